@@ -0,0 +1,477 @@
+//=============================================================================
+//
+// 物理の計測のメイン処理 [BenchMain.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "PhysicsBench.h"
+#include "string.h"
+
+//*****************************************************************************
+// プロトタイプ宣言（計測して結果を表示し、検証に通ればtrueを返す）
+//*****************************************************************************
+static bool RunSweepAndPrune(void);
+static bool RunBroadphase(void);
+static bool RunIslandWake(void);
+static bool RunStacking(void);
+static bool RunSolverRest(void);
+static bool RunDispatch(void);
+static bool RunIntegrate(void);
+static bool RunTunnelling(void);
+static bool RunIslandScaling(void);
+static bool RunNarrowphaseScaling(void);
+static bool RunRaycast(void);
+static bool RunRayPacket(void);
+static bool RunSnapshot(void);
+static bool RunBoxStack(void);
+static bool RunStaticBake(void);
+static bool RunTriangleMesh(void);
+static bool RunCompound(void);
+static bool RunGjk(void);
+static bool RunNarrowphaseBatch(void);
+
+//*****************************************************************************
+// 計測の一覧（コマンドラインで名前を指定すればそれだけ回す）
+//*****************************************************************************
+namespace
+{
+    struct BenchEntry
+    {
+        const char* name;           // 計測の名前
+        bool (*func)(void);         // 計測の関数
+    };
+
+    const BenchEntry BENCH_LIST[] =
+    {
+        { "sweep_and_prune",     RunSweepAndPrune },
+        { "broadphase",          RunBroadphase },
+        { "island_wake",         RunIslandWake },
+        { "stacking",            RunStacking },
+        { "solver_rest",         RunSolverRest },
+        { "dispatch",            RunDispatch },
+        { "integrate",           RunIntegrate },
+        { "tunnelling",          RunTunnelling },
+        { "island_scaling",      RunIslandScaling },
+        { "narrowphase_scaling", RunNarrowphaseScaling },
+        { "raycast",             RunRaycast },
+        { "ray_packet",          RunRayPacket },
+        { "snapshot",            RunSnapshot },
+        { "box_stack",           RunBoxStack },
+        { "static_bake",         RunStaticBake },
+        { "triangle_mesh",       RunTriangleMesh },
+        { "compound",            RunCompound },
+        { "gjk",                 RunGjk },
+        { "narrowphase_batch",   RunNarrowphaseBatch },
+    };
+}
+
+//=============================================================================
+// メイン関数
+//=============================================================================
+int main(int argc, char* argv[])
+{
+    int numFailed = 0;
+
+    for (const BenchEntry& entry : BENCH_LIST)
+    {
+        bool isSelected = argc <= 1;
+
+        for (int nCnt = 1; nCnt < argc; nCnt++)
+        {
+            isSelected = isSelected || strcmp(argv[nCnt], entry.name) == 0;
+        }
+
+        if (!isSelected)
+        {
+            continue;
+        }
+
+        printf("[%s]\n", entry.name);
+
+        if (!entry.func())
+        {
+            printf("  FAILED\n");
+            numFailed++;
+        }
+
+        fflush(stdout);
+    }
+
+    return numFailed > 0 ? 1 : 0;
+}
+//=============================================================================
+// スイープ＆プルーン（1000個・1万個の山で全組の二重ループと比べる）
+//=============================================================================
+static bool RunSweepAndPrune(void)
+{
+    SweepAndPruneBenchResult result = PhysicsBench::MeasureSweepAndPrune();
+    bool isMatch = true;
+
+    for (int nCnt = 0; nCnt < SweepAndPruneBenchResult::NUM_SIZES; nCnt++)
+    {
+        printf("  %5d bodies : step %.3f ms  sweep %.3f ms  pairs %d  hits %d / %d (all pairs)  all pairs x1 %.1f ms\n",
+            result.numBodies[nCnt], result.stepTime[nCnt], result.sweepTime[nCnt], result.numPairs[nCnt],
+            result.numHits[nCnt], result.numAllPairsHits[nCnt], result.allPairsTime[nCnt]);
+
+        // 当たっている組をブロードフェーズが1つも落としていないこと
+        isMatch = isMatch && result.numHits[nCnt] == result.numAllPairsHits[nCnt];
+    }
+
+    return isMatch;
+}
+//=============================================================================
+// ブロードフェーズの比較（通路と山でスイープ＆プルーンと動的AABBツリーを比べる）
+//=============================================================================
+static bool RunBroadphase(void)
+{
+    static const char* STAGE_NAME[BroadphaseBenchResult::STAGE_MAX] = { "Corridor", "Pile" };
+    static const char* TYPE_NAME[BroadphaseBenchResult::NUM_TYPES] = { "SAP", "AABB Tree" };
+
+    BroadphaseBenchResult result = PhysicsBench::MeasureBroadphase();
+    bool isMatch = true;
+
+    for (int nStage = 0; nStage < BroadphaseBenchResult::STAGE_MAX; nStage++)
+    {
+        for (int nType = 0; nType < BroadphaseBenchResult::NUM_TYPES; nType++)
+        {
+            printf("  %-8s %-9s (%d bodies) : step %.3f ms  pairs %.3f ms  pairs %d  hits %d\n",
+                STAGE_NAME[nStage], TYPE_NAME[nType], result.numBodies, result.stepTime[nStage][nType],
+                result.pairTime[nStage][nType], result.numPairs[nStage][nType], result.numHits[nStage][nType]);
+        }
+
+        // どちらの種類でも当たっている組は同じになること
+        isMatch = isMatch && result.numHits[nStage][0] == result.numHits[nStage][1];
+    }
+
+    return isMatch;
+}
+//=============================================================================
+// 起床（眠った積み上げの一番上に箱が当たったら、積み上げ全体が同じステップで起きること）
+//=============================================================================
+static bool RunIslandWake(void)
+{
+    IslandWakeResult result = PhysicsBench::MeasureIslandWake();
+
+    printf("  Bodies : %d  Asleep at step %d  Penetration %.2f\n", result.numBodies, result.sleepStep, result.sleepPenetration);
+    printf("  Woken : first step %d  all step %d  Max Penetration %.2f\n",
+        result.firstWakeStep, result.lastWakeStep, result.maxPenetration);
+
+    return result.sleepStep >= 0 && result.firstWakeStep >= 0 && result.lastWakeStep == result.firstWakeStep;
+}
+//=============================================================================
+// 積み上げ（デフォルトの設定で全部眠り、ウォームスタートなしのどの設定より崩れないこと）
+//=============================================================================
+static bool RunStacking(void)
+{
+    StackingBenchResult result = PhysicsBench::MeasureStacking();
+
+    for (int nConfig = 0; nConfig < StackingBenchResult::NUM_CONFIGS; nConfig++)
+    {
+        printf("  %d x %d  %-4s start  %2d iterations : step %.3f ms  sag %.3f  drift %.3f  standing %d / %d  rest at step %d\n",
+            result.height, result.numColumns, result.isWarmStarting[nConfig] ? "warm" : "cold", result.velocityIterations[nConfig],
+            result.stepTime[nConfig], result.maxSag[nConfig], result.maxDrift[nConfig],
+            result.numStanding[nConfig], result.numColumns, result.restStep[nConfig]);
+    }
+
+    // デフォルトの設定が眠りまで落ち着き、ウォームスタートなしのどの設定と比べても同じかそれ以上に立っていること
+    const int warm = StackingBenchResult::DEFAULT_CONFIG;
+    bool isStable = result.restStep[warm] >= 0;
+
+    for (int nConfig = 0; nConfig < StackingBenchResult::NUM_CONFIGS; nConfig++)
+    {
+        if (result.isWarmStarting[nConfig])
+        {
+            continue;
+        }
+
+        isStable = isStable && result.numStanding[warm] >= result.numStanding[nConfig] && result.maxSag[warm] <= result.maxSag[nConfig];
+    }
+
+    return isStable;
+}
+//=============================================================================
+// 静止までの反復（エディターと同じ設定で、どの場面も全部の箱が立ったまま、以前の押し戻しのソルバー以下のステップで眠ること）
+//=============================================================================
+static bool RunSolverRest(void)
+{
+    static const char* CONFIG_NAME[SolverRestBenchResult::NUM_CONFIGS] = { "default", "no early out", "cold start", "push-out" };
+
+    SolverRestBenchResult result = PhysicsBench::MeasureSolverRest();
+    bool isRest = true;
+
+    for (int nScene = 0; nScene < SolverRestBenchResult::NUM_SCENES; nScene++)
+    {
+        for (int nConfig = 0; nConfig < SolverRestBenchResult::NUM_CONFIGS; nConfig++)
+        {
+            printf("  %2d x %-2d %-12s : rest at step %3d  passes %5.2f / step  step %.3f ms  sag %.3f  standing %d / %d\n",
+                result.height[nScene], result.numColumns[nScene], CONFIG_NAME[nConfig],
+                result.restStep[nScene][nConfig], result.velocityPasses[nScene][nConfig], result.stepTime[nScene][nConfig],
+                result.maxSag[nScene][nConfig], result.numStanding[nScene][nConfig], result.numColumns[nScene]);
+        }
+
+        const int config = SolverRestBenchResult::DEFAULT_CONFIG;
+        int legacyRest = result.restStep[nScene][SolverRestBenchResult::PUSH_OUT_CONFIG];
+
+        isRest = isRest && result.restStep[nScene][config] >= 0 && result.numStanding[nScene][config] == result.numColumns[nScene] &&
+            (legacyRest < 0 || result.restStep[nScene][config] <= legacyRest);
+    }
+
+    return isRest;
+}
+//=============================================================================
+// 衝突判定の振り分け（判定本体を外し、関数表が以前のif/elseの連鎖より速いこと）
+//=============================================================================
+static bool RunDispatch(void)
+{
+    DispatchBenchResult result = PhysicsBench::MeasureDispatch();
+
+    printf("  %d mixed pairs x %d : table %.2f ns / pair  if/else chain %.2f ns / pair\n",
+        result.numPairs, result.numCalls / result.numPairs, result.tableCost, result.chainCost);
+
+    return result.tableCost < result.chainCost;
+}
+//=============================================================================
+// 積分（剛体プールが以前の1つずつヒープに置く形と同じ結果になり、散らばった並びより速いこと）
+//=============================================================================
+static bool RunIntegrate(void)
+{
+    IntegrateBenchResult result = PhysicsBench::MeasureIntegrate();
+
+    printf("  %d bodies (best of velocity + position) : pool %.2f ms  legacy in order %.2f ms  legacy scattered %.2f ms\n",
+        result.numBodies, result.poolTime, result.legacyOrderedTime, result.legacyScatteredTime);
+    printf("  Body Size : pool %d bytes  legacy %d bytes  Mismatch : %d\n",
+        result.poolBodySize, result.legacyBodySize, result.numMismatch);
+
+    return result.numMismatch == 0 && result.poolTime < result.legacyScatteredTime;
+}
+//=============================================================================
+// すり抜け（厚さ1の床に撃ち込んだ弾が、予測接触ありでは1つも抜けないこと）
+//=============================================================================
+static bool RunTunnelling(void)
+{
+    TunnellingTestResult result = PhysicsBench::MeasureTunnelling();
+
+    printf("  Tunnelled : %d / %d (without CCD %d)  Max Speed : %.0f  Speculative : %d\n",
+        result.numTunnelled, result.numShots, result.numTunnelledDiscrete, result.maxSpeed, result.numSpeculative);
+
+    return result.numShots > 0 && result.numTunnelled == 0;
+}
+//=============================================================================
+// アイランドの並列解決（独立した塔を並べ、どのスレッド数でも1スレッドと同じ結果になること）
+//=============================================================================
+static bool RunIslandScaling(void)
+{
+    IslandScalingResult result = PhysicsBench::MeasureIslandScaling();
+
+    printf("  Islands : %d  Cores : %d  %s\n", result.numIslands, result.numHardwareThreads,
+        result.isDeterministic ? "Deterministic" : "MISMATCH");
+
+    for (int nCnt = 0; nCnt < IslandScalingResult::NUM_THREAD_COUNTS; nCnt++)
+    {
+        printf("  %d threads : step %.3f ms  solve %.3f ms (x%.2f)\n",
+            result.threadCounts[nCnt], result.stepTime[nCnt], result.solveTime[nCnt],
+            result.solveTime[nCnt] > 0.0f ? result.solveTime[0] / result.solveTime[nCnt] : 0.0f);
+    }
+
+    return result.isDeterministic;
+}
+//=============================================================================
+// ナローフェーズの並列化（1万個の球の穴で、どのスレッド数でも1スレッドと同じ結果になること）
+//=============================================================================
+static bool RunNarrowphaseScaling(void)
+{
+    NarrowphaseScalingResult result = PhysicsBench::MeasureNarrowphaseScaling();
+
+    printf("  Spheres : %d  Pairs : %d  Contacts : %d  Cores : %d  %s\n", result.numBodies, result.numPairs,
+        result.numContacts, result.numHardwareThreads, result.isDeterministic ? "Deterministic" : "MISMATCH");
+
+    for (int nCnt = 0; nCnt < NarrowphaseScalingResult::NUM_THREAD_COUNTS; nCnt++)
+    {
+        printf("  %d threads : narrowphase %.3f ms (x%.2f)  step %.3f ms\n",
+            result.threadCounts[nCnt], result.narrowphaseTime[nCnt],
+            result.narrowphaseTime[nCnt] > 0.0f ? result.narrowphaseTime[0] / result.narrowphaseTime[nCnt] : 0.0f,
+            result.stepTime[nCnt]);
+
+        // ステップの残りがどこに掛かっているか（並列化したナローフェーズの割合を見るため）
+        printf("              integrate %.3f ms  broadphase %.3f ms  solve %.3f ms  sleep %.3f ms\n",
+            result.integrateTime[nCnt], result.broadphaseTime[nCnt], result.solveTime[nCnt], result.sleepTime[nCnt]);
+    }
+
+    return result.isDeterministic;
+}
+//=============================================================================
+// レイキャスト（1万個のブロックのステージで、BVHを使った結果が総当たりと食い違わないこと）
+//=============================================================================
+static bool RunRaycast(void)
+{
+    RaycastBenchResult result = PhysicsBench::MeasureRaycast();
+
+    printf("  Bodies : %d  Rays : %d  Hits : %d  Mismatch : %d\n",
+        result.numBodies, result.numRays, result.numHits, result.numMismatch);
+    printf("  BVH %.3f us / ray  Brute force %.3f us / ray (x%.1f)\n", result.treeTime, result.bruteForceTime,
+        result.treeTime > 0.0f ? result.bruteForceTime / result.treeTime : 0.0f);
+
+    return result.numMismatch == 0 && result.treeTime < result.bruteForceTime;
+}
+//=============================================================================
+// まとめたレイ（向きの近い8本ずつのレイが、1本ずつのRayCastと食い違わないこと）
+//=============================================================================
+static bool RunRayPacket(void)
+{
+    RayPacketBenchResult result = PhysicsBench::MeasureRayPacket();
+
+    printf("  Bodies : %d  Rays : %d  Hits : %d  Lanes : %d  Mismatch : %d\n",
+        result.numBodies, result.numRays, result.numHits, result.laneWidth, result.numMismatch);
+    printf("  Single %.2f Mrays/s  Packet %.2f Mrays/s (x%.2f)\n", result.scalarRate, result.packetRate,
+        result.scalarRate > 0.0f ? result.packetRate / result.scalarRate : 0.0f);
+
+    return result.numMismatch == 0;
+}
+//=============================================================================
+// スナップショット（球の穴を戻して回し直した結果が、1回目とも作り直したワールドともビット単位で同じこと）
+//=============================================================================
+static bool RunSnapshot(void)
+{
+    SnapshotBenchResult result = PhysicsBench::MeasureSnapshot();
+
+    printf("  Bodies : %d  Manifolds : %d  Size : %.1f KB  Restore %s  Rebuild %s\n",
+        result.numBodies, result.numManifolds, result.numBytes / 1024.0f,
+        result.isRestoreMatch ? "Match" : "MISMATCH", result.isRebuildMatch ? "Match" : "MISMATCH");
+    printf("  Save %.1f us  Restore %.1f us\n", result.saveTime, result.restoreTime);
+
+    return result.isRestoreMatch && result.isRebuildMatch;
+}
+//=============================================================================
+// 箱の塔（10段の塔を3通りに積んで、全部の箱が上限までに眠ること）
+//=============================================================================
+static bool RunBoxStack(void)
+{
+    static const char* TOWER_NAME[BoxStackTestResult::NUM_TOWERS] = { "Aligned", "Jittered", "Rotated 45" };
+
+    BoxStackTestResult result = PhysicsBench::MeasureBoxStack();
+
+    printf("  %s (limit %d steps)\n", result.isAllAtRest ? "All at rest" : "NOT AT REST", result.maxSteps);
+
+    for (int nCnt = 0; nCnt < BoxStackTestResult::NUM_TOWERS; nCnt++)
+    {
+        printf("  %-10s : rest %3d  drift %.2f  points %.2f  passes %.1f\n", TOWER_NAME[nCnt],
+            result.restStep[nCnt], result.topDrift[nCnt], result.avgPoints[nCnt], result.avgPasses[nCnt]);
+    }
+
+    return result.isAllAtRest;
+}
+//=============================================================================
+// 静的ステージの焼き込み（ほかのスレッドで組んだBVHが、呼び出したスレッドで組んだものと同じ結果を返すこと）
+//=============================================================================
+static bool RunStaticBake(void)
+{
+    StaticBakeBenchResult result = PhysicsBench::MeasureStaticBake();
+
+    printf("  Bodies : %d  Nodes : %d  %s\n", result.numBodies, result.numNodes, result.isMatch ? "Match" : "MISMATCH");
+    printf("  Bake : gather %.2f ms + worker %.2f ms  Sync build %.2f ms\n",
+        result.gatherTime, result.buildTime, result.syncBuildTime);
+    printf("  Edit frame %.3f ms  Scan %.1f us -> %.1f us baked  Static transforms %.2f ms\n",
+        result.editFrameTime, result.scanTime, result.bakedScanTime, result.transformTime);
+
+    return result.isMatch;
+}
+//=============================================================================
+// 三角形メッシュ（読み込み・レイが組み立てたもの・総当たりと同じで、落とした剛体が全部地面に支えられて眠ること）
+//=============================================================================
+static bool RunTriangleMesh(void)
+{
+    TriangleMeshBenchResult result = PhysicsBench::MeasureTriangleMesh();
+
+    printf("  Triangles : %d  Nodes : %d  Size : %.1f KB  Load %s  Corrupt %s\n",
+        result.numTriangles, result.numNodes, result.numBytes / 1024.0f, result.isRoundTripMatch ? "Match" : "MISMATCH",
+        result.isCorruptRejected ? "Rejected" : "ACCEPTED");
+    printf("  Cook %.2f ms  Load %.2f ms  Heightfield %.2f ms\n", result.cookTime, result.loadTime, result.sampleTime);
+    printf("  Ray : BVH %.2f us  Brute %.1f us  Heightfield %.2f us  %s / %s\n",
+        result.meshRayTime, result.bruteRayTime, result.fieldRayTime,
+        result.isRayMatch ? "Match" : "MISMATCH", result.isFieldRayMatch ? "Match" : "MISMATCH");
+    printf("  Dropped : %d  Held : %d  Sleeping : %d\n", result.numDropped, result.numHeld, result.numSleeping);
+
+    return result.isRoundTripMatch && result.isCorruptRejected && result.isRayMatch && result.isFieldRayMatch &&
+        result.numHeld == result.numDropped;
+}
+//=============================================================================
+// 複合コライダー（机を1つの複合コライダーで落として、全部の天板が傾かずに脚の高さで止まること）
+//=============================================================================
+static bool RunCompound(void)
+{
+    CompoundBenchResult result = PhysicsBench::MeasureCompound();
+
+    printf("  Tables : %d\n", result.numTables);
+    printf("  Compound : bodies %d  pairs %d  %.3f ms/step  rest %d  sleep %d\n",
+        result.compoundBodies, result.compoundPairs, result.compoundStepTime, result.compoundResting, result.compoundSleeping);
+    printf("  Separate : bodies %d  pairs %d  %.3f ms/step  rest %d  sleep %d\n",
+        result.separateBodies, result.separatePairs, result.separateStepTime, result.separateResting, result.separateSleeping);
+
+    return result.compoundResting == result.numTables;
+}
+//=============================================================================
+// GJK/EPA（専用の判定関数と浅い組のめり込み量がそろい、落とした凸包が全部床に支えられること）
+//=============================================================================
+static bool RunGjk(void)
+{
+    GjkBenchResult result = PhysicsBench::MeasureGjk();
+
+    struct PairRow
+    {
+        const char*         name;
+        const GjkPairBench& pair;
+        bool                isExact;    // 専用の判定関数がGJK/EPAと同じ深さを返すはずか（箱同士は基準面で切り取るので少しずれる）
+    };
+
+    const PairRow rows[] =
+    {
+        { "Box-Box",         result.boxBox,         false },
+        { "Sphere-Box",      result.sphereBox,      true },
+        { "Sphere-Sphere",   result.sphereSphere,   true },
+        { "Sphere-Capsule",  result.sphereCapsule,  true },
+        { "Sphere-Cylinder", result.sphereCylinder, true },
+        { "Capsule-Box",     result.capsuleBox,     true },
+        { "Capsule-Capsule", result.capsuleCapsule, true },
+    };
+
+    bool isMatch = true;
+
+    printf("  Pairs : %d\n", result.numPairs);
+
+    for (const PairRow& row : rows)
+    {
+        printf("  %-16s : %.0f ns -> %.0f ns  hits %d  mismatch %d/%d  depth err %.4f\n", row.name,
+            row.pair.specialisedTime, row.pair.gjkTime, row.pair.numHits, row.pair.numMismatches, row.pair.numShallow, row.pair.maxDepthError);
+
+        if (row.isExact && row.pair.numMismatches > 0)
+        {
+            isMatch = false;
+        }
+    }
+
+    printf("  Hull : %d verts  %d tris  cook %.1f us  hull-box %.0f ns\n",
+        result.hullVertices, result.hullTriangles, result.cookTime, result.hullBoxTime);
+    printf("  Drop : hulls %d  %.3f ms/step  held %d  sleep %d\n",
+        result.numHulls, result.hullStepTime, result.numHullsHeld, result.numHullsSleeping);
+
+    // 落とした凸包は全部床の上で止まって眠るはず
+    return isMatch && result.numHullsHeld == result.numHulls && result.numHullsSleeping == result.numHulls;
+}
+//=============================================================================
+// 球・箱のまとめ判定（SIMD版をスカラー版・1組ずつの判定と比べる）
+//=============================================================================
+static bool RunNarrowphaseBatch(void)
+{
+    NarrowphaseBenchResult result = PhysicsBench::MeasureNarrowphaseBatch();
+
+    printf("  Pairs : %d  Mismatch : %d (scalar) / %d (per pair)  Max Error : %.2e\n",
+        result.numPairs, result.numMismatch, result.numMismatchPerPair, result.maxError);
+    printf("  Per Pair : %.1f M/s  Scalar : %.1f M/s  SIMD x%d : %.1f M/s\n",
+        result.perPairRate / 1e6f, result.scalarRate / 1e6f, result.laneWidth, result.simdRate / 1e6f);
+
+    return result.numMismatch == 0 && result.numMismatchPerPair == 0;
+}
@@ -34,12 +34,15 @@ CBlock::CBlock(int nPriority) : CObjectX(nPriority)
 	m_isDead		 = false;					// 削除予約フラグ
 	m_isEditMode	 = false;					// エディットモードかどうか
 	m_isDynamic		 = false;					// ダイナミックかどうか
+	m_isTrigger		 = false;					// トリガーかどうか
+	m_CollisionLayer = RigidBody::DEFAULT_COLLISION_LAYER;	// 当たり判定のレイヤー
+	m_CollisionMask	 = RigidBody::ALL_COLLISION_LAYERS;		// 当たり判定のマスク
 	m_pDebug3D		 = nullptr;					// 3Dデバッグへのポインタ
 }
 //=============================================================================
 // 生成処理
 //=============================================================================
-CBlock* CBlock::Create(const char* pFilepath, D3DXVECTOR3 pos, D3DXVECTOR3 rot, D3DXVECTOR3 size, TYPE type, bool isDynamic)
+CBlock* CBlock::Create(const char* pFilepath, D3DXVECTOR3 pos, D3DXVECTOR3 rot, D3DXVECTOR3 size, TYPE type, bool isDynamic, bool isCreatePhysics)
 {
 	if (m_BlockFactoryMap.empty())
 	{
@@ -78,8 +81,11 @@ CBlock* CBlock::Create(const char* pFilepath, D3DXVECTOR3 pos, D3DXVECTOR3 rot,
 		return nullptr;
 	}
 
-	// 大きさからコライダー等を生成
-	pBlock->CreatePhysicsFromScale(size);
+	// 大きさからコライダー等を生成（まとめて生成する場合は呼び出し側で作る）
+	if (isCreatePhysics)
+	{
+		pBlock->CreatePhysicsFromScale(size);
+	}
 
 	return pBlock;
 }
@@ -95,14 +101,35 @@ void CBlock::InitFactory(void)
 	m_BlockFactoryMap[CBlock::TYPE_CYLINDER]	= []() -> CBlock* { return new CCylinderBlock(); };
 	m_BlockFactoryMap[CBlock::TYPE_SPHERE]		= []() -> CBlock* { return new CSphereBlock(); };
 	m_BlockFactoryMap[CBlock::TYPE_CAPSULE]		= []() -> CBlock* { return new CCapsuleBlock(); };
+	m_BlockFactoryMap[CBlock::TYPE_MESH]		= []() -> CBlock* { return new CMeshBlock(); };
+	m_BlockFactoryMap[CBlock::TYPE_TERRAIN]		= []() -> CBlock* { return new CTerrainBlock(); };
+	m_BlockFactoryMap[CBlock::TYPE_CONVEX]		= []() -> CBlock* { return new CConvexBlock(); };
 }
 //=============================================================================
 // 当たり判定の生成処理
 //=============================================================================
 void CBlock::CreatePhysics(const D3DXVECTOR3& pos, const D3DXVECTOR3& size)
 {
-	// BoxCollider を作成
-	m_pShape = CreateCollisionShape(size);
+	RigidBodyDesc desc = PreparePhysics(size);
+
+	// リジッドボディの生成（PhysicsWorld に登録してハンドルを受け取る）
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
+	RigidBodyHandle handle = pWorld->CreateRigidBody(desc.collider, desc.mass, desc.isDynamic);
+
+	AttachRigidBody(handle, pos);
+}
+//=============================================================================
+// コライダーの生成処理（剛体の生成情報を返す）
+//=============================================================================
+RigidBodyDesc CBlock::PreparePhysics(const D3DXVECTOR3& size)
+{
+	// 子の形状があれば複合コライダー、無ければ BoxCollider を作成
+	m_pShape = m_ColliderParts.empty() ? nullptr : CreateCompoundShape();
+
+	if (!m_pShape)
+	{
+		m_pShape = CreateCollisionShape(size);
+	}
 
 	float mass = (/*m_isEditMode ? 0.0f :*/ (IsDynamicBlock() ? GetMass() : 0.0f));
 
@@ -113,25 +140,78 @@ void CBlock::CreatePhysics(const D3DXVECTOR3& pos, const D3DXVECTOR3& size)
 		m_pShape->calculateLocalInertia(mass, inertia);
 	}
 
-	// リジッドボディの生成
-	m_pRigidBody = std::make_shared<RigidBody>(m_pShape, mass);
+	RigidBodyDesc desc;
+	desc.collider = m_pShape;
+	desc.mass = mass;
+	desc.isDynamic = IsDynamicBlock();
+
+	return desc;
+}
+//=============================================================================
+// 生成済みの剛体の初期設定処理
+//=============================================================================
+void CBlock::AttachRigidBody(const RigidBodyHandle& handle, const D3DXVECTOR3& pos)
+{
+	m_hRigidBody = handle;
+
+	RigidBody* pRigidBody = GetRigidBody();
+
+	if (!pRigidBody)
+	{
+		return;
+	}
 
 	D3DXVECTOR3 euler = GetRot(); // オイラー角（ラジアン）
 	D3DXQUATERNION q;
 	D3DXQuaternionRotationYawPitchRoll(&q, euler.y, euler.x, euler.z);
 
 	// 初期位置の設定
-	m_pRigidBody->SetTransform(pos, q, GetSize());
+	pRigidBody->SetTransform(pos, q, GetSize());
+
+	pRigidBody->SetLinearFactor(GetLinearFactor());		// 移動方向
+	pRigidBody->SetAngularFactor(GetAngularFactor());		// 回転方向
+	pRigidBody->SetRollingFriction(GetRollingFriction());	// 転がり摩擦
+	pRigidBody->SetFriction(GetFriction());				// 摩擦
+	pRigidBody->SetCollisionLayer(m_CollisionLayer);		// 当たり判定のレイヤー
+	pRigidBody->SetCollisionMask(m_CollisionMask);			// 当たり判定のマスク
+	pRigidBody->SetTrigger(m_isTrigger);					// トリガー
+	pRigidBody->SetUserData(this);							// 問い合わせの結果からブロックに戻る用
+}
+//=============================================================================
+// 当たり判定のレイヤーとマスクの設定処理
+//=============================================================================
+void CBlock::SetCollisionFilter(unsigned int layer, unsigned int mask)
+{
+	m_CollisionLayer = layer;
+	m_CollisionMask = mask;
+
+	RigidBody* pRigidBody = GetRigidBody();
 
-	m_pRigidBody->SetIsDynamic(IsDynamicBlock());			// ダイナミックブロックかどうか
+	if (pRigidBody)
+	{
+		pRigidBody->SetCollisionLayer(layer);
+		pRigidBody->SetCollisionMask(mask);
+		// 静的なら足場が変わったものとして周りの剛体も起こす
+		pRigidBody->WakeUp();
+		pRigidBody->SetMoved(true);
+	}
+}
+//=============================================================================
+// トリガーの設定処理
+//=============================================================================
+void CBlock::SetTrigger(bool isTrigger)
+{
+	m_isTrigger = isTrigger;
 
-	m_pRigidBody->SetLinearFactor(GetLinearFactor());		// 移動方向
-	m_pRigidBody->SetAngularFactor(GetAngularFactor());		// 回転方向
-	m_pRigidBody->SetRollingFriction(GetRollingFriction());	// 転がり摩擦
-	m_pRigidBody->SetFriction(GetFriction());				// 摩擦
+	RigidBody* pRigidBody = GetRigidBody();
 
-	// PhysicsWorld に追加
-	CManager::GetPhysicsWorld()->AddRigidBody(m_pRigidBody);
+	if (pRigidBody)
+	{
+		pRigidBody->SetTrigger(isTrigger);
+		// 静的なら足場が変わったものとして周りの剛体も起こす
+		pRigidBody->WakeUp();
+		pRigidBody->SetMoved(true);
+	}
 }
 //=============================================================================
 // スケールによるコライダーの生成処理
@@ -155,7 +235,7 @@ void CBlock::CreatePhysicsFromScale(const D3DXVECTOR3& scale)
 //=============================================================================
 void CBlock::RecreatePhysics(void)
 {
-	if (!m_pRigidBody)
+	if (!GetRigidBody())
 	{
 		return;
 	}
@@ -202,14 +282,14 @@ void CBlock::ReleasePhysics(void)
 	//OnPhysicsReleased();
 
 	// リジッドボディの破棄
-	if (m_pRigidBody)
+	if (m_hRigidBody.IsValid())
 	{
 		if (world)
 		{
-			world->RemoveRigidBody(m_pRigidBody);
+			world->RemoveRigidBody(m_hRigidBody);
 		}
 
-		m_pRigidBody = nullptr;
+		m_hRigidBody = {};
 	}
 
 	// シェイプの破棄
@@ -223,6 +303,12 @@ void CBlock::ReleasePhysics(void)
 //=============================================================================
 void CBlock::Update(void)
 {
+	// 再生中の静的ブロックは焼き込んだBVHのまま動かさない（毎フレーム同じ位置を設定し直さない）
+	if (!IsDynamicBlock() && !IsEditMode())
+	{
+		return;
+	}
+
 	if (!IsDynamicBlock() || IsEditMode())
     {
         // static ブロック
@@ -230,30 +316,33 @@ void CBlock::Update(void)
         D3DXVECTOR3 rot = GetRot();
         D3DXVECTOR3 scale = GetSize();
 
-        if (m_pRigidBody)
+        if (RigidBody* pRigidBody = GetRigidBody())
         {
 			// オイラー角 → クォータニオン変換
 			D3DXQUATERNION q;
 			D3DXQuaternionRotationYawPitchRoll(&q, rot.y, rot.x, rot.z);
 
-			m_pRigidBody->SetTransform(pos, q, scale);
+			pRigidBody->SetTransform(pos, q, scale);
 
             // 静的なので角速度はリセット
-            m_pRigidBody->SetVelocity(D3DXVECTOR3(0,0,0));
-            m_pRigidBody->SetAngularVelocity(D3DXVECTOR3(0,0,0));
+            pRigidBody->SetVelocity(D3DXVECTOR3(0,0,0));
+            pRigidBody->SetAngularVelocity(D3DXVECTOR3(0,0,0));
         }
     }
     else
     {
         // dynamic ブロック
-		if (!m_pRigidBody)
+		RigidBody* pRigidBody = GetRigidBody();
+
+		if (!pRigidBody)
 		{
 			return;
 		}
 
-        // Rigidbody 側の位置・回転を取得
-        D3DXVECTOR3 pos = m_pRigidBody->GetPosition();
-        D3DXQUATERNION q = m_pRigidBody->GetOrientation();
+        // Rigidbody 側の位置・回転を取得（物理のステップの間は補間する）
+        float alpha = CManager::GetPhysicsWorld()->GetInterpolationAlpha();
+        D3DXVECTOR3 pos = pRigidBody->GetInterpolatedPosition(alpha);
+        D3DXQUATERNION q = pRigidBody->GetInterpolatedOrientation(alpha);
 
         // クォータニオン → マトリックス → オイラー角
         D3DXMATRIX matRot;
@@ -335,6 +424,18 @@ void CBlock::DrawCollider(void)
 	{
 		m_pDebug3D->DrawCollider(capsule, COLLIDER_COLOR);
 	}
+	else if (auto mesh = m_pShape->As<MeshCollider>())
+	{
+		m_pDebug3D->DrawCollider(mesh, COLLIDER_COLOR);
+	}
+	else if (auto compound = m_pShape->As<CompoundCollider>())
+	{
+		m_pDebug3D->DrawCollider(compound, COLLIDER_COLOR);
+	}
+	else if (auto convex = m_pShape->As<ConvexCollider>())
+	{
+		m_pDebug3D->DrawCollider(convex, COLLIDER_COLOR);
+	}
 }
 //=============================================================================
 // 色の取得
@@ -375,13 +476,27 @@ D3DXMATRIX CBlock::GetWorldMatrix(void)
 	return world;
 }
 //=============================================================================
+// リジッドボディの取得処理（削除済みならnullptr）
+//=============================================================================
+RigidBody* CBlock::GetRigidBody(void)
+{
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
+
+	if (pWorld == nullptr)
+	{
+		return nullptr;
+	}
+
+	return pWorld->GetRigidBody(m_hRigidBody);
+}
+//=============================================================================
 // エディター中かどうかでキネマティックにするか判定する処理
 //=============================================================================
 void CBlock::SetEditMode(bool enable)
 {
 	m_isEditMode = enable;
 
-	if (!m_pRigidBody)
+	if (!GetRigidBody())
 	{
 		return;
 	}
@@ -410,6 +525,29 @@ void CBlock::SaveToJson(json& b)
 	b["rot"] = { degRot.x, degRot.y, degRot.z };
 	b["size"] = { GetSize().x, GetSize().y, GetSize().z };
 	b["is_dynamic"] = IsDynamicBlock();
+	b["is_trigger"] = m_isTrigger;
+	b["collision_layer"] = m_CollisionLayer;
+	b["collision_mask"] = m_CollisionMask;
+
+	// 子の形状は複合コライダーのブロックだけ書く
+	if (!m_ColliderParts.empty())
+	{
+		json colliders = json::array();
+
+		for (const ColliderPart& part : m_ColliderParts)
+		{
+			D3DXVECTOR3 degPartRot = D3DXToDegree(part.rot);
+
+			json c;
+			c["type"] = part.type;
+			c["offset"] = { part.offset.x, part.offset.y, part.offset.z };
+			c["rot"] = { degPartRot.x, degPartRot.y, degPartRot.z };
+			c["size"] = { part.size.x, part.size.y, part.size.z };
+			colliders.push_back(c);
+		}
+
+		b["colliders"] = colliders;
+	}
 }
 //=============================================================================
 // ブロック情報読み込み処理
@@ -424,6 +562,44 @@ void CBlock::LoadFromJson(const json& b)
 	SetRot(D3DXToRadian(degRot));
 	SetSize(size);
 	SetIsDynamic(b["is_dynamic"]);
+
+	// 古いステージには無いので既定値で読む
+	m_isTrigger = b.value("is_trigger", false);
+	m_CollisionLayer = b.value("collision_layer", RigidBody::DEFAULT_COLLISION_LAYER);
+	m_CollisionMask = b.value("collision_mask", RigidBody::ALL_COLLISION_LAYERS);
+
+	// 複合コライダーの子の形状（無ければブロックの種類の形状）
+	m_ColliderParts.clear();
+
+	if (b.contains("colliders"))
+	{
+		for (const json& c : b["colliders"])
+		{
+			ColliderPart part;
+			part.type = (Collider::TYPE)c.value("type", (int)Collider::BOX);
+			part.offset = INIT_VEC3;
+			part.rot = INIT_VEC3;
+			part.size = D3DXVECTOR3(1.0f, 1.0f, 1.0f);
+
+			if (c.contains("offset"))
+			{
+				part.offset = D3DXVECTOR3(c["offset"][0], c["offset"][1], c["offset"][2]);
+			}
+
+			if (c.contains("rot"))
+			{
+				D3DXVECTOR3 degPartRot(c["rot"][0], c["rot"][1], c["rot"][2]);
+				part.rot = D3DXToRadian(degPartRot);
+			}
+
+			if (c.contains("size"))
+			{
+				part.size = D3DXVECTOR3(c["size"][0], c["size"][1], c["size"][2]);
+			}
+
+			m_ColliderParts.push_back(part);
+		}
+	}
 }
 //=============================================================================
 // コリジョン生成処理
@@ -432,3 +608,47 @@ std::shared_ptr<Collider> CBlock::CreateCollisionShape(const D3DXVECTOR3& size)
 {
 	return std::make_shared <BoxCollider>(size);	// デフォルトはボックス 派生クラスで同じのを作ってShapeを設定
 }
+//=============================================================================
+// 複合コライダーの生成処理（子の位置・大きさはモデルの元の大きさで書き、ブロックのスケールは剛体がかける）
+//=============================================================================
+std::shared_ptr<Collider> CBlock::CreateCompoundShape(void)
+{
+	auto compound = std::make_shared<CompoundCollider>();
+
+	for (const ColliderPart& part : m_ColliderParts)
+	{
+		std::shared_ptr<Collider> child;
+
+		switch (part.type)
+		{
+		case Collider::BOX:
+			child = std::make_shared<BoxCollider>(part.size);
+			break;
+		case Collider::CYLINDER:
+			child = std::make_shared<CylinderCollider>(part.size, D3DXVECTOR3(0, 1, 0));
+			break;
+		case Collider::SPHERE:
+			child = std::make_shared<SphereCollider>(part.size);
+			break;
+		case Collider::CAPSULE:
+			// 全体の高さから両端の半球を除いた長さにする
+			child = std::make_shared<CapsuleCollider>(part.size.x * 0.5f, std::max(part.size.y - part.size.x, 0.0f));
+			break;
+		default:
+			// メッシュ・複合は子にできない
+			continue;
+		}
+
+		D3DXQUATERNION q;
+		D3DXQuaternionRotationYawPitchRoll(&q, part.rot.y, part.rot.x, part.rot.z);
+
+		compound->AddChild(child, part.offset, q);
+	}
+
+	if (compound->GetChildCount() == 0)
+	{// 使える子が無ければブロックの種類の形状で代用
+		return nullptr;
+	}
+
+	return compound;
+}
@@ -48,10 +48,24 @@ public:
 		TYPE_CYLINDER,
 		TYPE_SPHERE,
 		TYPE_CAPSULE,
+		TYPE_MESH,
+		TYPE_TERRAIN,
+		TYPE_CONVEX,
 		TYPE_MAX
 	};
 
-	static CBlock* Create(const char* pFilepath, D3DXVECTOR3 pos, D3DXVECTOR3 rot, D3DXVECTOR3 size, TYPE type, bool isDynamic);	// ブロックの生成
+	//*****************************************************************************
+	// 複合コライダーの子の形状（JSONの"colliders"、空ならブロックの種類の形状を使う）
+	//*****************************************************************************
+	struct ColliderPart
+	{
+		Collider::TYPE	type;		// 形状の種類（箱・円柱・球・カプセル）
+		D3DXVECTOR3		offset;		// ブロックから見た位置
+		D3DXVECTOR3		rot;		// ブロックから見た回転（ラジアン）
+		D3DXVECTOR3		size;		// 大きさ（カプセルはxが直径、yが全体の高さ）
+	};
+
+	static CBlock* Create(const char* pFilepath, D3DXVECTOR3 pos, D3DXVECTOR3 rot, D3DXVECTOR3 size, TYPE type, bool isDynamic, bool isCreatePhysics = true);	// ブロックの生成
 	static void InitFactory(void);
 	virtual HRESULT Init(void);
 	void Kill(void) { m_isDead = true; }												// ブロック削除
@@ -62,8 +76,11 @@ public:
 	void DrawCollider(void);
 	void CreatePhysicsFromScale(const D3DXVECTOR3& scale);								// ブロックスケールによるコライダーの生成
 	void CreatePhysics(const D3DXVECTOR3& pos, const D3DXVECTOR3& size);				// コライダーの生成
+	RigidBodyDesc PreparePhysics(const D3DXVECTOR3& size);								// コライダーの生成（剛体は作らない）
+	void AttachRigidBody(const RigidBodyHandle& handle, const D3DXVECTOR3& pos);		// 生成済みの剛体の初期設定
 	void RecreatePhysics(void);
 	virtual std::shared_ptr<Collider> CreateCollisionShape(const D3DXVECTOR3& size);
+	std::shared_ptr<Collider> CreateCompoundShape(void);								// 子の形状からの複合コライダーの生成
 	virtual void SaveToJson(json& b);
 	virtual void LoadFromJson(const json& b);
 	virtual void UpdateLight(void) {}
@@ -75,6 +92,7 @@ public:
 	bool IsEditMode(void) const { return m_isEditMode; }								// エディット中かどうか
 	virtual bool IsDynamicBlock(void) const { return m_isDynamic; }						// 動的ブロックの判別
 	bool IsDead(void) const { return m_isDead; }										// 削除予約の取得
+	bool IsTrigger(void) const { return m_isTrigger; }									// トリガー（押し戻さない）かどうか
 
 	//*****************************************************************************
 	// setter関数
@@ -86,6 +104,9 @@ public:
 	//void SetColliderManual(const D3DXVECTOR3& newSize);									// コライダーサイズの手動設定用
 	//void SetColliderOffset(const D3DXVECTOR3& offset) { m_colliderOffset = offset; }	// コライダーのオフセットの設定
 	void SetIsDynamic(bool isDynamic) { m_isDynamic = isDynamic; }
+	void SetCollisionFilter(unsigned int layer, unsigned int mask);						// 当たり判定のレイヤーとマスクの設定
+	void SetTrigger(bool isTrigger);													// トリガー（押し戻さない）の設定
+	void SetColliderParts(const std::vector<ColliderPart>& parts) { m_ColliderParts = parts; }	// 複合コライダーの子の形状の設定（次の生成から反映）
 
 	//*****************************************************************************
 	// getter関数
@@ -93,7 +114,11 @@ public:
 	virtual D3DXCOLOR GetCol(void) const override;										// カラーの取得
 	TYPE GetType(void) const { return m_Type; }											// タイプの取得
 	D3DXMATRIX GetWorldMatrix(void);
-	RigidBody* GetRigidBody(void) { return m_pRigidBody.get(); }
+	RigidBody* GetRigidBody(void);
+	const RigidBodyHandle& GetRigidBodyHandle(void) const { return m_hRigidBody; }		// リジッドボディのハンドルの取得
+	unsigned int GetCollisionLayer(void) const { return m_CollisionLayer; }			// 当たり判定のレイヤーの取得
+	unsigned int GetCollisionMask(void) const { return m_CollisionMask; }				// 当たり判定のマスクの取得
+	const std::vector<ColliderPart>& GetColliderParts(void) const { return m_ColliderParts; }	// 複合コライダーの子の形状の取得
 
 	virtual float GetMass(void) const { return DEFAULT_MASS; }								// 質量の取得
 	virtual int GetCollisionFlags(void) const { return 0; }// デフォルトはフラグなし
@@ -111,7 +136,7 @@ private:
 	const D3DXCOLOR			SELECTED_COLOR				= { 1.0f, 0.0f, 0.0f, 0.6f };	// ブロック選択時の色
 	const D3DXCOLOR			COLLIDER_COLOR				= { 0.0f, 1.0f, 0.3f, 1.0f };	// コライダーの色
 
-	std::shared_ptr<RigidBody>							m_pRigidBody;					// リジッドボディ
+	RigidBodyHandle										m_hRigidBody;					// リジッドボディのハンドル
 	std::shared_ptr<Collider>							m_pShape;						// コライダー
 	CDebugProc3D*										m_pDebug3D;						// 3Dデバッグ表示へのポインタ
 	D3DXCOLOR											m_col;							// アルファ値
@@ -120,6 +145,10 @@ private:
 	bool												m_isDead;						// 削除予約フラグ
 	bool												m_isEditMode;					// 編集中かどうか
 	bool												m_isDynamic;					// 動的ブロックかどうか
+	bool												m_isTrigger;					// トリガー（押し戻さない）かどうか
+	unsigned int										m_CollisionLayer;				// 当たり判定のレイヤー
+	unsigned int										m_CollisionMask;				// 当たり判定のマスク
+	std::vector<ColliderPart>							m_ColliderParts;				// 複合コライダーの子の形状
 	static std::unordered_map<TYPE, BlockCreateFunc>	m_BlockFactoryMap;				// ファクトリー
 	TYPE												m_Type;							// 種類
 
@@ -10,6 +10,7 @@
 //*****************************************************************************
 #include "BlockList.h"
 #include "Collider.h"
+#include "Manager.h"
 
 namespace ColliderParam
 {
@@ -57,3 +58,51 @@ std::shared_ptr<Collider> CCapsuleBlock::CreateCollisionShape(const D3DXVECTOR3&
 	// カプセルコライダー
 	return std::make_shared <CapsuleCollider>(Capsule::RADIUS, Capsule::HEIGHT);
 }
+//=============================================================================
+// メッシュブロックのコリジョン生成処理
+//=============================================================================
+std::shared_ptr<Collider> CMeshBlock::CreateCollisionShape(const D3DXVECTOR3& size)
+{
+	// 同じモデルのブロックで三角形を共有する
+	std::shared_ptr<const TriangleShape> shape = CManager::GetCollisionCache()->GetMesh(GetPath(), GetMesh());
+
+	if (!shape)
+	{// 三角形が取れなければ箱で代用
+		return CBlock::CreateCollisionShape(size);
+	}
+
+	// メッシュコライダー
+	return std::make_shared <MeshCollider>(shape);
+}
+//=============================================================================
+// 地形ブロックのコリジョン生成処理
+//=============================================================================
+std::shared_ptr<Collider> CTerrainBlock::CreateCollisionShape(const D3DXVECTOR3& size)
+{
+	// 同じモデルのブロックで高さの格子を共有する
+	std::shared_ptr<const TriangleShape> shape = CManager::GetCollisionCache()->GetHeightfield(GetPath(), GetMesh());
+
+	if (!shape)
+	{// 高さが取れなければ箱で代用
+		return CBlock::CreateCollisionShape(size);
+	}
+
+	// メッシュコライダー（高さの格子も同じコライダーで扱う）
+	return std::make_shared <MeshCollider>(shape);
+}
+//=============================================================================
+// 凸包ブロックのコリジョン生成処理
+//=============================================================================
+std::shared_ptr<Collider> CConvexBlock::CreateCollisionShape(const D3DXVECTOR3& size)
+{
+	// 同じモデルのブロックで凸包を共有する
+	std::shared_ptr<const ConvexHullShape> shape = CManager::GetCollisionCache()->GetConvexHull(GetPath(), GetMesh());
+
+	if (!shape)
+	{// 凸包が作れなければ箱で代用
+		return CBlock::CreateCollisionShape(size);
+	}
+
+	// 凸包コライダー
+	return std::make_shared <ConvexCollider>(shape);
+}
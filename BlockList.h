@@ -91,5 +91,47 @@ private:
 
 };
 
+//*****************************************************************************
+// メッシュブロッククラス（モデルの三角形そのままの静的な当たり判定）
+//*****************************************************************************
+class CMeshBlock : public CBlock
+{
+public:
+
+	// コライダー
+	std::shared_ptr<Collider> CreateCollisionShape(const D3DXVECTOR3& size) override;
+
+	bool IsDynamicBlock(void) const override { return false; }	// 三角形の集まりは動かさない
+};
+
+//*****************************************************************************
+// 地形ブロッククラス（モデルを見下ろした高さの格子の静的な当たり判定）
+//*****************************************************************************
+class CTerrainBlock : public CBlock
+{
+public:
+
+	// コライダー
+	std::shared_ptr<Collider> CreateCollisionShape(const D3DXVECTOR3& size) override;
+
+	bool IsDynamicBlock(void) const override { return false; }	// 三角形の集まりは動かさない
+};
+
+//*****************************************************************************
+// 凸包ブロッククラス（モデルの頂点を包んだ凸包で転がる当たり判定）
+//*****************************************************************************
+class CConvexBlock : public CBlock
+{
+public:
+
+	// コライダー
+	std::shared_ptr<Collider> CreateCollisionShape(const D3DXVECTOR3& size) override;
+
+	float GetMass(void) const override { return MASS; }  // 質量の取得
+
+private:
+	static constexpr float MASS = 4.0f;// 質量
+};
+
 #endif
 
@@ -16,6 +16,7 @@
 #include "RayCast.h"
 #include "Edit.h"
 #include "RigidBody.h"
+#include "algorithm"
 
 // JSONの使用
 using json = nlohmann::json;
@@ -27,6 +28,7 @@ std::vector<CBlock*> CBlockManager::m_blocks = {};	// ブロックの情報
 int CBlockManager::m_selectedIdx = 0;				// 選択中のインデックス
 CBlock* CBlockManager::m_draggingBlock = {};
 CBlock* CBlockManager::m_selectedBlock = {};
+bool CBlockManager::m_isPlaying = false;
 std::unordered_map<CBlock::TYPE, std::string> CBlockManager::s_FilePathMap; 
 
 //=============================================================================
@@ -58,14 +60,17 @@ std::unique_ptr<CBlockManager> CBlockManager::Create(void)
 //=============================================================================
 // 生成処理
 //=============================================================================
-CBlock* CBlockManager::CreateBlock(CBlock::TYPE type, D3DXVECTOR3 pos, bool isDynamic)
+CBlock* CBlockManager::CreateBlock(CBlock::TYPE type, D3DXVECTOR3 pos, bool isDynamic, bool isCreatePhysics)
 {
 	const char* path = CBlockManager::GetFilePathFromType(type);
 
-	CBlock* newBlock = CBlock::Create(path, pos, D3DXVECTOR3(0, 0, 0), D3DXVECTOR3(1, 1, 1), type, isDynamic);
+	CBlock* newBlock = CBlock::Create(path, pos, D3DXVECTOR3(0, 0, 0), D3DXVECTOR3(1, 1, 1), type, isDynamic, isCreatePhysics);
 
 	if (newBlock)
 	{
+		// 編集中に置いたブロックは再生するまで動かさない
+		newBlock->SetEditMode(!m_isPlaying);
+
 		m_blocks.push_back(newBlock);
 	}
 
@@ -301,15 +306,22 @@ void CBlockManager::Uninit(void)
 //=============================================================================
 void CBlockManager::CleanupDeadBlocks(void)
 {
-	for (int nCnt = (int)m_blocks.size() - 1; nCnt >= 0; nCnt--)
-	{
-		if (m_blocks[nCnt]->IsDead())
+	// 1個ずつeraseすると後ろを毎回詰め直すので、まとめて詰める
+	auto itEnd = std::remove_if(m_blocks.begin(), m_blocks.end(),
+		[](CBlock* block)
 		{
+			if (!block->IsDead())
+			{
+				return false;
+			}
+
 			// ブロックの終了処理
-			m_blocks[nCnt]->Uninit();
-			m_blocks.erase(m_blocks.begin() + nCnt);
-		}
-	}
+			block->Uninit();
+
+			return true;
+		});
+
+	m_blocks.erase(itEnd, m_blocks.end());
 }
 //=============================================================================
 // 更新処理
@@ -430,7 +442,7 @@ void CBlockManager::UpdateInfo(void)
 			// マウスの取得
 			CInputMouse* pMouse = CManager::GetInputMouse();
 
-			if (ImGui::IsMouseReleased(ImGuiMouseButton_Left) && m_isDragging)
+			if (ImGui::IsMouseReleased(ImGuiMouseButton_Left) && m_isDragging && !m_isPlaying)
 			{
 				// 現在のImGuiの内部状態（コンテキスト）へのポインターを取得
 				ImGuiContext* ctx = ImGui::GetCurrentContext();
@@ -464,7 +476,10 @@ void CBlockManager::UpdateInfo(void)
 
 	ImGui::Dummy(ImVec2(0.0f, 10.0f)); // 空白を空ける
 
-	if (ImGui::Button("Save") || (pKeyboard->GetPress(DIK_LCONTROL) && pKeyboard->GetPress(DIK_S)))
+	// 再生中は動いた後の位置を保存・上書きしない
+	ImGui::BeginDisabled(m_isPlaying);
+
+	if (ImGui::Button("Save") || (!m_isPlaying && pKeyboard->GetPress(DIK_LCONTROL) && pKeyboard->GetPress(DIK_S)))
 	{
 		// ダイアログを開いてファイルに保存
 		std::string path = OpenWindowsSaveFileDialog();
@@ -490,6 +505,8 @@ void CBlockManager::UpdateInfo(void)
 		}
 	}
 
+	ImGui::EndDisabled();
+
 	ImGui::End();
 
 	// マウス選択処理
@@ -519,6 +536,9 @@ void CBlockManager::UpdateTransform(CBlock* selectedBlock)
 			m_initializedDegRot = true;
 		}
 
+		// 再生中は見るだけ（剛体の並びや設定が変わると停止で元に戻せない）
+		ImGui::BeginDisabled(m_isPlaying);
+
 		// 編集中は動的か静的か設定
 		bool isDynamic = selectedBlock->IsDynamicBlock(); // 現在の状態を取得
 
@@ -629,6 +649,37 @@ void CBlockManager::UpdateTransform(CBlock* selectedBlock)
 		ImGui::SameLine();
 		ImGui::DragFloat("##Mass", &mass, 1.0f, 0.0f, 50.0f, "%.1f");
 
+		//*********************************************************************
+		// 当たり判定のレイヤー・マスク
+		//*********************************************************************
+
+		ImGui::Dummy(ImVec2(0.0f, 10.0f)); // 空白を空ける
+
+		// トリガーは重なりを知らせるだけで押し戻さない
+		bool isTrigger = selectedBlock->IsTrigger();
+
+		if (ImGui::Checkbox("is Trigger", &isTrigger))
+		{
+			selectedBlock->SetTrigger(isTrigger);
+		}
+
+		// お互いのマスクに相手のレイヤーのビットが入っている組だけ当たる（16進数で入力）
+		unsigned int layer = selectedBlock->GetCollisionLayer();
+		unsigned int mask = selectedBlock->GetCollisionMask();
+
+		ImGui::Text("Layer:"); ImGui::SameLine(60);
+		ImGui::SetNextItemWidth(100);
+		bool changedLayer = ImGui::InputScalar("##Block_layer", ImGuiDataType_U32, &layer, nullptr, nullptr, "%08X", ImGuiInputTextFlags_CharsHexadecimal);
+
+		ImGui::Text("Mask:"); ImGui::SameLine(60);
+		ImGui::SetNextItemWidth(100);
+		bool changedMask = ImGui::InputScalar("##Block_mask", ImGuiDataType_U32, &mask, nullptr, nullptr, "%08X", ImGuiInputTextFlags_CharsHexadecimal);
+
+		if (changedLayer || changedMask)
+		{
+			selectedBlock->SetCollisionFilter(layer, mask);
+		}
+
 		// 角度→ラジアンに戻す
 		D3DXVECTOR3 rotRad = D3DXToRadian(degRot);
 
@@ -693,6 +744,8 @@ void CBlockManager::UpdateTransform(CBlock* selectedBlock)
 		}
 
 		ImGui::PopStyleColor(3);
+
+		ImGui::EndDisabled();
 	}
 
 	// 最後に保存
@@ -719,38 +772,29 @@ void CBlockManager::PickBlockFromMouseClick(void)
 	D3DXVECTOR3 rayOrigin, rayDir;
 	CRayCast::GetMouseRay(rayOrigin, rayDir);
 
-	float minDist = FLT_MAX;
-	int hitIndex = -1;
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
 
-	for (size_t i = 0; i < m_blocks.size(); ++i)
+	if (pWorld == nullptr)
 	{
-		CBlock* block = m_blocks[i];
-
-		// ワールド行列の取得（位置・回転・拡大を含む）
-		D3DXMATRIX world = block->GetWorldMatrix();
-
-		D3DXVECTOR3 modelSize = block->GetModelSize();
-		D3DXVECTOR3 scale = block->GetSize();
+		return;
+	}
 
-		// 拡大率を適用
-		D3DXVECTOR3 halfSize;
-		halfSize.x = modelSize.x * 0.5f;
-		halfSize.y = modelSize.y * 0.5f;
-		halfSize.z = modelSize.z * 0.5f;
+	// 物理ワールドのBVHで一番近い剛体を探す（トリガーのブロックも選べるようにする）
+	QueryFilter filter;
+	filter.isHitTriggers = true;
 
-		float dist = 0.0f;
+	QueryHit hit;
 
-		// OBBとマウスのレイの交差判定
-		if (CRayCast::IntersectOBB(rayOrigin, rayDir, world, halfSize, dist))
-		{
-			if (dist < minDist)
-			{
-				minDist = dist;
-				hitIndex = i;
-			}
-		}
+	if (!pWorld->RayCast(rayOrigin, rayDir, PICK_DISTANCE, hit, filter))
+	{
+		return;
 	}
 
+	// 剛体の持ち主からブロックの番号に戻す
+	CBlock* pHitBlock = static_cast<CBlock*>(hit.body->GetUserData());
+	auto it = std::find(m_blocks.begin(), m_blocks.end(), pHitBlock);
+	int hitIndex = (it != m_blocks.end()) ? (int)(it - m_blocks.begin()) : -1;
+
 	// 選択状態を反映
 	if (hitIndex >= 0)
 	{
@@ -781,6 +825,7 @@ void CBlockManager::SaveToJson(const char* filename)
 {
 	// JSONオブジェクト
 	json j;
+	json blocks = json::array();
 
 	// 1つづつJSON化
 	for (const auto& block : m_blocks)
@@ -789,9 +834,16 @@ void CBlockManager::SaveToJson(const char* filename)
 		block->SaveToJson(b);
 
 		// 追加
-		j.push_back(b);
+		blocks.push_back(b);
 	}
 
+	// ステージに合うブロードフェーズも一緒に残す
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
+	Broadphase::TYPE broadphase = pWorld ? pWorld->GetBroadphaseType() : Broadphase::DYNAMIC_AABB_TREE;
+
+	j["broadphase"] = Broadphase::GetTypeName(broadphase);
+	j["blocks"] = blocks;
+
 	// 出力ファイルストリーム
 	std::ofstream file(filename);
 
@@ -821,7 +873,32 @@ void CBlockManager::LoadFromJson(const char* filename)
 	// ファイルを閉じる
 	file.close();
 
-	// 既存のブロックを消す
+	// 以前の形式（ブロックの配列だけ）も読めるようにする
+	const json& blockList = j.is_array() ? j : j["blocks"];
+
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
+
+	// 既存のブロックの剛体をまとめて消す（プレイヤー等の剛体は残す）
+	std::vector<RigidBodyHandle> handles;
+	handles.reserve(m_blocks.size());
+
+	for (auto block : m_blocks)
+	{
+		if (block != nullptr)
+		{
+			handles.push_back(block->GetRigidBodyHandle());
+		}
+	}
+
+	if (pWorld)
+	{
+		pWorld->RemoveRigidBodies(handles.data(), (int)handles.size());
+
+		// 残っているプレイヤー等の剛体ごとステージのブロードフェーズに移す
+		pWorld->SetBroadphase(GetBroadphaseType(j));
+	}
+
+	// 既存のブロックを消す（剛体は消えているので個別の削除は素通りする）
 	for (auto block : m_blocks)
 	{
 		if (block != nullptr)
@@ -833,16 +910,20 @@ void CBlockManager::LoadFromJson(const char* filename)
 
 	// 動的配列を空にする (サイズを0にする)
 	m_blocks.clear();
-	
-	// 新たに生成
-	for (const auto& b : j)
+	m_blocks.reserve(blockList.size());
+
+	std::vector<RigidBodyDesc> descs;
+	descs.reserve(blockList.size());
+
+	// 新たに生成（剛体は配置が決まってからまとめて作る）
+	for (const auto& b : blockList)
 	{
 		CBlock::TYPE type = b["type"];
 		D3DXVECTOR3 pos(b["pos"][0], b["pos"][1], b["pos"][2]);
 		bool isDynamic = b["is_dynamic"];
 
 		// ブロックの生成
-		CBlock* block = CreateBlock(type, pos, isDynamic);
+		CBlock* block = CreateBlock(type, pos, isDynamic, false);
 
 		if (!block)
 		{
@@ -850,9 +931,58 @@ void CBlockManager::LoadFromJson(const char* filename)
 		}
 
 		block->LoadFromJson(b);
+
+		// モデルの元サイズで作り、大きさは剛体の拡大率で持たせる
+		descs.push_back(block->PreparePhysics(block->GetModelSize()));
+	}
+
+	if (!pWorld)
+	{
+		return;
+	}
+
+	handles.resize(descs.size());
+	pWorld->CreateRigidBodies(descs.data(), (int)descs.size(), handles.data());
+
+	for (size_t nCnt = 0; nCnt < m_blocks.size(); nCnt++)
+	{
+		m_blocks[nCnt]->AttachRigidBody(handles[nCnt], m_blocks[nCnt]->GetPos());
 	}
 }
 //=============================================================================
+// ステージのブロードフェーズの読み込み処理
+//=============================================================================
+Broadphase::TYPE CBlockManager::LoadBroadphaseType(const char* filename)
+{
+	std::ifstream file(filename);
+
+	if (!file.is_open())
+	{// 開けなかった
+		return Broadphase::DYNAMIC_AABB_TREE;
+	}
+
+	json j;
+	file >> j;
+
+	// ファイルを閉じる
+	file.close();
+
+	return GetBroadphaseType(j);
+}
+//=============================================================================
+// JSONからブロードフェーズの種類を取得
+//=============================================================================
+Broadphase::TYPE CBlockManager::GetBroadphaseType(const json& j)
+{
+	// 指定がない・知らない名前ならエディターの既定（動的AABBツリー）
+	if (!j.is_object() || !j.contains("broadphase") || !j["broadphase"].is_string())
+	{
+		return Broadphase::DYNAMIC_AABB_TREE;
+	}
+
+	return Broadphase::FindType(j["broadphase"].get<std::string>(), Broadphase::DYNAMIC_AABB_TREE);
+}
+//=============================================================================
 // モデルリストの読み込み
 //=============================================================================
 void CBlockManager::LoadConfig(const std::string& filename)
@@ -889,6 +1019,19 @@ void CBlockManager::UpdateLight(void)
 	}
 }
 //=============================================================================
+// 再生中の切り替え処理
+//=============================================================================
+void CBlockManager::SetPlaying(bool isPlaying)
+{
+	m_isPlaying = isPlaying;
+
+	// 編集中のブロックは剛体を自分の位置に合わせる（動的ブロックも落ちない）
+	for (auto block : m_blocks)
+	{
+		block->SetEditMode(!isPlaying);
+	}
+}
+//=============================================================================
 // 全ブロックの取得
 //=============================================================================
 std::vector<CBlock*>& CBlockManager::GetAllBlocks(void)
@@ -23,7 +23,7 @@ public:
 	~CBlockManager();
 
     static std::unique_ptr<CBlockManager>Create(void);// ユニークポインタの生成
-    static CBlock* CreateBlock(CBlock::TYPE type, D3DXVECTOR3 pos, bool isDynamic);
+    static CBlock* CreateBlock(CBlock::TYPE type, D3DXVECTOR3 pos, bool isDynamic, bool isCreatePhysics = true);
     void Init(void);
     void Uninit(void);// 終了処理
     void CleanupDeadBlocks(void);// 削除予約があるブロックの削除
@@ -32,8 +32,10 @@ public:
     void UpdateInfo(void); // ImGuiでの操作関数をここで呼ぶ用
     void SaveToJson(const char* filename);
     void LoadFromJson(const char* filename);
+    static Broadphase::TYPE LoadBroadphaseType(const char* filename);// ステージが使うブロードフェーズだけを読む（ワールドを作る前に呼ぶ）
     void LoadConfig(const std::string& filename);
     void UpdateLight(void);
+    void SetPlaying(bool isPlaying);// 再生中の切り替え（編集中は動的ブロックも置いた位置に止める）
 
     //*****************************************************************************
     // ImGuiサムネイル描画用関数
@@ -56,13 +58,16 @@ public:
     //*****************************************************************************
     static std::vector<CBlock*>& GetAllBlocks(void);
     static CBlock* GetSelectedBlock(void) { return m_selectedBlock; }
+    static bool IsPlaying(void) { return m_isPlaying; }
 
 private:
     static const char* GetFilePathFromType(CBlock::TYPE type);
+    static Broadphase::TYPE GetBroadphaseType(const json& j);
 
 private:
     static constexpr float THUMB_WIDTH = 100.0f;// サムネイルの高さ
     static constexpr float THUMB_HEIGHT = 100.0f;// サムネイルの高さ
+    static constexpr float PICK_DISTANCE = 100000.0f;// クリックで選べる最大の距離
 
     //*****************************************************************************
     // ブロック管理
@@ -71,6 +76,7 @@ private:
     static CBlock*              m_draggingBlock;        // ドラッグ中のブロック情報
     static CBlock*              m_selectedBlock;        // 選択中のブロック
     static int                  m_selectedIdx;          // 選択中のインデックス
+    static bool                 m_isPlaying;            // 再生中か（ブロックの追加・削除・編集はできない）
     int                         m_prevSelectedIdx;      // 前回の選択中のインデックス
     bool                        m_isDragging;           // ドラッグ中か
 
@@ -0,0 +1,59 @@
+//=============================================================================
+//
+// ブロードフェーズ処理 [Broadphase.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "Broadphase.h"
+#include "SweepAndPrune.h"
+#include "DynamicAABBTree.h"
+
+//=============================================================================
+// 生成処理
+//=============================================================================
+std::unique_ptr<Broadphase> Broadphase::Create(TYPE type)
+{
+    switch (type)
+    {
+    case DYNAMIC_AABB_TREE:
+        return std::make_unique<DynamicAABBTree>();
+
+    case SWEEP_AND_PRUNE:
+    default:
+        return std::make_unique<SweepAndPrune>();
+    }
+}
+//=============================================================================
+// 種類の名前の取得処理
+//=============================================================================
+const char* Broadphase::GetTypeName(TYPE type)
+{
+    switch (type)
+    {
+    case DYNAMIC_AABB_TREE:
+        return "aabb_tree";
+
+    case SWEEP_AND_PRUNE:
+    default:
+        return "sweep_and_prune";
+    }
+}
+//=============================================================================
+// 名前から種類を探す処理
+//=============================================================================
+Broadphase::TYPE Broadphase::FindType(const std::string& name, TYPE fallback)
+{
+    for (TYPE type : { SWEEP_AND_PRUNE, DYNAMIC_AABB_TREE })
+    {
+        if (name == GetTypeName(type))
+        {
+            return type;
+        }
+    }
+
+    return fallback;
+}
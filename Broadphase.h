@@ -0,0 +1,72 @@
+//=============================================================================
+//
+// ブロードフェーズ処理 [Broadphase.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _BROADPHASE_H_// このマクロ定義がされていなかったら
+#define _BROADPHASE_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "Collider.h"
+
+//*****************************************************************************
+// 前方宣言
+//*****************************************************************************
+class RigidBody;
+
+//*****************************************************************************
+// 衝突候補ペア
+//*****************************************************************************
+struct BroadphasePair
+{
+    RigidBody* a;   // 剛体A（プロキシ番号が小さい方）
+    RigidBody* b;   // 剛体B
+};
+
+//=============================================================================
+// ブロードフェーズ基底クラス
+//=============================================================================
+class Broadphase
+{
+public:
+    enum TYPE
+    {
+        SWEEP_AND_PRUNE,    // スイープ＆プルーン
+        DYNAMIC_AABB_TREE   // 動的AABBツリー
+    };
+
+    Broadphase(TYPE type) : m_Type(type) {}
+    virtual ~Broadphase() {}
+
+    static std::unique_ptr<Broadphase> Create(TYPE type);
+
+    // ステージのJSONに書く名前との変換（知らない名前ならfallbackを返す）
+    static const char* GetTypeName(TYPE type);
+    static TYPE FindType(const std::string& name, TYPE fallback);
+
+    virtual int CreateProxy(RigidBody* body) = 0;
+    virtual void DestroyProxy(int proxyId) = 0;
+
+    // 剛体が動いたときにAABBを更新する（motionは1ステップの移動量、高速な剛体は進む向きに伸ばす）
+    virtual void MoveProxy(int proxyId, const D3DXVECTOR3& motion) = 0;
+
+    // 重なっているペアを収集
+    virtual void UpdatePairs(std::vector<BroadphasePair>& outPairs) = 0;
+
+    // boxと重なるプロキシの剛体をoutに追加する
+    virtual void QueryAABB(const AABB& box, std::vector<RigidBody*>& out) const = 0;
+
+    // 原点からdir（正規化済み）に進むレイに当たるプロキシの剛体を近い順にfuncへ渡す（AABBはextentだけ太らせる）
+    virtual void QueryRay(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, const D3DXVECTOR3& extent, const RayQueryFunc& func) const = 0;
+
+    virtual int GetProxyCount(void) const = 0;
+    TYPE GetType(void) const { return m_Type; }
+
+private:
+    TYPE m_Type;
+};
+
+#endif
@@ -9,6 +9,26 @@
 // インクルードファイル
 //*****************************************************************************
 #include "Collider.h"
+#include "TriangleShape.h"
+
+//=============================================================================
+// AABBを行列で変換して囲み直す処理（中心と半分の大きさを回転・拡大の絶対値で広げる）
+//=============================================================================
+static AABB TransformAABB(const AABB& box, const D3DXMATRIX& M)
+{
+    D3DXVECTOR3 center = (box.min + box.max) * 0.5f;
+    D3DXVECTOR3 half = (box.max - box.min) * 0.5f;
+
+    D3DXVECTOR3 newCenter;
+    D3DXVec3TransformCoord(&newCenter, &center, &M);
+
+    D3DXVECTOR3 extent(
+        half.x * fabsf(M._11) + half.y * fabsf(M._21) + half.z * fabsf(M._31),
+        half.x * fabsf(M._12) + half.y * fabsf(M._22) + half.z * fabsf(M._32),
+        half.x * fabsf(M._13) + half.y * fabsf(M._23) + half.z * fabsf(M._33));
+
+    return { newCenter - extent, newCenter + extent };
+}
 
 
 //=============================================================================
@@ -44,6 +64,22 @@ void BoxCollider::calculateLocalInertia(float mass, D3DXVECTOR3& inertia) const
     inertia.y = (1.0f / 12.0f) * mass * (s.x * s.x + s.z * s.z);
     inertia.z = (1.0f / 12.0f) * mass * (s.x * s.x + s.y * s.y);
 }
+//=============================================================================
+// ボックスコライダー(OBB)のAABB取得処理
+//=============================================================================
+AABB BoxCollider::GetAABB(void) const
+{
+    D3DXVECTOR3 h = m_ScaledSize * 0.5f;
+    const D3DXMATRIX& R = m_Rotation;
+
+    // 各ローカル軸をワールド軸へ投影した長さの合計
+    D3DXVECTOR3 extent(
+        h.x * fabsf(R._11) + h.y * fabsf(R._21) + h.z * fabsf(R._31),
+        h.x * fabsf(R._12) + h.y * fabsf(R._22) + h.z * fabsf(R._32),
+        h.x * fabsf(R._13) + h.y * fabsf(R._23) + h.z * fabsf(R._33));
+
+    return { m_Position - extent, m_Position + extent };
+}
 
 
 //=============================================================================
@@ -85,6 +121,16 @@ void CapsuleCollider::calculateLocalInertia(float mass, D3DXVECTOR3& inertia) co
     inertia.y = HALF * mass * r * r;
     inertia.x = inertia.z = (1.0f / 12.0f) * mass * (3.0f * r * r + h * h);
 }
+//=============================================================================
+// カプセルコライダーのAABB取得処理
+//=============================================================================
+AABB CapsuleCollider::GetAABB(void) const
+{
+    // 判定はY軸固定の線分 + 半径で行っているのでそれに合わせる
+    D3DXVECTOR3 extent(m_Radius, m_Height * HALF + m_Radius, m_Radius);
+
+    return { m_Position - extent, m_Position + extent };
+}
 
 
 //=============================================================================
@@ -111,6 +157,16 @@ void CylinderCollider::calculateLocalInertia(float mass, D3DXVECTOR3& inertia) c
     inertia.y = 0.5f * mass * r * r;          // 軸方向
     inertia.x = inertia.z = (1.0f / 12.0f) * mass * (3.0f * r * r + h * h); // 横
 }
+//=============================================================================
+// シリンダーコライダーのAABB取得処理
+//=============================================================================
+AABB CylinderCollider::GetAABB(void) const
+{
+    // カプセル扱いの判定もあるので上下は半径分余裕を持たせる
+    D3DXVECTOR3 extent(m_RadiusScaled, m_HeightScaled * HALF + m_RadiusScaled, m_RadiusScaled);
+
+    return { m_Position - extent, m_Position + extent };
+}
 
 
 //=============================================================================
@@ -142,3 +198,439 @@ void SphereCollider::calculateLocalInertia(float mass, D3DXVECTOR3& inertia) con
     float I = (2.0f / 5.0f) * mass * m_ScaledRadius * m_ScaledRadius;
     inertia = D3DXVECTOR3(I, I, I);
 }
+//=============================================================================
+// スフィアコライダーのAABB取得処理
+//=============================================================================
+AABB SphereCollider::GetAABB(void) const
+{
+    D3DXVECTOR3 extent(m_ScaledRadius, m_ScaledRadius, m_ScaledRadius);
+
+    return { m_Position - extent, m_Position + extent };
+}
+
+
+//=============================================================================
+// メッシュコライダーのコンストラクタ
+//=============================================================================
+MeshCollider::MeshCollider(std::shared_ptr<const TriangleShape> shape)
+    : Collider(MESH), m_pShape(std::move(shape)), m_isFlipped(false)
+{
+    D3DXMatrixIdentity(&m_World);
+    D3DXMatrixIdentity(&m_InvWorld);
+    m_Position = INIT_VEC3;
+    m_WorldBounds = m_pShape ? m_pShape->GetBounds() : AABB{ INIT_VEC3, INIT_VEC3 };
+}
+//=============================================================================
+// メッシュコライダーのトランスフォーム処理（描画と同じ 拡大→回転→移動 の順）
+//=============================================================================
+void MeshCollider::UpdateTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale)
+{
+    m_Position = pos;
+
+    auto clampScale = [](float s) { return (fabsf(s) < MIN_SCALE) ? (s < 0.0f ? -MIN_SCALE : MIN_SCALE) : s; };
+
+    D3DXMATRIX mtxScale, mtxRot, mtxTrans;
+    D3DXMatrixScaling(&mtxScale, clampScale(scale.x), clampScale(scale.y), clampScale(scale.z));
+    D3DXMatrixRotationQuaternion(&mtxRot, &rot);
+    D3DXMatrixTranslation(&mtxTrans, pos.x, pos.y, pos.z);
+
+    m_World = mtxScale * mtxRot * mtxTrans;
+    D3DXMatrixInverse(&m_InvWorld, nullptr, &m_World);
+
+    // 奇数個の軸が裏返っていれば外積の向きも逆になる
+    m_isFlipped = ((scale.x < 0.0f) != (scale.y < 0.0f)) != (scale.z < 0.0f);
+
+    m_WorldBounds = m_pShape ? TransformAABB(m_pShape->GetBounds(), m_World) : AABB{ pos, pos };
+}
+//=============================================================================
+// メッシュコライダーの三角形の範囲検索処理（ワールドのboxをローカルで囲み直して絞る）
+//=============================================================================
+void MeshCollider::QueryTriangles(const AABB& box, std::vector<int>& out) const
+{
+    if (!m_pShape || !m_WorldBounds.Overlaps(box))
+    {
+        return;
+    }
+
+    m_pShape->QueryTriangles(TransformAABB(box, m_InvWorld), out);
+}
+//=============================================================================
+// メッシュコライダーの三角形の取得処理
+//=============================================================================
+void MeshCollider::GetTriangle(int index, D3DXVECTOR3* outVertices, D3DXVECTOR3& outNormal, int* outVertexIds) const
+{
+    D3DXVECTOR3 local[3];
+    m_pShape->GetTriangle(index, local, outVertexIds);
+
+    for (int nVtx = 0; nVtx < 3; nVtx++)
+    {
+        D3DXVec3TransformCoord(&outVertices[nVtx], &local[nVtx], &m_World);
+    }
+
+    D3DXVECTOR3 e1 = outVertices[1] - outVertices[0];
+    D3DXVECTOR3 e2 = outVertices[2] - outVertices[0];
+    D3DXVec3Cross(&outNormal, &e1, &e2);
+    D3DXVec3Normalize(&outNormal, &outNormal);
+
+    if (m_isFlipped)
+    {
+        outNormal = -outNormal;
+    }
+}
+//=============================================================================
+// メッシュコライダーのレイの判定処理（レイをローカルへ変換する。向きを正規化しないので距離はそのまま使える）
+//=============================================================================
+bool MeshCollider::RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, D3DXVECTOR3& outNormal) const
+{
+    if (!m_pShape)
+    {
+        return false;
+    }
+
+    D3DXVECTOR3 localOrigin, localDir;
+    D3DXVec3TransformCoord(&localOrigin, &origin, &m_InvWorld);
+    D3DXVec3TransformNormal(&localDir, &dir, &m_InvWorld);
+
+    int triangle = 0;
+
+    if (!m_pShape->RayCast(localOrigin, localDir, maxDist, outDist, triangle))
+    {
+        return false;
+    }
+
+    D3DXVECTOR3 vertices[3];
+    GetTriangle(triangle, vertices, outNormal);
+
+    return true;
+}
+//=============================================================================
+// メッシュコライダーの三角形数の取得処理
+//=============================================================================
+int MeshCollider::GetTriangleCount(void) const
+{
+    return m_pShape ? m_pShape->GetTriangleCount() : 0;
+}
+
+
+//=============================================================================
+// 複合コライダーの子の追加処理（今の剛体の姿勢がまだ無いので原点に置いた位置で子を合わせておく）
+//=============================================================================
+bool CompoundCollider::AddChild(std::shared_ptr<Collider> child, const D3DXVECTOR3& localPos, const D3DXQUATERNION& localRot)
+{
+    // 入れ子と三角形は子の判定の振り分けに入れないので受け付けない
+    if (!child || child->GetType() == COMPOUND || child->GetType() == MESH)
+    {
+        return false;
+    }
+
+    m_Children.push_back({ std::move(child), localPos, localRot });
+
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+    UpdateTransform(m_Position, identity, m_Scale);
+
+    return true;
+}
+//=============================================================================
+// 複合コライダーのトランスフォーム処理
+//=============================================================================
+void CompoundCollider::UpdateTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale)
+{
+    m_Position = pos;
+    m_Scale = scale;
+
+    D3DXMATRIX mtxRot;
+    D3DXMatrixRotationQuaternion(&mtxRot, &rot);
+
+    for (size_t nCnt = 0; nCnt < m_Children.size(); nCnt++)
+    {
+        Child& child = m_Children[nCnt];
+
+        // オフセット → 拡大 → 剛体の回転 → 剛体の位置
+        D3DXVECTOR3 offset(child.localPos.x * scale.x, child.localPos.y * scale.y, child.localPos.z * scale.z);
+        D3DXVECTOR3 worldOffset;
+        D3DXVec3TransformNormal(&worldOffset, &offset, &mtxRot);
+
+        // 子の回転の後に剛体の回転
+        D3DXQUATERNION worldRot;
+        D3DXQuaternionMultiply(&worldRot, &child.localRot, &rot);
+
+        child.shape->UpdateTransform(pos + worldOffset, worldRot, scale);
+
+        if (nCnt == 0)
+        {
+            m_Bounds = child.shape->GetAABB();
+        }
+        else
+        {
+            m_Bounds.Merge(child.shape->GetAABB());
+        }
+    }
+
+    if (m_Children.empty())
+    {
+        m_Bounds = { pos, pos };
+    }
+}
+//=============================================================================
+// 複合コライダーの慣性計算処理（子の回転による軸の傾きは無視して対角成分だけ足す）
+//=============================================================================
+void CompoundCollider::calculateLocalInertia(float mass, D3DXVECTOR3& inertia) const
+{
+    inertia = INIT_VEC3;
+
+    if (mass <= 0.0f || m_Children.empty())
+    {
+        return;
+    }
+
+    float totalVolume = 0.0f;
+
+    for (const Child& child : m_Children)
+    {
+        totalVolume += GetVolume(child.shape.get());
+    }
+
+    for (const Child& child : m_Children)
+    {
+        // 体積が取れなければ子の数で等分する
+        float childMass = (totalVolume > 0.0f) ?
+            mass * GetVolume(child.shape.get()) / totalVolume :
+            mass / (float)m_Children.size();
+
+        D3DXVECTOR3 childInertia;
+        child.shape->calculateLocalInertia(childMass, childInertia);
+
+        // 平行軸の定理（原点からのずれの分だけ回しにくくなる）
+        D3DXVECTOR3 d(child.localPos.x * m_Scale.x, child.localPos.y * m_Scale.y, child.localPos.z * m_Scale.z);
+        inertia.x += childInertia.x + childMass * (d.y * d.y + d.z * d.z);
+        inertia.y += childInertia.y + childMass * (d.x * d.x + d.z * d.z);
+        inertia.z += childInertia.z + childMass * (d.x * d.x + d.y * d.y);
+    }
+}
+//=============================================================================
+// 子の形状の体積の取得処理（質量の配分用）
+//=============================================================================
+float CompoundCollider::GetVolume(const Collider* shape)
+{
+    switch (shape->GetType())
+    {
+    case BOX:
+    {
+        const D3DXVECTOR3& size = static_cast<const BoxCollider*>(shape)->GetScaledSize();
+        return fabsf(size.x * size.y * size.z);
+    }
+    case CAPSULE:
+    {
+        const CapsuleCollider* capsule = static_cast<const CapsuleCollider*>(shape);
+        float r = capsule->GetRadius();
+        return D3DX_PI * r * r * (capsule->GetHeight() + r * 4.0f / 3.0f);
+    }
+    case CYLINDER:
+    {
+        const CylinderCollider* cylinder = static_cast<const CylinderCollider*>(shape);
+        float r = cylinder->GetRadius();
+        return D3DX_PI * r * r * cylinder->GetHeight();
+    }
+    case SPHERE:
+    {
+        float r = static_cast<const SphereCollider*>(shape)->GetRadius();
+        return D3DX_PI * r * r * r * 4.0f / 3.0f;
+    }
+    case CONVEX:
+        return static_cast<const ConvexCollider*>(shape)->GetVolume();
+    default:
+        return 0.0f;
+    }
+}
+
+
+//=============================================================================
+// 凸包コライダーのコンストラクタ
+//=============================================================================
+ConvexCollider::ConvexCollider(std::shared_ptr<const ConvexHullShape> shape)
+    : Collider(CONVEX), m_pShape(std::move(shape)), m_Scale(1.0f, 1.0f, 1.0f), m_InnerRadius(0.0f), m_isFlipped(false)
+{
+    m_Position = INIT_VEC3;
+    m_WorldBounds = { INIT_VEC3, INIT_VEC3 };
+
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+    UpdateTransform(m_Position, identity, m_Scale);
+}
+//=============================================================================
+// 凸包コライダーのトランスフォーム処理（頂点をワールドへ変換し、AABBと中の球を求め直す）
+//=============================================================================
+void ConvexCollider::UpdateTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale)
+{
+    m_Position = pos;
+    m_Scale = scale;
+
+    auto clampScale = [](float s) { return (fabsf(s) < MIN_SCALE) ? (s < 0.0f ? -MIN_SCALE : MIN_SCALE) : s; };
+
+    D3DXMATRIX mtxScale, mtxRot, mtxTrans;
+    D3DXMatrixScaling(&mtxScale, clampScale(scale.x), clampScale(scale.y), clampScale(scale.z));
+    D3DXMatrixRotationQuaternion(&mtxRot, &rot);
+    D3DXMatrixTranslation(&mtxTrans, pos.x, pos.y, pos.z);
+
+    m_World = mtxScale * mtxRot * mtxTrans;
+    D3DXMatrixInverse(&m_InvWorld, nullptr, &m_World);
+
+    m_isFlipped = ((scale.x < 0.0f) != (scale.y < 0.0f)) != (scale.z < 0.0f);
+
+    if (!m_pShape || m_pShape->GetVertexCount() == 0)
+    {
+        m_WorldVertices.assign(1, pos);
+        m_WorldBounds = { pos, pos };
+        m_InnerRadius = 0.0f;
+        return;
+    }
+
+    m_WorldVertices.resize(m_pShape->GetVertexCount());
+
+    for (int nCnt = 0; nCnt < m_pShape->GetVertexCount(); nCnt++)
+    {
+        D3DXVec3TransformCoord(&m_WorldVertices[nCnt], &m_pShape->GetVertex(nCnt), &m_World);
+
+        if (nCnt == 0)
+        {
+            m_WorldBounds = { m_WorldVertices[0], m_WorldVertices[0] };
+        }
+        else
+        {
+            m_WorldBounds.Merge({ m_WorldVertices[nCnt], m_WorldVertices[nCnt] });
+        }
+    }
+
+    // 原点から一番近い面までの距離（原点が外にあれば0）
+    m_InnerRadius = FLT_MAX;
+
+    for (int nTri = 0; nTri < GetTriangleCount(); nTri++)
+    {
+        D3DXVECTOR3 vertices[3], normal;
+        GetTriangle(nTri, vertices, normal);
+
+        D3DXVECTOR3 toFace = vertices[0] - pos;
+        m_InnerRadius = std::min(m_InnerRadius, D3DXVec3Dot(&normal, &toFace));
+    }
+
+    m_InnerRadius = std::max(m_InnerRadius, 0.0f);
+}
+//=============================================================================
+// 凸包コライダーの慣性計算処理
+//=============================================================================
+void ConvexCollider::calculateLocalInertia(float mass, D3DXVECTOR3& inertia) const
+{
+    if (!m_pShape)
+    {
+        inertia = INIT_VEC3;
+        return;
+    }
+
+    m_pShape->CalculateInertia(m_Scale, mass, inertia);
+}
+//=============================================================================
+// 凸包コライダーの支持点の取得処理
+//=============================================================================
+int ConvexCollider::GetSupportIndex(const D3DXVECTOR3& dir) const
+{
+    int best = 0;
+    float bestDot = D3DXVec3Dot(&m_WorldVertices[0], &dir);
+
+    for (int nCnt = 1; nCnt < (int)m_WorldVertices.size(); nCnt++)
+    {
+        float dot = D3DXVec3Dot(&m_WorldVertices[nCnt], &dir);
+
+        if (dot > bestDot)
+        {
+            bestDot = dot;
+            best = nCnt;
+        }
+    }
+
+    return best;
+}
+//=============================================================================
+// 凸包コライダーの三角形数の取得処理
+//=============================================================================
+int ConvexCollider::GetTriangleCount(void) const
+{
+    return m_pShape ? m_pShape->GetTriangleCount() : 0;
+}
+//=============================================================================
+// 凸包コライダーの三角形の取得処理
+//=============================================================================
+void ConvexCollider::GetTriangle(int index, D3DXVECTOR3* outVertices, D3DXVECTOR3& outNormal) const
+{
+    for (int nVtx = 0; nVtx < 3; nVtx++)
+    {
+        outVertices[nVtx] = m_WorldVertices[m_pShape->GetIndex(index, nVtx)];
+    }
+
+    D3DXVECTOR3 e1 = outVertices[1] - outVertices[0];
+    D3DXVECTOR3 e2 = outVertices[2] - outVertices[0];
+    D3DXVec3Cross(&outNormal, &e1, &e2);
+    D3DXVec3Normalize(&outNormal, &outNormal);
+
+    if (m_isFlipped)
+    {
+        outNormal = -outNormal;
+    }
+}
+//=============================================================================
+// 凸包コライダーのレイの判定処理（裏返っていれば三角形の表も逆なので、ワールドの面で調べる）
+//=============================================================================
+bool ConvexCollider::RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, D3DXVECTOR3& outNormal) const
+{
+    if (!m_pShape)
+    {
+        return false;
+    }
+
+    if (!m_isFlipped)
+    {
+        D3DXVECTOR3 localOrigin, localDir;
+        D3DXVec3TransformCoord(&localOrigin, &origin, &m_InvWorld);
+        D3DXVec3TransformNormal(&localDir, &dir, &m_InvWorld);
+
+        int triangle = 0;
+
+        if (!m_pShape->RayCast(localOrigin, localDir, maxDist, outDist, triangle))
+        {
+            return false;
+        }
+
+        D3DXVECTOR3 vertices[3];
+        GetTriangle(triangle, vertices, outNormal);
+
+        return true;
+    }
+
+    bool isHit = false;
+
+    for (int nTri = 0; nTri < GetTriangleCount(); nTri++)
+    {
+        D3DXVECTOR3 vertices[3], normal;
+        GetTriangle(nTri, vertices, normal);
+
+        float dist = 0.0f;
+
+        // 裏返った三角形は頂点の並びを逆にすれば表から当たる
+        if (TriangleShape::IntersectTriangle(origin, dir, vertices[0], vertices[2], vertices[1], maxDist, dist))
+        {
+            maxDist = dist;
+            outDist = dist;
+            outNormal = normal;
+            isHit = true;
+        }
+    }
+
+    return isHit;
+}
+//=============================================================================
+// 凸包コライダーの体積の取得処理
+//=============================================================================
+float ConvexCollider::GetVolume(void) const
+{
+    return m_pShape ? fabsf(m_pShape->GetVolume() * m_Scale.x * m_Scale.y * m_Scale.z) : 0.0f;
+}
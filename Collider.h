@@ -10,15 +10,95 @@
 //*****************************************************************************
 // インクルードファイル
 //*****************************************************************************
-
+#include "algorithm"
 
 //*****************************************************************************
 // 前方宣言
 //*****************************************************************************
+class RigidBody;
 class BoxCollider;
 class CapsuleCollider;
 class CylinderCollider;
 class SphereCollider;
+class MeshCollider;
+class CompoundCollider;
+class ConvexCollider;
+class TriangleShape;
+class ConvexHullShape;
+
+//=============================================================================
+// 軸平行バウンディングボックス(AABB)
+//=============================================================================
+struct AABB
+{
+    D3DXVECTOR3 min;    // 最小点
+    D3DXVECTOR3 max;    // 最大点
+
+    // 重なっているかどうか
+    bool Overlaps(const AABB& other) const
+    {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    // 全方向に広げる
+    void Expand(float margin)
+    {
+        min -= D3DXVECTOR3(margin, margin, margin);
+        max += D3DXVECTOR3(margin, margin, margin);
+    }
+
+    // 移動量の分だけ進む向きに伸ばす
+    void Sweep(const D3DXVECTOR3& motion)
+    {
+        min += D3DXVECTOR3(std::min(motion.x, 0.0f), std::min(motion.y, 0.0f), std::min(motion.z, 0.0f));
+        max += D3DXVECTOR3(std::max(motion.x, 0.0f), std::max(motion.y, 0.0f), std::max(motion.z, 0.0f));
+    }
+
+    // 他のAABBを含むように広げる
+    void Merge(const AABB& other)
+    {
+        min = D3DXVECTOR3(std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z));
+        max = D3DXVECTOR3(std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z));
+    }
+
+    // レイとの交差（invDirは向きの逆数、outEnterは入る距離で原点が中なら0）
+    // extentの分だけ太らせて判定する（形状を飛ばすときは形状の半分の大きさを渡す）
+    bool IntersectRay(const D3DXVECTOR3& origin, const D3DXVECTOR3& invDir, float maxDist, const D3DXVECTOR3& extent, float& outEnter) const
+    {
+        float enter = 0.0f;
+        float exit = maxDist;
+
+        for (int nCnt = 0; nCnt < 3; nCnt++)
+        {
+            float t1 = (min[nCnt] - extent[nCnt] - origin[nCnt]) * invDir[nCnt];
+            float t2 = (max[nCnt] + extent[nCnt] - origin[nCnt]) * invDir[nCnt];
+
+            enter = std::max(enter, std::min(t1, t2));
+            exit = std::min(exit, std::max(t1, t2));
+        }
+
+        outEnter = enter;
+        return enter <= exit;
+    }
+
+    // レイの向きの逆数（軸に平行な成分は大きな値にして0除算を避ける）
+    static D3DXVECTOR3 InverseDirection(const D3DXVECTOR3& dir)
+    {
+        const float LARGE = 1e30f;
+
+        return D3DXVECTOR3(
+            fabsf(dir.x) > 1e-12f ? 1.0f / dir.x : (dir.x < 0.0f ? -LARGE : LARGE),
+            fabsf(dir.y) > 1e-12f ? 1.0f / dir.y : (dir.y < 0.0f ? -LARGE : LARGE),
+            fabsf(dir.z) > 1e-12f ? 1.0f / dir.z : (dir.z < 0.0f ? -LARGE : LARGE));
+    }
+};
+
+//*****************************************************************************
+// レイの検索で候補の剛体ごとに呼ぶ関数（今の最大距離を受け取り、これより先を調べない距離を返す）
+//*****************************************************************************
+using RayQueryFunc = std::function<float(RigidBody* body, float maxDist)>;
 
 //=============================================================================
 // コライダークラス
@@ -31,7 +111,11 @@ public:
         BOX,
         CAPSULE,
         CYLINDER,
-        SPHERE
+        SPHERE,
+        MESH,
+        COMPOUND,
+        CONVEX,
+        TYPE_MAX
     };
 
     Collider(TYPE type) : m_Type(type) {}
@@ -60,6 +144,18 @@ public:
         {
             return m_Type == SPHERE ? reinterpret_cast<T*>(this) : nullptr;
         }
+        else if constexpr (std::is_same_v<T, MeshCollider>)
+        {
+            return m_Type == MESH ? reinterpret_cast<T*>(this) : nullptr;
+        }
+        else if constexpr (std::is_same_v<T, CompoundCollider>)
+        {
+            return m_Type == COMPOUND ? reinterpret_cast<T*>(this) : nullptr;
+        }
+        else if constexpr (std::is_same_v<T, ConvexCollider>)
+        {
+            return m_Type == CONVEX ? reinterpret_cast<T*>(this) : nullptr;
+        }
     }
 
     // ワールド変換の取得
@@ -72,6 +168,12 @@ public:
         inertia = INIT_VEC3;
     }
 
+    // 現在のトランスフォームでのワールドAABBを取得
+    virtual AABB GetAABB(void) const
+    {
+        return { m_Position, m_Position };
+    }
+
 protected:
     TYPE m_Type;
     D3DXVECTOR3 m_Position;
@@ -84,11 +186,12 @@ class BoxCollider : public Collider
 {
 public:
     BoxCollider(const D3DXVECTOR3& size)
-        : Collider(BOX), m_Size(size) {}
+        : Collider(BOX), m_Size(size), m_ScaledSize(size) {}
 
     // 位置・回転・スケールを反映
     void UpdateTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale) override;
     void calculateLocalInertia(float mass, D3DXVECTOR3& inertia) const override;
+    AABB GetAABB(void) const override;
 
     const D3DXVECTOR3& GetScaledSize(void) const { return m_ScaledSize; }
     const D3DXMATRIX& GetRotation(void) const { return m_Rotation; }
@@ -114,6 +217,7 @@ public:
 
     // 慣性モーメント
     void calculateLocalInertia(float mass, D3DXVECTOR3& inertia) const;
+    AABB GetAABB(void) const override;
 
     float GetRadius(void) const { return m_Radius; }
     float GetHeight(void) const { return m_Height; }
@@ -141,12 +245,15 @@ public:
     {
         m_Radius = size.x * HALF;
         m_Height = size.y;
+        m_RadiusScaled = m_Radius;
+        m_HeightScaled = m_Height;
     }
 
     void UpdateTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale);
 
     // 慣性モーメント
     void calculateLocalInertia(float mass, D3DXVECTOR3& inertia) const;
+    AABB GetAABB(void) const override;
 
     float GetRadius(void) const { return m_RadiusScaled; }
     float GetHeight(void) const { return m_HeightScaled; }
@@ -183,6 +290,7 @@ public:
 
     // 慣性モーメント
     void calculateLocalInertia(float mass, D3DXVECTOR3& inertia) const override;
+    AABB GetAABB(void) const override;
 
     float GetRadius(void) const { return m_ScaledRadius; }
     const D3DXMATRIX& GetRotation(void) const { return m_Rotation; }
@@ -198,4 +306,126 @@ private:
     float           m_ScaledRadius;     // スケール反映後
 };
 
+//=============================================================================
+// メッシュコライダー（静的な三角形メッシュ・高さの格子、形状は同じモデルのブロックで共有する）
+// 三角形は表からだけ当たる（裏に抜けた相手は押し戻さない）
+//=============================================================================
+class MeshCollider : public Collider
+{
+public:
+    MeshCollider(std::shared_ptr<const TriangleShape> shape);
+
+    // 位置・回転・スケールを反映（三角形はローカルのまま持ち、使うときにワールドへ変換する）
+    void UpdateTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale) override;
+    AABB GetAABB(void) const override { return m_WorldBounds; }
+
+    // ワールドのboxと重なるかもしれない三角形の番号をoutに追加する
+    void QueryTriangles(const AABB& box, std::vector<int>& out) const;
+
+    // 三角形のワールドの3頂点と表の向きの法線（正規化済み）
+    void GetTriangle(int index, D3DXVECTOR3* outVertices, D3DXVECTOR3& outNormal, int* outVertexIds = nullptr) const;
+
+    // ワールドのレイ（dirは正規化済み）と表から当たる一番近い三角形
+    bool RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, D3DXVECTOR3& outNormal) const;
+
+    const TriangleShape* GetShape(void) const { return m_pShape.get(); }
+    int GetTriangleCount(void) const;
+
+private:
+    static constexpr float MIN_SCALE = 1e-4f;   // 逆行列が作れるように拡大率をこれより小さくしない
+
+    std::shared_ptr<const TriangleShape>    m_pShape;       // 三角形の形状（ローカル）
+    D3DXMATRIX                              m_World;        // ローカル→ワールド
+    D3DXMATRIX                              m_InvWorld;     // ワールド→ローカル
+    AABB                                    m_WorldBounds;  // ワールドAABB
+    bool                                    m_isFlipped;    // 拡大率で裏返っているか（外積の向きを逆にする）
+};
+
+//=============================================================================
+// 複合コライダー（1つの剛体に置いた子の形状の集まり、ブロードフェーズにはまとめたAABBで1つだけ入る）
+// 子の位置・回転は剛体から見たローカルで持ち、剛体の原点を重心とみなす
+//=============================================================================
+class CompoundCollider : public Collider
+{
+public:
+    CompoundCollider() : Collider(COMPOUND), m_Scale(1.0f, 1.0f, 1.0f), m_Bounds({ INIT_VEC3, INIT_VEC3 }) { m_Position = INIT_VEC3; }
+
+    // 子の追加（複合コライダー・メッシュは子にしない）
+    bool AddChild(std::shared_ptr<Collider> child, const D3DXVECTOR3& localPos, const D3DXQUATERNION& localRot);
+
+    // 位置・回転・スケールを子に反映（子のオフセットにもスケールをかける）
+    void UpdateTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale) override;
+
+    // 慣性モーメント（質量を子の体積で分け、平行軸の定理で剛体の原点まわりに足す）
+    void calculateLocalInertia(float mass, D3DXVECTOR3& inertia) const override;
+    AABB GetAABB(void) const override { return m_Bounds; }
+
+    int GetChildCount(void) const { return (int)m_Children.size(); }
+    Collider* GetChild(int index) const { return m_Children[index].shape.get(); }
+    const D3DXVECTOR3& GetChildPosition(int index) const { return m_Children[index].localPos; }
+    const D3DXQUATERNION& GetChildRotation(int index) const { return m_Children[index].localRot; }
+
+private:
+    // 子の形状
+    struct Child
+    {
+        std::shared_ptr<Collider>   shape;      // 形状
+        D3DXVECTOR3                 localPos;   // 剛体から見た位置
+        D3DXQUATERNION              localRot;   // 剛体から見た回転
+    };
+
+    static float GetVolume(const Collider* shape);
+
+    std::vector<Child>  m_Children;     // 子の形状
+    D3DXVECTOR3         m_Scale;        // 今のスケール（慣性モーメントの計算用）
+    AABB                m_Bounds;       // 子をまとめたワールドAABB
+};
+
+//=============================================================================
+// 凸包コライダー（Xファイルから作った凸包、形状は同じモデルのブロックで共有する）
+// 頂点はトランスフォームのたびにワールドへ変換して持ち、支持点は頂点の総当たりで探す
+// 凸包の原点を重心とみなす
+//=============================================================================
+class ConvexCollider : public Collider
+{
+public:
+    ConvexCollider(std::shared_ptr<const ConvexHullShape> shape);
+
+    // 位置・回転・スケールを反映（描画と同じ 拡大→回転→移動 の順）
+    void UpdateTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale) override;
+    void calculateLocalInertia(float mass, D3DXVECTOR3& inertia) const override;
+    AABB GetAABB(void) const override { return m_WorldBounds; }
+
+    // dirの向きに一番遠いワールドの頂点（dirは正規化しなくてよい）
+    int GetSupportIndex(const D3DXVECTOR3& dir) const;
+    const D3DXVECTOR3& GetSupport(const D3DXVECTOR3& dir) const { return m_WorldVertices[GetSupportIndex(dir)]; }
+
+    int GetVertexCount(void) const { return (int)m_WorldVertices.size(); }
+    const D3DXVECTOR3& GetVertex(int index) const { return m_WorldVertices[index]; }
+    int GetTriangleCount(void) const;
+
+    // 三角形のワールドの3頂点と外向きの法線（正規化済み）
+    void GetTriangle(int index, D3DXVECTOR3* outVertices, D3DXVECTOR3& outNormal) const;
+
+    // ワールドのレイ（dirは正規化済み）と外から当たる面
+    bool RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, D3DXVECTOR3& outNormal) const;
+
+    // 原点を中心に凸包の中に収まる球の半径（CCDで飛ばす芯の太さ）
+    float GetInnerRadius(void) const { return m_InnerRadius; }
+    float GetVolume(void) const;
+    const ConvexHullShape* GetShape(void) const { return m_pShape.get(); }
+
+private:
+    static constexpr float MIN_SCALE = 1e-4f;   // 逆行列が作れるように拡大率をこれより小さくしない
+
+    std::shared_ptr<const ConvexHullShape>  m_pShape;           // 凸包の形状（ローカル）
+    std::vector<D3DXVECTOR3>                m_WorldVertices;    // ワールドの頂点
+    D3DXMATRIX                              m_World;            // ローカル→ワールド
+    D3DXMATRIX                              m_InvWorld;         // ワールド→ローカル
+    D3DXVECTOR3                             m_Scale;            // 今のスケール（慣性モーメント・体積の計算用）
+    AABB                                    m_WorldBounds;      // ワールドAABB
+    float                                   m_InnerRadius;      // 中に収まる球の半径
+    bool                                    m_isFlipped;        // 拡大率で裏返っているか（外積の向きを逆にする）
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,296 @@
+//=============================================================================
+//
+// 当たり判定のキャッシュ処理 [CollisionCache.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "CollisionCache.h"
+#include "map"
+#include "tuple"
+
+//=============================================================================
+// コンストラクタ
+//=============================================================================
+CCollisionCache::CCollisionCache()
+{
+	// 値のクリア
+	m_Shapes.clear();
+}
+//=============================================================================
+// デストラクタ
+//=============================================================================
+CCollisionCache::~CCollisionCache()
+{
+	// なし
+}
+//=============================================================================
+// 三角形メッシュの取得処理
+//=============================================================================
+std::shared_ptr<const TriangleShape> CCollisionCache::GetMesh(const char* pFilepath, LPD3DXMESH pMesh)
+{
+	return GetShape(pFilepath, pMesh, TriangleShape::MESH);
+}
+//=============================================================================
+// 高さの格子の取得処理
+//=============================================================================
+std::shared_ptr<const TriangleShape> CCollisionCache::GetHeightfield(const char* pFilepath, LPD3DXMESH pMesh)
+{
+	return GetShape(pFilepath, pMesh, TriangleShape::HEIGHTFIELD);
+}
+//=============================================================================
+// 凸包の取得処理
+//=============================================================================
+std::shared_ptr<const ConvexHullShape> CCollisionCache::GetConvexHull(const char* pFilepath, LPD3DXMESH pMesh)
+{
+	return std::static_pointer_cast<const ConvexHullShape>(GetShape(pFilepath, pMesh, TriangleShape::HULL));
+}
+//=============================================================================
+// 形状の取得処理（読み込み済み→キャッシュファイル→組み立ての順に探す）
+//=============================================================================
+std::shared_ptr<const TriangleShape> CCollisionCache::GetShape(const char* pFilepath, LPD3DXMESH pMesh, TriangleShape::KIND kind)
+{
+	if (pFilepath == nullptr || pFilepath[0] == '\0')
+	{
+		return nullptr;
+	}
+
+	std::string cachePath = GetCachePath(pFilepath, kind);
+
+	// 読み込み済み
+	auto it = m_Shapes.find(cachePath);
+
+	if (it != m_Shapes.end())
+	{
+		return it->second;
+	}
+
+	// 元のXファイルの大きさと更新時刻が同じならキャッシュファイルを使う
+	FileHeader header = {};
+	bool isStamped = MakeHeader(pFilepath, kind, header);
+
+	std::shared_ptr<TriangleShape> shape = isStamped ? LoadFile(cachePath, header) : nullptr;
+
+	if (!shape)
+	{
+		if (kind == TriangleShape::HEIGHTFIELD || kind == TriangleShape::HULL)
+		{
+			// 高さの格子はメッシュを見下ろして、凸包はメッシュの頂点を包んで作る
+			std::shared_ptr<const TriangleShape> mesh = GetShape(pFilepath, pMesh, TriangleShape::MESH);
+
+			if (!mesh)
+			{
+				return nullptr;
+			}
+
+			if (kind == TriangleShape::HEIGHTFIELD)
+			{
+				auto heightfield = std::make_shared<HeightfieldShape>();
+				heightfield->CookFromMesh(*mesh);
+				shape = heightfield;
+			}
+			else
+			{
+				auto hull = std::make_shared<ConvexHullShape>();
+
+				if (!hull->CookFromMesh(*mesh))
+				{// 平らなモデルは包めない
+					return nullptr;
+				}
+
+				shape = hull;
+			}
+		}
+		else
+		{
+			shape = CookMesh(pMesh);
+		}
+
+		if (!shape)
+		{
+			return nullptr;
+		}
+
+		if (isStamped)
+		{
+			SaveFile(cachePath, header, *shape);
+		}
+	}
+
+	m_Shapes[cachePath] = shape;
+
+	return shape;
+}
+//=============================================================================
+// 三角形メッシュの組み立て処理（Xファイルのメッシュの頂点・インデックスバッファから作る）
+//=============================================================================
+std::shared_ptr<TriangleShape> CCollisionCache::CookMesh(LPD3DXMESH pMesh)
+{
+	if (pMesh == nullptr)
+	{
+		return nullptr;
+	}
+
+	int nNumVtx = (int)pMesh->GetNumVertices();
+	int nNumFace = (int)pMesh->GetNumFaces();
+	DWORD sizeFVF = D3DXGetFVFVertexSize(pMesh->GetFVF());
+
+	if (nNumVtx == 0 || nNumFace == 0)
+	{
+		return nullptr;
+	}
+
+	// 頂点（面ごとに分かれている同じ位置の頂点は1つにまとめる）
+	std::vector<D3DXVECTOR3> vertices;
+	std::vector<unsigned int> remap(nNumVtx);
+	std::map<std::tuple<float, float, float>, unsigned int> welded;
+	BYTE* pVtxBuff = nullptr;
+
+	if (FAILED(pMesh->LockVertexBuffer(D3DLOCK_READONLY, (void**)&pVtxBuff)))
+	{
+		return nullptr;
+	}
+
+	for (int nCnt = 0; nCnt < nNumVtx; nCnt++)
+	{
+		D3DXVECTOR3 pos = *(D3DXVECTOR3*)(pVtxBuff + sizeFVF * nCnt);
+
+		auto result = welded.emplace(std::make_tuple(pos.x, pos.y, pos.z), (unsigned int)vertices.size());
+
+		if (result.second)
+		{
+			vertices.push_back(pos);
+		}
+
+		remap[nCnt] = result.first->second;
+	}
+
+	pMesh->UnlockVertexBuffer();
+
+	// インデックス（16ビットと32ビットの両方）
+	std::vector<unsigned int> indices(nNumFace * 3);
+	bool is32Bit = (pMesh->GetOptions() & D3DXMESH_32BIT) != 0;
+	void* pIdxBuff = nullptr;
+
+	if (FAILED(pMesh->LockIndexBuffer(D3DLOCK_READONLY, &pIdxBuff)))
+	{
+		return nullptr;
+	}
+
+	for (int nCnt = 0; nCnt < nNumFace * 3; nCnt++)
+	{
+		unsigned int index = is32Bit ? ((const DWORD*)pIdxBuff)[nCnt] : ((const WORD*)pIdxBuff)[nCnt];
+		indices[nCnt] = (index < (unsigned int)nNumVtx) ? remap[index] : UINT_MAX;
+	}
+
+	pMesh->UnlockIndexBuffer();
+
+	auto mesh = std::make_shared<TriangleMeshShape>();
+	mesh->Cook(vertices.data(), (int)vertices.size(), indices.data(), nNumFace);
+
+	return mesh;
+}
+//=============================================================================
+// キャッシュファイルの読み込み処理（先頭が合わない・壊れていればnullptr）
+//=============================================================================
+std::shared_ptr<TriangleShape> CCollisionCache::LoadFile(const std::string& cachePath, const FileHeader& header)
+{
+	std::ifstream file(cachePath, std::ios::binary);
+
+	if (!file)
+	{
+		return nullptr;
+	}
+
+	std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	SnapshotReader reader(data);
+	FileHeader stored = {};
+
+	if (!reader.Read(stored) ||
+		stored.magic != header.magic || stored.version != header.version || stored.kind != header.kind ||
+		stored.sourceSize != header.sourceSize || stored.sourceTime != header.sourceTime)
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<TriangleShape> shape = TriangleShape::Read(reader);
+
+	if (!shape || shape->GetKind() != header.kind)
+	{
+		return nullptr;
+	}
+
+	return shape;
+}
+//=============================================================================
+// キャッシュファイルの書き出し処理（書けなくても次回また組み立てるだけなので無視する）
+//=============================================================================
+void CCollisionCache::SaveFile(const std::string& cachePath, const FileHeader& header, const TriangleShape& shape)
+{
+	CreateDirectoryA(CACHE_DIRECTORY, nullptr);
+
+	std::vector<unsigned char> data;
+	SnapshotWriter writer(data);
+	writer.Write(header);
+	shape.Write(data);
+
+	std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+
+	if (file)
+	{
+		file.write((const char*)data.data(), (std::streamsize)data.size());
+	}
+}
+//=============================================================================
+// キャッシュファイルの先頭の作成処理（元のXファイルの大きさと更新時刻で古いキャッシュを見分ける）
+//=============================================================================
+bool CCollisionCache::MakeHeader(const char* pFilepath, TriangleShape::KIND kind, FileHeader& outHeader)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attribute;
+
+	if (!GetFileAttributesExA(pFilepath, GetFileExInfoStandard, &attribute))
+	{
+		return false;
+	}
+
+	outHeader.sourceSize = ((unsigned long long)attribute.nFileSizeHigh << 32) | attribute.nFileSizeLow;
+	outHeader.sourceTime = ((unsigned long long)attribute.ftLastWriteTime.dwHighDateTime << 32) | attribute.ftLastWriteTime.dwLowDateTime;
+	outHeader.magic = CACHE_MAGIC;
+	outHeader.version = CACHE_VERSION;
+	outHeader.kind = (int)kind;
+	outHeader.reserved = 0;
+
+	return true;
+}
+//=============================================================================
+// キャッシュファイルのパスの取得処理（区切り文字を_にして1つのフォルダに並べる）
+//=============================================================================
+std::string CCollisionCache::GetCachePath(const char* pFilepath, TriangleShape::KIND kind)
+{
+	std::string name = pFilepath;
+
+	for (char& c : name)
+	{
+		if (c == '/' || c == '\\' || c == ':' || c == '.')
+		{
+			c = '_';
+		}
+	}
+
+	const char* extension = ".mesh";
+
+	if (kind == TriangleShape::HEIGHTFIELD)
+	{
+		extension = ".hf";
+	}
+	else if (kind == TriangleShape::HULL)
+	{
+		extension = ".hull";
+	}
+
+	return std::string(CACHE_DIRECTORY) + "/" + name + extension;
+}
@@ -0,0 +1,60 @@
+//=============================================================================
+//
+// 当たり判定のキャッシュ処理 [CollisionCache.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _COLLISIONCACHE_H_// このマクロ定義がされていなかったら
+#define _COLLISIONCACHE_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "TriangleShape.h"
+#include "unordered_map"
+
+//*****************************************************************************
+// 当たり判定のキャッシュクラス
+// モデルのパスごとに三角形の形状を1度だけ組み立てて同じモデルのブロックで共有する
+// 組み立てた形状はファイルに書き出し、元のXファイルが変わっていなければ次からは読み込むだけにする
+//*****************************************************************************
+class CCollisionCache
+{
+public:
+	CCollisionCache();
+	~CCollisionCache();
+
+	std::shared_ptr<const TriangleShape> GetMesh(const char* pFilepath, LPD3DXMESH pMesh);			// 三角形メッシュの取得
+	std::shared_ptr<const TriangleShape> GetHeightfield(const char* pFilepath, LPD3DXMESH pMesh);	// 高さの格子の取得
+	std::shared_ptr<const ConvexHullShape> GetConvexHull(const char* pFilepath, LPD3DXMESH pMesh);	// 凸包の取得
+	void Clear(void) { m_Shapes.clear(); }															// 読み込み済みの形状の破棄
+
+private:
+	//*****************************************************************************
+	// キャッシュファイルの先頭
+	//*****************************************************************************
+	struct FileHeader
+	{
+		unsigned long long	sourceSize;		// 元のXファイルの大きさ
+		unsigned long long	sourceTime;		// 元のXファイルの更新時刻
+		int					magic;			// 識別子
+		int					version;		// 並びの版
+		int					kind;			// 形状の種類
+		int					reserved;		// 予備（0）
+	};
+
+	std::shared_ptr<const TriangleShape> GetShape(const char* pFilepath, LPD3DXMESH pMesh, TriangleShape::KIND kind);
+	std::shared_ptr<TriangleShape> CookMesh(LPD3DXMESH pMesh);
+	std::shared_ptr<TriangleShape> LoadFile(const std::string& cachePath, const FileHeader& header);
+	void SaveFile(const std::string& cachePath, const FileHeader& header, const TriangleShape& shape);
+	static bool MakeHeader(const char* pFilepath, TriangleShape::KIND kind, FileHeader& outHeader);
+	static std::string GetCachePath(const char* pFilepath, TriangleShape::KIND kind);
+
+	static constexpr int	CACHE_MAGIC		= 0x4C4F4343;		// 識別子
+	static constexpr int	CACHE_VERSION	= 1;				// 並びの版（形状の書き出しを変えたら上げる）
+	static constexpr const char* CACHE_DIRECTORY = "data/COLLISION";	// 書き出し先のフォルダ
+
+	std::unordered_map<std::string, std::shared_ptr<const TriangleShape>>	m_Shapes;	// 読み込み済みの形状（パスと種類ごと）
+};
+
+#endif
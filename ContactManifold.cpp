@@ -0,0 +1,334 @@
+//=============================================================================
+//
+// 接触多様体処理 [ContactManifold.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "ContactManifold.h"
+#include "RigidBody.h"
+
+//=============================================================================
+// ワールド座標からローカル座標への変換
+//=============================================================================
+D3DXVECTOR3 ContactManifold::ToLocal(const RigidBody* body, const D3DXVECTOR3& world)
+{
+    D3DXMATRIX rot;
+    D3DXMatrixRotationQuaternion(&rot, &body->GetOrientation());
+
+    // 回転行列の転置で逆回転
+    D3DXVECTOR3 d = world - body->GetPosition();
+
+    return D3DXVECTOR3(
+        d.x * rot._11 + d.y * rot._12 + d.z * rot._13,
+        d.x * rot._21 + d.y * rot._22 + d.z * rot._23,
+        d.x * rot._31 + d.y * rot._32 + d.z * rot._33);
+}
+//=============================================================================
+// 接触点の更新処理
+//=============================================================================
+void ContactManifold::Update(const ContactPoint* newPoints, int count, const D3DXVECTOR3& newNormal)
+{
+    std::array<ContactPoint, MAX_POINTS> oldPoints = points;
+    int numOld = numPoints;
+
+    // 法線が大きく変わったら引き継がない（摩擦方向も法線から決まるので一緒に捨てる）
+    if (numOld > 0 && D3DXVec3Dot(&normal, &newNormal) < MATCH_NORMAL)
+    {
+        numOld = 0;
+    }
+
+    bool isUsed[MAX_POINTS] = {};
+    int matched[MAX_POINTS];
+
+    numPoints = std::min(count, MAX_POINTS);
+    normal = newNormal;
+
+    // 先に同じ特徴から作られた古い点を探す
+    for (int nCnt = 0; nCnt < numPoints; nCnt++)
+    {
+        ContactPoint& cp = points[nCnt];
+        cp = newPoints[nCnt];
+        cp.normalImpulse = 0.0f;
+        cp.tangentImpulse[0] = 0.0f;
+        cp.tangentImpulse[1] = 0.0f;
+
+        matched[nCnt] = -1;
+
+        if (cp.featureId == ContactPoint::NO_FEATURE)
+        {
+            continue;
+        }
+
+        for (int nCnt2 = 0; nCnt2 < numOld; nCnt2++)
+        {
+            if (!isUsed[nCnt2] && oldPoints[nCnt2].featureId == cp.featureId)
+            {
+                isUsed[nCnt2] = true;
+                matched[nCnt] = nCnt2;
+                break;
+            }
+        }
+    }
+
+    // 残りは一番近い古い点から引き継ぐ（切り取りの境目で特徴が入れ替わった点もここで拾う）
+    for (int nCnt = 0; nCnt < numPoints; nCnt++)
+    {
+        ContactPoint& cp = points[nCnt];
+        int best = matched[nCnt];
+
+        if (best < 0)
+        {
+            float bestDistSq = MATCH_DISTANCE * MATCH_DISTANCE;
+
+            for (int nCnt2 = 0; nCnt2 < numOld; nCnt2++)
+            {
+                if (isUsed[nCnt2])
+                {
+                    continue;
+                }
+
+                D3DXVECTOR3 diff = cp.localA - oldPoints[nCnt2].localA;
+                float distSq = D3DXVec3LengthSq(&diff);
+
+                if (distSq < bestDistSq)
+                {
+                    bestDistSq = distSq;
+                    best = nCnt2;
+                }
+            }
+
+            if (best < 0)
+            {
+                continue;
+            }
+
+            isUsed[best] = true;
+        }
+
+        cp.normalImpulse = oldPoints[best].normalImpulse;
+        cp.tangentImpulse[0] = oldPoints[best].tangentImpulse[0];
+        cp.tangentImpulse[1] = oldPoints[best].tangentImpulse[1];
+    }
+}
+//=============================================================================
+// 剛体の組のキーの作成処理
+//=============================================================================
+unsigned long long ContactCache::MakeKey(const RigidBody* a, const RigidBody* b)
+{
+    return ((unsigned long long)a->GetPoolIndex() << 32) | (unsigned int)b->GetPoolIndex();
+}
+//=============================================================================
+// 多様体の取得処理（前のステップの表を先頭から突き合わせる）
+//=============================================================================
+ContactManifold& ContactCache::Find(RigidBody* a, RigidBody* b)
+{
+    unsigned long long key = MakeKey(a, b);
+
+    // 同じ組が続けて来たら同じ多様体を返す
+    if (!m_NextEntries.empty() && m_NextEntries.back().key == key)
+    {
+        return m_Storage[m_NextEntries.back().index];
+    }
+
+    // キーがこれより小さい前の多様体は今回は取得されなかった
+    while (m_Cursor < m_Entries.size() && m_Entries[m_Cursor].key < key)
+    {
+        m_Untouched.push_back(m_Entries[m_Cursor]);
+        m_Cursor++;
+    }
+
+    int index = 0;
+
+    if (m_Cursor < m_Entries.size() && m_Entries[m_Cursor].key == key)
+    {
+        index = m_Entries[m_Cursor].index;
+        m_Cursor++;
+    }
+    else if (!m_FreeIndices.empty())
+    {
+        // 空いた置き場を作りたてと同じ状態にして使い回す
+        index = m_FreeIndices.back();
+        m_FreeIndices.pop_back();
+        m_Storage[index] = ContactManifold();
+    }
+    else
+    {
+        index = (int)m_Storage.size();
+        m_Storage.emplace_back();
+    }
+
+    ContactManifold& manifold = m_Storage[index];
+    manifold.a = a;
+    manifold.b = b;
+    manifold.isTouched = true;
+
+    m_NextEntries.push_back({ key, index });
+
+    return manifold;
+}
+//=============================================================================
+// 前のステップの多様体の検索処理
+//=============================================================================
+const ContactManifold* ContactCache::FindPrevious(unsigned long long key) const
+{
+    auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), key,
+        [](const Entry& entry, unsigned long long value) { return entry.key < value; });
+
+    if (it == m_Entries.end() || it->key != key)
+    {
+        return nullptr;
+    }
+
+    return &m_Storage[it->index];
+}
+//=============================================================================
+// ステップ開始処理
+//=============================================================================
+void ContactCache::BeginStep(void)
+{
+    // 削除された剛体のアドレスは使い回されるので、照合より先に捨てる
+    PurgeRemovedBodies();
+
+    m_NextEntries.clear();
+    m_Untouched.clear();
+    m_Cursor = 0;
+}
+//=============================================================================
+// ステップ終了処理（取得されなかった多様体は残すか捨てるかを決めてから今回の表にまとめる）
+//=============================================================================
+void ContactCache::EndStep(void)
+{
+    while (m_Cursor < m_Entries.size())
+    {
+        m_Untouched.push_back(m_Entries[m_Cursor]);
+        m_Cursor++;
+    }
+
+    size_t numTouched = m_NextEntries.size();
+
+    for (const Entry& entry : m_Untouched)
+    {
+        ContactManifold& manifold = m_Storage[entry.index];
+
+        // スリープ中のペアは起きたときのウォームスタート用に残す
+        if (manifold.a->IsSleeping() || manifold.b->IsSleeping())
+        {
+            manifold.isTouched = false;
+            m_NextEntries.push_back(entry);
+        }
+        else
+        {
+            m_FreeIndices.push_back(entry.index);
+        }
+    }
+
+    // 取得された分と残した分はどちらもキー順なので、つなぎ目でまとめ直すだけで済む
+    std::inplace_merge(m_NextEntries.begin(), m_NextEntries.begin() + numTouched, m_NextEntries.end(),
+        [](const Entry& lhs, const Entry& rhs) { return lhs.key < rhs.key; });
+
+    std::swap(m_Entries, m_NextEntries);
+
+    m_NextEntries.clear();
+    m_Untouched.clear();
+    m_Cursor = 0;
+}
+//=============================================================================
+// 復元のための作り直しの開始処理（表を空にし、置き場の先頭count個を復元に使って残りは空きにする）
+//=============================================================================
+void ContactCache::ResetForRestore(int count)
+{
+    // 削除された剛体のアドレスは使い回されるので、ステップ開始と同じく先に捨てる
+    PurgeRemovedBodies();
+
+    m_Entries.clear();
+    m_NextEntries.clear();
+    m_Untouched.clear();
+    m_FreeIndices.clear();
+    m_Cursor = 0;
+
+    if ((int)m_Storage.size() < count)
+    {
+        m_Storage.resize(count);
+    }
+
+    // 小さい番号から使われるように逆順に積む
+    for (int index = (int)m_Storage.size() - 1; index >= count; index--)
+    {
+        m_FreeIndices.push_back(index);
+    }
+
+    m_Entries.reserve(count);
+}
+//=============================================================================
+// 復元した多様体の追加処理（置き場を前から順に使う）
+// 法線・接触点・累積インパルスは呼び出し側が書く。それ以外（有効質量など）は次のステップで必ず計算し直すので、
+// 多様体まるごと作りたてに戻して書き込む量を増やさない
+//=============================================================================
+ContactManifold& ContactCache::AppendRestored(RigidBody* a, RigidBody* b, unsigned long long key)
+{
+    int index = (int)m_Entries.size();
+
+    ContactManifold& manifold = m_Storage[index];
+    manifold.a = a;
+    manifold.b = b;
+    manifold.isTouched = true;
+
+    m_Entries.push_back({ key, index });
+
+    return manifold;
+}
+//=============================================================================
+// 全削除処理
+//=============================================================================
+void ContactCache::Clear(void)
+{
+    m_Storage.clear();
+    m_FreeIndices.clear();
+    m_Entries.clear();
+    m_NextEntries.clear();
+    m_Untouched.clear();
+    m_Cursor = 0;
+    m_RemovedBodies.clear();
+}
+//=============================================================================
+// 削除予約された剛体の多様体をまとめて捨てる処理
+//=============================================================================
+void ContactCache::PurgeRemovedBodies(void)
+{
+    if (m_RemovedBodies.empty())
+    {
+        return;
+    }
+
+    // 何体消えても表の走査は1回で済ませる
+    m_Entries.erase(std::remove_if(m_Entries.begin(), m_Entries.end(),
+        [this](const Entry& entry)
+        {
+            const ContactManifold& manifold = m_Storage[entry.index];
+
+            if (m_RemovedBodies.count(manifold.a) || m_RemovedBodies.count(manifold.b))
+            {
+                m_FreeIndices.push_back(entry.index);
+                return true;
+            }
+
+            return false;
+        }),
+        m_Entries.end());
+
+    // 削除で末尾の剛体がプール内の空いた番号に移るので、キーを付け直して並べ直す
+    for (Entry& entry : m_Entries)
+    {
+        const ContactManifold& manifold = m_Storage[entry.index];
+        entry.key = MakeKey(manifold.a, manifold.b);
+    }
+
+    std::sort(m_Entries.begin(), m_Entries.end(),
+        [](const Entry& lhs, const Entry& rhs) { return lhs.key < rhs.key; });
+
+    m_RemovedBodies.clear();
+}
@@ -0,0 +1,144 @@
+//=============================================================================
+//
+// 接触多様体処理 [ContactManifold.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _CONTACTMANIFOLD_H_// このマクロ定義がされていなかったら
+#define _CONTACTMANIFOLD_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "deque"
+#include "unordered_set"
+
+//*****************************************************************************
+// 前方宣言
+//*****************************************************************************
+class RigidBody;
+
+//*****************************************************************************
+// 接触点
+//*****************************************************************************
+struct ContactPoint
+{
+    D3DXVECTOR3 position;       // ワールド接触点
+    D3DXVECTOR3 localA;         // Aのローカル接触点（前フレームとの照合用）
+    D3DXVECTOR3 localB;             // Bのローカル接触点
+    D3DXVECTOR3 rA;                 // Aの重心から接触点まで
+    D3DXVECTOR3 rB;                 // Bの重心から接触点まで
+    float       depth;              // めり込み量
+    float       normalImpulse;      // 累積法線インパルス（ウォームスタート用）
+    float       tangentImpulse[2];  // 累積摩擦インパルス（ウォームスタート用）
+    float       pushImpulse;        // 累積の押し戻しインパルス（疑似速度用）
+    float       normalMass;         // 法線方向の有効質量
+    float       tangentMass[2];     // 摩擦方向の有効質量
+    float       velocityBias;       // 反発で目標にする法線速度
+    float       positionBias;       // めり込み解消で目標にする疑似速度
+    unsigned int featureId;         // 接触を作った面・辺・頂点の組（前フレームとの照合用、NO_FEATUREなら位置で照合）
+
+    static constexpr unsigned int NO_FEATURE = 0;   // 特徴の番号なし
+};
+
+//=============================================================================
+// 接触多様体クラス（1ペア分の接触点の集まり）
+//=============================================================================
+class ContactManifold
+{
+public:
+    static constexpr int MAX_POINTS = 4;    // 最大接触点数
+
+    ContactManifold() : a(nullptr), b(nullptr), normal(0, 0, 0), invMassA(0.0f), invMassB(0.0f), friction(0.0f), points(), numPoints(0), isTouched(false)
+    {
+        // D3DXの型は既定のコンストラクタで0にならないので明示して埋める
+        tangent[0] = tangent[1] = D3DXVECTOR3(0, 0, 0);
+        ZeroMemory(&invInertiaA, sizeof(invInertiaA));
+        ZeroMemory(&invInertiaB, sizeof(invInertiaB));
+    }
+
+    // 新しい接触点に置き換え、前フレームの同じ特徴の点（見つからなければ近い点）から累積インパルスを引き継ぐ
+    void Update(const ContactPoint* newPoints, int count, const D3DXVECTOR3& newNormal);
+
+    // ワールド座標からローカル座標への変換
+    static D3DXVECTOR3 ToLocal(const RigidBody* body, const D3DXVECTOR3& world);
+
+    RigidBody*                              a;              // 剛体A
+    RigidBody*                              b;              // 剛体B
+    D3DXVECTOR3                             normal;         // 法線（A→B）
+    D3DXVECTOR3                             tangent[2];     // 摩擦方向（法線から決める）
+    D3DXMATRIX                              invInertiaA;    // Aのワールド逆慣性テンソル
+    D3DXMATRIX                              invInertiaB;    // Bのワールド逆慣性テンソル
+    float                                   invMassA;       // Aの逆質量
+    float                                   invMassB;       // Bの逆質量
+    float                                   friction;       // 摩擦係数
+    std::array<ContactPoint, MAX_POINTS>    points;         // 接触点
+    int                                     numPoints;      // 接触点数
+    bool                                    isTouched;      // 今回のステップで接触したか
+
+private:
+    static constexpr float MATCH_DISTANCE  = 2.0f;  // 同じ点とみなす距離
+    static constexpr float MATCH_NORMAL    = 0.9f;  // 同じ法線とみなす内積
+};
+
+//=============================================================================
+// 接触キャッシュクラス（剛体の組をキーにフレームをまたいで保持）
+// 多様体の実体はアドレスの変わらない置き場に置き、キー順に並べた番号の表だけを毎ステップ作り直す
+// ナローフェーズの結果はキー順に届くので、前のステップの表と先頭から突き合わせるだけで引き継げる
+//=============================================================================
+class ContactCache
+{
+public:
+    ContactCache() : m_Cursor(0) {}
+
+    // ペアの多様体を取得（なければ作成）。BeginStep～EndStepの間にキーの昇順で呼ぶ
+    ContactManifold& Find(RigidBody* a, RigidBody* b);
+
+    // ステップ開始（削除予約された剛体の多様体を捨ててから突き合わせを始める）
+    void BeginStep(void);
+
+    // 今回接触しなかった多様体を捨てる（スリープ中のペアは残す）
+    void EndStep(void);
+
+    // スナップショットから戻すときの作り直し（前の表とは突き合わせず、count個の多様体を置き場の先頭から詰め直す）
+    // ResetForRestoreのあとにAppendRestoredをキーの昇順でcount回呼ぶ
+    void ResetForRestore(int count);
+    ContactManifold& AppendRestored(RigidBody* a, RigidBody* b, unsigned long long key);
+
+    // 剛体の削除を予約する（多様体は次のステップ開始時にまとめて捨てる）
+    void RemoveBody(const RigidBody* body) { m_RemovedBodies.insert(body); }
+
+    // 削除予約された剛体の多様体をいま捨てる
+    void PurgeRemovedBodies(void);
+
+    void Clear(void);
+
+    // 残っている多様体（キー順）
+    int GetManifoldCount(void) const { return (int)m_Entries.size(); }
+    unsigned long long GetKey(int index) const { return m_Entries[index].key; }
+    const ContactManifold& GetManifold(int index) const { return m_Storage[m_Entries[index].index]; }
+
+    // 前のステップの多様体を読むだけで探す（なければnullptr）。ナローフェーズの間は表が変わらないので並列に呼べる
+    const ContactManifold* FindPrevious(unsigned long long key) const;
+
+    // 剛体の組のキー（プール内の番号A・B、ナローフェーズの結果のキーと同じ）
+    static unsigned long long MakeKey(const RigidBody* a, const RigidBody* b);
+
+private:
+    // キーと多様体の置き場の番号
+    struct Entry
+    {
+        unsigned long long  key;    // 剛体の組のキー
+        int                 index;  // m_Storageの番号
+    };
+
+    std::deque<ContactManifold>             m_Storage;          // 多様体の実体（push_backでアドレスが変わらない）
+    std::vector<int>                        m_FreeIndices;      // 空いている置き場の番号
+    std::vector<Entry>                      m_Entries;          // 前のステップまでの多様体（キー順）
+    std::vector<Entry>                      m_NextEntries;      // 今回のステップで取得された多様体（キー順）
+    std::vector<Entry>                      m_Untouched;        // 今回取得されなかった前の多様体（キー順）
+    size_t                                  m_Cursor;           // m_Entriesの突き合わせ位置
+    std::unordered_set<const RigidBody*>    m_RemovedBodies;    // 削除予約された剛体
+};
+
+#endif
@@ -111,6 +111,21 @@ void CDebugProc3D::DrawCollider(Collider* shape, D3DXCOLOR color)
         // スフィアコライダーの描画
         DrawSphereCollider(sphere, color);
     }
+    else if (auto mesh = shape->As<MeshCollider>())
+    {
+        // メッシュコライダーの描画
+        DrawMeshCollider(mesh, color);
+    }
+    else if (auto compound = shape->As<CompoundCollider>())
+    {
+        // 複合コライダーの描画
+        DrawCompoundCollider(compound, color);
+    }
+    else if (auto convex = shape->As<ConvexCollider>())
+    {
+        // 凸包コライダーの描画
+        DrawConvexCollider(convex, color);
+    }
 }
 //=============================================================================
 // ボックスコライダー描画処理
@@ -402,3 +417,78 @@ void CDebugProc3D::DrawSphereCollider(SphereCollider* sphere, D3DXCOLOR color)
             center + D3DXVECTOR3(cosf(t2), 0, sinf(t2)) * r, color);
     }
 }
+//=============================================================================
+// メッシュコライダー描画処理（三角形の辺をワールド座標のまま描く）
+//=============================================================================
+void CDebugProc3D::DrawMeshCollider(MeshCollider* mesh, D3DXCOLOR color)
+{
+    if (!mesh || !m_pLine)
+    {
+        return;
+    }
+
+    // デバイスの取得
+    LPDIRECT3DDEVICE9 pDevice = CManager::GetRenderer()->GetDevice();
+
+    // 三角形はワールドで取り出すので単位行列
+    D3DXMATRIX matWorld;
+    D3DXMatrixIdentity(&matWorld);
+    pDevice->SetTransform(D3DTS_WORLD, &matWorld);
+
+    int numTriangles = std::min(mesh->GetTriangleCount(), MAX_MESH_TRIANGLES);
+
+    for (int nCnt = 0; nCnt < numTriangles; nCnt++)
+    {
+        D3DXVECTOR3 v[3];
+        D3DXVECTOR3 normal;
+        mesh->GetTriangle(nCnt, v, normal);
+
+        DrawLine3D(v[0], v[1], color);
+        DrawLine3D(v[1], v[2], color);
+        DrawLine3D(v[2], v[0], color);
+    }
+}
+//=============================================================================
+// 複合コライダー描画処理（子はワールドの位置・回転を持っているのでそれぞれ描く）
+//=============================================================================
+void CDebugProc3D::DrawCompoundCollider(CompoundCollider* compound, D3DXCOLOR color)
+{
+    if (!compound || !m_pLine)
+    {
+        return;
+    }
+
+    for (int nCnt = 0; nCnt < compound->GetChildCount(); nCnt++)
+    {
+        DrawCollider(compound->GetChild(nCnt), color);
+    }
+}
+//=============================================================================
+// 凸包コライダー描画処理（三角形の辺をワールド座標のまま描く）
+//=============================================================================
+void CDebugProc3D::DrawConvexCollider(ConvexCollider* convex, D3DXCOLOR color)
+{
+    if (!convex || !m_pLine)
+    {
+        return;
+    }
+
+    // デバイスの取得
+    LPDIRECT3DDEVICE9 pDevice = CManager::GetRenderer()->GetDevice();
+
+    // 頂点はワールドで持っているので単位行列
+    D3DXMATRIX matWorld;
+    D3DXMatrixIdentity(&matWorld);
+    pDevice->SetTransform(D3DTS_WORLD, &matWorld);
+
+    for (int nCnt = 0; nCnt < convex->GetTriangleCount(); nCnt++)
+    {
+        D3DXVECTOR3 v[3];
+        D3DXVECTOR3 normal;
+        convex->GetTriangle(nCnt, v, normal);
+
+        DrawLine3D(v[0], v[1], color);
+        DrawLine3D(v[1], v[2], color);
+        DrawLine3D(v[2], v[0], color);
+    }
+}
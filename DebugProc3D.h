@@ -33,11 +33,15 @@ public:
 	static void DrawCapsuleCollider(CapsuleCollider* capsule, D3DXCOLOR color);
 	static void DrawCylinderCollider(CylinderCollider* cylinder, D3DXCOLOR color);
 	static void DrawSphereCollider(SphereCollider* sphere, D3DXCOLOR color);
+	static void DrawMeshCollider(MeshCollider* mesh, D3DXCOLOR color);
+	static void DrawCompoundCollider(CompoundCollider* compound, D3DXCOLOR color);
+	static void DrawConvexCollider(ConvexCollider* convex, D3DXCOLOR color);
 
 private:
 	static constexpr int	VERTEX	= 8;		// 頂点数
 	static constexpr float	HALF	= 0.5f;		// 半分
 	static constexpr float	DOUBLE	= 2.0f;		// 二倍
+	static constexpr int	MAX_MESH_TRIANGLES = 8192;	// メッシュで描く最大の三角形数（重くなりすぎないように）
 
 	static LPD3DXLINE m_pLine;   // ライン描画用オブジェクト
 
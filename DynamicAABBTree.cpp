@@ -0,0 +1,625 @@
+//=============================================================================
+//
+// 動的AABBツリー処理 [DynamicAABBTree.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "DynamicAABBTree.h"
+#include "RigidBody.h"
+#include "algorithm"
+#include "iterator"
+
+//=============================================================================
+// コンストラクタ
+//=============================================================================
+DynamicAABBTree::DynamicAABBTree() : Broadphase(DYNAMIC_AABB_TREE)
+{
+    // 値のクリア
+    m_Root          = NULL_NODE;    // 根ノード
+    m_FreeNode      = NULL_NODE;    // 空きノード
+    m_NumProxies    = 0;            // プロキシ数
+}
+//=============================================================================
+// 面積の計算
+//=============================================================================
+float DynamicAABBTree::SurfaceArea(const AABB& box)
+{
+    D3DXVECTOR3 d = box.max - box.min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+//=============================================================================
+// 2つのAABBを囲むAABB
+//=============================================================================
+AABB DynamicAABBTree::Combine(const AABB& a, const AABB& b)
+{
+    AABB out;
+    out.min = D3DXVECTOR3(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z));
+    out.max = D3DXVECTOR3(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z));
+    return out;
+}
+//=============================================================================
+// outerがinnerを完全に含むかどうか
+//=============================================================================
+bool DynamicAABBTree::Contains(const AABB& outer, const AABB& inner)
+{
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+           inner.max.x <= outer.max.x && inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+}
+//=============================================================================
+// 太らせたAABBの作成
+//=============================================================================
+AABB DynamicAABBTree::MakeFatAABB(RigidBody* body) const
+{
+    AABB box = body->GetColliderPtr()->GetAABB();
+    box.Expand(FAT_MARGIN);
+    return box;
+}
+//=============================================================================
+// ノードの確保
+//=============================================================================
+int DynamicAABBTree::AllocateNode(void)
+{
+    int nodeId = m_FreeNode;
+
+    if (nodeId == NULL_NODE)
+    {
+        nodeId = (int)m_Nodes.size();
+        m_Nodes.push_back({});
+    }
+    else
+    {
+        m_FreeNode = m_Nodes[nodeId].parent;
+    }
+
+    Node& node = m_Nodes[nodeId];
+    node.body = nullptr;
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 0;
+
+    return nodeId;
+}
+//=============================================================================
+// ノードの解放
+//=============================================================================
+void DynamicAABBTree::FreeNode(int nodeId)
+{
+    Node& node = m_Nodes[nodeId];
+    node.body = nullptr;
+    node.child1 = NULL_NODE;
+    node.height = -1;
+    node.parent = m_FreeNode;
+    m_FreeNode = nodeId;
+}
+//=============================================================================
+// プロキシの生成処理
+//=============================================================================
+int DynamicAABBTree::CreateProxy(RigidBody* body)
+{
+    int proxyId = AllocateNode();
+
+    m_Nodes[proxyId].body = body;
+    m_Nodes[proxyId].box = MakeFatAABB(body);
+    m_Nodes[proxyId].tight = body->GetColliderPtr()->GetAABB();
+    m_Nodes[proxyId].tight.Expand(TIGHT_MARGIN);
+
+    InsertLeaf(proxyId);
+    m_MoveBuffer.push_back(proxyId);
+    m_NumProxies++;
+
+    return proxyId;
+}
+//=============================================================================
+// プロキシの破棄処理
+//=============================================================================
+void DynamicAABBTree::DestroyProxy(int proxyId)
+{
+    if (proxyId < 0 || proxyId >= (int)m_Nodes.size() || !m_Nodes[proxyId].body)
+    {
+        return;
+    }
+
+    RemoveLeaf(proxyId);
+    FreeNode(proxyId);
+    m_NumProxies--;
+}
+//=============================================================================
+// プロキシの移動処理
+//=============================================================================
+void DynamicAABBTree::MoveProxy(int proxyId, const D3DXVECTOR3& motion)
+{
+    if (proxyId < 0 || proxyId >= (int)m_Nodes.size() || !m_Nodes[proxyId].body)
+    {
+        return;
+    }
+
+    Node& node = m_Nodes[proxyId];
+    AABB tight = node.body->GetColliderPtr()->GetAABB();
+    tight.Sweep(motion);
+
+    node.tight = tight;
+    node.tight.Expand(TIGHT_MARGIN);
+
+    // 太いAABBの中に収まっている間はツリーを触らない
+    if (Contains(node.box, tight))
+    {
+        return;
+    }
+
+    RemoveLeaf(proxyId);
+    tight.Expand(FAT_MARGIN);
+    m_Nodes[proxyId].box = tight;
+    InsertLeaf(proxyId);
+
+    m_MoveBuffer.push_back(proxyId);
+}
+//=============================================================================
+// 葉の挿入処理
+//=============================================================================
+void DynamicAABBTree::InsertLeaf(int leaf)
+{
+    if (m_Root == NULL_NODE)
+    {
+        m_Root = leaf;
+        m_Nodes[m_Root].parent = NULL_NODE;
+        return;
+    }
+
+    // 面積の増加が最も小さい兄弟を探す
+    AABB leafBox = m_Nodes[leaf].box;
+    int index = m_Root;
+
+    while (!m_Nodes[index].IsLeaf())
+    {
+        const Node& node = m_Nodes[index];
+        int child1 = node.child1;
+        int child2 = node.child2;
+
+        float area = SurfaceArea(node.box);
+        float combinedArea = SurfaceArea(Combine(node.box, leafBox));
+
+        // ここに新しい親を作るコスト
+        float cost = 2.0f * combinedArea;
+
+        // 下に降りる場合に祖先が大きくなるコスト
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int child)
+        {
+            const Node& c = m_Nodes[child];
+            float newArea = SurfaceArea(Combine(leafBox, c.box));
+            return (c.IsLeaf() ? newArea : newArea - SurfaceArea(c.box)) + inheritanceCost;
+        };
+
+        float cost1 = descendCost(child1);
+        float cost2 = descendCost(child2);
+
+        if (cost < cost1 && cost < cost2)
+        {
+            break;
+        }
+
+        index = (cost1 < cost2) ? child1 : child2;
+    }
+
+    int sibling = index;
+
+    // 新しい親を作る
+    int oldParent = m_Nodes[sibling].parent;
+    int newParent = AllocateNode();
+    m_Nodes[newParent].parent = oldParent;
+    m_Nodes[newParent].box = Combine(leafBox, m_Nodes[sibling].box);
+    m_Nodes[newParent].height = m_Nodes[sibling].height + 1;
+    m_Nodes[newParent].child1 = sibling;
+    m_Nodes[newParent].child2 = leaf;
+    m_Nodes[sibling].parent = newParent;
+    m_Nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_NODE)
+    {
+        if (m_Nodes[oldParent].child1 == sibling)
+        {
+            m_Nodes[oldParent].child1 = newParent;
+        }
+        else
+        {
+            m_Nodes[oldParent].child2 = newParent;
+        }
+    }
+    else
+    {
+        m_Root = newParent;
+    }
+
+    // 親をたどってAABBと高さを直す
+    index = m_Nodes[leaf].parent;
+    while (index != NULL_NODE)
+    {
+        index = Balance(index);
+
+        Node& node = m_Nodes[index];
+        node.height = 1 + std::max(m_Nodes[node.child1].height, m_Nodes[node.child2].height);
+        node.box = Combine(m_Nodes[node.child1].box, m_Nodes[node.child2].box);
+
+        index = node.parent;
+    }
+}
+//=============================================================================
+// 葉の削除処理
+//=============================================================================
+void DynamicAABBTree::RemoveLeaf(int leaf)
+{
+    if (leaf == m_Root)
+    {
+        m_Root = NULL_NODE;
+        return;
+    }
+
+    int parent = m_Nodes[leaf].parent;
+    int grandParent = m_Nodes[parent].parent;
+    int sibling = (m_Nodes[parent].child1 == leaf) ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+
+    if (grandParent == NULL_NODE)
+    {
+        m_Root = sibling;
+        m_Nodes[sibling].parent = NULL_NODE;
+        FreeNode(parent);
+        return;
+    }
+
+    // 親を消して兄弟を祖父につなぐ
+    if (m_Nodes[grandParent].child1 == parent)
+    {
+        m_Nodes[grandParent].child1 = sibling;
+    }
+    else
+    {
+        m_Nodes[grandParent].child2 = sibling;
+    }
+
+    m_Nodes[sibling].parent = grandParent;
+    FreeNode(parent);
+
+    int index = grandParent;
+    while (index != NULL_NODE)
+    {
+        index = Balance(index);
+
+        Node& node = m_Nodes[index];
+        node.box = Combine(m_Nodes[node.child1].box, m_Nodes[node.child2].box);
+        node.height = 1 + std::max(m_Nodes[node.child1].height, m_Nodes[node.child2].height);
+
+        index = node.parent;
+    }
+}
+//=============================================================================
+// 回転による平衡化処理（新しい部分木の根を返す）
+//=============================================================================
+int DynamicAABBTree::Balance(int iA)
+{
+    Node* A = &m_Nodes[iA];
+
+    if (A->IsLeaf() || A->height < 2)
+    {
+        return iA;
+    }
+
+    int iB = A->child1;
+    int iC = A->child2;
+    Node* B = &m_Nodes[iB];
+    Node* C = &m_Nodes[iC];
+
+    int balance = C->height - B->height;
+
+    // Cを持ち上げる
+    if (balance > 1)
+    {
+        int iF = C->child1;
+        int iG = C->child2;
+        Node* F = &m_Nodes[iF];
+        Node* G = &m_Nodes[iG];
+
+        C->child1 = iA;
+        C->parent = A->parent;
+        A->parent = iC;
+
+        if (C->parent != NULL_NODE)
+        {
+            if (m_Nodes[C->parent].child1 == iA)
+            {
+                m_Nodes[C->parent].child1 = iC;
+            }
+            else
+            {
+                m_Nodes[C->parent].child2 = iC;
+            }
+        }
+        else
+        {
+            m_Root = iC;
+        }
+
+        if (F->height > G->height)
+        {
+            C->child2 = iF;
+            A->child2 = iG;
+            G->parent = iA;
+            A->box = Combine(B->box, G->box);
+            C->box = Combine(A->box, F->box);
+            A->height = 1 + std::max(B->height, G->height);
+            C->height = 1 + std::max(A->height, F->height);
+        }
+        else
+        {
+            C->child2 = iG;
+            A->child2 = iF;
+            F->parent = iA;
+            A->box = Combine(B->box, F->box);
+            C->box = Combine(A->box, G->box);
+            A->height = 1 + std::max(B->height, F->height);
+            C->height = 1 + std::max(A->height, G->height);
+        }
+
+        return iC;
+    }
+
+    // Bを持ち上げる
+    if (balance < -1)
+    {
+        int iD = B->child1;
+        int iE = B->child2;
+        Node* D = &m_Nodes[iD];
+        Node* E = &m_Nodes[iE];
+
+        B->child1 = iA;
+        B->parent = A->parent;
+        A->parent = iB;
+
+        if (B->parent != NULL_NODE)
+        {
+            if (m_Nodes[B->parent].child1 == iA)
+            {
+                m_Nodes[B->parent].child1 = iB;
+            }
+            else
+            {
+                m_Nodes[B->parent].child2 = iB;
+            }
+        }
+        else
+        {
+            m_Root = iB;
+        }
+
+        if (D->height > E->height)
+        {
+            B->child2 = iD;
+            A->child1 = iE;
+            E->parent = iA;
+            A->box = Combine(C->box, E->box);
+            B->box = Combine(A->box, D->box);
+            A->height = 1 + std::max(C->height, E->height);
+            B->height = 1 + std::max(A->height, D->height);
+        }
+        else
+        {
+            B->child2 = iE;
+            A->child1 = iD;
+            D->parent = iA;
+            A->box = Combine(C->box, D->box);
+            B->box = Combine(A->box, E->box);
+            A->height = 1 + std::max(C->height, D->height);
+            B->height = 1 + std::max(A->height, E->height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+//=============================================================================
+// 衝突候補ペアの更新処理
+//=============================================================================
+void DynamicAABBTree::UpdatePairs(std::vector<BroadphasePair>& outPairs)
+{
+    m_NewPairIds.clear();
+
+    // 太いAABBが変わった葉だけツリーに問い合わせる
+    for (int queryId : m_MoveBuffer)
+    {
+        if (queryId >= (int)m_Nodes.size() || !m_Nodes[queryId].body || !m_Nodes[queryId].IsLeaf())
+        {
+            continue;
+        }
+
+        const AABB& queryBox = m_Nodes[queryId].box;
+        const RigidBody* queryBody = m_Nodes[queryId].body;
+
+        m_Stack.clear();
+        m_Stack.push_back(m_Root);
+
+        while (!m_Stack.empty())
+        {
+            int nodeId = m_Stack.back();
+            m_Stack.pop_back();
+
+            if (nodeId == NULL_NODE)
+            {
+                continue;
+            }
+
+            const Node& node = m_Nodes[nodeId];
+
+            if (!node.box.Overlaps(queryBox))
+            {
+                continue;
+            }
+
+            if (node.IsLeaf())
+            {
+                // レイヤーとマスクで外れる組はナローフェーズに渡さない
+                if (nodeId != queryId && queryBody->CanCollideWith(node.body))
+                {
+                    m_NewPairIds.push_back({ std::min(nodeId, queryId), std::max(nodeId, queryId) });
+                }
+            }
+            else
+            {
+                m_Stack.push_back(node.child1);
+                m_Stack.push_back(node.child2);
+            }
+        }
+    }
+
+    m_MoveBuffer.clear();
+
+    // 今回のペアだけ並べ、並んだままの継続中のペアに混ぜる（全体を並べ直さない）
+    std::sort(m_NewPairIds.begin(), m_NewPairIds.end());
+    m_NewPairIds.erase(std::unique(m_NewPairIds.begin(), m_NewPairIds.end()), m_NewPairIds.end());
+
+    m_MergedPairIds.clear();
+    m_MergedPairIds.reserve(m_PairIds.size() + m_NewPairIds.size());
+    std::set_union(m_PairIds.begin(), m_PairIds.end(), m_NewPairIds.begin(), m_NewPairIds.end(), std::back_inserter(m_MergedPairIds));
+    m_PairIds.swap(m_MergedPairIds);
+
+    // 離れたペア・削除されたプロキシのペアを取り除く
+    m_PairIds.erase(std::remove_if(m_PairIds.begin(), m_PairIds.end(),
+        [this](const std::pair<int, int>& ids)
+        {
+            const Node& a = m_Nodes[ids.first];
+            const Node& b = m_Nodes[ids.second];
+
+            if (!a.body || !b.body || !a.IsLeaf() || !b.IsLeaf())
+            {
+                return true;
+            }
+
+            // 続いている組もレイヤーやマスクが変わったら外す
+            return !a.box.Overlaps(b.box) || !a.body->CanCollideWith(b.body);
+        }),
+        m_PairIds.end());
+
+    outPairs.clear();
+    outPairs.reserve(m_PairIds.size());
+
+    // 太いAABBで続けているだけの組はナローフェーズに渡さない
+    for (const auto& ids : m_PairIds)
+    {
+        const Node& a = m_Nodes[ids.first];
+        const Node& b = m_Nodes[ids.second];
+
+        if (a.tight.Overlaps(b.tight))
+        {
+            outPairs.push_back({ a.body, b.body });
+        }
+    }
+}
+//=============================================================================
+// AABBの問い合わせ処理
+//=============================================================================
+void DynamicAABBTree::QueryAABB(const AABB& box, std::vector<RigidBody*>& out) const
+{
+    if (m_Root == NULL_NODE)
+    {
+        return;
+    }
+
+    int stack[MAX_QUERY_STACK];
+    int top = 0;
+    stack[top++] = m_Root;
+
+    while (top > 0)
+    {
+        const Node& node = m_Nodes[stack[--top]];
+
+        if (!node.box.Overlaps(box))
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            out.push_back(node.body);
+            continue;
+        }
+
+        stack[top++] = node.child1;
+        stack[top++] = node.child2;
+    }
+}
+//=============================================================================
+// レイの問い合わせ処理（近い子から調べ、funcが返した距離より先の枝は捨てる）
+//=============================================================================
+void DynamicAABBTree::QueryRay(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, const D3DXVECTOR3& extent, const RayQueryFunc& func) const
+{
+    if (m_Root == NULL_NODE)
+    {
+        return;
+    }
+
+    D3DXVECTOR3 invDir = AABB::InverseDirection(dir);
+
+    float enter = 0.0f;
+
+    if (!m_Nodes[m_Root].box.IntersectRay(origin, invDir, maxDist, extent, enter))
+    {
+        return;
+    }
+
+    int stack[MAX_QUERY_STACK];
+    float stackEnter[MAX_QUERY_STACK];
+    int top = 0;
+
+    stack[top] = m_Root;
+    stackEnter[top++] = enter;
+
+    while (top > 0)
+    {
+        top--;
+
+        if (stackEnter[top] > maxDist)
+        {
+            continue;
+        }
+
+        const Node& node = m_Nodes[stack[top]];
+
+        if (node.IsLeaf())
+        {
+            maxDist = std::min(maxDist, func(node.body, maxDist));
+            continue;
+        }
+
+        int near = node.child1;
+        int far = node.child2;
+
+        float enterNear = 0.0f;
+        float enterFar = 0.0f;
+        bool isHitNear = m_Nodes[near].box.IntersectRay(origin, invDir, maxDist, extent, enterNear);
+        bool isHitFar = m_Nodes[far].box.IntersectRay(origin, invDir, maxDist, extent, enterFar);
+
+        // 遠い方を先に積んで近い方から調べる
+        if (isHitNear && isHitFar && enterNear > enterFar)
+        {
+            std::swap(near, far);
+            std::swap(enterNear, enterFar);
+        }
+
+        if (isHitFar)
+        {
+            stack[top] = far;
+            stackEnter[top++] = enterFar;
+        }
+
+        if (isHitNear)
+        {
+            stack[top] = near;
+            stackEnter[top++] = enterNear;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+//=============================================================================
+//
+// 動的AABBツリー処理 [DynamicAABBTree.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _DYNAMICAABBTREE_H_// このマクロ定義がされていなかったら
+#define _DYNAMICAABBTREE_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "Broadphase.h"
+
+//=============================================================================
+// 動的AABBツリー（ブロードフェーズ）クラス
+//=============================================================================
+class DynamicAABBTree : public Broadphase
+{
+public:
+    DynamicAABBTree();
+
+    int CreateProxy(RigidBody* body) override;
+    void DestroyProxy(int proxyId) override;
+    void MoveProxy(int proxyId, const D3DXVECTOR3& motion) override;
+
+    // 動いたプロキシだけツリーに問い合わせてペアを更新
+    void UpdatePairs(std::vector<BroadphasePair>& outPairs) override;
+
+    // 問い合わせ
+    void QueryAABB(const AABB& box, std::vector<RigidBody*>& out) const override;
+    void QueryRay(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, const D3DXVECTOR3& extent, const RayQueryFunc& func) const override;
+
+    int GetProxyCount(void) const override { return m_NumProxies; }
+    int GetHeight(void) const { return m_Root == NULL_NODE ? 0 : m_Nodes[m_Root].height; }
+
+private:
+    // ツリーのノード
+    struct Node
+    {
+        AABB        box;        // 太らせたAABB（葉）/ 子を囲むAABB（枝）
+        AABB        tight;      // 葉の剛体のAABB（移動量と押し戻しの余裕を含む。ペアの出力に使う）
+        RigidBody*  body;       // 葉のときの剛体
+        int         parent;     // 親（空きノードのときは次の空きノード）
+        int         child1;     // 子1
+        int         child2;     // 子2
+        int         height;     // 葉は0、空きノードは-1
+
+        bool IsLeaf(void) const { return child1 == NULL_NODE; }
+    };
+
+    int AllocateNode(void);
+    void FreeNode(int nodeId);
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    int Balance(int iA);
+    AABB MakeFatAABB(RigidBody* body) const;
+
+    // 面積（挿入コスト用）
+    static float SurfaceArea(const AABB& box);
+    static AABB Combine(const AABB& a, const AABB& b);
+    static bool Contains(const AABB& outer, const AABB& inner);
+
+    static constexpr int    NULL_NODE       = -1;   // 無効ノード
+    static constexpr float  FAT_MARGIN      = 8.0f; // AABBを太らせる量
+    static constexpr float  TIGHT_MARGIN    = 2.0f; // 出力するペアの判定に足す押し戻し分の余裕（スイープ＆プルーンと同じ）
+    static constexpr int    MAX_QUERY_STACK = 256;  // 問い合わせの探索スタックの深さ
+
+    std::vector<Node>                   m_Nodes;        // ノード
+    std::vector<int>                    m_MoveBuffer;   // 前回から太いAABBが変わった葉
+    std::vector<int>                    m_Stack;        // 探索用スタック
+    std::vector<std::pair<int, int>>    m_PairIds;      // 継続中のペア（ソート済み）
+    std::vector<std::pair<int, int>>    m_NewPairIds;   // 今回見つかったペア
+    std::vector<std::pair<int, int>>    m_MergedPairIds;// 継続中のペアと今回のペアを混ぜた結果（使い回す）
+    int                                 m_Root;         // 根ノード
+    int                                 m_FreeNode;     // 空きノードの先頭
+    int                                 m_NumProxies;   // プロキシ数
+};
+
+#endif
@@ -12,6 +12,7 @@
 #include "Manager.h"
 #include "SkyCube.h"
 #include "Parameter.h"
+#include "chrono"
 
 //*****************************************************************************
 // 静的メンバ変数宣言
@@ -45,6 +46,9 @@ CEdit::CEdit() : CScene(CScene::MODE_EDIT)
 {
 	// 値のクリア
 	m_pPlayer = nullptr;
+	m_PlayState = PLAYSTATE_EDIT;
+	m_StopTime = 0.0f;
+	m_isRestoreFailed = false;
 }
 //=============================================================================
 // デストラクタ
@@ -73,8 +77,12 @@ HRESULT CEdit::Init(void)
 	// グリッドの初期化
 	m_pGrid->Init();
 
+	// 編集から始めるので物理は止めておく
+	m_pBlockManager->SetPlaying(false);
+	CManager::GetPhysicsWorld()->SetPaused(true);
+
 	// JSONの読み込み
-	m_pBlockManager->LoadFromJson("data/STAGE/test.json");
+	m_pBlockManager->LoadFromJson(START_STAGE);
 
 	// プレイヤーの生成
 	m_pPlayer = CPlayer::Create(Create::PLAYER_POS, INIT_VEC3);
@@ -94,10 +102,154 @@ void CEdit::Uninit(void)
 //=============================================================================
 void CEdit::Update(void)
 {
+	// 再生・停止の操作
+	UpdatePlayControl();
+
 	// ブロックマネージャーの更新処理
 	m_pBlockManager->Update();
 }
 //=============================================================================
+// 再生・停止の操作処理
+//=============================================================================
+void CEdit::UpdatePlayControl(void)
+{
+	// 場所
+	CImGuiManager::Instance().SetPosImgui(ImVec2(960.0f, 20.0f));
+
+	// サイズ
+	CImGuiManager::Instance().SetSizeImgui(ImVec2(360.0f, 110.0f));
+
+	CImGuiManager::Instance().StartImgui(u8"Play", CImGuiManager::IMGUITYPE_DEFOULT);
+
+	static const char* STATE_NAME[PLAYSTATE_MAX] = { "Edit", "Play", "Pause" };
+
+	ImGui::Text("Mode: %s", STATE_NAME[m_PlayState]);
+
+	if (m_PlayState != PLAYSTATE_PLAY && ImGui::Button("Play"))
+	{
+		Play();
+	}
+	else if (m_PlayState == PLAYSTATE_PLAY && ImGui::Button("Pause"))
+	{
+		Pause();
+	}
+
+	ImGui::SameLine();
+
+	// 1ステップ進めるのは一時停止中だけ
+	ImGui::BeginDisabled(m_PlayState != PLAYSTATE_PAUSE);
+
+	if (ImGui::Button("Step"))
+	{
+		CManager::GetPhysicsWorld()->RequestStep();
+	}
+
+	ImGui::EndDisabled();
+
+	ImGui::SameLine();
+
+	ImGui::BeginDisabled(m_PlayState == PLAYSTATE_EDIT);
+
+	if (ImGui::Button("Stop"))
+	{
+		Stop();
+	}
+
+	ImGui::EndDisabled();
+
+	if (m_isRestoreFailed)
+	{
+		ImGui::Text("Restore failed (bodies changed during play)");
+	}
+	else if (m_StopTime > 0.0f)
+	{
+		ImGui::Text("Last stop %.2f ms", m_StopTime);
+	}
+
+	ImGui::End();
+}
+//=============================================================================
+// 再生処理
+//=============================================================================
+void CEdit::Play(void)
+{
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
+
+	// 編集から始めるときだけ戻す先を残す（一時停止からの再開はそのまま）
+	if (m_PlayState == PLAYSTATE_EDIT)
+	{
+		std::vector<CBlock*>& blocks = CBlockManager::GetAllBlocks();
+
+		m_BlockTransforms.resize(blocks.size());
+
+		for (size_t nCnt = 0; nCnt < blocks.size(); nCnt++)
+		{
+			m_BlockTransforms[nCnt] = { blocks[nCnt], blocks[nCnt]->GetPos(), blocks[nCnt]->GetRot() };
+		}
+
+		// メッシュやオブジェクトは作り直さず、剛体の状態だけ残す
+		pWorld->SaveSnapshot(m_Snapshot);
+
+		m_pBlockManager->SetPlaying(true);
+
+		// 再生中は静的ブロックが動かないのでBVHを焼き込む
+		pWorld->BakeStaticWorld();
+	}
+
+	pWorld->SetPaused(false);
+
+	m_PlayState = PLAYSTATE_PLAY;
+}
+//=============================================================================
+// 一時停止処理
+//=============================================================================
+void CEdit::Pause(void)
+{
+	CManager::GetPhysicsWorld()->SetPaused(true);
+
+	m_PlayState = PLAYSTATE_PAUSE;
+}
+//=============================================================================
+// 停止処理（再生を始めたときの状態にその場で戻す）
+//=============================================================================
+void CEdit::Stop(void)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
+
+	// 再生中は剛体を増やしたり消したりできないので、ふつうは全部戻せる
+	m_isRestoreFailed = !pWorld->RestoreSnapshot(m_Snapshot);
+
+	std::vector<CBlock*>& blocks = CBlockManager::GetAllBlocks();
+
+	if (!m_isRestoreFailed && blocks.size() == m_BlockTransforms.size())
+	{
+		for (size_t nCnt = 0; nCnt < blocks.size(); nCnt++)
+		{
+			const BlockTransform& saved = m_BlockTransforms[nCnt];
+
+			if (blocks[nCnt] != saved.pBlock)
+			{
+				continue;
+			}
+
+			saved.pBlock->SetPos(saved.pos);
+			saved.pBlock->SetRot(saved.rot);
+		}
+	}
+
+	// 戻せなかったときは今の位置のまま編集に戻る
+	m_pBlockManager->SetPlaying(false);
+	pWorld->UnbakeStaticWorld();
+	pWorld->SetPaused(true);
+
+	m_PlayState = PLAYSTATE_EDIT;
+
+	auto endTime = std::chrono::high_resolution_clock::now();
+	m_StopTime = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+}
+//=============================================================================
 // 描画処理
 //=============================================================================
 void CEdit::Draw(void)
@@ -33,15 +33,46 @@ public:
 	void ReleaseThumbnail(void) override;
 	void ResetThumbnail(void) override;
 
+	//*****************************************************************************
+	// 再生の状態
+	//*****************************************************************************
+	enum PLAYSTATE
+	{
+		PLAYSTATE_EDIT = 0,	// 編集中（物理は止めて置いた位置のまま）
+		PLAYSTATE_PLAY,		// 再生中
+		PLAYSTATE_PAUSE,	// 一時停止中（Stepで1ステップずつ進める）
+		PLAYSTATE_MAX
+	};
+
 	static CBlock* GetBlock(void) { return m_pBlock; }
 	static CBlockManager* GetBlockManager(void) { return m_pBlockManager.get(); }
 	static CImGuiManager* GetImGuiManager(void) { return m_pImGuiManager; }
+
+	static constexpr const char* START_STAGE = "data/STAGE/test.json";	// 起動時に読み込むステージ
 private:
+	void UpdatePlayControl(void);
+	void Play(void);
+	void Pause(void);
+	void Stop(void);
+
+	// 再生を始めたときのブロックの位置・向き
+	struct BlockTransform
+	{
+		CBlock*		pBlock;	// ブロック
+		D3DXVECTOR3	pos;	// 位置
+		D3DXVECTOR3	rot;	// 向き
+	};
+
 	static CBlock*							m_pBlock;			// ブロックへのポインタ
 	static std::unique_ptr<CBlockManager>	m_pBlockManager;	// ブロックマネージャーへのポインタ
 	static CImGuiManager*					m_pImGuiManager;	// ImGuiマネージャーへのポインタ
 	std::unique_ptr<CGrid>					m_pGrid;			// グリッドへのポインタ
 	CPlayer*								m_pPlayer;			// プレイヤーへのポインタ
+	PLAYSTATE								m_PlayState;		// 再生の状態
+	std::vector<unsigned char>				m_Snapshot;			// 再生を始めたときの物理の状態
+	std::vector<BlockTransform>				m_BlockTransforms;	// 再生を始めたときのブロックの位置・向き
+	float									m_StopTime;			// 停止で戻すのにかかった時間(ミリ秒)
+	bool									m_isRestoreFailed;	// 停止で戻せなかったか
 };
 
 #endif
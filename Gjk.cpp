@@ -0,0 +1,821 @@
+//=============================================================================
+//
+// 凸形状の判定処理 [Gjk.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "Gjk.h"
+#include "algorithm"
+
+//=============================================================================
+// コライダーからの凸形状の作成（球・カプセルは芯の点・線分と半径に分ける）
+//=============================================================================
+ConvexShape::ConvexShape(const Collider* col) : collider(col)
+{
+    switch (col->GetType())
+    {
+    case Collider::SPHERE:
+        radius = static_cast<const SphereCollider*>(col)->GetRadius();
+        break;
+    case Collider::CAPSULE:
+        radius = static_cast<const CapsuleCollider*>(col)->GetRadius();
+        break;
+    default:
+        radius = 0.0f;
+        break;
+    }
+}
+//=============================================================================
+// 芯の支持点の取得処理
+//=============================================================================
+D3DXVECTOR3 ConvexShape::SupportCore(const D3DXVECTOR3& dir) const
+{
+    if (collider == nullptr)
+    {
+        int best = 0;
+        float bestDot = D3DXVec3Dot(&points[0], &dir);
+
+        for (int nCnt = 1; nCnt < numPoints; nCnt++)
+        {
+            float dot = D3DXVec3Dot(&points[nCnt], &dir);
+
+            if (dot > bestDot)
+            {
+                bestDot = dot;
+                best = nCnt;
+            }
+        }
+
+        return points[best];
+    }
+
+    const D3DXVECTOR3& pos = collider->GetPosition();
+
+    switch (collider->GetType())
+    {
+    case Collider::BOX:
+    {
+        const BoxCollider* box = static_cast<const BoxCollider*>(collider);
+        const D3DXMATRIX& R = box->GetRotation();
+        const D3DXVECTOR3& size = box->GetScaledSize();
+        D3DXVECTOR3 axes[3] = { D3DXVECTOR3(R._11, R._12, R._13), D3DXVECTOR3(R._21, R._22, R._23), D3DXVECTOR3(R._31, R._32, R._33) };
+        D3DXVECTOR3 result = pos;
+
+        // 軸ごとにdirの向きの側の面を選ぶと角になる
+        for (int nAxis = 0; nAxis < 3; nAxis++)
+        {
+            float half = size[nAxis] * 0.5f;
+            result += axes[nAxis] * ((D3DXVec3Dot(&axes[nAxis], &dir) >= 0.0f) ? half : -half);
+        }
+
+        return result;
+    }
+    case Collider::CAPSULE:
+    {
+        const CapsuleCollider* capsule = static_cast<const CapsuleCollider*>(collider);
+        return (dir.y >= 0.0f) ? capsule->GetTop() : capsule->GetBottom();
+    }
+    case Collider::CYLINDER:
+    {
+        const CylinderCollider* cylinder = static_cast<const CylinderCollider*>(collider);
+        float halfHeight = cylinder->GetHeight() * 0.5f;
+        D3DXVECTOR3 result = pos + D3DXVECTOR3(0.0f, (dir.y >= 0.0f) ? halfHeight : -halfHeight, 0.0f);
+
+        // 横向きの成分があれば縁の点、真上・真下なら面の中心
+        float horizontal = sqrtf(dir.x * dir.x + dir.z * dir.z);
+
+        if (horizontal > 0.0f)
+        {
+            float scale = cylinder->GetRadius() / horizontal;
+            result.x += dir.x * scale;
+            result.z += dir.z * scale;
+        }
+
+        return result;
+    }
+    case Collider::CONVEX:
+        return static_cast<const ConvexCollider*>(collider)->GetSupport(dir);
+    default:
+        return pos;
+    }
+}
+//=============================================================================
+// 丸みを含めた支持点の取得処理
+//=============================================================================
+D3DXVECTOR3 ConvexShape::Support(const D3DXVECTOR3& dir) const
+{
+    D3DXVECTOR3 core = SupportCore(dir);
+    float length = D3DXVec3Length(&dir);
+
+    if (radius <= 0.0f || length <= 0.0f)
+    {
+        return core;
+    }
+
+    return core + dir * (radius / length);
+}
+//=============================================================================
+// 形状の中にある点の取得処理
+//=============================================================================
+D3DXVECTOR3 ConvexShape::GetCenter(void) const
+{
+    if (collider != nullptr)
+    {
+        return collider->GetPosition();
+    }
+
+    D3DXVECTOR3 center = INIT_VEC3;
+
+    for (int nCnt = 0; nCnt < numPoints; nCnt++)
+    {
+        center += points[nCnt];
+    }
+
+    return (numPoints > 0) ? center / (float)numPoints : center;
+}
+
+
+//=============================================================================
+// GJK/EPAで判定できる形状かどうか
+//=============================================================================
+bool Gjk::IsConvex(Collider::TYPE type)
+{
+    switch (type)
+    {
+    case Collider::BOX:
+    case Collider::CAPSULE:
+    case Collider::CYLINDER:
+    case Collider::SPHERE:
+    case Collider::CONVEX:
+        return true;
+    default:
+        return false;
+    }
+}
+//=============================================================================
+// 芯同士の最近接点の取得処理
+//=============================================================================
+bool Gjk::Distance(const ConvexShape& a, const ConvexShape& b, float maxDist,
+    D3DXVECTOR3& outOnA, D3DXVECTOR3& outOnB, float& outDist)
+{
+    Simplex simplex;
+    D3DXVECTOR3 v;
+
+    if (Run(a, b, maxDist, true, simplex, v) == RESULT_OVERLAP)
+    {
+        return false;
+    }
+
+    // 単体の重みで元の形状の点を合わせる
+    outOnA = INIT_VEC3;
+    outOnB = INIT_VEC3;
+
+    for (int nCnt = 0; nCnt < simplex.count; nCnt++)
+    {
+        outOnA += simplex.v[nCnt].a * simplex.weight[nCnt];
+        outOnB += simplex.v[nCnt].b * simplex.weight[nCnt];
+    }
+
+    outDist = D3DXVec3Length(&v);
+
+    return true;
+}
+//=============================================================================
+// 押し戻しの取得処理（芯が離れていれば最近接点から、重なっていればEPAで求める）
+//=============================================================================
+bool Gjk::Penetration(const ConvexShape& a, const ConvexShape& b, D3DXVECTOR3& outPush)
+{
+    float margin = a.radius + b.radius;
+    Simplex simplex;
+    D3DXVECTOR3 v;
+
+    switch (Run(a, b, margin, true, simplex, v))
+    {
+    case RESULT_SEPARATED:
+        return false;
+
+    case RESULT_CLOSEST:
+    {
+        // vはAの点 - Bの点なので、AからBへは-v
+        float dist = D3DXVec3Length(&v);
+
+        if (dist >= margin || dist <= 0.0f)
+        {
+            return false;
+        }
+
+        outPush = -v * ((margin - dist) / dist);
+        return true;
+    }
+
+    default:
+    {
+        D3DXVECTOR3 normal;
+        float depth = 0.0f;
+
+        // 芯のミンコフスキー差を広げ、丸みは一番近い面までの距離に足す（芯の単体と同じ点の取り方でないと多面体が凸でなくなる）
+        if (ExpandSimplex(a, b, true, simplex) && Epa(a, b, true, simplex, normal, depth))
+        {
+            depth += margin;
+        }
+        else
+        {
+            // 縦向きの線分同士など芯のミンコフスキー差がつぶれていれば、丸みを含めた形で囲み直す
+            if (Run(a, b, 0.0f, false, simplex, v) != RESULT_OVERLAP ||
+                !ExpandSimplex(a, b, false, simplex) || !Epa(a, b, false, simplex, normal, depth))
+            {
+                return false;
+            }
+        }
+
+        // ミンコフスキー差の外向きの法線は、Bを押し出す向き
+        outPush = normal * std::max(depth, 0.0f);
+        return true;
+    }
+    }
+}
+//=============================================================================
+// 単体の頂点の作成処理（isCoreなら丸みを除いた芯で取る）
+//=============================================================================
+Gjk::Vertex Gjk::MakeVertex(const ConvexShape& a, const ConvexShape& b, const D3DXVECTOR3& dir, bool isCore)
+{
+    Vertex vertex;
+    D3DXVECTOR3 opposite = -dir;
+
+    vertex.a = isCore ? a.SupportCore(dir) : a.Support(dir);
+    vertex.b = isCore ? b.SupportCore(opposite) : b.Support(opposite);
+    vertex.w = vertex.a - vertex.b;
+
+    return vertex;
+}
+//=============================================================================
+// GJKの本体（ミンコフスキー差A - Bの原点に一番近い点vを単体で詰めていく）
+//=============================================================================
+Gjk::RESULT Gjk::Run(const ConvexShape& a, const ConvexShape& b, float maxDist, bool isCore, Simplex& simplex, D3DXVECTOR3& outV)
+{
+    // 最初はBからAへ向かう向きの点から始める
+    D3DXVECTOR3 dir = b.GetCenter() - a.GetCenter();
+
+    if (D3DXVec3LengthSq(&dir) <= DEGENERATE_EPSILON)
+    {
+        dir = D3DXVECTOR3(1.0f, 0.0f, 0.0f);
+    }
+
+    simplex.v[0] = MakeVertex(a, b, dir, isCore);
+    simplex.weight[0] = 1.0f;
+    simplex.count = 1;
+
+    D3DXVECTOR3 v = simplex.v[0].w;
+    float maxDistSq = maxDist * maxDist;
+
+    for (int nIter = 0; nIter < GJK_MAX_ITERATIONS; nIter++)
+    {
+        float vv = D3DXVec3LengthSq(&v);
+
+        if (vv <= GJK_OVERLAP_DIST_SQ)
+        {
+            outV = v;
+            return RESULT_OVERLAP;
+        }
+
+        Vertex vertex = MakeVertex(a, b, -v, isCore);
+        float vw = D3DXVec3Dot(&v, &vertex.w);
+
+        // vの向きで分けたときの距離の下限(vw / |v|)がmaxDistを超えていれば離れている
+        if (vw > 0.0f && vw * vw > vv * maxDistSq)
+        {
+            outV = v;
+            return RESULT_SEPARATED;
+        }
+
+        // もう原点へ近づけない
+        if (vv - vw <= GJK_TOLERANCE * vv)
+        {
+            break;
+        }
+
+        bool isDuplicate = false;
+
+        for (int nCnt = 0; nCnt < simplex.count; nCnt++)
+        {
+            D3DXVECTOR3 diff = simplex.v[nCnt].w - vertex.w;
+
+            if (D3DXVec3LengthSq(&diff) <= GJK_OVERLAP_DIST_SQ)
+            {
+                isDuplicate = true;
+                break;
+            }
+        }
+
+        if (isDuplicate)
+        {
+            break;
+        }
+
+        simplex.v[simplex.count++] = vertex;
+
+        // 四面体が原点を囲んだ
+        if (!ClosestOnSimplex(simplex, v))
+        {
+            outV = INIT_VEC3;
+            return RESULT_OVERLAP;
+        }
+    }
+
+    outV = v;
+
+    return (D3DXVec3LengthSq(&v) <= GJK_OVERLAP_DIST_SQ) ? RESULT_OVERLAP : RESULT_CLOSEST;
+}
+//=============================================================================
+// 単体の原点に一番近い点の取得処理（使わない頂点は単体から外す。原点を囲んでいればfalse）
+//=============================================================================
+bool Gjk::ClosestOnSimplex(Simplex& simplex, D3DXVECTOR3& outV)
+{
+    switch (simplex.count)
+    {
+    case 1:
+        simplex.weight[0] = 1.0f;
+        outV = simplex.v[0].w;
+        return true;
+    case 2:
+        ClosestOnSegment(simplex, outV);
+        return true;
+    case 3:
+        ClosestOnTriangle(simplex, outV);
+        return true;
+    default:
+        return ClosestOnTetrahedron(simplex, outV);
+    }
+}
+//=============================================================================
+// 線分の原点に一番近い点の取得処理
+//=============================================================================
+void Gjk::ClosestOnSegment(Simplex& simplex, D3DXVECTOR3& outV)
+{
+    const D3DXVECTOR3& A = simplex.v[0].w;
+    D3DXVECTOR3 ab = simplex.v[1].w - A;
+    float denom = D3DXVec3LengthSq(&ab);
+    float t = (denom > DEGENERATE_EPSILON) ? -D3DXVec3Dot(&A, &ab) / denom : 0.0f;
+
+    if (t <= 0.0f)
+    {
+        simplex.count = 1;
+        simplex.weight[0] = 1.0f;
+    }
+    else if (t >= 1.0f)
+    {
+        simplex.v[0] = simplex.v[1];
+        simplex.count = 1;
+        simplex.weight[0] = 1.0f;
+    }
+    else
+    {
+        simplex.weight[0] = 1.0f - t;
+        simplex.weight[1] = t;
+    }
+
+    outV = INIT_VEC3;
+
+    for (int nCnt = 0; nCnt < simplex.count; nCnt++)
+    {
+        outV += simplex.v[nCnt].w * simplex.weight[nCnt];
+    }
+}
+//=============================================================================
+// 三角形の原点に一番近い点の取得処理（頂点・辺・面のどの領域にあるかで分ける）
+//=============================================================================
+void Gjk::ClosestOnTriangle(Simplex& simplex, D3DXVECTOR3& outV)
+{
+    Vertex A = simplex.v[0], B = simplex.v[1], C = simplex.v[2];
+    D3DXVECTOR3 ab = B.w - A.w;
+    D3DXVECTOR3 ac = C.w - A.w;
+
+    auto keep1 = [&](const Vertex& p)
+    {
+        simplex.v[0] = p;
+        simplex.weight[0] = 1.0f;
+        simplex.count = 1;
+        outV = p.w;
+    };
+
+    auto keep2 = [&](const Vertex& p, const Vertex& q, float t)
+    {
+        simplex.v[0] = p;
+        simplex.v[1] = q;
+        simplex.weight[0] = 1.0f - t;
+        simplex.weight[1] = t;
+        simplex.count = 2;
+        outV = p.w + (q.w - p.w) * t;
+    };
+
+    // Aの頂点の領域
+    D3DXVECTOR3 ap = -A.w;
+    float d1 = D3DXVec3Dot(&ab, &ap);
+    float d2 = D3DXVec3Dot(&ac, &ap);
+
+    if (d1 <= 0.0f && d2 <= 0.0f)
+    {
+        keep1(A);
+        return;
+    }
+
+    // Bの頂点の領域
+    D3DXVECTOR3 bp = -B.w;
+    float d3 = D3DXVec3Dot(&ab, &bp);
+    float d4 = D3DXVec3Dot(&ac, &bp);
+
+    if (d3 >= 0.0f && d4 <= d3)
+    {
+        keep1(B);
+        return;
+    }
+
+    // ABの辺の領域
+    float vc = d1 * d4 - d3 * d2;
+
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+        keep2(A, B, d1 / (d1 - d3));
+        return;
+    }
+
+    // Cの頂点の領域
+    D3DXVECTOR3 cp = -C.w;
+    float d5 = D3DXVec3Dot(&ab, &cp);
+    float d6 = D3DXVec3Dot(&ac, &cp);
+
+    if (d6 >= 0.0f && d5 <= d6)
+    {
+        keep1(C);
+        return;
+    }
+
+    // ACの辺の領域
+    float vb = d5 * d2 - d1 * d6;
+
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+        keep2(A, C, d2 / (d2 - d6));
+        return;
+    }
+
+    // BCの辺の領域
+    float va = d3 * d6 - d5 * d4;
+
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    {
+        keep2(B, C, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        return;
+    }
+
+    // 面の内側
+    float sum = va + vb + vc;
+
+    if (sum <= 0.0f)
+    {
+        keep1(A);
+        return;
+    }
+
+    float v = vb / sum;
+    float w = vc / sum;
+
+    simplex.weight[0] = 1.0f - v - w;
+    simplex.weight[1] = v;
+    simplex.weight[2] = w;
+    outV = A.w + ab * v + ac * w;
+}
+//=============================================================================
+// 四面体の原点に一番近い点の取得処理（原点が外側にある面の中で一番近いもの）
+//=============================================================================
+bool Gjk::ClosestOnTetrahedron(Simplex& simplex, D3DXVECTOR3& outV)
+{
+    // 面の3頂点と反対側の頂点
+    static const int faces[4][4] =
+    {
+        { 0, 1, 2, 3 },
+        { 0, 3, 1, 2 },
+        { 0, 2, 3, 1 },
+        { 1, 3, 2, 0 },
+    };
+
+    Simplex best = {};
+    D3DXVECTOR3 bestV = INIT_VEC3;
+    float bestDistSq = FLT_MAX;
+    bool isOutside = false;
+
+    for (const auto& face : faces)
+    {
+        const D3DXVECTOR3& A = simplex.v[face[0]].w;
+        D3DXVECTOR3 ab = simplex.v[face[1]].w - A;
+        D3DXVECTOR3 ac = simplex.v[face[2]].w - A;
+        D3DXVECTOR3 ad = simplex.v[face[3]].w - A;
+        D3DXVECTOR3 n;
+        D3DXVec3Cross(&n, &ab, &ac);
+
+        float sideOrigin = -D3DXVec3Dot(&n, &A);
+        float sideOpposite = D3DXVec3Dot(&n, &ad);
+
+        // つぶれた四面体はどの面も外側として調べる
+        bool isDegenerate = sideOpposite * sideOpposite <= DEGENERATE_EPSILON * D3DXVec3LengthSq(&n);
+
+        if (!isDegenerate && sideOrigin * sideOpposite >= 0.0f)
+        {
+            continue;
+        }
+
+        Simplex triangle;
+        triangle.v[0] = simplex.v[face[0]];
+        triangle.v[1] = simplex.v[face[1]];
+        triangle.v[2] = simplex.v[face[2]];
+        triangle.count = 3;
+
+        D3DXVECTOR3 v;
+        ClosestOnTriangle(triangle, v);
+
+        float distSq = D3DXVec3LengthSq(&v);
+
+        if (distSq < bestDistSq)
+        {
+            bestDistSq = distSq;
+            best = triangle;
+            bestV = v;
+        }
+
+        isOutside = true;
+    }
+
+    if (!isOutside)
+    {
+        return false;
+    }
+
+    simplex = best;
+    outV = bestV;
+
+    return true;
+}
+//=============================================================================
+// 単体を四面体まで広げる処理（原点が点・線・面の上で止まったときにEPAの最初の多面体を作る）
+//=============================================================================
+bool Gjk::ExpandSimplex(const ConvexShape& a, const ConvexShape& b, bool isCore, Simplex& simplex)
+{
+    static const D3DXVECTOR3 axes[6] =
+    {
+        D3DXVECTOR3(1.0f, 0.0f, 0.0f), D3DXVECTOR3(-1.0f, 0.0f, 0.0f),
+        D3DXVECTOR3(0.0f, 1.0f, 0.0f), D3DXVECTOR3(0.0f, -1.0f, 0.0f),
+        D3DXVECTOR3(0.0f, 0.0f, 1.0f), D3DXVECTOR3(0.0f, 0.0f, -1.0f),
+    };
+
+    // 点 → 離れた点を足して線分
+    if (simplex.count == 1)
+    {
+        for (const D3DXVECTOR3& axis : axes)
+        {
+            Vertex vertex = MakeVertex(a, b, axis, isCore);
+            D3DXVECTOR3 diff = vertex.w - simplex.v[0].w;
+
+            if (D3DXVec3LengthSq(&diff) > DEGENERATE_EPSILON)
+            {
+                simplex.v[simplex.count++] = vertex;
+                break;
+            }
+        }
+    }
+
+    // 線分 → 線に直交する向きの点を足して三角形
+    if (simplex.count == 2)
+    {
+        D3DXVECTOR3 line = simplex.v[1].w - simplex.v[0].w;
+        D3DXVECTOR3 absLine(fabsf(line.x), fabsf(line.y), fabsf(line.z));
+        int minAxis = (absLine.x < absLine.y) ? ((absLine.x < absLine.z) ? 0 : 2) : ((absLine.y < absLine.z) ? 1 : 2);
+
+        D3DXVECTOR3 e1, e2;
+        D3DXVec3Cross(&e1, &line, &axes[minAxis * 2]);
+        D3DXVec3Cross(&e2, &line, &e1);
+
+        const D3DXVECTOR3 dirs[4] = { e1, -e1, e2, -e2 };
+
+        for (const D3DXVECTOR3& dir : dirs)
+        {
+            Vertex vertex = MakeVertex(a, b, dir, isCore);
+            D3DXVECTOR3 toVertex = vertex.w - simplex.v[0].w;
+            D3DXVECTOR3 c;
+            D3DXVec3Cross(&c, &toVertex, &line);
+
+            if (D3DXVec3LengthSq(&c) > DEGENERATE_EPSILON * std::max(D3DXVec3LengthSq(&line), 1.0f))
+            {
+                simplex.v[simplex.count++] = vertex;
+                break;
+            }
+        }
+    }
+
+    // 三角形 → 面の表か裏の点を足して四面体
+    if (simplex.count == 3)
+    {
+        D3DXVECTOR3 ab = simplex.v[1].w - simplex.v[0].w;
+        D3DXVECTOR3 ac = simplex.v[2].w - simplex.v[0].w;
+        D3DXVECTOR3 n;
+        D3DXVec3Cross(&n, &ab, &ac);
+
+        const D3DXVECTOR3 dirs[2] = { n, -n };
+
+        for (const D3DXVECTOR3& dir : dirs)
+        {
+            Vertex vertex = MakeVertex(a, b, dir, isCore);
+            D3DXVECTOR3 toVertex = vertex.w - simplex.v[0].w;
+            float side = D3DXVec3Dot(&toVertex, &n);
+
+            if (side * side > DEGENERATE_EPSILON * std::max(D3DXVec3LengthSq(&n), 1.0f))
+            {
+                simplex.v[simplex.count++] = vertex;
+                break;
+            }
+        }
+    }
+
+    return simplex.count == 4;
+}
+//=============================================================================
+// EPAの本体（原点を囲む多面体を、原点に一番近い面の向きの支持点で広げていく）
+//=============================================================================
+bool Gjk::Epa(const ConvexShape& a, const ConvexShape& b, bool isCore, const Simplex& simplex, D3DXVECTOR3& outNormal, float& outDepth)
+{
+    Vertex vertices[EPA_MAX_VERTICES];
+    EpaFace faces[EPA_MAX_FACES];
+    std::pair<int, int> edges[EPA_MAX_FACES * 3];
+    int numVertices = 4;
+    int numFaces = 0;
+
+    D3DXVECTOR3 inner = INIT_VEC3;
+
+    for (int nCnt = 0; nCnt < 4; nCnt++)
+    {
+        vertices[nCnt] = simplex.v[nCnt];
+        inner += simplex.v[nCnt].w * 0.25f;
+    }
+
+    // 面の追加（最初の四面体の重心は広げても中にあるので、重心を裏に見る向きにそろえる）
+    auto addFace = [&](int i0, int i1, int i2)
+    {
+        if (numFaces >= EPA_MAX_FACES)
+        {
+            return false;
+        }
+
+        EpaFace& face = faces[numFaces++];
+        face.v[0] = i0;
+        face.v[1] = i1;
+        face.v[2] = i2;
+        face.isAlive = true;
+
+        const D3DXVECTOR3& w0 = vertices[i0].w;
+        D3DXVECTOR3 ab = vertices[i1].w - w0;
+        D3DXVECTOR3 ac = vertices[i2].w - w0;
+        D3DXVec3Cross(&face.normal, &ab, &ac);
+
+        // つぶれた面は選ばれないように遠くへ置く
+        if (D3DXVec3LengthSq(&face.normal) <= DEGENERATE_EPSILON)
+        {
+            face.normal = INIT_VEC3;
+            face.dist = FLT_MAX;
+            return true;
+        }
+
+        D3DXVec3Normalize(&face.normal, &face.normal);
+
+        D3DXVECTOR3 toInner = inner - w0;
+
+        if (D3DXVec3Dot(&face.normal, &toInner) > 0.0f)
+        {
+            std::swap(face.v[1], face.v[2]);
+            face.normal = -face.normal;
+        }
+
+        face.dist = D3DXVec3Dot(&face.normal, &w0);
+        return true;
+    };
+
+    addFace(0, 1, 2);
+    addFace(0, 1, 3);
+    addFace(0, 2, 3);
+    addFace(1, 2, 3);
+
+    EpaFace best = {};
+    bool hasBest = false;
+
+    for (int nIter = 0; nIter < EPA_MAX_ITERATIONS; nIter++)
+    {
+        // 消えた面を詰めて、原点に一番近い面を探す
+        int numAlive = 0;
+        int closestIndex = -1;
+
+        for (int nFace = 0; nFace < numFaces; nFace++)
+        {
+            if (!faces[nFace].isAlive)
+            {
+                continue;
+            }
+
+            faces[numAlive] = faces[nFace];
+
+            if (closestIndex < 0 || faces[numAlive].dist < faces[closestIndex].dist)
+            {
+                closestIndex = numAlive;
+            }
+
+            numAlive++;
+        }
+
+        numFaces = numAlive;
+
+        if (closestIndex < 0 || faces[closestIndex].dist == FLT_MAX)
+        {
+            break;
+        }
+
+        best = faces[closestIndex];
+        hasBest = true;
+
+        Vertex vertex = MakeVertex(a, b, best.normal, isCore);
+        float gap = D3DXVec3Dot(&vertex.w, &best.normal) - best.dist;
+
+        // 支持点が面からほとんど出なければ、その面が境界
+        if (gap <= std::max(EPA_TOLERANCE, EPA_RELATIVE_TOLERANCE * best.dist) || numVertices >= EPA_MAX_VERTICES)
+        {
+            break;
+        }
+
+        int newIndex = numVertices++;
+        vertices[newIndex] = vertex;
+
+        // 新しい点から見える面を消し、見える面の境目の辺を集める（2枚の見える面が共有する辺は向きが逆で打ち消す）
+        int numEdges = 0;
+
+        for (int nFace = 0; nFace < numFaces; nFace++)
+        {
+            EpaFace& face = faces[nFace];
+
+            if (face.dist == FLT_MAX || D3DXVec3Dot(&face.normal, &vertex.w) - face.dist <= 0.0f)
+            {
+                continue;
+            }
+
+            face.isAlive = false;
+
+            for (int nEdge = 0; nEdge < 3; nEdge++)
+            {
+                int e0 = face.v[nEdge];
+                int e1 = face.v[(nEdge + 1) % 3];
+                bool isShared = false;
+
+                for (int nOther = 0; nOther < numEdges; nOther++)
+                {
+                    if (edges[nOther].first == e1 && edges[nOther].second == e0)
+                    {
+                        edges[nOther] = edges[--numEdges];
+                        isShared = true;
+                        break;
+                    }
+                }
+
+                if (!isShared)
+                {
+                    edges[numEdges++] = { e0, e1 };
+                }
+            }
+        }
+
+        // 面が入りきらなければ、今までで一番近い面で止める
+        bool isFull = false;
+
+        for (int nEdge = 0; nEdge < numEdges; nEdge++)
+        {
+            if (!addFace(edges[nEdge].first, edges[nEdge].second, newIndex))
+            {
+                isFull = true;
+                break;
+            }
+        }
+
+        if (isFull)
+        {
+            break;
+        }
+    }
+
+    if (!hasBest)
+    {
+        return false;
+    }
+
+    outNormal = best.normal;
+    outDepth = best.dist;
+
+    return true;
+}
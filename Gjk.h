@@ -0,0 +1,113 @@
+//=============================================================================
+//
+// 凸形状の判定処理 [Gjk.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _GJK_H_// このマクロ定義がされていなかったら
+#define _GJK_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "Collider.h"
+
+//*****************************************************************************
+// 支持写像で表した凸形状（丸みを除いた芯と、芯のまわりの丸みの半径）
+// 球は点、カプセルは線分を芯にして、芯同士の距離から丸みを引いて判定する
+// カプセル・シリンダーは他の判定と同じく縦向き固定で回転を見ない
+//*****************************************************************************
+struct ConvexShape
+{
+    const Collider*     collider = nullptr;     // コライダー（nullptrならpointsを包む形）
+    const D3DXVECTOR3*  points = nullptr;       // 点の集まり（三角形など）
+    int                 numPoints = 0;          // 点の数
+    float               radius = 0.0f;          // 丸みの半径
+
+    ConvexShape(const Collider* col);
+    ConvexShape(const D3DXVECTOR3* pts, int num, float r = 0.0f) : points(pts), numPoints(num), radius(r) {}
+
+    // dirの向きに一番遠い芯の点（dirは正規化しなくてよい）
+    D3DXVECTOR3 SupportCore(const D3DXVECTOR3& dir) const;
+
+    // 丸みを含めた支持点
+    D3DXVECTOR3 Support(const D3DXVECTOR3& dir) const;
+
+    // 形状の中にある点（最初の探索方向用）
+    D3DXVECTOR3 GetCenter(void) const;
+};
+
+//=============================================================================
+// GJK/EPAクラス
+// GJKで芯同士の最近接点を求め、芯が重なっていればEPAで一番浅い押し戻しを求める
+// 形状は支持点だけで扱うので、新しい凸形状は支持点を書けば全ての形状と判定できる
+//=============================================================================
+class Gjk
+{
+public:
+    // GJK/EPAで判定できる形状か
+    static bool IsConvex(Collider::TYPE type);
+
+    // 芯同士の最近接点（芯が重なっていればfalse）
+    // 距離がmaxDistより離れているとわかった時点で打ち切り、そのときのoutDistはmaxDistより大きい下限になる
+    static bool Distance(const ConvexShape& a, const ConvexShape& b, float maxDist,
+        D3DXVECTOR3& outOnA, D3DXVECTOR3& outOnB, float& outDist);
+
+    // 丸みを含めた形状同士の押し戻し（AからBへの向き、長さがめり込み量。重なっていなければfalse）
+    static bool Penetration(const ConvexShape& a, const ConvexShape& b, D3DXVECTOR3& outPush);
+
+private:
+    // 単体の頂点（ミンコフスキー差の点と、元になった両方の支持点）
+    struct Vertex
+    {
+        D3DXVECTOR3 w;  // a - b
+        D3DXVECTOR3 a;  // Aの支持点
+        D3DXVECTOR3 b;  // Bの支持点
+    };
+
+    // 単体（1～4点）
+    struct Simplex
+    {
+        Vertex  v[4];       // 頂点
+        float   weight[4];  // 原点に一番近い点の重み
+        int     count;      // 頂点数
+    };
+
+    // GJKの結果
+    enum RESULT
+    {
+        RESULT_SEPARATED,   // maxDistより離れている
+        RESULT_CLOSEST,     // 最近接点が求まった
+        RESULT_OVERLAP      // 芯が重なっている
+    };
+
+    // EPAの面
+    struct EpaFace
+    {
+        int         v[3];       // 頂点の番号（外から見て左回り）
+        D3DXVECTOR3 normal;     // 外向きの法線（正規化済み）
+        float       dist;       // 原点からの距離
+        bool        isAlive;    // 残っているか
+    };
+
+    static RESULT Run(const ConvexShape& a, const ConvexShape& b, float maxDist, bool isCore, Simplex& simplex, D3DXVECTOR3& outV);
+    static bool ClosestOnSimplex(Simplex& simplex, D3DXVECTOR3& outV);
+    static void ClosestOnSegment(Simplex& simplex, D3DXVECTOR3& outV);
+    static void ClosestOnTriangle(Simplex& simplex, D3DXVECTOR3& outV);
+    static bool ClosestOnTetrahedron(Simplex& simplex, D3DXVECTOR3& outV);
+    static bool ExpandSimplex(const ConvexShape& a, const ConvexShape& b, bool isCore, Simplex& simplex);
+    static bool Epa(const ConvexShape& a, const ConvexShape& b, bool isCore, const Simplex& simplex, D3DXVECTOR3& outNormal, float& outDepth);
+    static Vertex MakeVertex(const ConvexShape& a, const ConvexShape& b, const D3DXVECTOR3& dir, bool isCore);
+
+    static constexpr int    GJK_MAX_ITERATIONS      = 32;       // GJKの最大の反復回数
+    static constexpr float  GJK_TOLERANCE           = 1e-4f;    // 距離の2乗がこの割合しか縮まなければ収束とみなす
+    static constexpr float  GJK_OVERLAP_DIST_SQ     = 1e-8f;    // 芯が重なっているとみなす距離の2乗
+    static constexpr int    EPA_MAX_ITERATIONS      = 32;       // EPAの最大の反復回数
+    static constexpr int    EPA_MAX_VERTICES        = 64;       // EPAの多面体の最大の頂点数
+    static constexpr int    EPA_MAX_FACES           = 128;      // EPAの多面体の最大の面数
+    static constexpr float  EPA_TOLERANCE           = 1e-3f;    // 支持点が面からこれしか出なければ収束とみなす
+    static constexpr float  EPA_RELATIVE_TOLERANCE  = 1e-4f;    // 深さに対する収束の割合
+    static constexpr float  DEGENERATE_EPSILON      = 1e-10f;   // つぶれた面・線とみなす外積の長さの2乗
+};
+
+#endif
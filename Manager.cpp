@@ -25,6 +25,7 @@ CLight* CManager::m_pLight = nullptr;
 CScene* CManager::m_pScene = nullptr;
 CFade* CManager::m_pFade = nullptr;
 std::unique_ptr<PhysicsWorld> CManager::m_pPhysicsWorld = nullptr;
+std::unique_ptr<CCollisionCache> CManager::m_pCollisionCache = nullptr;
 
 //=============================================================================
 // コンストラクタ
@@ -33,6 +34,7 @@ CManager::CManager()
 {
 	// 値のクリア
 	m_fps = 0;
+	m_dwPrevTime = 0;
 }
 //=============================================================================
 // デストラクタ
@@ -82,12 +84,15 @@ HRESULT CManager::Init(HINSTANCE hInstance, HWND hWnd)
 		return E_FAIL;
 	}
 
-	// 物理ワールドの生成
-	m_pPhysicsWorld = std::make_unique <PhysicsWorld>();
+	// 物理ワールドの生成（ブロードフェーズは最初に読むステージの指定に合わせる）
+	m_pPhysicsWorld = std::make_unique <PhysicsWorld>(CBlockManager::LoadBroadphaseType(CEdit::START_STAGE));
 
 	// 重力の設定
 	m_pPhysicsWorld->SetGravity(D3DXVECTOR3(0.0f, -320.0f, 0.0f));
 
+	// 当たり判定のキャッシュの生成
+	m_pCollisionCache = std::make_unique<CCollisionCache>();
+
 	// カメラの生成
 	m_pCamera = new CCamera;
 
@@ -112,6 +117,9 @@ HRESULT CManager::Init(HINSTANCE hInstance, HWND hWnd)
 	// エディター画面
 	m_pScene = CScene::Create(CScene::MODE_EDIT);
 
+	// 経過時間の計測開始
+	m_dwPrevTime = timeGetTime();
+
 	return S_OK;
 }
 //=============================================================================
@@ -122,6 +130,9 @@ void CManager::Uninit(void)
 	// すべてのオブジェクトの破棄
 	CObject::ReleaseAll();
 
+	// 当たり判定のキャッシュの破棄
+	m_pCollisionCache.reset();
+
 	// テクスチャの破棄
 	if (m_pTexture != nullptr)
 	{
@@ -226,10 +237,13 @@ void CManager::Update(void)
 		m_pFade->Update();
 	}
 
-	float dt = 1.0f / 60.0f;
+	// 前のフレームからの経過時間
+	DWORD dwCurrentTime = timeGetTime();
+	float frameTime = (dwCurrentTime - m_dwPrevTime) * 0.001f;
+	m_dwPrevTime = dwCurrentTime;
 
-	// 物理シミュレーション
-	m_pPhysicsWorld->StepSimulation(dt);// 引き数にFPS,1フレームに付き何回衝突するかデフォ1,デルタタイム
+	// 物理シミュレーション（経過時間を固定の刻みに分けて進める）
+	m_pPhysicsWorld->Update(frameTime);
 
 	// カメラの更新
 	m_pCamera->Update();
@@ -256,6 +270,9 @@ void CManager::SetMode(CScene::MODE mode)
 	// カメラの初期化処理
 	m_pCamera->Init();
 
+	// 剛体をまとめて破棄（各オブジェクトの終了処理での個別削除は素通りする）
+	m_pPhysicsWorld->RemoveAll();
+
 	if (m_pScene != nullptr)
 	{
 		// 現在のモード破棄
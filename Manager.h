@@ -18,6 +18,7 @@
 #include "Scene.h"
 #include "Fade.h"
 #include "PhysicsWorld.h"
+#include "CollisionCache.h"
 
 //*****************************************************************************
 // マネージャークラス
@@ -47,6 +48,7 @@ public:
 	int GetFPS(int fps) { return m_fps = fps; };
 	int GetFPSCnt(void) { return m_fps; }
 	static PhysicsWorld* GetPhysicsWorld(void) { return m_pPhysicsWorld.get(); }
+	static CCollisionCache* GetCollisionCache(void) { return m_pCollisionCache.get(); }
 	static void SetMode(CScene::MODE mode);
 	static CScene::MODE GetMode(void);
 
@@ -59,9 +61,11 @@ private:
 	static CCamera*							m_pCamera;			// カメラへのポインタ
 	static CLight*							m_pLight;			// ライトへのポインタ
 	static std::unique_ptr<PhysicsWorld>	m_pPhysicsWorld;	// 物理世界へのポインタ
+	static std::unique_ptr<CCollisionCache>	m_pCollisionCache;	// 当たり判定のキャッシュへのポインタ
 	static CFade*							m_pFade;			// フェードへのポインタ
 	static CScene*							m_pScene;			// シーンへのポインタ
 	int										m_fps;				// FPS値
+	DWORD									m_dwPrevTime;		// 前のフレームの時刻
 };
 
 #endif
\ No newline at end of file
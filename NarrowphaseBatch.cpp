@@ -0,0 +1,417 @@
+//=============================================================================
+//
+// ナローフェーズのまとめ判定処理 [NarrowphaseBatch.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "NarrowphaseBatch.h"
+#include "NarrowphaseBatchSimd.h"
+
+//=============================================================================
+// 中身を空にする処理
+//=============================================================================
+void NarrowphaseBatch::Clear(int numPairs)
+{
+    static const int fieldsOfKind[KIND_MAX] =
+    {
+        SPHERE_FIELDS * 2,              // 球と球
+        SPHERE_FIELDS + BOX_FIELDS,     // 球と箱
+        BOX_FIELDS * 2,                 // 箱と箱
+    };
+
+    for (int nCnt = 0; nCnt < KIND_MAX; nCnt++)
+    {
+        Stream& stream = m_Streams[nCnt];
+        stream.numFields = fieldsOfKind[nCnt];
+        stream.count = 0;
+
+        // 容量は残して使い回す
+        for (int field = 0; field < stream.numFields; field++)
+        {
+            stream.in[field].clear();
+        }
+    }
+
+    m_Entries.assign(numPairs, { -1, 0, false });
+}
+//=============================================================================
+// ペアを詰める処理
+//=============================================================================
+bool NarrowphaseBatch::Add(int pairIndex, Collider* a, Collider* b)
+{
+    Collider::TYPE typeA = a->GetType();
+    Collider::TYPE typeB = b->GetType();
+
+    // 球・箱は球を先、箱同士・球同士はそのままの順で詰める
+    bool isSwapped = (typeA == Collider::BOX && typeB == Collider::SPHERE);
+
+    if (isSwapped)
+    {
+        std::swap(a, b);
+        std::swap(typeA, typeB);
+    }
+
+    int kind = -1;
+
+    if (typeA == Collider::SPHERE && typeB == Collider::SPHERE)
+    {
+        kind = KIND_SPHERE_SPHERE;
+        PushSphere(m_Streams[kind], 0, static_cast<SphereCollider*>(a));
+        PushSphere(m_Streams[kind], SPHERE_FIELDS, static_cast<SphereCollider*>(b));
+    }
+    else if (typeA == Collider::SPHERE && typeB == Collider::BOX)
+    {
+        kind = KIND_SPHERE_BOX;
+        PushSphere(m_Streams[kind], 0, static_cast<SphereCollider*>(a));
+        PushBox(m_Streams[kind], SPHERE_FIELDS, static_cast<BoxCollider*>(b));
+    }
+    else if (typeA == Collider::BOX && typeB == Collider::BOX)
+    {
+        kind = KIND_BOX_BOX;
+        PushBox(m_Streams[kind], 0, static_cast<BoxCollider*>(a));
+        PushBox(m_Streams[kind], BOX_FIELDS, static_cast<BoxCollider*>(b));
+    }
+    else
+    {
+        return false;
+    }
+
+    Entry& entry = m_Entries[pairIndex];
+    entry.kind = kind;
+    entry.index = m_Streams[kind].count++;
+    entry.isSwapped = isSwapped;
+
+    return true;
+}
+//=============================================================================
+// 球の情報を詰める処理
+//=============================================================================
+void NarrowphaseBatch::PushSphere(Stream& stream, int offset, SphereCollider* sphere)
+{
+    const D3DXVECTOR3& pos = sphere->GetPosition();
+
+    stream.in[offset + 0].push_back(pos.x);
+    stream.in[offset + 1].push_back(pos.y);
+    stream.in[offset + 2].push_back(pos.z);
+    stream.in[offset + 3].push_back(sphere->GetRadius());
+}
+//=============================================================================
+// 箱の情報を詰める処理（回転行列の行をそのまま軸にする）
+//=============================================================================
+void NarrowphaseBatch::PushBox(Stream& stream, int offset, BoxCollider* box)
+{
+    const D3DXVECTOR3& center = box->GetPosition();
+    const D3DXMATRIX& R = box->GetRotation();
+    D3DXVECTOR3 half = box->GetScaledSize() * HALF;
+
+    stream.in[offset + BOX_CENTER + 0].push_back(center.x);
+    stream.in[offset + BOX_CENTER + 1].push_back(center.y);
+    stream.in[offset + BOX_CENTER + 2].push_back(center.z);
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (int nCnt = 0; nCnt < 3; nCnt++)
+        {
+            stream.in[offset + BOX_AXIS + axis * 3 + nCnt].push_back(R.m[axis][nCnt]);
+        }
+    }
+
+    stream.in[offset + BOX_HALF + 0].push_back(half.x);
+    stream.in[offset + BOX_HALF + 1].push_back(half.y);
+    stream.in[offset + BOX_HALF + 2].push_back(half.z);
+}
+//=============================================================================
+// 判定前の準備処理（端数を埋めて出力の配列を用意する）
+//=============================================================================
+void NarrowphaseBatch::Prepare(Stream& stream)
+{
+    // 最後の1回もまとめて読めるように0で埋める（0の組は当たらない）
+    size_t padded = (size_t)((stream.count + LANE_ALIGN - 1) / LANE_ALIGN * LANE_ALIGN);
+
+    for (int field = 0; field < stream.numFields; field++)
+    {
+        stream.in[field].resize(padded, 0.0f);
+    }
+
+    stream.pushX.assign(padded, 0.0f);
+    stream.pushY.assign(padded, 0.0f);
+    stream.pushZ.assign(padded, 0.0f);
+    stream.hitMask.assign(padded / LANE_ALIGN, 0u);
+}
+//=============================================================================
+// まとめ判定処理
+//=============================================================================
+void NarrowphaseBatch::Execute(bool isSimd)
+{
+    for (int nCnt = 0; nCnt < KIND_MAX; nCnt++)
+    {
+        Prepare(m_Streams[nCnt]);
+    }
+
+    if (isSimd && SimdCpu::HasAvx2())
+    {
+        // AVX2が使えるCPUなら8組ずつ（別のファイルでAVX2向けにビルドしたもの）
+        ExecuteAvx2();
+    }
+    else if (isSimd)
+    {
+        SphereSphereSimd<SimdSSE>(m_Streams[KIND_SPHERE_SPHERE]);
+        SphereBoxSimd<SimdSSE>(m_Streams[KIND_SPHERE_BOX]);
+        BoxBoxSimd<SimdSSE>(m_Streams[KIND_BOX_BOX]);
+    }
+    else
+    {
+        SphereSphereScalar(m_Streams[KIND_SPHERE_SPHERE]);
+        SphereBoxScalar(m_Streams[KIND_SPHERE_BOX]);
+        BoxBoxScalar(m_Streams[KIND_BOX_BOX]);
+    }
+}
+//=============================================================================
+// 判定結果の取得処理
+//=============================================================================
+bool NarrowphaseBatch::GetResult(int pairIndex, D3DXVECTOR3& outPush) const
+{
+    const Entry& entry = m_Entries[pairIndex];
+    const Stream& stream = m_Streams[entry.kind];
+    int index = entry.index;
+
+    if (!(stream.hitMask[index / LANE_ALIGN] & (1u << (index % LANE_ALIGN))))
+    {
+        return false;
+    }
+
+    outPush = D3DXVECTOR3(stream.pushX[index], stream.pushY[index], stream.pushZ[index]);
+
+    // 入れ替えて詰めた組はAから見た向きに戻す
+    if (entry.isSwapped)
+    {
+        outPush = -outPush;
+    }
+
+    return true;
+}
+//=============================================================================
+// 同時に判定する組の数の取得
+//=============================================================================
+int NarrowphaseBatch::GetLaneWidth(void)
+{
+    return SimdCpu::HasAvx2() ? SimdCpu::AVX2_WIDTH : SimdSSE::WIDTH;
+}
+//=============================================================================
+// 球と球（スカラー版）
+//=============================================================================
+void NarrowphaseBatch::SphereSphereScalar(Stream& s)
+{
+    for (int i = 0; i < s.count; i++)
+    {
+        float dx = s.in[0][i] - s.in[4][i];
+        float dy = s.in[1][i] - s.in[5][i];
+        float dz = s.in[2][i] - s.in[6][i];
+        float distSq = dx * dx + dy * dy + dz * dz;
+        float rSum = s.in[3][i] + s.in[7][i];
+
+        if (!(distSq < rSum * rSum))
+        {
+            continue;
+        }
+
+        float dist = sqrtf(distSq);
+
+        if (dist > MIN_DISTANCE)
+        {
+            float scale = (rSum - dist) / dist;
+            s.pushX[i] = -dx * scale;
+            s.pushY[i] = -dy * scale;
+            s.pushZ[i] = -dz * scale;
+        }
+        else
+        {
+            s.pushX[i] = rSum; // 完全重なり
+        }
+
+        s.hitMask[i / LANE_ALIGN] |= 1u << (i % LANE_ALIGN);
+    }
+}
+//=============================================================================
+// 球と箱（スカラー版）
+//=============================================================================
+void NarrowphaseBatch::SphereBoxScalar(Stream& s)
+{
+    const int B = SPHERE_FIELDS;
+
+    for (int i = 0; i < s.count; i++)
+    {
+        float sp[3] = { s.in[0][i], s.in[1][i], s.in[2][i] };
+        float radius = s.in[3][i];
+        float d[3] = { sp[0] - s.in[B + BOX_CENTER][i], sp[1] - s.in[B + BOX_CENTER + 1][i], sp[2] - s.in[B + BOX_CENTER + 2][i] };
+
+        // 球の中心を箱のローカルに移して箱の中に押し込む
+        float local[3];
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const int A = B + BOX_AXIS + axis * 3;
+            float half = s.in[B + BOX_HALF + axis][i];
+
+            local[axis] = d[0] * s.in[A][i] + d[1] * s.in[A + 1][i] + d[2] * s.in[A + 2][i];
+            local[axis] = std::min(std::max(local[axis], -half), half);
+        }
+
+        // ワールドに戻した最近接点から球の中心まで
+        float delta[3];
+
+        for (int nCnt = 0; nCnt < 3; nCnt++)
+        {
+            float closest =
+                local[0] * s.in[B + BOX_AXIS + 0 + nCnt][i] +
+                local[1] * s.in[B + BOX_AXIS + 3 + nCnt][i] +
+                local[2] * s.in[B + BOX_AXIS + 6 + nCnt][i];
+
+            closest += s.in[B + BOX_CENTER + nCnt][i];
+            delta[nCnt] = sp[nCnt] - closest;
+        }
+
+        float distSq = delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2];
+
+        if (!(distSq < radius * radius))
+        {
+            continue;
+        }
+
+        float dist = sqrtf(distSq);
+
+        if (dist > MIN_DISTANCE)
+        {
+            float scale = (radius - dist) / dist;
+            s.pushX[i] = -delta[0] * scale;
+            s.pushY[i] = -delta[1] * scale;
+            s.pushZ[i] = -delta[2] * scale;
+        }
+        else
+        {
+            s.pushY[i] = radius; // 中心が箱に埋まっている
+        }
+
+        s.hitMask[i / LANE_ALIGN] |= 1u << (i % LANE_ALIGN);
+    }
+}
+//=============================================================================
+// 箱と箱（スカラー版）
+//=============================================================================
+void NarrowphaseBatch::BoxBoxScalar(Stream& s)
+{
+    const int B = BOX_FIELDS;
+
+    for (int i = 0; i < s.count; i++)
+    {
+        float axes[NUM_AXES][3];
+
+        // 両方の面の軸
+        for (int axis = 0; axis < 6; axis++)
+        {
+            const int A = (axis < 3 ? 0 : B) + BOX_AXIS + (axis % 3) * 3;
+            axes[axis][0] = s.in[A][i];
+            axes[axis][1] = s.in[A + 1][i];
+            axes[axis][2] = s.in[A + 2][i];
+        }
+
+        // 辺同士のクロス軸（ほぼ平行なものは使わない）
+        int numAxes = 6;
+
+        for (int nCnt = 0; nCnt < 3; nCnt++)
+        {
+            for (int nCnt2 = 0; nCnt2 < 3; nCnt2++)
+            {
+                const float* u = axes[nCnt];
+                const float* v = axes[3 + nCnt2];
+                float c[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+                float lenSq = c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+
+                if (lenSq > PARALLEL_EPSILON)
+                {
+                    float len = sqrtf(lenSq);
+                    axes[numAxes][0] = c[0] / len;
+                    axes[numAxes][1] = c[1] / len;
+                    axes[numAxes][2] = c[2] / len;
+                    numAxes++;
+                }
+            }
+        }
+
+        float minOverlap = FLT_MAX;
+        float best[3] = { 0.0f, 0.0f, 0.0f };
+        bool isSeparated = false;
+
+        for (int nCnt = 0; nCnt < numAxes; nCnt++)
+        {
+            const float* n = axes[nCnt];
+            float proj[2][2];
+
+            // 両方の箱を軸に投影する
+            for (int box = 0; box < 2; box++)
+            {
+                const int O = box * B;
+                float r = 0.0f;
+
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    const int A = O + BOX_AXIS + axis * 3;
+                    float dot = n[0] * s.in[A][i] + n[1] * s.in[A + 1][i] + n[2] * s.in[A + 2][i];
+                    r += s.in[O + BOX_HALF + axis][i] * fabsf(dot);
+                }
+
+                float center = n[0] * s.in[O + BOX_CENTER][i] + n[1] * s.in[O + BOX_CENTER + 1][i] + n[2] * s.in[O + BOX_CENTER + 2][i];
+                proj[box][0] = center - r;
+                proj[box][1] = center + r;
+            }
+
+            float overlap = std::min(proj[0][1], proj[1][1]) - std::max(proj[0][0], proj[1][0]);
+
+            if (overlap <= 0.0f)
+            {
+                isSeparated = true;
+                break;
+            }
+
+            // 面の軸を優先し、辺同士の軸ははっきり浅いときだけ選ぶ
+            float bias = (nCnt >= 6) ? EDGE_AXIS_BIAS : 1.0f;
+
+            if (overlap * bias < minOverlap)
+            {
+                minOverlap = overlap;
+                best[0] = n[0];
+                best[1] = n[1];
+                best[2] = n[2];
+            }
+        }
+
+        if (isSeparated)
+        {
+            continue;
+        }
+
+        // 押し戻し方向は a→b
+        float dir[3] =
+        {
+            s.in[B + BOX_CENTER][i] - s.in[BOX_CENTER][i],
+            s.in[B + BOX_CENTER + 1][i] - s.in[BOX_CENTER + 1][i],
+            s.in[B + BOX_CENTER + 2][i] - s.in[BOX_CENTER + 2][i],
+        };
+
+        if (dir[0] * best[0] + dir[1] * best[1] + dir[2] * best[2] < 0.0f)
+        {
+            best[0] = -best[0];
+            best[1] = -best[1];
+            best[2] = -best[2];
+        }
+
+        s.pushX[i] = best[0] * minOverlap;
+        s.pushY[i] = best[1] * minOverlap;
+        s.pushZ[i] = best[2] * minOverlap;
+        s.hitMask[i / LANE_ALIGN] |= 1u << (i % LANE_ALIGN);
+    }
+}
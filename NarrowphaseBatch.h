@@ -0,0 +1,109 @@
+//=============================================================================
+//
+// ナローフェーズのまとめ判定処理 [NarrowphaseBatch.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _NARROWPHASEBATCH_H_// このマクロ定義がされていなかったら
+#define _NARROWPHASEBATCH_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "Collider.h"
+
+//=============================================================================
+// ナローフェーズのまとめ判定クラス
+// 同じ型の組み合わせのペアを項目ごとの配列に詰め、4組（AVX2が使えるCPUなら8組）ずつ判定する
+//=============================================================================
+class NarrowphaseBatch
+{
+public:
+    // まとめて判定する型の組み合わせ
+    enum KIND
+    {
+        KIND_SPHERE_SPHERE = 0,
+        KIND_SPHERE_BOX,
+        KIND_BOX_BOX,
+        KIND_MAX
+    };
+
+    NarrowphaseBatch() {}
+
+    // ペア数を決めて中身を空にする
+    void Clear(int numPairs);
+
+    // 対象の組み合わせならペアを詰める（対象外ならfalse）
+    bool Add(int pairIndex, Collider* a, Collider* b);
+
+    // 詰めたペアをまとめて判定する（isSimdがfalseならスカラー版の参照実装）
+    void Execute(bool isSimd);
+
+    // 判定結果の取得（押し戻しはAから見た向き）
+    bool IsBatched(int pairIndex) const { return m_Entries[pairIndex].kind >= 0; }
+    bool GetResult(int pairIndex, D3DXVECTOR3& outPush) const;
+
+    int GetCount(KIND kind) const { return m_Streams[kind].count; }
+    static int GetLaneWidth(void);
+
+private:
+    // 1組分の入力の項目数
+    static constexpr int SPHERE_FIELDS  = 4;                            // 中心(3)・半径
+    static constexpr int BOX_FIELDS     = 15;                           // 中心(3)・軸(3x3)・半分の大きさ(3)
+    static constexpr int MAX_FIELDS     = BOX_FIELDS * 2;               // 最大の項目数
+    static constexpr int LANE_ALIGN     = 32;                           // 配列の長さをそろえる単位（当たりビットの1ワード分）
+    static constexpr int NUM_AXES       = 15;                           // 箱同士の分離軸の数
+
+    // 判定の定数（PhysicsWorldの1組ずつの判定と同じ値）
+    static constexpr float PARALLEL_EPSILON = 1e-3f;                    // 辺が平行とみなす外積の長さの2乗
+    static constexpr float EDGE_AXIS_BIAS   = 1.05f;                    // 辺同士の軸を選ぶときの割増
+    static constexpr float MIN_DISTANCE     = 1e-6f;                    // 中心が重なったとみなす距離
+    static constexpr float HALF             = 0.5f;                     // 半分
+
+    // 項目の並び（箱は中心・軸・半分の大きさの順）
+    static constexpr int BOX_CENTER     = 0;                            // 中心
+    static constexpr int BOX_AXIS       = 3;                            // 軸（軸ごとにxyz）
+    static constexpr int BOX_HALF       = 12;                           // 半分の大きさ
+
+    // 組み合わせごとの項目ごとの配列
+    struct Stream
+    {
+        std::vector<float>          in[MAX_FIELDS];     // 入力
+        std::vector<float>          pushX;              // 出力：押し戻しX
+        std::vector<float>          pushY;              // 出力：押し戻しY
+        std::vector<float>          pushZ;              // 出力：押し戻しZ
+        std::vector<unsigned int>   hitMask;            // 出力：当たりのビット（1ビット1組）
+        int                         numFields = 0;      // 入力の項目数
+        int                         count = 0;          // 詰めた組の数
+    };
+
+    // ペアから詰めた位置への対応
+    struct Entry
+    {
+        int     kind;       // 組み合わせ（対象外なら-1）
+        int     index;      // 組み合わせ内の番号
+        bool    isSwapped;  // A・Bを入れ替えて詰めたか
+    };
+
+    static void PushSphere(Stream& stream, int offset, SphereCollider* sphere);
+    static void PushBox(Stream& stream, int offset, BoxCollider* box);
+    static void Prepare(Stream& stream);
+
+    // スカラー版（1組ずつの判定関数と同じ計算順）
+    static void SphereSphereScalar(Stream& s);
+    static void SphereBoxScalar(Stream& s);
+    static void BoxBoxScalar(Stream& s);
+
+    // SIMD版（Vはレジスタ幅ごとの命令のまとまり）
+    template <class V> static void SphereSphereSimd(Stream& s);
+    template <class V> static void SphereBoxSimd(Stream& s);
+    template <class V> static void BoxBoxSimd(Stream& s);
+
+    // AVX2版の判定（NarrowphaseBatchAvx2.cppだけをAVX2向けにビルドし、使えるCPUのときだけ呼ぶ）
+    void ExecuteAvx2(void);
+
+    Stream              m_Streams[KIND_MAX];    // 組み合わせごとの配列
+    std::vector<Entry>  m_Entries;              // ペアごとの対応
+};
+
+#endif
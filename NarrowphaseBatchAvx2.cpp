@@ -0,0 +1,27 @@
+//=============================================================================
+//
+// ナローフェーズのまとめ判定のAVX2版 [NarrowphaseBatchAvx2.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+// このファイルだけを /arch:AVX2 でビルドする（プロジェクトのファイルごとの設定）
+// AVX2命令で作った関数がほかのファイルの同じ関数と入れ替わらないよう、ここではSimdAVXの判定だけを実体化する
+//*****************************************************************************
+#include "NarrowphaseBatchSimd.h"
+
+#if !defined(__AVX2__)
+#error NarrowphaseBatchAvx2.cpp は /arch:AVX2 でビルドする
+#endif
+
+//=============================================================================
+// まとめ判定処理（AVX2版）
+//=============================================================================
+void NarrowphaseBatch::ExecuteAvx2(void)
+{
+    SphereSphereSimd<SimdAVX>(m_Streams[KIND_SPHERE_SPHERE]);
+    SphereBoxSimd<SimdAVX>(m_Streams[KIND_SPHERE_BOX]);
+    BoxBoxSimd<SimdAVX>(m_Streams[KIND_BOX_BOX]);
+}
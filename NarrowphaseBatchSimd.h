@@ -0,0 +1,267 @@
+//=============================================================================
+//
+// ナローフェーズのまとめ判定のSIMD版 [NarrowphaseBatchSimd.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _NARROWPHASEBATCHSIMD_H_// このマクロ定義がされていなかったら
+#define _NARROWPHASEBATCHSIMD_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+// 命令のまとまりVを差し替えて、SSE版はNarrowphaseBatch.cpp、AVX2版はNarrowphaseBatchAvx2.cppで実体を作る
+//*****************************************************************************
+#include "NarrowphaseBatch.h"
+#include "SimdMath.h"
+
+//=============================================================================
+// 球と球（SIMD版）
+//=============================================================================
+template <class V>
+void NarrowphaseBatch::SphereSphereSimd(Stream& s)
+{
+    using R = typename V::Reg;
+
+    const R minDistance = V::Set(MIN_DISTANCE);
+
+    for (int i = 0; i < s.count; i += V::WIDTH)
+    {
+        R dx = V::Sub(V::Load(&s.in[0][i]), V::Load(&s.in[4][i]));
+        R dy = V::Sub(V::Load(&s.in[1][i]), V::Load(&s.in[5][i]));
+        R dz = V::Sub(V::Load(&s.in[2][i]), V::Load(&s.in[6][i]));
+        R distSq = V::Add(V::Add(V::Mul(dx, dx), V::Mul(dy, dy)), V::Mul(dz, dz));
+        R rSum = V::Add(V::Load(&s.in[3][i]), V::Load(&s.in[7][i]));
+
+        R hit = V::Less(distSq, V::Mul(rSum, rSum));
+        int hitBits = V::MoveMask(hit);
+
+        if (hitBits == 0)
+        {
+            continue;
+        }
+
+        // 離れた組の割り算の結果は捨てる
+        R dist = V::Sqrt(distSq);
+        R isApart = V::Greater(dist, minDistance);
+        R scale = V::Div(V::Sub(rSum, dist), dist);
+
+        R px = V::Select(isApart, V::Mul(V::Neg(dx), scale), rSum);
+        R py = V::And(isApart, V::Mul(V::Neg(dy), scale));
+        R pz = V::And(isApart, V::Mul(V::Neg(dz), scale));
+
+        V::Store(&s.pushX[i], V::And(hit, px));
+        V::Store(&s.pushY[i], V::And(hit, py));
+        V::Store(&s.pushZ[i], V::And(hit, pz));
+        s.hitMask[i / LANE_ALIGN] |= (unsigned int)hitBits << (i % LANE_ALIGN);
+    }
+}
+//=============================================================================
+// 球と箱（SIMD版）
+//=============================================================================
+template <class V>
+void NarrowphaseBatch::SphereBoxSimd(Stream& s)
+{
+    using R = typename V::Reg;
+
+    const int B = SPHERE_FIELDS;
+    const R minDistance = V::Set(MIN_DISTANCE);
+
+    for (int i = 0; i < s.count; i += V::WIDTH)
+    {
+        R sp[3] = { V::Load(&s.in[0][i]), V::Load(&s.in[1][i]), V::Load(&s.in[2][i]) };
+        R radius = V::Load(&s.in[3][i]);
+        R axis[3][3];
+
+        for (int nCnt = 0; nCnt < 3; nCnt++)
+        {
+            for (int nCnt2 = 0; nCnt2 < 3; nCnt2++)
+            {
+                axis[nCnt][nCnt2] = V::Load(&s.in[B + BOX_AXIS + nCnt * 3 + nCnt2][i]);
+            }
+        }
+
+        R center[3] = { V::Load(&s.in[B + BOX_CENTER][i]), V::Load(&s.in[B + BOX_CENTER + 1][i]), V::Load(&s.in[B + BOX_CENTER + 2][i]) };
+        R d[3] = { V::Sub(sp[0], center[0]), V::Sub(sp[1], center[1]), V::Sub(sp[2], center[2]) };
+
+        // 球の中心を箱のローカルに移して箱の中に押し込む
+        R local[3];
+
+        for (int nCnt = 0; nCnt < 3; nCnt++)
+        {
+            R half = V::Load(&s.in[B + BOX_HALF + nCnt][i]);
+
+            local[nCnt] = V::Add(V::Add(V::Mul(d[0], axis[nCnt][0]), V::Mul(d[1], axis[nCnt][1])), V::Mul(d[2], axis[nCnt][2]));
+            local[nCnt] = V::Min(V::Max(local[nCnt], V::Neg(half)), half);
+        }
+
+        // ワールドに戻した最近接点から球の中心まで
+        R delta[3];
+
+        for (int nCnt = 0; nCnt < 3; nCnt++)
+        {
+            R closest = V::Add(V::Add(V::Mul(local[0], axis[0][nCnt]), V::Mul(local[1], axis[1][nCnt])), V::Mul(local[2], axis[2][nCnt]));
+            closest = V::Add(closest, center[nCnt]);
+            delta[nCnt] = V::Sub(sp[nCnt], closest);
+        }
+
+        R distSq = V::Add(V::Add(V::Mul(delta[0], delta[0]), V::Mul(delta[1], delta[1])), V::Mul(delta[2], delta[2]));
+        R hit = V::Less(distSq, V::Mul(radius, radius));
+        int hitBits = V::MoveMask(hit);
+
+        if (hitBits == 0)
+        {
+            continue;
+        }
+
+        R dist = V::Sqrt(distSq);
+        R isApart = V::Greater(dist, minDistance);
+        R scale = V::Div(V::Sub(radius, dist), dist);
+
+        R px = V::And(isApart, V::Mul(V::Neg(delta[0]), scale));
+        R py = V::Select(isApart, V::Mul(V::Neg(delta[1]), scale), radius);
+        R pz = V::And(isApart, V::Mul(V::Neg(delta[2]), scale));
+
+        V::Store(&s.pushX[i], V::And(hit, px));
+        V::Store(&s.pushY[i], V::And(hit, py));
+        V::Store(&s.pushZ[i], V::And(hit, pz));
+        s.hitMask[i / LANE_ALIGN] |= (unsigned int)hitBits << (i % LANE_ALIGN);
+    }
+}
+//=============================================================================
+// 箱と箱（SIMD版）
+//=============================================================================
+template <class V>
+void NarrowphaseBatch::BoxBoxSimd(Stream& s)
+{
+    using R = typename V::Reg;
+
+    const int B = BOX_FIELDS;
+    const int ALL_LANES = (1 << V::WIDTH) - 1;
+    const R zero = V::Zero();
+    const R parallelEpsilon = V::Set(PARALLEL_EPSILON);
+    const R edgeBias = V::Set(EDGE_AXIS_BIAS);
+
+    for (int i = 0; i < s.count; i += V::WIDTH)
+    {
+        R center[2][3];
+        R axis[2][3][3];
+        R half[2][3];
+
+        for (int box = 0; box < 2; box++)
+        {
+            const int O = box * B;
+
+            for (int nCnt = 0; nCnt < 3; nCnt++)
+            {
+                center[box][nCnt] = V::Load(&s.in[O + BOX_CENTER + nCnt][i]);
+                half[box][nCnt] = V::Load(&s.in[O + BOX_HALF + nCnt][i]);
+
+                for (int nCnt2 = 0; nCnt2 < 3; nCnt2++)
+                {
+                    axis[box][nCnt][nCnt2] = V::Load(&s.in[O + BOX_AXIS + nCnt * 3 + nCnt2][i]);
+                }
+            }
+        }
+
+        R minOverlap = V::Set(FLT_MAX);
+        R best[3] = { zero, zero, zero };
+        R separated = zero;
+
+        // 1本の軸で全組を調べる（validが偽の組はこの軸を使わない）
+        auto testAxis = [&](const R* n, R valid, R bias)
+        {
+            R proj[2][2];
+
+            for (int box = 0; box < 2; box++)
+            {
+                R r = zero;
+
+                for (int nCnt = 0; nCnt < 3; nCnt++)
+                {
+                    R dot = V::Add(V::Add(V::Mul(n[0], axis[box][nCnt][0]), V::Mul(n[1], axis[box][nCnt][1])), V::Mul(n[2], axis[box][nCnt][2]));
+                    r = V::Add(r, V::Mul(half[box][nCnt], V::Abs(dot)));
+                }
+
+                R c = V::Add(V::Add(V::Mul(n[0], center[box][0]), V::Mul(n[1], center[box][1])), V::Mul(n[2], center[box][2]));
+                proj[box][0] = V::Sub(c, r);
+                proj[box][1] = V::Add(c, r);
+            }
+
+            R overlap = V::Sub(V::Min(proj[0][1], proj[1][1]), V::Max(proj[0][0], proj[1][0]));
+
+            // 隙間のある軸が1本でもあれば当たっていない
+            separated = V::Or(separated, V::And(valid, V::LessEqual(overlap, zero)));
+
+            R take = V::And(valid, V::Less(V::Mul(overlap, bias), minOverlap));
+            minOverlap = V::Select(take, overlap, minOverlap);
+            best[0] = V::Select(take, n[0], best[0]);
+            best[1] = V::Select(take, n[1], best[1]);
+            best[2] = V::Select(take, n[2], best[2]);
+        };
+
+        const R allValid = V::LessEqual(zero, zero);
+        const R faceBias = V::Set(1.0f);
+
+        // 両方の面の軸
+        for (int box = 0; box < 2; box++)
+        {
+            for (int nCnt = 0; nCnt < 3; nCnt++)
+            {
+                testAxis(axis[box][nCnt], allValid, faceBias);
+            }
+        }
+
+        // 辺同士のクロス軸（ほぼ平行な組ではその軸を使わない）
+        for (int nCnt = 0; nCnt < 3 && V::MoveMask(separated) != ALL_LANES; nCnt++)
+        {
+            for (int nCnt2 = 0; nCnt2 < 3; nCnt2++)
+            {
+                const R* u = axis[0][nCnt];
+                const R* v = axis[1][nCnt2];
+                R c[3] =
+                {
+                    V::Sub(V::Mul(u[1], v[2]), V::Mul(u[2], v[1])),
+                    V::Sub(V::Mul(u[2], v[0]), V::Mul(u[0], v[2])),
+                    V::Sub(V::Mul(u[0], v[1]), V::Mul(u[1], v[0])),
+                };
+                R lenSq = V::Add(V::Add(V::Mul(c[0], c[0]), V::Mul(c[1], c[1])), V::Mul(c[2], c[2]));
+                R valid = V::Greater(lenSq, parallelEpsilon);
+
+                if (V::MoveMask(valid) == 0)
+                {
+                    continue;
+                }
+
+                R len = V::Sqrt(lenSq);
+                R n[3] = { V::Div(c[0], len), V::Div(c[1], len), V::Div(c[2], len) };
+
+                testAxis(n, valid, edgeBias);
+            }
+        }
+
+        R hit = V::AndNot(separated, allValid);
+        int hitBits = V::MoveMask(hit);
+
+        if (hitBits == 0)
+        {
+            continue;
+        }
+
+        // 押し戻し方向は a→b
+        R dir[3] = { V::Sub(center[1][0], center[0][0]), V::Sub(center[1][1], center[0][1]), V::Sub(center[1][2], center[0][2]) };
+        R dot = V::Add(V::Add(V::Mul(dir[0], best[0]), V::Mul(dir[1], best[1])), V::Mul(dir[2], best[2]));
+        R flip = V::Less(dot, zero);
+
+        for (int nCnt = 0; nCnt < 3; nCnt++)
+        {
+            best[nCnt] = V::Select(flip, V::Neg(best[nCnt]), best[nCnt]);
+        }
+
+        V::Store(&s.pushX[i], V::And(hit, V::Mul(best[0], minOverlap)));
+        V::Store(&s.pushY[i], V::And(hit, V::Mul(best[1], minOverlap)));
+        V::Store(&s.pushZ[i], V::And(hit, V::Mul(best[2], minOverlap)));
+        s.hitMask[i / LANE_ALIGN] |= (unsigned int)hitBits << (i % LANE_ALIGN);
+    }
+}
+
+#endif
@@ -0,0 +1,2865 @@
+//=============================================================================
+//
+// 物理の計測・検証処理 [PhysicsBench.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "PhysicsBench.h"
+#include "RigidBody.h"
+#include "TriangleShape.h"
+#include "algorithm"
+#include "chrono"
+#include "random"
+
+//*****************************************************************************
+// 積分の計測で比べる以前の剛体（1つずつヒープに置き、積分で触る状態もまとめて持っていた形）
+//*****************************************************************************
+namespace
+{
+    struct LegacyRigidBody
+    {
+        std::shared_ptr<Collider>   m_Collider;            // コライダーのポインタ
+        D3DXVECTOR3                 m_Position;            // 位置
+        D3DXVECTOR3                 m_Velocity;            // 速度
+        D3DXVECTOR3                 m_Scale;               // 拡大率
+        D3DXVECTOR3                 m_AccumulatedForce;    // 外力の蓄積
+        D3DXVECTOR3                 m_AccumulatedTorque;   // トルクの蓄積
+        D3DXVECTOR3                 m_AngularFactor;       // 回転方向
+        D3DXVECTOR3                 m_Inertia;             // 慣性モーメント
+        D3DXVECTOR3                 m_InertiaInv;          // 慣性
+        D3DXVECTOR3                 m_Rotation;            // 向き
+        D3DXVECTOR3                 m_LinearFactor;        // 移動方向
+        D3DXVECTOR3                 m_AngularVelocity;     // 角速度
+        D3DXVECTOR3                 m_PushVelocity;        // めり込み解消用の疑似速度
+        D3DXVECTOR3                 m_TurnVelocity;        // めり込み解消用の疑似角速度
+        D3DXQUATERNION              m_Orientation;         // 回転
+        float                       m_Friction;            // 摩擦
+        float                       m_RollingFriction;     // 回転摩擦
+        float                       m_Restitution;         // 反発係数
+        float                       m_Mass;                // 質量
+        int                         m_ProxyId;             // ブロードフェーズのプロキシ番号
+        int                         m_IslandIndex;         // アイランド計算用の番号
+        int                         m_SleepCounter;        // 静止が続いているフレーム数
+        bool                        m_isDynamic;           // 動的ブロックかどうか
+        bool                        m_onGround;            // 乗っているかどうか
+        bool                        m_isMoved;             // AABBの更新が必要かどうか
+        bool                        m_isSleeping;          // スリープ中かどうか
+
+        // 速度の積分（以前のRigidBody::IntegrateVelocityと同じ）
+        void IntegrateVelocity(float dt, const D3DXVECTOR3& gravity)
+        {
+            if (!m_isDynamic || m_isSleeping)
+            {
+                return;
+            }
+
+            if (!m_onGround)
+            {
+                m_Velocity += gravity * m_Mass * dt;
+            }
+
+            m_AngularVelocity += D3DXVECTOR3(
+                m_AccumulatedTorque.x * m_InertiaInv.x,
+                m_AccumulatedTorque.y * m_InertiaInv.y,
+                m_AccumulatedTorque.z * m_InertiaInv.z) * dt;
+
+            m_AccumulatedForce = INIT_VEC3;
+            m_AccumulatedTorque = INIT_VEC3;
+        }
+
+        // 位置の積分（以前のRigidBody::IntegratePositionと同じ。コライダーの更新も計算と同じループで呼ぶ）
+        void IntegratePosition(float dt)
+        {
+            if (!m_isDynamic || m_isSleeping)
+            {
+                return;
+            }
+
+            m_Position += (m_Velocity + m_PushVelocity) * dt;
+
+            D3DXVECTOR3 angVel = m_AngularVelocity + m_TurnVelocity;
+
+            m_PushVelocity = INIT_VEC3;
+            m_TurnVelocity = INIT_VEC3;
+
+            if (D3DXVec3LengthSq(&angVel) > 1e-6f)
+            {
+                D3DXQUATERNION omega(angVel.x, angVel.y, angVel.z, 0);
+                D3DXQUATERNION dq;
+                D3DXQuaternionMultiply(&dq, &omega, &m_Orientation);
+
+                m_Orientation.x += dq.x * 0.5f * dt;
+                m_Orientation.y += dq.y * 0.5f * dt;
+                m_Orientation.z += dq.z * 0.5f * dt;
+                m_Orientation.w += dq.w * 0.5f * dt;
+
+                D3DXQuaternionNormalize(&m_Orientation, &m_Orientation);
+            }
+
+            m_Velocity *= (1.0f - m_Friction * dt);
+            m_AngularVelocity *= 0.98f;
+
+            if (m_Collider)
+            {
+                m_Collider->UpdateTransform(m_Position, m_Orientation, m_Scale);
+            }
+
+            m_isMoved = true;
+        }
+    };
+}
+
+//*****************************************************************************
+// 振り分けの計測で使う判定本体なしの関数表（PhysicsWorld::CollisionFuncの引数の前にワールドを取る形で、並びは本物の関数表と同じ）
+//*****************************************************************************
+namespace
+{
+    template <class FUNC>
+    struct StubFuncOf;
+
+    template <class R, class... ARGS>
+    struct StubFuncOf<R (PhysicsWorld::*)(ARGS...)>
+    {
+        using Type = R (*)(PhysicsWorld& world, ARGS...);
+    };
+
+    using StubCollisionFunc = StubFuncOf<PhysicsWorld::CollisionFunc>::Type;
+    using StubCollisionTable = std::array<std::array<StubCollisionFunc, Collider::TYPE_MAX>, Collider::TYPE_MAX>;
+
+    // 判定本体の代わり（組み合わせごとに別の関数にして、呼び先が散らばるところは本物と揃える）
+    template <class TA, class TB>
+    bool StubCollision(PhysicsWorld& world, Collider* a, Collider* b, D3DXVECTOR3& outPush)
+    {
+        outPush = INIT_VEC3;
+        return false;
+    }
+
+    // 入れ替えた判定本体の代わり（押し戻しの向きを戻す手間も本物と揃える）
+    template <class TA, class TB>
+    bool StubCollisionSwapped(PhysicsWorld& world, Collider* a, Collider* b, D3DXVECTOR3& outPush)
+    {
+        bool collided = StubCollision<TA, TB>(world, b, a, outPush);
+        outPush = -outPush;
+        return collided;
+    }
+
+    constexpr StubCollisionTable MakeStubCollisionTable(void)
+    {
+        StubCollisionTable table = {};
+
+        table[Collider::BOX][Collider::BOX]           = &StubCollision<BoxCollider, BoxCollider>;
+        table[Collider::BOX][Collider::CAPSULE]       = &StubCollisionSwapped<CapsuleCollider, BoxCollider>;
+        table[Collider::BOX][Collider::CYLINDER]      = &StubCollision<Collider, Collider>;
+        table[Collider::BOX][Collider::SPHERE]        = &StubCollisionSwapped<SphereCollider, BoxCollider>;
+        table[Collider::BOX][Collider::MESH]          = &StubCollision<BoxCollider, MeshCollider>;
+
+        table[Collider::CAPSULE][Collider::BOX]       = &StubCollision<CapsuleCollider, BoxCollider>;
+        table[Collider::CAPSULE][Collider::CAPSULE]   = &StubCollision<CapsuleCollider, CapsuleCollider>;
+        table[Collider::CAPSULE][Collider::CYLINDER]  = &StubCollisionSwapped<CylinderCollider, CapsuleCollider>;
+        table[Collider::CAPSULE][Collider::SPHERE]    = &StubCollisionSwapped<SphereCollider, CapsuleCollider>;
+        table[Collider::CAPSULE][Collider::MESH]      = &StubCollision<CapsuleCollider, MeshCollider>;
+
+        table[Collider::CYLINDER][Collider::BOX]      = &StubCollision<Collider, Collider>;
+        table[Collider::CYLINDER][Collider::CAPSULE]  = &StubCollision<CylinderCollider, CapsuleCollider>;
+        table[Collider::CYLINDER][Collider::CYLINDER] = &StubCollision<Collider, Collider>;
+        table[Collider::CYLINDER][Collider::SPHERE]   = &StubCollisionSwapped<SphereCollider, CylinderCollider>;
+        table[Collider::CYLINDER][Collider::MESH]     = &StubCollision<CylinderCollider, MeshCollider>;
+
+        table[Collider::SPHERE][Collider::BOX]        = &StubCollision<SphereCollider, BoxCollider>;
+        table[Collider::SPHERE][Collider::CAPSULE]    = &StubCollision<SphereCollider, CapsuleCollider>;
+        table[Collider::SPHERE][Collider::CYLINDER]   = &StubCollision<SphereCollider, CylinderCollider>;
+        table[Collider::SPHERE][Collider::SPHERE]     = &StubCollision<SphereCollider, SphereCollider>;
+        table[Collider::SPHERE][Collider::MESH]       = &StubCollision<SphereCollider, MeshCollider>;
+
+        table[Collider::MESH][Collider::BOX]          = &StubCollisionSwapped<BoxCollider, MeshCollider>;
+        table[Collider::MESH][Collider::CAPSULE]      = &StubCollisionSwapped<CapsuleCollider, MeshCollider>;
+        table[Collider::MESH][Collider::CYLINDER]     = &StubCollisionSwapped<CylinderCollider, MeshCollider>;
+        table[Collider::MESH][Collider::SPHERE]       = &StubCollisionSwapped<SphereCollider, MeshCollider>;
+        table[Collider::MESH][Collider::MESH]         = &StubCollision<MeshCollider, MeshCollider>;
+        table[Collider::MESH][Collider::CONVEX]       = &StubCollisionSwapped<ConvexCollider, MeshCollider>;
+
+        for (int nType : { Collider::BOX, Collider::CAPSULE, Collider::CYLINDER, Collider::SPHERE, Collider::CONVEX })
+        {
+            table[Collider::CONVEX][nType] = &StubCollision<Collider, Collider>;
+            table[nType][Collider::CONVEX] = &StubCollision<Collider, Collider>;
+        }
+
+        table[Collider::CONVEX][Collider::MESH]       = &StubCollision<ConvexCollider, MeshCollider>;
+
+        for (int nType = 0; nType < Collider::TYPE_MAX; nType++)
+        {
+            table[Collider::COMPOUND][nType] = &StubCollision<CompoundCollider, Collider>;
+
+            if (nType != Collider::COMPOUND)
+            {
+                table[nType][Collider::COMPOUND] = &StubCollisionSwapped<CompoundCollider, Collider>;
+            }
+        }
+
+        return table;
+    }
+
+    const StubCollisionTable STUB_COLLISION_TABLE = MakeStubCollisionTable();
+
+    // 表は毎回このポインタから読む（同じ翻訳単位の表だと、if/elseの連鎖では呼び先が畳み込まれて呼び出しそのものが消えるため）
+    const StubCollisionTable* volatile g_pStubCollisionTable = &STUB_COLLISION_TABLE;
+}
+
+//=============================================================================
+// スイープ＆プルーンの計測処理（1000個・1万個の山でステップとペアの収集の時間を測り、全組の二重ループと比べる）
+//=============================================================================
+SweepAndPruneBenchResult PhysicsBench::MeasureSweepAndPrune(void)
+{
+    SweepAndPruneBenchResult result;
+
+    for (int nSize = 0; nSize < SweepAndPruneBenchResult::NUM_SIZES; nSize++)
+    {
+        PhysicsWorld world(Broadphase::SWEEP_AND_PRUNE);
+
+        // 山の下に床を敷く
+        const float floorWidth = cbrtf((float)result.numBodies[nSize]) * PILE_SPACING * 4.0f;
+        CreateFloor(world, floorWidth, floorWidth);
+
+        std::vector<RigidBody*> bodies;
+        CreatePileStage(world, result.numBodies[nSize], INIT_VEC3, bodies);
+
+        for (int nCnt = 0; nCnt < SAP_WARMUP_STEPS; nCnt++)
+        {
+            world.StepSimulation(TIME_STEP);
+        }
+
+        // ステップ全体と、同じ状態でのペアの収集だけを測る
+        std::vector<BroadphasePair> pairs;
+        float stepTime = 0.0f;
+        float sweepTime = 0.0f;
+
+        for (int nCnt = 0; nCnt < SAP_STEPS; nCnt++)
+        {
+            world.StepSimulation(TIME_STEP);
+            stepTime += world.GetStepTime();
+
+            auto sweepStart = std::chrono::high_resolution_clock::now();
+            world.m_pBroadphase->UpdatePairs(pairs);
+            sweepTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - sweepStart).count();
+        }
+
+        result.stepTime[nSize] = stepTime / SAP_STEPS;
+        result.sweepTime[nSize] = sweepTime / SAP_STEPS;
+        result.numPairs[nSize] = (int)pairs.size();
+
+        D3DXVECTOR3 push;
+
+        for (const BroadphasePair& pair : pairs)
+        {
+            result.numHits[nSize] += world.CheckCollision(pair.a, pair.b, push) ? 1 : 0;
+        }
+
+        // 以前の二重ループ（全部の組を判定関数に通す）の1反復分
+        auto allPairsStart = std::chrono::high_resolution_clock::now();
+
+        for (size_t nA = 0; nA < bodies.size(); nA++)
+        {
+            for (size_t nB = nA + 1; nB < bodies.size(); nB++)
+            {
+                result.numAllPairsHits[nSize] += world.CheckCollision(bodies[nA], bodies[nB], push) ? 1 : 0;
+            }
+        }
+
+        result.allPairsTime[nSize] = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - allPairsStart).count();
+    }
+
+    return result;
+}
+//=============================================================================
+// ブロードフェーズの比較処理（通路と山を両方の種類で回し、ステップとペアの収集の時間を測る）
+//=============================================================================
+BroadphaseBenchResult PhysicsBench::MeasureBroadphase(void)
+{
+    BroadphaseBenchResult result;
+    result.numBodies = BROADPHASE_BENCH_BODIES;
+
+    const Broadphase::TYPE TYPES[BroadphaseBenchResult::NUM_TYPES] = { Broadphase::SWEEP_AND_PRUNE, Broadphase::DYNAMIC_AABB_TREE };
+
+    for (int nStage = 0; nStage < BroadphaseBenchResult::STAGE_MAX; nStage++)
+    {
+        for (int nType = 0; nType < BroadphaseBenchResult::NUM_TYPES; nType++)
+        {
+            // ペアの並びを剛体の番号で決め、どちらの種類でも同じ動きにする
+            PhysicsWorld world(TYPES[nType]);
+            world.SetDeterministic(true);
+
+            std::vector<RigidBody*> bodies;
+
+            if (nStage == BroadphaseBenchResult::STAGE_CORRIDOR)
+            {
+                const float length = (float)(BROADPHASE_BENCH_BODIES / (CORRIDOR_WIDTH * CORRIDOR_HEIGHT)) * PILE_SPACING;
+                CreateFloor(world, CORRIDOR_WIDTH * PILE_SPACING * 4.0f, length * 2.0f);
+                CreateCorridorStage(world, BROADPHASE_BENCH_BODIES, bodies);
+            }
+            else
+            {
+                const float floorWidth = cbrtf((float)BROADPHASE_BENCH_BODIES) * PILE_SPACING * 4.0f;
+                CreateFloor(world, floorWidth, floorWidth);
+                CreatePileStage(world, BROADPHASE_BENCH_BODIES, INIT_VEC3, bodies);
+            }
+
+            for (int nCnt = 0; nCnt < SAP_WARMUP_STEPS; nCnt++)
+            {
+                world.StepSimulation(TIME_STEP);
+            }
+
+            std::vector<BroadphasePair> pairs;
+            float stepTime = 0.0f;
+            float pairTime = 0.0f;
+
+            for (int nCnt = 0; nCnt < SAP_STEPS; nCnt++)
+            {
+                world.StepSimulation(TIME_STEP);
+                stepTime += world.GetStepTime();
+
+                auto pairStart = std::chrono::high_resolution_clock::now();
+                world.m_pBroadphase->UpdatePairs(pairs);
+                pairTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - pairStart).count();
+            }
+
+            result.stepTime[nStage][nType] = stepTime / SAP_STEPS;
+            result.pairTime[nStage][nType] = pairTime / SAP_STEPS;
+            result.numPairs[nStage][nType] = (int)pairs.size();
+
+            D3DXVECTOR3 push;
+
+            for (const BroadphasePair& pair : pairs)
+            {
+                result.numHits[nStage][nType] += world.CheckCollision(pair.a, pair.b, push) ? 1 : 0;
+            }
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// 起床の計測処理（眠った10段の積み上げの上に箱を落とし、積み上げが何ステップかけて起きるかと起きてからの重なりを見る）
+//=============================================================================
+IslandWakeResult PhysicsBench::MeasureIslandWake(void)
+{
+    IslandWakeResult result;
+
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+
+    PhysicsWorld world;
+    world.SetGravity(D3DXVECTOR3(0.0f, EDITOR_GRAVITY, 0.0f));
+
+    std::vector<RigidBody*> bodies;
+    std::vector<RigidBody*> tops;
+    CreateFloor(world, STACK_FLOOR_SIZE, STACK_FLOOR_SIZE);
+    CreateStackStage(world, WAKE_STACK_HEIGHT, 1, bodies, tops);
+    result.numBodies = (int)bodies.size();
+
+    // 隣り合う箱（一番下は床）の最大の重なり（積んだ順に下から並んでいる）
+    auto getPenetration = [&bodies]()
+    {
+        float penetration = STACK_BOX_SIZE * HALF - bodies[0]->GetPosition().y;
+
+        for (size_t nCnt = 1; nCnt < bodies.size(); nCnt++)
+        {
+            penetration = std::max(penetration, STACK_BOX_SIZE - (bodies[nCnt]->GetPosition().y - bodies[nCnt - 1]->GetPosition().y));
+        }
+
+        return penetration;
+    };
+
+    for (int nStep = 0; nStep < WAKE_SETTLE_STEPS; nStep++)
+    {
+        world.StepSimulation(TIME_STEP);
+
+        if (world.GetSleepingBodyCount() == result.numBodies)
+        {
+            result.sleepStep = nStep;
+            break;
+        }
+    }
+
+    if (result.sleepStep < 0)
+    {
+        return result;
+    }
+
+    result.sleepPenetration = getPenetration();
+
+    // 一番上の箱の真上から落とす
+    float dropY = tops[0]->GetPosition().y + STACK_BOX_SIZE + WAKE_DROP_HEIGHT;
+    RigidBody* dropped = world.GetRigidBody(world.CreateRigidBody(
+        std::make_shared<BoxCollider>(D3DXVECTOR3(STACK_BOX_SIZE, STACK_BOX_SIZE, STACK_BOX_SIZE)), 1.0f, true));
+    dropped->SetTransform(D3DXVECTOR3(tops[0]->GetPosition().x, dropY, 0.0f), identity, unitScale);
+    dropped->SetVelocity(D3DXVECTOR3(0.0f, -WAKE_DROP_SPEED, 0.0f));
+
+    for (int nStep = 0; nStep < WAKE_STEPS; nStep++)
+    {
+        world.StepSimulation(TIME_STEP);
+
+        int numAwake = 0;
+
+        for (RigidBody* body : bodies)
+        {
+            if (!body->IsSleeping())
+            {
+                numAwake++;
+            }
+        }
+
+        if (numAwake > 0 && result.firstWakeStep < 0)
+        {
+            result.firstWakeStep = nStep;
+        }
+
+        if (numAwake == result.numBodies && result.lastWakeStep < 0)
+        {
+            result.lastWakeStep = nStep;
+        }
+
+        if (result.firstWakeStep >= 0)
+        {
+            result.maxPenetration = std::max(result.maxPenetration, getPenetration());
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// 積み上げの計測処理（10段×10列をウォームスタートの有無と速度の反復回数を変えて比べる）
+//=============================================================================
+StackingBenchResult PhysicsBench::MeasureStacking(void)
+{
+    StackingBenchResult result;
+    result.numColumns = STACKING_COLUMNS;
+    result.height = STACKING_HEIGHT;
+
+    const float topY = GetStackTopY(STACKING_HEIGHT);
+
+    for (int nConfig = 0; nConfig < StackingBenchResult::NUM_CONFIGS; nConfig++)
+    {
+        PhysicsWorld world;
+        world.SetGravity(D3DXVECTOR3(0.0f, EDITOR_GRAVITY, 0.0f));
+        world.SetWarmStarting(result.isWarmStarting[nConfig]);
+        world.SetSolverIterations(result.velocityIterations[nConfig], PhysicsWorld::DEFAULT_POSITION_ITERATIONS);
+
+        // 途中で打ち切らず、決めた回数を必ず回して手間をそろえる
+        world.SetConvergenceTolerance(0.0f, 0.0f);
+
+        std::vector<RigidBody*> bodies;
+        std::vector<RigidBody*> tops;
+        CreateFloor(world, STACK_FLOOR_SIZE, STACK_FLOOR_SIZE);
+        CreateStackStage(world, STACKING_HEIGHT, STACKING_COLUMNS, bodies, tops);
+
+        std::vector<D3DXVECTOR3> startPos(tops.size());
+
+        for (size_t nCnt = 0; nCnt < tops.size(); nCnt++)
+        {
+            startPos[nCnt] = tops[nCnt]->GetPosition();
+        }
+
+        float stepTime = 0.0f;
+        result.restStep[nConfig] = -1;
+
+        for (int nStep = 0; nStep < STACK_STEPS; nStep++)
+        {
+            world.StepSimulation(TIME_STEP);
+            stepTime += world.GetStepTime();
+
+            if (result.restStep[nConfig] < 0 && world.GetSleepingBodyCount() == (int)bodies.size())
+            {
+                result.restStep[nConfig] = nStep;
+            }
+
+            if (nStep < STACK_SETTLE_STEPS)
+            {
+                continue;
+            }
+
+            for (size_t nCnt = 0; nCnt < tops.size(); nCnt++)
+            {
+                D3DXVECTOR3 pos = tops[nCnt]->GetPosition();
+                float driftX = pos.x - startPos[nCnt].x;
+                float driftZ = pos.z - startPos[nCnt].z;
+
+                result.maxSag[nConfig] = std::max(result.maxSag[nConfig], topY - pos.y);
+                result.maxDrift[nConfig] = std::max(result.maxDrift[nConfig], sqrtf(driftX * driftX + driftZ * driftZ));
+            }
+        }
+
+        result.stepTime[nConfig] = stepTime / STACK_STEPS;
+
+        // 一番上の箱が半分以上沈んだり、箱1つ分以上ずれたりしていなければ立っている
+        for (size_t nCnt = 0; nCnt < tops.size(); nCnt++)
+        {
+            D3DXVECTOR3 pos = tops[nCnt]->GetPosition();
+            D3DXVECTOR3 drift = pos - startPos[nCnt];
+            drift.y = 0.0f;
+
+            if (topY - pos.y < STACK_BOX_SIZE * HALF && D3DXVec3Length(&drift) < STACK_BOX_SIZE)
+            {
+                result.numStanding[nConfig]++;
+            }
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// 静止までの計測処理（積んだ箱が全部眠るまでのステップ数と、そこまでの速度の反復回数・時間を設定ごとに測る）
+//=============================================================================
+SolverRestBenchResult PhysicsBench::MeasureSolverRest(void)
+{
+    SolverRestBenchResult result;
+
+    for (int nScene = 0; nScene < SolverRestBenchResult::NUM_SCENES; nScene++)
+    {
+        const int height = result.height[nScene];
+        const float topY = GetStackTopY(height);
+
+        for (int nConfig = 0; nConfig < SolverRestBenchResult::NUM_CONFIGS; nConfig++)
+        {
+            PhysicsWorld world;
+            world.SetGravity(D3DXVECTOR3(0.0f, EDITOR_GRAVITY, 0.0f));
+            world.SetWarmStarting(result.isWarmStarting[nConfig]);
+
+            // 打ち切らない設定は決めた回数を必ず回す
+            if (!result.isEarlyOut[nConfig])
+            {
+                world.SetConvergenceTolerance(0.0f, 0.0f);
+            }
+
+            std::vector<RigidBody*> bodies;
+            std::vector<RigidBody*> tops;
+            CreateFloor(world, STACK_FLOOR_SIZE, STACK_FLOOR_SIZE);
+            CreateStackStage(world, height, result.numColumns[nScene], bodies, tops);
+
+            for (RigidBody* body : bodies)
+            {
+                body->SetFriction(SOLVER_REST_FRICTION);
+            }
+
+            std::vector<D3DXVECTOR3> startPos(tops.size());
+
+            for (size_t nCnt = 0; nCnt < tops.size(); nCnt++)
+            {
+                startPos[nCnt] = tops[nCnt]->GetPosition();
+            }
+
+            float stepTime = 0.0f;
+            int velocityPasses = 0;
+            int numSteps = 0;
+            result.restStep[nScene][nConfig] = -1;
+
+            for (int nStep = 0; nStep < STACK_STEPS; nStep++)
+            {
+                float time = 0.0f;
+                int passes = PUSH_OUT_VELOCITY_ITERATIONS;
+
+                if (result.isPushOut[nConfig])
+                {
+                    time = StepPushOut(world, TIME_STEP);
+                }
+                else
+                {
+                    world.StepSimulation(TIME_STEP);
+                    time = world.GetStepTime();
+                    passes = world.GetVelocityPasses();
+                }
+
+                // 眠るまでの手間だけを数える
+                if (result.restStep[nScene][nConfig] < 0)
+                {
+                    stepTime += time;
+                    velocityPasses += passes;
+                    numSteps++;
+
+                    if (world.GetSleepingBodyCount() == (int)bodies.size())
+                    {
+                        result.restStep[nScene][nConfig] = nStep;
+                    }
+                }
+
+                if (nStep < STACK_SETTLE_STEPS)
+                {
+                    continue;
+                }
+
+                for (RigidBody* top : tops)
+                {
+                    result.maxSag[nScene][nConfig] = std::max(result.maxSag[nScene][nConfig], topY - top->GetPosition().y);
+                }
+            }
+
+            result.stepTime[nScene][nConfig] = stepTime / numSteps;
+            result.velocityPasses[nScene][nConfig] = (float)velocityPasses / numSteps;
+
+            // 積み上げの計測と同じく、一番上の箱が半分以上沈んだり箱1つ分以上ずれたりしていなければ立っている
+            for (size_t nCnt = 0; nCnt < tops.size(); nCnt++)
+            {
+                D3DXVECTOR3 pos = tops[nCnt]->GetPosition();
+                D3DXVECTOR3 drift = pos - startPos[nCnt];
+                drift.y = 0.0f;
+
+                if (topY - pos.y < STACK_BOX_SIZE * HALF && D3DXVec3Length(&drift) < STACK_BOX_SIZE)
+                {
+                    result.numStanding[nScene][nConfig]++;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// 以前の押し戻しのソルバーで1ステップ進める処理（比較用。並進だけのインパルスを解いたあと、重なった組をSetTransformで押し戻す）
+// 返り値は1ステップの時間(ms)
+//=============================================================================
+float PhysicsBench::StepPushOut(PhysicsWorld& world, float dt)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    world.m_BodyPool.StorePreviousTransforms();
+    world.m_BodyPool.IntegrateVelocity(dt, world.m_Gravity);
+    world.CollectContacts(dt);
+
+    // ある程度の速さでぶつかったときだけ跳ね返す（以前は予測接触がないので重なった点だけ解く）
+    for (ContactManifold* manifold : world.m_Manifolds)
+    {
+        RigidBody* A = manifold->a;
+        RigidBody* B = manifold->b;
+
+        D3DXVECTOR3 relVel = B->GetVelocity() - A->GetVelocity();
+        float velAlongNormal = D3DXVec3Dot(&relVel, &manifold->normal);
+        float e = std::min(A->GetRestitution(), B->GetRestitution());
+        float bias = (velAlongNormal < -PhysicsWorld::RESTITUTION_THRESHOLD) ? -e * velAlongNormal : 0.0f;
+
+        for (int nCnt = 0; nCnt < manifold->numPoints; nCnt++)
+        {
+            manifold->points[nCnt].velocityBias = bias;
+        }
+    }
+
+    // ウォームスタート（法線のインパルスの合計を重心に加える）
+    for (ContactManifold* manifold : world.m_Manifolds)
+    {
+        float total = 0.0f;
+
+        for (int nCnt = 0; nCnt < manifold->numPoints; nCnt++)
+        {
+            if (manifold->points[nCnt].depth >= 0.0f)
+            {
+                total += manifold->points[nCnt].normalImpulse;
+            }
+        }
+
+        if (total <= 0.0f)
+        {
+            continue;
+        }
+
+        D3DXVECTOR3 impulse = manifold->normal * total;
+        manifold->a->ApplyImpulse(-impulse, INIT_VEC3);
+        manifold->b->ApplyImpulse(impulse, INIT_VEC3);
+    }
+
+    // 速度の反復解決（回転も摩擦もなく、累積インパルスを0以上にクランプするだけ）
+    for (int nIter = 0; nIter < PUSH_OUT_VELOCITY_ITERATIONS; nIter++)
+    {
+        for (ContactManifold* manifold : world.m_Manifolds)
+        {
+            RigidBody* A = manifold->a;
+            RigidBody* B = manifold->b;
+            float invMassSum = A->GetInverseMass() + B->GetInverseMass();
+
+            if (invMassSum <= 0.0f)
+            {
+                continue;
+            }
+
+            for (int nCnt = 0; nCnt < manifold->numPoints; nCnt++)
+            {
+                ContactPoint& cp = manifold->points[nCnt];
+
+                if (cp.depth < 0.0f)
+                {
+                    continue;
+                }
+
+                D3DXVECTOR3 relVel = B->GetVelocity() - A->GetVelocity();
+                float velAlongNormal = D3DXVec3Dot(&relVel, &manifold->normal);
+
+                float lambda = (cp.velocityBias - velAlongNormal) / invMassSum;
+                float oldImpulse = cp.normalImpulse;
+                cp.normalImpulse = std::max(oldImpulse + lambda, 0.0f);
+                lambda = cp.normalImpulse - oldImpulse;
+
+                D3DXVECTOR3 impulse = manifold->normal * lambda;
+                A->ApplyImpulse(-impulse, INIT_VEC3);
+                B->ApplyImpulse(impulse, INIT_VEC3);
+            }
+        }
+    }
+
+    world.m_BodyPool.IntegratePosition(dt);
+
+    // 位置の補正（このステップで新しくめり込んだ組も拾い、許容量を残して位置を直接ずらす）
+    for (int nIter = 0; nIter < PUSH_OUT_POSITION_ITERATIONS; nIter++)
+    {
+        for (const BroadphasePair& pair : world.m_Pairs)
+        {
+            RigidBody* A = pair.a;
+            RigidBody* B = pair.b;
+            D3DXVECTOR3 push;
+
+            if (A->IsTrigger() || B->IsTrigger() || !world.CheckCollision(A, B, push))
+            {
+                continue;
+            }
+
+            float depth = D3DXVec3Length(&push);
+
+            if (push.y > 0.7f * depth)
+            {
+                if (A->IsDynamic()) A->SetOnGround(true);
+                if (B->IsDynamic()) B->SetOnGround(true);
+            }
+
+            if (depth <= PhysicsWorld::POSITION_SLOP)
+            {
+                continue;
+            }
+
+            push *= (depth - PhysicsWorld::POSITION_SLOP) / depth;
+
+            if (A->IsDynamic() && B->IsDynamic())
+            {
+                A->SetTransform(A->GetPosition() - push * HALF, A->GetOrientation(), A->GetScale());
+                B->SetTransform(B->GetPosition() + push * HALF, B->GetOrientation(), B->GetScale());
+            }
+            else if (A->IsDynamic())
+            {
+                A->SetTransform(A->GetPosition() - push, A->GetOrientation(), A->GetScale());
+            }
+            else if (B->IsDynamic())
+            {
+                B->SetTransform(B->GetPosition() + push, B->GetOrientation(), B->GetScale());
+            }
+        }
+    }
+
+    // 接地した剛体の下向きの速度を消す
+    for (RigidBody* body : world.m_DynamicBodies)
+    {
+        D3DXVECTOR3 vel = body->GetVelocity();
+
+        if (body->IsOnGround() && vel.y < 0.0f)
+        {
+            vel.y = 0.0f;
+            body->SetVelocity(vel);
+        }
+    }
+
+    world.UpdateSleeping();
+
+    return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+//=============================================================================
+// 衝突判定の振り分けの計測処理（種類の混ざった組を関数表とif/elseの連鎖で振り分け、判定本体を外した手間を比べる）
+//=============================================================================
+DispatchBenchResult PhysicsBench::MeasureDispatch(void)
+{
+    DispatchBenchResult result;
+
+    PhysicsWorld world;
+    std::mt19937 rng(DISPATCH_BENCH_SEED);
+    std::uniform_int_distribution<int> typeDist(0, DISPATCH_BENCH_TYPES - 1);
+    std::uniform_int_distribution<int> bodyDist(0, DISPATCH_BENCH_BODIES - 1);
+
+    const D3DXVECTOR3 size(PILE_BOX_SIZE, PILE_BOX_SIZE, PILE_BOX_SIZE);
+    std::vector<RigidBody*> bodies;
+
+    for (int nCnt = 0; nCnt < DISPATCH_BENCH_BODIES; nCnt++)
+    {
+        std::shared_ptr<Collider> col;
+
+        switch (typeDist(rng))
+        {
+        case Collider::BOX:
+            col = std::make_shared<BoxCollider>(size);
+            break;
+        case Collider::CAPSULE:
+            col = std::make_shared<CapsuleCollider>(PILE_BOX_SIZE * HALF, PILE_BOX_SIZE);
+            break;
+        case Collider::CYLINDER:
+            col = std::make_shared<CylinderCollider>(size, D3DXVECTOR3(0.0f, 1.0f, 0.0f));
+            break;
+        default:
+            col = std::make_shared<SphereCollider>(size);
+            break;
+        }
+
+        bodies.push_back(world.GetRigidBody(world.CreateRigidBody(col, 1.0f, true)));
+    }
+
+    std::vector<BroadphasePair> pairs(DISPATCH_BENCH_PAIRS);
+
+    for (BroadphasePair& pair : pairs)
+    {
+        pair.a = bodies[bodyDist(rng)];
+        pair.b = bodies[bodyDist(rng)];
+    }
+
+    result.numPairs = DISPATCH_BENCH_PAIRS;
+    result.numCalls = DISPATCH_BENCH_PAIRS * DISPATCH_BENCH_REPEAT;
+
+    // 判定本体を呼ばない関数表（中身はCheckCollisionと同じ引き方）
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < DISPATCH_BENCH_REPEAT; nCnt++)
+    {
+        for (const BroadphasePair& pair : pairs)
+        {
+            Collider* colA = pair.a->GetColliderPtr();
+            Collider* colB = pair.b->GetColliderPtr();
+            D3DXVECTOR3 push;
+
+            StubCollisionFunc func = (*g_pStubCollisionTable)[colA->GetType()][colB->GetType()];
+
+            func(world, colA, colB, push);
+        }
+    }
+
+    result.tableCost = std::chrono::duration<float, std::nano>(std::chrono::high_resolution_clock::now() - startTime).count() / result.numCalls;
+
+    // 以前のif/elseの連鎖（選んだ先は同じ判定本体なしの関数なので、違いは選び方だけ）
+    startTime = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < DISPATCH_BENCH_REPEAT; nCnt++)
+    {
+        for (const BroadphasePair& pair : pairs)
+        {
+            D3DXVECTOR3 push;
+            ChainDispatch(world, pair.a, pair.b, push);
+        }
+    }
+
+    result.chainCost = std::chrono::duration<float, std::nano>(std::chrono::high_resolution_clock::now() - startTime).count() / result.numCalls;
+
+    return result;
+}
+//=============================================================================
+// 以前のif/elseの連鎖による振り分け処理（比較用。コライダーをshared_ptrで受け取り、分岐ごとに種類を読み直す）
+//=============================================================================
+bool PhysicsBench::ChainDispatch(PhysicsWorld& world, RigidBody* a, RigidBody* b, D3DXVECTOR3& outPush)
+{
+    const StubCollisionTable& table = *g_pStubCollisionTable;
+
+    auto colA = a->GetCollider();
+    auto colB = b->GetCollider();
+
+    if (colA->GetType() == Collider::BOX && colB->GetType() == Collider::BOX)
+    {
+        return table[Collider::BOX][Collider::BOX](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::CAPSULE && colB->GetType() == Collider::BOX)
+    {
+        return table[Collider::CAPSULE][Collider::BOX](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::BOX && colB->GetType() == Collider::CAPSULE)
+    {
+        return table[Collider::BOX][Collider::CAPSULE](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::CAPSULE && colB->GetType() == Collider::CAPSULE)
+    {
+        return table[Collider::CAPSULE][Collider::CAPSULE](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::CYLINDER && colB->GetType() == Collider::BOX)
+    {
+        return table[Collider::CYLINDER][Collider::BOX](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::BOX && colB->GetType() == Collider::CYLINDER)
+    {
+        return table[Collider::BOX][Collider::CYLINDER](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::CYLINDER && colB->GetType() == Collider::CAPSULE)
+    {
+        return table[Collider::CYLINDER][Collider::CAPSULE](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::CAPSULE && colB->GetType() == Collider::CYLINDER)
+    {
+        return table[Collider::CAPSULE][Collider::CYLINDER](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::CYLINDER && colB->GetType() == Collider::CYLINDER)
+    {
+        return table[Collider::CYLINDER][Collider::CYLINDER](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::SPHERE && colB->GetType() == Collider::BOX)
+    {
+        return table[Collider::SPHERE][Collider::BOX](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::BOX && colB->GetType() == Collider::SPHERE)
+    {
+        return table[Collider::BOX][Collider::SPHERE](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::SPHERE && colB->GetType() == Collider::CAPSULE)
+    {
+        return table[Collider::SPHERE][Collider::CAPSULE](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::CAPSULE && colB->GetType() == Collider::SPHERE)
+    {
+        return table[Collider::CAPSULE][Collider::SPHERE](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::SPHERE && colB->GetType() == Collider::CYLINDER)
+    {
+        return table[Collider::SPHERE][Collider::CYLINDER](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::CYLINDER && colB->GetType() == Collider::SPHERE)
+    {
+        return table[Collider::CYLINDER][Collider::SPHERE](world, colA.get(), colB.get(), outPush);
+    }
+    else if (colA->GetType() == Collider::SPHERE && colB->GetType() == Collider::SPHERE)
+    {
+        return table[Collider::SPHERE][Collider::SPHERE](world, colA.get(), colB.get(), outPush);
+    }
+
+    outPush = INIT_VEC3;
+    return false;
+}
+//=============================================================================
+// 積分の計測処理（10万個の剛体の速度・位置の積分を、剛体プールと以前の1つずつヒープに置く形で比べる）
+//=============================================================================
+IntegrateBenchResult PhysicsBench::MeasureIntegrate(void)
+{
+    IntegrateBenchResult result;
+    result.numBodies = INTEGRATE_BENCH_BODIES;
+    result.legacyBodySize = (int)sizeof(LegacyRigidBody);
+    result.poolBodySize = (int)sizeof(RigidBody);
+
+    std::mt19937 rng(INTEGRATE_BENCH_SEED);
+    std::uniform_real_distribution<float> speedDist(-INTEGRATE_BENCH_SPEED, INTEGRATE_BENCH_SPEED);
+    std::uniform_real_distribution<float> spinDist(-1.0f, 1.0f);
+
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+    const D3DXVECTOR3 size(PILE_BOX_SIZE, PILE_BOX_SIZE, PILE_BOX_SIZE);
+    const D3DXVECTOR3 gravity(0.0f, EDITOR_GRAVITY, 0.0f);
+    const int width = (int)ceilf(cbrtf((float)INTEGRATE_BENCH_BODIES));
+
+    // 同じ初期状態の剛体を両方の形で作る（以前の形は作った順に剛体とコライダーが交互にヒープへ並ぶ）
+    RigidBodyPool pool;
+    pool.Reserve(INTEGRATE_BENCH_BODIES);
+
+    std::vector<RigidBody*> poolBodies;
+    std::vector<std::unique_ptr<LegacyRigidBody>> legacyBodies;
+
+    for (int nCnt = 0; nCnt < INTEGRATE_BENCH_BODIES; nCnt++)
+    {
+        D3DXVECTOR3 pos((nCnt % width) * PILE_SPACING, (nCnt / (width * width)) * PILE_SPACING, ((nCnt / width) % width) * PILE_SPACING);
+        D3DXVECTOR3 vel(speedDist(rng), speedDist(rng), speedDist(rng));
+        D3DXVECTOR3 angVel(spinDist(rng), spinDist(rng), spinDist(rng));
+
+        auto poolCol = std::make_shared<BoxCollider>(size);
+        RigidBody* body = pool.Get(pool.Create(poolCol, 1.0f));
+        body->SetIsDynamic(true);
+        body->SetTransform(pos, identity, unitScale);
+        body->SetVelocity(vel);
+        body->SetAngularVelocity(angVel);
+        poolBodies.push_back(body);
+
+        auto legacy = std::make_unique<LegacyRigidBody>();
+        legacy->m_Collider = std::make_shared<BoxCollider>(size);
+        legacy->m_Position = pos;
+        legacy->m_Velocity = vel;
+        legacy->m_Scale = unitScale;
+        legacy->m_AccumulatedForce = INIT_VEC3;
+        legacy->m_AccumulatedTorque = INIT_VEC3;
+        legacy->m_AngularFactor = unitScale;
+        legacy->m_Inertia = body->GetInertia();
+        legacy->m_InertiaInv = D3DXVECTOR3(1.0f / legacy->m_Inertia.x, 1.0f / legacy->m_Inertia.y, 1.0f / legacy->m_Inertia.z);
+        legacy->m_Rotation = INIT_VEC3;
+        legacy->m_LinearFactor = unitScale;
+        legacy->m_AngularVelocity = angVel;
+        legacy->m_PushVelocity = INIT_VEC3;
+        legacy->m_TurnVelocity = INIT_VEC3;
+        legacy->m_Orientation = identity;
+        legacy->m_Friction = body->GetFriction();
+        legacy->m_RollingFriction = body->GetRollingFriction();
+        legacy->m_Restitution = body->GetRestitution();
+        legacy->m_Mass = 1.0f;
+        legacy->m_ProxyId = -1;
+        legacy->m_IslandIndex = -1;
+        legacy->m_SleepCounter = 0;
+        legacy->m_isDynamic = true;
+        legacy->m_onGround = false;
+        legacy->m_isMoved = true;
+        legacy->m_isSleeping = false;
+        legacyBodies.push_back(std::move(legacy));
+    }
+
+    // 繰り返して一番速かった回の時間を返す
+    auto measureBest = [&](auto integrate)
+    {
+        float bestTime = FLT_MAX;
+
+        for (int nCnt = 0; nCnt < INTEGRATE_BENCH_REPEAT; nCnt++)
+        {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            integrate();
+            bestTime = std::min(bestTime, std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count());
+        }
+
+        return bestTime;
+    };
+
+    result.poolTime = measureBest([&]()
+    {
+        pool.IntegrateVelocity(TIME_STEP, gravity);
+        pool.IntegratePosition(TIME_STEP);
+    });
+
+    auto integrateLegacy = [&]()
+    {
+        for (auto& body : legacyBodies)
+        {
+            body->IntegrateVelocity(TIME_STEP, gravity);
+        }
+
+        for (auto& body : legacyBodies)
+        {
+            body->IntegratePosition(TIME_STEP);
+        }
+    };
+
+    result.legacyOrderedTime = measureBest(integrateLegacy);
+
+    // 編集で作っては消すうちにヒープ上で散らばった並びを、回す順を混ぜて作る
+    std::vector<std::unique_ptr<LegacyRigidBody>> orderedBodies(legacyBodies.size());
+    std::vector<int> order(legacyBodies.size());
+
+    for (size_t nCnt = 0; nCnt < order.size(); nCnt++)
+    {
+        order[nCnt] = (int)nCnt;
+    }
+
+    std::shuffle(order.begin(), order.end(), rng);
+
+    for (size_t nCnt = 0; nCnt < order.size(); nCnt++)
+    {
+        orderedBodies[order[nCnt]] = std::move(legacyBodies[nCnt]);
+    }
+
+    legacyBodies.swap(orderedBodies);
+
+    result.legacyScatteredTime = measureBest(integrateLegacy);
+
+    // 同じ回数だけ積分したので、同じ初期状態から同じ位置にいるはず（四元数の丸めの順だけ違う）
+    for (int nCnt = 0; nCnt < INTEGRATE_BENCH_REPEAT; nCnt++)
+    {
+        pool.IntegrateVelocity(TIME_STEP, gravity);
+        pool.IntegratePosition(TIME_STEP);
+    }
+
+    for (size_t nCnt = 0; nCnt < order.size(); nCnt++)
+    {
+        D3DXVECTOR3 diff = poolBodies[nCnt]->GetPosition() - legacyBodies[order[nCnt]]->m_Position;
+
+        if (D3DXVec3Length(&diff) > INTEGRATE_BENCH_TOLERANCE)
+        {
+            result.numMismatch++;
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// すり抜けの検証処理（厚さ1の床に球・カプセル・箱を速さを上げながら撃ち込む）
+//=============================================================================
+TunnellingTestResult PhysicsBench::MeasureTunnelling(void)
+{
+    TunnellingTestResult result;
+
+    const float floorBottom = -TUNNEL_FLOOR_THICKNESS * HALF;
+    const float floorHalfWidth = TUNNEL_FLOOR_WIDTH * HALF;
+
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    // 1発撃って床の下まで抜けたかを返す
+    auto shoot = [&](bool isContinuous, Collider::TYPE type, float speed, float angle, int& outSpeculative)
+    {
+        PhysicsWorld world;
+        world.SetContinuousCollision(isContinuous);
+
+        auto floorCol = std::make_shared<BoxCollider>(D3DXVECTOR3(TUNNEL_FLOOR_WIDTH, TUNNEL_FLOOR_THICKNESS, TUNNEL_FLOOR_WIDTH));
+        RigidBody* floor = world.GetRigidBody(world.CreateRigidBody(floorCol, 0.0f, false));
+        floor->SetTransform(INIT_VEC3, identity, D3DXVECTOR3(1.0f, 1.0f, 1.0f));
+
+        std::shared_ptr<Collider> col;
+        D3DXVECTOR3 size(TUNNEL_PROJECTILE_SIZE, TUNNEL_PROJECTILE_SIZE, TUNNEL_PROJECTILE_SIZE);
+
+        switch (type)
+        {
+        case Collider::SPHERE:
+            col = std::make_shared<SphereCollider>(size);
+            break;
+        case Collider::CAPSULE:
+            col = std::make_shared<CapsuleCollider>(TUNNEL_PROJECTILE_SIZE * HALF, TUNNEL_PROJECTILE_SIZE);
+            break;
+        default:
+            col = std::make_shared<BoxCollider>(size);
+            break;
+        }
+
+        // 床の中心に向けて斜め上から撃つ
+        D3DXVECTOR3 dir(sinf(angle), -cosf(angle), 0.0f);
+        D3DXVECTOR3 start = -dir * TUNNEL_START_DISTANCE;
+
+        RigidBody* body = world.GetRigidBody(world.CreateRigidBody(col, 1.0f, true));
+        body->SetTransform(start, identity, D3DXVECTOR3(1.0f, 1.0f, 1.0f));
+        body->SetVelocity(dir * speed);
+
+        bool isTunnelled = false;
+
+        for (int nCnt = 0; nCnt < TUNNEL_STEPS && !isTunnelled; nCnt++)
+        {
+            world.StepSimulation(TIME_STEP);
+            outSpeculative += world.GetSpeculativeContactCount();
+
+            const D3DXVECTOR3& pos = body->GetPosition();
+            isTunnelled = pos.y < floorBottom && fabsf(pos.x) < floorHalfWidth && fabsf(pos.z) < floorHalfWidth;
+        }
+
+        return isTunnelled;
+    };
+
+    const Collider::TYPE types[] = { Collider::SPHERE, Collider::CAPSULE, Collider::BOX };
+    const float angles[] = { 0.0f, D3DX_PI * 0.25f };
+
+    for (Collider::TYPE type : types)
+    {
+        float speed = TUNNEL_MIN_SPEED;
+
+        for (int nSpeed = 0; nSpeed < TUNNEL_NUM_SPEEDS; nSpeed++, speed *= 2.0f)
+        {
+            for (float angle : angles)
+            {
+                int unused = 0;
+
+                result.numTunnelled += shoot(true, type, speed, angle, result.numSpeculative) ? 1 : 0;
+                result.numTunnelledDiscrete += shoot(false, type, speed, angle, unused) ? 1 : 0;
+                result.numShots++;
+            }
+
+            result.maxSpeed = std::max(result.maxSpeed, speed);
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// アイランド並列解決の計測処理（独立した塔を並べてスレッド数ごとに時間と結果を比べる）
+//=============================================================================
+IslandScalingResult PhysicsBench::MeasureIslandScaling(void)
+{
+    IslandScalingResult result;
+    result.numHardwareThreads = (int)std::thread::hardware_concurrency();
+
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+    const float floorWidth = std::max(SCALING_TOWERS_X, SCALING_TOWERS_Z) * SCALING_TOWER_SPACING * 2.0f;
+
+    std::vector<D3DXVECTOR3> reference;
+    result.isDeterministic = true;
+
+    for (int nThread = 0; nThread < IslandScalingResult::NUM_THREAD_COUNTS; nThread++)
+    {
+        PhysicsWorld world;
+        world.SetThreadCount(result.threadCounts[nThread]);
+
+        auto floorCol = std::make_shared<BoxCollider>(D3DXVECTOR3(floorWidth, SCALING_BOX_SIZE, floorWidth));
+        RigidBody* floor = world.GetRigidBody(world.CreateRigidBody(floorCol, 0.0f, false));
+        floor->SetTransform(D3DXVECTOR3(0.0f, -SCALING_BOX_SIZE * HALF, 0.0f), identity, unitScale);
+
+        // 塔同士は離してあるので1本が1つのアイランドになる
+        std::vector<RigidBody*> bodies;
+
+        for (int nX = 0; nX < SCALING_TOWERS_X; nX++)
+        {
+            for (int nZ = 0; nZ < SCALING_TOWERS_Z; nZ++)
+            {
+                D3DXVECTOR3 base(
+                    (nX - SCALING_TOWERS_X * HALF) * SCALING_TOWER_SPACING, 0.0f,
+                    (nZ - SCALING_TOWERS_Z * HALF) * SCALING_TOWER_SPACING);
+
+                for (int nY = 0; nY < SCALING_TOWER_HEIGHT; nY++)
+                {
+                    auto col = std::make_shared<BoxCollider>(D3DXVECTOR3(SCALING_BOX_SIZE, SCALING_BOX_SIZE, SCALING_BOX_SIZE));
+                    RigidBody* body = world.GetRigidBody(world.CreateRigidBody(col, 1.0f, true));
+
+                    D3DXVECTOR3 pos = base;
+                    pos.y = SCALING_BOX_SIZE * (nY + HALF) + nY * PhysicsWorld::TOI_TOLERANCE;
+
+                    body->SetTransform(pos, identity, unitScale);
+                    bodies.push_back(body);
+                }
+            }
+        }
+
+        for (int nCnt = 0; nCnt < SCALING_WARMUP_STEPS; nCnt++)
+        {
+            world.StepSimulation(TIME_STEP);
+        }
+
+        float stepTime = 0.0f;
+        float solveTime = 0.0f;
+
+        for (int nCnt = 0; nCnt < SCALING_STEPS; nCnt++)
+        {
+            world.StepSimulation(TIME_STEP);
+            stepTime += world.GetStepTime();
+            solveTime += world.GetSolveTime();
+        }
+
+        result.stepTime[nThread] = stepTime / SCALING_STEPS;
+        result.solveTime[nThread] = solveTime / SCALING_STEPS;
+        result.numIslands = world.GetIslandCount();
+
+        // 1スレッドの結果とビット単位で比べる
+        if (nThread == 0)
+        {
+            for (RigidBody* body : bodies)
+            {
+                reference.push_back(body->GetPosition());
+            }
+        }
+        else
+        {
+            for (size_t nCnt = 0; nCnt < bodies.size(); nCnt++)
+            {
+                if (memcmp(&reference[nCnt], &bodies[nCnt]->GetPosition(), sizeof(D3DXVECTOR3)) != 0)
+                {
+                    result.isDeterministic = false;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// ナローフェーズ並列化の計測処理（1万個の球を穴に落としてスレッド数ごとに時間と結果を比べる）
+//=============================================================================
+NarrowphaseScalingResult PhysicsBench::MeasureNarrowphaseScaling(void)
+{
+    NarrowphaseScalingResult result;
+    result.numHardwareThreads = (int)std::thread::hardware_concurrency();
+
+    std::vector<D3DXVECTOR3> reference;
+    result.isDeterministic = true;
+
+    for (int nThread = 0; nThread < NarrowphaseScalingResult::NUM_THREAD_COUNTS; nThread++)
+    {
+        PhysicsWorld world;
+        world.SetThreadCount(result.threadCounts[nThread]);
+
+        std::vector<RigidBody*> bodies;
+        CreatePitStage(world, bodies);
+
+        for (int nCnt = 0; nCnt < PIT_WARMUP_STEPS; nCnt++)
+        {
+            world.StepSimulation(TIME_STEP);
+        }
+
+        float integrateTime = 0.0f;
+        float broadphaseTime = 0.0f;
+        float narrowphaseTime = 0.0f;
+        float solveTime = 0.0f;
+        float sleepTime = 0.0f;
+        float stepTime = 0.0f;
+
+        for (int nCnt = 0; nCnt < PIT_STEPS; nCnt++)
+        {
+            world.StepSimulation(TIME_STEP);
+            integrateTime += world.GetIntegrateTime();
+            broadphaseTime += world.GetBroadphaseTime();
+            narrowphaseTime += world.GetNarrowphaseTime();
+            solveTime += world.GetSolveTime();
+            sleepTime += world.GetSleepTime();
+            stepTime += world.GetStepTime();
+        }
+
+        result.integrateTime[nThread] = integrateTime / PIT_STEPS;
+        result.broadphaseTime[nThread] = broadphaseTime / PIT_STEPS;
+        result.narrowphaseTime[nThread] = narrowphaseTime / PIT_STEPS;
+        result.solveTime[nThread] = solveTime / PIT_STEPS;
+        result.sleepTime[nThread] = sleepTime / PIT_STEPS;
+        result.stepTime[nThread] = stepTime / PIT_STEPS;
+        result.numBodies = (int)bodies.size();
+        result.numPairs = world.GetPairCount();
+        result.numContacts = world.GetContactCount();
+
+        // 1スレッドの結果とビット単位で比べる
+        if (nThread == 0)
+        {
+            for (RigidBody* body : bodies)
+            {
+                reference.push_back(body->GetPosition());
+            }
+        }
+        else
+        {
+            for (size_t nCnt = 0; nCnt < bodies.size(); nCnt++)
+            {
+                if (memcmp(&reference[nCnt], &bodies[nCnt]->GetPosition(), sizeof(D3DXVECTOR3)) != 0)
+                {
+                    result.isDeterministic = false;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// レイキャストの計測処理（1万個のブロックのステージに1万本のレイを飛ばし、総当たりと時間と結果を比べる）
+//=============================================================================
+RaycastBenchResult PhysicsBench::MeasureRaycast(void)
+{
+    RaycastBenchResult result;
+
+    // 結果を見比べられるように乱数の種は固定する
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> posDist(-RAYCAST_STAGE_WIDTH * HALF, RAYCAST_STAGE_WIDTH * HALF);
+    std::uniform_real_distribution<float> heightDist(0.0f, RAYCAST_STAGE_HEIGHT);
+    std::uniform_real_distribution<float> dirDist(-1.0f, 1.0f);
+
+    PhysicsWorld world;
+    std::vector<RigidBody*> bodies;
+    CreateRaycastStage(world, RAYCAST_DYNAMIC_BODIES, bodies);
+
+    std::vector<D3DXVECTOR3> origins(RAYCAST_RAYS);
+    std::vector<D3DXVECTOR3> dirs(RAYCAST_RAYS);
+
+    for (int nCnt = 0; nCnt < RAYCAST_RAYS; nCnt++)
+    {
+        origins[nCnt] = D3DXVECTOR3(posDist(rng), heightDist(rng), posDist(rng));
+
+        D3DXVECTOR3 dir(dirDist(rng), dirDist(rng), dirDist(rng));
+
+        if (D3DXVec3LengthSq(&dir) < PhysicsWorld::MIN_DISTANCE)
+        {
+            dir = D3DXVECTOR3(0.0f, -1.0f, 0.0f);
+        }
+
+        D3DXVec3Normalize(&dirs[nCnt], &dir);
+    }
+
+    std::vector<QueryHit> treeHits(RAYCAST_RAYS);
+    std::vector<bool> isTreeHit(RAYCAST_RAYS);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < RAYCAST_RAYS; nCnt++)
+    {
+        isTreeHit[nCnt] = world.RayCast(origins[nCnt], dirs[nCnt], RAYCAST_MAX_DISTANCE, treeHits[nCnt]);
+    }
+
+    auto treeTime = std::chrono::high_resolution_clock::now();
+
+    // 総当たり（これまでのブロック選択と同じく全部の剛体を1つずつ調べる）
+    std::vector<QueryHit> bruteHits(RAYCAST_RAYS);
+    std::vector<bool> isBruteHit(RAYCAST_RAYS);
+
+    for (int nCnt = 0; nCnt < RAYCAST_RAYS; nCnt++)
+    {
+        float best = RAYCAST_MAX_DISTANCE;
+        bool isHit = false;
+
+        for (RigidBody* body : bodies)
+        {
+            QueryHit hit;
+
+            if (world.CastCoreAgainstBody(origins[nCnt], origins[nCnt], 0.0f, dirs[nCnt], best, body, hit) &&
+                (!isHit || hit.distance < best))
+            {
+                best = hit.distance;
+                bruteHits[nCnt] = hit;
+                isHit = true;
+            }
+        }
+
+        isBruteHit[nCnt] = isHit;
+    }
+
+    auto bruteTime = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < RAYCAST_RAYS; nCnt++)
+    {
+        if (isTreeHit[nCnt])
+        {
+            result.numHits++;
+        }
+
+        // 同じ距離で別の剛体に当たったものは食い違いにしない
+        bool isSame = (isTreeHit[nCnt] == isBruteHit[nCnt]) &&
+            (!isTreeHit[nCnt] || fabsf(treeHits[nCnt].distance - bruteHits[nCnt].distance) <= PhysicsWorld::TOI_TOLERANCE);
+
+        if (!isSame)
+        {
+            result.numMismatch++;
+        }
+    }
+
+    result.numBodies = (int)bodies.size();
+    result.numRays = RAYCAST_RAYS;
+    result.treeTime = std::chrono::duration<float, std::micro>(treeTime - startTime).count() / RAYCAST_RAYS;
+    result.bruteForceTime = std::chrono::duration<float, std::micro>(bruteTime - treeTime).count() / RAYCAST_RAYS;
+
+    return result;
+}
+//=============================================================================
+// まとめたレイの計測処理（向きの近い8本ずつのレイを1本ずつのRayCastと比べる）
+//=============================================================================
+RayPacketBenchResult PhysicsBench::MeasureRayPacket(void)
+{
+    RayPacketBenchResult result;
+    result.laneWidth = StaticBVH::GetPacketLaneWidth();
+
+    // 静的なステージだけにする（動的剛体はどちらも1本ずつ調べるので差が見えなくなる）
+    PhysicsWorld world;
+    std::vector<RigidBody*> bodies;
+    CreateRaycastStage(world, 0, bodies);
+
+    // 結果を見比べられるように乱数の種は固定する
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> posDist(-RAYCAST_STAGE_WIDTH * HALF, RAYCAST_STAGE_WIDTH * HALF);
+    std::uniform_real_distribution<float> heightDist(0.0f, RAYCAST_STAGE_HEIGHT);
+    std::uniform_real_distribution<float> dirDist(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> spreadDist(-PACKET_SPREAD, PACKET_SPREAD);
+
+    // 同じ始点から少しずつ向きをずらしたレイを並べる（AOの半球やカメラの1区画のようなまとまり）
+    std::vector<D3DXVECTOR3> origins(PACKET_RAYS);
+    std::vector<D3DXVECTOR3> dirs(PACKET_RAYS);
+
+    for (int first = 0; first < PACKET_RAYS; first += RayPacket::MAX_RAYS)
+    {
+        D3DXVECTOR3 origin(posDist(rng), heightDist(rng), posDist(rng));
+        D3DXVECTOR3 baseDir(dirDist(rng), dirDist(rng), dirDist(rng));
+
+        if (D3DXVec3LengthSq(&baseDir) < PhysicsWorld::MIN_DISTANCE)
+        {
+            baseDir = D3DXVECTOR3(0.0f, -1.0f, 0.0f);
+        }
+
+        D3DXVec3Normalize(&baseDir, &baseDir);
+
+        for (int lane = 0; lane < RayPacket::MAX_RAYS && first + lane < PACKET_RAYS; lane++)
+        {
+            D3DXVECTOR3 dir = baseDir + D3DXVECTOR3(spreadDist(rng), spreadDist(rng), spreadDist(rng));
+            origins[first + lane] = origin;
+            D3DXVec3Normalize(&dirs[first + lane], &dir);
+        }
+    }
+
+    std::vector<RigidBody*> scalarBodies(PACKET_RAYS);
+    std::vector<float> scalarDistances(PACKET_RAYS);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < PACKET_RAYS; nCnt++)
+    {
+        QueryHit hit;
+        bool isHit = world.RayCast(origins[nCnt], dirs[nCnt], RAYCAST_MAX_DISTANCE, hit);
+        scalarBodies[nCnt] = isHit ? hit.body : nullptr;
+        scalarDistances[nCnt] = isHit ? hit.distance : RAYCAST_MAX_DISTANCE;
+    }
+
+    auto scalarTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<RigidBody*> packetBodies(PACKET_RAYS);
+    std::vector<float> packetDistances(PACKET_RAYS);
+
+    result.numHits = world.RayCastPacket(origins.data(), dirs.data(), PACKET_RAYS, RAYCAST_MAX_DISTANCE,
+        packetBodies.data(), packetDistances.data());
+
+    auto packetTime = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < PACKET_RAYS; nCnt++)
+    {
+        // 同じ距離で別の剛体に当たったものは食い違いにしない
+        bool isSame = (scalarBodies[nCnt] != nullptr) == (packetBodies[nCnt] != nullptr) &&
+            fabsf(scalarDistances[nCnt] - packetDistances[nCnt]) <= PhysicsWorld::TOI_TOLERANCE;
+
+        if (!isSame)
+        {
+            result.numMismatch++;
+        }
+    }
+
+    float scalarSeconds = std::chrono::duration<float>(scalarTime - startTime).count();
+    float packetSeconds = std::chrono::duration<float>(packetTime - scalarTime).count();
+
+    result.numBodies = (int)bodies.size();
+    result.numRays = PACKET_RAYS;
+    result.scalarRate = scalarSeconds > 0.0f ? PACKET_RAYS / scalarSeconds / 1e6f : 0.0f;
+    result.packetRate = packetSeconds > 0.0f ? PACKET_RAYS / packetSeconds / 1e6f : 0.0f;
+
+    return result;
+}
+//=============================================================================
+// スナップショットの計測処理（球の穴を途中で保存し、回す→戻す→回し直すで結果がビット単位で同じか調べる）
+//=============================================================================
+SnapshotBenchResult PhysicsBench::MeasureSnapshot(void)
+{
+    SnapshotBenchResult result;
+
+    PhysicsWorld world;
+    world.SetDeterministic(true);
+
+    std::vector<RigidBody*> bodies;
+    CreatePitStage(world, bodies);
+
+    for (int nCnt = 0; nCnt < PIT_WARMUP_STEPS; nCnt++)
+    {
+        world.Update(world.GetFixedTimeStep());
+    }
+
+    // 球が崩れている途中で保存する（保存の時間は同じバッファで繰り返して平均を取る）
+    std::vector<unsigned char> snapshot;
+    auto saveStart = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < SNAPSHOT_REPEAT; nCnt++)
+    {
+        world.SaveSnapshot(snapshot);
+    }
+
+    result.saveTime = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - saveStart).count() / SNAPSHOT_REPEAT;
+    result.numBodies = world.GetBodyCount();
+    result.numManifolds = world.m_ContactCache.GetManifoldCount();
+    result.numBytes = (int)snapshot.size();
+
+    for (int nCnt = 0; nCnt < SNAPSHOT_STEPS; nCnt++)
+    {
+        world.Update(world.GetFixedTimeStep());
+    }
+
+    std::vector<unsigned char> firstRun;
+    world.SaveSnapshot(firstRun);
+
+    // 回したあとの状態から戻す時間を測る（毎回回したあとの状態に置き直し、全部の剛体と接触キャッシュを書き換える復元だけを測る）
+    bool isRestored = true;
+    float restoreTime = 0.0f;
+
+    for (int nCnt = 0; nCnt < SNAPSHOT_REPEAT; nCnt++)
+    {
+        isRestored = world.RestoreSnapshot(firstRun) && isRestored;
+
+        auto restoreStart = std::chrono::high_resolution_clock::now();
+        isRestored = world.RestoreSnapshot(snapshot) && isRestored;
+        restoreTime += std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - restoreStart).count();
+    }
+
+    result.restoreTime = restoreTime / SNAPSHOT_REPEAT;
+
+    // 戻した直後に保存し直しても同じバイト列になるか（コライダーと接触キャッシュは使うまで戻したままの形で持っている）
+    std::vector<unsigned char> resaved;
+    world.SaveSnapshot(resaved);
+    isRestored = isRestored && resaved == snapshot;
+
+    // 戻した状態から同じだけ回し直す
+    for (int nCnt = 0; nCnt < SNAPSHOT_STEPS; nCnt++)
+    {
+        world.Update(world.GetFixedTimeStep());
+    }
+
+    std::vector<unsigned char> secondRun;
+    world.SaveSnapshot(secondRun);
+
+    result.isRestoreMatch = isRestored && firstRun == secondRun;
+
+    // 同じ手順で作り直したワールドを1スレッドで回しても同じバイト列になるか
+    PhysicsWorld rebuilt;
+    rebuilt.SetDeterministic(true);
+    rebuilt.SetThreadCount(1);
+
+    std::vector<RigidBody*> rebuiltBodies;
+    CreatePitStage(rebuilt, rebuiltBodies);
+
+    for (int nCnt = 0; nCnt < PIT_WARMUP_STEPS + SNAPSHOT_STEPS; nCnt++)
+    {
+        rebuilt.Update(rebuilt.GetFixedTimeStep());
+    }
+
+    std::vector<unsigned char> rebuiltRun;
+    rebuilt.SaveSnapshot(rebuiltRun);
+
+    result.isRebuildMatch = firstRun == rebuiltRun;
+
+    return result;
+}
+//=============================================================================
+// 箱の塔の検証処理（10段の塔を3通りに積み、全部の箱が眠るまでのステップ数を数える）
+//=============================================================================
+BoxStackTestResult PhysicsBench::MeasureBoxStack(void)
+{
+    BoxStackTestResult result;
+    result.maxSteps = TOWER_MAX_STEPS;
+    result.isAllAtRest = true;
+
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+    const float floorWidth = STACK_BOX_SIZE * TOWER_HEIGHT * 2.0f;
+
+    for (int nTower = 0; nTower < BoxStackTestResult::NUM_TOWERS; nTower++)
+    {
+        PhysicsWorld world;
+
+        auto floorCol = std::make_shared<BoxCollider>(D3DXVECTOR3(floorWidth, STACK_BOX_SIZE, floorWidth));
+        RigidBody* floor = world.GetRigidBody(world.CreateRigidBody(floorCol, 0.0f, false));
+        floor->SetTransform(D3DXVECTOR3(0.0f, -STACK_BOX_SIZE * HALF, 0.0f), identity, unitScale);
+
+        RigidBody* top = nullptr;
+
+        for (int nY = 0; nY < TOWER_HEIGHT; nY++)
+        {
+            auto col = std::make_shared<BoxCollider>(D3DXVECTOR3(STACK_BOX_SIZE, STACK_BOX_SIZE, STACK_BOX_SIZE));
+            top = world.GetRigidBody(world.CreateRigidBody(col, 1.0f, true));
+
+            D3DXVECTOR3 pos(0.0f, STACK_BOX_SIZE * (nY + HALF) + nY * TOWER_GAP, 0.0f);
+            float yaw = 0.0f;
+
+            if (nTower == 1)
+            {
+                // 段ごとに少しずつずらして回す（面が平行にならず、切り取りの点が8つになる）
+                pos.x = ((nY * 13) % 5 - 2) * TOWER_OFFSET;
+                pos.z = ((nY * 7) % 5 - 2) * TOWER_OFFSET;
+                yaw = D3DXToRadian(((nY * 37) % 7 - 3) * TOWER_YAW);
+            }
+            else if (nTower == 2)
+            {
+                // 1段おきに45度回す（頂点が相手の面の外に出るので辺の切り取りだけで支える）
+                yaw = (nY % 2) ? D3DX_PI * 0.25f : 0.0f;
+            }
+
+            D3DXQUATERNION rot;
+            D3DXQuaternionRotationYawPitchRoll(&rot, yaw, 0.0f, 0.0f);
+
+            top->SetTransform(pos, rot, unitScale);
+        }
+
+        D3DXVECTOR3 startPos = top->GetPosition();
+        int numPoints = 0;
+        int numManifolds = 0;
+        int numPasses = 0;
+        int numSteps = 0;
+
+        result.restStep[nTower] = -1;
+
+        while (numSteps < TOWER_MAX_STEPS)
+        {
+            world.StepSimulation(TIME_STEP);
+            numSteps++;
+            numPasses += world.GetVelocityPasses();
+
+            for (const ContactManifold* manifold : world.m_Manifolds)
+            {
+                numPoints += manifold->numPoints;
+                numManifolds++;
+            }
+
+            if (world.GetSleepingBodyCount() == TOWER_HEIGHT)
+            {
+                result.restStep[nTower] = numSteps;
+                break;
+            }
+        }
+
+        D3DXVECTOR3 drift = top->GetPosition() - startPos;
+        drift.y = 0.0f;
+
+        result.topDrift[nTower] = D3DXVec3Length(&drift);
+        result.avgPoints[nTower] = numManifolds > 0 ? (float)numPoints / numManifolds : 0.0f;
+        result.avgPasses[nTower] = (float)numPasses / numSteps;
+        result.isAllAtRest = result.isAllAtRest && result.restStep[nTower] >= 0;
+    }
+
+    return result;
+}
+//=============================================================================
+// 静的ステージの焼き込みの計測処理（5万個のブロックでBVHをほかのスレッドで組み、呼び出したスレッドで作ったBVHと比べる）
+//=============================================================================
+StaticBakeBenchResult PhysicsBench::MeasureStaticBake(void)
+{
+    StaticBakeBenchResult result;
+
+    // 同じステージになるように乱数の種は固定する
+    std::mt19937 rng(24680);
+    std::uniform_real_distribution<float> sizeDist(10.0f, 30.0f);
+    std::uniform_real_distribution<float> heightDist(0.0f, 40.0f);
+    std::uniform_real_distribution<float> angleDist(-D3DX_PI, D3DX_PI);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+
+    // エディターと同じく止めたワールドに置く
+    PhysicsWorld world;
+    world.SetGravity(INIT_VEC3);
+    world.SetPaused(true);
+
+    // 箱・球・円柱・カプセルを順に格子へ並べる
+    std::vector<RigidBodyDesc> descs(BAKE_GRID_X * BAKE_GRID_Z);
+
+    for (size_t nCnt = 0; nCnt < descs.size(); nCnt++)
+    {
+        D3DXVECTOR3 size(sizeDist(rng), sizeDist(rng), sizeDist(rng));
+
+        switch (nCnt % 4)
+        {
+        case 0:
+            descs[nCnt].collider = std::make_shared<BoxCollider>(size);
+            break;
+        case 1:
+            descs[nCnt].collider = std::make_shared<SphereCollider>(size);
+            break;
+        case 2:
+            descs[nCnt].collider = std::make_shared<CylinderCollider>(size, D3DXVECTOR3(0.0f, 1.0f, 0.0f));
+            break;
+        default:
+            descs[nCnt].collider = std::make_shared<CapsuleCollider>(size.x * HALF, size.y);
+            break;
+        }
+    }
+
+    std::vector<RigidBodyHandle> handles(descs.size());
+    world.CreateRigidBodies(descs.data(), (int)descs.size(), handles.data());
+
+    std::vector<RigidBody*> bodies(handles.size());
+
+    for (int nCnt = 0; nCnt < (int)handles.size(); nCnt++)
+    {
+        D3DXVECTOR3 pos(
+            (nCnt % BAKE_GRID_X - BAKE_GRID_X * HALF) * BAKE_BLOCK_SPACING,
+            heightDist(rng),
+            (nCnt / BAKE_GRID_X - BAKE_GRID_Z * HALF) * BAKE_BLOCK_SPACING);
+
+        D3DXQUATERNION rot;
+        D3DXQuaternionRotationYawPitchRoll(&rot, angleDist(rng), 0.0f, 0.0f);
+
+        bodies[nCnt] = world.GetRigidBody(handles[nCnt]);
+        bodies[nCnt]->SetTransform(pos, rot, unitScale);
+    }
+
+    result.numBodies = world.GetStaticBodyCount();
+
+    // これまでどおり呼び出したスレッドで全部作り直す
+    StaticBVH reference;
+    auto syncStart = std::chrono::high_resolution_clock::now();
+    reference.Build(world.m_StaticBodies);
+    result.syncBuildTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - syncStart).count();
+
+    // 焼き込み（呼び出したスレッドは写し取ったら戻り、組むのはほかのスレッド）
+    auto gatherStart = std::chrono::high_resolution_clock::now();
+    world.BakeStaticWorld();
+    result.gatherTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - gatherStart).count();
+
+    world.FinishStaticBake(true);
+    result.buildTime = world.GetStaticBakeTime();
+    result.numNodes = world.m_StaticTree.GetNodeCount();
+
+    // 同じ範囲を検索して、見つかる剛体とその並びがそろうか
+    std::uniform_real_distribution<float> queryDist(-BAKE_GRID_X * HALF * BAKE_BLOCK_SPACING, BAKE_GRID_X * HALF * BAKE_BLOCK_SPACING);
+    std::vector<RigidBody*> bakedHits;
+    std::vector<RigidBody*> referenceHits;
+    result.isMatch = true;
+
+    for (int nCnt = 0; nCnt < BAKE_QUERIES; nCnt++)
+    {
+        D3DXVECTOR3 center(queryDist(rng), heightDist(rng), queryDist(rng));
+        D3DXVECTOR3 extent(sizeDist(rng) * 4.0f, sizeDist(rng), sizeDist(rng) * 4.0f);
+        AABB box = { center - extent, center + extent };
+
+        bakedHits.clear();
+        referenceHits.clear();
+        world.m_StaticTree.Query(box, bakedHits);
+        reference.Query(box, referenceHits);
+
+        result.isMatch = result.isMatch && bakedHits == referenceHits;
+    }
+
+    // 1ステップごとの静的剛体の確認（焼き込んでいる間は全部を見て回らない）
+    auto bakedScanStart = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < BAKE_SCAN_STEPS; nCnt++)
+    {
+        world.RefreshStaticTree(true);
+    }
+
+    result.bakedScanTime = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - bakedScanStart).count() / BAKE_SCAN_STEPS;
+
+    world.UnbakeStaticWorld();
+
+    auto scanStart = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < BAKE_SCAN_STEPS; nCnt++)
+    {
+        world.RefreshStaticTree(true);
+    }
+
+    result.scanTime = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - scanStart).count() / BAKE_SCAN_STEPS;
+
+    // 再生中のブロックの更新で省いた、同じ位置の設定し直し
+    auto transformStart = std::chrono::high_resolution_clock::now();
+
+    for (RigidBody* body : bodies)
+    {
+        body->SetTransform(body->GetPosition(), body->GetOrientation(), unitScale);
+    }
+
+    result.transformTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - transformStart).count();
+
+    // 編集中に毎フレーム1個ずつ動かす（止めたワールドの更新で呼び出したスレッドが止まる時間）
+    float editTime = 0.0f;
+
+    for (int nCnt = 0; nCnt < BAKE_EDIT_FRAMES; nCnt++)
+    {
+        RigidBody* body = bodies[(nCnt * 7919) % bodies.size()];
+        body->SetTransform(body->GetPosition() + D3DXVECTOR3(0.0f, 1.0f, 0.0f), body->GetOrientation(), unitScale);
+
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        world.Update(TIME_STEP);
+        editTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count();
+    }
+
+    result.editFrameTime = editTime / BAKE_EDIT_FRAMES;
+
+    // 組んでいる途中のものは受け取ってから壊す
+    world.FinishStaticBake(true);
+
+    return result;
+}
+//=============================================================================
+// 三角形メッシュの計測処理（でこぼこの地形を組み立て・読み込み・レイ・落下で確かめる）
+//=============================================================================
+TriangleMeshBenchResult PhysicsBench::MeasureTriangleMesh(void)
+{
+    TriangleMeshBenchResult result;
+
+    // 谷と山が交互に並ぶ地形（格子点の高さ）
+    auto terrainHeight = [](float x, float z)
+    {
+        const float k = D3DX_PI * 2.0f / MESH_BUMP_PERIOD;
+        return MESH_BUMP_HEIGHT * sinf(x * k) * cosf(z * k);
+    };
+
+    std::vector<float> heights(MESH_GRID_SIZE * MESH_GRID_SIZE);
+    std::vector<D3DXVECTOR3> vertices(heights.size());
+
+    for (int nZ = 0; nZ < MESH_GRID_SIZE; nZ++)
+    {
+        for (int nX = 0; nX < MESH_GRID_SIZE; nX++)
+        {
+            float x = nX * MESH_CELL_SIZE;
+            float z = nZ * MESH_CELL_SIZE;
+            heights[nZ * MESH_GRID_SIZE + nX] = terrainHeight(x, z);
+            vertices[nZ * MESH_GRID_SIZE + nX] = D3DXVECTOR3(x, terrainHeight(x, z), z);
+        }
+    }
+
+    // 高さの格子と同じ並びの三角形（マスごとに(00, 01, 11)と(00, 11, 10)）
+    std::vector<unsigned int> indices;
+    indices.reserve((MESH_GRID_SIZE - 1) * (MESH_GRID_SIZE - 1) * 6);
+
+    for (int nZ = 0; nZ < MESH_GRID_SIZE - 1; nZ++)
+    {
+        for (int nX = 0; nX < MESH_GRID_SIZE - 1; nX++)
+        {
+            unsigned int v00 = nZ * MESH_GRID_SIZE + nX;
+            unsigned int v10 = v00 + 1;
+            unsigned int v01 = v00 + MESH_GRID_SIZE;
+            unsigned int v11 = v01 + 1;
+
+            unsigned int quad[6] = { v00, v01, v11, v00, v11, v10 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+
+    // 組み立て（初回の読み込み）と書き出したバイト列からの読み込み（2回目以降）
+    auto mesh = std::make_shared<TriangleMeshShape>();
+    auto cookStart = std::chrono::high_resolution_clock::now();
+    mesh->Cook(vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size() / 3);
+    result.cookTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - cookStart).count();
+
+    result.numTriangles = mesh->GetTriangleCount();
+    result.numNodes = mesh->GetNodeCount();
+
+    std::vector<unsigned char> data;
+    mesh->Write(data);
+    result.numBytes = (int)data.size();
+
+    SnapshotReader reader(data);
+    auto loadStart = std::chrono::high_resolution_clock::now();
+    std::shared_ptr<TriangleShape> loaded = TriangleShape::Read(reader);
+    result.loadTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+
+    result.isRoundTripMatch = loaded && loaded->GetTriangleCount() == mesh->GetTriangleCount();
+
+    for (int nCnt = 0; result.isRoundTripMatch && nCnt < mesh->GetTriangleCount(); nCnt++)
+    {
+        D3DXVECTOR3 a[PhysicsWorld::AXIS], b[PhysicsWorld::AXIS];
+        int idsA[PhysicsWorld::AXIS], idsB[PhysicsWorld::AXIS];
+        mesh->GetTriangle(nCnt, a, idsA);
+        loaded->GetTriangle(nCnt, b, idsB);
+
+        result.isRoundTripMatch = memcmp(a, b, sizeof(a)) == 0 && memcmp(idsA, idsB, sizeof(idsA)) == 0;
+    }
+
+    // 最後のノード（必ず葉）の三角形数はバイト列の末尾にあるので、三角形の外まで伸ばして読めないことを確かめる
+    std::vector<unsigned char> corrupt = data;
+    int badCount = mesh->GetTriangleCount() + 1;
+    memcpy(corrupt.data() + corrupt.size() - sizeof(int), &badCount, sizeof(int));
+
+    SnapshotReader corruptReader(corrupt);
+    result.isCorruptRejected = TriangleShape::Read(corruptReader) == nullptr;
+
+    // 同じ地形の高さの格子、メッシュを見下ろして作る高さの格子
+    auto heightfield = std::make_shared<HeightfieldShape>();
+    heightfield->Cook(INIT_VEC3, MESH_CELL_SIZE, MESH_CELL_SIZE, MESH_GRID_SIZE, MESH_GRID_SIZE, heights.data());
+
+    auto sampleStart = std::chrono::high_resolution_clock::now();
+    HeightfieldShape sampled;
+    sampled.CookFromMesh(*mesh, MESH_GRID_SIZE - 1);
+    result.sampleTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - sampleStart).count();
+
+    // 斜め下へのレイ（BVH・総当たり・高さの格子で同じ距離になるか）
+    std::mt19937 rng(13579);
+    const float extent = (MESH_GRID_SIZE - 1) * MESH_CELL_SIZE;
+    std::uniform_real_distribution<float> posDist(0.0f, extent);
+    std::uniform_real_distribution<float> slantDist(-MESH_RAY_SLANT, MESH_RAY_SLANT);
+
+    std::vector<D3DXVECTOR3> origins(MESH_RAYS), dirs(MESH_RAYS);
+
+    for (int nCnt = 0; nCnt < MESH_RAYS; nCnt++)
+    {
+        origins[nCnt] = D3DXVECTOR3(posDist(rng), MESH_RAY_HEIGHT, posDist(rng));
+        dirs[nCnt] = D3DXVECTOR3(slantDist(rng), -1.0f, slantDist(rng));
+        D3DXVec3Normalize(&dirs[nCnt], &dirs[nCnt]);
+    }
+
+    const float maxDist = MESH_RAY_HEIGHT * 4.0f;
+    std::vector<float> meshDists(MESH_RAYS, -1.0f), bruteDists(MESH_RAYS, -1.0f), fieldDists(MESH_RAYS, -1.0f);
+
+    auto meshStart = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < MESH_RAYS; nCnt++)
+    {
+        int triangle = 0;
+        mesh->RayCast(origins[nCnt], dirs[nCnt], maxDist, meshDists[nCnt], triangle);
+    }
+
+    auto bruteStart = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < MESH_RAYS; nCnt++)
+    {
+        float best = maxDist;
+
+        for (int nTri = 0; nTri < mesh->GetTriangleCount(); nTri++)
+        {
+            D3DXVECTOR3 tri[PhysicsWorld::AXIS];
+            int ids[PhysicsWorld::AXIS];
+            float dist = 0.0f;
+            mesh->GetTriangle(nTri, tri, ids);
+
+            if (TriangleShape::IntersectTriangle(origins[nCnt], dirs[nCnt], tri[0], tri[1], tri[2], best, dist))
+            {
+                best = dist;
+                bruteDists[nCnt] = dist;
+            }
+        }
+    }
+
+    auto fieldStart = std::chrono::high_resolution_clock::now();
+
+    for (int nCnt = 0; nCnt < MESH_RAYS; nCnt++)
+    {
+        int triangle = 0;
+        heightfield->RayCast(origins[nCnt], dirs[nCnt], maxDist, fieldDists[nCnt], triangle);
+    }
+
+    auto fieldEnd = std::chrono::high_resolution_clock::now();
+
+    result.numRays = MESH_RAYS;
+    result.meshRayTime = std::chrono::duration<float, std::micro>(bruteStart - meshStart).count() / MESH_RAYS;
+    result.bruteRayTime = std::chrono::duration<float, std::micro>(fieldStart - bruteStart).count() / MESH_RAYS;
+    result.fieldRayTime = std::chrono::duration<float, std::micro>(fieldEnd - fieldStart).count() / MESH_RAYS;
+
+    result.isRayMatch = true;
+    result.isFieldRayMatch = true;
+
+    for (int nCnt = 0; nCnt < MESH_RAYS; nCnt++)
+    {
+        if ((meshDists[nCnt] < 0.0f) != (bruteDists[nCnt] < 0.0f) || fabsf(meshDists[nCnt] - bruteDists[nCnt]) > MESH_RAY_TOLERANCE)
+        {
+            result.isRayMatch = false;
+        }
+
+        if ((meshDists[nCnt] < 0.0f) != (fieldDists[nCnt] < 0.0f) || fabsf(meshDists[nCnt] - fieldDists[nCnt]) > MESH_RAY_TOLERANCE)
+        {
+            result.isFieldRayMatch = false;
+        }
+    }
+
+    // 谷に球・カプセル・箱を落として、沈まずに支えられるか（メッシュと高さの格子の両方）
+    // 転がりの抵抗はないので、谷の斜面に乗った球・カプセルは揺れ続けて眠らないことがある
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+    const std::shared_ptr<const TriangleShape> shapes[2] = { mesh, heightfield };
+
+    for (const auto& shape : shapes)
+    {
+        PhysicsWorld world;
+
+        RigidBody* ground = world.GetRigidBody(world.CreateRigidBody(std::make_shared<MeshCollider>(shape), 0.0f, false));
+        ground->SetTransform(INIT_VEC3, identity, unitScale);
+
+        std::vector<RigidBody*> bodies;
+
+        for (int nCnt = 0; nCnt < MESH_DROP_BODIES; nCnt++)
+        {
+            std::shared_ptr<Collider> col;
+            D3DXVECTOR3 size(MESH_SHAPE_SIZE, MESH_SHAPE_SIZE, MESH_SHAPE_SIZE);
+
+            switch (nCnt % 3)
+            {
+            case 0:
+                col = std::make_shared<SphereCollider>(size);
+                break;
+            case 1:
+                col = std::make_shared<CapsuleCollider>(MESH_SHAPE_SIZE * HALF, MESH_SHAPE_SIZE * 2.0f);
+                break;
+            default:
+                col = std::make_shared<BoxCollider>(size);
+                break;
+            }
+
+            // 谷（sin = -1, cos = 1）の真上から落とす
+            float x = (0.75f + nCnt % 3) * MESH_BUMP_PERIOD;
+            float z = (1 + nCnt / 3) * MESH_BUMP_PERIOD;
+
+            RigidBody* body = world.GetRigidBody(world.CreateRigidBody(col, 1.0f, true));
+            body->SetTransform(D3DXVECTOR3(x, terrainHeight(x, z) + MESH_DROP_HEIGHT, z), identity, unitScale);
+            bodies.push_back(body);
+        }
+
+        for (int nStep = 0; nStep < MESH_DROP_STEPS && world.GetSleepingBodyCount() < MESH_DROP_BODIES; nStep++)
+        {
+            world.StepSimulation(TIME_STEP);
+        }
+
+        for (RigidBody* body : bodies)
+        {
+            const D3DXVECTOR3& pos = body->GetPosition();
+            float bottom = body->GetColliderPtr()->GetAABB().min.y;
+
+            result.numDropped++;
+
+            // 一番下が真下の地面より沈んでいなければ支えられている（斜面では中心の真下より低く触れるので甘めに見る）
+            if (bottom > terrainHeight(pos.x, pos.z) - MESH_HOLD_TOLERANCE)
+            {
+                result.numHeld++;
+            }
+
+            if (body->IsSleeping())
+            {
+                result.numSleeping++;
+            }
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// 複合コライダーの計測処理（同じ机を複合コライダー1つと形状ごとの剛体5つで落として比べる）
+//=============================================================================
+CompoundBenchResult PhysicsBench::MeasureCompound(void)
+{
+    CompoundBenchResult result;
+
+    // 机の形（剛体の原点から見た天板・脚の位置、脚の下端が原点の11下）
+    const D3DXVECTOR3 topSize(40.0f, 4.0f, 40.0f);
+    const D3DXVECTOR3 legSize(4.0f, 18.0f, 4.0f);
+    const D3DXVECTOR3 topOffset(0.0f, 9.0f, 0.0f);
+    const float legInset = 16.0f;
+    const float legOffsetY = -2.0f;
+    const float topMass = 3.0f;
+    const float legMass = 0.5f;
+    const float restTopY = topOffset.y - (legOffsetY - legSize.y * HALF) + topSize.y * HALF;
+
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+
+    D3DXVECTOR3 legOffsets[4];
+
+    for (int nLeg = 0; nLeg < 4; nLeg++)
+    {
+        legOffsets[nLeg] = D3DXVECTOR3((nLeg & 1) ? legInset : -legInset, legOffsetY, (nLeg & 2) ? legInset : -legInset);
+    }
+
+    result.numTables = COMPOUND_GRID * COMPOUND_GRID;
+
+    for (int mode = 0; mode < 2; mode++)
+    {
+        bool isCompound = mode == 0;
+        PhysicsWorld world;
+
+        const float floorWidth = COMPOUND_GRID * COMPOUND_SPACING * 2.0f;
+        RigidBody* floor = world.GetRigidBody(world.CreateRigidBody(
+            std::make_shared<BoxCollider>(D3DXVECTOR3(floorWidth, STACK_BOX_SIZE, floorWidth)), 0.0f, false));
+        floor->SetTransform(D3DXVECTOR3(0.0f, -STACK_BOX_SIZE * HALF, 0.0f), identity, unitScale);
+
+        // 机ごとの剛体（分けた場合は先頭が天板）
+        std::vector<std::vector<RigidBody*>> tables(result.numTables);
+
+        for (int nCnt = 0; nCnt < result.numTables; nCnt++)
+        {
+            D3DXVECTOR3 base((nCnt % COMPOUND_GRID - COMPOUND_GRID * HALF) * COMPOUND_SPACING, COMPOUND_DROP_HEIGHT,
+                (nCnt / COMPOUND_GRID - COMPOUND_GRID * HALF) * COMPOUND_SPACING);
+
+            D3DXQUATERNION rot;
+            D3DXQuaternionRotationYawPitchRoll(&rot, (nCnt % COMPOUND_YAW_STEPS) * COMPOUND_YAW_STEP, 0.0f, 0.0f);
+
+            if (isCompound)
+            {
+                auto compound = std::make_shared<CompoundCollider>();
+                compound->AddChild(std::make_shared<BoxCollider>(topSize), topOffset, identity);
+
+                for (const D3DXVECTOR3& offset : legOffsets)
+                {
+                    compound->AddChild(std::make_shared<BoxCollider>(legSize), offset, identity);
+                }
+
+                RigidBody* body = world.GetRigidBody(world.CreateRigidBody(compound, topMass + legMass * 4.0f, true));
+                body->SetTransform(base, rot, unitScale);
+                tables[nCnt].push_back(body);
+            }
+            else
+            {
+                D3DXMATRIX matRot;
+                D3DXMatrixRotationQuaternion(&matRot, &rot);
+
+                auto put = [&](const D3DXVECTOR3& size, const D3DXVECTOR3& offset, float mass)
+                {
+                    D3DXVECTOR3 worldOffset;
+                    D3DXVec3TransformNormal(&worldOffset, &offset, &matRot);
+
+                    RigidBody* body = world.GetRigidBody(world.CreateRigidBody(std::make_shared<BoxCollider>(size), mass, true));
+                    body->SetTransform(base + worldOffset, rot, unitScale);
+                    tables[nCnt].push_back(body);
+                };
+
+                put(topSize, topOffset, topMass);
+
+                for (const D3DXVECTOR3& offset : legOffsets)
+                {
+                    put(legSize, offset, legMass);
+                }
+            }
+        }
+
+        // 同じステップ数で比べる（どちらも途中で眠った分は軽くなる）
+        float totalTime = 0.0f;
+        int maxPairs = 0;
+
+        for (int nStep = 0; nStep < COMPOUND_STEPS; nStep++)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            world.StepSimulation(TIME_STEP);
+            totalTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+            maxPairs = std::max(maxPairs, world.GetPairCount());
+        }
+
+        int numResting = 0;
+        int numSleeping = 0;
+
+        for (const auto& table : tables)
+        {
+            // 天板の上面が脚の高さにあり、上向きのままなら止まっている
+            RigidBody* top = table.front();
+            D3DXMATRIX matRot;
+            D3DXQUATERNION rot = top->GetOrientation();
+            D3DXMatrixRotationQuaternion(&matRot, &rot);
+
+            float topY = top->GetColliderPtr()->GetAABB().max.y;
+
+            if (fabsf(topY - restTopY) <= COMPOUND_REST_TOLERANCE && matRot._22 >= COMPOUND_UP_TOLERANCE)
+            {
+                numResting++;
+            }
+
+            bool isSleeping = true;
+
+            for (RigidBody* body : table)
+            {
+                isSleeping = isSleeping && body->IsSleeping();
+            }
+
+            if (isSleeping)
+            {
+                numSleeping++;
+            }
+        }
+
+        int numBodies = (int)world.m_DynamicBodies.size();
+        float stepTime = totalTime / COMPOUND_STEPS;
+
+        if (isCompound)
+        {
+            result.compoundBodies = numBodies;
+            result.compoundPairs = maxPairs;
+            result.compoundStepTime = stepTime;
+            result.compoundResting = numResting;
+            result.compoundSleeping = numSleeping;
+        }
+        else
+        {
+            result.separateBodies = numBodies;
+            result.separatePairs = maxPairs;
+            result.separateStepTime = stepTime;
+            result.separateResting = numResting;
+            result.separateSleeping = numSleeping;
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// GJK/EPAの計測処理（同じ形状の組を専用の判定関数とGJK/EPAで判定して時間と結果を比べ、凸包を床に落とす）
+//=============================================================================
+GjkBenchResult PhysicsBench::MeasureGjk(void)
+{
+    GjkBenchResult result;
+    result.numPairs = GJK_BENCH_PAIRS;
+
+    // 結果を見比べられるように乱数の種は固定する
+    std::mt19937 rng(97531);
+    std::uniform_real_distribution<float> posDist(-GJK_BENCH_RANGE * HALF, GJK_BENCH_RANGE * HALF);
+    std::uniform_real_distribution<float> sizeDist(5.0f, 20.0f);
+    std::uniform_real_distribution<float> angleDist(-D3DX_PI, D3DX_PI);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+
+    // 形状を作る関数（カプセル・シリンダーは判定関数と同じく縦向き固定）
+    auto makeShape = [&](Collider::TYPE type) -> std::shared_ptr<Collider>
+    {
+        switch (type)
+        {
+        case Collider::BOX:
+            return std::make_shared<BoxCollider>(D3DXVECTOR3(sizeDist(rng), sizeDist(rng), sizeDist(rng)));
+        case Collider::SPHERE:
+            return std::make_shared<SphereCollider>(D3DXVECTOR3(1.0f, 1.0f, 1.0f) * sizeDist(rng));
+        case Collider::CAPSULE:
+            return std::make_shared<CapsuleCollider>(sizeDist(rng) * 0.3f, sizeDist(rng));
+        default:
+        {
+            float diameter = sizeDist(rng);
+            return std::make_shared<CylinderCollider>(D3DXVECTOR3(diameter, sizeDist(rng), diameter), D3DXVECTOR3(0.0f, 1.0f, 0.0f));
+        }
+        }
+    };
+
+    auto place = [&](Collider* col)
+    {
+        D3DXQUATERNION rot;
+        D3DXQuaternionRotationYawPitchRoll(&rot, angleDist(rng), angleDist(rng), angleDist(rng));
+        col->UpdateTransform(D3DXVECTOR3(posDist(rng), posDist(rng), posDist(rng)), rot, unitScale);
+    };
+
+    PhysicsWorld world;
+    std::vector<D3DXVECTOR3> pushes(GJK_BENCH_PAIRS);
+    std::vector<D3DXVECTOR3> gjkPushes(GJK_BENCH_PAIRS);
+    std::vector<char> isHit(GJK_BENCH_PAIRS);
+    std::vector<char> isGjkHit(GJK_BENCH_PAIRS);
+
+    auto measurePair = [&](Collider::TYPE typeA, Collider::TYPE typeB, GjkPairBench& out)
+    {
+        std::vector<std::shared_ptr<Collider>> shapesA(GJK_BENCH_PAIRS), shapesB(GJK_BENCH_PAIRS);
+
+        for (int nCnt = 0; nCnt < GJK_BENCH_PAIRS; nCnt++)
+        {
+            shapesA[nCnt] = makeShape(typeA);
+            shapesB[nCnt] = makeShape(typeB);
+            place(shapesA[nCnt].get());
+            place(shapesB[nCnt].get());
+        }
+
+        PhysicsWorld::CollisionFunc specialised = world.m_CollisionTable[typeA][typeB];
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (int nRepeat = 0; nRepeat < GJK_BENCH_REPEAT; nRepeat++)
+        {
+            for (int nCnt = 0; nCnt < GJK_BENCH_PAIRS; nCnt++)
+            {
+                isHit[nCnt] = (world.*specialised)(shapesA[nCnt].get(), shapesB[nCnt].get(), pushes[nCnt]);
+            }
+        }
+
+        out.specialisedTime = std::chrono::duration<float, std::nano>(std::chrono::high_resolution_clock::now() - start).count() /
+            (GJK_BENCH_PAIRS * GJK_BENCH_REPEAT);
+
+        start = std::chrono::high_resolution_clock::now();
+
+        for (int nRepeat = 0; nRepeat < GJK_BENCH_REPEAT; nRepeat++)
+        {
+            for (int nCnt = 0; nCnt < GJK_BENCH_PAIRS; nCnt++)
+            {
+                isGjkHit[nCnt] = world.GjkCollision(shapesA[nCnt].get(), shapesB[nCnt].get(), gjkPushes[nCnt]);
+            }
+        }
+
+        out.gjkTime = std::chrono::duration<float, std::nano>(std::chrono::high_resolution_clock::now() - start).count() /
+            (GJK_BENCH_PAIRS * GJK_BENCH_REPEAT);
+
+        // 浅い当たりの有無は誤差で分かれるので、めり込み量が許容量を超えたものだけ食い違いにする
+        // 専用の判定関数は深く重なった組を簡単に押し出す（球の中心が箱の中なら上へ押すなど）ので、比べるのはGJK/EPAで浅い組だけ
+        for (int nCnt = 0; nCnt < GJK_BENCH_PAIRS; nCnt++)
+        {
+            float depth = isHit[nCnt] ? D3DXVec3Length(&pushes[nCnt]) : 0.0f;
+            float gjkDepth = isGjkHit[nCnt] ? D3DXVec3Length(&gjkPushes[nCnt]) : 0.0f;
+            float error = fabsf(depth - gjkDepth);
+
+            if (isHit[nCnt])
+            {
+                out.numHits++;
+            }
+
+            if (gjkDepth > GJK_BENCH_SHALLOW_DEPTH)
+            {
+                continue;
+            }
+
+            out.numShallow++;
+
+            if (isHit[nCnt] && isGjkHit[nCnt])
+            {
+                out.maxDepthError = std::max(out.maxDepthError, error);
+            }
+
+            if (error > GJK_BENCH_DEPTH_TOLERANCE)
+            {
+                out.numMismatches++;
+            }
+        }
+    };
+
+    measurePair(Collider::BOX, Collider::BOX, result.boxBox);
+    measurePair(Collider::SPHERE, Collider::BOX, result.sphereBox);
+    measurePair(Collider::SPHERE, Collider::SPHERE, result.sphereSphere);
+    measurePair(Collider::SPHERE, Collider::CAPSULE, result.sphereCapsule);
+    measurePair(Collider::SPHERE, Collider::CYLINDER, result.sphereCylinder);
+    measurePair(Collider::CAPSULE, Collider::BOX, result.capsuleBox);
+    measurePair(Collider::CAPSULE, Collider::CAPSULE, result.capsuleCapsule);
+
+    // 楕円体の表面の点から凸包を組み立てる
+    std::vector<D3DXVECTOR3> points(GJK_HULL_POINTS);
+    std::uniform_real_distribution<float> unitDist(-1.0f, 1.0f);
+
+    for (D3DXVECTOR3& point : points)
+    {
+        D3DXVECTOR3 dir(unitDist(rng), unitDist(rng), unitDist(rng));
+
+        if (D3DXVec3LengthSq(&dir) < PhysicsWorld::MIN_DISTANCE)
+        {
+            dir = D3DXVECTOR3(0.0f, 1.0f, 0.0f);
+        }
+
+        D3DXVec3Normalize(&dir, &dir);
+        point = D3DXVECTOR3(dir.x * 10.0f, dir.y * 6.0f, dir.z * 8.0f);
+    }
+
+    auto hull = std::make_shared<ConvexHullShape>();
+    auto cookStart = std::chrono::high_resolution_clock::now();
+    hull->Cook(points.data(), (int)points.size());
+    result.cookTime = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - cookStart).count();
+    result.hullVertices = hull->GetVertexCount();
+    result.hullTriangles = hull->GetTriangleCount();
+
+    // 凸包と箱は専用の判定関数がないのでGJK/EPAの時間だけ測る
+    {
+        std::vector<std::shared_ptr<Collider>> hulls(GJK_BENCH_PAIRS), boxes(GJK_BENCH_PAIRS);
+
+        for (int nCnt = 0; nCnt < GJK_BENCH_PAIRS; nCnt++)
+        {
+            hulls[nCnt] = std::make_shared<ConvexCollider>(hull);
+            boxes[nCnt] = makeShape(Collider::BOX);
+            place(hulls[nCnt].get());
+            place(boxes[nCnt].get());
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (int nRepeat = 0; nRepeat < GJK_BENCH_REPEAT; nRepeat++)
+        {
+            for (int nCnt = 0; nCnt < GJK_BENCH_PAIRS; nCnt++)
+            {
+                isGjkHit[nCnt] = world.GjkCollision(hulls[nCnt].get(), boxes[nCnt].get(), gjkPushes[nCnt]);
+            }
+        }
+
+        result.hullBoxTime = std::chrono::duration<float, std::nano>(std::chrono::high_resolution_clock::now() - start).count() /
+            (GJK_BENCH_PAIRS * GJK_BENCH_REPEAT);
+    }
+
+    // 凸包を向きを変えて床に落とす
+    PhysicsWorld dropWorld;
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    const float floorWidth = GJK_HULL_GRID * GJK_HULL_SPACING * 2.0f;
+    RigidBody* floor = dropWorld.GetRigidBody(dropWorld.CreateRigidBody(
+        std::make_shared<BoxCollider>(D3DXVECTOR3(floorWidth, STACK_BOX_SIZE, floorWidth)), 0.0f, false));
+    floor->SetTransform(D3DXVECTOR3(0.0f, -STACK_BOX_SIZE * HALF, 0.0f), identity, unitScale);
+
+    result.numHulls = GJK_HULL_GRID * GJK_HULL_GRID;
+    std::vector<RigidBody*> bodies;
+
+    for (int nCnt = 0; nCnt < result.numHulls; nCnt++)
+    {
+        D3DXVECTOR3 pos((nCnt % GJK_HULL_GRID - GJK_HULL_GRID * HALF) * GJK_HULL_SPACING, GJK_HULL_DROP_HEIGHT,
+            (nCnt / GJK_HULL_GRID - GJK_HULL_GRID * HALF) * GJK_HULL_SPACING);
+
+        D3DXQUATERNION rot;
+        D3DXQuaternionRotationYawPitchRoll(&rot, angleDist(rng), angleDist(rng), angleDist(rng));
+
+        RigidBody* body = dropWorld.GetRigidBody(dropWorld.CreateRigidBody(std::make_shared<ConvexCollider>(hull), 1.0f, true));
+        body->SetTransform(pos, rot, unitScale);
+        bodies.push_back(body);
+    }
+
+    float totalTime = 0.0f;
+
+    for (int nStep = 0; nStep < GJK_HULL_STEPS; nStep++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        dropWorld.StepSimulation(TIME_STEP);
+        totalTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    result.hullStepTime = totalTime / GJK_HULL_STEPS;
+
+    for (RigidBody* body : bodies)
+    {
+        // 下端が床の上面（高さ0）にあれば沈まずに支えられている
+        float bottom = body->GetColliderPtr()->GetAABB().min.y;
+
+        if (fabsf(bottom) <= GJK_HULL_REST_TOLERANCE)
+        {
+            result.numHullsHeld++;
+        }
+
+        if (body->IsSleeping())
+        {
+            result.numHullsSleeping++;
+        }
+    }
+
+    return result;
+}
+//=============================================================================
+// 床の作成処理（上面がy=0になる静的な箱）
+//=============================================================================
+void PhysicsBench::CreateFloor(PhysicsWorld& world, float width, float depth)
+{
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    RigidBody* floor = world.GetRigidBody(world.CreateRigidBody(
+        std::make_shared<BoxCollider>(D3DXVECTOR3(width, PILE_BOX_SIZE, depth)), 0.0f, false));
+    floor->SetTransform(D3DXVECTOR3(0.0f, -PILE_BOX_SIZE * HALF, 0.0f), identity, D3DXVECTOR3(1.0f, 1.0f, 1.0f));
+}
+//=============================================================================
+// 山の作成処理（箱と球を交互に立方体の格子へ積む。centerは山の底面の中心）
+//=============================================================================
+void PhysicsBench::CreatePileStage(PhysicsWorld& world, int numBodies, const D3DXVECTOR3& center, std::vector<RigidBody*>& outBodies)
+{
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+    const D3DXVECTOR3 size(PILE_BOX_SIZE, PILE_BOX_SIZE, PILE_BOX_SIZE);
+    const int width = (int)ceilf(cbrtf((float)numBodies));
+
+    for (int nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        int nX = nCnt % width;
+        int nZ = (nCnt / width) % width;
+        int nY = nCnt / (width * width);
+
+        std::shared_ptr<Collider> col;
+
+        if (nCnt % 2 == 0)
+        {
+            col = std::make_shared<BoxCollider>(size);
+        }
+        else
+        {
+            col = std::make_shared<SphereCollider>(size);
+        }
+
+        D3DXVECTOR3 pos = center + D3DXVECTOR3(
+            (nX - width * HALF) * PILE_SPACING,
+            (nY + HALF) * PILE_SPACING,
+            (nZ - width * HALF) * PILE_SPACING);
+
+        RigidBody* body = world.GetRigidBody(world.CreateRigidBody(col, 1.0f, true));
+        body->SetTransform(pos, identity, unitScale);
+        outBodies.push_back(body);
+    }
+}
+//=============================================================================
+// 通路の作成処理（箱と球を交互にZ方向へ並べる。X軸のスイープでは全員が重なる）
+//=============================================================================
+void PhysicsBench::CreateCorridorStage(PhysicsWorld& world, int numBodies, std::vector<RigidBody*>& outBodies)
+{
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+    const D3DXVECTOR3 size(PILE_BOX_SIZE, PILE_BOX_SIZE, PILE_BOX_SIZE);
+    const int numRows = numBodies / (CORRIDOR_WIDTH * CORRIDOR_HEIGHT);
+
+    for (int nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        int nX = nCnt % CORRIDOR_WIDTH;
+        int nY = (nCnt / CORRIDOR_WIDTH) % CORRIDOR_HEIGHT;
+        int nZ = nCnt / (CORRIDOR_WIDTH * CORRIDOR_HEIGHT);
+
+        std::shared_ptr<Collider> col;
+
+        if (nCnt % 2 == 0)
+        {
+            col = std::make_shared<BoxCollider>(size);
+        }
+        else
+        {
+            col = std::make_shared<SphereCollider>(size);
+        }
+
+        D3DXVECTOR3 pos(
+            (nX - CORRIDOR_WIDTH * HALF) * PILE_SPACING,
+            (nY + HALF) * PILE_SPACING,
+            (nZ - numRows * HALF) * PILE_SPACING);
+
+        RigidBody* body = world.GetRigidBody(world.CreateRigidBody(col, 1.0f, true));
+        body->SetTransform(pos, identity, unitScale);
+        outBodies.push_back(body);
+    }
+}
+//=============================================================================
+// 積み上げの作成処理（同じ大きさの箱をX方向に並べた列ごとに隙間を空けて積む）
+//=============================================================================
+void PhysicsBench::CreateStackStage(PhysicsWorld& world, int height, int numColumns, std::vector<RigidBody*>& outBodies, std::vector<RigidBody*>& outTops)
+{
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+    const D3DXVECTOR3 size(STACK_BOX_SIZE, STACK_BOX_SIZE, STACK_BOX_SIZE);
+
+    for (int nColumn = 0; nColumn < numColumns; nColumn++)
+    {
+        float x = (nColumn - (numColumns - 1) * HALF) * STACK_COLUMN_SPACING;
+
+        for (int nCnt = 0; nCnt < height; nCnt++)
+        {
+            RigidBody* body = world.GetRigidBody(world.CreateRigidBody(std::make_shared<BoxCollider>(size), 1.0f, true));
+            body->SetTransform(D3DXVECTOR3(x, (nCnt + HALF) * STACK_BOX_SIZE + nCnt * STACK_GAP, 0.0f), identity, unitScale);
+            outBodies.push_back(body);
+
+            if (nCnt == height - 1)
+            {
+                outTops.push_back(body);
+            }
+        }
+    }
+}
+//=============================================================================
+// 積み上げが隙間なく落ち着いたときの一番上の箱の中心の高さ
+//=============================================================================
+float PhysicsBench::GetStackTopY(int height)
+{
+    return (height - HALF) * STACK_BOX_SIZE;
+}
+//=============================================================================
+// レイキャスト計測用のステージの生成処理（広さの中に4種類の形のブロックを散らばらせる）
+//=============================================================================
+void PhysicsBench::CreateRaycastStage(PhysicsWorld& world, int numDynamic, std::vector<RigidBody*>& outBodies)
+{
+    // どの計測でも同じステージになるように乱数の種は固定する
+    std::mt19937 rng(54321);
+    std::uniform_real_distribution<float> posDist(-RAYCAST_STAGE_WIDTH * HALF, RAYCAST_STAGE_WIDTH * HALF);
+    std::uniform_real_distribution<float> heightDist(0.0f, RAYCAST_STAGE_HEIGHT);
+    std::uniform_real_distribution<float> sizeDist(10.0f, 60.0f);
+    std::uniform_real_distribution<float> angleDist(-D3DX_PI, D3DX_PI);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+
+    world.SetGravity(INIT_VEC3);
+
+    // ブロックの形は箱を多めにして4種類を混ぜる
+    auto makeCollider = [&]() -> std::shared_ptr<Collider>
+    {
+        D3DXVECTOR3 size(sizeDist(rng), sizeDist(rng), sizeDist(rng));
+
+        switch (rng() % 6)
+        {
+        case 0:
+            return std::make_shared<SphereCollider>(size);
+        case 1:
+            return std::make_shared<CylinderCollider>(size, D3DXVECTOR3(0.0f, 1.0f, 0.0f));
+        case 2:
+            return std::make_shared<CapsuleCollider>(size.x * HALF, size.y);
+        default:
+            return std::make_shared<BoxCollider>(size);
+        }
+    };
+
+    for (int nCnt = 0; nCnt < RAYCAST_STATIC_BODIES + numDynamic; nCnt++)
+    {
+        bool isDynamic = nCnt >= RAYCAST_STATIC_BODIES;
+        RigidBody* body = world.GetRigidBody(world.CreateRigidBody(makeCollider(), isDynamic ? 1.0f : 0.0f, isDynamic));
+
+        D3DXQUATERNION rot;
+        D3DXQuaternionRotationYawPitchRoll(&rot, angleDist(rng), angleDist(rng), angleDist(rng));
+        body->SetTransform(D3DXVECTOR3(posDist(rng), heightDist(rng), posDist(rng)), rot, unitScale);
+        outBodies.push_back(body);
+
+        // 動的剛体は押し合って動かないように当たり判定を切る（問い合わせには当たる）
+        if (isDynamic)
+        {
+            body->SetCollisionMask(0);
+        }
+    }
+
+    // 静的BVHとブロードフェーズを作る
+    world.StepSimulation(TIME_STEP);
+}
+//=============================================================================
+// 球の穴の作成処理（床と4枚の壁で囲った穴に1万個の球を段ごとにずらして積む）
+//=============================================================================
+void PhysicsBench::CreatePitStage(PhysicsWorld& world, std::vector<RigidBody*>& outBodies)
+{
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    const D3DXVECTOR3 unitScale(1.0f, 1.0f, 1.0f);
+    const float innerWidth = (PIT_WIDTH + HALF) * PIT_SPACING;
+    const float wallHeight = PIT_LAYERS * PIT_SPACING * 2.0f;
+    const float wallThickness = PIT_SPHERE_SIZE;
+
+    // 床と4枚の壁で囲った穴
+    struct Wall
+    {
+        D3DXVECTOR3 size;
+        D3DXVECTOR3 pos;
+    };
+
+    const float outer = innerWidth + wallThickness * 2.0f;
+    const float side = (innerWidth + wallThickness) * HALF;
+    const Wall walls[] =
+    {
+        { D3DXVECTOR3(outer, wallThickness, outer), D3DXVECTOR3(0.0f, -wallThickness * HALF, 0.0f) },
+        { D3DXVECTOR3(wallThickness, wallHeight, outer), D3DXVECTOR3(-side, wallHeight * HALF, 0.0f) },
+        { D3DXVECTOR3(wallThickness, wallHeight, outer), D3DXVECTOR3(side, wallHeight * HALF, 0.0f) },
+        { D3DXVECTOR3(outer, wallHeight, wallThickness), D3DXVECTOR3(0.0f, wallHeight * HALF, -side) },
+        { D3DXVECTOR3(outer, wallHeight, wallThickness), D3DXVECTOR3(0.0f, wallHeight * HALF, side) },
+    };
+
+    for (const Wall& wall : walls)
+    {
+        RigidBody* body = world.GetRigidBody(world.CreateRigidBody(std::make_shared<BoxCollider>(wall.size), 0.0f, false));
+        body->SetTransform(wall.pos, identity, unitScale);
+    }
+
+    // 段ごとに半分ずらして積む（真上に乗って止まらないように）
+    const D3DXVECTOR3 sphereSize(PIT_SPHERE_SIZE, PIT_SPHERE_SIZE, PIT_SPHERE_SIZE);
+
+    for (int nY = 0; nY < PIT_LAYERS; nY++)
+    {
+        float shift = (nY % 2) * PIT_SPACING * HALF;
+
+        for (int nX = 0; nX < PIT_WIDTH; nX++)
+        {
+            for (int nZ = 0; nZ < PIT_WIDTH; nZ++)
+            {
+                RigidBody* body = world.GetRigidBody(world.CreateRigidBody(std::make_shared<SphereCollider>(sphereSize), 1.0f, true));
+
+                D3DXVECTOR3 pos(
+                    (nX - PIT_WIDTH * HALF) * PIT_SPACING + shift,
+                    (nY + HALF) * PIT_SPACING,
+                    (nZ - PIT_WIDTH * HALF) * PIT_SPACING + shift);
+
+                body->SetTransform(pos, identity, unitScale);
+                outBodies.push_back(body);
+            }
+        }
+    }
+}
+//=============================================================================
+// まとめ判定の検証と計測処理（乱数で作った組でスカラー版・1組ずつの判定と比べる）
+//=============================================================================
+NarrowphaseBenchResult PhysicsBench::MeasureNarrowphaseBatch(void)
+{
+    NarrowphaseBenchResult result;
+    const int numPairs = NARROWPHASE_BENCH_PAIRS;
+
+    // 結果を見比べられるように乱数の種は固定する
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> posDist(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> offsetDist(-30.0f, 30.0f);
+    std::uniform_real_distribution<float> sizeDist(5.0f, 30.0f);
+    std::uniform_real_distribution<float> angleDist(-D3DX_PI, D3DX_PI);
+
+    auto makeCollider = [&](bool isBox, const D3DXVECTOR3& pos)
+    {
+        D3DXVECTOR3 size(sizeDist(rng), sizeDist(rng), sizeDist(rng));
+        std::shared_ptr<Collider> col;
+
+        if (isBox)
+        {
+            col = std::make_shared<BoxCollider>(size);
+        }
+        else
+        {
+            col = std::make_shared<SphereCollider>(size);
+        }
+
+        D3DXQUATERNION rot;
+        D3DXQuaternionRotationYawPitchRoll(&rot, angleDist(rng), angleDist(rng), angleDist(rng));
+        col->UpdateTransform(pos, rot, D3DXVECTOR3(1.0f, 1.0f, 1.0f));
+
+        return col;
+    };
+
+    // 球と球・球と箱（逆順も）・箱と箱を同じ数ずつ作る
+    std::vector<std::shared_ptr<Collider>> colliders;
+    colliders.reserve(numPairs * 2);
+
+    for (int nCnt = 0; nCnt < numPairs; nCnt++)
+    {
+        bool isBoxA = (nCnt % 4) >= 2;
+        bool isBoxB = (nCnt % 4) == 1 || (nCnt % 4) == 3;
+
+        D3DXVECTOR3 posA(posDist(rng), posDist(rng), posDist(rng));
+        D3DXVECTOR3 posB = posA + D3DXVECTOR3(offsetDist(rng), offsetDist(rng), offsetDist(rng));
+
+        colliders.push_back(makeCollider(isBoxA, posA));
+        colliders.push_back(makeCollider(isBoxB, posB));
+    }
+
+    NarrowphaseBatch batch;
+    batch.Clear(numPairs);
+
+    for (int nCnt = 0; nCnt < numPairs; nCnt++)
+    {
+        batch.Add(nCnt, colliders[nCnt * 2].get(), colliders[nCnt * 2 + 1].get());
+    }
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    // 1組ずつの判定関数
+    PhysicsWorld world;
+    std::vector<unsigned char> perPairHit(numPairs);
+    std::vector<D3DXVECTOR3> perPairPush(numPairs);
+
+    auto startTime = Clock::now();
+
+    for (int nCnt = 0; nCnt < numPairs; nCnt++)
+    {
+        Collider* colA = colliders[nCnt * 2].get();
+        Collider* colB = colliders[nCnt * 2 + 1].get();
+        PhysicsWorld::CollisionFunc func = PhysicsWorld::m_CollisionTable[colA->GetType()][colB->GetType()];
+
+        perPairHit[nCnt] = (world.*func)(colA, colB, perPairPush[nCnt]);
+    }
+
+    float perPairSec = std::chrono::duration<float>(Clock::now() - startTime).count();
+
+    // スカラー版
+    startTime = Clock::now();
+    batch.Execute(false);
+    float scalarSec = std::chrono::duration<float>(Clock::now() - startTime).count();
+
+    std::vector<unsigned char> scalarHit(numPairs);
+    std::vector<D3DXVECTOR3> scalarPush(numPairs);
+
+    for (int nCnt = 0; nCnt < numPairs; nCnt++)
+    {
+        scalarHit[nCnt] = batch.GetResult(nCnt, scalarPush[nCnt]);
+    }
+
+    // SIMD版
+    startTime = Clock::now();
+    batch.Execute(true);
+    float simdSec = std::chrono::duration<float>(Clock::now() - startTime).count();
+
+    auto isSame = [&](bool hitA, const D3DXVECTOR3& pushA, bool hitB, const D3DXVECTOR3& pushB, float& outError)
+    {
+        outError = 0.0f;
+
+        if (hitA != hitB)
+        {
+            return false;
+        }
+
+        if (hitA)
+        {
+            D3DXVECTOR3 diff = pushA - pushB;
+            outError = D3DXVec3Length(&diff);
+        }
+
+        return outError <= NARROWPHASE_TOLERANCE;
+    };
+
+    for (int nCnt = 0; nCnt < numPairs; nCnt++)
+    {
+        D3DXVECTOR3 push = INIT_VEC3;
+        bool isHit = batch.GetResult(nCnt, push);
+        float error = 0.0f;
+
+        if (!isSame(isHit, push, scalarHit[nCnt] != 0, scalarPush[nCnt], error))
+        {
+            result.numMismatch++;
+        }
+
+        result.maxError = std::max(result.maxError, error);
+
+        if (!isSame(isHit, push, perPairHit[nCnt] != 0, perPairPush[nCnt], error))
+        {
+            result.numMismatchPerPair++;
+        }
+    }
+
+    result.numPairs = numPairs;
+    result.laneWidth = NarrowphaseBatch::GetLaneWidth();
+    result.perPairRate = perPairSec > 0.0f ? numPairs / perPairSec : 0.0f;
+    result.scalarRate = scalarSec > 0.0f ? numPairs / scalarSec : 0.0f;
+    result.simdRate = simdSec > 0.0f ? numPairs / simdSec : 0.0f;
+
+    return result;
+}
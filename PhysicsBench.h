@@ -0,0 +1,496 @@
+//=============================================================================
+//
+// 物理の計測・検証処理 [PhysicsBench.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _PHYSICSBENCH_H_// このマクロ定義がされていなかったら
+#define _PHYSICSBENCH_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "PhysicsWorld.h"
+
+//*****************************************************************************
+// スイープ＆プルーンの計測結果（積み上げた山の剛体数ごと）
+//*****************************************************************************
+struct SweepAndPruneBenchResult
+{
+    static constexpr int NUM_SIZES = 2;                         // 計測する剛体数の段階数
+
+    int   numBodies[NUM_SIZES] = { 1000, 10000 };               // 動的剛体の数
+    int   numPairs[NUM_SIZES] = {};                             // ブロードフェーズが出したペア数
+    int   numHits[NUM_SIZES] = {};                              // ペアのうちナローフェーズで当たった数
+    int   numAllPairsHits[NUM_SIZES] = {};                      // 全組を調べて当たった数
+    float stepTime[NUM_SIZES] = {};                             // 1ステップの時間(ms)
+    float sweepTime[NUM_SIZES] = {};                            // ペアの収集だけの時間(ms)
+    float allPairsTime[NUM_SIZES] = {};                         // 全組の判定1回分の時間（以前の二重ループの1反復）(ms)
+};
+
+//*****************************************************************************
+// ブロードフェーズの比較結果（場面ごと・種類ごと）
+//*****************************************************************************
+struct BroadphaseBenchResult
+{
+    enum STAGE
+    {
+        STAGE_CORRIDOR = 0,     // Z方向に長い通路（全員がX軸で重なる）
+        STAGE_PILE,             // 密に積んだ山
+        STAGE_MAX
+    };
+
+    static constexpr int NUM_TYPES = 2;                         // 比べるブロードフェーズの数（Broadphase::TYPEの順）
+
+    int   numBodies = 0;                                        // 動的剛体の数
+    int   numPairs[STAGE_MAX][NUM_TYPES] = {};                  // ブロードフェーズが出したペア数
+    int   numHits[STAGE_MAX][NUM_TYPES] = {};                   // ペアのうちナローフェーズで当たった数
+    float stepTime[STAGE_MAX][NUM_TYPES] = {};                  // 1ステップの時間(ms)
+    float pairTime[STAGE_MAX][NUM_TYPES] = {};                  // ペアの収集だけの時間(ms)
+};
+
+//*****************************************************************************
+// 眠った積み上げを起こしたときの計測結果（落とした箱で一番上を起こす）
+//*****************************************************************************
+struct IslandWakeResult
+{
+    int   numBodies = 0;                // 積み上げの箱の数
+    int   sleepStep = -1;               // 積み上げが全部眠ったステップ（眠らなければ-1）
+    int   firstWakeStep = -1;           // 箱を落としてから積み上げの箱が最初に起きたステップ（起きなければ-1）
+    int   lastWakeStep = -1;            // 箱を落としてから積み上げの箱が全部起きたステップ（起きなければ-1）
+    float sleepPenetration = 0.0f;      // 眠ったときの隣り合う箱（一番下は床）の最大の重なり
+    float maxPenetration = 0.0f;        // 起きてからの隣り合う箱（一番下は床）の最大の重なり
+};
+
+//*****************************************************************************
+// 積み上げの計測結果（ウォームスタートの有無と速度の反復回数の組み合わせごと）
+//*****************************************************************************
+struct StackingBenchResult
+{
+    static constexpr int NUM_CONFIGS = 4;                       // 比べる設定の数
+    static constexpr int DEFAULT_CONFIG = 3;                    // エディターのデフォルトと同じ設定（ウォームスタートあり・8回）
+
+    bool  isWarmStarting[NUM_CONFIGS] = { false, false, true, true }; // ウォームスタートするか
+    int   velocityIterations[NUM_CONFIGS] = { 8, 15, 4, 8 };    // 速度の反復回数
+    int   numColumns = 0;                                       // 箱の列の数
+    int   height = 0;                                           // 1列に積む箱の数
+    float stepTime[NUM_CONFIGS] = {};                           // 1ステップの平均時間(ms)
+    float maxSag[NUM_CONFIGS] = {};                             // 落ち着いてからの一番上の箱の最大の沈み込み
+    float maxDrift[NUM_CONFIGS] = {};                           // 落ち着いてからの一番上の箱の最大の横ずれ
+    int   numStanding[NUM_CONFIGS] = {};                        // 最後まで立っていた列の数
+    int   restStep[NUM_CONFIGS] = {};                           // 全部の箱が眠ったステップ（眠らなければ-1）
+};
+
+//*****************************************************************************
+// 静止までの計測結果（場面ごと・ソルバーの設定ごと）
+//*****************************************************************************
+struct SolverRestBenchResult
+{
+    static constexpr int NUM_SCENES = 3;                        // 場面の数
+    static constexpr int NUM_CONFIGS = 4;                       // 比べる設定の数
+    static constexpr int DEFAULT_CONFIG = 0;                    // エディターと同じ設定
+    static constexpr int PUSH_OUT_CONFIG = 3;                   // 以前の押し戻しのソルバー
+
+    int   height[NUM_SCENES] = { 10, 20, 25 };                  // 1列に積む箱の数
+    int   numColumns[NUM_SCENES] = { 1, 10, 4 };                // 箱の列の数
+    bool  isWarmStarting[NUM_CONFIGS] = { true, true, false, true }; // ウォームスタートするか
+    bool  isEarlyOut[NUM_CONFIGS] = { true, false, true, false };    // 収束したら反復を打ち切るか
+    bool  isPushOut[NUM_CONFIGS] = { false, false, false, true };    // 以前の押し戻しのソルバーで解くか
+    int   restStep[NUM_SCENES][NUM_CONFIGS] = {};               // 全部の箱が眠ったステップ（眠らなければ-1）
+    float velocityPasses[NUM_SCENES][NUM_CONFIGS] = {};         // 眠るまでの1ステップあたりの速度の反復回数の平均
+    float stepTime[NUM_SCENES][NUM_CONFIGS] = {};               // 眠るまでの1ステップの平均時間(ms)
+    float maxSag[NUM_SCENES][NUM_CONFIGS] = {};                 // 落ち着いてからの一番上の箱の最大の沈み込み
+    int   numStanding[NUM_SCENES][NUM_CONFIGS] = {};            // 最後まで立っていた列の数
+};
+
+//*****************************************************************************
+// 衝突判定の振り分けの計測結果（判定本体を外した1組あたりの手間）
+//*****************************************************************************
+struct DispatchBenchResult
+{
+    int   numPairs = 0;                 // 振り分けた組の数（種類の混ざった組）
+    int   numCalls = 0;                 // 1つの方式で振り分けた回数（組の数×繰り返し回数）
+    float tableCost = 0.0f;             // 関数表で引いたとき(ns/組)
+    float chainCost = 0.0f;             // 以前のif/elseの連鎖で選んだとき(ns/組)
+};
+
+//*****************************************************************************
+// 積分の計測結果（剛体プールと、剛体を1つずつヒープに置いていた以前の形を比べる）
+//*****************************************************************************
+struct IntegrateBenchResult
+{
+    int   numBodies = 0;                // 動的剛体の数
+    int   legacyBodySize = 0;           // 以前の剛体1つの大きさ(バイト)
+    int   poolBodySize = 0;             // 剛体プールの剛体本体1つの大きさ(バイト)
+    float legacyOrderedTime = 0.0f;     // 以前の形・作った順に回したとき(ms)
+    float legacyScatteredTime = 0.0f;   // 以前の形・ヒープ上で散らばった順に回したとき(ms)
+    float poolTime = 0.0f;              // 剛体プール(ms)
+    int   numMismatch = 0;              // 積分し終えた位置が以前の形と食い違った剛体の数
+};
+
+//*****************************************************************************
+// すり抜けの検証結果（薄い床に弾を撃ち込んで数える）
+//*****************************************************************************
+struct TunnellingTestResult
+{
+    int   numShots = 0;                 // 撃った数
+    int   numTunnelled = 0;             // 予測接触ありで抜けた数
+    int   numTunnelledDiscrete = 0;     // 予測接触なしで抜けた数
+    int   numSpeculative = 0;           // 作った予測接触の数
+    float maxSpeed = 0.0f;              // 撃った最大の速さ
+};
+
+//*****************************************************************************
+// アイランド並列解決の計測結果（スレッド数ごとの処理時間）
+//*****************************************************************************
+struct IslandScalingResult
+{
+    static constexpr int NUM_THREAD_COUNTS = 4;                 // 計測するスレッド数の段階数
+
+    int   threadCounts[NUM_THREAD_COUNTS] = { 1, 2, 4, 8 };     // 計測したスレッド数
+    float stepTime[NUM_THREAD_COUNTS] = {};                     // 1ステップの平均処理時間(ms)
+    float solveTime[NUM_THREAD_COUNTS] = {};                    // 1ステップの接触の解決の平均時間(ms)
+    int   numIslands = 0;                                       // 最後のステップのアイランド数
+    int   numHardwareThreads = 0;                               // 実行環境の論理コア数
+    bool  isDeterministic = false;                              // どのスレッド数でも1スレッドと同じ結果か
+};
+
+//*****************************************************************************
+// ナローフェーズ並列化の計測結果（球を敷き詰めた穴でスレッド数ごとの処理時間）
+//*****************************************************************************
+struct NarrowphaseScalingResult
+{
+    static constexpr int NUM_THREAD_COUNTS = 4;                 // 計測するスレッド数の段階数
+
+    int   threadCounts[NUM_THREAD_COUNTS] = { 1, 2, 4, 8 };     // 計測したスレッド数
+    float narrowphaseTime[NUM_THREAD_COUNTS] = {};              // 1ステップのナローフェーズの平均時間(ms)
+    float stepTime[NUM_THREAD_COUNTS] = {};                     // 1ステップの平均処理時間(ms)
+    float integrateTime[NUM_THREAD_COUNTS] = {};                // うち速度・位置の積分の平均時間(ms)
+    float broadphaseTime[NUM_THREAD_COUNTS] = {};               // うちAABBの更新とペア集めの平均時間(ms)
+    float solveTime[NUM_THREAD_COUNTS] = {};                    // うちアイランド分けと接触の解決の平均時間(ms)
+    float sleepTime[NUM_THREAD_COUNTS] = {};                    // うちスリープ判定の平均時間(ms)
+    int   numBodies = 0;                                        // 動的な球の数
+    int   numPairs = 0;                                         // 最後のステップの候補ペア数
+    int   numContacts = 0;                                      // 最後のステップの接触数
+    int   numHardwareThreads = 0;                               // 実行環境の論理コア数
+    bool  isDeterministic = false;                              // どのスレッド数でも1スレッドと同じ結果か
+};
+
+//*****************************************************************************
+// レイキャストの計測結果（1万個のブロックのステージに1万本のレイを飛ばす）
+//*****************************************************************************
+struct RaycastBenchResult
+{
+    int   numBodies = 0;                // ステージの剛体数
+    int   numRays = 0;                  // 飛ばしたレイの数
+    int   numHits = 0;                  // 何かに当たったレイの数
+    int   numMismatch = 0;              // 総当たりと当たった剛体・距離が食い違ったレイの数
+    float treeTime = 0.0f;              // BVH・ブロードフェーズを使った1本あたりの時間(us)
+    float bruteForceTime = 0.0f;        // 全剛体を総当たりした1本あたりの時間(us)
+};
+
+//*****************************************************************************
+// まとめたレイの計測結果（同じ1万個のステージに向きの近いレイを8本ずつ飛ばす）
+//*****************************************************************************
+struct RayPacketBenchResult
+{
+    int   numBodies = 0;                // ステージの剛体数
+    int   numRays = 0;                  // 飛ばしたレイの数
+    int   numHits = 0;                  // 何かに当たったレイの数
+    int   numMismatch = 0;              // 1本ずつのRayCastと当たった距離が食い違ったレイの数
+    float scalarRate = 0.0f;            // 1本ずつのRayCast(Mrays/s)
+    float packetRate = 0.0f;            // まとめたレイ(Mrays/s)
+    int   laneWidth = 0;                // SIMDの同時処理数
+};
+
+//*****************************************************************************
+// スナップショットの計測結果（球の穴を途中で保存し、戻して回し直した結果と比べる）
+//*****************************************************************************
+struct SnapshotBenchResult
+{
+    int   numBodies = 0;                // 剛体数
+    int   numManifolds = 0;             // 保存した接触多様体の数
+    int   numBytes = 0;                 // スナップショットの大きさ(バイト)
+    float saveTime = 0.0f;              // 1回の保存の平均時間(us)
+    float restoreTime = 0.0f;           // 回したあとの状態から1回戻す平均時間(us)
+    bool  isRestoreMatch = false;       // 戻して回し直した結果が1回目とビット単位で同じか
+    bool  isRebuildMatch = false;       // 作り直したワールドを別のスレッド数で回した結果とも同じか
+};
+
+//*****************************************************************************
+// 箱の塔の検証結果（10段の塔が止まって眠るまでのステップ数）
+//*****************************************************************************
+struct BoxStackTestResult
+{
+    static constexpr int NUM_TOWERS = 3;                        // 塔の種類（そろえた・少しずらした・1段おきに45度回した）
+
+    int   restStep[NUM_TOWERS] = {};                            // 全部の箱が眠ったステップ（上限までに眠らなければ-1）
+    float topDrift[NUM_TOWERS] = {};                            // 一番上の箱の横のずれ
+    float avgPoints[NUM_TOWERS] = {};                           // 1組あたりの平均の接触点数
+    float avgPasses[NUM_TOWERS] = {};                           // 1ステップの平均の速度の反復回数
+    int   maxSteps = 0;                                         // 待つステップ数の上限
+    bool  isAllAtRest = false;                                  // 全部の塔が上限までに眠ったか
+};
+
+//*****************************************************************************
+// 静的ステージの焼き込みの計測結果（5万個の静的ブロックのBVHをほかのスレッドで組む）
+//*****************************************************************************
+struct StaticBakeBenchResult
+{
+    int   numBodies = 0;                // 静的剛体の数
+    int   numNodes = 0;                 // 組んだBVHのノード数
+    float gatherTime = 0.0f;            // 焼き込みを始めるときに呼び出したスレッドが止まる時間(ms)（動いた印の確認と写し取り）
+    float buildTime = 0.0f;             // ほかのスレッドで組む時間(ms)
+    float syncBuildTime = 0.0f;         // 呼び出したスレッドで全部作り直す時間(ms)（これまでの編集中の1回分）
+    float editFrameTime = 0.0f;         // 毎フレーム1個ずつ動かしたときに編集中の1フレームで止まる平均時間(ms)
+    float scanTime = 0.0f;              // 焼き込む前の1ステップで動いた静的剛体を探す時間(us)
+    float bakedScanTime = 0.0f;         // 焼き込んだあとの同じ時間(us)
+    float transformTime = 0.0f;         // 全部の静的剛体に同じ位置を設定し直す時間(ms)（再生中のブロックの更新で省いた分）
+    bool  isMatch = false;              // ほかのスレッドで組んだBVHと呼び出したスレッドで作ったBVHの検索結果が同じか
+};
+
+//*****************************************************************************
+// 三角形メッシュの計測結果（でこぼこの地形を1つのメッシュ・高さの格子にして箱の代わりに使う）
+//*****************************************************************************
+struct TriangleMeshBenchResult
+{
+    int   numTriangles = 0;             // 三角形数
+    int   numNodes = 0;                 // 三角形のBVHのノード数
+    int   numBytes = 0;                 // キャッシュに書き出す大きさ(バイト)
+    float cookTime = 0.0f;              // 頂点から組み立てる時間(ms)（キャッシュがない初回の読み込み）
+    float loadTime = 0.0f;              // 書き出したバイト列から読み込む時間(ms)（キャッシュがある2回目以降）
+    float sampleTime = 0.0f;            // メッシュを見下ろして高さの格子を作る時間(ms)
+    int   numRays = 0;                  // 飛ばしたレイの数
+    float meshRayTime = 0.0f;           // BVHで調べた1本あたりの時間(us)
+    float bruteRayTime = 0.0f;          // 全部の三角形を調べた1本あたりの時間(us)
+    float fieldRayTime = 0.0f;          // 高さの格子のマスをたどった1本あたりの時間(us)
+    int   numDropped = 0;               // 落とした剛体の数
+    int   numHeld = 0;                  // 沈まずに地面に支えられた剛体の数
+    int   numSleeping = 0;              // 眠った剛体の数
+    bool  isRoundTripMatch = false;     // 読み込んだ三角形が組み立てたものとビット単位で同じか
+    bool  isCorruptRejected = false;    // 葉が三角形の外を指すように壊したバイト列を読み込みで弾けたか
+    bool  isRayMatch = false;           // BVHと総当たりのレイの結果が同じか
+    bool  isFieldRayMatch = false;      // 高さの格子とメッシュのレイの結果が同じか
+};
+
+//*****************************************************************************
+// 複合コライダーの計測結果（天板と4本の脚の机を1つの剛体と5つの剛体で落として比べる）
+//*****************************************************************************
+struct CompoundBenchResult
+{
+    int   numTables = 0;                // 机の数
+    int   compoundBodies = 0;           // 複合コライダーの剛体数（ブロードフェーズに入る数、机1つで1個）
+    int   separateBodies = 0;           // 形状ごとに分けた剛体数（机1つで5個）
+    int   compoundPairs = 0;            // 複合コライダーの最大の候補ペア数
+    int   separatePairs = 0;            // 分けた剛体の最大の候補ペア数
+    float compoundStepTime = 0.0f;      // 複合コライダーの1ステップの平均処理時間(ms)
+    float separateStepTime = 0.0f;      // 分けた剛体の1ステップの平均処理時間(ms)
+    int   compoundResting = 0;          // 複合コライダーで天板が傾かずに脚の高さで止まった机の数
+    int   separateResting = 0;          // 分けた剛体で天板が傾かずに脚の高さで止まった机の数
+    int   compoundSleeping = 0;         // 複合コライダーで眠った机の数
+    int   separateSleeping = 0;         // 分けた剛体で全部の剛体が眠った机の数
+};
+
+//*****************************************************************************
+// GJK/EPAと専用の判定関数の比較結果（1種類の形状の組）
+//*****************************************************************************
+struct GjkPairBench
+{
+    float specialisedTime = 0.0f;       // 専用の判定関数の1組あたりの時間(ns)
+    float gjkTime = 0.0f;               // GJK/EPAの1組あたりの時間(ns)
+    int   numHits = 0;                  // 専用の判定関数で重なった組の数
+    int   numShallow = 0;               // 比べた浅い組（離れている・めり込みが浅い組）の数
+    int   numMismatches = 0;            // 浅い組のうち重なりの有無・めり込み量が食い違った組の数
+    float maxDepthError = 0.0f;         // 浅い組のうち両方で重なった組のめり込み量の最大の差
+};
+
+//*****************************************************************************
+// GJK/EPAの計測結果（専用の判定関数と同じ組を比べ、凸包を床に落とす）
+//*****************************************************************************
+struct GjkBenchResult
+{
+    int   numPairs = 0;                 // 形状の組ごとに判定した数
+    GjkPairBench boxBox;                // 箱と箱
+    GjkPairBench sphereBox;             // 球と箱
+    GjkPairBench sphereSphere;          // 球と球
+    GjkPairBench sphereCapsule;         // 球とカプセル
+    GjkPairBench sphereCylinder;        // 球とシリンダー
+    GjkPairBench capsuleBox;            // カプセルと箱
+    GjkPairBench capsuleCapsule;        // カプセルとカプセル
+    float hullBoxTime = 0.0f;           // 凸包と箱のGJK/EPAの1組あたりの時間(ns)
+    int   hullVertices = 0;             // 凸包の頂点数
+    int   hullTriangles = 0;            // 凸包の三角形数
+    float cookTime = 0.0f;              // 点の集まりから凸包を組み立てる時間(us)
+    int   numHulls = 0;                 // 落とした凸包の数
+    float hullStepTime = 0.0f;          // 凸包を落とした1ステップの平均処理時間(ms)
+    int   numHullsHeld = 0;             // 沈まずに床に支えられた凸包の数
+    int   numHullsSleeping = 0;         // 眠った凸包の数
+};
+
+//*****************************************************************************
+// まとめ判定の計測結果
+//*****************************************************************************
+struct NarrowphaseBenchResult
+{
+    int   numPairs = 0;                 // 判定した組の数
+    int   numMismatch = 0;              // SIMD版とスカラー版で食い違った組の数
+    int   numMismatchPerPair = 0;       // SIMD版と1組ずつの判定関数で食い違った組の数
+    float maxError = 0.0f;              // 押し戻しの最大誤差
+    float perPairRate = 0.0f;           // 1組ずつの判定関数(組/秒)
+    float scalarRate = 0.0f;            // スカラー版(組/秒)
+    float simdRate = 0.0f;              // SIMD版(組/秒)
+    int   laneWidth = 0;                // SIMD版の同時処理数
+};
+
+//=============================================================================
+// 物理の計測・検証クラス（計測用の実行ファイルだけに入れ、エディターには入れない）
+// 計測のたびにワールドを作って同じ場面を組み、時間と結果を返す
+//=============================================================================
+class PhysicsBench
+{
+public:
+    static SweepAndPruneBenchResult MeasureSweepAndPrune(void);
+    static BroadphaseBenchResult MeasureBroadphase(void);
+    static IslandWakeResult MeasureIslandWake(void);
+    static StackingBenchResult MeasureStacking(void);
+    static SolverRestBenchResult MeasureSolverRest(void);
+    static DispatchBenchResult MeasureDispatch(void);
+    static IntegrateBenchResult MeasureIntegrate(void);
+    static TunnellingTestResult MeasureTunnelling(void);
+    static IslandScalingResult MeasureIslandScaling(void);
+    static NarrowphaseScalingResult MeasureNarrowphaseScaling(void);
+    static RaycastBenchResult MeasureRaycast(void);
+    static RayPacketBenchResult MeasureRayPacket(void);
+    static SnapshotBenchResult MeasureSnapshot(void);
+    static BoxStackTestResult MeasureBoxStack(void);
+    static StaticBakeBenchResult MeasureStaticBake(void);
+    static TriangleMeshBenchResult MeasureTriangleMesh(void);
+    static CompoundBenchResult MeasureCompound(void);
+    static GjkBenchResult MeasureGjk(void);
+    static NarrowphaseBenchResult MeasureNarrowphaseBatch(void);
+
+private:
+    static void CreateFloor(PhysicsWorld& world, float width, float depth);
+    static void CreatePileStage(PhysicsWorld& world, int numBodies, const D3DXVECTOR3& center, std::vector<RigidBody*>& outBodies);
+    static void CreateCorridorStage(PhysicsWorld& world, int numBodies, std::vector<RigidBody*>& outBodies);
+    static void CreateStackStage(PhysicsWorld& world, int height, int numColumns, std::vector<RigidBody*>& outBodies, std::vector<RigidBody*>& outTops);
+    static float GetStackTopY(int height);
+    static void CreateRaycastStage(PhysicsWorld& world, int numDynamic, std::vector<RigidBody*>& outBodies);
+    static void CreatePitStage(PhysicsWorld& world, std::vector<RigidBody*>& outBodies);
+    static bool ChainDispatch(PhysicsWorld& world, RigidBody* a, RigidBody* b, D3DXVECTOR3& outPush);
+    static float StepPushOut(PhysicsWorld& world, float dt);
+
+    static constexpr float  HALF                        = 0.5f;    // 半分
+    static constexpr float  TIME_STEP                   = 1.0f / PhysicsWorld::DEFAULT_PHYSICS_RATE; // 1ステップの時間(秒)
+    static constexpr float  PILE_BOX_SIZE               = 10.0f;   // 山に積む剛体の大きさ
+    static constexpr float  PILE_SPACING                = 10.5f;   // 山に積む剛体の間隔
+    static constexpr int    SAP_WARMUP_STEPS            = 10;      // スイープ＆プルーンの計測で山が崩れ始めるまで回すステップ数
+    static constexpr int    SAP_STEPS                   = 10;      // スイープ＆プルーンの計測で時間を測るステップ数
+    static constexpr int    BROADPHASE_BENCH_BODIES     = 5000;    // ブロードフェーズの比較に使う剛体の数
+    static constexpr int    CORRIDOR_WIDTH              = 4;       // 通路の横に並べる数
+    static constexpr int    CORRIDOR_HEIGHT             = 2;       // 通路の縦に積む数
+    static constexpr float  EDITOR_GRAVITY              = -320.0f; // エディターと同じ重力
+    static constexpr float  STACK_BOX_SIZE              = 20.0f;   // 積む箱の大きさ
+    static constexpr float  STACK_GAP                   = 0.5f;    // 積むときに箱の間に空ける隙間
+    static constexpr float  STACK_COLUMN_SPACING        = 40.0f;   // 列の間隔
+    static constexpr float  STACK_FLOOR_SIZE            = 2000.0f; // 積み上げの床の広さ（崩れた箱も受け止める）
+    static constexpr int    WAKE_STACK_HEIGHT           = 10;      // 起床の計測で積む数
+    static constexpr int    WAKE_SETTLE_STEPS           = 600;     // 起床の計測で積み上げが眠るまで待つステップ数の上限
+    static constexpr float  WAKE_DROP_HEIGHT            = 10.0f;   // 起床の計測で落とす箱の下面と一番上の箱の上面の間
+    static constexpr float  WAKE_DROP_SPEED             = 200.0f;  // 起床の計測で落とす箱の初めの速さ
+    static constexpr int    WAKE_STEPS                  = 60;      // 起床の計測で箱を落としてから回すステップ数
+    static constexpr int    STACKING_HEIGHT             = 10;      // 積み上げの計測で1列に積む数
+    static constexpr int    STACKING_COLUMNS            = 10;      // 積み上げの計測の列の数
+    static constexpr int    STACK_STEPS                 = 600;     // 積み上げを回すステップ数
+    static constexpr int    STACK_SETTLE_STEPS          = 120;     // 沈み込みを測り始めるまでのステップ数
+    static constexpr float  SOLVER_REST_FRICTION        = 2.5f;    // 静止までの計測で箱に設定する摩擦（以前の押し戻しのソルバーで測った場面と同じ）
+    static constexpr int    PUSH_OUT_VELOCITY_ITERATIONS = 4;      // 以前の押し戻しのソルバーの速度の反復回数
+    static constexpr int    PUSH_OUT_POSITION_ITERATIONS = 2;      // 以前の押し戻しのソルバーの押し戻しの反復回数
+    static constexpr int    DISPATCH_BENCH_BODIES       = 400;     // 振り分けの計測に使う剛体の数
+    static constexpr int    DISPATCH_BENCH_PAIRS        = 4096;    // 振り分けの計測に使う組の数
+    static constexpr int    DISPATCH_BENCH_REPEAT       = 1000;    // 振り分けの計測の繰り返し回数
+    static constexpr int    DISPATCH_BENCH_TYPES        = 4;       // 振り分けの計測に混ぜる形状の数（箱・カプセル・円柱・球）
+    static constexpr unsigned int DISPATCH_BENCH_SEED   = 12345;   // 振り分けの計測で形状と組を決める乱数の種
+    static constexpr int    INTEGRATE_BENCH_BODIES      = 100000;  // 積分の計測に使う剛体の数
+    static constexpr int    INTEGRATE_BENCH_REPEAT      = 20;      // 積分の計測の繰り返し回数（一番速かった回を使う）
+    static constexpr float  INTEGRATE_BENCH_SPEED       = 50.0f;   // 積分の計測で剛体に与える速さ・角速さの上限
+    static constexpr float  INTEGRATE_BENCH_TOLERANCE   = 1e-2f;   // 積分の計測で位置が同じとみなす誤差
+    static constexpr unsigned int INTEGRATE_BENCH_SEED  = 54321;   // 積分の計測で初速と回す順を決める乱数の種
+    static constexpr float  TUNNEL_FLOOR_WIDTH          = 4000.0f; // すり抜け検証の床の幅
+    static constexpr float  TUNNEL_FLOOR_THICKNESS      = 1.0f;    // すり抜け検証の床の厚さ
+    static constexpr float  TUNNEL_PROJECTILE_SIZE      = 4.0f;    // すり抜け検証の弾の大きさ
+    static constexpr float  TUNNEL_START_DISTANCE       = 100.0f;  // すり抜け検証の弾を撃つ距離
+    static constexpr float  TUNNEL_MIN_SPEED            = 250.0f;  // すり抜け検証の最初の速さ（倍々に上げる）
+    static constexpr int    TUNNEL_NUM_SPEEDS           = 8;       // すり抜け検証の速さの段階数
+    static constexpr int    TUNNEL_STEPS                = 60;      // すり抜け検証で1発ごとに回すステップ数
+    static constexpr int    SCALING_TOWERS_X            = 10;      // 並列計測の塔の横の数
+    static constexpr int    SCALING_TOWERS_Z            = 5;       // 並列計測の塔の奥の数
+    static constexpr int    SCALING_TOWER_HEIGHT        = 10;      // 並列計測の塔の段数
+    static constexpr float  SCALING_BOX_SIZE            = 20.0f;   // 並列計測の箱の大きさ
+    static constexpr float  SCALING_TOWER_SPACING       = 60.0f;   // 並列計測の塔の間隔
+    static constexpr int    SCALING_WARMUP_STEPS        = 5;       // 並列計測の前に全部の塔が接地するまでのステップ数
+    static constexpr int    SCALING_STEPS               = 20;      // 並列計測で時間を測るステップ数（眠り始める前まで）
+    static constexpr int    RAYCAST_STATIC_BODIES       = 10000;   // レイキャスト計測のステージのブロック数
+    static constexpr int    RAYCAST_DYNAMIC_BODIES      = 1000;    // レイキャスト計測の浮かせておく動的剛体の数
+    static constexpr int    RAYCAST_RAYS                = 10000;   // レイキャスト計測で飛ばすレイの数
+    static constexpr float  RAYCAST_STAGE_WIDTH         = 4000.0f; // レイキャスト計測のステージの幅
+    static constexpr float  RAYCAST_STAGE_HEIGHT        = 400.0f;  // レイキャスト計測のステージの高さ
+    static constexpr float  RAYCAST_MAX_DISTANCE        = 2000.0f; // レイキャスト計測のレイの長さ
+    static constexpr int    PACKET_RAYS                 = 65536;   // まとめたレイの計測で飛ばすレイの数
+    static constexpr float  PACKET_SPREAD               = 0.05f;   // まとめたレイの計測で1つのまとまりの向きをずらす幅
+    static constexpr int    PIT_WIDTH                   = 25;      // 球の穴の1辺に並べる数
+    static constexpr int    PIT_LAYERS                  = 16;      // 球の穴に積む段数（25x25x16で1万個）
+    static constexpr float  PIT_SPHERE_SIZE             = 10.0f;   // 球の穴の球の直径
+    static constexpr float  PIT_SPACING                 = 10.5f;   // 球の穴の球を置く間隔
+    static constexpr int    PIT_WARMUP_STEPS            = 20;      // 球の穴で計測前に落とすステップ数
+    static constexpr int    PIT_STEPS                   = 10;      // 球の穴で時間を測るステップ数
+    static constexpr int    SNAPSHOT_STEPS              = 30;      // スナップショットの計測で保存してから回すステップ数
+    static constexpr int    SNAPSHOT_REPEAT             = 20;      // スナップショットの計測で保存・復元を繰り返す回数
+    static constexpr int    TOWER_HEIGHT                = 10;      // 箱の塔の検証の段数
+    static constexpr float  TOWER_GAP                   = 0.05f;   // 箱の塔の検証で段の間に空ける隙間
+    static constexpr float  TOWER_OFFSET                = 0.5f;    // 箱の塔の検証で段ごとに横へずらす幅の単位
+    static constexpr float  TOWER_YAW                   = 1.0f;    // 箱の塔の検証で段ごとに回す角度の単位(度)
+    static constexpr int    TOWER_MAX_STEPS             = 120;     // 箱の塔の検証で眠るまで待つステップ数の上限
+    static constexpr int    BAKE_GRID_X                 = 250;     // 焼き込みの計測のステージの横のブロック数
+    static constexpr int    BAKE_GRID_Z                 = 200;     // 焼き込みの計測のステージの奥のブロック数（250x200で5万個）
+    static constexpr float  BAKE_BLOCK_SPACING          = 40.0f;   // 焼き込みの計測のブロックの間隔
+    static constexpr int    BAKE_EDIT_FRAMES            = 60;      // 焼き込みの計測でブロックを動かすフレーム数
+    static constexpr int    BAKE_SCAN_STEPS             = 100;     // 焼き込みの計測で確認の時間を測るステップ数
+    static constexpr int    BAKE_QUERIES                = 1000;    // 焼き込みの計測で検索結果を比べる回数
+    static constexpr int    MESH_GRID_SIZE              = 129;     // メッシュの計測の地形の1辺の格子点の数（128x128マスで32768枚）
+    static constexpr float  MESH_CELL_SIZE              = 10.0f;   // メッシュの計測の地形のマスの幅
+    static constexpr float  MESH_BUMP_HEIGHT            = 20.0f;   // メッシュの計測の地形の山の高さ
+    static constexpr float  MESH_BUMP_PERIOD            = 200.0f;  // メッシュの計測の地形の山の間隔
+    static constexpr int    MESH_RAYS                   = 10000;   // メッシュの計測で飛ばすレイの数
+    static constexpr float  MESH_RAY_HEIGHT             = 100.0f;  // メッシュの計測でレイを飛ばす高さ
+    static constexpr float  MESH_RAY_SLANT              = 0.5f;    // メッシュの計測でレイを横へ傾ける幅
+    static constexpr float  MESH_RAY_TOLERANCE          = 1e-3f;   // メッシュの計測でレイの距離を同じとみなす誤差
+    static constexpr int    MESH_DROP_BODIES            = 9;       // メッシュの計測で落とす剛体の数
+    static constexpr float  MESH_SHAPE_SIZE             = 10.0f;   // メッシュの計測で落とす剛体の大きさ
+    static constexpr float  MESH_DROP_HEIGHT            = 30.0f;   // メッシュの計測で落とす高さ
+    static constexpr int    MESH_DROP_STEPS             = 600;     // メッシュの計測で眠るまで待つステップ数の上限
+    static constexpr float  MESH_HOLD_TOLERANCE         = 1.0f;    // メッシュの計測で地面に支えられているとみなす沈み込み
+    static constexpr int    COMPOUND_GRID               = 15;      // 複合の計測で机を並べる1辺の数（15x15で225個）
+    static constexpr float  COMPOUND_SPACING            = 120.0f;  // 複合の計測の机の間隔
+    static constexpr float  COMPOUND_DROP_HEIGHT        = 40.0f;   // 複合の計測で机を落とす高さ（剛体の原点）
+    static constexpr int    COMPOUND_YAW_STEPS          = 10;      // 複合の計測で机の向きを変える段階数
+    static constexpr float  COMPOUND_YAW_STEP           = 0.1f;    // 複合の計測で机の向きを変える幅（ラジアン）
+    static constexpr int    COMPOUND_STEPS              = 300;     // 複合の計測で時間を測るステップ数
+    static constexpr float  COMPOUND_REST_TOLERANCE     = 1.0f;    // 複合の計測で天板が脚の高さにあるとみなす誤差
+    static constexpr float  COMPOUND_UP_TOLERANCE       = 0.99f;   // 複合の計測で天板が傾いていないとみなす上向きの内積
+    static constexpr int    GJK_BENCH_PAIRS             = 10000;   // GJKの計測で形状の組ごとに判定する数
+    static constexpr int    GJK_BENCH_REPEAT            = 10;      // GJKの計測で時間を測る繰り返し回数
+    static constexpr float  GJK_BENCH_RANGE             = 30.0f;   // GJKの計測で形状を置く範囲（半分ほどの組が重なる広さ）
+    static constexpr float  GJK_BENCH_DEPTH_TOLERANCE   = 0.05f;   // GJKの計測でめり込み量が同じとみなす誤差
+    static constexpr float  GJK_BENCH_SHALLOW_DEPTH     = 2.0f;    // GJKの計測で結果を比べるめり込み量の上限（接地・積み上げで起きる深さ）
+    static constexpr int    GJK_HULL_POINTS             = 64;      // GJKの計測で凸包を組み立てる点の数
+    static constexpr int    GJK_HULL_GRID               = 8;       // GJKの計測で凸包を並べる1辺の数（8x8で64個）
+    static constexpr float  GJK_HULL_SPACING            = 40.0f;   // GJKの計測の凸包の間隔
+    static constexpr float  GJK_HULL_DROP_HEIGHT        = 30.0f;   // GJKの計測で凸包を落とす高さ
+    static constexpr int    GJK_HULL_STEPS              = 600;     // GJKの計測で凸包を落として回すステップ数
+    static constexpr float  GJK_HULL_REST_TOLERANCE     = 1.0f;    // GJKの計測で凸包の下端が床の上にあるとみなす誤差
+    static constexpr int    NARROWPHASE_BENCH_PAIRS     = 100000;  // まとめ判定の検証に使う組の数
+    static constexpr float  NARROWPHASE_TOLERANCE       = 1e-3f;   // まとめ判定の結果を同じとみなす誤差
+};
+
+#endif
@@ -9,10 +9,31 @@
 // インクルードファイル
 //*****************************************************************************
 #include "PhysicsWorld.h"
-#include "Block.h"
 #include "Collider.h"
 #include "RigidBody.h"
+#include "Snapshot.h"
+#include "TriangleShape.h"
+#include "Gjk.h"
+#include "chrono"
 
+//=============================================================================
+// コンストラクタ
+//=============================================================================
+PhysicsWorld::PhysicsWorld(Broadphase::TYPE broadphase)
+    : m_Gravity(0, DEFAULT_GRAVITY, 0), m_StepTime(0.0f), m_IntegrateTime(0.0f), m_BroadphaseTime(0.0f), m_NarrowphaseTime(0.0f), m_SolveTime(0.0f), m_SleepTime(0.0f), m_StaticBakeTime(0.0f), // デフォルト重力
+    m_FixedTimeStep(1.0f / DEFAULT_PHYSICS_RATE), m_Accumulator(0.0f), m_InterpolationAlpha(1.0f),
+    m_PhysicsRate(DEFAULT_PHYSICS_RATE), m_MaxSubSteps(DEFAULT_MAX_SUBSTEPS), m_SubStepCount(0), m_NumDroppedSteps(0),
+    m_NumSleeping(0), m_NumSpeculative(0), m_NumRestoredManifolds(0),
+    m_VelocityIterations(DEFAULT_VELOCITY_ITERATIONS), m_PositionIterations(DEFAULT_POSITION_ITERATIONS),
+    m_VelocityPasses(0), m_PositionPasses(0), m_NumUnconvergedSteps(0),
+    m_ThreadCount(std::max((int)std::thread::hardware_concurrency(), 1)),
+    m_ImpulseTolerance(DEFAULT_IMPULSE_TOLERANCE), m_PenetrationTolerance(DEFAULT_PENETRATION_TOLERANCE),
+    m_isSolverConverged(true), m_isContinuous(true), m_isWarmStarting(true), m_isStaticDirty(false), m_isBakeReplacing(false), m_isStaticBaked(false),
+    m_isDeterministic(false),
+    m_isPaused(false), m_isContactRestorePending(false), m_NumRequestedSteps(0)
+{
+    m_pBroadphase = Broadphase::Create(broadphase);
+}
 //=============================================================================
 // ヘルパー関数
 //=============================================================================
@@ -166,6 +187,147 @@ D3DXVECTOR3 PhysicsWorld::ClosestPointOnOBB(const D3DXVECTOR3& point, BoxCollide
 
     return closest;
 }
+//=============================================================================
+// 線分とOBBの最短距離の2乗（交わっていれば0）
+// 箱のローカルでは各軸のはみ出しの2乗の和で、線分が面をまたぐ位置で区切った区間ごとに2次式になるので区間ごとの最小を比べる
+//=============================================================================
+float PhysicsWorld::DistanceSqSegmentOBB(const D3DXVECTOR3& p0, const D3DXVECTOR3& p1, BoxCollider* obb,
+    D3DXVECTOR3& outOnSegment, D3DXVECTOR3& outOnBox)
+{
+    const D3DXMATRIX& R = obb->GetRotation();
+    const D3DXVECTOR3 half = obb->GetScaledSize() * HALF;
+
+    std::array<D3DXVECTOR3, AXIS> axes =
+    {
+        D3DXVECTOR3(R._11, R._12, R._13),
+        D3DXVECTOR3(R._21, R._22, R._23),
+        D3DXVECTOR3(R._31, R._32, R._33)
+    };
+
+    // 箱のローカルでの始点と向き
+    D3DXVECTOR3 rel = p0 - obb->GetPosition();
+    D3DXVECTOR3 dir = p1 - p0;
+    float start[AXIS], delta[AXIS];
+
+    for (int nAxis = 0; nAxis < AXIS; nAxis++)
+    {
+        start[nAxis] = D3DXVec3Dot(&rel, &axes[nAxis]);
+        delta[nAxis] = D3DXVec3Dot(&dir, &axes[nAxis]);
+    }
+
+    // 区切り（両端と、各軸で面をまたぐ位置）
+    float breaks[2 + AXIS * 2];
+    int numBreaks = 0;
+    breaks[numBreaks++] = 0.0f;
+    breaks[numBreaks++] = 1.0f;
+
+    for (int nAxis = 0; nAxis < AXIS; nAxis++)
+    {
+        if (fabsf(delta[nAxis]) < MIN_DISTANCE)
+        {
+            continue;
+        }
+
+        for (float bound : { -half[nAxis], half[nAxis] })
+        {
+            float t = (bound - start[nAxis]) / delta[nAxis];
+
+            if (t > 0.0f && t < 1.0f)
+            {
+                breaks[numBreaks++] = t;
+            }
+        }
+    }
+
+    std::sort(breaks, breaks + numBreaks);
+
+    float bestT = 0.0f;
+    float bestDistSq = FLT_MAX;
+
+    for (int nCnt = 0; nCnt + 1 < numBreaks; nCnt++)
+    {
+        float t0 = breaks[nCnt];
+        float t1 = breaks[nCnt + 1];
+        float mid = (t0 + t1) * HALF;
+
+        // 区間の中ではどの軸がどちらへはみ出すかは変わらないので、中点ではみ出す軸だけの2次式を最小にする
+        float num = 0.0f;
+        float den = 0.0f;
+
+        for (int nAxis = 0; nAxis < AXIS; nAxis++)
+        {
+            float x = start[nAxis] + delta[nAxis] * mid;
+
+            if (x > half[nAxis] || x < -half[nAxis])
+            {
+                float bound = (x > 0.0f) ? half[nAxis] : -half[nAxis];
+                num -= (start[nAxis] - bound) * delta[nAxis];
+                den += delta[nAxis] * delta[nAxis];
+            }
+        }
+
+        // どの軸もはみ出さない区間は箱を通っている
+        if (den <= 0.0f)
+        {
+            bestT = mid;
+            bestDistSq = 0.0f;
+            break;
+        }
+
+        float t = std::clamp(num / den, t0, t1);
+        float distSq = 0.0f;
+
+        for (int nAxis = 0; nAxis < AXIS; nAxis++)
+        {
+            float x = start[nAxis] + delta[nAxis] * t;
+            float over = x - std::clamp(x, -half[nAxis], half[nAxis]);
+            distSq += over * over;
+        }
+
+        if (distSq < bestDistSq)
+        {
+            bestDistSq = distSq;
+            bestT = t;
+        }
+    }
+
+    outOnSegment = p0 + dir * bestT;
+    outOnBox = obb->GetPosition();
+
+    for (int nAxis = 0; nAxis < AXIS; nAxis++)
+    {
+        float x = start[nAxis] + delta[nAxis] * bestT;
+        outOnBox += axes[nAxis] * std::clamp(x, -half[nAxis], half[nAxis]);
+    }
+
+    return bestDistSq;
+}
+//=============================================================================
+// 点をシリンダー（軸方向Y固定）に投影して最近接点を返す
+//=============================================================================
+D3DXVECTOR3 PhysicsWorld::ClosestPointOnCylinder(const D3DXVECTOR3& point, CylinderCollider* cyl)
+{
+    const D3DXVECTOR3& center = cyl->GetPosition();
+    float halfHeight = cyl->GetHeight() * HALF;
+    float radius = cyl->GetRadius();
+
+    D3DXVECTOR3 closest = point;
+    closest.y = std::clamp(point.y, center.y - halfHeight, center.y + halfHeight);
+
+    // 円の外なら縁まで寄せる
+    float dx = point.x - center.x;
+    float dz = point.z - center.z;
+    float distSq = dx * dx + dz * dz;
+
+    if (distSq > radius * radius)
+    {
+        float scale = radius / sqrtf(distSq);
+        closest.x = center.x + dx * scale;
+        closest.z = center.z + dz * scale;
+    }
+
+    return closest;
+}
 
 
 //=============================================================================
@@ -202,110 +364,99 @@ bool PhysicsWorld::CapsuleCapsuleCollision(CapsuleCollider* a, CapsuleCollider*
 
 //=============================================================================
 // カプセル vs OBB
+// 芯と箱の最近接点から押し出し、芯が箱に入っていれば箱の面と芯×箱の軸のうち抜けるまでが一番短い向きへ押し出す
 //=============================================================================
 bool PhysicsWorld::CapsuleBoxCollision(CapsuleCollider* cap, BoxCollider* box, D3DXVECTOR3& outPush)
 {
     // カプセルの上下点
-    D3DXVECTOR3 capTop = cap->GetPosition() + D3DXVECTOR3(0, cap->GetHeight() * HALF, 0);
-    D3DXVECTOR3 capBottom = cap->GetPosition() - D3DXVECTOR3(0, cap->GetHeight() * HALF, 0);
-
-    // OBB の最近接点（カプセル中心を基準に仮取得）
-    D3DXVECTOR3 closestBox = ClosestPointOnOBB(cap->GetPosition(), box);
+    D3DXVECTOR3 half(0.0f, cap->GetHalfHeight(), 0.0f);
+    D3DXVECTOR3 capTop = cap->GetPosition() + half;
+    D3DXVECTOR3 capBottom = cap->GetPosition() - half;
+    float radius = cap->GetRadius();
 
-    // カプセル線分上で最も OBB 側に近い点を取得
-    D3DXVECTOR3 closestCapsule = ClosestPointOnLineSegment(closestBox, capTop, capBottom);
+    // 箱を囲む球に届かなければ当たらない
+    D3DXVECTOR3 boxHalf = box->GetScaledSize() * HALF;
+    D3DXVECTOR3 toBox = box->GetPosition() - ClosestPointOnLineSegment(box->GetPosition(), capTop, capBottom);
+    float reach = radius + D3DXVec3Length(&boxHalf);
 
-    // 衝突方向
-    D3DXVECTOR3 delta = closestCapsule - closestBox;
-    float distSq = D3DXVec3LengthSq(&delta);
+    if (D3DXVec3LengthSq(&toBox) >= reach * reach)
+    {
+        return false;
+    }
 
-    // 衝突してたら押し返す
-    float radius = cap->GetRadius();
-    float radiusSq = radius * radius;
+    // 芯と箱の最近接点
+    D3DXVECTOR3 onSegment, onBox;
+    float distSq = DistanceSqSegmentOBB(capBottom, capTop, box, onSegment, onBox);
 
-    if (distSq < radiusSq)
+    if (distSq >= radius * radius)
     {
-        float len = sqrtf(distSq);
+        return false;
+    }
 
-        if (len > 1e-6f)
-        {
-            // 正規化した方向 × (めり込み量)
-            D3DXVECTOR3 normal = delta / len;
-            outPush = -normal * (radius - len);
-        }
-        else
-        {
-            // 衝突点が完全に一致してる場合（沈み込み）
-            outPush = D3DXVECTOR3(0, radius, 0);
-        }
+    float len = sqrtf(distSq);
 
+    if (len > MIN_DISTANCE)
+    {
+        // 正規化した方向 × (めり込み量)
+        D3DXVECTOR3 normal = (onSegment - onBox) / len;
+        outPush = -normal * (radius - len);
         return true;
     }
 
-    return false;
-}
-//=============================================================================
-// シリンダー vs Box
-//=============================================================================
-bool PhysicsWorld::CylinderBoxCollision(CylinderCollider* cyl, BoxCollider* box, D3DXVECTOR3& outPush)
-{
-    // Cylinder 情報
-    D3DXVECTOR3 cylPos = cyl->GetPosition();         // Cylinderの中心
-    float radius = cyl->GetRadius();
-    float halfHeight = cyl->GetHeight() * HALF;
-
-    // Box 情報（OBB対応）
-    D3DXVECTOR3 boxCenter = box->GetPosition();
-    const D3DXMATRIX& boxRot = box->GetRotation();
-    D3DXVECTOR3 boxHalfExtents = box->GetScaledSize() * HALF;
-
-    // Cylinderの中心をOBBローカルへ変換
-    D3DXMATRIX invRot;
-    D3DXMatrixTranspose(&invRot, &boxRot);
-    D3DXVECTOR3 localPos = cylPos - boxCenter;
-    D3DXVec3TransformNormal(&localPos, &localPos, &invRot);
+    // 芯が箱に入っている（分離軸の候補は箱の3軸と、芯の向きと箱の3軸の外積）
+    const D3DXMATRIX& R = box->GetRotation();
+    D3DXVECTOR3 segDir = capTop - capBottom;
 
-    // まずXY平面（地面平面）での最近接点を計算（高さ判定とは別）
-    D3DXVECTOR3 closestLocal = localPos;
-    closestLocal.x = std::clamp(closestLocal.x, -boxHalfExtents.x, boxHalfExtents.x);
-    closestLocal.z = std::clamp(closestLocal.z, -boxHalfExtents.z, boxHalfExtents.z);
+    std::array<D3DXVECTOR3, AXIS * 2> axes =
+    {
+        D3DXVECTOR3(R._11, R._12, R._13),
+        D3DXVECTOR3(R._21, R._22, R._23),
+        D3DXVECTOR3(R._31, R._32, R._33)
+    };
+    int numAxes = AXIS;
 
-    // 高さ方向の判定（Cylinder軸Yだけ特別扱い）
-    if (localPos.y > boxHalfExtents.y + halfHeight || localPos.y < -boxHalfExtents.y - halfHeight)
+    for (int nCnt = 0; nCnt < AXIS; nCnt++)
     {
-        return false;  // 高さが完全にはみ出してるなら当たらない
-    }
+        D3DXVECTOR3 cross;
+        D3DXVec3Cross(&cross, &segDir, &axes[nCnt]);
+        float crossLenSq = D3DXVec3LengthSq(&cross);
 
-    // ローカル空間からワールドへ戻す
-    D3DXVECTOR3 closestWorld = closestLocal;
-    D3DXVec3TransformNormal(&closestWorld, &closestWorld, &boxRot);
-    closestWorld += boxCenter;
+        // 芯と平行な軸は面の軸と同じになるので除く
+        if (crossLenSq > MIN_DISTANCE)
+        {
+            axes[numAxes++] = cross / sqrtf(crossLenSq);
+        }
+    }
 
-    // CylinderのXZ円とBoxとの衝突判定
-    D3DXVECTOR3 delta = cylPos - closestWorld;
-    delta.y = 0; // 高さ方向は円判定に含めない
-    float distSq = D3DXVec3LengthSq(&delta);
+    float minDepth = FLT_MAX;
 
-    if (distSq < radius * radius)
+    for (int nCnt = 0; nCnt < numAxes; nCnt++)
     {
-        float dist = sqrtf(distSq);
+        float boxMin, boxMax;
+        ProjectOBB(axes[nCnt], box, boxMin, boxMax);
 
-        if (dist > 1e-6f)
+        float bottomProj = D3DXVec3Dot(&capBottom, &axes[nCnt]);
+        float topProj = D3DXVec3Dot(&capTop, &axes[nCnt]);
+
+        // 芯を軸の正の向きへ抜く量と負の向きへ抜く量（半径の分も離す）
+        float positiveDepth = boxMax - std::min(bottomProj, topProj) + radius;
+        float negativeDepth = std::max(bottomProj, topProj) - boxMin + radius;
+
+        if (positiveDepth < minDepth)
         {
-            outPush = delta * ((radius - dist) / dist);
+            minDepth = positiveDepth;
+            outPush = -axes[nCnt] * positiveDepth;
         }
-        else
+
+        if (negativeDepth < minDepth)
         {
-            // 真下 or 真上から来た場合
-            outPush = D3DXVECTOR3(0, radius, 0);
+            minDepth = negativeDepth;
+            outPush = axes[nCnt] * negativeDepth;
         }
-
-        return true;
     }
 
-    return false;
+    return true;
 }
-
 //=============================================================================
 // シリンダー vs カプセル
 //=============================================================================
@@ -363,23 +514,6 @@ bool PhysicsWorld::CylinderCapsuleCollision(CylinderCollider* cyl, CapsuleCollid
     return false;
 }
 
-//=============================================================================
-// シリンダー vs シリンダー
-//=============================================================================
-bool PhysicsWorld::CylinderCylinderCollision(CylinderCollider* a, CylinderCollider* b, D3DXVECTOR3& outPush)
-{
-    D3DXVECTOR3 delta = b->GetPosition() - a->GetPosition();
-    float dist = sqrtf(delta.x * delta.x + delta.z * delta.z);
-    float radiusSum = a->GetRadius() + b->GetRadius();
-    if (dist < radiusSum)
-    {
-        D3DXVECTOR3 V = delta * (radiusSum - dist);
-        D3DXVec3Normalize(&outPush, &V);
-        return true;
-    }
-    return false;
-}
-
 //=============================================================================
 // スフィア vs ボックス
 //=============================================================================
@@ -472,28 +606,62 @@ bool PhysicsWorld::SphereCapsuleCollision(SphereCollider* sphere, CapsuleCollide
 
 //=============================================================================
 // スフィア vs シリンダー（軸方向Y固定）
+// 中心がシリンダーの外なら表面の最近接点から、中なら側面と上下の面のうち近い方へ押し出す
 //=============================================================================
 bool PhysicsWorld::SphereCylinderCollision(SphereCollider* sphere, CylinderCollider* cylinder, D3DXVECTOR3& outPush)
 {
-    D3DXVECTOR3 cylPos = cylinder->GetPosition();
+    D3DXVECTOR3 local = sphere->GetPosition() - cylinder->GetPosition();
     float halfHeight = cylinder->GetHeight() * 0.5f;
+    float cylRadius = cylinder->GetRadius();
+    float radius = sphere->GetRadius();
 
-    float clampedY = std::max(cylPos.y - halfHeight, std::min(sphere->GetPosition().y, cylPos.y + halfHeight));
-    D3DXVECTOR3 delta = sphere->GetPosition() - D3DXVECTOR3(cylPos.x, clampedY, cylPos.z);
+    float radialSq = local.x * local.x + local.z * local.z;
+    float radial = sqrtf(radialSq);
 
-    float distSq = delta.x * delta.x + delta.z * delta.z;
-    float radiusSum = sphere->GetRadius() + cylinder->GetRadius();
+    if (fabsf(local.y) <= halfHeight && radial <= cylRadius)
+    {
+        // 中心が中にある（側面と上下の面のうち浅い方）
+        float sideDepth = cylRadius - radial + radius;
+        float capDepth = halfHeight - fabsf(local.y) + radius;
 
-    if (distSq < radiusSum * radiusSum)
+        if (capDepth < sideDepth)
+        {
+            outPush = D3DXVECTOR3(0.0f, (local.y > 0.0f) ? -capDepth : capDepth, 0.0f);
+        }
+        else if (radial > 1e-6f)
+        {
+            outPush = D3DXVECTOR3(-local.x, 0.0f, -local.z) * (sideDepth / radial);
+        }
+        else
+        {
+            outPush = D3DXVECTOR3(sideDepth, 0, 0);
+        }
+
+        return true;
+    }
+
+    // シリンダーの表面の最近接点（高さと半径の範囲に収める）
+    D3DXVECTOR3 closest(local.x, std::max(-halfHeight, std::min(local.y, halfHeight)), local.z);
+
+    if (radial > cylRadius)
+    {
+        closest.x *= cylRadius / radial;
+        closest.z *= cylRadius / radial;
+    }
+
+    D3DXVECTOR3 delta = local - closest;
+    float distSq = D3DXVec3LengthSq(&delta);
+
+    if (distSq < radius * radius)
     {
         float dist = sqrtf(distSq);
         if (dist > 1e-6f)
         {
-            outPush = -delta * ((radiusSum - dist) / dist);
+            outPush = -delta * ((radius - dist) / dist);
         }
         else
         {
-            outPush = D3DXVECTOR3(radiusSum, 0, 0);
+            outPush = D3DXVECTOR3(radius, 0, 0);
         }
 
         return true;
@@ -555,7 +723,8 @@ bool PhysicsWorld::BoxBoxCollision(BoxCollider* a, BoxCollider* b, D3DXVECTOR3&
             D3DXVECTOR3 axis;
             D3DXVec3Cross(&axis, &axes[nCnt], &axes[3 + nCnt2]);
 
-            if (D3DXVec3LengthSq(&axis) > 1e-6f)
+            // ほぼ平行な辺の外積は向きが不安定なので使わない
+            if (D3DXVec3LengthSq(&axis) > PARALLEL_EPSILON)
             {
                 D3DXVec3Normalize(&axis, &axis);
                 axes[idx++] = axis;
@@ -579,7 +748,10 @@ bool PhysicsWorld::BoxBoxCollision(BoxCollider* a, BoxCollider* b, D3DXVECTOR3&
             return false; // 隙間あり → 衝突なし
         }
 
-        if (overlap < minOverlap)
+        // 面の軸を優先し、辺同士の軸ははっきり浅いときだけ選ぶ
+        float bias = (nCnt >= 6) ? EDGE_AXIS_BIAS : 1.0f;
+
+        if (overlap * bias < minOverlap)
         {
             minOverlap = overlap;
             smallestAxis = axes[nCnt];
@@ -599,246 +771,4634 @@ bool PhysicsWorld::BoxBoxCollision(BoxCollider* a, BoxCollider* b, D3DXVECTOR3&
 }
 
 //=============================================================================
-// 2体の簡易AABB押し戻し
+// 三角形上の最近接点（頂点・辺・面の領域で場合分け）
 //=============================================================================
-bool PhysicsWorld::CheckCollision(RigidBody* a, RigidBody* b, D3DXVECTOR3& outPush)
+D3DXVECTOR3 PhysicsWorld::ClosestPointOnTriangle(const D3DXVECTOR3& point, const D3DXVECTOR3& a, const D3DXVECTOR3& b, const D3DXVECTOR3& c)
 {
-    auto colA = a->GetCollider();
-    auto colB = b->GetCollider();
+    D3DXVECTOR3 ab = b - a;
+    D3DXVECTOR3 ac = c - a;
+    D3DXVECTOR3 ap = point - a;
 
-    if (colA->GetType() == Collider::BOX && colB->GetType() == Collider::BOX)
-    {
-        return BoxBoxCollision(static_cast<BoxCollider*>(colA.get()), static_cast<BoxCollider*>(colB.get()), outPush);
-    }
-    else if (colA->GetType() == Collider::CAPSULE && colB->GetType() == Collider::BOX)
-    {
-        return CapsuleBoxCollision(static_cast<CapsuleCollider*>(colA.get()), static_cast<BoxCollider*>(colB.get()), outPush);
-    }
-    else if (colA->GetType() == Collider::BOX && colB->GetType() == Collider::CAPSULE)
+    float d1 = D3DXVec3Dot(&ab, &ap);
+    float d2 = D3DXVec3Dot(&ac, &ap);
+
+    // 頂点aの領域
+    if (d1 <= 0.0f && d2 <= 0.0f)
     {
-        bool collided = CapsuleBoxCollision(static_cast<CapsuleCollider*>(colB.get()), static_cast<BoxCollider*>(colA.get()), outPush);
-        outPush = -outPush;
-        return collided;
+        return a;
     }
-    else if (colA->GetType() == Collider::CAPSULE && colB->GetType() == Collider::CAPSULE)
+
+    D3DXVECTOR3 bp = point - b;
+    float d3 = D3DXVec3Dot(&ab, &bp);
+    float d4 = D3DXVec3Dot(&ac, &bp);
+
+    // 頂点bの領域
+    if (d3 >= 0.0f && d4 <= d3)
     {
-        return CapsuleCapsuleCollision(static_cast<CapsuleCollider*>(colA.get()), static_cast<CapsuleCollider*>(colB.get()), outPush);
+        return b;
     }
-    else if (colA->GetType() == Collider::CYLINDER && colB->GetType() == Collider::BOX)
+
+    // 辺abの領域
+    float vc = d1 * d4 - d3 * d2;
+
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
     {
-        return CylinderBoxCollision(static_cast<CylinderCollider*>(colA.get()), static_cast<BoxCollider*>(colB.get()), outPush);
+        return a + ab * (d1 / (d1 - d3));
     }
-    else if (colA->GetType() == Collider::BOX && colB->GetType() == Collider::CYLINDER)
+
+    D3DXVECTOR3 cp = point - c;
+    float d5 = D3DXVec3Dot(&ab, &cp);
+    float d6 = D3DXVec3Dot(&ac, &cp);
+
+    // 頂点cの領域
+    if (d6 >= 0.0f && d5 <= d6)
     {
-        bool collided = CylinderBoxCollision(static_cast<CylinderCollider*>(colB.get()), static_cast<BoxCollider*>(colA.get()), outPush);
-        outPush = -outPush;
-        return collided;
+        return c;
     }
-    else if (colA->GetType() == Collider::CYLINDER && colB->GetType() == Collider::CAPSULE)
+
+    // 辺acの領域
+    float vb = d5 * d2 - d1 * d6;
+
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
     {
-        return CylinderCapsuleCollision(static_cast<CylinderCollider*>(colA.get()), static_cast<CapsuleCollider*>(colB.get()), outPush);
+        return a + ac * (d2 / (d2 - d6));
     }
-    else if (colA->GetType() == Collider::CAPSULE && colB->GetType() == Collider::CYLINDER)
+
+    // 辺bcの領域
+    float va = d3 * d6 - d5 * d4;
+
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
     {
-        bool collided = CylinderCapsuleCollision(static_cast<CylinderCollider*>(colB.get()), static_cast<CapsuleCollider*>(colA.get()), outPush);
-        outPush = -outPush;
-        return collided;
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
     }
-    else if (colA->GetType() == Collider::CYLINDER && colB->GetType() == Collider::CYLINDER)
+
+    // 面の領域
+    float denom = 1.0f / (va + vb + vc);
+
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+//=============================================================================
+// 線分と三角形の最短距離の2乗（面を貫いていれば0、それ以外は端点と3辺の近い方）
+//=============================================================================
+float PhysicsWorld::DistanceSqSegmentTriangle(const D3DXVECTOR3& p0, const D3DXVECTOR3& p1, const D3DXVECTOR3* tri,
+    D3DXVECTOR3& outOnSegment, D3DXVECTOR3& outOnTriangle)
+{
+    D3DXVECTOR3 e1 = tri[1] - tri[0];
+    D3DXVECTOR3 e2 = tri[2] - tri[0];
+    D3DXVECTOR3 n;
+    D3DXVec3Cross(&n, &e1, &e2);
+
+    D3DXVECTOR3 r0 = p0 - tri[0];
+    D3DXVECTOR3 r1 = p1 - tri[0];
+    float s0 = D3DXVec3Dot(&r0, &n);
+    float s1 = D3DXVec3Dot(&r1, &n);
+
+    // 線分が面の両側にあれば面との交点が三角形の中か調べる
+    if (s0 * s1 <= 0.0f && s0 != s1)
     {
-        return CylinderCylinderCollision(static_cast<CylinderCollider*>(colA.get()), static_cast<CylinderCollider*>(colB.get()), outPush);
+        D3DXVECTOR3 cross = p0 + (p1 - p0) * (s0 / (s0 - s1));
+        D3DXVECTOR3 onTri = ClosestPointOnTriangle(cross, tri[0], tri[1], tri[2]);
+        D3DXVECTOR3 diff = cross - onTri;
+
+        if (D3DXVec3LengthSq(&diff) < MIN_DISTANCE)
+        {
+            outOnSegment = cross;
+            outOnTriangle = onTri;
+            return 0.0f;
+        }
     }
-    else if (colA->GetType() == Collider::SPHERE && colB->GetType() == Collider::BOX)
+
+    // 端点から面へ
+    outOnSegment = p0;
+    outOnTriangle = ClosestPointOnTriangle(p0, tri[0], tri[1], tri[2]);
+    D3DXVECTOR3 diff = p0 - outOnTriangle;
+    float best = D3DXVec3LengthSq(&diff);
+
+    if (p1 != p0)
     {
-        return SphereBoxCollision(static_cast<SphereCollider*>(colA.get()), static_cast<BoxCollider*>(colB.get()), outPush);
+        D3DXVECTOR3 onTri = ClosestPointOnTriangle(p1, tri[0], tri[1], tri[2]);
+        diff = p1 - onTri;
+        float distSq = D3DXVec3LengthSq(&diff);
+
+        if (distSq < best)
+        {
+            best = distSq;
+            outOnSegment = p1;
+            outOnTriangle = onTri;
+        }
     }
-    else if (colA->GetType() == Collider::BOX && colB->GetType() == Collider::SPHERE)
+
+    // 線分と3辺
+    for (int nCnt = 0; nCnt < AXIS; nCnt++)
     {
-        bool collided = SphereBoxCollision(static_cast<SphereCollider*>(colB.get()), static_cast<BoxCollider*>(colA.get()), outPush);
-        outPush = -outPush;
-        return collided;
+        D3DXVECTOR3 onSeg, onEdge;
+        float distSq = DistanceSqSegmentSegment(p0, p1, tri[nCnt], tri[(nCnt + 1) % AXIS], &onSeg, &onEdge);
+
+        if (distSq < best)
+        {
+            best = distSq;
+            outOnSegment = onSeg;
+            outOnTriangle = onEdge;
+        }
     }
-    else if (colA->GetType() == Collider::SPHERE && colB->GetType() == Collider::CAPSULE)
+
+    return best;
+}
+
+//=============================================================================
+// 判定用の芯の取得処理（球は点、カプセルは線分、シリンダーは同じ高さ・半径のカプセルで近似）
+// 判定関数と同じく軸は縦向き
+//=============================================================================
+bool PhysicsWorld::GetCollisionCore(Collider* col, D3DXVECTOR3& outSegA, D3DXVECTOR3& outSegB, float& outRadius)
+{
+    switch (col->GetType())
     {
-        return SphereCapsuleCollision(static_cast<SphereCollider*>(colA.get()), static_cast<CapsuleCollider*>(colB.get()), outPush);
-    }
-    else if (colA->GetType() == Collider::CAPSULE && colB->GetType() == Collider::SPHERE)
+    case Collider::SPHERE:
     {
-        bool collided = SphereCapsuleCollision(static_cast<SphereCollider*>(colB.get()), static_cast<CapsuleCollider*>(colA.get()), outPush);
-        outPush = -outPush;
-        return collided;
+        SphereCollider* sphere = static_cast<SphereCollider*>(col);
+        outSegA = outSegB = sphere->GetPosition();
+        outRadius = sphere->GetRadius();
+        return true;
     }
-    else if (colA->GetType() == Collider::SPHERE && colB->GetType() == Collider::CYLINDER)
+    case Collider::CAPSULE:
     {
-        return SphereCylinderCollision(static_cast<SphereCollider*>(colA.get()), static_cast<CylinderCollider*>(colB.get()), outPush);
+        CapsuleCollider* capsule = static_cast<CapsuleCollider*>(col);
+        D3DXVECTOR3 half(0.0f, capsule->GetHalfHeight(), 0.0f);
+        outSegA = capsule->GetPosition() - half;
+        outSegB = capsule->GetPosition() + half;
+        outRadius = capsule->GetRadius();
+        return true;
     }
-    else if (colA->GetType() == Collider::CYLINDER && colB->GetType() == Collider::SPHERE)
+    case Collider::CYLINDER:
     {
-        bool collided = SphereCylinderCollision(static_cast<SphereCollider*>(colB.get()), static_cast<CylinderCollider*>(colA.get()), outPush);
-        outPush = -outPush;
-        return collided;
+        CylinderCollider* cylinder = static_cast<CylinderCollider*>(col);
+        D3DXVECTOR3 half(0.0f, std::max(cylinder->GetHeight() * HALF - cylinder->GetRadius(), 0.0f), 0.0f);
+        outSegA = cylinder->GetPosition() - half;
+        outSegB = cylinder->GetPosition() + half;
+        outRadius = cylinder->GetRadius();
+        return true;
     }
-    else if (colA->GetType() == Collider::SPHERE && colB->GetType() == Collider::SPHERE)
-    {
-        return SphereSphereCollision(static_cast<SphereCollider*>(colA.get()), static_cast<SphereCollider*>(colB.get()), outPush);
+    default:
+        return false;
     }
-
-    return false;
 }
-//=============================================================================
-// 接触点の取得
-//=============================================================================
-D3DXVECTOR3 PhysicsWorld::GetActualCollisionPoint(RigidBody* a, RigidBody* b, const D3DXVECTOR3& push)
-{
-    // ブロックの中心(位置)とハーフサイズを取得
-    D3DXVECTOR3 posA = a->GetPosition();
-    D3DXVECTOR3 posB = b->GetPosition();
-    D3DXVECTOR3 halfA = a->GetScale() * HALF;
-    D3DXVECTOR3 halfB = b->GetScale() * HALF;
-
-    // 衝突面に近い中心点
-    D3DXVECTOR3 contactA = posA;
-    contactA.x += push.x > 0 ? halfA.x : -halfA.x;
-    contactA.y += push.y > 0 ? halfA.y : -halfA.y;
-    contactA.z += push.z > 0 ? halfA.z : -halfA.z;
 
-    D3DXVECTOR3 contactB = posB;
-    contactB.x += push.x > 0 ? -halfB.x : halfB.x;
-    contactB.y += push.y > 0 ? -halfB.y : halfB.y;
-    contactB.z += push.z > 0 ? -halfB.z : halfB.z;
-
-    // 中点を返す
-    return (contactA + contactB) * HALF;
-}
 //=============================================================================
-// 端乗り判定関数
+// 芯（線分＋半径） vs メッシュ
+// 芯が裏にある三角形は無視し、三角形ごとのめり込みの一番深いものを押し戻しにする
 //=============================================================================
-bool PhysicsWorld::IsUnstableStack(RigidBody* A, RigidBody* B)
+bool PhysicsWorld::CoreMeshCollision(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, MeshCollider* mesh, D3DXVECTOR3& outPush)
 {
-    D3DXVECTOR3 posA = A->GetPosition();
-    D3DXVECTOR3 posB = B->GetPosition();
-    D3DXVECTOR3 diff = posA - posB;
+    // 候補の三角形（スレッドごとに使い回す）
+    thread_local std::vector<int> triangles;
+    triangles.clear();
 
-    D3DXVECTOR3 halfA = A->GetScale() * HALF;
-    D3DXVECTOR3 halfB = B->GetScale() * HALF;
+    D3DXVECTOR3 extent(radius, radius, radius);
+    AABB box;
+    D3DXVec3Minimize(&box.min, &segA, &segB);
+    D3DXVec3Maximize(&box.max, &segA, &segB);
+    box.min -= extent;
+    box.max += extent;
 
-    float limitX = (halfA.x + halfB.x) * 0.6f; // ズレ閾値
-    float limitZ = (halfA.z + halfB.z) * 0.6f;
+    mesh->QueryTriangles(box, triangles);
 
-    return (fabsf(diff.x) > limitX || fabsf(diff.z) > limitZ);
-}
-//=============================================================================
-// 当たり判定シミュレーション
-//=============================================================================
-void PhysicsWorld::StepSimulation(float dt)
-{
-    // 移動反映
-    for (auto& body : m_Bodies)
+    float bestDepth = 0.0f;
+    D3DXVECTOR3 bestDir = INIT_VEC3;
+    bool isHit = false;
+
+    for (int triangle : triangles)
     {
-        body->SetOnGround(false);
+        D3DXVECTOR3 tri[AXIS], n;
+        mesh->GetTriangle(triangle, tri, n);
 
-        if (body->IsDynamic())
+        D3DXVECTOR3 r0 = segA - tri[0];
+        D3DXVECTOR3 r1 = segB - tri[0];
+        float s0 = D3DXVec3Dot(&r0, &n);
+        float s1 = D3DXVec3Dot(&r1, &n);
+
+        // 芯がまるごと裏にあれば当たらない
+        if (std::max(s0, s1) < 0.0f)
         {
-            body->Integrate(dt, m_Gravity);
+            continue;
         }
-    }
 
-    // 衝突解決の反復
-    for (int iter = 0; iter < ITERATIONS; iter++)
-    {
-        for (size_t nCnt = 0; nCnt < m_Bodies.size(); nCnt++)
+        D3DXVECTOR3 onSegment, onTriangle;
+        float distSq = DistanceSqSegmentTriangle(segA, segB, tri, onSegment, onTriangle);
+
+        if (distSq >= radius * radius)
         {
-            for (size_t nCnt2 = nCnt + 1; nCnt2 < m_Bodies.size(); nCnt2++)
-            {
-                RigidBody* A = m_Bodies[nCnt].get();
-                RigidBody* B = m_Bodies[nCnt2].get();
-                D3DXVECTOR3 push;
+            continue;
+        }
 
-                if (CheckCollision(A, B, push))
-                {
-                    // 衝突点・法線を求める簡易版
-                    D3DXVECTOR3 normal = INIT_VEC3;
-                    D3DXVec3Normalize(&normal, &push);
+        D3DXVECTOR3 delta = onSegment - onTriangle;
+        float dist = sqrtf(distSq);
+        D3DXVECTOR3 dir = n;
+        float depth = 0.0f;
 
-                    // ここで接地判定
-                    if (normal.y > 0.7f)
-                    {
-                        if (A->IsDynamic()) A->SetOnGround(true);
-                        if (B->IsDynamic()) B->SetOnGround(true);
-                    }
+        if (dist < MIN_DISTANCE || D3DXVec3Dot(&delta, &n) >= dist * FACE_CONTACT_DOT)
+        {
+            // 面の領域なら面の法線の向きに、芯の一番深い端まで押し戻す
+            depth = radius - std::min(s0, s1);
+        }
+        else
+        {
+            // 辺・頂点の領域なら最近接点の向き（裏から回り込む向きは使わない）
+            dir = delta / dist;
 
-                    // 相対速度
-                    D3DXVECTOR3 relVel = B->GetVelocity() - A->GetVelocity();
-                    float velAlongNormal = D3DXVec3Dot(&relVel, &normal);
+            if (D3DXVec3Dot(&dir, &n) < 0.0f)
+            {
+                continue;
+            }
 
-                    // 衝突反発（インパルス）
-                    float e = std::min(A->GetRestitution(), B->GetRestitution());
-                    float t = -(1 + e) * velAlongNormal / (1 / A->GetMass() + 1 / B->GetMass());
+            depth = radius - dist;
+        }
 
-                    D3DXVECTOR3 impulse = normal * t;
+        if (!isHit || depth > bestDepth)
+        {
+            bestDepth = depth;
+            bestDir = dir;
+            isHit = true;
+        }
+    }
 
-                    D3DXVECTOR3 contactPoint = GetActualCollisionPoint(A, B, push);
-                    D3DXVECTOR3 relPosA = contactPoint - A->GetPosition();
-                    D3DXVECTOR3 relPosB = contactPoint - B->GetPosition();
+    if (!isHit)
+    {
+        return false;
+    }
 
-                    A->ApplyImpulse(-impulse, relPosA/*D3DXVECTOR3(0, 0, 0)*/);
-                    B->ApplyImpulse(impulse, relPosB/*D3DXVECTOR3(0, 0, 0)*/);
+    // 押し戻し方向は芯→メッシュ
+    outPush = -bestDir * bestDepth;
+    return true;
+}
 
-                    // 位置補正
-                    if (A->IsDynamic() && B->IsDynamic())
-                    {
-                        // 両方ダイナミックなら半分ずつ移動
-                        A->SetTransform(A->GetPosition() - push * 0.5f, A->GetOrientation(), A->GetScale());
-                        B->SetTransform(B->GetPosition() + push * 0.5f, B->GetOrientation(), B->GetScale());
-                    }
-                    else if (A->IsDynamic() && !B->IsDynamic())
-                    {
-                        // B が静的なら A だけ動かす
-                        A->SetTransform(A->GetPosition() - push, A->GetOrientation(), A->GetScale());
-                    }
-                    else if (!A->IsDynamic() && B->IsDynamic())
-                    {
-                        // A が静的なら B だけ動かす
-                        B->SetTransform(B->GetPosition() + push, B->GetOrientation(), B->GetScale());
-                    }
+//=============================================================================
+// ボックス vs メッシュ（三角形ごとに13軸の分離軸判定）
+// 箱の中心が裏にある三角形は無視し、三角形ごとの最小の重なりの一番大きいものを押し戻しにする
+//=============================================================================
+bool PhysicsWorld::BoxMeshCollision(BoxCollider* box, MeshCollider* mesh, D3DXVECTOR3& outPush)
+{
+    D3DXVECTOR3 axes[AXIS];
+    float half[AXIS];
+    GetBoxFrame(box, axes, half);
+
+    const D3DXVECTOR3& center = box->GetPosition();
+
+    thread_local std::vector<int> triangles;
+    triangles.clear();
+    mesh->QueryTriangles(box->GetAABB(), triangles);
+
+    float bestDepth = 0.0f;
+    D3DXVECTOR3 bestAxis = INIT_VEC3;
+    bool isHit = false;
+
+    for (int triangle : triangles)
+    {
+        D3DXVECTOR3 tri[AXIS], n;
+        mesh->GetTriangle(triangle, tri, n);
+
+        D3DXVECTOR3 toCenter = center - tri[0];
+
+        if (D3DXVec3Dot(&toCenter, &n) < 0.0f)
+        {
+            continue;
+        }
+
+        // 面の法線、箱の3軸、三角形の3辺と箱の3軸の外積
+        std::array<D3DXVECTOR3, 13> testAxes;
+        int numAxes = 0;
+        testAxes[numAxes++] = n;
+
+        for (int nCnt = 0; nCnt < AXIS; nCnt++)
+        {
+            testAxes[numAxes++] = axes[nCnt];
+        }
+
+        for (int nEdge = 0; nEdge < AXIS; nEdge++)
+        {
+            D3DXVECTOR3 edge = tri[(nEdge + 1) % AXIS] - tri[nEdge];
+            D3DXVec3Normalize(&edge, &edge);
+
+            for (int nCnt = 0; nCnt < AXIS; nCnt++)
+            {
+                D3DXVECTOR3 axis;
+                D3DXVec3Cross(&axis, &edge, &axes[nCnt]);
+
+                if (D3DXVec3LengthSq(&axis) > PARALLEL_EPSILON)
+                {
+                    D3DXVec3Normalize(&axis, &axis);
+                    testAxes[numAxes++] = axis;
                 }
             }
         }
+
+        float minOverlap = FLT_MAX;
+        D3DXVECTOR3 smallestAxis = n;
+        bool isSeparated = false;
+
+        for (int nCnt = 0; nCnt < numAxes; nCnt++)
+        {
+            const D3DXVECTOR3& axis = testAxes[nCnt];
+
+            float boxCenter = D3DXVec3Dot(&center, &axis);
+            float boxRadius = 0.0f;
+
+            for (int nAxis = 0; nAxis < AXIS; nAxis++)
+            {
+                boxRadius += half[nAxis] * fabsf(D3DXVec3Dot(&axes[nAxis], &axis));
+            }
+
+            float triMin = FLT_MAX, triMax = -FLT_MAX;
+
+            for (int nVtx = 0; nVtx < AXIS; nVtx++)
+            {
+                float proj = D3DXVec3Dot(&tri[nVtx], &axis);
+                triMin = std::min(triMin, proj);
+                triMax = std::max(triMax, proj);
+            }
+
+            // 軸のどちらへ押し出すと浅いか（三角形は平らなので区間の重なりの長さではなく押し出す量で比べる）
+            // 面の法線は表へだけ押し出す
+            float pushPlus = triMax - (boxCenter - boxRadius);
+            float pushMinus = (boxCenter + boxRadius) - triMin;
+            float overlap = (nCnt == 0) ? pushPlus : std::min(pushPlus, pushMinus);
+
+            if (overlap <= 0.0f)
+            {
+                isSeparated = true;
+                break;
+            }
+
+            // 面・箱の軸を優先し、辺同士の軸ははっきり浅いときだけ選ぶ
+            float bias = (nCnt >= 1 + AXIS) ? EDGE_AXIS_BIAS : 1.0f;
+
+            if (overlap * bias < minOverlap)
+            {
+                minOverlap = overlap;
+                smallestAxis = (overlap == pushPlus) ? axis : -axis;
+            }
+        }
+
+        if (isSeparated)
+        {
+            continue;
+        }
+
+        if (!isHit || minOverlap > bestDepth)
+        {
+            bestDepth = minOverlap;
+            bestAxis = smallestAxis;
+            isHit = true;
+        }
     }
 
-    // 最終補正
-    for (auto& body : m_Bodies)
+    if (!isHit)
+    {
+        return false;
+    }
+
+    // 押し戻し方向は箱→メッシュ
+    outPush = -bestAxis * bestDepth;
+    return true;
+}
+
+//=============================================================================
+// カプセル vs メッシュ
+//=============================================================================
+bool PhysicsWorld::CapsuleMeshCollision(CapsuleCollider* cap, MeshCollider* mesh, D3DXVECTOR3& outPush)
+{
+    D3DXVECTOR3 segA, segB;
+    float radius = 0.0f;
+    GetCollisionCore(cap, segA, segB, radius);
+
+    return CoreMeshCollision(segA, segB, radius, mesh, outPush);
+}
+
+//=============================================================================
+// シリンダー vs メッシュ（同じ高さ・半径のカプセルで近似）
+//=============================================================================
+bool PhysicsWorld::CylinderMeshCollision(CylinderCollider* cyl, MeshCollider* mesh, D3DXVECTOR3& outPush)
+{
+    D3DXVECTOR3 segA, segB;
+    float radius = 0.0f;
+    GetCollisionCore(cyl, segA, segB, radius);
+
+    return CoreMeshCollision(segA, segB, radius, mesh, outPush);
+}
+
+//=============================================================================
+// スフィア vs メッシュ
+//=============================================================================
+bool PhysicsWorld::SphereMeshCollision(SphereCollider* sphere, MeshCollider* mesh, D3DXVECTOR3& outPush)
+{
+    return CoreMeshCollision(sphere->GetPosition(), sphere->GetPosition(), sphere->GetRadius(), mesh, outPush);
+}
+
+//=============================================================================
+// メッシュ vs メッシュ（どちらも静的なので判定しない）
+//=============================================================================
+bool PhysicsWorld::MeshMeshCollision(MeshCollider* /*a*/, MeshCollider* /*b*/, D3DXVECTOR3& outPush)
+{
+    outPush = INIT_VEC3;
+    return false;
+}
+//=============================================================================
+// 複合 vs 何でも
+// AABBの重なる子だけを子の型の判定関数で調べ、一番深い子の押し戻しを全体の押し戻しにする（相手も複合なら子同士まで降りる）
+//=============================================================================
+bool PhysicsWorld::CompoundCollision(CompoundCollider* compound, Collider* other, D3DXVECTOR3& outPush)
+{
+    outPush = INIT_VEC3;
+
+    AABB otherBox = other->GetAABB();
+    float bestDepthSq = -1.0f;
+
+    for (int nCnt = 0; nCnt < compound->GetChildCount(); nCnt++)
     {
-        if (!body->IsDynamic())
+        Collider* child = compound->GetChild(nCnt);
+
+        if (!child->GetAABB().Overlaps(otherBox))
         {
             continue;
         }
 
-        if (body->IsOnGround())
+        D3DXVECTOR3 push;
+
+        if (!(this->*m_CollisionTable[child->GetType()][other->GetType()])(child, other, push))
         {
-            D3DXVECTOR3 vel = body->GetVelocity();
-            if (vel.y < 0)
+            continue;
+        }
+
+        float depthSq = D3DXVec3LengthSq(&push);
+
+        if (depthSq > bestDepthSq)
+        {
+            bestDepthSq = depthSq;
+            outPush = push;
+        }
+    }
+
+    return bestDepthSq >= 0.0f;
+}
+//=============================================================================
+// 凸形状同士（GJK/EPA）
+// 専用の判定関数が無い組（凸包との組・シリンダーと箱・シリンダー）を支持点だけで判定する
+//=============================================================================
+bool PhysicsWorld::GjkCollision(Collider* a, Collider* b, D3DXVECTOR3& outPush)
+{
+    return Gjk::Penetration(ConvexShape(a), ConvexShape(b), outPush);
+}
+//=============================================================================
+// 凸包 vs メッシュ
+// 三角形ごとにGJK/EPAで押し戻しを求め、一番深いものを使う（裏へ押し出す向きになったら面の法線で押し戻す）
+//=============================================================================
+bool PhysicsWorld::ConvexMeshCollision(ConvexCollider* convex, MeshCollider* mesh, D3DXVECTOR3& outPush)
+{
+    const D3DXVECTOR3& center = convex->GetPosition();
+
+    thread_local std::vector<int> triangles;
+    triangles.clear();
+    mesh->QueryTriangles(convex->GetAABB(), triangles);
+
+    ConvexShape hull(convex);
+    float bestDepth = 0.0f;
+    bool isHit = false;
+
+    for (int triangle : triangles)
+    {
+        D3DXVECTOR3 tri[AXIS], n;
+        mesh->GetTriangle(triangle, tri, n);
+
+        D3DXVECTOR3 toCenter = center - tri[0];
+
+        if (D3DXVec3Dot(&toCenter, &n) < 0.0f)
+        {
+            continue;
+        }
+
+        D3DXVECTOR3 push;
+
+        if (!Gjk::Penetration(hull, ConvexShape(tri, AXIS), push))
+        {
+            continue;
+        }
+
+        float depth = D3DXVec3Length(&push);
+
+        if (D3DXVec3Dot(&push, &n) > 0.0f)
+        {
+            // 三角形の面より奥に出ている頂点の分だけ表へ押し戻す
+            D3DXVECTOR3 deepest = convex->GetSupport(-n);
+            D3DXVECTOR3 toFace = tri[0] - deepest;
+            depth = D3DXVec3Dot(&toFace, &n);
+
+            if (depth <= 0.0f)
             {
-                vel.y = 0; // 下方向を消す
+                continue;
             }
 
-            body->SetVelocity(vel);
+            push = -n * depth;
+        }
+
+        if (!isHit || depth > bestDepth)
+        {
+            bestDepth = depth;
+            outPush = push;
+            isHit = true;
         }
     }
+
+    return isHit;
 }
 //=============================================================================
-// 剛体の削除
+// 2体の簡易AABB押し戻し
 //=============================================================================
-void PhysicsWorld::RemoveRigidBody(std::shared_ptr<RigidBody> body)
+bool PhysicsWorld::CheckCollision(RigidBody* a, RigidBody* b, D3DXVECTOR3& outPush)
 {
-    if (!body)
+    Collider* colA = a->GetColliderPtr();
+    Collider* colB = b->GetColliderPtr();
+
+    CollisionFunc func = m_CollisionTable[colA->GetType()][colB->GetType()];
+
+    return (this->*func)(colA, colB, outPush);
+}
+//=============================================================================
+// 判定関数の呼び出し処理（コライダーを実際の型にして渡す）
+//=============================================================================
+template <class TA, class TB, bool (PhysicsWorld::*FUNC)(TA*, TB*, D3DXVECTOR3&)>
+bool PhysicsWorld::DispatchCollision(Collider* a, Collider* b, D3DXVECTOR3& outPush)
+{
+    return (this->*FUNC)(static_cast<TA*>(a), static_cast<TB*>(b), outPush);
+}
+//=============================================================================
+// 入れ替えた判定関数の呼び出し処理（押し戻しはAから見た向きに戻す）
+//=============================================================================
+template <class TA, class TB, bool (PhysicsWorld::*FUNC)(TA*, TB*, D3DXVECTOR3&)>
+bool PhysicsWorld::DispatchCollisionSwapped(Collider* a, Collider* b, D3DXVECTOR3& outPush)
+{
+    bool collided = DispatchCollision<TA, TB, FUNC>(b, a, outPush);
+    outPush = -outPush;
+    return collided;
+}
+//=============================================================================
+// 衝突判定の関数表の生成処理（コンパイル時に作る）
+//=============================================================================
+constexpr PhysicsWorld::CollisionTable PhysicsWorld::MakeCollisionTable(void)
+{
+    CollisionTable table = {};
+
+    table[Collider::BOX][Collider::BOX]           = &PhysicsWorld::DispatchCollision<BoxCollider, BoxCollider, &PhysicsWorld::BoxBoxCollision>;
+    table[Collider::BOX][Collider::CAPSULE]       = &PhysicsWorld::DispatchCollisionSwapped<CapsuleCollider, BoxCollider, &PhysicsWorld::CapsuleBoxCollision>;
+    table[Collider::BOX][Collider::CYLINDER]      = &PhysicsWorld::DispatchCollision<Collider, Collider, &PhysicsWorld::GjkCollision>;
+    table[Collider::BOX][Collider::SPHERE]        = &PhysicsWorld::DispatchCollisionSwapped<SphereCollider, BoxCollider, &PhysicsWorld::SphereBoxCollision>;
+    table[Collider::BOX][Collider::MESH]          = &PhysicsWorld::DispatchCollision<BoxCollider, MeshCollider, &PhysicsWorld::BoxMeshCollision>;
+
+    table[Collider::CAPSULE][Collider::BOX]       = &PhysicsWorld::DispatchCollision<CapsuleCollider, BoxCollider, &PhysicsWorld::CapsuleBoxCollision>;
+    table[Collider::CAPSULE][Collider::CAPSULE]   = &PhysicsWorld::DispatchCollision<CapsuleCollider, CapsuleCollider, &PhysicsWorld::CapsuleCapsuleCollision>;
+    table[Collider::CAPSULE][Collider::CYLINDER]  = &PhysicsWorld::DispatchCollisionSwapped<CylinderCollider, CapsuleCollider, &PhysicsWorld::CylinderCapsuleCollision>;
+    table[Collider::CAPSULE][Collider::SPHERE]    = &PhysicsWorld::DispatchCollisionSwapped<SphereCollider, CapsuleCollider, &PhysicsWorld::SphereCapsuleCollision>;
+    table[Collider::CAPSULE][Collider::MESH]      = &PhysicsWorld::DispatchCollision<CapsuleCollider, MeshCollider, &PhysicsWorld::CapsuleMeshCollision>;
+
+    table[Collider::CYLINDER][Collider::BOX]      = &PhysicsWorld::DispatchCollision<Collider, Collider, &PhysicsWorld::GjkCollision>;
+    table[Collider::CYLINDER][Collider::CAPSULE]  = &PhysicsWorld::DispatchCollision<CylinderCollider, CapsuleCollider, &PhysicsWorld::CylinderCapsuleCollision>;
+    table[Collider::CYLINDER][Collider::CYLINDER] = &PhysicsWorld::DispatchCollision<Collider, Collider, &PhysicsWorld::GjkCollision>;
+    table[Collider::CYLINDER][Collider::SPHERE]   = &PhysicsWorld::DispatchCollisionSwapped<SphereCollider, CylinderCollider, &PhysicsWorld::SphereCylinderCollision>;
+    table[Collider::CYLINDER][Collider::MESH]     = &PhysicsWorld::DispatchCollision<CylinderCollider, MeshCollider, &PhysicsWorld::CylinderMeshCollision>;
+
+    table[Collider::SPHERE][Collider::BOX]        = &PhysicsWorld::DispatchCollision<SphereCollider, BoxCollider, &PhysicsWorld::SphereBoxCollision>;
+    table[Collider::SPHERE][Collider::CAPSULE]    = &PhysicsWorld::DispatchCollision<SphereCollider, CapsuleCollider, &PhysicsWorld::SphereCapsuleCollision>;
+    table[Collider::SPHERE][Collider::CYLINDER]   = &PhysicsWorld::DispatchCollision<SphereCollider, CylinderCollider, &PhysicsWorld::SphereCylinderCollision>;
+    table[Collider::SPHERE][Collider::SPHERE]     = &PhysicsWorld::DispatchCollision<SphereCollider, SphereCollider, &PhysicsWorld::SphereSphereCollision>;
+    table[Collider::SPHERE][Collider::MESH]       = &PhysicsWorld::DispatchCollision<SphereCollider, MeshCollider, &PhysicsWorld::SphereMeshCollision>;
+
+    table[Collider::MESH][Collider::BOX]          = &PhysicsWorld::DispatchCollisionSwapped<BoxCollider, MeshCollider, &PhysicsWorld::BoxMeshCollision>;
+    table[Collider::MESH][Collider::CAPSULE]      = &PhysicsWorld::DispatchCollisionSwapped<CapsuleCollider, MeshCollider, &PhysicsWorld::CapsuleMeshCollision>;
+    table[Collider::MESH][Collider::CYLINDER]     = &PhysicsWorld::DispatchCollisionSwapped<CylinderCollider, MeshCollider, &PhysicsWorld::CylinderMeshCollision>;
+    table[Collider::MESH][Collider::SPHERE]       = &PhysicsWorld::DispatchCollisionSwapped<SphereCollider, MeshCollider, &PhysicsWorld::SphereMeshCollision>;
+    table[Collider::MESH][Collider::MESH]         = &PhysicsWorld::DispatchCollision<MeshCollider, MeshCollider, &PhysicsWorld::MeshMeshCollision>;
+    table[Collider::MESH][Collider::CONVEX]       = &PhysicsWorld::DispatchCollisionSwapped<ConvexCollider, MeshCollider, &PhysicsWorld::ConvexMeshCollision>;
+
+    // 凸包は専用の判定関数を持たず、凸形状とはGJK/EPAで判定する
+    for (int nType : { Collider::BOX, Collider::CAPSULE, Collider::CYLINDER, Collider::SPHERE, Collider::CONVEX })
+    {
+        table[Collider::CONVEX][nType] = &PhysicsWorld::DispatchCollision<Collider, Collider, &PhysicsWorld::GjkCollision>;
+        table[nType][Collider::CONVEX] = &PhysicsWorld::DispatchCollision<Collider, Collider, &PhysicsWorld::GjkCollision>;
+    }
+
+    table[Collider::CONVEX][Collider::MESH]       = &PhysicsWorld::DispatchCollision<ConvexCollider, MeshCollider, &PhysicsWorld::ConvexMeshCollision>;
+
+    // 複合は子の型で引き直すので相手の型を問わない
+    for (int nType = 0; nType < Collider::TYPE_MAX; nType++)
+    {
+        table[Collider::COMPOUND][nType] = &PhysicsWorld::DispatchCollision<CompoundCollider, Collider, &PhysicsWorld::CompoundCollision>;
+
+        if (nType != Collider::COMPOUND)
+        {
+            table[nType][Collider::COMPOUND] = &PhysicsWorld::DispatchCollisionSwapped<CompoundCollider, Collider, &PhysicsWorld::CompoundCollision>;
+        }
+    }
+
+    return table;
+}
+
+const PhysicsWorld::CollisionTable PhysicsWorld::m_CollisionTable = PhysicsWorld::MakeCollisionTable();
+//=============================================================================
+// 接触点の取得
+//=============================================================================
+D3DXVECTOR3 PhysicsWorld::GetActualCollisionPoint(Collider* a, Collider* b)
+{
+    // 重なっているAABBの中心を接触点にする（角に寄らないので余計な回転が出ない）
+    AABB boxA = a->GetAABB();
+    AABB boxB = b->GetAABB();
+
+    D3DXVECTOR3 lower(
+        std::max(boxA.min.x, boxB.min.x),
+        std::max(boxA.min.y, boxB.min.y),
+        std::max(boxA.min.z, boxB.min.z));
+    D3DXVECTOR3 upper(
+        std::min(boxA.max.x, boxB.max.x),
+        std::min(boxA.max.y, boxB.max.y),
+        std::min(boxA.max.z, boxB.max.z));
+
+    // 中点を返す
+    return (lower + upper) * HALF;
+}
+//=============================================================================
+// 更新処理（経過時間を貯めて固定の刻みでステップを回す）
+//=============================================================================
+int PhysicsWorld::Update(float frameTime)
+{
+    // 一時停止中は頼まれた分だけ進め、止めたままの時間は貯めない
+    if (m_isPaused)
+    {
+        m_SubStepCount = 0;
+
+        for (; m_NumRequestedSteps > 0; m_NumRequestedSteps--)
+        {
+            StepSimulation(m_FixedTimeStep);
+            m_SubStepCount++;
+        }
+
+        // エディターで置き直した剛体も選べるようにBVH・AABBだけ合わせる
+        RefreshEditedBodies();
+
+        m_Accumulator = 0.0f;
+        m_InterpolationAlpha = 1.0f;
+
+        return m_SubStepCount;
+    }
+
+    // 決定論モードは描画の速さに依らず1フレーム1ステップ（同じ入力の列なら同じ結果になる）
+    if (m_isDeterministic)
+    {
+        StepSimulation(m_FixedTimeStep);
+
+        m_Accumulator = 0.0f;
+        m_SubStepCount = 1;
+        m_InterpolationAlpha = 1.0f;
+
+        return m_SubStepCount;
+    }
+
+    // 読み込みなどで止まったフレームは丸ごと取り返さない
+    m_Accumulator += std::clamp(frameTime, 0.0f, MAX_FRAME_TIME);
+
+    m_SubStepCount = 0;
+
+    while (m_Accumulator >= m_FixedTimeStep)
+    {
+        // 上限を超えた分は捨てる（処理落ちでステップが増え続けるのを防ぐ）
+        if (m_SubStepCount >= m_MaxSubSteps)
+        {
+            int numDropped = (int)(m_Accumulator / m_FixedTimeStep);
+
+            m_NumDroppedSteps += numDropped;
+            m_Accumulator -= numDropped * m_FixedTimeStep;
+            break;
+        }
+
+        StepSimulation(m_FixedTimeStep);
+
+        m_Accumulator -= m_FixedTimeStep;
+        m_SubStepCount++;
+    }
+
+    // 残りの時間の分だけ前のステップから今のステップへ補間する
+    m_InterpolationAlpha = std::clamp(m_Accumulator / m_FixedTimeStep, 0.0f, 1.0f);
+
+    return m_SubStepCount;
+}
+//=============================================================================
+// 一時停止の設定処理
+//=============================================================================
+void PhysicsWorld::SetPaused(bool isPaused)
+{
+    m_isPaused = isPaused;
+
+    // 止める前に頼まれて残っていたステップは持ち越さない
+    m_NumRequestedSteps = 0;
+    m_Accumulator = 0.0f;
+}
+//=============================================================================
+// 静的BVHの更新処理（動いた静的剛体があるときだけ作り直す）
+// isWaitがfalseなら作り直しはほかのスレッドに任せ、組み上がるまでは今のBVHのまま戻る
+//=============================================================================
+void PhysicsWorld::RefreshStaticTree(bool isWait)
+{
+    // 焼き込んでいる間は静的剛体は動かないので確かめない（付いた印は焼き込みを外したときに拾う）
+    if (!m_isStaticBaked)
+    {
+        for (auto& body : m_StaticBodies)
+        {
+            if (body->IsMoved())
+            {
+                m_isStaticDirty = true;
+                body->SetMoved(false);
+            }
+        }
+    }
+
+    if (!isWait)
+    {
+        // 組み終わっていれば入れ替え、まだ組んでいなければ次を始める（組んでいる途中の変更は次の回にまとめる）
+        FinishStaticBake(false);
+
+        if (m_isStaticDirty && !m_StaticBakeTask.valid())
+        {
+            StartStaticBake();
+        }
+
+        return;
+    }
+
+    SyncStaticTree();
+}
+//=============================================================================
+// 静的BVHを今の静的剛体にそろえる処理（古いときだけ組み上がるのを待つか、その場で作り直す）
+//=============================================================================
+void PhysicsWorld::SyncStaticTree(void)
+{
+    // 今のBVHと同じ中身を組んでいるだけなら待たない（組み上がった方に入れ替えても結果は変わらない）
+    if (!m_isBakeReplacing && !m_isStaticDirty)
+    {
+        return;
+    }
+
+    FinishStaticBake(true);
+
+    if (!m_isStaticDirty)
     {
         return;
     }
 
-    auto it = std::find(m_Bodies.begin(), m_Bodies.end(), body);
-    if (it != m_Bodies.end())
+    m_StaticTree.Build(m_StaticBodies);
+    m_isStaticDirty = false;
+
+    // 足場が変わったかもしれないので全員起こす
+    for (auto& body : m_DynamicBodies)
     {
-        m_Bodies.erase(it);
+        body->WakeUp();
     }
 }
+//=============================================================================
+// 静的BVHをほかのスレッドで組み始める処理
+//=============================================================================
+void PhysicsWorld::StartStaticBake(void)
+{
+    // 前の仕事が残っていれば受け取ってから（組む先のツリーは1つだけ）
+    FinishStaticBake(true);
+
+    // 剛体・コライダーにはここで触り終え、ほかのスレッドでは写した要素を並べてノードを組むだけにする
+    m_BakingTree.Gather(m_StaticBodies);
+    m_isBakeReplacing = m_isStaticDirty;
+    m_isStaticDirty = false;
+
+    m_StaticBakeTask = std::async(std::launch::async, [this]()
+    {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        m_BakingTree.BuildGathered();
+
+        return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    });
+}
+//=============================================================================
+// ほかのスレッドで組んだ静的BVHの受け取り処理（入れ替えたらtrue）
+//=============================================================================
+bool PhysicsWorld::FinishStaticBake(bool isWait)
+{
+    if (!m_StaticBakeTask.valid())
+    {
+        return false;
+    }
+
+    if (!isWait && m_StaticBakeTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return false;
+    }
+
+    m_StaticBakeTime = m_StaticBakeTask.get();
+
+    // 古いツリーの領域は次に組むときに使い回す
+    std::swap(m_StaticTree, m_BakingTree);
+
+    if (m_isBakeReplacing)
+    {
+        m_isBakeReplacing = false;
+
+        // 足場が変わったかもしれないので全員起こす
+        for (auto& body : m_DynamicBodies)
+        {
+            body->WakeUp();
+        }
+    }
+
+    return true;
+}
+//=============================================================================
+// ほかのスレッドで組んでいる静的BVHの取り消し処理（静的剛体を消すときに呼ぶ）
+//=============================================================================
+void PhysicsWorld::CancelStaticBake(void)
+{
+    if (!m_StaticBakeTask.valid())
+    {
+        return;
+    }
+
+    // 消す剛体を指したまま入れ替えないように、組み終わるのを待って捨てる
+    m_StaticBakeTask.get();
+    m_BakingTree.Clear();
+
+    if (m_isBakeReplacing)
+    {
+        m_isBakeReplacing = false;
+        m_isStaticDirty = true;
+    }
+}
+//=============================================================================
+// 静的剛体の焼き込み処理
+//=============================================================================
+void PhysicsWorld::BakeStaticWorld(void)
+{
+    // 止めている間に動かした分を拾ってから止める（作り直しが要ればほかのスレッドで始めておく）
+    RefreshStaticTree(false);
+
+    m_isStaticBaked = true;
+}
+//=============================================================================
+// 止めている間に置き直された剛体の反映処理（ステップは進めない）
+//=============================================================================
+void PhysicsWorld::RefreshEditedBodies(void)
+{
+    // ドラッグ中に毎フレーム全部を作り直して止まらないように、静的BVHはほかのスレッドで組む
+    RefreshStaticTree(false);
+
+    // 印は残して次のステップに任せる（AABBの中に収まっていればもう一度動かしても何も変わらない）
+    for (auto& body : m_DynamicBodies)
+    {
+        if (body->IsMoved())
+        {
+            m_pBroadphase->MoveProxy(body->GetProxyId(), INIT_VEC3);
+        }
+    }
+}
+//=============================================================================
+// 当たり判定シミュレーション
+//=============================================================================
+void PhysicsWorld::StepSimulation(float dt)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // スナップショットから戻したままの分をここでそろえる（ナローフェーズの並列処理では読むだけにする）
+    m_BodyPool.SyncColliders();
+    ApplyRestoredContacts();
+
+    // 描画の補間用にステップ前の位置・回転を残す
+    m_BodyPool.StorePreviousTransforms();
+
+    // 速度の更新（起きている動的剛体だけ、スリープ中は接地状態も含めてそのまま）
+    m_BodyPool.IntegrateVelocity(dt, m_Gravity);
+
+    m_IntegrateTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    // 今回の接触を集める（ブロードフェーズ・ナローフェーズ・接触多様体の更新）
+    CollectContacts(dt);
+
+    // 接触をアイランドごとに分けて、互いに独立なアイランドを並列で解く
+    auto solveStart = std::chrono::high_resolution_clock::now();
+
+    BuildIslands();
+
+    ThreadPool* pThreadPool = GetThreadPool();
+    int numIslands = (int)m_Islands.size();
+
+    if (pThreadPool && numIslands > 1)
+    {
+        // 大きいアイランドから配る（結果は番号の順番に依らない）
+        pThreadPool->ParallelFor(numIslands, [this, dt](int index, int)
+            {
+                SolveIsland(m_Islands[m_IslandOrder[index]], dt);
+            });
+    }
+    else
+    {
+        for (Island& island : m_Islands)
+        {
+            SolveIsland(island, dt);
+        }
+    }
+
+    // 一番多く回したアイランドの回数を残す
+    m_VelocityPasses = 0;
+    m_PositionPasses = 0;
+    m_isSolverConverged = true;
+
+    for (const Island& island : m_Islands)
+    {
+        m_VelocityPasses = std::max(m_VelocityPasses, island.velocityPasses);
+        m_PositionPasses = std::max(m_PositionPasses, island.positionPasses);
+        m_isSolverConverged = m_isSolverConverged && island.isConverged;
+    }
+
+    // 上限まで回しても収束しなかったステップを数える
+    if (!m_isSolverConverged)
+    {
+        m_NumUnconvergedSteps++;
+    }
+
+    auto integrateStart = std::chrono::high_resolution_clock::now();
+    m_SolveTime = std::chrono::duration<float, std::milli>(integrateStart - solveStart).count();
+
+    // 位置の更新
+    m_BodyPool.IntegratePosition(dt);
+
+    // 最終補正
+    for (auto& body : m_DynamicBodies)
+    {
+        if (body->IsOnGround())
+        {
+            D3DXVECTOR3 vel = body->GetVelocity();
+            if (vel.y < 0)
+            {
+                vel.y = 0; // 下方向を消す
+            }
+
+            // 遅く動いている剛体は速度を落として早く落ち着かせる（積んだ箱が着地したあとの揺れ戻しを抑える）
+            D3DXVECTOR3 angVel = body->GetAngularVelocity();
+
+            if (D3DXVec3LengthSq(&vel) < STABILIZE_LINEAR_VELOCITY * STABILIZE_LINEAR_VELOCITY &&
+                D3DXVec3LengthSq(&angVel) < STABILIZE_ANGULAR_VELOCITY * STABILIZE_ANGULAR_VELOCITY)
+            {
+                vel *= STABILIZE_DAMPING;
+                body->SetAngularVelocity(angVel * STABILIZE_DAMPING);
+            }
+
+            body->SetVelocity(vel);
+        }
+    }
+
+    // スリープ判定
+    auto sleepStart = std::chrono::high_resolution_clock::now();
+    m_IntegrateTime += std::chrono::duration<float, std::milli>(sleepStart - integrateStart).count();
+
+    UpdateSleeping();
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    m_SleepTime = std::chrono::duration<float, std::milli>(endTime - sleepStart).count();
+    m_StepTime = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+}
+//=============================================================================
+// 接触の収集処理（剛体の組を集めて判定し、接触多様体を前のステップから引き継ぐ）
+//=============================================================================
+void PhysicsWorld::CollectContacts(float dt)
+{
+    auto broadStart = std::chrono::high_resolution_clock::now();
+
+    // 静的剛体は編集されたときだけBVHを作り直す
+    RefreshStaticTree(true);
+
+    // アイランドの初期化とAABBの更新
+    for (size_t nCnt = 0; nCnt < m_DynamicBodies.size(); nCnt++)
+    {
+        auto& body = m_DynamicBodies[nCnt];
+        body->SetIslandIndex((int)nCnt);
+        m_IslandParent[nCnt] = (int)nCnt;
+
+        // 1ステップで自分の厚みの割合以上に動く剛体は高速とみなす
+        D3DXVECTOR3 motion = body->GetVelocity() * dt;
+        bool isFast = false;
+
+        if (m_isContinuous && !body->IsSleeping())
+        {
+            AABB box = body->GetColliderPtr()->GetAABB();
+            D3DXVECTOR3 extent = box.max - box.min;
+            float minExtent = std::min({ extent.x, extent.y, extent.z }) * CCD_MOTION_RATIO;
+
+            isFast = D3DXVec3LengthSq(&motion) > minExtent * minExtent;
+        }
+
+        body->SetFast(isFast);
+
+        // 前のステップから動いた剛体だけAABBを更新する（高速な剛体は移動量の分だけ伸ばす）
+        if (body->IsMoved() || isFast)
+        {
+            m_pBroadphase->MoveProxy(body->GetProxyId(), isFast ? motion : INIT_VEC3);
+            body->SetMoved(false);
+        }
+    }
+
+    // 動的同士のペアはブロードフェーズで集める
+    m_pBroadphase->UpdatePairs(m_Pairs);
+
+    // 起きている剛体に触れられた眠ったアイランドは丸ごと起こす（静的との組を集めて眠った組を外す前に）
+    WakeTouchedIslands(dt);
+
+    // 動的と静的のペアは静的BVHに問い合わせる（静的同士は調べない）
+    for (auto& body : m_DynamicBodies)
+    {
+        if (body->IsSleeping())
+        {
+            continue;
+        }
+
+        AABB box = body->GetColliderPtr()->GetAABB();
+
+        if (body->IsFast())
+        {
+            box.Sweep(body->GetVelocity() * dt);
+        }
+
+        box.Expand(STATIC_QUERY_MARGIN);
+
+        m_StaticHits.clear();
+        m_StaticTree.Query(box, m_StaticHits);
+
+        for (RigidBody* other : m_StaticHits)
+        {
+            // レイヤーとマスクで外れる組はナローフェーズに渡さない
+            if (other->CanCollideWith(body))
+            {
+                m_Pairs.push_back({ other, body });
+            }
+        }
+    }
+
+    // 両方眠っているペアは解決しない
+    m_Pairs.erase(std::remove_if(m_Pairs.begin(), m_Pairs.end(),
+        [](const BroadphasePair& pair)
+        {
+            bool awakeA = pair.a->IsDynamic() && !pair.a->IsSleeping();
+            bool awakeB = pair.b->IsDynamic() && !pair.b->IsSleeping();
+            return !awakeA && !awakeB;
+        }),
+        m_Pairs.end());
+
+    // 決定論モードでは動的同士の向きと並びをプール内の番号で決める（ブロードフェーズの木の形やプロキシ番号に依らない）
+    if (m_isDeterministic)
+    {
+        for (BroadphasePair& pair : m_Pairs)
+        {
+            if (pair.a->IsDynamic() && pair.b->IsDynamic() && pair.a->GetPoolIndex() > pair.b->GetPoolIndex())
+            {
+                std::swap(pair.a, pair.b);
+            }
+        }
+
+        std::sort(m_Pairs.begin(), m_Pairs.end(),
+            [](const BroadphasePair& lhs, const BroadphasePair& rhs)
+            {
+                if (lhs.a->GetPoolIndex() != rhs.a->GetPoolIndex())
+                {
+                    return lhs.a->GetPoolIndex() < rhs.a->GetPoolIndex();
+                }
+
+                return lhs.b->GetPoolIndex() < rhs.b->GetPoolIndex();
+            });
+    }
+
+    // ナローフェーズ：球・箱同士の組は型ごとに詰めてSIMDでまとめて判定しておく
+    auto narrowStart = std::chrono::high_resolution_clock::now();
+    m_BroadphaseTime = std::chrono::duration<float, std::milli>(narrowStart - broadStart).count();
+
+    m_NarrowphaseBatch.Clear((int)m_Pairs.size());
+
+    for (size_t nCnt = 0; nCnt < m_Pairs.size(); nCnt++)
+    {
+        m_NarrowphaseBatch.Add((int)nCnt, m_Pairs[nCnt].a->GetColliderPtr(), m_Pairs[nCnt].b->GetColliderPtr());
+    }
+
+    m_NarrowphaseBatch.Execute(true);
+
+    // 残りの組は判定だけを並列に回してスレッドごとのバッファに書き出す
+    ThreadPool* pThreadPool = GetThreadPool();
+    int numThreads = pThreadPool ? pThreadPool->GetThreadCount() : 1;
+    int numPairs = (int)m_Pairs.size();
+    int numChunks = (numPairs + NARROWPHASE_CHUNK - 1) / NARROWPHASE_CHUNK;
+
+    m_ThreadContacts.resize(numThreads);
+
+    for (auto& contacts : m_ThreadContacts)
+    {
+        contacts.clear();
+    }
+
+    if (pThreadPool && numChunks > 1)
+    {
+        pThreadPool->ParallelFor(numChunks, [this, dt, numPairs](int chunk, int threadIndex)
+            {
+                int begin = chunk * NARROWPHASE_CHUNK;
+                DetectContacts(begin, std::min(begin + NARROWPHASE_CHUNK, numPairs), dt, m_ThreadContacts[threadIndex]);
+            });
+    }
+    else
+    {
+        DetectContacts(0, numPairs, dt, m_ThreadContacts[0]);
+    }
+
+    // 接触多様体を更新して前フレームの累積インパルスを引き継ぐ（ここからは1スレッド）
+    MergeContacts();
+
+    m_NarrowphaseTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - narrowStart).count();
+}
+//=============================================================================
+// 接触点の生成処理
+//=============================================================================
+int PhysicsWorld::GenerateContacts(RigidBody* a, RigidBody* b, const D3DXVECTOR3& push, const D3DXVECTOR3& normal, ContactPoint* outPoints)
+{
+    int count = ShapeContacts(a->GetColliderPtr(), b->GetColliderPtr(), push, normal, outPoints);
+
+    // 減らすときは前のステップで1点目に残した点を続けて選ぶ
+    // （対称な重なりでは深さの僅かな差で残す組が入れ替わり、ウォームスタートが毎回切れてしまう）
+    unsigned int anchorFeature = ContactPoint::NO_FEATURE;
+
+    if (count > ContactManifold::MAX_POINTS)
+    {
+        const ContactManifold* prev = m_ContactCache.FindPrevious(ContactCache::MakeKey(a, b));
+
+        if (prev && prev->numPoints > 0)
+        {
+            anchorFeature = prev->points[0].featureId;
+        }
+    }
+
+    count = ReduceContacts(outPoints, count, anchorFeature);
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        outPoints[nCnt].localA = ContactManifold::ToLocal(a, outPoints[nCnt].position);
+        outPoints[nCnt].localB = ContactManifold::ToLocal(b, outPoints[nCnt].position);
+        outPoints[nCnt].normalImpulse = 0.0f;
+        outPoints[nCnt].tangentImpulse[0] = 0.0f;
+        outPoints[nCnt].tangentImpulse[1] = 0.0f;
+        outPoints[nCnt].pushImpulse = 0.0f;
+        outPoints[nCnt].velocityBias = 0.0f;
+        outPoints[nCnt].positionBias = 0.0f;
+    }
+
+    return count;
+}
+//=============================================================================
+// 形状の組の接触点生成処理（減らす前の候補をMAX_CANDIDATESまで、少なくとも1点返す）
+//=============================================================================
+int PhysicsWorld::ShapeContacts(Collider* colA, Collider* colB, const D3DXVECTOR3& push, const D3DXVECTOR3& normal, ContactPoint* outPoints)
+{
+    int count = 0;
+
+    if (colA->GetType() == Collider::COMPOUND)
+    {
+        count = CompoundContacts(static_cast<CompoundCollider*>(colA), colB, normal, false, outPoints);
+    }
+    else if (colB->GetType() == Collider::COMPOUND)
+    {
+        count = CompoundContacts(static_cast<CompoundCollider*>(colB), colA, normal, true, outPoints);
+    }
+    else if (colA->GetType() == Collider::BOX && colB->GetType() == Collider::BOX)
+    {
+        count = BoxBoxContacts(static_cast<BoxCollider*>(colA), static_cast<BoxCollider*>(colB), normal, 0.0f, outPoints);
+    }
+    else if (colA->GetType() == Collider::MESH)
+    {
+        count = MeshContacts(colB, static_cast<MeshCollider*>(colA), -normal, outPoints);
+    }
+    else if (colB->GetType() == Collider::MESH)
+    {
+        count = MeshContacts(colA, static_cast<MeshCollider*>(colB), normal, outPoints);
+    }
+    else if (colA->GetType() == Collider::CONVEX || colB->GetType() == Collider::CONVEX ||
+        (colA->GetType() == Collider::CYLINDER && (colB->GetType() == Collider::BOX || colB->GetType() == Collider::CYLINDER)) ||
+        (colB->GetType() == Collider::CYLINDER && colA->GetType() == Collider::BOX))
+    {
+        // GJK/EPAで判定した組は支持点の面同士で切り取る
+        count = ConvexContacts(colA, colB, normal, D3DXVec3Length(&push), outPoints);
+    }
+
+    // 複数点が取れない組み合わせは代表点1つ
+    if (count == 0)
+    {
+        outPoints[0].position = GetActualCollisionPoint(colA, colB);
+        outPoints[0].depth = D3DXVec3Length(&push);
+        outPoints[0].featureId = ContactPoint::NO_FEATURE;
+        count = 1;
+    }
+
+    return count;
+}
+//=============================================================================
+// 複合の子ごとの接触点生成処理（isSwappedなら複合がB側）
+// 1組に法線は1つなので、押し戻しの向きが法線と合う子の接触だけを集める
+// 点の特徴の番号には子の番号を混ぜ、別の子の同じ特徴と取り違えないようにする
+//=============================================================================
+int PhysicsWorld::CompoundContacts(CompoundCollider* compound, Collider* other, const D3DXVECTOR3& normal, bool isSwapped, ContactPoint* outPoints)
+{
+    AABB otherBox = other->GetAABB();
+    int count = 0;
+
+    for (int nCnt = 0; nCnt < compound->GetChildCount() && count < MAX_CANDIDATES; nCnt++)
+    {
+        Collider* child = compound->GetChild(nCnt);
+
+        if (!child->GetAABB().Overlaps(otherBox))
+        {
+            continue;
+        }
+
+        Collider* colA = isSwapped ? other : child;
+        Collider* colB = isSwapped ? child : other;
+        D3DXVECTOR3 push;
+
+        if (!(this->*m_CollisionTable[colA->GetType()][colB->GetType()])(colA, colB, push))
+        {
+            continue;
+        }
+
+        float depth = D3DXVec3Length(&push);
+
+        if (depth > MIN_DISTANCE && D3DXVec3Dot(&push, &normal) < depth * COMPOUND_NORMAL_DOT)
+        {
+            continue;
+        }
+
+        std::array<ContactPoint, MAX_CANDIDATES> childPoints;
+        int numChildPoints = ShapeContacts(colA, colB, push, normal, childPoints.data());
+        unsigned int childFeature = ((unsigned int)nCnt & COMPOUND_CHILD_MASK) << (isSwapped ? COMPOUND_FEATURE_SHIFT_B : COMPOUND_FEATURE_SHIFT_A);
+
+        for (int nPoint = 0; nPoint < numChildPoints && count < MAX_CANDIDATES; nPoint++)
+        {
+            outPoints[count] = childPoints[nPoint];
+            outPoints[count].featureId ^= childFeature;
+            count++;
+        }
+    }
+
+    return count;
+}
+//=============================================================================
+// OBB同士の接触点生成処理
+// 法線に向きの合う面があれば、基準面に相手の面（incident face）を重ねて基準面の4辺で切り取る
+// どちらの面とも合わなければ辺同士の接触として最近接点を1つ返す
+// gapは離れた箱の予測接触を作るときの隙間（重なっていれば0）
+//=============================================================================
+int PhysicsWorld::BoxBoxContacts(BoxCollider* a, BoxCollider* b, const D3DXVECTOR3& normal, float gap, ContactPoint* outPoints)
+{
+    D3DXVECTOR3 axesA[AXIS], axesB[AXIS];
+    float halfA[AXIS], halfB[AXIS];
+    GetBoxFrame(a, axesA, halfA);
+    GetBoxFrame(b, axesB, halfB);
+
+    // 法線に一番向きの合う面をそれぞれ探す
+    int faceA = 0, faceB = 0;
+    float dotA = 0.0f, dotB = 0.0f;
+
+    for (int nCnt = 0; nCnt < AXIS; nCnt++)
+    {
+        float dA = fabsf(D3DXVec3Dot(&normal, &axesA[nCnt]));
+        float dB = fabsf(D3DXVec3Dot(&normal, &axesB[nCnt]));
+
+        if (dA > dotA)
+        {
+            dotA = dA;
+            faceA = nCnt;
+        }
+
+        if (dB > dotB)
+        {
+            dotB = dB;
+            faceB = nCnt;
+        }
+    }
+
+    if (std::max(dotA, dotB) < FACE_CONTACT_DOT)
+    {
+        return BoxEdgeContact(a, axesA, halfA, b, axesB, halfB, normal, outPoints);
+    }
+
+    // 基準面は向きの合っている方（ほぼ同じならAにして、フレームごとに入れ替わって点が変わらないようにする）
+    bool isRefA = dotA + REFERENCE_FACE_TOLERANCE >= dotB;
+
+    BoxCollider* ref = isRefA ? a : b;
+    BoxCollider* inc = isRefA ? b : a;
+    const D3DXVECTOR3* refAxes = isRefA ? axesA : axesB;
+    const D3DXVECTOR3* incAxes = isRefA ? axesB : axesA;
+    const float* refHalf = isRefA ? halfA : halfB;
+    const float* incHalf = isRefA ? halfB : halfA;
+    int refFace = isRefA ? faceA : faceB;
+
+    // 基準面の外向き法線（相手の方を向く）
+    D3DXVECTOR3 towardInc = isRefA ? normal : -normal;
+    float refSign = (D3DXVec3Dot(&towardInc, &refAxes[refFace]) >= 0.0f) ? 1.0f : -1.0f;
+    D3DXVECTOR3 refNormal = refAxes[refFace] * refSign;
+    D3DXVECTOR3 refCenter = ref->GetPosition() + refNormal * refHalf[refFace];
+
+    // 相手の面は基準面と一番向かい合っている面
+    int incFace = 0;
+    float incDot = 0.0f;
+
+    for (int nCnt = 0; nCnt < AXIS; nCnt++)
+    {
+        float d = D3DXVec3Dot(&refNormal, &incAxes[nCnt]);
+
+        if (fabsf(d) > fabsf(incDot))
+        {
+            incDot = d;
+            incFace = nCnt;
+        }
+    }
+
+    float incSign = (incDot > 0.0f) ? -1.0f : 1.0f;
+    D3DXVECTOR3 incCenter = inc->GetPosition() + incAxes[incFace] * (incSign * incHalf[incFace]);
+    D3DXVECTOR3 incU = incAxes[(incFace + 1) % AXIS] * incHalf[(incFace + 1) % AXIS];
+    D3DXVECTOR3 incV = incAxes[(incFace + 2) % AXIS] * incHalf[(incFace + 2) % AXIS];
+
+    // 相手の面の4頂点（辺nCntは頂点nCntからnCnt+1へ向かう）
+    std::array<ClipVertex, MAX_CLIP_POINTS> poly, clipped;
+    poly[0].position = incCenter + incU + incV;
+    poly[1].position = incCenter - incU + incV;
+    poly[2].position = incCenter - incU - incV;
+    poly[3].position = incCenter + incU - incV;
+
+    int count = NUM_FACE_EDGES;
+
+    for (int nCnt = 0; nCnt < NUM_FACE_EDGES; nCnt++)
+    {
+        poly[nCnt].feature = nCnt;
+        poly[nCnt].edge = nCnt;
+    }
+
+    // 基準面の4辺の側面で切り取る（側面の番号は辺の番号の続き）
+    // 側面は接触の許容量だけ外へずらし、少しはみ出した相手の頂点も支えとして残す
+    // （ぴったり切ると、揃えて積んだ箱がわずかにずれるたびに支えの四角が縮んで塔が傾き続ける）
+    for (int nPlane = 0; nPlane < NUM_FACE_EDGES && count > 0; nPlane++)
+    {
+        int axis = (refFace + 1 + nPlane / 2) % AXIS;
+        float sign = (nPlane & 1) ? -1.0f : 1.0f;
+        D3DXVECTOR3 planeNormal = refAxes[axis] * sign;
+        float offset = D3DXVec3Dot(&planeNormal, &ref->GetPosition()) + refHalf[axis] + CONTACT_TOLERANCE;
+
+        count = ClipPolygon(poly.data(), count, planeNormal, offset, nPlane, clipped.data());
+        std::swap(poly, clipped);
+    }
+
+    // 面・面の組の番号（どちらの箱の何番目の面か）を上位に入れる
+    unsigned int refFeature = (isRefA ? 0 : AXIS * 2) + refFace * 2 + (refSign > 0.0f ? 1 : 0);
+    unsigned int incFeature = incFace * 2 + (incSign > 0.0f ? 1 : 0);
+    unsigned int faceFeature = ((refFeature + 1) << 16) | (incFeature << 8);
+
+    int numPoints = 0;
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        D3DXVECTOR3 diff = poly[nCnt].position - refCenter;
+        float separation = D3DXVec3Dot(&diff, &refNormal);
+
+        // 基準面より外に離れている点は捨てる（予測接触は隙間の分だけ遠くまで拾う）
+        if (separation > gap + CONTACT_TOLERANCE)
+        {
+            continue;
+        }
+
+        // 両面の中間に置く（どちらを基準にしても同じ高さになり、摩擦が余計な回転を生まない）
+        // 予測接触は隙間を負のめり込みとして残す
+        float depth = (gap > 0.0f) ? -separation : std::max(-separation, 0.0f);
+
+        ContactPoint& cp = outPoints[numPoints++];
+        cp.position = poly[nCnt].position + refNormal * (depth * HALF);
+        cp.depth = depth;
+        cp.featureId = faceFeature | poly[nCnt].feature;
+    }
+
+    return numPoints;
+}
+//=============================================================================
+// 多角形を平面の内側で切り取る処理（Sutherland-Hodgman）
+// 新しくできた点は「切った辺と平面」の組を特徴の番号にする
+//=============================================================================
+int PhysicsWorld::ClipPolygon(const ClipVertex* in, int count, const D3DXVECTOR3& planeNormal, float offset, int planeIndex, ClipVertex* out)
+{
+    int numOut = 0;
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        const ClipVertex& cur = in[nCnt];
+        const ClipVertex& next = in[(nCnt + 1) % count];
+
+        float distCur = D3DXVec3Dot(&planeNormal, &cur.position) - offset;
+        float distNext = D3DXVec3Dot(&planeNormal, &next.position) - offset;
+        // 面の上にちょうど乗っている頂点は内側に残す（誤差で切り取られると特徴の番号がフレームごとに変わる）
+        bool isCurInside = distCur <= CLIP_TOLERANCE;
+        bool isNextInside = distNext <= CLIP_TOLERANCE;
+
+        if (isCurInside)
+        {
+            out[numOut++] = cur;
+        }
+
+        if (isCurInside == isNextInside)
+        {
+            continue;
+        }
+
+        // 辺と平面の交点（外へ出る点から先は平面に沿った辺になる）
+        float t = distCur / (distCur - distNext);
+
+        ClipVertex& vertex = out[numOut++];
+        vertex.position = cur.position + (next.position - cur.position) * t;
+        vertex.feature = CLIP_FEATURE | (cur.edge << 2) | planeIndex;
+        vertex.edge = isCurInside ? NUM_FACE_EDGES + planeIndex : cur.edge;
+    }
+
+    return numOut;
+}
+//=============================================================================
+// OBB同士の辺と辺の接触点生成処理
+//=============================================================================
+int PhysicsWorld::BoxEdgeContact(BoxCollider* a, const D3DXVECTOR3* axesA, const float* halfA,
+    BoxCollider* b, const D3DXVECTOR3* axesB, const float* halfB, const D3DXVECTOR3& normal, ContactPoint* outPoints)
+{
+    // 法線に直交する軸の辺のうち、Aは法線の向き、Bは逆向きに一番出ている辺を選ぶ
+    auto supportEdge = [&](BoxCollider* box, const D3DXVECTOR3* axes, const float* half, float dir,
+        D3DXVECTOR3& outStart, D3DXVECTOR3& outEnd)
+    {
+        int edgeAxis = 0;
+
+        for (int nCnt = 1; nCnt < AXIS; nCnt++)
+        {
+            if (fabsf(D3DXVec3Dot(&normal, &axes[nCnt])) < fabsf(D3DXVec3Dot(&normal, &axes[edgeAxis])))
+            {
+                edgeAxis = nCnt;
+            }
+        }
+
+        D3DXVECTOR3 center = box->GetPosition();
+        unsigned int signBits = 0;
+
+        for (int nCnt = 1; nCnt < AXIS; nCnt++)
+        {
+            int axis = (edgeAxis + nCnt) % AXIS;
+            bool isPositive = D3DXVec3Dot(&normal, &axes[axis]) * dir >= 0.0f;
+
+            center += axes[axis] * (isPositive ? half[axis] : -half[axis]);
+            signBits |= (isPositive ? 1u : 0u) << (nCnt - 1);
+        }
+
+        outStart = center - axes[edgeAxis] * half[edgeAxis];
+        outEnd = center + axes[edgeAxis] * half[edgeAxis];
+
+        // 箱の12本の辺の番号
+        return (unsigned int)edgeAxis * NUM_FACE_EDGES + signBits;
+    };
+
+    D3DXVECTOR3 startA, endA, startB, endB;
+    unsigned int edgeA = supportEdge(a, axesA, halfA, 1.0f, startA, endA);
+    unsigned int edgeB = supportEdge(b, axesB, halfB, -1.0f, startB, endB);
+
+    D3DXVECTOR3 closestA, closestB;
+    DistanceSqSegmentSegment(startA, endA, startB, endB, &closestA, &closestB);
+
+    // Aの辺がBの辺より法線の向きに出ている分がめり込み
+    D3DXVECTOR3 diff = closestA - closestB;
+    float depth = D3DXVec3Dot(&diff, &normal);
+
+    if (depth < -CONTACT_TOLERANCE)
+    {
+        return 0;
+    }
+
+    outPoints[0].position = (closestA + closestB) * HALF;
+    outPoints[0].depth = std::max(depth, 0.0f);
+    outPoints[0].featureId = (EDGE_FEATURE << 16) | (edgeA << 8) | edgeB;
+
+    return 1;
+}
+//=============================================================================
+// 箱の軸と半分の大きさの取得処理
+//=============================================================================
+void PhysicsWorld::GetBoxFrame(BoxCollider* box, D3DXVECTOR3* outAxes, float* outHalf)
+{
+    const D3DXMATRIX& R = box->GetRotation();
+    D3DXVECTOR3 half = box->GetScaledSize() * HALF;
+
+    outAxes[0] = D3DXVECTOR3(R._11, R._12, R._13);
+    outAxes[1] = D3DXVECTOR3(R._21, R._22, R._23);
+    outAxes[2] = D3DXVECTOR3(R._31, R._32, R._33);
+
+    outHalf[0] = half.x;
+    outHalf[1] = half.y;
+    outHalf[2] = half.z;
+}
+//=============================================================================
+// メッシュとの接触点生成処理（normalは相手→メッシュ）
+// 球・カプセル・シリンダーは芯の点ごとに一番深い三角形の点、箱・凸包は三角形に刺さった頂点と中に入った三角形の頂点
+// 点の番号は三角形ではなく相手側の点・メッシュの頂点で付けるので、三角形をまたいでも前フレームと照合できる
+//=============================================================================
+int PhysicsWorld::MeshContacts(Collider* other, MeshCollider* mesh, const D3DXVECTOR3& normal, ContactPoint* outPoints)
+{
+    thread_local std::vector<int> triangles;
+    thread_local std::vector<ContactPoint> candidates;
+    triangles.clear();
+    candidates.clear();
+
+    // 押し戻しの向きから接触面の許容量だけ外まで見る
+    AABB box = other->GetAABB();
+    D3DXVECTOR3 margin(CONTACT_TOLERANCE, CONTACT_TOLERANCE, CONTACT_TOLERANCE);
+    box.min -= margin;
+    box.max += margin;
+    mesh->QueryTriangles(box, triangles);
+
+    D3DXVECTOR3 segA, segB;
+    float radius = 0.0f;
+
+    if (GetCollisionCore(other, segA, segB, radius))
+    {
+        // 芯の両端（球なら1点）ごとに一番深い三角形を選ぶ
+        int numSamples = (segA == segB) ? 1 : 2;
+        const D3DXVECTOR3 samples[2] = { segA, segB };
+
+        for (int nSample = 0; nSample < numSamples; nSample++)
+        {
+            const D3DXVECTOR3& center = samples[nSample];
+            ContactPoint best;
+            bool isFound = false;
+
+            for (int triangle : triangles)
+            {
+                D3DXVECTOR3 tri[AXIS], n;
+                mesh->GetTriangle(triangle, tri, n);
+
+                // 裏から当たる三角形・相手の向きと合わない三角形は使わない
+                D3DXVECTOR3 toCenter = center - tri[0];
+
+                if (D3DXVec3Dot(&toCenter, &n) < 0.0f || D3DXVec3Dot(&n, &normal) >= 0.0f)
+                {
+                    continue;
+                }
+
+                D3DXVECTOR3 onTri = ClosestPointOnTriangle(center, tri[0], tri[1], tri[2]);
+                D3DXVECTOR3 delta = center - onTri;
+                float depth = radius + D3DXVec3Dot(&delta, &normal);
+
+                if (depth > -CONTACT_TOLERANCE && (!isFound || depth > best.depth))
+                {
+                    best.depth = depth;
+                    best.position = onTri;
+                    isFound = true;
+                }
+            }
+
+            if (isFound)
+            {
+                best.depth = std::max(best.depth, 0.0f);
+                best.position += normal * (best.depth * HALF);
+                best.featureId = MESH_FEATURE | nSample;
+                candidates.push_back(best);
+            }
+        }
+    }
+    else if (other->GetType() == Collider::BOX || other->GetType() == Collider::CONVEX)
+    {
+        // 箱は8頂点、凸包はワールドの頂点
+        thread_local std::vector<D3DXVECTOR3> vertices;
+        vertices.clear();
+
+        D3DXVECTOR3 axes[AXIS];
+        float half[AXIS] = {};
+        ConvexCollider* convex = nullptr;
+
+        const D3DXVECTOR3& center = other->GetPosition();
+
+        // 法線の向きでの一番奥（三角形の頂点のめり込みの基準）
+        float support = D3DXVec3Dot(&center, &normal);
+
+        if (other->GetType() == Collider::BOX)
+        {
+            GetBoxFrame(static_cast<BoxCollider*>(other), axes, half);
+
+            const int NUM_BOX_VERTICES = 8;
+
+            for (int nCnt = 0; nCnt < NUM_BOX_VERTICES; nCnt++)
+            {
+                D3DXVECTOR3 vertex = center;
+
+                for (int nAxis = 0; nAxis < AXIS; nAxis++)
+                {
+                    float sign = (nCnt & (1 << nAxis)) ? 1.0f : -1.0f;
+                    vertex += axes[nAxis] * (half[nAxis] * sign);
+                }
+
+                vertices.push_back(vertex);
+            }
+
+            for (int nAxis = 0; nAxis < AXIS; nAxis++)
+            {
+                support += half[nAxis] * fabsf(D3DXVec3Dot(&axes[nAxis], &normal));
+            }
+        }
+        else
+        {
+            convex = static_cast<ConvexCollider*>(other);
+
+            for (int nCnt = 0; nCnt < convex->GetVertexCount(); nCnt++)
+            {
+                vertices.push_back(convex->GetVertex(nCnt));
+            }
+
+            D3DXVECTOR3 deepest = convex->GetSupport(normal);
+            support = D3DXVec3Dot(&deepest, &normal);
+        }
+
+        // 点が箱・凸包の中にあるか（凸包は全ての面の内側）
+        auto isInsideShape = [&](const D3DXVECTOR3& point)
+        {
+            if (convex == nullptr)
+            {
+                for (int nAxis = 0; nAxis < AXIS; nAxis++)
+                {
+                    D3DXVECTOR3 local = point - center;
+
+                    if (fabsf(D3DXVec3Dot(&local, &axes[nAxis])) > half[nAxis] + CLIP_TOLERANCE)
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            for (int nFace = 0; nFace < convex->GetTriangleCount(); nFace++)
+            {
+                D3DXVECTOR3 face[AXIS], faceNormal;
+                convex->GetTriangle(nFace, face, faceNormal);
+
+                D3DXVECTOR3 toPoint = point - face[0];
+
+                if (D3DXVec3Dot(&toPoint, &faceNormal) > CLIP_TOLERANCE)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+
+        int numVertices = (int)vertices.size();
+        thread_local std::vector<ContactPoint> vertexBest;
+        thread_local std::vector<char> isVertexFound;
+        vertexBest.assign(numVertices, ContactPoint());
+        isVertexFound.assign(numVertices, 0);
+
+        for (int triangle : triangles)
+        {
+            D3DXVECTOR3 tri[AXIS], n;
+            int vertexIds[AXIS];
+            mesh->GetTriangle(triangle, tri, n, vertexIds);
+
+            D3DXVECTOR3 toCenter = center - tri[0];
+
+            if (D3DXVec3Dot(&toCenter, &n) < 0.0f || D3DXVec3Dot(&n, &normal) >= 0.0f)
+            {
+                continue;
+            }
+
+            // 三角形の面の上に刺さった頂点
+            for (int nCnt = 0; nCnt < numVertices; nCnt++)
+            {
+                D3DXVECTOR3 toVertex = vertices[nCnt] - tri[0];
+                D3DXVECTOR3 onPlane = vertices[nCnt] - n * D3DXVec3Dot(&toVertex, &n);
+                D3DXVECTOR3 onTri = ClosestPointOnTriangle(onPlane, tri[0], tri[1], tri[2]);
+                D3DXVECTOR3 outside = onPlane - onTri;
+
+                if (D3DXVec3LengthSq(&outside) > CLIP_TOLERANCE)
+                {
+                    continue;
+                }
+
+                D3DXVECTOR3 delta = vertices[nCnt] - onPlane;
+                float depth = D3DXVec3Dot(&delta, &normal);
+
+                if (depth > -CONTACT_TOLERANCE && (!isVertexFound[nCnt] || depth > vertexBest[nCnt].depth))
+                {
+                    vertexBest[nCnt].depth = depth;
+                    vertexBest[nCnt].position = vertices[nCnt];
+                    vertexBest[nCnt].featureId = MESH_FEATURE | nCnt;
+                    isVertexFound[nCnt] = 1;
+                }
+            }
+
+            // 箱・凸包の中に入った三角形の頂点（同じ頂点は1回だけ）
+            for (int nVtx = 0; nVtx < AXIS; nVtx++)
+            {
+                unsigned int featureId = MESH_VERTEX_FEATURE | (unsigned int)vertexIds[nVtx];
+
+                bool isDuplicate = std::any_of(candidates.begin(), candidates.end(),
+                    [featureId](const ContactPoint& cp) { return cp.featureId == featureId; });
+
+                if (isDuplicate || !isInsideShape(tri[nVtx]))
+                {
+                    continue;
+                }
+
+                ContactPoint cp;
+                cp.depth = std::max(support - D3DXVec3Dot(&tri[nVtx], &normal), 0.0f);
+                cp.position = tri[nVtx] + normal * (cp.depth * HALF);
+                cp.featureId = featureId;
+                candidates.push_back(cp);
+            }
+        }
+
+        for (int nCnt = 0; nCnt < numVertices; nCnt++)
+        {
+            if (isVertexFound[nCnt])
+            {
+                ContactPoint& cp = vertexBest[nCnt];
+                cp.depth = std::max(cp.depth, 0.0f);
+                cp.position -= normal * (cp.depth * HALF);
+                candidates.push_back(cp);
+            }
+        }
+    }
+
+    // 深い順に最大数まで残す（同じ深さなら番号順にして並びを決める）
+    int count = std::min((int)candidates.size(), MAX_CANDIDATES);
+
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+        [](const ContactPoint& a, const ContactPoint& b)
+        {
+            if (a.depth != b.depth)
+            {
+                return a.depth > b.depth;
+            }
+
+            return a.featureId < b.featureId;
+        });
+
+    std::copy(candidates.begin(), candidates.begin() + count, outPoints);
+
+    return count;
+}
+//=============================================================================
+// 凸形状同士の接触点生成処理（normalはA→B、depthは判定関数のめり込み量）
+// Aは法線の向き、Bは逆向きに一番出ている点の集まり（支持点の面）を取り、
+// 箱の面、なければ点の多い方を基準面にして相手の点を基準面の側面で切り取る。面にならない組は1点にする
+//=============================================================================
+int PhysicsWorld::ConvexContacts(Collider* colA, Collider* colB, const D3DXVECTOR3& normal, float depth, ContactPoint* outPoints)
+{
+    D3DXVECTOR3 pointsA[MAX_FEATURE_POINTS], pointsB[MAX_FEATURE_POINTS];
+    unsigned int idsA[MAX_FEATURE_POINTS], idsB[MAX_FEATURE_POINTS];
+
+    int countA = GetSupportFeature(colA, normal, pointsA, idsA);
+    int countB = GetSupportFeature(colB, -normal, pointsB, idsB);
+
+    if (countA == 0 || countB == 0)
+    {
+        return 0;
+    }
+
+    if (countA >= AXIS || countB >= AXIS)
+    {
+        // 箱の面は平らなので凸包などの少し曲がった点の集まりより優先して基準面にする
+        bool isFaceA = colA->GetType() == Collider::BOX && countA >= AXIS;
+        bool isFaceB = colB->GetType() == Collider::BOX && countB >= AXIS;
+        bool isRefA = (isFaceA != isFaceB) ? isFaceA : countA >= countB;
+        D3DXVECTOR3* ref = isRefA ? pointsA : pointsB;
+        unsigned int* refIds = isRefA ? idsA : idsB;
+        int refCount = isRefA ? countA : countB;
+        D3DXVECTOR3* inc = isRefA ? pointsB : pointsA;
+        unsigned int* incIds = isRefA ? idsB : idsA;
+        int incCount = isRefA ? countB : countA;
+
+        // 基準面の外向き（相手へ向かう向き）
+        D3DXVECTOR3 refNormal = isRefA ? normal : -normal;
+
+        OrderPolygon(ref, refIds, refCount, refNormal);
+        OrderPolygon(inc, incIds, incCount, refNormal);
+
+        // 基準面の高さは一番出ている点にする（少し傾いた面でも浅く見積もらない）
+        float refHeight = -FLT_MAX;
+
+        for (int nCnt = 0; nCnt < refCount; nCnt++)
+        {
+            refHeight = std::max(refHeight, D3DXVec3Dot(&ref[nCnt], &refNormal));
+        }
+
+        // 基準面の頂点の番号が続く形なら、一番小さい番号を面・面の組の番号に使う
+        unsigned int refKey = ContactPoint::NO_FEATURE;
+
+        for (int nCnt = 0; nCnt < refCount; nCnt++)
+        {
+            refKey = std::min(refKey, refIds[nCnt]);
+        }
+
+        bool isStable = refKey != ContactPoint::NO_FEATURE && std::none_of(refIds, refIds + refCount,
+            [](unsigned int id) { return id == ContactPoint::NO_FEATURE; });
+        unsigned int faceFeature = (((isRefA ? 0 : CONVEX_REF_B_FEATURE) | (refKey & (CONVEX_REF_B_FEATURE - 1))) + 1) << 16;
+
+        std::array<ClipVertex, MAX_FEATURE_POINTS * 2> poly, clipped;
+
+        for (int nCnt = 0; nCnt < incCount; nCnt++)
+        {
+            poly[nCnt].position = inc[nCnt];
+            poly[nCnt].feature = nCnt;
+            poly[nCnt].edge = nCnt & (NUM_FACE_EDGES - 1);
+        }
+
+        int count = incCount;
+
+        // 基準面の辺ごとの側面で切り取る（辺は法線から見て左回りなので、外向きは辺×法線）
+        for (int nEdge = 0; nEdge < refCount && count > 0; nEdge++)
+        {
+            D3DXVECTOR3 edge = ref[(nEdge + 1) % refCount] - ref[nEdge];
+            D3DXVECTOR3 side;
+            D3DXVec3Cross(&side, &edge, &refNormal);
+
+            if (D3DXVec3LengthSq(&side) <= MIN_DISTANCE)
+            {
+                continue;
+            }
+
+            D3DXVec3Normalize(&side, &side);
+
+            count = ClipPolygon(poly.data(), std::min(count, MAX_FEATURE_POINTS), side, D3DXVec3Dot(&side, &ref[nEdge]),
+                nEdge & (NUM_FACE_EDGES - 1), clipped.data());
+            std::swap(poly, clipped);
+        }
+
+        int numPoints = 0;
+
+        for (int nCnt = 0; nCnt < count && numPoints < MAX_CANDIDATES; nCnt++)
+        {
+            float separation = D3DXVec3Dot(&poly[nCnt].position, &refNormal) - refHeight;
+
+            if (separation > CONTACT_TOLERANCE)
+            {
+                continue;
+            }
+
+            float pointDepth = std::max(-separation, 0.0f);
+            D3DXVECTOR3 position = poly[nCnt].position + refNormal * (pointDepth * HALF);
+
+            // 線分・点を多角形として切り取ると同じ点が重なって出るので1つにする
+            bool isDuplicate = std::any_of(outPoints, outPoints + numPoints, [&position](const ContactPoint& cp)
+            {
+                D3DXVECTOR3 diff = cp.position - position;
+                return D3DXVec3LengthSq(&diff) <= CLIP_TOLERANCE;
+            });
+
+            if (isDuplicate)
+            {
+                continue;
+            }
+
+            // 切り取りでできた点・番号の続かない点は位置で照合する
+            unsigned int feature = poly[nCnt].feature;
+            bool isVertex = (feature & CLIP_FEATURE) == 0 && incIds[feature] != ContactPoint::NO_FEATURE;
+
+            ContactPoint& cp = outPoints[numPoints++];
+            cp.position = position;
+            cp.depth = pointDepth;
+            cp.featureId = (isStable && isVertex) ? (faceFeature | (incIds[feature] & 0xFFFF)) : ContactPoint::NO_FEATURE;
+        }
+
+        if (numPoints > 0)
+        {
+            return numPoints;
+        }
+    }
+
+    // 辺と辺は最近接点の中間
+    if (countA == 2 && countB == 2)
+    {
+        D3DXVECTOR3 onA, onB;
+        DistanceSqSegmentSegment(pointsA[0], pointsA[1], pointsB[0], pointsB[1], &onA, &onB);
+
+        outPoints[0].position = (onA + onB) * HALF;
+        outPoints[0].depth = depth;
+        outPoints[0].featureId = EDGE_FEATURE << 16;
+        return 1;
+    }
+
+    // 点の少ない方の一番出ている点を、相手の面との中間に置く
+    bool isVertexA = countA <= countB;
+    const D3DXVECTOR3* points = isVertexA ? pointsA : pointsB;
+    int count = isVertexA ? countA : countB;
+    float sign = isVertexA ? 1.0f : -1.0f;
+    int deepest = 0;
+
+    for (int nCnt = 1; nCnt < count; nCnt++)
+    {
+        if (D3DXVec3Dot(&points[nCnt], &normal) * sign > D3DXVec3Dot(&points[deepest], &normal) * sign)
+        {
+            deepest = nCnt;
+        }
+    }
+
+    outPoints[0].position = points[deepest] - normal * (sign * depth * HALF);
+    outPoints[0].depth = depth;
+    outPoints[0].featureId = ContactPoint::NO_FEATURE;
+
+    return 1;
+}
+//=============================================================================
+// 支持点の面の取得処理（dirの向きに一番出ている点から許容量までの点、dirは正規化済み）
+// 番号は箱・凸包の頂点の番号、シリンダー・球・カプセルの点は続かないのでNO_FEATURE
+//=============================================================================
+int PhysicsWorld::GetSupportFeature(Collider* col, const D3DXVECTOR3& dir, D3DXVECTOR3* outPoints, unsigned int* outIds)
+{
+    thread_local std::vector<D3DXVECTOR3> candidates;
+    thread_local std::vector<unsigned int> ids;
+    candidates.clear();
+    ids.clear();
+
+    const D3DXVECTOR3& pos = col->GetPosition();
+
+    switch (col->GetType())
+    {
+    case Collider::BOX:
+    {
+        // 箱は軸ごとの向きの符号で面・辺・頂点を決める
+        // （大きさに合わせた許容量では薄い箱は裏の面まで、大きい箱は少し傾いただけで面の端を落とす）
+        D3DXVECTOR3 axes[AXIS];
+        float half[AXIS];
+        GetBoxFrame(static_cast<BoxCollider*>(col), axes, half);
+
+        const int NUM_BOX_VERTICES = 8;
+        int count = 0;
+
+        for (int nCnt = 0; nCnt < NUM_BOX_VERTICES; nCnt++)
+        {
+            D3DXVECTOR3 vertex = pos;
+            bool isFeature = true;
+
+            for (int nAxis = 0; nAxis < AXIS; nAxis++)
+            {
+                float sign = (nCnt & (1 << nAxis)) ? 1.0f : -1.0f;
+                float axisDot = D3DXVec3Dot(&axes[nAxis], &dir);
+
+                if (fabsf(axisDot) > BOX_FEATURE_AXIS_DOT && axisDot * sign < 0.0f)
+                {
+                    isFeature = false;
+                    break;
+                }
+
+                vertex += axes[nAxis] * (half[nAxis] * sign);
+            }
+
+            if (isFeature)
+            {
+                outPoints[count] = vertex;
+                outIds[count] = nCnt;
+                count++;
+            }
+        }
+
+        return count;
+    }
+    case Collider::CONVEX:
+    {
+        ConvexCollider* convex = static_cast<ConvexCollider*>(col);
+
+        for (int nCnt = 0; nCnt < convex->GetVertexCount(); nCnt++)
+        {
+            candidates.push_back(convex->GetVertex(nCnt));
+            ids.push_back(nCnt);
+        }
+        break;
+    }
+    case Collider::CYLINDER:
+    {
+        // 上下の縁をdirの横向きの角度から等分した点（縦向き固定）
+        CylinderCollider* cylinder = static_cast<CylinderCollider*>(col);
+        float radius = cylinder->GetRadius();
+        float halfHeight = cylinder->GetHeight() * HALF;
+        float base = (dir.x * dir.x + dir.z * dir.z > MIN_DISTANCE) ? atan2f(dir.z, dir.x) : 0.0f;
+
+        for (int nCap = 0; nCap < 2; nCap++)
+        {
+            float y = (nCap == 0) ? -halfHeight : halfHeight;
+
+            for (int nCnt = 0; nCnt < CYLINDER_FEATURE_SEGMENTS; nCnt++)
+            {
+                float angle = base + D3DX_PI * 2.0f * nCnt / CYLINDER_FEATURE_SEGMENTS;
+                candidates.push_back(pos + D3DXVECTOR3(cosf(angle) * radius, y, sinf(angle) * radius));
+                ids.push_back(ContactPoint::NO_FEATURE);
+            }
+        }
+        break;
+    }
+    case Collider::SPHERE:
+        candidates.push_back(pos + dir * static_cast<SphereCollider*>(col)->GetRadius());
+        ids.push_back(ContactPoint::NO_FEATURE);
+        break;
+    case Collider::CAPSULE:
+    {
+        CapsuleCollider* capsule = static_cast<CapsuleCollider*>(col);
+        candidates.push_back(capsule->GetBottom() + dir * capsule->GetRadius());
+        candidates.push_back(capsule->GetTop() + dir * capsule->GetRadius());
+        ids.push_back(ContactPoint::NO_FEATURE);
+        ids.push_back(ContactPoint::NO_FEATURE);
+        break;
+    }
+    default:
+        return 0;
+    }
+
+    // 許容量は形状の大きさに合わせる（少し傾いた面も面として拾う）
+    AABB box = col->GetAABB();
+    D3DXVECTOR3 halfDiagonal = (box.max - box.min) * HALF;
+    float tolerance = D3DXVec3Length(&halfDiagonal) * FEATURE_TOLERANCE_RATIO;
+
+    float maxDot = -FLT_MAX;
+
+    for (const D3DXVECTOR3& point : candidates)
+    {
+        maxDot = std::max(maxDot, D3DXVec3Dot(&point, &dir));
+    }
+
+    // 出ている順に最大数まで残す
+    thread_local std::vector<std::pair<float, int>> order;
+    order.clear();
+
+    for (int nCnt = 0; nCnt < (int)candidates.size(); nCnt++)
+    {
+        float dot = D3DXVec3Dot(&candidates[nCnt], &dir);
+
+        if (dot >= maxDot - tolerance)
+        {
+            order.push_back({ -dot, nCnt });
+        }
+    }
+
+    int count = std::min((int)order.size(), MAX_FEATURE_POINTS);
+    std::partial_sort(order.begin(), order.begin() + count, order.end());
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        outPoints[nCnt] = candidates[order[nCnt].second];
+        outIds[nCnt] = ids[order[nCnt].second];
+    }
+
+    return count;
+}
+//=============================================================================
+// 点の集まりを法線から見て左回りに並べる処理（3点以上のとき）
+//=============================================================================
+void PhysicsWorld::OrderPolygon(D3DXVECTOR3* points, unsigned int* ids, int count, const D3DXVECTOR3& normal)
+{
+    if (count < AXIS)
+    {
+        return;
+    }
+
+    D3DXVECTOR3 center = INIT_VEC3;
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        center += points[nCnt];
+    }
+
+    center /= (float)count;
+
+    // 法線に直交する2軸（左回りになるようにv = n×u）
+    D3DXVECTOR3 helper = (fabsf(normal.x) < 0.9f) ? D3DXVECTOR3(1.0f, 0.0f, 0.0f) : D3DXVECTOR3(0.0f, 1.0f, 0.0f);
+    D3DXVECTOR3 u, v;
+    D3DXVec3Cross(&u, &helper, &normal);
+    D3DXVec3Normalize(&u, &u);
+    D3DXVec3Cross(&v, &normal, &u);
+
+    std::pair<float, int> order[MAX_FEATURE_POINTS];
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        D3DXVECTOR3 offset = points[nCnt] - center;
+        order[nCnt] = { atan2f(D3DXVec3Dot(&offset, &v), D3DXVec3Dot(&offset, &u)), nCnt };
+    }
+
+    std::sort(order, order + count);
+
+    D3DXVECTOR3 sortedPoints[MAX_FEATURE_POINTS];
+    unsigned int sortedIds[MAX_FEATURE_POINTS];
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        sortedPoints[nCnt] = points[order[nCnt].second];
+        sortedIds[nCnt] = ids[order[nCnt].second];
+    }
+
+    std::copy(sortedPoints, sortedPoints + count, points);
+    std::copy(sortedIds, sortedIds + count, ids);
+}
+//=============================================================================
+// 接触点を最大数まで減らす処理（深い点と広がりを残す）
+// anchorFeatureの点があれば一番深い点の代わりに1点目にする
+//=============================================================================
+int PhysicsWorld::ReduceContacts(ContactPoint* points, int count, unsigned int anchorFeature)
+{
+    if (count <= ContactManifold::MAX_POINTS)
+    {
+        return count;
+    }
+
+    std::array<ContactPoint, ContactManifold::MAX_POINTS> kept;
+
+    auto distSq = [](const D3DXVECTOR3& p, const D3DXVECTOR3& q)
+    {
+        D3DXVECTOR3 d = p - q;
+        return D3DXVec3LengthSq(&d);
+    };
+
+    auto take = [&](int index, int slot)
+    {
+        kept[slot] = points[index];
+        points[index] = points[--count];
+    };
+
+    // 1点目：前のステップの1点目、なければ一番深い点
+    int best = 0;
+    for (int nCnt = 1; nCnt < count; nCnt++)
+    {
+        if (points[nCnt].depth > points[best].depth)
+        {
+            best = nCnt;
+        }
+    }
+
+    if (anchorFeature != ContactPoint::NO_FEATURE)
+    {
+        for (int nCnt = 0; nCnt < count; nCnt++)
+        {
+            if (points[nCnt].featureId == anchorFeature)
+            {
+                best = nCnt;
+                break;
+            }
+        }
+    }
+    take(best, 0);
+
+    // 2点目：1点目から一番遠い点
+    best = 0;
+    for (int nCnt = 1; nCnt < count; nCnt++)
+    {
+        if (distSq(points[nCnt].position, kept[0].position) > distSq(points[best].position, kept[0].position))
+        {
+            best = nCnt;
+        }
+    }
+    take(best, 1);
+
+    // 3点目：三角形の面積が最大になる点
+    auto area = [&](const D3DXVECTOR3& p)
+    {
+        D3DXVECTOR3 e1 = kept[1].position - kept[0].position;
+        D3DXVECTOR3 e2 = p - kept[0].position;
+        D3DXVECTOR3 c;
+        D3DXVec3Cross(&c, &e1, &e2);
+        return D3DXVec3LengthSq(&c);
+    };
+
+    best = 0;
+    for (int nCnt = 1; nCnt < count; nCnt++)
+    {
+        if (area(points[nCnt].position) > area(points[best].position))
+        {
+            best = nCnt;
+        }
+    }
+    take(best, 2);
+
+    // 4点目：残りの3点から一番離れている点
+    auto spread = [&](const D3DXVECTOR3& p)
+    {
+        return distSq(p, kept[0].position) + distSq(p, kept[1].position) + distSq(p, kept[2].position);
+    };
+
+    best = 0;
+    for (int nCnt = 1; nCnt < count; nCnt++)
+    {
+        if (spread(points[nCnt].position) > spread(points[best].position))
+        {
+            best = nCnt;
+        }
+    }
+    take(best, 3);
+
+    for (int nCnt = 0; nCnt < ContactManifold::MAX_POINTS; nCnt++)
+    {
+        points[nCnt] = kept[nCnt];
+    }
+
+    return ContactManifold::MAX_POINTS;
+}
+//=============================================================================
+// 予測接触の生成処理（球・カプセル・箱の芯を箱・メッシュに向けて進め、当たる時刻の面を接触にする）
+// 返り値は作った接触点の数（当たらなければ0）
+//=============================================================================
+int PhysicsWorld::SweepContacts(RigidBody* a, RigidBody* b, float dt, D3DXVECTOR3& outNormal, ContactPoint* outPoints)
+{
+    Collider* colA = a->GetColliderPtr();
+    Collider* colB = b->GetColliderPtr();
+
+    // 相手がメッシュ・箱なら自分の芯を動かす（どちらも箱なら高速な方を動かす、メッシュは動かさない）
+    bool isMoveB = (colA->GetType() == Collider::MESH) ||
+        (colA->GetType() == Collider::BOX && colB->GetType() != Collider::MESH && (colB->GetType() != Collider::BOX || b->IsFast()));
+
+    RigidBody* mover = isMoveB ? b : a;
+    Collider* target = isMoveB ? colA : colB;
+
+    if (target->GetType() != Collider::BOX && target->GetType() != Collider::MESH)
+    {
+        return 0;
+    }
+
+    D3DXVECTOR3 segA, segB;
+    float radius = 0.0f;
+
+    if (!GetSweptCore(mover->GetColliderPtr(), segA, segB, radius))
+    {
+        return 0;
+    }
+
+    // 箱・メッシュから見た相対的な移動量（回転は無視する）
+    RigidBody* other = isMoveB ? a : b;
+    D3DXVECTOR3 motion = (mover->GetVelocity() - other->GetVelocity()) * dt;
+
+    float gap = 0.0f;
+    D3DXVECTOR3 normal, point;
+
+    bool isSwept = (target->GetType() == Collider::MESH) ?
+        SweepCoreAgainstMesh(segA, segB, radius, motion, static_cast<MeshCollider*>(target), gap, normal, point) :
+        SweepCoreAgainstBox(segA, segB, radius, motion, static_cast<BoxCollider*>(target), gap, normal, point);
+
+    if (!isSwept)
+    {
+        return 0;
+    }
+
+    // 法線はA→Bにそろえる（求めた法線は箱・メッシュ→芯）
+    outNormal = isMoveB ? normal : -normal;
+
+    ContactPoint& cp = outPoints[0];
+    cp.position = point;
+    cp.depth = -gap;
+    cp.localA = ContactManifold::ToLocal(a, point);
+    cp.localB = ContactManifold::ToLocal(b, point);
+    cp.normalImpulse = 0.0f;
+    cp.tangentImpulse[0] = 0.0f;
+    cp.tangentImpulse[1] = 0.0f;
+    cp.pushImpulse = 0.0f;
+    cp.velocityBias = 0.0f;
+    cp.positionBias = 0.0f;
+    cp.featureId = ContactPoint::NO_FEATURE;
+
+    return 1;
+}
+//=============================================================================
+// 離れた箱同士の予測接触の生成処理（面の軸で一番広い隙間を法線にして、このステップで詰まりそうなら作る）
+// 辺同士の軸は調べないので隙間は実際より狭めに出るが、少し手前で止まるだけでめり込むことはない
+// 返り値は作った接触点の数（詰まらなければ0）
+//=============================================================================
+int PhysicsWorld::BoxBoxSpeculative(RigidBody* a, RigidBody* b, float dt, D3DXVECTOR3& outNormal, ContactPoint* outPoints)
+{
+    BoxCollider* boxA = static_cast<BoxCollider*>(a->GetColliderPtr());
+    BoxCollider* boxB = static_cast<BoxCollider*>(b->GetColliderPtr());
+
+    D3DXVECTOR3 axes[AXIS * 2];
+    float half[AXIS];
+    GetBoxFrame(boxA, axes, half);
+    GetBoxFrame(boxB, axes + AXIS, half);
+
+    float gap = -FLT_MAX;
+    D3DXVECTOR3 normal = INIT_VEC3;
+
+    for (int nCnt = 0; nCnt < AXIS * 2; nCnt++)
+    {
+        float minA, maxA, minB, maxB;
+        ProjectOBB(axes[nCnt], boxA, minA, maxA);
+        ProjectOBB(axes[nCnt], boxB, minB, maxB);
+
+        float axisGap = std::max(minA, minB) - std::min(maxA, maxB);
+
+        if (axisGap > gap)
+        {
+            gap = axisGap;
+            normal = axes[nCnt];
+        }
+    }
+
+    // 面の軸では重なって見える組（辺同士で離れている組）は作らない
+    if (gap <= 0.0f)
+    {
+        return 0;
+    }
+
+    // 法線はA→Bにそろえる
+    D3DXVECTOR3 dir = boxB->GetPosition() - boxA->GetPosition();
+
+    if (D3DXVec3Dot(&dir, &normal) < 0.0f)
+    {
+        normal = -normal;
+    }
+
+    // このステップで近づく量（離れていく組は負になる）に余裕を足しても届かなければ作らない
+    D3DXVECTOR3 relVel = b->GetVelocity() - a->GetVelocity();
+    float approach = -D3DXVec3Dot(&relVel, &normal) * dt;
+
+    if (gap > approach + SPECULATIVE_MARGIN)
+    {
+        return 0;
+    }
+
+    int count = BoxBoxContacts(boxA, boxB, normal, gap, outPoints);
+    count = ReduceContacts(outPoints, count, ContactPoint::NO_FEATURE);
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        ContactPoint& cp = outPoints[nCnt];
+        cp.localA = ContactManifold::ToLocal(a, cp.position);
+        cp.localB = ContactManifold::ToLocal(b, cp.position);
+        cp.normalImpulse = 0.0f;
+        cp.tangentImpulse[0] = 0.0f;
+        cp.tangentImpulse[1] = 0.0f;
+        cp.pushImpulse = 0.0f;
+        cp.velocityBias = 0.0f;
+        cp.positionBias = 0.0f;
+    }
+
+    outNormal = normal;
+    return count;
+}
+//=============================================================================
+// 芯（線分＋半径）を箱に向けて進める処理（保守的前進法で当たる時刻を求める）
+// outGapは今の位置での接触面までの隙間、outNormalは箱→芯、outPointは今の位置での芯側の接触点
+//=============================================================================
+bool PhysicsWorld::SweepCoreAgainstBox(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& motion,
+    BoxCollider* box, float& outGap, D3DXVECTOR3& outNormal, D3DXVECTOR3& outPoint)
+{
+    float motionLength = D3DXVec3Length(&motion);
+
+    if (motionLength < MIN_DISTANCE)
+    {
+        return false;
+    }
+
+    float t = 0.0f;
+
+    for (int nIter = 0; nIter < TOI_ITERATIONS; nIter++)
+    {
+        D3DXVECTOR3 offset = motion * t;
+        D3DXVECTOR3 p0 = segA + offset;
+        D3DXVECTOR3 p1 = segB + offset;
+
+        // 線分と箱の最近接点（交互に投影して詰める）
+        D3DXVECTOR3 onSegment = (p0 + p1) * HALF;
+        D3DXVECTOR3 onBox = onSegment;
+
+        for (int nCnt = 0; nCnt < SEGMENT_ITERATIONS; nCnt++)
+        {
+            onBox = ClosestPointOnOBB(onSegment, box);
+            onSegment = ClosestPointOnLineSegment(onBox, p0, p1);
+        }
+
+        D3DXVECTOR3 delta = onSegment - onBox;
+        float distance = D3DXVec3Length(&delta);
+        float gap = distance - radius;
+
+        if (gap <= TOI_TOLERANCE)
+        {
+            // 芯が箱の中にある（通常の判定に任せる）
+            if (distance < MIN_DISTANCE)
+            {
+                return false;
+            }
+
+            D3DXVECTOR3 normal = delta / distance;
+            float approach = -D3DXVec3Dot(&motion, &normal);
+
+            // 離れていく向きなら作らない
+            if (approach <= 0.0f)
+            {
+                return false;
+            }
+
+            // 当たる時刻の接触面を今の位置まで戻したときの隙間
+            outGap = std::max(gap + approach * t, 0.0f);
+            outNormal = normal;
+
+            // 接触点は今の位置の芯の表面に置く（当たる時刻の点だと腕が長くなり回転に逃げる）
+            outPoint = onBox - offset;
+            return true;
+        }
+
+        // 隙間の分だけは当たらずに進める
+        t += gap / motionLength;
+
+        if (t > 1.0f)
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+//=============================================================================
+// 芯（線分＋半径）をメッシュに向けて進める処理（SweepCoreAgainstBoxと同じ、三角形は動かす範囲で先に集める）
+// outGapは今の位置での接触面までの隙間、outNormalはメッシュ→芯、outPointは今の位置での芯側の接触点
+//=============================================================================
+bool PhysicsWorld::SweepCoreAgainstMesh(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& motion,
+    MeshCollider* mesh, float& outGap, D3DXVECTOR3& outNormal, D3DXVECTOR3& outPoint)
+{
+    float motionLength = D3DXVec3Length(&motion);
+
+    if (motionLength < MIN_DISTANCE)
+    {
+        return false;
+    }
+
+    // 動かす範囲の三角形
+    thread_local std::vector<int> triangles;
+    triangles.clear();
+
+    D3DXVECTOR3 endA = segA + motion;
+    D3DXVECTOR3 endB = segB + motion;
+    D3DXVECTOR3 extent(radius, radius, radius);
+    AABB box;
+    D3DXVec3Minimize(&box.min, &segA, &segB);
+    D3DXVec3Minimize(&box.min, &box.min, &endA);
+    D3DXVec3Minimize(&box.min, &box.min, &endB);
+    D3DXVec3Maximize(&box.max, &segA, &segB);
+    D3DXVec3Maximize(&box.max, &box.max, &endA);
+    D3DXVec3Maximize(&box.max, &box.max, &endB);
+    box.min -= extent;
+    box.max += extent;
+
+    mesh->QueryTriangles(box, triangles);
+
+    if (triangles.empty())
+    {
+        return false;
+    }
+
+    float t = 0.0f;
+
+    for (int nIter = 0; nIter < TOI_ITERATIONS; nIter++)
+    {
+        D3DXVECTOR3 offset = motion * t;
+        D3DXVECTOR3 onCore, onMesh, faceNormal;
+
+        float distSq = ClosestPointsToTriangles(segA + offset, segB + offset, mesh, triangles, motion, onCore, onMesh, faceNormal);
+
+        if (distSq == FLT_MAX)
+        {
+            return false;
+        }
+
+        D3DXVECTOR3 delta = onCore - onMesh;
+        float distance = sqrtf(distSq);
+        float gap = distance - radius;
+
+        if (gap <= TOI_TOLERANCE)
+        {
+            // 芯が面を貫いている（通常の判定に任せる）
+            if (distance < MIN_DISTANCE)
+            {
+                return false;
+            }
+
+            D3DXVECTOR3 normal = delta / distance;
+            float approach = -D3DXVec3Dot(&motion, &normal);
+
+            // 離れていく向きなら作らない
+            if (approach <= 0.0f)
+            {
+                return false;
+            }
+
+            outGap = std::max(gap + approach * t, 0.0f);
+            outNormal = normal;
+            outPoint = onMesh - offset;
+            return true;
+        }
+
+        t += gap / motionLength;
+
+        if (t > 1.0f)
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+//=============================================================================
+// 芯とメッシュの三角形の最近接点の取得処理（返り値は距離の2乗、使える三角形がなければFLT_MAX）
+// 芯がまるごと裏にある三角形と、motionの向きで見て裏から近づく三角形は使わない
+//=============================================================================
+float PhysicsWorld::ClosestPointsToTriangles(const D3DXVECTOR3& p0, const D3DXVECTOR3& p1, MeshCollider* mesh, const std::vector<int>& triangles,
+    const D3DXVECTOR3& motion, D3DXVECTOR3& outOnCore, D3DXVECTOR3& outOnMesh, D3DXVECTOR3& outNormal)
+{
+    float best = FLT_MAX;
+
+    for (int triangle : triangles)
+    {
+        D3DXVECTOR3 tri[AXIS], n;
+        mesh->GetTriangle(triangle, tri, n);
+
+        if (D3DXVec3Dot(&n, &motion) >= 0.0f)
+        {
+            continue;
+        }
+
+        D3DXVECTOR3 r0 = p0 - tri[0];
+        D3DXVECTOR3 r1 = p1 - tri[0];
+
+        if (std::max(D3DXVec3Dot(&r0, &n), D3DXVec3Dot(&r1, &n)) < 0.0f)
+        {
+            continue;
+        }
+
+        D3DXVECTOR3 onCore, onMesh;
+        float distSq = DistanceSqSegmentTriangle(p0, p1, tri, onCore, onMesh);
+
+        if (distSq < best)
+        {
+            best = distSq;
+            outOnCore = onCore;
+            outOnMesh = onMesh;
+            outNormal = n;
+        }
+    }
+
+    return best;
+}
+//=============================================================================
+// 予測接触で動かす芯の取得処理（球は点、カプセルは線分、箱・凸包は内接球）
+//=============================================================================
+bool PhysicsWorld::GetSweptCore(Collider* col, D3DXVECTOR3& outSegA, D3DXVECTOR3& outSegB, float& outRadius)
+{
+    switch (col->GetType())
+    {
+    case Collider::SPHERE:
+    {
+        SphereCollider* sphere = static_cast<SphereCollider*>(col);
+        outSegA = outSegB = sphere->GetPosition();
+        outRadius = sphere->GetRadius();
+        return true;
+    }
+    case Collider::CAPSULE:
+    {
+        // 判定関数と同じく軸は縦向き
+        CapsuleCollider* capsule = static_cast<CapsuleCollider*>(col);
+        D3DXVECTOR3 half(0.0f, capsule->GetHalfHeight(), 0.0f);
+        outSegA = capsule->GetPosition() - half;
+        outSegB = capsule->GetPosition() + half;
+        outRadius = capsule->GetRadius();
+        return true;
+    }
+    case Collider::BOX:
+    {
+        // 内接球なら箱より内側にあるので、芯が止まれば箱も抜けない
+        BoxCollider* box = static_cast<BoxCollider*>(col);
+        const D3DXVECTOR3& size = box->GetScaledSize();
+        outSegA = outSegB = box->GetPosition();
+        outRadius = std::min({ size.x, size.y, size.z }) * HALF;
+        return true;
+    }
+    case Collider::CONVEX:
+    {
+        // 箱と同じく内接球（原点から一番近い面までの距離）
+        ConvexCollider* convex = static_cast<ConvexCollider*>(col);
+        outSegA = outSegB = convex->GetPosition();
+        outRadius = convex->GetInnerRadius();
+        return outRadius > 0.0f;
+    }
+    default:
+        return false;
+    }
+}
+//=============================================================================
+// 有効質量の計算処理（dir方向に単位インパルスを加えたときの相対速度変化の逆数）
+//=============================================================================
+float PhysicsWorld::ComputeEffectiveMass(const ContactManifold* manifold, const ContactPoint& cp, const D3DXVECTOR3& dir)
+{
+    D3DXVECTOR3 rnA, rnB, angA, angB;
+    D3DXVec3Cross(&rnA, &cp.rA, &dir);
+    D3DXVec3Cross(&rnB, &cp.rB, &dir);
+    D3DXVec3TransformNormal(&angA, &rnA, &manifold->invInertiaA);
+    D3DXVec3TransformNormal(&angB, &rnB, &manifold->invInertiaB);
+
+    float k = manifold->invMassA + manifold->invMassB + D3DXVec3Dot(&rnA, &angA) + D3DXVec3Dot(&rnB, &angB);
+
+    return (k > 0.0f) ? 1.0f / k : 0.0f;
+}
+//=============================================================================
+// 接触点での相対速度（B - A）の取得処理
+//=============================================================================
+D3DXVECTOR3 PhysicsWorld::GetRelativeVelocity(const ContactPoint& cp,
+    const D3DXVECTOR3& vA, const D3DXVECTOR3& wA, const D3DXVECTOR3& vB, const D3DXVECTOR3& wB)
+{
+    D3DXVECTOR3 wrA, wrB;
+    D3DXVec3Cross(&wrA, &wA, &cp.rA);
+    D3DXVec3Cross(&wrB, &wB, &cp.rB);
+
+    return (vB + wrB) - (vA + wrA);
+}
+//=============================================================================
+// 接触点へのインパルス適用処理（AにはマイナスBにはプラス）
+//=============================================================================
+void PhysicsWorld::ApplyContactImpulse(const ContactManifold* manifold, const ContactPoint& cp, const D3DXVECTOR3& impulse,
+    D3DXVECTOR3& vA, D3DXVECTOR3& wA, D3DXVECTOR3& vB, D3DXVECTOR3& wB)
+{
+    D3DXVECTOR3 torque, angVel;
+
+    vA -= impulse * manifold->invMassA;
+    D3DXVec3Cross(&torque, &cp.rA, &impulse);
+    D3DXVec3TransformNormal(&angVel, &torque, &manifold->invInertiaA);
+    wA -= angVel;
+
+    vB += impulse * manifold->invMassB;
+    D3DXVec3Cross(&torque, &cp.rB, &impulse);
+    D3DXVec3TransformNormal(&angVel, &torque, &manifold->invInertiaB);
+    wB += angVel;
+}
+//=============================================================================
+// スレッドプールの取得処理（1スレッドならnullptr、スレッド数が変わったら作り直す）
+//=============================================================================
+ThreadPool* PhysicsWorld::GetThreadPool(void)
+{
+    if (m_ThreadCount <= 1)
+    {
+        m_pThreadPool.reset();
+        return nullptr;
+    }
+
+    if (!m_pThreadPool || m_pThreadPool->GetThreadCount() != m_ThreadCount)
+    {
+        m_pThreadPool = std::make_unique<ThreadPool>(m_ThreadCount);
+    }
+
+    return m_pThreadPool.get();
+}
+//=============================================================================
+// ナローフェーズの判定処理（ペアのbegin～end-1を判定して結果をoutに足す）
+// 剛体・キャッシュには書き込まないので別々のバッファなら並列に呼べる
+//=============================================================================
+void PhysicsWorld::DetectContacts(int begin, int end, float dt, std::vector<NarrowphaseContact>& out)
+{
+    for (int nCnt = begin; nCnt < end; nCnt++)
+    {
+        RigidBody* A = m_Pairs[nCnt].a;
+        RigidBody* B = m_Pairs[nCnt].b;
+        D3DXVECTOR3 push;
+
+        bool isHit = m_NarrowphaseBatch.IsBatched(nCnt) ?
+            m_NarrowphaseBatch.GetResult(nCnt, push) :
+            CheckCollision(A, B, push);
+
+        // トリガーは重なりだけを残して接触点は作らない
+        if (A->IsTrigger() || B->IsTrigger())
+        {
+            if (isHit)
+            {
+                out.emplace_back();
+
+                NarrowphaseContact& contact = out.back();
+                contact.key = ((unsigned long long)A->GetPoolIndex() << 32) | (unsigned int)B->GetPoolIndex();
+                contact.a = A;
+                contact.b = B;
+                contact.normal = INIT_VEC3;
+                contact.numPoints = 0;
+                contact.isOnGround = false;
+                contact.isSpeculative = false;
+                contact.isTrigger = true;
+            }
+
+            continue;
+        }
+
+        std::array<ContactPoint, MAX_CANDIDATES> points;
+        D3DXVECTOR3 normal = INIT_VEC3;
+        int numPoints = 0;
+        bool isOnGround = false;
+
+        if (isHit)
+        {
+            D3DXVec3Normalize(&normal, &push);
+
+            // 接地はまとめるときに反映する（同じ剛体を別のスレッドが触るため）
+            isOnGround = normal.y > 0.7f;
+
+            numPoints = GenerateContacts(A, B, push, normal, points.data());
+        }
+        else if (A->IsFast() || B->IsFast())
+        {
+            // 高速な剛体は今は離れていてもステップ中に当たるなら予測接触を作る（すり抜け対策）
+            numPoints = SweepContacts(A, B, dt, normal, points.data());
+        }
+        else if (A->GetColliderPtr()->GetType() == Collider::BOX && B->GetColliderPtr()->GetType() == Collider::BOX)
+        {
+            // 箱同士は離れていてもこのステップで触れそうなら予測接触を作る（積んだ箱が落ちてきて深くめり込むのを防ぐ）
+            numPoints = BoxBoxSpeculative(A, B, dt, normal, points.data());
+        }
+
+        if (numPoints == 0 && !isOnGround)
+        {
+            continue;
+        }
+
+        out.emplace_back();
+
+        NarrowphaseContact& contact = out.back();
+        contact.key = ((unsigned long long)A->GetPoolIndex() << 32) | (unsigned int)B->GetPoolIndex();
+        contact.a = A;
+        contact.b = B;
+        contact.normal = normal;
+        contact.numPoints = std::min(numPoints, ContactManifold::MAX_POINTS);
+        contact.isOnGround = isOnGround;
+        contact.isSpeculative = !isHit;
+        contact.isTrigger = false;
+
+        std::copy(points.begin(), points.begin() + contact.numPoints, contact.points.begin());
+    }
+}
+//=============================================================================
+// ナローフェーズの結果のまとめ処理
+// 剛体の組のキー順に並べてから反映するので、スレッド数やペアの順番が変わっても同じ結果になる
+//=============================================================================
+void PhysicsWorld::MergeContacts(void)
+{
+    m_SortedContacts.clear();
+
+    for (auto& contacts : m_ThreadContacts)
+    {
+        for (NarrowphaseContact& contact : contacts)
+        {
+            m_SortedContacts.push_back(&contact);
+        }
+    }
+
+    std::sort(m_SortedContacts.begin(), m_SortedContacts.end(),
+        [](const NarrowphaseContact* lhs, const NarrowphaseContact* rhs) { return lhs->key < rhs->key; });
+
+    m_ContactCache.BeginStep();
+    m_Manifolds.clear();
+    m_NumSpeculative = 0;
+
+    // 前のステップの重なりと比べて入ってきたものに印を付ける（どちらもキー順）
+    std::swap(m_TriggerKeys, m_PrevTriggerKeys);
+    m_TriggerKeys.clear();
+    m_TriggerOverlaps.clear();
+
+    for (const NarrowphaseContact* contact : m_SortedContacts)
+    {
+        RigidBody* A = contact->a;
+        RigidBody* B = contact->b;
+
+        if (contact->isTrigger)
+        {
+            bool isEnter = !std::binary_search(m_PrevTriggerKeys.begin(), m_PrevTriggerKeys.end(), contact->key);
+
+            if (A->IsTrigger())
+            {
+                m_TriggerOverlaps.push_back({ A, B, isEnter });
+            }
+            else
+            {
+                m_TriggerOverlaps.push_back({ B, A, isEnter });
+            }
+
+            m_TriggerKeys.push_back(contact->key);
+            continue;
+        }
+
+        // ここで接地判定
+        if (contact->isOnGround)
+        {
+            if (A->IsDynamic()) A->SetOnGround(true);
+            if (B->IsDynamic()) B->SetOnGround(true);
+        }
+
+        if (contact->numPoints == 0)
+        {
+            continue;
+        }
+
+        if (contact->isSpeculative)
+        {
+            m_NumSpeculative += contact->numPoints;
+        }
+
+        // 起きている剛体に触れられたら起こし、同じアイランドにまとめる
+        if (A->IsDynamic() && B->IsDynamic())
+        {
+            A->WakeUp();
+            B->WakeUp();
+            UniteIslands(A->GetIslandIndex(), B->GetIslandIndex());
+        }
+
+        ContactManifold& manifold = m_ContactCache.Find(A, B);
+        manifold.Update(contact->points.data(), contact->numPoints, contact->normal);
+
+        m_Manifolds.push_back(&manifold);
+    }
+
+    m_ContactCache.EndStep();
+}
+//=============================================================================
+// アイランドの組み立て処理（接触を重力方向の順に並べてからアイランドごとに分ける）
+// アイランドの並びは根の剛体の番号順、アイランド内は並べた順のままなのでスレッド数に依らない
+//=============================================================================
+void PhysicsWorld::BuildIslands(void)
+{
+    // 重力方向で下にある接触から解く（積み重ねの支えが1回の反復で上まで伝わる）
+    D3DXVECTOR3 gravity = m_Gravity;
+
+    std::sort(m_Manifolds.begin(), m_Manifolds.end(),
+        [&gravity](const ContactManifold* lhs, const ContactManifold* rhs)
+        {
+            D3DXVECTOR3 posL = lhs->a->GetPosition() + lhs->b->GetPosition();
+            D3DXVECTOR3 posR = rhs->a->GetPosition() + rhs->b->GetPosition();
+            return D3DXVec3Dot(&posL, &gravity) > D3DXVec3Dot(&posR, &gravity);
+        });
+
+    // 多様体の属するアイランドの根（静的剛体はアイランドを持たないので動的な方で引く）
+    auto rootOf = [this](const ContactManifold* manifold)
+    {
+        const RigidBody* body = manifold->a->IsDynamic() ? manifold->a : manifold->b;
+        return FindIsland(body->GetIslandIndex());
+    };
+
+    int numBodies = (int)m_DynamicBodies.size();
+    m_IslandOfRoot.assign(numBodies, -1);
+    m_Islands.clear();
+
+    for (ContactManifold* manifold : m_Manifolds)
+    {
+        m_IslandOfRoot[rootOf(manifold)] = 0;
+    }
+
+    // 根の番号が小さい順にアイランドを並べる
+    for (int nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        if (m_IslandOfRoot[nCnt] < 0)
+        {
+            continue;
+        }
+
+        m_IslandOfRoot[nCnt] = (int)m_Islands.size();
+        m_Islands.push_back({ 0, 0, 0, 0, true });
+    }
+
+    for (ContactManifold* manifold : m_Manifolds)
+    {
+        m_Islands[m_IslandOfRoot[rootOf(manifold)]].count++;
+    }
+
+    int begin = 0;
+
+    for (Island& island : m_Islands)
+    {
+        island.begin = begin;
+        begin += island.count;
+        island.count = 0;
+    }
+
+    // 並べた順を崩さずにアイランドごとに詰める
+    m_IslandManifolds.resize(m_Manifolds.size());
+
+    for (ContactManifold* manifold : m_Manifolds)
+    {
+        Island& island = m_Islands[m_IslandOfRoot[rootOf(manifold)]];
+        m_IslandManifolds[island.begin + island.count] = manifold;
+        island.count++;
+    }
+
+    // 配る順番（大きいアイランドを先に取らせて終わりをそろえる）
+    m_IslandOrder.resize(m_Islands.size());
+
+    for (int nCnt = 0; nCnt < (int)m_IslandOrder.size(); nCnt++)
+    {
+        m_IslandOrder[nCnt] = nCnt;
+    }
+
+    std::stable_sort(m_IslandOrder.begin(), m_IslandOrder.end(),
+        [this](int lhs, int rhs) { return m_Islands[lhs].count > m_Islands[rhs].count; });
+}
+//=============================================================================
+// アイランド1つ分の解決処理（ほかのアイランドとは剛体を共有しないので並列に呼べる）
+//=============================================================================
+void PhysicsWorld::SolveIsland(Island& island, float dt)
+{
+    ContactManifold* const* manifolds = m_IslandManifolds.data() + island.begin;
+    int count = island.count;
+
+    // 速度の解決（ウォームスタート後に累積インパルスを反復で更新）
+    PrepareContacts(manifolds, count, dt);
+
+    if (m_isWarmStarting)
+    {
+        WarmStart(manifolds, count);
+    }
+    else
+    {
+        // 前のステップの累積インパルスを捨てて0から解く
+        for (int nManifold = 0; nManifold < count; nManifold++)
+        {
+            for (int nCnt = 0; nCnt < manifolds[nManifold]->numPoints; nCnt++)
+            {
+                ContactPoint& cp = manifolds[nManifold]->points[nCnt];
+                cp.normalImpulse = 0.0f;
+                cp.tangentImpulse[0] = cp.tangentImpulse[1] = 0.0f;
+            }
+        }
+    }
+
+    int numPoints = 0;
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        numPoints += manifolds[nCnt]->numPoints;
+    }
+
+    // 1回のパスで加えたインパルスが十分小さくなったら打ち切る
+    float impulseLimit = m_ImpulseTolerance * numPoints;
+    bool isVelocityConverged = false;
+
+    island.velocityPasses = 0;
+
+    while (island.velocityPasses < m_VelocityIterations)
+    {
+        float totalImpulse = SolveVelocity(manifolds, count);
+        island.velocityPasses++;
+
+        if (totalImpulse <= impulseLimit)
+        {
+            isVelocityConverged = true;
+            break;
+        }
+    }
+
+    // めり込みの解消（疑似速度だけを解くので反発が生まれない）
+    // 残りのめり込みが許容量を下回ったら打ち切る（めり込みがなければ1回で抜ける）
+    bool isPositionConverged = (m_PositionIterations == 0);
+
+    island.positionPasses = 0;
+
+    while (island.positionPasses < m_PositionIterations)
+    {
+        float maxPenetration = SolvePosition(manifolds, count, dt);
+        island.positionPasses++;
+
+        if (maxPenetration <= m_PenetrationTolerance)
+        {
+            isPositionConverged = true;
+            break;
+        }
+    }
+
+    island.isConverged = isVelocityConverged && isPositionConverged;
+}
+//=============================================================================
+// 接触の事前計算処理（逆質量・逆慣性・有効質量をステップ中は固定）
+//=============================================================================
+void PhysicsWorld::PrepareContacts(ContactManifold* const* manifolds, int count, float dt)
+{
+    float invDt = (dt > 0.0f) ? 1.0f / dt : 0.0f;
+
+    for (int nManifold = 0; nManifold < count; nManifold++)
+    {
+        ContactManifold* manifold = manifolds[nManifold];
+        RigidBody* A = manifold->a;
+        RigidBody* B = manifold->b;
+        const D3DXVECTOR3& n = manifold->normal;
+
+        manifold->invMassA = A->GetInverseMass();
+        manifold->invMassB = B->GetInverseMass();
+        A->GetInverseInertiaWorld(manifold->invInertiaA);
+        B->GetInverseInertiaWorld(manifold->invInertiaB);
+        manifold->friction = sqrtf(A->GetFriction() * B->GetFriction());
+
+        // 摩擦方向は法線だけから決めてフレーム間でそろえる（ウォームスタートのため）
+        if (fabsf(n.x) >= 0.57735f)
+        {
+            manifold->tangent[0] = D3DXVECTOR3(n.y, -n.x, 0.0f);
+        }
+        else
+        {
+            manifold->tangent[0] = D3DXVECTOR3(0.0f, n.z, -n.y);
+        }
+
+        D3DXVec3Normalize(&manifold->tangent[0], &manifold->tangent[0]);
+        D3DXVec3Cross(&manifold->tangent[1], &n, &manifold->tangent[0]);
+
+        float e = std::min(A->GetRestitution(), B->GetRestitution());
+
+        for (int nCnt = 0; nCnt < manifold->numPoints; nCnt++)
+        {
+            ContactPoint& cp = manifold->points[nCnt];
+
+            cp.rA = cp.position - A->GetPosition();
+            cp.rB = cp.position - B->GetPosition();
+            cp.normalMass = ComputeEffectiveMass(manifold, cp, n);
+            cp.tangentMass[0] = ComputeEffectiveMass(manifold, cp, manifold->tangent[0]);
+            cp.tangentMass[1] = ComputeEffectiveMass(manifold, cp, manifold->tangent[1]);
+
+            D3DXVECTOR3 relVel = GetRelativeVelocity(cp, A->GetVelocity(), A->GetAngularVelocity(), B->GetVelocity(), B->GetAngularVelocity());
+            float velAlongNormal = D3DXVec3Dot(&relVel, &n);
+
+            if (cp.depth < 0.0f)
+            {
+                // 予測接触：隙間をこのステップで詰めきる速さまでは近づいてよい
+                cp.velocityBias = cp.depth * invDt;
+
+                // まだ触れていないので摩擦は掛けない（当たる前に回転が付くのを防ぐ）
+                cp.tangentMass[0] = 0.0f;
+                cp.tangentMass[1] = 0.0f;
+            }
+            else
+            {
+                // ある程度の速さでぶつかったときだけ跳ね返す
+                // 前のステップから力を受けている点（予測接触で止めた点など）はぶつかった瞬間ではないので跳ね返さない
+                bool isImpact = (velAlongNormal < -RESTITUTION_THRESHOLD) && (cp.normalImpulse <= 0.0f);
+                cp.velocityBias = isImpact ? -e * velAlongNormal : 0.0f;
+            }
+
+            // 許容量を超えためり込みを疑似速度で押し戻す
+            cp.positionBias = POSITION_CORRECTION * std::max(cp.depth - POSITION_SLOP, 0.0f) * invDt;
+            cp.pushImpulse = 0.0f;
+        }
+    }
+}
+//=============================================================================
+// ウォームスタート処理（前フレームの累積インパルスを先に加える）
+//=============================================================================
+void PhysicsWorld::WarmStart(ContactManifold* const* manifolds, int count)
+{
+    for (int nManifold = 0; nManifold < count; nManifold++)
+    {
+        ContactManifold* manifold = manifolds[nManifold];
+        RigidBody* A = manifold->a;
+        RigidBody* B = manifold->b;
+        D3DXVECTOR3 vA = A->GetVelocity();
+        D3DXVECTOR3 wA = A->GetAngularVelocity();
+        D3DXVECTOR3 vB = B->GetVelocity();
+        D3DXVECTOR3 wB = B->GetAngularVelocity();
+
+        for (int nCnt = 0; nCnt < manifold->numPoints; nCnt++)
+        {
+            const ContactPoint& cp = manifold->points[nCnt];
+
+            D3DXVECTOR3 impulse = manifold->normal * cp.normalImpulse +
+                manifold->tangent[0] * cp.tangentImpulse[0] +
+                manifold->tangent[1] * cp.tangentImpulse[1];
+
+            ApplyContactImpulse(manifold, cp, impulse, vA, wA, vB, wB);
+        }
+
+        if (A->IsDynamic())
+        {
+            A->SetVelocity(vA);
+            A->SetAngularVelocity(wA);
+        }
+
+        if (B->IsDynamic())
+        {
+            B->SetVelocity(vB);
+            B->SetAngularVelocity(wB);
+        }
+    }
+}
+//=============================================================================
+// 速度の反復解決処理（摩擦→法線の順に累積インパルスをクランプ）
+// 返り値はこのパスで加えたインパルスの大きさの合計
+//=============================================================================
+float PhysicsWorld::SolveVelocity(ContactManifold* const* manifolds, int count)
+{
+    float totalImpulse = 0.0f;
+
+    for (int nManifold = 0; nManifold < count; nManifold++)
+    {
+        ContactManifold* manifold = manifolds[nManifold];
+        RigidBody* A = manifold->a;
+        RigidBody* B = manifold->b;
+        D3DXVECTOR3 vA = A->GetVelocity();
+        D3DXVECTOR3 wA = A->GetAngularVelocity();
+        D3DXVECTOR3 vB = B->GetVelocity();
+        D3DXVECTOR3 wB = B->GetAngularVelocity();
+
+        for (int nCnt = 0; nCnt < manifold->numPoints; nCnt++)
+        {
+            ContactPoint& cp = manifold->points[nCnt];
+
+            // 摩擦（法線インパルスに比例した範囲に収める）
+            float maxFriction = manifold->friction * cp.normalImpulse;
+
+            for (int axis = 0; axis < 2; axis++)
+            {
+                const D3DXVECTOR3& t = manifold->tangent[axis];
+                D3DXVECTOR3 relVel = GetRelativeVelocity(cp, vA, wA, vB, wB);
+
+                float lambda = -D3DXVec3Dot(&relVel, &t) * cp.tangentMass[axis];
+                float oldImpulse = cp.tangentImpulse[axis];
+                cp.tangentImpulse[axis] = std::clamp(oldImpulse + lambda, -maxFriction, maxFriction);
+                lambda = cp.tangentImpulse[axis] - oldImpulse;
+                totalImpulse += fabsf(lambda);
+
+                ApplyContactImpulse(manifold, cp, t * lambda, vA, wA, vB, wB);
+            }
+
+            // 法線（引っ張らないように累積を0以上にする）
+            D3DXVECTOR3 relVel = GetRelativeVelocity(cp, vA, wA, vB, wB);
+            float velAlongNormal = D3DXVec3Dot(&relVel, &manifold->normal);
+
+            float lambda = (cp.velocityBias - velAlongNormal) * cp.normalMass;
+            float oldImpulse = cp.normalImpulse;
+            cp.normalImpulse = std::max(oldImpulse + lambda, 0.0f);
+            lambda = cp.normalImpulse - oldImpulse;
+            totalImpulse += fabsf(lambda);
+
+            ApplyContactImpulse(manifold, cp, manifold->normal * lambda, vA, wA, vB, wB);
+        }
+
+        if (A->IsDynamic())
+        {
+            A->SetVelocity(vA);
+            A->SetAngularVelocity(wA);
+        }
+
+        if (B->IsDynamic())
+        {
+            B->SetVelocity(vB);
+            B->SetAngularVelocity(wB);
+        }
+    }
+
+    return totalImpulse;
+}
+//=============================================================================
+// めり込みの反復解決処理（疑似速度だけを更新するスプリットインパルス）
+// 返り値はこのパスの前に残っていた最大のめり込み量
+//=============================================================================
+float PhysicsWorld::SolvePosition(ContactManifold* const* manifolds, int count, float dt)
+{
+    float maxPenetration = 0.0f;
+
+    for (int nManifold = 0; nManifold < count; nManifold++)
+    {
+        ContactManifold* manifold = manifolds[nManifold];
+        RigidBody* A = manifold->a;
+        RigidBody* B = manifold->b;
+        D3DXVECTOR3 vA = A->GetPushVelocity();
+        D3DXVECTOR3 wA = A->GetTurnVelocity();
+        D3DXVECTOR3 vB = B->GetPushVelocity();
+        D3DXVECTOR3 wB = B->GetTurnVelocity();
+
+        for (int nCnt = 0; nCnt < manifold->numPoints; nCnt++)
+        {
+            ContactPoint& cp = manifold->points[nCnt];
+
+            if (cp.positionBias <= 0.0f)
+            {
+                continue;
+            }
+
+            D3DXVECTOR3 relVel = GetRelativeVelocity(cp, vA, wA, vB, wB);
+            float velAlongNormal = D3DXVec3Dot(&relVel, &manifold->normal);
+
+            // まだ押し出しきれていない分をめり込み量に直して記録する
+            float residual = cp.positionBias - velAlongNormal;
+            maxPenetration = std::max(maxPenetration, residual * dt);
+
+            float lambda = residual * cp.normalMass;
+            float oldImpulse = cp.pushImpulse;
+            cp.pushImpulse = std::max(oldImpulse + lambda, 0.0f);
+            lambda = cp.pushImpulse - oldImpulse;
+
+            ApplyContactImpulse(manifold, cp, manifold->normal * lambda, vA, wA, vB, wB);
+        }
+
+        if (A->IsDynamic())
+        {
+            A->SetPushVelocity(vA);
+            A->SetTurnVelocity(wA);
+        }
+
+        if (B->IsDynamic())
+        {
+            B->SetPushVelocity(vB);
+            B->SetTurnVelocity(wB);
+        }
+    }
+
+    return maxPenetration;
+}
+//=============================================================================
+// アイランドの根を探す
+//=============================================================================
+int PhysicsWorld::FindIsland(int index)
+{
+    while (m_IslandParent[index] != index)
+    {
+        // 経路を半分に縮める
+        m_IslandParent[index] = m_IslandParent[m_IslandParent[index]];
+        index = m_IslandParent[index];
+    }
+
+    return index;
+}
+//=============================================================================
+// アイランドの結合
+//=============================================================================
+void PhysicsWorld::UniteIslands(int a, int b)
+{
+    int rootA = FindIsland(a);
+    int rootB = FindIsland(b);
+
+    if (rootA != rootB)
+    {
+        m_IslandParent[std::max(rootA, rootB)] = std::min(rootA, rootB);
+    }
+}
+//=============================================================================
+// 触れられた眠ったアイランドの起床処理
+// 起きている剛体とAABBが重なった眠った剛体を、眠ったまま残してある多様体でつながった剛体ごと同じステップで起こす
+// （触れた剛体だけ起こすと下の剛体との組が外され、支えのないまま1段ずつ沈みながら起きていく）
+// 起きている剛体のAABBはこのステップの移動量と予測接触の余裕の分だけ広げる（予測接触で先に触れた剛体も一緒に起こす）
+//=============================================================================
+void PhysicsWorld::WakeTouchedIslands(float dt)
+{
+    m_WakeSeeds.clear();
+
+    for (const BroadphasePair& pair : m_Pairs)
+    {
+        RigidBody* A = pair.a;
+        RigidBody* B = pair.b;
+
+        // 動的同士で片方だけ眠っている組（トリガーは起こさない）
+        if (!A->IsDynamic() || !B->IsDynamic() || A->IsSleeping() == B->IsSleeping())
+        {
+            continue;
+        }
+
+        if (A->IsTrigger() || B->IsTrigger() || !A->CanCollideWith(B))
+        {
+            continue;
+        }
+
+        RigidBody* sleeper = A->IsSleeping() ? A : B;
+        RigidBody* waker = A->IsSleeping() ? B : A;
+
+        // 止まりかけている剛体では起こさない（眠る時期のずれた隣同士が触れずに起こし合い続ける）
+        if (waker->GetSleepCounter() > 0)
+        {
+            continue;
+        }
+
+        AABB reach = waker->GetColliderPtr()->GetAABB();
+        reach.Sweep(waker->GetVelocity() * dt);
+        reach.Expand(SPECULATIVE_MARGIN);
+
+        if (reach.Overlaps(sleeper->GetColliderPtr()->GetAABB()))
+        {
+            m_WakeSeeds.push_back(sleeper);
+        }
+    }
+
+    if (m_WakeSeeds.empty())
+    {
+        return;
+    }
+
+    // 眠った剛体同士の多様体でアイランドをつなぎ直す（ステップの初めに1剛体ずつに戻してある）
+    for (int nCnt = 0; nCnt < m_ContactCache.GetManifoldCount(); nCnt++)
+    {
+        const ContactManifold& manifold = m_ContactCache.GetManifold(nCnt);
+
+        if (manifold.a->IsDynamic() && manifold.b->IsDynamic() && manifold.a->IsSleeping() && manifold.b->IsSleeping())
+        {
+            UniteIslands(manifold.a->GetIslandIndex(), manifold.b->GetIslandIndex());
+        }
+    }
+
+    m_IsWakeRoot.assign(m_DynamicBodies.size(), 0);
+
+    for (RigidBody* seed : m_WakeSeeds)
+    {
+        m_IsWakeRoot[FindIsland(seed->GetIslandIndex())] = 1;
+    }
+
+    for (size_t nCnt = 0; nCnt < m_DynamicBodies.size(); nCnt++)
+    {
+        if (m_DynamicBodies[nCnt]->IsSleeping() && m_IsWakeRoot[FindIsland((int)nCnt)])
+        {
+            m_DynamicBodies[nCnt]->WakeUp();
+        }
+    }
+}
+//=============================================================================
+// スリープ判定処理（アイランド単位で眠らせる）
+//=============================================================================
+void PhysicsWorld::UpdateSleeping(void)
+{
+    size_t numBodies = m_DynamicBodies.size();
+
+    // アイランドごとの最小静止フレーム数
+    m_IslandSleepCounter.assign(numBodies, SLEEP_FRAMES);
+
+    for (size_t nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        auto& body = m_DynamicBodies[nCnt];
+
+        if (body->IsSleeping())
+        {
+            continue;
+        }
+
+        body->UpdateSleepCounter(SLEEP_LINEAR_VELOCITY, SLEEP_ANGULAR_VELOCITY);
+
+        int root = FindIsland((int)nCnt);
+        m_IslandSleepCounter[root] = std::min(m_IslandSleepCounter[root], body->GetSleepCounter());
+    }
+
+    // 全員が静止し続けているアイランドだけ眠らせる
+    m_NumSleeping = 0;
+
+    for (size_t nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        auto& body = m_DynamicBodies[nCnt];
+
+        if (!body->IsSleeping() && m_IslandSleepCounter[FindIsland((int)nCnt)] >= SLEEP_FRAMES)
+        {
+            body->Sleep();
+        }
+
+        if (body->IsSleeping())
+        {
+            m_NumSleeping++;
+        }
+    }
+}
+//=============================================================================
+// 剛体の生成処理（プールに作ってワールドに登録する）
+//=============================================================================
+RigidBodyHandle PhysicsWorld::CreateRigidBody(std::shared_ptr<Collider> col, float mass, bool isDynamic)
+{
+    RigidBodyHandle handle = m_BodyPool.Create(col, mass);
+    RigidBody* body = m_BodyPool.Get(handle);
+
+    body->SetIsDynamic(isDynamic);
+
+    // 動的・静的を切り替える場合は作り直す
+    if (isDynamic)
+    {
+        body->SetProxyId(m_pBroadphase->CreateProxy(body));
+        body->SetWorldIndex((int)m_DynamicBodies.size());
+        m_DynamicBodies.push_back(body);
+        m_IslandParent.push_back(0);
+    }
+    else
+    {
+        body->SetWorldIndex((int)m_StaticBodies.size());
+        m_StaticBodies.push_back(body);
+        m_isStaticDirty = true;
+    }
+
+    return handle;
+}
+//=============================================================================
+// 剛体のまとめて生成処理（ステージ読み込み用）
+//=============================================================================
+void PhysicsWorld::CreateRigidBodies(const RigidBodyDesc* descs, int count, RigidBodyHandle* outHandles)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    int numDynamic = 0;
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        if (descs[nCnt].isDynamic)
+        {
+            numDynamic++;
+        }
+    }
+
+    // 配列の伸長を1回で済ませる
+    m_BodyPool.Reserve(m_BodyPool.GetCount() + count);
+    m_DynamicBodies.reserve(m_DynamicBodies.size() + numDynamic);
+    m_IslandParent.reserve(m_IslandParent.size() + numDynamic);
+    m_StaticBodies.reserve(m_StaticBodies.size() + (count - numDynamic));
+
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        outHandles[nCnt] = CreateRigidBody(descs[nCnt].collider, descs[nCnt].mass, descs[nCnt].isDynamic);
+    }
+}
+//=============================================================================
+// 静的・動的リストから外す処理
+//=============================================================================
+void PhysicsWorld::EraseFromList(std::vector<RigidBody*>& list, RigidBody* body)
+{
+    int index = body->GetWorldIndex();
+    int last = (int)list.size() - 1;
+
+    // 末尾の剛体を空いた場所に移して番号を付け直す
+    if (index != last)
+    {
+        list[index] = list[last];
+        list[index]->SetWorldIndex(index);
+    }
+
+    list.pop_back();
+    body->SetWorldIndex(-1);
+}
+//=============================================================================
+// 剛体の削除
+//=============================================================================
+void PhysicsWorld::RemoveRigidBody(const RigidBodyHandle& handle)
+{
+    RigidBody* body = m_BodyPool.Get(handle);
+
+    if (!body)
+    {
+        return;
+    }
+
+    // 戻したままの接触キャッシュはプール内の番号で剛体を指すので、削除で番号が詰まる前に広げておく
+    ApplyRestoredContacts();
+
+    int index = body->GetWorldIndex();
+
+    // 生成後に動的・静的を切り替えていても、実際に入っているリストで判断する
+    if (index < (int)m_DynamicBodies.size() && m_DynamicBodies[index] == body)
+    {
+        m_pBroadphase->DestroyProxy(body->GetProxyId());
+        body->SetProxyId(-1);
+
+        if (body->IsSleeping())
+        {
+            m_NumSleeping--;
+        }
+
+        EraseFromList(m_DynamicBodies, body);
+        m_IslandParent.pop_back();
+    }
+    else if (index < (int)m_StaticBodies.size() && m_StaticBodies[index] == body)
+    {
+        CancelStaticBake();
+        EraseFromList(m_StaticBodies, body);
+        m_isStaticDirty = true;
+    }
+
+    // 多様体は次のステップでまとめて捨てる
+    m_ContactCache.RemoveBody(body);
+
+    // 前回の結果は消した剛体を指しているので捨てる
+    m_Pairs.clear();
+    m_Manifolds.clear();
+
+    m_BodyPool.Destroy(handle);
+}
+//=============================================================================
+// 剛体のまとめて削除処理（ステージ破棄用）
+//=============================================================================
+void PhysicsWorld::RemoveRigidBodies(const RigidBodyHandle* handles, int count)
+{
+    for (int nCnt = 0; nCnt < count; nCnt++)
+    {
+        RemoveRigidBody(handles[nCnt]);
+    }
+}
+//=============================================================================
+// 全剛体の削除処理
+//=============================================================================
+void PhysicsWorld::RemoveAll(void)
+{
+    // 1体ずつ外さず、ブロードフェーズごと作り直す
+    m_pBroadphase = Broadphase::Create(m_pBroadphase->GetType());
+
+    CancelStaticBake();
+
+    m_ContactCache.Clear();
+    m_isContactRestorePending = false;
+    m_BodyPool.Clear();
+    m_StaticBodies.clear();
+    m_DynamicBodies.clear();
+    m_StaticHits.clear();
+    m_Pairs.clear();
+    m_Manifolds.clear();
+    m_TriggerOverlaps.clear();
+    m_TriggerKeys.clear();
+    m_PrevTriggerKeys.clear();
+    m_IslandParent.clear();
+    m_IslandSleepCounter.clear();
+    m_NumSleeping = 0;
+    m_isStaticDirty = true;
+}
+//=============================================================================
+// ブロードフェーズの切り替え処理（ステージごとに選ぶ）
+//=============================================================================
+void PhysicsWorld::SetBroadphase(Broadphase::TYPE type)
+{
+    if (m_pBroadphase->GetType() == type)
+    {
+        return;
+    }
+
+    m_pBroadphase = Broadphase::Create(type);
+
+    // 動的剛体のプロキシを新しいブロードフェーズに登録し直す
+    for (RigidBody* body : m_DynamicBodies)
+    {
+        body->SetProxyId(m_pBroadphase->CreateProxy(body));
+    }
+
+    // 前回のペアは古いブロードフェーズの結果なので捨てる
+    m_Pairs.clear();
+}
+//=============================================================================
+// ソルバーの反復回数設定処理
+//=============================================================================
+void PhysicsWorld::SetSolverIterations(int velocityIterations, int positionIterations)
+{
+    m_VelocityIterations = std::max(velocityIterations, 1);
+    m_PositionIterations = std::max(positionIterations, 0);
+}
+//=============================================================================
+// 収束判定の許容量設定処理
+//=============================================================================
+void PhysicsWorld::SetConvergenceTolerance(float impulseTolerance, float penetrationTolerance)
+{
+    m_ImpulseTolerance = std::max(impulseTolerance, 0.0f);
+    m_PenetrationTolerance = std::max(penetrationTolerance, 0.0f);
+}
+//=============================================================================
+// 物理の更新頻度の設定処理
+//=============================================================================
+void PhysicsWorld::SetPhysicsRate(int rate)
+{
+    m_PhysicsRate = std::clamp(rate, MIN_PHYSICS_RATE, MAX_PHYSICS_RATE);
+    m_FixedTimeStep = 1.0f / m_PhysicsRate;
+
+    // 貯めていた時間は新しい刻みに持ち越さない
+    m_Accumulator = 0.0f;
+}
+//=============================================================================
+// スナップショットの保存処理（ヘッダー・接触キャッシュ・トリガーのキー・剛体の状態の順に詰める）
+// outDataの容量は使い回すので、同じバッファで何度も呼べば確保は最初の1回だけ
+//=============================================================================
+void PhysicsWorld::SaveSnapshot(std::vector<unsigned char>& outData)
+{
+    outData.clear();
+
+    SnapshotWriter writer(outData);
+
+    // 戻したまま広げていない接触キャッシュがあれば広げ、削除した剛体の多様体が残っていれば捨てる
+    // （キャッシュはキー順なので同じ状態なら同じバイト列になる）
+    ApplyRestoredContacts();
+    m_ContactCache.PurgeRemovedBodies();
+
+    int numManifolds = m_ContactCache.GetManifoldCount();
+    int manifoldBytes = 0;
+
+    for (int nCnt = 0; nCnt < numManifolds; nCnt++)
+    {
+        manifoldBytes += (int)(sizeof(SnapshotManifold) + sizeof(SnapshotContact) * m_ContactCache.GetManifold(nCnt).numPoints);
+    }
+
+    SnapshotHeader header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.numBodies = m_BodyPool.GetCount();
+    header.numManifolds = numManifolds;
+    header.numTriggerKeys = (int)m_TriggerKeys.size();
+    header.manifoldBytes = manifoldBytes;
+    header.accumulator = m_Accumulator;
+    header.interpolationAlpha = m_InterpolationAlpha;
+    header.isStaticDirty = (m_isStaticDirty || m_isBakeReplacing) ? 1 : 0;
+
+    // 全体の大きさは先に決まるので、書き出し中に確保し直さないよう1回で取っておく
+    outData.reserve(sizeof(SnapshotHeader) + manifoldBytes + sizeof(unsigned long long) * m_TriggerKeys.size() + m_BodyPool.GetStateSize());
+
+    writer.Write(header);
+
+    // 次のステップのウォームスタートに使う分だけ残す（有効質量などは毎ステップ計算し直す）
+    // 1件ずつ足すと多様体の数だけ末尾を伸ばすので、領域をまとめて取ってから詰める
+    unsigned char* cursor = writer.Append(manifoldBytes);
+
+    for (int nCnt = 0; nCnt < numManifolds; nCnt++)
+    {
+        const ContactManifold& manifold = m_ContactCache.GetManifold(nCnt);
+        unsigned long long key = m_ContactCache.GetKey(nCnt);
+
+        SnapshotManifold record;
+        record.indexA = (int)(key >> 32);
+        record.indexB = (int)(key & 0xFFFFFFFFu);
+        record.normal = manifold.normal;
+        record.numPoints = manifold.numPoints;
+
+        memcpy(cursor, &record, sizeof(SnapshotManifold));
+        cursor += sizeof(SnapshotManifold);
+
+        for (int nPoint = 0; nPoint < manifold.numPoints; nPoint++)
+        {
+            const ContactPoint& cp = manifold.points[nPoint];
+
+            SnapshotContact contact;
+            contact.localA = cp.localA;
+            contact.normalImpulse = cp.normalImpulse;
+            contact.tangentImpulse[0] = cp.tangentImpulse[0];
+            contact.tangentImpulse[1] = cp.tangentImpulse[1];
+            contact.featureId = cp.featureId;
+
+            memcpy(cursor, &contact, sizeof(SnapshotContact));
+            cursor += sizeof(SnapshotContact);
+        }
+    }
+
+    writer.WriteArray(m_TriggerKeys.data(), m_TriggerKeys.size());
+
+    m_BodyPool.SaveState(writer);
+}
+//=============================================================================
+// スナップショットの復元処理（形が合わなければ何も書き換えずにfalse）
+//=============================================================================
+bool PhysicsWorld::RestoreSnapshot(const std::vector<unsigned char>& data)
+{
+    SnapshotReader reader(data);
+    SnapshotHeader header;
+
+    if (!reader.Read(header) ||
+        header.magic != SNAPSHOT_MAGIC ||
+        header.version != SNAPSHOT_VERSION ||
+        header.numBodies != m_BodyPool.GetCount() ||
+        header.numManifolds < 0 ||
+        header.numTriggerKeys < 0 ||
+        header.manifoldBytes < 0)
+    {
+        return false;
+    }
+
+    // 大きさが合わないものは途中まで書き換える前に断る
+    size_t expectedSize = sizeof(SnapshotHeader) +
+        (size_t)header.manifoldBytes +
+        sizeof(unsigned long long) * header.numTriggerKeys +
+        m_BodyPool.GetStateSize();
+
+    if (data.size() != expectedSize)
+    {
+        return false;
+    }
+
+    const unsigned char* manifolds = reader.Skip(header.manifoldBytes);
+    const unsigned char* triggerKeys = reader.Skip(sizeof(unsigned long long) * header.numTriggerKeys);
+
+    // 多様体の並びを先に確かめる（番号の範囲・キー順か・点の数から出した大きさがmanifoldBytesとそろうか）
+    size_t offset = 0;
+    long long prevKey = -1;
+
+    for (int nCnt = 0; nCnt < header.numManifolds; nCnt++)
+    {
+        if (offset + sizeof(SnapshotManifold) > (size_t)header.manifoldBytes)
+        {
+            return false;
+        }
+
+        SnapshotManifold record;
+        memcpy(&record, manifolds + offset, sizeof(SnapshotManifold));
+
+        if (record.indexA < 0 || record.indexA >= header.numBodies ||
+            record.indexB < 0 || record.indexB >= header.numBodies ||
+            record.numPoints < 0 || record.numPoints > ContactManifold::MAX_POINTS)
+        {
+            return false;
+        }
+
+        long long key = ((long long)record.indexA << 32) | (unsigned int)record.indexB;
+
+        if (key <= prevKey)
+        {
+            return false;
+        }
+
+        prevKey = key;
+        offset += sizeof(SnapshotManifold) + sizeof(SnapshotContact) * record.numPoints;
+    }
+
+    if (offset != (size_t)header.manifoldBytes)
+    {
+        return false;
+    }
+
+    // 剛体の並びが違えばここで断られる（まだ何も書き換えていない）
+    if (!m_BodyPool.RestoreState(reader))
+    {
+        return false;
+    }
+
+    // 接触キャッシュは保存した小さい並びのまま写しておき、多様体（1つ数百バイト）へは最初に使うときに広げる
+    // 続けて何度戻しても、間でステップを回さなければ多様体には一度も触れない
+    m_RestoredContacts.assign(manifolds, manifolds + header.manifoldBytes);
+    m_NumRestoredManifolds = header.numManifolds;
+    m_isContactRestorePending = true;
+
+    m_TriggerKeys.resize(header.numTriggerKeys);
+
+    if (header.numTriggerKeys > 0)
+    {
+        memcpy(m_TriggerKeys.data(), triggerKeys, sizeof(unsigned long long) * header.numTriggerKeys);
+    }
+
+    // 前回のステップの結果は戻す前の剛体・多様体を指しているので捨てる
+    m_PrevTriggerKeys.clear();
+    m_TriggerOverlaps.clear();
+    m_Pairs.clear();
+    m_Manifolds.clear();
+
+    m_Accumulator = header.accumulator;
+    m_InterpolationAlpha = header.interpolationAlpha;
+    m_isStaticDirty = m_isStaticDirty || header.isStaticDirty != 0;
+
+    m_NumSleeping = 0;
+
+    for (RigidBody* body : m_DynamicBodies)
+    {
+        if (body->IsSleeping())
+        {
+            m_NumSleeping++;
+        }
+    }
+
+    return true;
+}
+//=============================================================================
+// 戻した接触キャッシュを多様体に広げる処理
+//=============================================================================
+void PhysicsWorld::ApplyRestoredContacts(void)
+{
+    if (!m_isContactRestorePending)
+    {
+        return;
+    }
+
+    m_isContactRestorePending = false;
+
+    // 接触キャッシュは今の表と突き合わせず、保存した多様体だけで作り直す（キー順は戻すときに確かめてある）
+    // 累積インパルスが戻るので、次のステップのウォームスタートが保存したときと同じになる
+    m_ContactCache.ResetForRestore(m_NumRestoredManifolds);
+
+    const unsigned char* cursor = m_RestoredContacts.data();
+
+    for (int nCnt = 0; nCnt < m_NumRestoredManifolds; nCnt++)
+    {
+        SnapshotManifold record;
+        memcpy(&record, cursor, sizeof(SnapshotManifold));
+        cursor += sizeof(SnapshotManifold);
+
+        unsigned long long key = ((unsigned long long)record.indexA << 32) | (unsigned int)record.indexB;
+        ContactManifold& manifold = m_ContactCache.AppendRestored(m_BodyPool.GetAt(record.indexA), m_BodyPool.GetAt(record.indexB), key);
+        manifold.normal = record.normal;
+        manifold.numPoints = record.numPoints;
+
+        for (int nPoint = 0; nPoint < record.numPoints; nPoint++)
+        {
+            SnapshotContact contact;
+            memcpy(&contact, cursor, sizeof(SnapshotContact));
+            cursor += sizeof(SnapshotContact);
+
+            ContactPoint& cp = manifold.points[nPoint];
+            cp.localA = contact.localA;
+            cp.normalImpulse = contact.normalImpulse;
+            cp.tangentImpulse[0] = contact.tangentImpulse[0];
+            cp.tangentImpulse[1] = contact.tangentImpulse[1];
+            cp.featureId = contact.featureId;
+        }
+    }
+}
+//=============================================================================
+// レイキャスト処理（一番近い当たりを返す）
+//=============================================================================
+bool PhysicsWorld::RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, QueryHit& outHit, const QueryFilter& filter)
+{
+    return CastCore(origin, origin, 0.0f, dir, maxDist, filter, &outHit, nullptr);
+}
+//=============================================================================
+// レイキャスト処理（当たった剛体を近い順にすべて返す）
+//=============================================================================
+int PhysicsWorld::RayCastAll(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, std::vector<QueryHit>& outHits, const QueryFilter& filter)
+{
+    outHits.clear();
+    CastCore(origin, origin, 0.0f, dir, maxDist, filter, nullptr, &outHits);
+
+    return (int)outHits.size();
+}
+//=============================================================================
+// 球を飛ばす処理（一番近い当たりを返す）
+//=============================================================================
+bool PhysicsWorld::SphereCast(const D3DXVECTOR3& center, float radius, const D3DXVECTOR3& dir, float maxDist, QueryHit& outHit, const QueryFilter& filter)
+{
+    return CastCore(center, center, radius, dir, maxDist, filter, &outHit, nullptr);
+}
+//=============================================================================
+// 球を飛ばす処理（当たった剛体を近い順にすべて返す）
+//=============================================================================
+int PhysicsWorld::SphereCastAll(const D3DXVECTOR3& center, float radius, const D3DXVECTOR3& dir, float maxDist, std::vector<QueryHit>& outHits, const QueryFilter& filter)
+{
+    outHits.clear();
+    CastCore(center, center, radius, dir, maxDist, filter, nullptr, &outHits);
+
+    return (int)outHits.size();
+}
+//=============================================================================
+// カプセル（軸は縦向き、heightは芯の長さ）を飛ばす処理（一番近い当たりを返す）
+//=============================================================================
+bool PhysicsWorld::CapsuleCast(const D3DXVECTOR3& center, float radius, float height, const D3DXVECTOR3& dir, float maxDist, QueryHit& outHit, const QueryFilter& filter)
+{
+    D3DXVECTOR3 half(0.0f, height * HALF, 0.0f);
+
+    return CastCore(center - half, center + half, radius, dir, maxDist, filter, &outHit, nullptr);
+}
+//=============================================================================
+// カプセル（軸は縦向き、heightは芯の長さ）を飛ばす処理（当たった剛体を近い順にすべて返す）
+//=============================================================================
+int PhysicsWorld::CapsuleCastAll(const D3DXVECTOR3& center, float radius, float height, const D3DXVECTOR3& dir, float maxDist, std::vector<QueryHit>& outHits, const QueryFilter& filter)
+{
+    D3DXVECTOR3 half(0.0f, height * HALF, 0.0f);
+
+    outHits.clear();
+    CastCore(center - half, center + half, radius, dir, maxDist, filter, nullptr, &outHits);
+
+    return (int)outHits.size();
+}
+//=============================================================================
+// 箱と重なっている剛体の取得処理（sizeは箱の大きさ）
+//=============================================================================
+int PhysicsWorld::OverlapBox(const D3DXVECTOR3& center, const D3DXVECTOR3& size, const D3DXQUATERNION& rot, std::vector<RigidBody*>& outBodies, const QueryFilter& filter)
+{
+    BoxCollider box(size);
+    box.UpdateTransform(center, rot, D3DXVECTOR3(1.0f, 1.0f, 1.0f));
+
+    return Overlap(&box, outBodies, filter);
+}
+//=============================================================================
+// 球と重なっている剛体の取得処理
+//=============================================================================
+int PhysicsWorld::OverlapSphere(const D3DXVECTOR3& center, float radius, std::vector<RigidBody*>& outBodies, const QueryFilter& filter)
+{
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    float diameter = radius * 2.0f;
+    SphereCollider sphere(D3DXVECTOR3(diameter, diameter, diameter));
+    sphere.UpdateTransform(center, identity, D3DXVECTOR3(1.0f, 1.0f, 1.0f));
+
+    return Overlap(&sphere, outBodies, filter);
+}
+//=============================================================================
+// まとめたレイキャスト処理（静的剛体はBVHを8本ずつ一緒に辿り、動的剛体は1本ずつブロードフェーズで調べる）
+//=============================================================================
+int PhysicsWorld::RayCastPacket(const D3DXVECTOR3* origins, const D3DXVECTOR3* dirs, int count, float maxDist,
+    RigidBody** outBodies, float* outDistances, const QueryFilter& filter)
+{
+    // 編集で動かした直後でも新しい位置で当たるように、組んでいる途中の静的BVHを待つ
+    SyncStaticTree();
+
+    RayPacket packet;
+    packet.mask = filter.mask;
+    packet.isHitTriggers = filter.isHitTriggers;
+    packet.pIgnoreBody = filter.pIgnoreBody;
+
+    // 箱・球以外は1本ずつの判定に任せる
+    RayPacketFunc func = [&](RigidBody* body, int ray, float dist) -> float
+    {
+        D3DXVECTOR3 origin(packet.originX[ray], packet.originY[ray], packet.originZ[ray]);
+        D3DXVECTOR3 dir(packet.dirX[ray], packet.dirY[ray], packet.dirZ[ray]);
+        QueryHit hit;
+
+        return CastCoreAgainstBody(origin, origin, 0.0f, dir, dist, body, hit) ? hit.distance : dist;
+    };
+
+    int numHits = 0;
+
+    for (int first = 0; first < count; first += RayPacket::MAX_RAYS)
+    {
+        int numRays = std::min(count - first, RayPacket::MAX_RAYS);
+
+        // 端数は最後のレイで埋めて、距離を負にして当たらないようにする
+        for (int lane = 0; lane < RayPacket::MAX_RAYS; lane++)
+        {
+            int index = first + std::min(lane, numRays - 1);
+            D3DXVECTOR3 dir = dirs[index];
+            float length = D3DXVec3Length(&dir);
+            bool isValid = lane < numRays && length >= MIN_DISTANCE && maxDist >= 0.0f;
+
+            if (length >= MIN_DISTANCE)
+            {
+                dir /= length;
+            }
+
+            packet.originX[lane] = origins[index].x;
+            packet.originY[lane] = origins[index].y;
+            packet.originZ[lane] = origins[index].z;
+            packet.dirX[lane] = dir.x;
+            packet.dirY[lane] = dir.y;
+            packet.dirZ[lane] = dir.z;
+            packet.maxDist[lane] = isValid ? maxDist : -1.0f;
+        }
+
+        m_StaticTree.QueryRayPacket(packet, func);
+
+        for (int lane = 0; lane < numRays; lane++)
+        {
+            RigidBody* body = packet.body[lane];
+            float dist = packet.maxDist[lane];
+
+            // 動的剛体は静的剛体に当たった距離までに絞って調べる
+            if (dist >= 0.0f && !m_DynamicBodies.empty())
+            {
+                D3DXVECTOR3 origin(packet.originX[lane], packet.originY[lane], packet.originZ[lane]);
+                D3DXVECTOR3 dir(packet.dirX[lane], packet.dirY[lane], packet.dirZ[lane]);
+
+                m_pBroadphase->QueryRay(origin, dir, dist, INIT_VEC3,
+                    [&](RigidBody* other, float limit) -> float
+                    {
+                        QueryHit hit;
+
+                        if (!IsQueryTarget(other, filter) || !CastCoreAgainstBody(origin, origin, 0.0f, dir, limit, other, hit) || hit.distance >= dist)
+                        {
+                            return limit;
+                        }
+
+                        body = other;
+                        dist = hit.distance;
+                        return dist;
+                    });
+            }
+
+            outBodies[first + lane] = body;
+            outDistances[first + lane] = body ? dist : maxDist;
+
+            if (body)
+            {
+                numHits++;
+            }
+        }
+    }
+
+    return numHits;
+}
+//=============================================================================
+// 問い合わせの対象かどうかの判定処理
+//=============================================================================
+bool PhysicsWorld::IsQueryTarget(const RigidBody* body, const QueryFilter& filter) const
+{
+    if (body == filter.pIgnoreBody || body->GetColliderPtr() == nullptr)
+    {
+        return false;
+    }
+
+    if ((body->GetCollisionLayer() & filter.mask) == 0)
+    {
+        return false;
+    }
+
+    return filter.isHitTriggers || !body->IsTrigger();
+}
+//=============================================================================
+// 芯を飛ばす問い合わせの本体（静的BVH→ブロードフェーズの順に近いものから調べる）
+// outClosestなら当たるたびに調べる距離を縮め、outAllなら全部集めて近い順に並べる
+//=============================================================================
+bool PhysicsWorld::CastCore(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& dir, float maxDist,
+    const QueryFilter& filter, QueryHit* outClosest, std::vector<QueryHit>* outAll)
+{
+    float length = D3DXVec3Length(&dir);
+
+    if (length < MIN_DISTANCE || maxDist < 0.0f)
+    {
+        return false;
+    }
+
+    D3DXVECTOR3 unitDir = dir / length;
+
+    // 編集で動かした直後でも新しい位置で当たるように、組んでいる途中の静的BVHを待つ
+    SyncStaticTree();
+
+    // 芯の中点から飛ばすレイにして、ノードのAABBは芯を囲む大きさだけ太らせる
+    D3DXVECTOR3 origin = (segA + segB) * HALF;
+    D3DXVECTOR3 halfSegment = (segB - segA) * HALF;
+    D3DXVECTOR3 extent(fabsf(halfSegment.x) + radius, fabsf(halfSegment.y) + radius, fabsf(halfSegment.z) + radius);
+
+    QueryHit best;
+    bool isHit = false;
+
+    RayQueryFunc func = [&](RigidBody* body, float dist) -> float
+    {
+        if (!IsQueryTarget(body, filter))
+        {
+            return dist;
+        }
+
+        QueryHit hit;
+
+        if (!CastCoreAgainstBody(segA, segB, radius, unitDir, dist, body, hit))
+        {
+            return dist;
+        }
+
+        if (outAll)
+        {
+            outAll->push_back(hit);
+            return dist;
+        }
+
+        // 同じ距離なら先に見つけた方を残す（木の形が同じなら結果も同じ）
+        if (!isHit || hit.distance < best.distance)
+        {
+            best = hit;
+            isHit = true;
+        }
+
+        return hit.distance;
+    };
+
+    m_StaticTree.QueryRay(origin, unitDir, maxDist, extent, func);
+    m_pBroadphase->QueryRay(origin, unitDir, isHit ? best.distance : maxDist, extent, func);
+
+    if (outAll)
+    {
+        std::sort(outAll->begin(), outAll->end(),
+            [](const QueryHit& a, const QueryHit& b)
+            {
+                if (a.distance != b.distance)
+                {
+                    return a.distance < b.distance;
+                }
+
+                return a.body->GetPoolIndex() < b.body->GetPoolIndex();
+            });
+
+        return !outAll->empty();
+    }
+
+    if (isHit)
+    {
+        *outClosest = best;
+    }
+
+    return isHit;
+}
+//=============================================================================
+// 芯を1つの剛体に向けて飛ばす処理（maxDistより先の当たりは返さない）
+//=============================================================================
+bool PhysicsWorld::CastCoreAgainstBody(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& dir, float maxDist,
+    RigidBody* body, QueryHit& outHit)
+{
+    float dist = 0.0f;
+    D3DXVECTOR3 normal = -dir;
+    D3DXVECTOR3 point = segA;
+
+    if (!CastCoreAgainstCollider(segA, segB, radius, dir, maxDist, body->GetColliderPtr(), dist, normal, point))
+    {
+        return false;
+    }
+
+    outHit.body = body;
+    outHit.point = point;
+    outHit.normal = normal;
+    outHit.distance = dist;
+
+    return true;
+}
+//=============================================================================
+// 芯を1つのコライダーに向けて飛ばす処理（maxDistより先の当たりは返さない）
+// 点の芯は球・カプセルなら半径を足したレイ、半径0なら箱・シリンダー・メッシュ・凸包もレイで正確に解き、それ以外は保守的前進法で詰める
+// 複合は子ごとに飛ばして一番近い子の当たりを返す
+//=============================================================================
+bool PhysicsWorld::CastCoreAgainstCollider(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& dir, float maxDist,
+    Collider* col, float& outDist, D3DXVECTOR3& outNormal, D3DXVECTOR3& outPoint)
+{
+    D3DXVECTOR3 segment = segB - segA;
+    bool isPoint = D3DXVec3LengthSq(&segment) < MIN_DISTANCE;
+
+    float dist = 0.0f;
+    D3DXVECTOR3 normal = -dir;
+    D3DXVECTOR3 point = segA;
+    bool isHit = false;
+
+    if (col->GetType() == Collider::COMPOUND)
+    {
+        CompoundCollider* compound = static_cast<CompoundCollider*>(col);
+
+        for (int nCnt = 0; nCnt < compound->GetChildCount(); nCnt++)
+        {
+            float childDist = 0.0f;
+            D3DXVECTOR3 childNormal, childPoint;
+
+            // 当たるたびに調べる距離を縮める（同じ距離なら先の子を残す）
+            if (CastCoreAgainstCollider(segA, segB, radius, dir, isHit ? dist : maxDist, compound->GetChild(nCnt), childDist, childNormal, childPoint) &&
+                (!isHit || childDist < dist))
+            {
+                dist = childDist;
+                normal = childNormal;
+                point = childPoint;
+                isHit = true;
+            }
+        }
+    }
+    else if (isPoint && col->GetType() == Collider::SPHERE)
+    {
+        SphereCollider* sphere = static_cast<SphereCollider*>(col);
+        isHit = RayCapsule(segA, dir, sphere->GetPosition(), sphere->GetPosition(), sphere->GetRadius() + radius, maxDist, dist, normal);
+        point = segA + dir * dist - normal * radius;
+    }
+    else if (isPoint && col->GetType() == Collider::CAPSULE)
+    {
+        CapsuleCollider* capsule = static_cast<CapsuleCollider*>(col);
+        isHit = RayCapsule(segA, dir, capsule->GetBottom(), capsule->GetTop(), capsule->GetRadius() + radius, maxDist, dist, normal);
+        point = segA + dir * dist - normal * radius;
+    }
+    else if (isPoint && radius <= 0.0f && col->GetType() == Collider::BOX)
+    {
+        isHit = RayOBB(segA, dir, static_cast<BoxCollider*>(col), maxDist, dist, normal);
+        point = segA + dir * dist;
+    }
+    else if (isPoint && radius <= 0.0f && col->GetType() == Collider::CYLINDER)
+    {
+        isHit = RayCylinder(segA, dir, static_cast<CylinderCollider*>(col), maxDist, dist, normal);
+        point = segA + dir * dist;
+    }
+    else if (isPoint && radius <= 0.0f && col->GetType() == Collider::MESH)
+    {
+        isHit = static_cast<MeshCollider*>(col)->RayCast(segA, dir, maxDist, dist, normal);
+        point = segA + dir * dist;
+    }
+    else if (isPoint && radius <= 0.0f && col->GetType() == Collider::CONVEX)
+    {
+        isHit = static_cast<ConvexCollider*>(col)->RayCast(segA, dir, maxDist, dist, normal);
+        point = segA + dir * dist;
+    }
+    else
+    {
+        isHit = AdvanceCore(segA, segB, radius, dir, maxDist, col, dist, normal, point);
+    }
+
+    if (!isHit)
+    {
+        return false;
+    }
+
+    outDist = dist;
+    outNormal = normal;
+    outPoint = point;
+
+    return true;
+}
+//=============================================================================
+// 芯をコライダーに向けて進める処理（保守的前進法、dirは正規化済みなので隙間の分だけ進めても当たらない）
+// outNormalはコライダーの外向き、outPointはコライダーの表面の点。始めから重なっていれば距離0で返す
+//=============================================================================
+bool PhysicsWorld::AdvanceCore(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& dir, float maxDist,
+    Collider* col, float& outDist, D3DXVECTOR3& outNormal, D3DXVECTOR3& outPoint)
+{
+    // メッシュは進む範囲の三角形を先に集めておく
+    thread_local std::vector<int> triangles;
+    MeshCollider* mesh = (col->GetType() == Collider::MESH) ? static_cast<MeshCollider*>(col) : nullptr;
+
+    if (mesh)
+    {
+        triangles.clear();
+
+        D3DXVECTOR3 travel = dir * maxDist;
+        D3DXVECTOR3 endA = segA + travel;
+        D3DXVECTOR3 endB = segB + travel;
+        D3DXVECTOR3 extent(radius, radius, radius);
+        AABB box;
+        D3DXVec3Minimize(&box.min, &segA, &segB);
+        D3DXVec3Minimize(&box.min, &box.min, &endA);
+        D3DXVec3Minimize(&box.min, &box.min, &endB);
+        D3DXVec3Maximize(&box.max, &segA, &segB);
+        D3DXVec3Maximize(&box.max, &box.max, &endA);
+        D3DXVec3Maximize(&box.max, &box.max, &endB);
+        box.min -= extent;
+        box.max += extent;
+
+        mesh->QueryTriangles(box, triangles);
+    }
+
+    float t = 0.0f;
+
+    for (int nIter = 0; nIter < QUERY_ITERATIONS; nIter++)
+    {
+        D3DXVECTOR3 offset = dir * t;
+        D3DXVECTOR3 onCore;
+        D3DXVECTOR3 onCollider;
+
+        float colRadius = 0.0f;
+
+        if (mesh)
+        {
+            D3DXVECTOR3 faceNormal;
+
+            if (ClosestPointsToTriangles(segA + offset, segB + offset, mesh, triangles, dir, onCore, onCollider, faceNormal) == FLT_MAX)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            colRadius = ClosestPointsToCollider(segA + offset, segB + offset, col, onCore, onCollider);
+        }
+
+        D3DXVECTOR3 delta = onCore - onCollider;
+        float distance = D3DXVec3Length(&delta);
+        float gap = distance - colRadius - radius;
+
+        if (gap <= TOI_TOLERANCE)
+        {
+            // 芯がコライダーの中にあるときは向きが決まらないので進む向きの逆にする
+            outNormal = (distance > MIN_DISTANCE) ? delta / distance : -dir;
+            outPoint = onCollider + outNormal * colRadius;
+            outDist = t;
+            return true;
+        }
+
+        t += gap;
+
+        if (t > maxDist)
+        {
+            return false;
+        }
+    }
+
+    // 詰め切れないのは面をかすめて進むときなので当たらないものとする
+    return false;
+}
+//=============================================================================
+// 芯とコライダーの最近接点の取得処理（返り値はコライダー側の芯の半径、箱・シリンダー・凸包は0）
+//=============================================================================
+float PhysicsWorld::ClosestPointsToCollider(const D3DXVECTOR3& p0, const D3DXVECTOR3& p1, Collider* col, D3DXVECTOR3& outOnCore, D3DXVECTOR3& outOnCollider)
+{
+    switch (col->GetType())
+    {
+    case Collider::SPHERE:
+    {
+        SphereCollider* sphere = static_cast<SphereCollider*>(col);
+        outOnCollider = sphere->GetPosition();
+        outOnCore = ClosestPointOnLineSegment(outOnCollider, p0, p1);
+        return sphere->GetRadius();
+    }
+    case Collider::CAPSULE:
+    {
+        CapsuleCollider* capsule = static_cast<CapsuleCollider*>(col);
+        DistanceSqSegmentSegment(p0, p1, capsule->GetBottom(), capsule->GetTop(), &outOnCore, &outOnCollider);
+        return capsule->GetRadius();
+    }
+    case Collider::BOX:
+    case Collider::CYLINDER:
+    {
+        // 線分と形状の最近接点（交互に投影して詰める）
+        outOnCore = (p0 + p1) * HALF;
+
+        for (int nCnt = 0; nCnt < SEGMENT_ITERATIONS; nCnt++)
+        {
+            outOnCollider = (col->GetType() == Collider::BOX) ?
+                ClosestPointOnOBB(outOnCore, static_cast<BoxCollider*>(col)) :
+                ClosestPointOnCylinder(outOnCore, static_cast<CylinderCollider*>(col));
+            outOnCore = ClosestPointOnLineSegment(outOnCollider, p0, p1);
+        }
+
+        return 0.0f;
+    }
+    case Collider::CONVEX:
+    {
+        // 線分と凸包の最近接点はGJKで求める（重なっていれば両方とも中心に一番近い線分上の点）
+        const D3DXVECTOR3 segment[2] = { p0, p1 };
+        float dist = 0.0f;
+
+        if (!Gjk::Distance(ConvexShape(segment, 2), ConvexShape(col), FLT_MAX, outOnCore, outOnCollider, dist))
+        {
+            outOnCore = outOnCollider = ClosestPointOnLineSegment(col->GetPosition(), p0, p1);
+        }
+
+        return 0.0f;
+    }
+    default:
+        outOnCore = p0;
+        outOnCollider = col->GetPosition();
+        return 0.0f;
+    }
+}
+//=============================================================================
+// 重なっている剛体の取得処理（候補をAABBで集めてから判定関数で確かめる）
+//=============================================================================
+int PhysicsWorld::Overlap(Collider* col, std::vector<RigidBody*>& outBodies, const QueryFilter& filter)
+{
+    outBodies.clear();
+
+    // 編集で動かした直後でも新しい位置で重なるように、組んでいる途中の静的BVHを待つ
+    SyncStaticTree();
+
+    AABB box = col->GetAABB();
+
+    m_QueryBodies.clear();
+    m_StaticTree.Query(box, m_QueryBodies);
+    m_pBroadphase->QueryAABB(box, m_QueryBodies);
+
+    // 重なりはトリガーも拾う（入ったかどうかを調べる用途が多いため）
+    QueryFilter overlapFilter = filter;
+    overlapFilter.isHitTriggers = true;
+
+    for (RigidBody* body : m_QueryBodies)
+    {
+        if (!IsQueryTarget(body, overlapFilter))
+        {
+            continue;
+        }
+
+        // ブロードフェーズのAABBは太らせてあるので今のAABBで確かめ直す
+        Collider* other = body->GetColliderPtr();
+
+        if (!box.Overlaps(other->GetAABB()))
+        {
+            continue;
+        }
+
+        D3DXVECTOR3 push;
+
+        if ((this->*m_CollisionTable[col->GetType()][other->GetType()])(col, other, push))
+        {
+            outBodies.push_back(body);
+        }
+    }
+
+    // ブロードフェーズの並びに依らないように番号順にそろえる
+    std::sort(outBodies.begin(), outBodies.end(),
+        [](const RigidBody* a, const RigidBody* b) { return a->GetPoolIndex() < b->GetPoolIndex(); });
+
+    return (int)outBodies.size();
+}
+//=============================================================================
+// レイとカプセル（a-bの線分＋半径、a==bなら球）の交差判定処理
+//=============================================================================
+bool PhysicsWorld::RayCapsule(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, const D3DXVECTOR3& a, const D3DXVECTOR3& b, float radius,
+    float maxDist, float& outDist, D3DXVECTOR3& outNormal)
+{
+    float radiusSq = radius * radius;
+
+    // 始点が中にある
+    D3DXVECTOR3 inside = origin - ClosestPointOnLineSegment(origin, a, b);
+
+    if (D3DXVec3LengthSq(&inside) <= radiusSq)
+    {
+        outDist = 0.0f;
+        outNormal = -dir;
+        return true;
+    }
+
+    float best = maxDist;
+    bool isHit = false;
+
+    // 両端の球
+    const D3DXVECTOR3* ends[] = { &a, &b };
+
+    for (const D3DXVECTOR3* end : ends)
+    {
+        D3DXVECTOR3 m = origin - *end;
+        float bDot = D3DXVec3Dot(&m, &dir);
+        float c = D3DXVec3LengthSq(&m) - radiusSq;
+        float disc = bDot * bDot - c;
+
+        if (bDot > 0.0f || disc < 0.0f)
+        {
+            continue;
+        }
+
+        float t = -bDot - sqrtf(disc);
+
+        if (t >= 0.0f && t <= best)
+        {
+            best = t;
+            isHit = true;
+        }
+    }
+
+    // 側面（軸に垂直な成分だけで円柱との交差を解き、軸方向が線分の内側なら当たり）
+    D3DXVECTOR3 axis = b - a;
+    float axisLength = D3DXVec3Length(&axis);
+
+    if (axisLength > MIN_DISTANCE)
+    {
+        axis /= axisLength;
+
+        D3DXVECTOR3 ao = origin - a;
+        D3DXVECTOR3 dirPerp = dir - axis * D3DXVec3Dot(&dir, &axis);
+        D3DXVECTOR3 aoPerp = ao - axis * D3DXVec3Dot(&ao, &axis);
+
+        float qa = D3DXVec3LengthSq(&dirPerp);
+        float qb = D3DXVec3Dot(&aoPerp, &dirPerp);
+        float qc = D3DXVec3LengthSq(&aoPerp) - radiusSq;
+        float disc = qb * qb - qa * qc;
+
+        if (qa > MIN_DISTANCE && disc >= 0.0f)
+        {
+            float t = (-qb - sqrtf(disc)) / qa;
+            D3DXVECTOR3 hit = ao + dir * t;
+            float s = D3DXVec3Dot(&hit, &axis);
+
+            if (t >= 0.0f && t <= best && s >= 0.0f && s <= axisLength)
+            {
+                best = t;
+                isHit = true;
+            }
+        }
+    }
+
+    if (!isHit)
+    {
+        return false;
+    }
+
+    D3DXVECTOR3 hitPoint = origin + dir * best;
+    D3DXVECTOR3 normal = hitPoint - ClosestPointOnLineSegment(hitPoint, a, b);
+    D3DXVec3Normalize(&outNormal, &normal);
+    outDist = best;
+
+    return true;
+}
+//=============================================================================
+// レイとOBBの交差判定処理（箱のローカル空間でのスラブ法）
+//=============================================================================
+bool PhysicsWorld::RayOBB(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, BoxCollider* box, float maxDist, float& outDist, D3DXVECTOR3& outNormal)
+{
+    const D3DXMATRIX& R = box->GetRotation();
+    D3DXVECTOR3 half = box->GetScaledSize() * HALF;
+    D3DXVECTOR3 d = origin - box->GetPosition();
+
+    std::array<D3DXVECTOR3, AXIS> axes =
+    {
+        D3DXVECTOR3(R._11, R._12, R._13),
+        D3DXVECTOR3(R._21, R._22, R._23),
+        D3DXVECTOR3(R._31, R._32, R._33)
+    };
+
+    float enter = 0.0f;
+    float exit = maxDist;
+    int enterAxis = -1;
+    float enterSign = 0.0f;
+
+    for (int nCnt = 0; nCnt < AXIS; nCnt++)
+    {
+        float localOrigin = D3DXVec3Dot(&d, &axes[nCnt]);
+        float localDir = D3DXVec3Dot(&dir, &axes[nCnt]);
+
+        if (fabsf(localDir) < MIN_DISTANCE)
+        {
+            // 平行なら板の間にいなければ当たらない
+            if (localOrigin < -half[nCnt] || localOrigin > half[nCnt])
+            {
+                return false;
+            }
+
+            continue;
+        }
+
+        float t1 = (-half[nCnt] - localOrigin) / localDir;
+        float t2 = (half[nCnt] - localOrigin) / localDir;
+        float sign = -1.0f;
+
+        if (t1 > t2)
+        {
+            std::swap(t1, t2);
+            sign = 1.0f;
+        }
+
+        if (t1 > enter)
+        {
+            enter = t1;
+            enterAxis = nCnt;
+            enterSign = sign;
+        }
+
+        exit = std::min(exit, t2);
+
+        if (enter > exit)
+        {
+            return false;
+        }
+    }
+
+    outDist = enter;
+    outNormal = (enterAxis >= 0) ? axes[enterAxis] * enterSign : -dir;
+
+    return true;
+}
+//=============================================================================
+// レイとシリンダー（軸方向Y固定）の交差判定処理
+//=============================================================================
+bool PhysicsWorld::RayCylinder(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, CylinderCollider* cyl, float maxDist, float& outDist, D3DXVECTOR3& outNormal)
+{
+    const D3DXVECTOR3& center = cyl->GetPosition();
+    float halfHeight = cyl->GetHeight() * HALF;
+    float radius = cyl->GetRadius();
+
+    float enter = 0.0f;
+    float exit = maxDist;
+    D3DXVECTOR3 normal = -dir;
+
+    // 上下の面の間
+    float oy = origin.y - center.y;
+
+    if (fabsf(dir.y) < MIN_DISTANCE)
+    {
+        if (oy < -halfHeight || oy > halfHeight)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        float t1 = (-halfHeight - oy) / dir.y;
+        float t2 = (halfHeight - oy) / dir.y;
+        float sign = (dir.y > 0.0f) ? -1.0f : 1.0f;
+
+        if (t1 > t2)
+        {
+            std::swap(t1, t2);
+        }
+
+        if (t1 > enter)
+        {
+            enter = t1;
+            normal = D3DXVECTOR3(0.0f, sign, 0.0f);
+        }
+
+        exit = std::min(exit, t2);
+    }
+
+    // XZ平面の円の中
+    float ox = origin.x - center.x;
+    float oz = origin.z - center.z;
+    float qa = dir.x * dir.x + dir.z * dir.z;
+    float qb = ox * dir.x + oz * dir.z;
+    float qc = ox * ox + oz * oz - radius * radius;
+
+    if (qa < MIN_DISTANCE)
+    {
+        if (qc > 0.0f)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        float disc = qb * qb - qa * qc;
+
+        if (disc < 0.0f)
+        {
+            return false;
+        }
+
+        float root = sqrtf(disc);
+        float t1 = (-qb - root) / qa;
+        float t2 = (-qb + root) / qa;
+
+        if (t1 > enter)
+        {
+            enter = t1;
+
+            D3DXVECTOR3 side(ox + dir.x * t1, 0.0f, oz + dir.z * t1);
+            D3DXVec3Normalize(&normal, &side);
+        }
+
+        exit = std::min(exit, t2);
+    }
+
+    if (enter > exit)
+    {
+        return false;
+    }
+
+    outDist = enter;
+    outNormal = normal;
+
+    return true;
+}
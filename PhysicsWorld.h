@@ -10,50 +10,347 @@
 //*****************************************************************************
 // インクルードファイル
 //*****************************************************************************
+#include "Broadphase.h"
+#include "StaticBVH.h"
+#include "ContactManifold.h"
+#include "Collider.h"
+#include "RigidBodyPool.h"
+#include "NarrowphaseBatch.h"
+#include "ThreadPool.h"
+#include "future"
 
 //*****************************************************************************
 // 前方宣言
 //*****************************************************************************
-class Collider;
-class BoxCollider;
-class CapsuleCollider;
-class CylinderCollider;
-class SphereCollider;
 class RigidBody;
 
+//*****************************************************************************
+// 剛体の生成情報（まとめて生成するときに使う）
+//*****************************************************************************
+struct RigidBodyDesc
+{
+    std::shared_ptr<Collider> collider;             // コライダー
+    float                     mass = 0.0f;          // 質量
+    bool                      isDynamic = false;    // 動的かどうか
+};
+
+//*****************************************************************************
+// トリガーとの重なり（押し戻さずに知らせるだけ）
+//*****************************************************************************
+struct TriggerOverlap
+{
+    RigidBody*  trigger;    // トリガーの剛体（両方トリガーならA）
+    RigidBody*  other;      // 重なっている相手
+    bool        isEnter;    // このステップで重なり始めたか
+};
+
+//*****************************************************************************
+// 問い合わせの絞り込み（レイ・形状を飛ばす、重なりを集めるときの対象）
+//*****************************************************************************
+struct QueryFilter
+{
+    unsigned int        mask = 0xFFFFFFFFu;     // 対象にするレイヤー（剛体のレイヤーと重なれば対象）
+    bool                isHitTriggers = false;  // トリガーも対象にするか
+    const RigidBody*    pIgnoreBody = nullptr;  // 対象から外す剛体（自分自身など）
+};
+
+//*****************************************************************************
+// レイ・形状を飛ばしたときの当たり
+//*****************************************************************************
+struct QueryHit
+{
+    RigidBody*  body = nullptr;         // 当たった剛体
+    D3DXVECTOR3 point = INIT_VEC3;      // 当たった剛体の表面の点
+    D3DXVECTOR3 normal = INIT_VEC3;     // 当たった面の法線（剛体の外向き）
+    float       distance = 0.0f;        // 当たるまでに進んだ距離（始めから重なっていれば0）
+};
+
 //=============================================================================
 // Physics World
 //=============================================================================
 class PhysicsWorld
 {
 public:
-    PhysicsWorld() : m_Gravity(0, DEFAULT_GRAVITY, 0) {}  // デフォルト重力
+    // 衝突判定の関数（コライダーの型の組み合わせごとに1つ）と、それを型で引く表
+    using CollisionFunc = bool (PhysicsWorld::*)(Collider* a, Collider* b, D3DXVECTOR3& outPush);
+    using CollisionTable = std::array<std::array<CollisionFunc, Collider::TYPE_MAX>, Collider::TYPE_MAX>;
+
+    PhysicsWorld(Broadphase::TYPE broadphase = Broadphase::DYNAMIC_AABB_TREE);
 
-    void AddRigidBody(std::shared_ptr<RigidBody> body) { m_Bodies.push_back(body); }
+    RigidBodyHandle CreateRigidBody(std::shared_ptr<Collider> col, float mass, bool isDynamic);
+    void CreateRigidBodies(const RigidBodyDesc* descs, int count, RigidBodyHandle* outHandles);
     void StepSimulation(float dt);
+    int Update(float frameTime);
     void SetGravity(const D3DXVECTOR3& g) { m_Gravity = g; }
-    void RemoveRigidBody(std::shared_ptr<RigidBody> body);
+    void RemoveRigidBody(const RigidBodyHandle& handle);
+    void RemoveRigidBodies(const RigidBodyHandle* handles, int count);
+    void RemoveAll(void);
+    void SetBroadphase(Broadphase::TYPE type);
+    void SetSolverIterations(int velocityIterations, int positionIterations);
+    void SetConvergenceTolerance(float impulseTolerance, float penetrationTolerance);
+    void SetPhysicsRate(int rate);
+    void SetMaxSubSteps(int maxSubSteps) { m_MaxSubSteps = std::max(maxSubSteps, 1); }
+    void SetContinuousCollision(bool isEnabled) { m_isContinuous = isEnabled; }
+    void SetWarmStarting(bool isEnabled) { m_isWarmStarting = isEnabled; }
+    void SetThreadCount(int threadCount) { m_ThreadCount = std::max(threadCount, 1); }
+
+    // 決定論モード（経過時間に依らず1回のUpdateで1ステップだけ回し、ペアの向きと並びを剛体の番号で決める）
+    void SetDeterministic(bool isEnabled) { m_isDeterministic = isEnabled; }
+    bool IsDeterministic(void) const { return m_isDeterministic; }
+
+    // 一時停止（止めている間も編集で動いた剛体のBVH・AABBは直すので問い合わせは使える）
+    // RequestStepは止めている間に固定の刻みで1ステップだけ進める
+    void SetPaused(bool isPaused);
+    bool IsPaused(void) const { return m_isPaused; }
+    void RequestStep(void) { m_NumRequestedSteps++; }
+
+    // スナップショット（剛体の状態・接触キャッシュをバイト列に保存し、同じ剛体の並びのワールドに戻す）
+    // 戻せるのは保存してから剛体の生成・削除、動的・静的の切り替えがないときだけ（合わなければ何も変えずにfalse）
+    void SaveSnapshot(std::vector<unsigned char>& outData);
+    bool RestoreSnapshot(const std::vector<unsigned char>& data);
+
+    // 静的剛体の焼き込み（再生を始めるときに呼び、止めたら外す。その間は静的剛体は動かないものとして毎ステップの確認をやめる）
+    // BVHの作り直しが要るときはほかのスレッドで組み、今のBVHが古いときだけ次のステップが組み上がるのを待つ
+    void BakeStaticWorld(void);
+    void UnbakeStaticWorld(void) { m_isStaticBaked = false; }
+    bool IsStaticBaked(void) const { return m_isStaticBaked; }
+    bool IsStaticBakePending(void) const { return m_StaticBakeTask.valid(); }
+    float GetStaticBakeTime(void) const { return m_StaticBakeTime; }
 
+    // 問い合わせ（静的剛体はBVH、動的剛体はブロードフェーズで絞る。どちらも前のステップの状態で調べる）
+    // 編集中にほかのスレッドで組んでいる静的BVHが古い中身の間は、組み上がるのを待ってから調べる
+    // Castは一番近い当たり、CastAllは当たった剛体を近い順にすべて返す。Overlapはトリガーも含めて重なっている剛体を返す
+    bool RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, QueryHit& outHit, const QueryFilter& filter = QueryFilter());
+    int RayCastAll(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, std::vector<QueryHit>& outHits, const QueryFilter& filter = QueryFilter());
+    bool SphereCast(const D3DXVECTOR3& center, float radius, const D3DXVECTOR3& dir, float maxDist, QueryHit& outHit, const QueryFilter& filter = QueryFilter());
+    int SphereCastAll(const D3DXVECTOR3& center, float radius, const D3DXVECTOR3& dir, float maxDist, std::vector<QueryHit>& outHits, const QueryFilter& filter = QueryFilter());
+    bool CapsuleCast(const D3DXVECTOR3& center, float radius, float height, const D3DXVECTOR3& dir, float maxDist, QueryHit& outHit, const QueryFilter& filter = QueryFilter());
+    int CapsuleCastAll(const D3DXVECTOR3& center, float radius, float height, const D3DXVECTOR3& dir, float maxDist, std::vector<QueryHit>& outHits, const QueryFilter& filter = QueryFilter());
+    int OverlapBox(const D3DXVECTOR3& center, const D3DXVECTOR3& size, const D3DXQUATERNION& rot, std::vector<RigidBody*>& outBodies, const QueryFilter& filter = QueryFilter());
+    int OverlapSphere(const D3DXVECTOR3& center, float radius, std::vector<RigidBody*>& outBodies, const QueryFilter& filter = QueryFilter());
+
+    // たくさんのレイをまとめて飛ばす（向きの近いレイを並べておくと速い）。レイごとの一番近い剛体と距離を返し、返り値は当たった数
+    int RayCastPacket(const D3DXVECTOR3* origins, const D3DXVECTOR3* dirs, int count, float maxDist,
+        RigidBody** outBodies, float* outDistances, const QueryFilter& filter = QueryFilter());
+
+    RigidBody* GetRigidBody(const RigidBodyHandle& handle) const { return m_BodyPool.Get(handle); }
     const D3DXVECTOR3& GetGravity(void) const { return m_Gravity; }
+    int GetBodyCount(void) const { return (int)(m_StaticBodies.size() + m_DynamicBodies.size()); }
+    int GetStaticBodyCount(void) const { return (int)m_StaticBodies.size(); }
+    int GetDynamicBodyCount(void) const { return (int)m_DynamicBodies.size(); }
+    int GetAwakeBodyCount(void) const { return (int)m_DynamicBodies.size() - m_NumSleeping; }
+    int GetSleepingBodyCount(void) const { return m_NumSleeping; }
+    int GetPairCount(void) const { return (int)m_Pairs.size(); }
+    int GetContactCount(void) const { return (int)m_Manifolds.size(); }
+    int GetVelocityIterations(void) const { return m_VelocityIterations; }
+    int GetPositionIterations(void) const { return m_PositionIterations; }
+    int GetVelocityPasses(void) const { return m_VelocityPasses; }
+    int GetPositionPasses(void) const { return m_PositionPasses; }
+    bool IsSolverConverged(void) const { return m_isSolverConverged; }
+    int GetUnconvergedStepCount(void) const { return m_NumUnconvergedSteps; }
+    float GetImpulseTolerance(void) const { return m_ImpulseTolerance; }
+    float GetPenetrationTolerance(void) const { return m_PenetrationTolerance; }
+    float GetStepTime(void) const { return m_StepTime; }
+    bool IsContinuousCollision(void) const { return m_isContinuous; }
+    bool IsWarmStarting(void) const { return m_isWarmStarting; }
+    int GetSpeculativeContactCount(void) const { return m_NumSpeculative; }
+    const std::vector<TriggerOverlap>& GetTriggerOverlaps(void) const { return m_TriggerOverlaps; }
+    int GetThreadCount(void) const { return m_ThreadCount; }
+    int GetIslandCount(void) const { return (int)m_Islands.size(); }
+    float GetIntegrateTime(void) const { return m_IntegrateTime; }
+    float GetBroadphaseTime(void) const { return m_BroadphaseTime; }
+    float GetNarrowphaseTime(void) const { return m_NarrowphaseTime; }
+    float GetSolveTime(void) const { return m_SolveTime; }
+    float GetSleepTime(void) const { return m_SleepTime; }
+    int GetPhysicsRate(void) const { return m_PhysicsRate; }
+    int GetMaxSubSteps(void) const { return m_MaxSubSteps; }
+    int GetSubStepCount(void) const { return m_SubStepCount; }
+    int GetDroppedStepCount(void) const { return m_NumDroppedSteps; }
+    float GetFixedTimeStep(void) const { return m_FixedTimeStep; }
+    float GetInterpolationAlpha(void) const { return m_InterpolationAlpha; }
+    Broadphase::TYPE GetBroadphaseType(void) const { return m_pBroadphase->GetType(); }
 
 private:
-    D3DXVECTOR3 GetActualCollisionPoint(RigidBody* a, RigidBody* b, const D3DXVECTOR3& push);
-    bool IsUnstableStack(RigidBody* A, RigidBody* B);
+    friend class PhysicsBench;  // 計測用の実行ファイルから場面を組んで中を調べる
+
+    D3DXVECTOR3 GetActualCollisionPoint(Collider* a, Collider* b);
+
+    // アイランド（接触でつながった剛体の集まり）
+    int FindIsland(int index);
+    void UniteIslands(int a, int b);
+    void WakeTouchedIslands(float dt);
+    void UpdateSleeping(void);
+    void RefreshStaticTree(bool isWait);
+    void SyncStaticTree(void);
+    void RefreshEditedBodies(void);
+
+    // 静的BVHをほかのスレッドで組む（Startで写し取って渡し、Finishで今のBVHと入れ替える）
+    void StartStaticBake(void);
+    bool FinishStaticBake(bool isWait);
+    void CancelStaticBake(void);
+
+    // 静的・動的リストから外す（末尾と入れ替えて詰める）
+    void EraseFromList(std::vector<RigidBody*>& list, RigidBody* body);
 
     // 衝突判定と押し戻し
     bool CheckCollision(RigidBody* a, RigidBody* b, D3DXVECTOR3& outPush);
 
+    // 衝突判定の振り分け（型の組み合わせで引く関数表）
+    template <class TA, class TB, bool (PhysicsWorld::*FUNC)(TA*, TB*, D3DXVECTOR3&)>
+    bool DispatchCollision(Collider* a, Collider* b, D3DXVECTOR3& outPush);
+    template <class TA, class TB, bool (PhysicsWorld::*FUNC)(TA*, TB*, D3DXVECTOR3&)>
+    bool DispatchCollisionSwapped(Collider* a, Collider* b, D3DXVECTOR3& outPush);
+    static constexpr CollisionTable MakeCollisionTable(void);
+
+    // 接触点の生成
+    int GenerateContacts(RigidBody* a, RigidBody* b, const D3DXVECTOR3& push, const D3DXVECTOR3& normal, ContactPoint* outPoints);
+    int ShapeContacts(Collider* colA, Collider* colB, const D3DXVECTOR3& push, const D3DXVECTOR3& normal, ContactPoint* outPoints);
+    int CompoundContacts(CompoundCollider* compound, Collider* other, const D3DXVECTOR3& normal, bool isSwapped, ContactPoint* outPoints);
+    int BoxBoxContacts(BoxCollider* a, BoxCollider* b, const D3DXVECTOR3& normal, float gap, ContactPoint* outPoints);
+    int BoxEdgeContact(BoxCollider* a, const D3DXVECTOR3* axesA, const float* halfA,
+        BoxCollider* b, const D3DXVECTOR3* axesB, const float* halfB, const D3DXVECTOR3& normal, ContactPoint* outPoints);
+    static void GetBoxFrame(BoxCollider* box, D3DXVECTOR3* outAxes, float* outHalf);
+    int MeshContacts(Collider* other, MeshCollider* mesh, const D3DXVECTOR3& normal, ContactPoint* outPoints);
+    int ConvexContacts(Collider* colA, Collider* colB, const D3DXVECTOR3& normal, float depth, ContactPoint* outPoints);
+    static int GetSupportFeature(Collider* col, const D3DXVECTOR3& dir, D3DXVECTOR3* outPoints, unsigned int* outIds);
+    static void OrderPolygon(D3DXVECTOR3* points, unsigned int* ids, int count, const D3DXVECTOR3& normal);
+
+    // 面の切り取りの頂点（featureは点の特徴の番号、edgeはこの点から次の点へ向かう辺の番号）
+    // 辺の番号は0～3が相手の面の辺、4～7が基準面の側面
+    struct ClipVertex
+    {
+        D3DXVECTOR3     position;   // 位置
+        unsigned int    feature;    // 特徴の番号
+        unsigned int    edge;       // 次の点へ向かう辺
+    };
+
+    static int ClipPolygon(const ClipVertex* in, int count, const D3DXVECTOR3& planeNormal, float offset, int planeIndex, ClipVertex* out);
+    int ReduceContacts(ContactPoint* points, int count, unsigned int anchorFeature);
+
+    // 予測接触の生成（高速な剛体が今は離れていてもステップ中に当たる相手）
+    int SweepContacts(RigidBody* a, RigidBody* b, float dt, D3DXVECTOR3& outNormal, ContactPoint* outPoints);
+    int BoxBoxSpeculative(RigidBody* a, RigidBody* b, float dt, D3DXVECTOR3& outNormal, ContactPoint* outPoints);
+    bool SweepCoreAgainstBox(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& motion,
+        BoxCollider* box, float& outGap, D3DXVECTOR3& outNormal, D3DXVECTOR3& outPoint);
+    bool SweepCoreAgainstMesh(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& motion,
+        MeshCollider* mesh, float& outGap, D3DXVECTOR3& outNormal, D3DXVECTOR3& outPoint);
+    static bool GetSweptCore(Collider* col, D3DXVECTOR3& outSegA, D3DXVECTOR3& outSegB, float& outRadius);
+
+    // 問い合わせの本体（芯＝線分＋半径をdirに進める。レイは長さ0・半径0の芯）
+    bool IsQueryTarget(const RigidBody* body, const QueryFilter& filter) const;
+    bool CastCore(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& dir, float maxDist,
+        const QueryFilter& filter, QueryHit* outClosest, std::vector<QueryHit>* outAll);
+    bool CastCoreAgainstBody(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& dir, float maxDist,
+        RigidBody* body, QueryHit& outHit);
+    bool CastCoreAgainstCollider(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& dir, float maxDist,
+        Collider* col, float& outDist, D3DXVECTOR3& outNormal, D3DXVECTOR3& outPoint);
+    bool AdvanceCore(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, const D3DXVECTOR3& dir, float maxDist,
+        Collider* col, float& outDist, D3DXVECTOR3& outNormal, D3DXVECTOR3& outPoint);
+    float ClosestPointsToCollider(const D3DXVECTOR3& p0, const D3DXVECTOR3& p1, Collider* col, D3DXVECTOR3& outOnCore, D3DXVECTOR3& outOnCollider);
+    int Overlap(Collider* col, std::vector<RigidBody*>& outBodies, const QueryFilter& filter);
+
+    // スナップショットの並び（パディングが入らないように4バイトの項目だけで組む）
+    struct SnapshotHeader
+    {
+        int             magic;              // 識別子
+        int             version;            // 並びの版
+        int             numBodies;          // 剛体数
+        int             numManifolds;       // 接触多様体の数
+        int             numTriggerKeys;     // トリガーとの重なりのキーの数
+        int             manifoldBytes;      // 接触多様体の部分の大きさ(バイト)
+        float           accumulator;        // まだステップにしていない経過時間
+        float           interpolationAlpha; // 描画の補間の割合
+        int             isStaticDirty;      // 静的BVHの作り直しが必要か（0・1）
+    };
+
+    struct SnapshotContact
+    {
+        D3DXVECTOR3     localA;             // Aのローカル接触点（次のステップの照合用）
+        float           normalImpulse;      // 累積法線インパルス
+        float           tangentImpulse[2];  // 累積摩擦インパルス
+        unsigned int    featureId;          // 接触を作った面・辺・頂点の組（次のステップの照合用）
+    };
+
+    // 多様体ごとにこのあとへ接触点をnumPoints個だけ続ける
+    struct SnapshotManifold
+    {
+        int             indexA;             // 剛体Aのプール内の番号
+        int             indexB;             // 剛体Bのプール内の番号
+        D3DXVECTOR3     normal;             // 法線（A→B）
+        int             numPoints;          // 接触点数
+    };
+
+    // 戻した接触キャッシュを多様体に広げる（戻してから最初に使うところで呼ぶ、何もなければ何もしない）
+    void ApplyRestoredContacts(void);
+
+    // レイと形状の交差（dirは正規化済み、法線は形状の外向き）
+    bool RayCapsule(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, const D3DXVECTOR3& a, const D3DXVECTOR3& b, float radius,
+        float maxDist, float& outDist, D3DXVECTOR3& outNormal);
+    bool RayOBB(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, BoxCollider* box, float maxDist, float& outDist, D3DXVECTOR3& outNormal);
+    bool RayCylinder(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, CylinderCollider* cyl, float maxDist, float& outDist, D3DXVECTOR3& outNormal);
+
+    // ナローフェーズの1組分の結果（スレッドごとのバッファに書いてから1つにまとめる）
+    struct NarrowphaseContact
+    {
+        unsigned long long                                      key;            // 剛体の組のキー（プール内の番号A・B）
+        RigidBody*                                              a;              // 剛体A
+        RigidBody*                                              b;              // 剛体B
+        D3DXVECTOR3                                             normal;         // 法線（A→B）
+        std::array<ContactPoint, ContactManifold::MAX_POINTS>   points;         // 接触点
+        int                                                     numPoints;      // 接触点数
+        bool                                                    isOnGround;     // 接地させる向きの接触か
+        bool                                                    isSpeculative;  // 予測接触か
+        bool                                                    isTrigger;      // トリガーとの重なりか（接触点なし）
+    };
+
+    ThreadPool* GetThreadPool(void);
+    void CollectContacts(float dt);
+    void DetectContacts(int begin, int end, float dt, std::vector<NarrowphaseContact>& out);
+    void MergeContacts(void);
+
+    // 接触でつながった剛体の集まりごとの解決の単位
+    struct Island
+    {
+        int     begin;          // m_IslandManifoldsの先頭
+        int     count;          // 多様体の数
+        int     velocityPasses; // 回した速度の反復回数
+        int     positionPasses; // 回しためり込み解消の反復回数
+        bool    isConverged;    // 上限までに収束したか
+    };
+
+    void BuildIslands(void);
+    void SolveIsland(Island& island, float dt);
+
+    // 接触の解決（PGS：速度は反発と摩擦、めり込みは疑似速度で解く）
+    void PrepareContacts(ContactManifold* const* manifolds, int count, float dt);
+    void WarmStart(ContactManifold* const* manifolds, int count);
+    float SolveVelocity(ContactManifold* const* manifolds, int count);
+    float SolvePosition(ContactManifold* const* manifolds, int count, float dt);
+    float ComputeEffectiveMass(const ContactManifold* manifold, const ContactPoint& cp, const D3DXVECTOR3& dir);
+    D3DXVECTOR3 GetRelativeVelocity(const ContactPoint& cp,
+        const D3DXVECTOR3& vA, const D3DXVECTOR3& wA, const D3DXVECTOR3& vB, const D3DXVECTOR3& wB);
+    void ApplyContactImpulse(const ContactManifold* manifold, const ContactPoint& cp, const D3DXVECTOR3& impulse,
+        D3DXVECTOR3& vA, D3DXVECTOR3& wA, D3DXVECTOR3& vB, D3DXVECTOR3& wB);
+
     // 各種判定関数
     bool BoxBoxCollision(BoxCollider* a, BoxCollider* b, D3DXVECTOR3& outPush);
     bool CapsuleBoxCollision(CapsuleCollider* cap, BoxCollider* box, D3DXVECTOR3& outPush);
     bool CapsuleCapsuleCollision(CapsuleCollider* a, CapsuleCollider* b, D3DXVECTOR3& outPush);
-    bool CylinderBoxCollision(CylinderCollider* cyl, BoxCollider* box, D3DXVECTOR3& outPush);
     bool CylinderCapsuleCollision(CylinderCollider* cyl, CapsuleCollider* cap, D3DXVECTOR3& outPush);
-    bool CylinderCylinderCollision(CylinderCollider* a, CylinderCollider* b, D3DXVECTOR3& outPush);
     bool SphereBoxCollision(SphereCollider* s, BoxCollider* b, D3DXVECTOR3& outPush);
     bool SphereCapsuleCollision(SphereCollider* s, CapsuleCollider* c, D3DXVECTOR3& outPush);
     bool SphereCylinderCollision(SphereCollider* s, CylinderCollider* c, D3DXVECTOR3& outPush);
     bool SphereSphereCollision(SphereCollider* s1, SphereCollider* s2, D3DXVECTOR3& outPush);
+    bool BoxMeshCollision(BoxCollider* box, MeshCollider* mesh, D3DXVECTOR3& outPush);
+    bool CapsuleMeshCollision(CapsuleCollider* cap, MeshCollider* mesh, D3DXVECTOR3& outPush);
+    bool CylinderMeshCollision(CylinderCollider* cyl, MeshCollider* mesh, D3DXVECTOR3& outPush);
+    bool SphereMeshCollision(SphereCollider* sphere, MeshCollider* mesh, D3DXVECTOR3& outPush);
+    bool MeshMeshCollision(MeshCollider* a, MeshCollider* b, D3DXVECTOR3& outPush);
+    bool CompoundCollision(CompoundCollider* compound, Collider* other, D3DXVECTOR3& outPush);
+    bool GjkCollision(Collider* a, Collider* b, D3DXVECTOR3& outPush);
+    bool ConvexMeshCollision(ConvexCollider* convex, MeshCollider* mesh, D3DXVECTOR3& outPush);
+    bool CoreMeshCollision(const D3DXVECTOR3& segA, const D3DXVECTOR3& segB, float radius, MeshCollider* mesh, D3DXVECTOR3& outPush);
+    static bool GetCollisionCore(Collider* col, D3DXVECTOR3& outSegA, D3DXVECTOR3& outSegB, float& outRadius);
 
     // ヘルパー関数
     // 線分p1-q1とp2-q2間の最短距離を求める（最近接点も返す）
@@ -66,15 +363,141 @@ private:
 
     void ProjectOBB(const D3DXVECTOR3& axis, BoxCollider* obb, float& outMin, float& outMax);
     D3DXVECTOR3 ClosestPointOnOBB(const D3DXVECTOR3& point, BoxCollider* obb);
+    float DistanceSqSegmentOBB(const D3DXVECTOR3& p0, const D3DXVECTOR3& p1, BoxCollider* obb,
+        D3DXVECTOR3& outOnSegment, D3DXVECTOR3& outOnBox);
+    D3DXVECTOR3 ClosestPointOnCylinder(const D3DXVECTOR3& point, CylinderCollider* cyl);
+
+    // 三角形の最近接点（線分との距離は交わっていれば0）
+    D3DXVECTOR3 ClosestPointOnTriangle(const D3DXVECTOR3& point, const D3DXVECTOR3& a, const D3DXVECTOR3& b, const D3DXVECTOR3& c);
+    float DistanceSqSegmentTriangle(const D3DXVECTOR3& p0, const D3DXVECTOR3& p1, const D3DXVECTOR3* tri,
+        D3DXVECTOR3& outOnSegment, D3DXVECTOR3& outOnTriangle);
+
+    // 芯とメッシュの三角形（trianglesの中だけ）の最近接点（距離の2乗、裏にいる・motionの向きで裏から近づく三角形は除く）
+    float ClosestPointsToTriangles(const D3DXVECTOR3& p0, const D3DXVECTOR3& p1, MeshCollider* mesh, const std::vector<int>& triangles,
+        const D3DXVECTOR3& motion, D3DXVECTOR3& outOnCore, D3DXVECTOR3& outOnMesh, D3DXVECTOR3& outNormal);
 
 private:
-    static constexpr int    AXIS             = 3;       // 各軸
-    static constexpr int    ITERATIONS       = 8;       // 反復回数
-    static constexpr float  DEFAULT_GRAVITY  = -300.0f; // デフォルトの重力
-    static constexpr float  HALF             = 0.5f;    // 半分
+    static constexpr int    AXIS                        = 3;       // 各軸
+    static constexpr int    DEFAULT_VELOCITY_ITERATIONS = 8;       // デフォルトの速度の反復回数
+    static constexpr int    DEFAULT_POSITION_ITERATIONS = 4;       // デフォルトのめり込み解消の反復回数
+    static constexpr float  DEFAULT_IMPULSE_TOLERANCE   = 0.003f;  // 収束とみなす1接触点あたりのインパルス
+    static constexpr float  DEFAULT_PENETRATION_TOLERANCE = 0.01f; // 収束とみなす残りのめり込み量
+    static constexpr int    DEFAULT_PHYSICS_RATE        = 60;      // デフォルトの物理の更新頻度(Hz)
+    static constexpr int    MIN_PHYSICS_RATE            = 10;      // 物理の更新頻度の下限(Hz)
+    static constexpr int    MAX_PHYSICS_RATE            = 240;     // 物理の更新頻度の上限(Hz)
+    static constexpr int    DEFAULT_MAX_SUBSTEPS        = 5;       // 1フレームで回すステップ数の上限
+    static constexpr float  MAX_FRAME_TIME              = 0.25f;   // 1フレームとして受け付ける最大の経過時間(秒)
+    static constexpr int    MAX_CANDIDATES              = 16;      // 減らす前の接触点の最大数
+    static constexpr float  CONTACT_TOLERANCE           = 0.5f;    // 接触点を拾う許容量
+    static constexpr float  PARALLEL_EPSILON            = 1e-3f;   // 辺が平行とみなす外積の長さの2乗
+    static constexpr float  EDGE_AXIS_BIAS              = 1.05f;   // 辺同士の軸を選ぶときの割増（面の軸を優先）
+    static constexpr float  FACE_CONTACT_DOT            = 0.99f;   // 法線と面の向きがこれ以上合えば面の接触として切り取る
+    static constexpr float  REFERENCE_FACE_TOLERANCE    = 0.02f;   // この差まではAの面を基準面にする
+    static constexpr int    NUM_FACE_EDGES              = 4;       // 箱の面の辺の数
+    static constexpr int    MAX_CLIP_POINTS             = 8;       // 四角形を4辺で切り取ったときの最大の頂点数
+    static constexpr float  CLIP_TOLERANCE              = 1e-3f;   // 側面の内側とみなす許容量
+    static constexpr unsigned int CLIP_FEATURE          = 0x20;    // 切り取りでできた点の印（下位は辺・側面の番号）
+    static constexpr unsigned int EDGE_FEATURE          = 0xFF;    // 辺同士の接触の印（面・面の組の番号と重ならない値）
+    static constexpr unsigned int MESH_FEATURE          = 0x40000000; // メッシュとの接触で相手側の点の印（下位は芯の端・箱の頂点の番号）
+    static constexpr unsigned int MESH_VERTEX_FEATURE   = 0x80000000; // メッシュとの接触でメッシュの頂点の印（下位は頂点の番号）
+    static constexpr int    MAX_FEATURE_POINTS          = 16;      // 支持点の面として拾う最大の点数
+    static constexpr float  FEATURE_TOLERANCE_RATIO     = 0.05f;   // 支持点の面に入れる許容量（AABBの対角の半分に対する割合）
+    static constexpr float  BOX_FEATURE_AXIS_DOT        = 0.05f;   // 箱の支持点の面で軸の両側の頂点を拾う傾き（向きとの内積の絶対値）
+    static constexpr int    CYLINDER_FEATURE_SEGMENTS   = 8;       // 支持点の面でシリンダーの縁を分ける数
+    static constexpr unsigned int CONVEX_REF_B_FEATURE  = 0x40;    // 凸の接触でBの面を基準にした印（下位は基準面の頂点の番号）
+    static constexpr float  COMPOUND_NORMAL_DOT         = 0.7f;    // 複合の子の押し戻しが法線とこれ以上合えば同じ組の接触にする
+    static constexpr unsigned int COMPOUND_CHILD_MASK   = 0x7;     // 特徴の番号に混ぜる子の番号の桁（超えた子は番号が重なるがウォームスタートが切れるだけ）
+    static constexpr int    COMPOUND_FEATURE_SHIFT_A    = 24;      // Aの子の番号を混ぜる位置（箱の特徴の番号とメッシュの印の間）
+    static constexpr int    COMPOUND_FEATURE_SHIFT_B    = 27;      // Bの子の番号を混ぜる位置
+    static constexpr float  POSITION_SLOP               = 0.1f;    // 位置補正で残すめり込み量
+    static constexpr float  POSITION_CORRECTION         = 0.8f;    // 1ステップで解消するめり込みの割合
+    static constexpr float  RESTITUTION_THRESHOLD       = 30.0f;   // 反発させる最低の衝突速度
+    static constexpr float  DEFAULT_GRAVITY             = -300.0f; // デフォルトの重力
+    static constexpr float  HALF                        = 0.5f;    // 半分
+    static constexpr float  STATIC_QUERY_MARGIN         = 2.0f;    // 静的BVH検索時の余裕
+    static constexpr float  SLEEP_LINEAR_VELOCITY       = 2.0f;    // これより遅ければ静止とみなす速度
+    static constexpr float  SLEEP_ANGULAR_VELOCITY      = 0.05f;   // これより遅ければ静止とみなす角速度
+    static constexpr int    SLEEP_FRAMES                = 30;      // 眠るまでの静止フレーム数
+    static constexpr float  CCD_MOTION_RATIO            = 0.5f;    // 最小の厚みに対してこれ以上動くと予測接触を作る割合
+    static constexpr float  SPECULATIVE_MARGIN          = 0.5f;    // 箱同士の隙間がこのステップで近づく量にこれを足した値より狭ければ予測接触を作る
+    static constexpr float  STABILIZE_LINEAR_VELOCITY   = 10.0f;   // 接地してこれより遅い剛体は速度を落として落ち着かせる
+    static constexpr float  STABILIZE_ANGULAR_VELOCITY  = 0.25f;   // 接地してこれより遅く回る剛体は速度を落として落ち着かせる
+    static constexpr float  STABILIZE_DAMPING           = 0.2f;    // 落ち着かせるときに残す速度の割合
+    static constexpr int    TOI_ITERATIONS              = 32;      // 到達時刻を詰める最大の反復回数
+    static constexpr float  TOI_TOLERANCE               = 0.05f;   // 到達したとみなす距離
+    static constexpr int    SEGMENT_ITERATIONS          = 4;       // 線分と箱の最近接点を詰める反復回数
+    static constexpr float  MIN_DISTANCE                = 1e-6f;   // 重なったとみなす距離
+    static constexpr int    QUERY_ITERATIONS            = 64;      // 形状を飛ばす問い合わせで詰める最大の反復回数
+    static constexpr int    NARROWPHASE_CHUNK           = 64;      // ナローフェーズで1回に取るペア数
+    static constexpr int    SNAPSHOT_MAGIC              = 0x50534E50; // スナップショットの識別子
+    static constexpr int    SNAPSHOT_VERSION            = 2;       // スナップショットの並びの版
+
+    static const CollisionTable m_CollisionTable;   // 衝突判定の関数表
 
-    std::vector<std::shared_ptr<RigidBody>> m_Bodies;   // リジッドボディ
-    D3DXVECTOR3                             m_Gravity;  // 重力
+    RigidBodyPool                           m_BodyPool;           // 剛体の実体と積分する状態
+    std::vector<RigidBody*>                 m_StaticBodies;       // 静的リジッドボディ
+    std::vector<RigidBody*>                 m_DynamicBodies;      // 動的リジッドボディ
+    std::unique_ptr<Broadphase>             m_pBroadphase;        // ブロードフェーズ（動的のみ）
+    StaticBVH                               m_StaticTree;         // 静的剛体のBVH
+    StaticBVH                               m_BakingTree;         // ほかのスレッドで組んでいる静的BVH
+    std::future<float>                      m_StaticBakeTask;     // 静的BVHを組む仕事（組んだ時間(ms)を返す。m_BakingTreeより先に壊して待つ）
+    std::vector<RigidBody*>                 m_StaticHits;         // 静的BVHの検索結果
+    std::vector<RigidBody*>                 m_QueryBodies;        // 重なりの問い合わせの候補
+    std::vector<BroadphasePair>             m_Pairs;              // 衝突候補ペア
+    NarrowphaseBatch                        m_NarrowphaseBatch;   // 球・箱の組のまとめ判定
+    ContactCache                            m_ContactCache;       // フレームをまたぐ接触キャッシュ
+    std::vector<unsigned char>              m_RestoredContacts;   // 戻したまま広げていない接触キャッシュ（スナップショットの多様体の並びのまま）
+    std::vector<ContactManifold*>           m_Manifolds;          // 今回接触している多様体
+    std::vector<int>                        m_IslandParent;       // アイランドの親（Union-Find）
+    std::vector<int>                        m_IslandSleepCounter; // アイランドごとの最小静止フレーム数
+    std::vector<RigidBody*>                 m_WakeSeeds;          // 今回起きている剛体に触れられた眠った剛体
+    std::vector<char>                       m_IsWakeRoot;         // 根の剛体ごとに、そのアイランドを起こすか
+    std::vector<Island>                     m_Islands;            // 今回解くアイランド（根の番号順）
+    std::vector<ContactManifold*>           m_IslandManifolds;    // アイランドごとに詰め直した多様体
+    std::vector<int>                        m_IslandOfRoot;       // 根の剛体からアイランドへの対応
+    std::vector<int>                        m_IslandOrder;        // スレッドに配る順番（大きい順）
+    std::unique_ptr<ThreadPool>             m_pThreadPool;        // ナローフェーズ・アイランドを並列に回すスレッド
+    std::vector<std::vector<NarrowphaseContact>> m_ThreadContacts; // スレッドごとのナローフェーズの結果
+    std::vector<NarrowphaseContact*>        m_SortedContacts;     // キー順に並べたナローフェーズの結果
+    std::vector<TriggerOverlap>             m_TriggerOverlaps;    // 今回のステップのトリガーとの重なり
+    std::vector<unsigned long long>         m_TriggerKeys;        // 今回の重なりのキー（キー順）
+    std::vector<unsigned long long>         m_PrevTriggerKeys;    // 前のステップの重なりのキー（キー順）
+    D3DXVECTOR3                             m_Gravity;            // 重力
+    float                                   m_StepTime;           // 1ステップの処理時間(ms)
+    float                                   m_IntegrateTime;      // 1ステップの速度・位置の積分の時間(ms)
+    float                                   m_BroadphaseTime;     // 1ステップのAABBの更新とペア集めの時間(ms)
+    float                                   m_NarrowphaseTime;    // 1ステップのナローフェーズの時間(ms)
+    float                                   m_SolveTime;          // 1ステップの接触の解決時間(ms)
+    float                                   m_SleepTime;          // 1ステップのスリープ判定の時間(ms)
+    float                                   m_StaticBakeTime;     // 前回ほかのスレッドで静的BVHを組んだ時間(ms)
+    float                                   m_FixedTimeStep;      // 1ステップの時間(秒)
+    float                                   m_Accumulator;        // まだステップにしていない経過時間(秒)
+    float                                   m_InterpolationAlpha; // 描画の補間の割合（前のステップ0～今のステップ1）
+    int                                     m_PhysicsRate;        // 物理の更新頻度(Hz)
+    int                                     m_MaxSubSteps;        // 1フレームで回すステップ数の上限
+    int                                     m_SubStepCount;       // 前のフレームで回したステップ数
+    int                                     m_NumDroppedSteps;    // 上限を超えて捨てたステップ数
+    int                                     m_NumSleeping;        // スリープ中の剛体数
+    int                                     m_NumSpeculative;     // 前回のステップで作った予測接触の数
+    int                                     m_NumRestoredManifolds; // m_RestoredContactsの多様体の数
+    int                                     m_VelocityIterations; // 速度の反復回数
+    int                                     m_PositionIterations; // めり込み解消の反復回数
+    int                                     m_VelocityPasses;     // 前回のステップで回した速度の反復回数
+    int                                     m_PositionPasses;     // 前回のステップで回しためり込み解消の反復回数
+    int                                     m_NumUnconvergedSteps; // 上限まで回しても収束しなかったステップ数
+    int                                     m_ThreadCount;        // 接触の解決に使うスレッド数（呼び出し側を含む）
+    float                                   m_ImpulseTolerance;   // 収束とみなす1接触点あたりのインパルス
+    float                                   m_PenetrationTolerance; // 収束とみなす残りのめり込み量
+    bool                                    m_isSolverConverged;  // 前回のステップで収束したか
+    bool                                    m_isContinuous;       // 高速な剛体に予測接触を作るか
+    bool                                    m_isWarmStarting;     // 前のステップの累積インパルスから解き始めるか
+    bool                                    m_isStaticDirty;      // 静的BVHの作り直しが必要か
+    bool                                    m_isBakeReplacing;    // 組んでいる静的BVHが今のBVHにない変更を含むか（今のBVHが古いか）
+    bool                                    m_isStaticBaked;      // 静的剛体を焼き込んで動かないものとして扱っているか
+    bool                                    m_isDeterministic;    // 決定論モードか
+    bool                                    m_isPaused;           // 一時停止中か
+    bool                                    m_isContactRestorePending; // m_RestoredContactsをまだ接触キャッシュに広げていないか
+    int                                     m_NumRequestedSteps;  // 一時停止中に進めるステップ数
 };
 
 #endif
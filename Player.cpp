@@ -122,29 +122,26 @@ HRESULT CPlayer::Init(void)
 
 	m_pShape->calculateLocalInertia(MASS, inertia);
 
-	// リジッドボディの生成
-	m_pRigidBody = std::make_shared<RigidBody>(m_pShape, MASS);
+	// リジッドボディの生成（物理ワールドに登録してハンドルを受け取る）
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
 
-	D3DXVECTOR3 euler = GetRot(); // オイラー角（ラジアン）
-	D3DXQUATERNION q;
-	D3DXQuaternionRotationYawPitchRoll(&q, euler.y, euler.x, euler.z);
+	if (pWorld != nullptr)
+	{
+		m_hRigidBody = pWorld->CreateRigidBody(m_pShape, MASS, true);
 
-	// 位置の設定
-	m_pRigidBody->SetTransform(m_colliderPos, q, GetSize());
+		RigidBody* pRigidBody = pWorld->GetRigidBody(m_hRigidBody);
 
-	m_pRigidBody->SetIsDynamic(true);			// ダイナミックブロックかどうか
+		D3DXVECTOR3 euler = GetRot(); // オイラー角（ラジアン）
+		D3DXQUATERNION q;
+		D3DXQuaternionRotationYawPitchRoll(&q, euler.y, euler.x, euler.z);
 
-	m_pRigidBody->SetLinearFactor(D3DXVECTOR3(1, 1, 1));
-	m_pRigidBody->SetAngularFactor(D3DXVECTOR3(0, 0, 0));
-	m_pRigidBody->SetFriction(1.5f);// 摩擦
-	m_pRigidBody->SetRollingFriction(0.0f);// 転がり摩擦
+		// 位置の設定
+		pRigidBody->SetTransform(m_colliderPos, q, GetSize());
 
-	// 物理ワールドに追加
-	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
-
-	if (pWorld != nullptr)
-	{
-		pWorld->AddRigidBody(m_pRigidBody);
+		pRigidBody->SetLinearFactor(D3DXVECTOR3(1, 1, 1));
+		pRigidBody->SetAngularFactor(D3DXVECTOR3(0, 0, 0));
+		pRigidBody->SetFriction(1.5f);// 摩擦
+		pRigidBody->SetRollingFriction(0.0f);// 転がり摩擦
 	}
 
 	//// ステンシルシャドウの生成
@@ -196,14 +193,14 @@ void CPlayer::ReleasePhysics(void)
 	//OnPhysicsReleased();
 
 	// リジッドボディの破棄
-	if (m_pRigidBody)
+	if (m_hRigidBody.IsValid())
 	{
 		if (world)
 		{
-			world->RemoveRigidBody(m_pRigidBody);
+			world->RemoveRigidBody(m_hRigidBody);
 		}
 
-		m_pRigidBody = nullptr;
+		m_hRigidBody = {};
 	}
 
 	// シェイプの破棄
@@ -250,19 +247,72 @@ void CPlayer::Update(void)
 		m_rotDest.y = atan2f(-input.moveDir.x, -input.moveDir.z);
 	}
 
+	RigidBody* pRigidBody = GetRigidBody();
+
+	if (pRigidBody == nullptr)
+	{
+		return;
+	}
+
 	// クォータニオンにして Rigidbody に渡す
 	D3DXQUATERNION q;
 	D3DXQuaternionRotationYawPitchRoll(&q, m_rot.y, 0, 0);
-	m_pRigidBody->SetOrientation(q);
+	pRigidBody->SetOrientation(q);
 
 	// Rigidbody から物理座標を取得（カプセル中心）
-	D3DXVECTOR3 rigidPos = m_pRigidBody->GetPosition();
+	D3DXVECTOR3 rigidPos = pRigidBody->GetPosition();
 
 	// カプセルコライダーに反映
 	m_colliderPos = rigidPos;
 
-	// モデル描画やゲーム上の座標は足元基準に変換
-	m_pos = rigidPos - Pos::OFFSET;
+	// モデル描画やゲーム上の座標は足元基準に変換（物理のステップの間は補間する）
+	D3DXVECTOR3 drawPos = pRigidBody->GetInterpolatedPosition(CManager::GetPhysicsWorld()->GetInterpolationAlpha());
+	m_pos = drawPos - Pos::OFFSET;
+
+	// 接地判定
+	m_bOnGround = OnGround(GROUND_PROBE_LENGTH);
+}
+//=============================================================================
+// 接地判定処理（カプセルの下の球より少し細い球を真下に飛ばす）
+//=============================================================================
+bool CPlayer::OnGround(float rayLength)
+{
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
+	RigidBody* pRigidBody = GetRigidBody();
+
+	if (pWorld == nullptr || pRigidBody == nullptr)
+	{
+		return false;
+	}
+
+	CapsuleCollider* pCapsule = static_cast<CapsuleCollider*>(pRigidBody->GetColliderPtr());
+
+	// 自分自身は外し、自分が当たる相手だけを地面とみなす
+	QueryFilter filter;
+	filter.mask = pRigidBody->GetCollisionMask();
+	filter.pIgnoreBody = pRigidBody;
+
+	// 細くした分だけ余計に下まで調べる（壁に触れているだけでは接地にしない）
+	float radius = pCapsule->GetRadius() * GROUND_PROBE_RATE;
+	float distance = pCapsule->GetRadius() - radius + rayLength;
+
+	QueryHit hit;
+
+	return pWorld->SphereCast(pCapsule->GetBottom(), radius, D3DXVECTOR3(0.0f, -1.0f, 0.0f), distance, hit, filter);
+}
+//=============================================================================
+// リジッドボディの取得処理（削除済みならnullptr）
+//=============================================================================
+RigidBody* CPlayer::GetRigidBody(void) const
+{
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
+
+	if (pWorld == nullptr)
+	{
+		return nullptr;
+	}
+
+	return pWorld->GetRigidBody(m_hRigidBody);
 }
 //=============================================================================
 // 描画処理
@@ -55,7 +55,7 @@ public:
 	//*****************************************************************************
 	// flagment関数
 	//*****************************************************************************
-	//bool OnGround(btDiscreteDynamicsWorld* world, btRigidBody* playerBody, float rayLength);
+	bool OnGround(float rayLength);
 
 	//*****************************************************************************
 	// setter関数
@@ -76,7 +76,7 @@ public:
 	bool GetIsMoving(void) const { return m_bIsMoving; }
 	D3DXVECTOR3 GetForward(void);
 	InputData GatherInput(void);
-	RigidBody* GetRigidBody(void) const { return m_pRigidBody.get(); }						// RigidBodyの取得
+	RigidBody* GetRigidBody(void) const;											// RigidBodyの取得
 	void ReleasePhysics(void);														// Physics破棄用
 
 	// ステート用にフラグ更新
@@ -91,12 +91,14 @@ private:
 	static constexpr float	MAX_GRAVITY		= -0.26f;	// 重力加速度
 	static constexpr float	CAPSULE_RADIUS	= 16.5f;	// カプセルコライダーの半径
 	static constexpr float	CAPSULE_HEIGHT	= 40.0f;	// カプセルコライダーの高さ
+	static constexpr float	GROUND_PROBE_LENGTH	= 2.0f;	// 接地とみなす足元からの距離
+	static constexpr float	GROUND_PROBE_RATE	= 0.9f;	// 接地判定の球の半径（カプセルの半径に対する割合）
 	static constexpr float	DOUBLE			= 2.0f;		// 二倍
 
 	CModel*						m_apModel[MAX_PARTS];	// モデル(パーツ)へのポインタ
 	CMotion*					m_pMotion;				// モーションへのポインタ
 	CDebugProc3D*				m_pDebug3D;				// 3Dデバッグ表示へのポインタ
-	std::shared_ptr<RigidBody>	m_pRigidBody;			// リジッドボディ
+	RigidBodyHandle				m_hRigidBody;			// リジッドボディのハンドル
 	std::shared_ptr<Collider>	m_pShape;				// コライダー
 	D3DXVECTOR3					m_pos;					// 位置
 	D3DXVECTOR3					m_rot;					// 向き
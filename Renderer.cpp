@@ -186,6 +186,123 @@ void CRenderer::Update(void)
 
 	ImGui::Dummy(ImVec2(0.0f, 10.0f)); // 空白を空ける
 
+	// 物理ワールドの情報
+	PhysicsWorld* pWorld = CManager::GetPhysicsWorld();
+
+	if (pWorld != nullptr)
+	{
+		// ブロードフェーズの切り替え（保存するとステージに残る）
+		static const char* BROADPHASE_NAME[] = { "SAP", "AABB Tree" };
+		int broadphase = (int)pWorld->GetBroadphaseType();
+
+		if (ImGui::Combo("Broadphase", &broadphase, BROADPHASE_NAME, IM_ARRAYSIZE(BROADPHASE_NAME)))
+		{
+			pWorld->SetBroadphase((Broadphase::TYPE)broadphase);
+		}
+
+		ImGui::Text("Physics Bodies : %d (Static %d / Dynamic %d)", pWorld->GetBodyCount(), pWorld->GetStaticBodyCount(), pWorld->GetDynamicBodyCount());
+		ImGui::Text("Physics Awake : %d / Sleeping : %d", pWorld->GetAwakeBodyCount(), pWorld->GetSleepingBodyCount());
+		ImGui::Text("Physics Pairs : %d", pWorld->GetPairCount());
+		ImGui::Text("Physics Contacts : %d  Trigger Overlaps : %d", pWorld->GetContactCount(), (int)pWorld->GetTriggerOverlaps().size());
+		ImGui::Text("Physics Step : %.3f ms", pWorld->GetStepTime());
+
+		// 物理の更新頻度（描画は前後のステップの間を補間する）
+		int physicsRate = pWorld->GetPhysicsRate();
+
+		ImGui::Text("Physics Rate :");
+
+		for (int nCnt = 0; nCnt < NUM_PHYSICS_RATES; nCnt++)
+		{
+			ImGui::SameLine();
+
+			char label[16];
+			sprintf_s(label, "%d Hz", PHYSICS_RATES[nCnt]);
+
+			if (ImGui::RadioButton(label, physicsRate == PHYSICS_RATES[nCnt]))
+			{
+				pWorld->SetPhysicsRate(PHYSICS_RATES[nCnt]);
+			}
+		}
+
+		int maxSubSteps = pWorld->GetMaxSubSteps();
+
+		if (ImGui::SliderInt("Max Sub Steps", &maxSubSteps, 1, 10))
+		{
+			pWorld->SetMaxSubSteps(maxSubSteps);
+		}
+
+		ImGui::Text("Sub Steps : %d  Alpha : %.2f  Dropped : %d",
+			pWorld->GetSubStepCount(), pWorld->GetInterpolationAlpha(), pWorld->GetDroppedStepCount());
+
+		// 決定論モード（描画の速さに依らず1フレーム1ステップ）
+		bool isDeterministic = pWorld->IsDeterministic();
+
+		if (ImGui::Checkbox("Deterministic (1 step / frame)", &isDeterministic))
+		{
+			pWorld->SetDeterministic(isDeterministic);
+		}
+
+		// ソルバーの反復回数
+		int velocityIterations = pWorld->GetVelocityIterations();
+		int positionIterations = pWorld->GetPositionIterations();
+
+		bool changedVel = ImGui::SliderInt("Velocity Iterations", &velocityIterations, 1, 30);
+		bool changedPos = ImGui::SliderInt("Position Iterations", &positionIterations, 0, 10);
+
+		if (changedVel || changedPos)
+		{
+			pWorld->SetSolverIterations(velocityIterations, positionIterations);
+		}
+
+		// 収束で打ち切った実際の反復回数
+		ImGui::Text("Solver Passes : vel %d/%d  pos %d/%d%s",
+			pWorld->GetVelocityPasses(), velocityIterations,
+			pWorld->GetPositionPasses(), positionIterations,
+			pWorld->IsSolverConverged() ? "" : "  (not converged)");
+		ImGui::Text("Unconverged Steps : %d", pWorld->GetUnconvergedStepCount());
+
+		// アイランドごとの並列解決
+		int threadCount = pWorld->GetThreadCount();
+
+		if (ImGui::SliderInt("Solver Threads", &threadCount, 1, MAX_SOLVER_THREADS))
+		{
+			pWorld->SetThreadCount(threadCount);
+		}
+
+		ImGui::Text("Narrowphase : %.3f ms  Islands : %d  Solve : %.3f ms",
+			pWorld->GetNarrowphaseTime(), pWorld->GetIslandCount(), pWorld->GetSolveTime());
+
+		float impulseTolerance = pWorld->GetImpulseTolerance();
+		float penetrationTolerance = pWorld->GetPenetrationTolerance();
+
+		bool changedImpulse = ImGui::DragFloat("Impulse Tolerance", &impulseTolerance, 0.0005f, 0.0f, 1.0f, "%.4f");
+		bool changedPenetration = ImGui::DragFloat("Penetration Tolerance", &penetrationTolerance, 0.001f, 0.0f, 1.0f, "%.3f");
+
+		if (changedImpulse || changedPenetration)
+		{
+			pWorld->SetConvergenceTolerance(impulseTolerance, penetrationTolerance);
+		}
+
+		// 高速な剛体の予測接触（すり抜け対策）
+		bool isContinuous = pWorld->IsContinuousCollision();
+
+		if (ImGui::Checkbox("Continuous Collision", &isContinuous))
+		{
+			pWorld->SetContinuousCollision(isContinuous);
+		}
+
+		ImGui::SameLine();
+		ImGui::Text("Speculative : %d", pWorld->GetSpeculativeContactCount());
+
+		// 前のステップの累積インパルスから解き始める
+		bool isWarmStarting = pWorld->IsWarmStarting();
+
+		if (ImGui::Checkbox("Warm Starting", &isWarmStarting))
+		{
+			pWorld->SetWarmStarting(isWarmStarting);
+		}
+	}
+
 	ImGui::Dummy(ImVec2(0.0f, 10.0f)); // 空白を空ける
 
 	//// カメラのデバッグ情報の表示処理
@@ -72,6 +72,10 @@ public:
 	LPD3DXCONSTANTTABLE GetSkyCubePSConsts(void) const { return m_pSkyPSConsts; }
 
 private:
+	static constexpr int NUM_PHYSICS_RATES = 3;			// 選べる物理の更新頻度の数
+	static constexpr int PHYSICS_RATES[NUM_PHYSICS_RATES] = { 30, 60, 120 };	// 選べる物理の更新頻度(Hz)
+	static constexpr int MAX_SOLVER_THREADS = 16;		// 接触の解決に使うスレッド数の上限
+
 	LPDIRECT3D9				m_pD3D;				// DirectX3Dオブジェクトへのポインタ
 	LPDIRECT3DDEVICE9		m_pD3DDevice;		// デバイスへのポインタ
 	static CDebugProc3D*	m_pDebug3D;			// 3Dデバッグ表示へのポインタ
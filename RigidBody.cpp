@@ -14,37 +14,94 @@
 //=============================================================================
 // コンストラクタ
 //=============================================================================
-RigidBody::RigidBody(std::shared_ptr<Collider> col, float mass)
-    : m_Collider(col), m_Mass(mass), m_Velocity(0, 0, 0),
-    m_Friction(0.1f), m_RollingFriction(0.1f),
+RigidBody::RigidBody(RigidBodyPool* pool, int index, std::shared_ptr<Collider> col, float mass)
+    : m_Collider(col), m_pPool(pool), m_Index(index),
+    m_RollingFriction(0.1f),
     m_LinearFactor(1, 1, 1), m_AngularFactor(1, 1, 1),
     m_Restitution(0.1f)
 {
-    m_onGround = false;
-    m_AccumulatedForce = INIT_VEC3;
-    m_AccumulatedTorque = INIT_VEC3;
-    D3DXQuaternionIdentity(&m_Orientation);
-    m_Scale = D3DXVECTOR3(1, 1, 1);
-    m_AngularVelocity = D3DXVECTOR3(0, 0, 0);
+    m_ProxyId = -1;
+    m_IslandIndex = -1;
+    m_WorldIndex = -1;
+    m_SleepCounter = 0;
+    m_pUserData = nullptr;
+    m_Rotation = INIT_VEC3;
     m_Inertia = D3DXVECTOR3(1, 1, 1);
 
-    if (m_Collider)
+    // 質量に合わせて逆質量と慣性モーメントを用意する
+    m_pPool->m_Mass[m_Index] = mass;
+
+    UpdateInverseMass();
+    UpdateInertia();
+}
+//=============================================================================
+// フラグの設定処理
+//=============================================================================
+void RigidBody::SetFlag(unsigned char flag, bool isOn)
+{
+    unsigned char& flags = m_pPool->m_Flags[m_Index];
+
+    if (isOn)
     {
-        m_Collider->calculateLocalInertia(m_Mass, m_Inertia);
+        flags |= flag;
+    }
+    else
+    {
+        flags &= ~flag;
+    }
+}
+//=============================================================================
+// 古いままのコライダーの位置を直す処理（読み込みで付いた印を外す。状態は変えないのでconst）
+//=============================================================================
+void RigidBody::RefreshCollider(void) const
+{
+    m_Collider->UpdateTransform(GetPosition(), GetOrientation(), GetScale());
+    m_pPool->m_Flags[m_Index] &= ~RigidBodyPool::FLAG_STALE_COLLIDER;
+}
+//=============================================================================
+// 動的かどうかの設定処理
+//=============================================================================
+void RigidBody::SetIsDynamic(bool flag)
+{
+    SetFlag(RigidBodyPool::FLAG_DYNAMIC, flag);
+
+    // 静的は逆質量0（ソルバーで動かされない）
+    UpdateInverseMass();
+}
+//=============================================================================
+// 逆質量の更新処理
+//=============================================================================
+void RigidBody::UpdateInverseMass(void)
+{
+    float mass = m_pPool->m_Mass[m_Index];
 
-        m_InertiaInv.x = (m_Inertia.x != 0) ? 1.0f / m_Inertia.x : 0.0f;
-        m_InertiaInv.y = (m_Inertia.y != 0) ? 1.0f / m_Inertia.y : 0.0f;
-        m_InertiaInv.z = (m_Inertia.z != 0) ? 1.0f / m_Inertia.z : 0.0f;
+    m_pPool->m_InverseMass[m_Index] = (IsDynamic() && mass > 0.0f) ? 1.0f / mass : 0.0f;
+}
+//=============================================================================
+// 慣性モーメントの更新処理（コライダーの現在のサイズから）
+//=============================================================================
+void RigidBody::UpdateInertia(void)
+{
+    if (!m_Collider)
+    {
+        return;
     }
+
+    m_Collider->calculateLocalInertia(m_pPool->m_Mass[m_Index], m_Inertia);
+
+    D3DXVECTOR3& inertiaInv = m_pPool->m_InertiaInv[m_Index];
+    inertiaInv.x = (m_Inertia.x != 0) ? 1.0f / m_Inertia.x : 0.0f;
+    inertiaInv.y = (m_Inertia.y != 0) ? 1.0f / m_Inertia.y : 0.0f;
+    inertiaInv.z = (m_Inertia.z != 0) ? 1.0f / m_Inertia.z : 0.0f;
 }
 //=============================================================================
 // 重力適用処理
 //=============================================================================
 void RigidBody::ApplyGravity(float dt, D3DXVECTOR3 gravity)
 {
-    if (m_isDynamic && !m_onGround)
+    if (IsDynamic() && !IsOnGround())
     {
-        m_Velocity += gravity * m_Mass * dt;
+        m_pPool->m_Velocity[m_Index] += gravity * m_pPool->m_Mass[m_Index] * dt;
     }
 }
 //=============================================================================
@@ -52,138 +109,223 @@ void RigidBody::ApplyGravity(float dt, D3DXVECTOR3 gravity)
 //=============================================================================
 void RigidBody::ApplyForce(const D3DXVECTOR3& force)
 {
-    if (!m_isDynamic)
+    if (!IsDynamic())
     {
         return;
     }
 
-    m_AccumulatedForce += force;
+    WakeUp();
+    m_pPool->m_Force[m_Index] += force;
 }
 //=============================================================================
 // 衝突点の適用処理
 //=============================================================================
 void RigidBody::ApplyForceAtPoint(const D3DXVECTOR3& force, const D3DXVECTOR3& point)
 {
-    if (!m_isDynamic)
+    if (!IsDynamic())
     {
         return;
     }
 
-    m_AccumulatedForce += force;
-    D3DXVECTOR3 r = point - m_Position;
+    WakeUp();
+    m_pPool->m_Force[m_Index] += force;
+    D3DXVECTOR3 r = point - GetPosition();
     D3DXVECTOR3 torque = INIT_VEC3;
     D3DXVec3Cross(&torque, &r, &force);
 
-    m_AccumulatedTorque += torque;
+    m_pPool->m_Torque[m_Index] += torque;
 }
 //=============================================================================
 // インパルスの適用
 //=============================================================================
 void RigidBody::ApplyImpulse(const D3DXVECTOR3& impulse, const D3DXVECTOR3& relPos)
 {
-    if (!m_isDynamic)
+    if (!IsDynamic())
     {
         return;
     }
 
-    m_Velocity += impulse / m_Mass;
+    WakeUp();
+    m_pPool->m_Velocity[m_Index] += impulse / m_pPool->m_Mass[m_Index];
 
     D3DXVECTOR3 angImpulse = INIT_VEC3;
     D3DXVec3Cross(&angImpulse, &relPos, &impulse);
 
-    m_AngularVelocity += D3DXVECTOR3(
-        angImpulse.x * m_InertiaInv.x,
-        angImpulse.y * m_InertiaInv.y,
-        angImpulse.z * m_InertiaInv.z
+    const D3DXVECTOR3& inertiaInv = m_pPool->m_InertiaInv[m_Index];
+
+    m_pPool->m_AngularVelocity[m_Index] += D3DXVECTOR3(
+        angImpulse.x * inertiaInv.x,
+        angImpulse.y * inertiaInv.y,
+        angImpulse.z * inertiaInv.z
     );
 }
 //=============================================================================
-// 更新処理
+// 中心設定処理
 //=============================================================================
-void RigidBody::Integrate(float dt, const D3DXVECTOR3& gravity)
+void RigidBody::SetOrientation(const D3DXQUATERNION& q)
 {
-    if (!m_isDynamic)
+    D3DXQUATERNION& orientation = m_pPool->m_Orientation[m_Index];
+
+    if (q != orientation)
     {
-        return;
+        SetMoved(true);
+        WakeUp();
     }
 
-    // 線形速度更新
-    ApplyGravity(dt, gravity);
-
-    m_Position += m_Velocity * dt;
+    orientation = q;
 
-    // 角速度更新
-    D3DXVECTOR3 angAcc = D3DXVECTOR3(
-        m_AccumulatedTorque.x * m_InertiaInv.x,
-        m_AccumulatedTorque.y * m_InertiaInv.y,
-        m_AccumulatedTorque.z * m_InertiaInv.z
-    );
+    // 外から向きを決めたときは補間しない
+    m_pPool->m_PrevOrientation[m_Index] = q;
 
-    m_AngularVelocity += angAcc * dt;
+    // コライダーにも反映
+    if (m_Collider)
+    {
+        m_Collider->UpdateTransform(GetPosition(), orientation, GetScale());
+        SetFlag(RigidBodyPool::FLAG_STALE_COLLIDER, false);
+    }
+}
+//=============================================================================
+// トランスフォーム設定処理
+//=============================================================================
+void RigidBody::SetTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale)
+{
+    D3DXVECTOR3& position = m_pPool->m_Position[m_Index];
+    D3DXQUATERNION& orientation = m_pPool->m_Orientation[m_Index];
+    D3DXVECTOR3& currentScale = m_pPool->m_Scale[m_Index];
 
-    // Quaternion更新
-    if (D3DXVec3LengthSq(&m_AngularVelocity) > 1e-6f)
+    // 静的ブロックは毎フレーム同じ値で呼ばれるので変化したときだけ印を付ける
+    if (pos != position || rot != orientation || scale != currentScale)
     {
-        D3DXQUATERNION omega(m_AngularVelocity.x, m_AngularVelocity.y, m_AngularVelocity.z, 0);
-        D3DXQUATERNION dq;
-        D3DXQuaternionMultiply(&dq, &omega, &m_Orientation);
+        SetMoved(true);
+        WakeUp();
+    }
+
+    bool isScaled = (scale != currentScale);
 
-        dq.x *= 0.5f * dt;
-        dq.y *= 0.5f * dt;
-        dq.z *= 0.5f * dt;
-        dq.w *= 0.5f * dt;
+    position = pos;
+    orientation = rot;
+    currentScale = scale;
 
-        m_Orientation.x += dq.x;
-        m_Orientation.y += dq.y;
-        m_Orientation.z += dq.z;
-        m_Orientation.w += dq.w;
+    // 置き直したときは前の位置から補間しない
+    m_pPool->m_PrevPosition[m_Index] = pos;
+    m_pPool->m_PrevOrientation[m_Index] = rot;
 
-        D3DXQuaternionNormalize(&m_Orientation, &m_Orientation);
+    if (m_Collider)
+    {
+        // コライダーの位置更新
+        m_Collider->UpdateTransform(pos, rot, scale);
+        SetFlag(RigidBodyPool::FLAG_STALE_COLLIDER, false);
     }
 
-    // 摩擦・転がり抵抗
-    m_Velocity *= (1.0f - m_Friction * dt);
+    // 大きさが変わったら慣性モーメントも合わせる
+    if (isScaled)
+    {
+        UpdateInertia();
+    }
+}
+//=============================================================================
+// 補間した位置の取得処理（alphaは前のステップから今のステップまでの割合）
+//=============================================================================
+D3DXVECTOR3 RigidBody::GetInterpolatedPosition(float alpha) const
+{
+    D3DXVECTOR3 pos;
+    D3DXVec3Lerp(&pos, &m_pPool->m_PrevPosition[m_Index], &m_pPool->m_Position[m_Index], alpha);
 
-    // 減衰をフレーム固定率で
-    m_AngularVelocity *= 0.98f;
+    return pos;
+}
+//=============================================================================
+// 補間した回転の取得処理
+//=============================================================================
+D3DXQUATERNION RigidBody::GetInterpolatedOrientation(float alpha) const
+{
+    D3DXQUATERNION q;
+    D3DXQuaternionSlerp(&q, &m_pPool->m_PrevOrientation[m_Index], &m_pPool->m_Orientation[m_Index], alpha);
 
-    // コライダー更新
-    if (m_Collider)
+    return q;
+}
+//=============================================================================
+// ワールド空間の逆慣性テンソル取得処理（R * I^-1 * R^T、回転方向の係数込み）
+//=============================================================================
+void RigidBody::GetInverseInertiaWorld(D3DXMATRIX& out) const
+{
+    ZeroMemory(&out, sizeof(out));
+
+    if (!IsDynamic())
     {
-        m_Collider->UpdateTransform(m_Position, m_Orientation, m_Scale);
+        return;
     }
 
-    // 力のリセット
-    m_AccumulatedForce = INIT_VEC3;
-    m_AccumulatedTorque = INIT_VEC3;
+    D3DXMATRIX rot;
+    D3DXMatrixRotationQuaternion(&rot, &GetOrientation());
+
+    // D3DXは行ベクトルなので軸は行に入っている
+    const float axis[3][3] =
+    {
+        { rot._11, rot._12, rot._13 },
+        { rot._21, rot._22, rot._23 },
+        { rot._31, rot._32, rot._33 },
+    };
+    const D3DXVECTOR3& inertiaInv = m_pPool->m_InertiaInv[m_Index];
+    const float inv[3] = { inertiaInv.x, inertiaInv.y, inertiaInv.z };
+    const float factor[3] = { m_AngularFactor.x, m_AngularFactor.y, m_AngularFactor.z };
+
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            float sum = 0.0f;
+
+            for (int k = 0; k < 3; k++)
+            {
+                sum += axis[k][row] * inv[k] * axis[k][col];
+            }
+
+            // 回転しない軸は寄与を消す（D3DXVec3TransformNormalでそのまま掛けられる並び）
+            out.m[row][col] = sum * factor[col];
+        }
+    }
 }
 //=============================================================================
-// 中心設定処理
+// スリープ処理
 //=============================================================================
-void RigidBody::SetOrientation(const D3DXQUATERNION& q)
+void RigidBody::Sleep(void)
 {
-    m_Orientation = q;
-    D3DXMATRIX mat;
-    D3DXMatrixRotationQuaternion(&mat, &m_Orientation);
-
-    // コライダーにも反映
-    if (m_Collider)
+    SetFlag(RigidBodyPool::FLAG_SLEEPING, true);
+    m_pPool->m_Velocity[m_Index] = INIT_VEC3;
+    m_pPool->m_AngularVelocity[m_Index] = INIT_VEC3;
+    m_pPool->m_Force[m_Index] = INIT_VEC3;
+    m_pPool->m_Torque[m_Index] = INIT_VEC3;
+}
+//=============================================================================
+// 起床処理
+//=============================================================================
+void RigidBody::WakeUp(void)
+{
+    if (!IsSleeping())
     {
-        m_Collider->UpdateTransform(m_Position, m_Orientation, m_Scale);
+        return;
     }
+
+    SetFlag(RigidBodyPool::FLAG_SLEEPING, false);
+    m_SleepCounter = 0;
 }
 //=============================================================================
-// トランスフォーム設定処理
+// 静止フレーム数の更新処理
 //=============================================================================
-void RigidBody::SetTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale)
+void RigidBody::UpdateSleepCounter(float linearThreshold, float angularThreshold)
 {
-    m_Position = pos;
-    m_Orientation = rot;
-    m_Scale = scale;
+    if (IsSleeping())
+    {
+        return;
+    }
 
-    if (m_Collider)
+    if (D3DXVec3LengthSq(&GetVelocity()) < linearThreshold * linearThreshold &&
+        D3DXVec3LengthSq(&GetAngularVelocity()) < angularThreshold * angularThreshold)
     {
-        // コライダーの位置更新
-        m_Collider->UpdateTransform(pos, rot, scale);
+        m_SleepCounter++;
     }
-}
\ No newline at end of file
+    else
+    {
+        m_SleepCounter = 0;
+    }
+}
@@ -10,6 +10,7 @@
 //*****************************************************************************
 // インクルードファイル
 //*****************************************************************************
+#include "RigidBodyPool.h"
 
 //*****************************************************************************
 // 前方宣言
@@ -21,12 +22,13 @@ class CylinderCollider;
 class SphereCollider;
 
 //*****************************************************************************
-// リジッドボディクラス
+// リジッドボディクラス（積分で触る状態はRigidBodyPoolの配列にある）
 //*****************************************************************************
 class RigidBody
 {
 public:
-    RigidBody(std::shared_ptr<Collider> col, float mass);
+    static constexpr unsigned int DEFAULT_COLLISION_LAYER = 1u << 0;       // 何も設定しないときのレイヤー
+    static constexpr unsigned int ALL_COLLISION_LAYERS    = 0xFFFFFFFFu;   // すべてのレイヤー
 
     // 重力適用処理
     void ApplyGravity(float dt, D3DXVECTOR3 gravity);
@@ -40,60 +42,114 @@ public:
     // インパルスの適用
     void ApplyImpulse(const D3DXVECTOR3& impulse, const D3DXVECTOR3& relPos);
 
-    // 更新
-    void Integrate(float dt, const D3DXVECTOR3& gravity);
-
     // ダイナミックブロックかどうか
-    bool IsDynamic(void) const { return m_isDynamic; }
+    bool IsDynamic(void) const { return HasFlag(RigidBodyPool::FLAG_DYNAMIC); }
+
+    bool IsOnGround(void) const { return HasFlag(RigidBodyPool::FLAG_ON_GROUND); }
+
+    // 前回のブロードフェーズ更新から動いたかどうか
+    bool IsMoved(void) const { return HasFlag(RigidBodyPool::FLAG_MOVED); }
+
+    // 1ステップの移動量が大きく、すり抜け対策が必要かどうか
+    bool IsFast(void) const { return HasFlag(RigidBodyPool::FLAG_FAST); }
+
+    // 重なりを知らせるだけで押し戻さない（トリガー）かどうか
+    bool IsTrigger(void) const { return HasFlag(RigidBodyPool::FLAG_TRIGGER); }
 
-    bool IsOnGround(void) const { return m_onGround; }
+    // レイヤーとマスクで当たる組か（お互いのマスクに相手のレイヤーが入っているとき）
+    bool CanCollideWith(const RigidBody* other) const
+    {
+        return (GetCollisionLayer() & other->GetCollisionMask()) != 0 && (other->GetCollisionLayer() & GetCollisionMask()) != 0;
+    }
 
-    void SetIsDynamic(bool flag) { m_isDynamic = flag; }
+    // スリープ
+    bool IsSleeping(void) const { return HasFlag(RigidBodyPool::FLAG_SLEEPING); }
+    void Sleep(void);
+    void WakeUp(void);
+    void UpdateSleepCounter(float linearThreshold, float angularThreshold);
+    int GetSleepCounter(void) const { return m_SleepCounter; }
+
+    void SetIsDynamic(bool flag);
     void SetLinearFactor(const D3DXVECTOR3& factor) { m_LinearFactor = factor; }
     void SetAngularFactor(const D3DXVECTOR3& factor) { m_AngularFactor = factor; }
-    void SetAngularVelocity(const D3DXVECTOR3& vel) { m_AngularVelocity = vel; }
-    void SetFriction(float f) { m_Friction = f; }
+    void SetAngularVelocity(const D3DXVECTOR3& vel) { m_pPool->m_AngularVelocity[m_Index] = vel; }
+    void SetPushVelocity(const D3DXVECTOR3& vel) { m_pPool->m_PushVelocity[m_Index] = vel; }
+    void SetTurnVelocity(const D3DXVECTOR3& vel) { m_pPool->m_TurnVelocity[m_Index] = vel; }
+    void SetFriction(float f) { m_pPool->m_Friction[m_Index] = f; }
     void SetRollingFriction(float f) { m_RollingFriction = f; }
-    void SetVelocity(D3DXVECTOR3 vel) { m_Velocity = vel; }
+    void SetVelocity(D3DXVECTOR3 vel) { if (vel != GetVelocity()) { WakeUp(); } m_pPool->m_Velocity[m_Index] = vel; }
     void SetRestitution(float r) { m_Restitution = r; }
-    void SetOnGround(bool flag) { m_onGround = flag; }
+    void SetOnGround(bool flag) { SetFlag(RigidBodyPool::FLAG_ON_GROUND, flag); }
+    void SetProxyId(int id) { m_ProxyId = id; }
+    void SetMoved(bool flag) { SetFlag(RigidBodyPool::FLAG_MOVED, flag); }
+    void SetFast(bool flag) { SetFlag(RigidBodyPool::FLAG_FAST, flag); }
+    void SetTrigger(bool flag) { SetFlag(RigidBodyPool::FLAG_TRIGGER, flag); }
+    void SetCollisionLayer(unsigned int layer) { m_pPool->m_CollisionLayer[m_Index] = layer; }
+    void SetCollisionMask(unsigned int mask) { m_pPool->m_CollisionMask[m_Index] = mask; }
+    void SetIslandIndex(int index) { m_IslandIndex = index; }
+    void SetWorldIndex(int index) { m_WorldIndex = index; }
+    void SetUserData(void* pUserData) { m_pUserData = pUserData; }
     void SetOrientation(const D3DXQUATERNION& q);
     void SetTransform(const D3DXVECTOR3& pos, const D3DXQUATERNION& rot, const D3DXVECTOR3& scale);
 
-    std::shared_ptr<Collider> GetCollider(void) const { return m_Collider; }
-    const D3DXVECTOR3& GetPosition(void) const { return m_Position; }
+    std::shared_ptr<Collider> GetCollider(void) const { SyncCollider(); return m_Collider; }
+    Collider* GetColliderPtr(void) const { SyncCollider(); return m_Collider.get(); } // 参照カウントを増やさない取得
+    const D3DXVECTOR3& GetPosition(void) const { return m_pPool->m_Position[m_Index]; }
     const D3DXVECTOR3& GetRotation(void) const { return m_Rotation; }
-    const D3DXVECTOR3& GetVelocity(void) const { return m_Velocity; }
-    const D3DXVECTOR3& GetScale(void) const { return m_Scale; }
-    const float GetFriction(void) const { return m_Friction; }
+    const D3DXVECTOR3& GetVelocity(void) const { return m_pPool->m_Velocity[m_Index]; }
+    const D3DXVECTOR3& GetScale(void) const { return m_pPool->m_Scale[m_Index]; }
+    const float GetFriction(void) const { return m_pPool->m_Friction[m_Index]; }
     const D3DXVECTOR3& GetAngularFactor(void) const { return m_AngularFactor; }
-    const D3DXVECTOR3& GetAngularVelocity(void) const { return m_AngularVelocity; }
+    const D3DXVECTOR3& GetAngularVelocity(void) const { return m_pPool->m_AngularVelocity[m_Index]; }
     const float GetRollingFriction(void) const { return m_RollingFriction; }
     const D3DXVECTOR3& GetInertia(void) const { return m_Inertia; }
-    const float GetMass(void) { return m_Mass; }
+    const float GetMass(void) { return m_pPool->m_Mass[m_Index]; }
+    float GetInverseMass(void) const { return m_pPool->m_InverseMass[m_Index]; }
+    void GetInverseInertiaWorld(D3DXMATRIX& out) const;
+    const D3DXVECTOR3& GetPushVelocity(void) const { return m_pPool->m_PushVelocity[m_Index]; }
+    const D3DXVECTOR3& GetTurnVelocity(void) const { return m_pPool->m_TurnVelocity[m_Index]; }
     float GetRestitution(void) const { return m_Restitution; }
-    const D3DXQUATERNION& GetOrientation(void) const { return m_Orientation; }
+    const D3DXQUATERNION& GetOrientation(void) const { return m_pPool->m_Orientation[m_Index]; }
+    unsigned int GetCollisionLayer(void) const { return m_pPool->m_CollisionLayer[m_Index]; }
+    unsigned int GetCollisionMask(void) const { return m_pPool->m_CollisionMask[m_Index]; }
+    D3DXVECTOR3 GetInterpolatedPosition(float alpha) const;
+    D3DXQUATERNION GetInterpolatedOrientation(float alpha) const;
+    int GetProxyId(void) const { return m_ProxyId; }
+    int GetIslandIndex(void) const { return m_IslandIndex; }
+    int GetWorldIndex(void) const { return m_WorldIndex; }
+    int GetPoolIndex(void) const { return m_Index; }
+    void* GetUserData(void) const { return m_pUserData; }       // 持ち主（問い合わせの結果から持ち主に戻る用）
 
 private:
+    friend class RigidBodyPool;
+
+    // 生成はRigidBodyPoolだけが行う
+    RigidBody(RigidBodyPool* pool, int index, std::shared_ptr<Collider> col, float mass);
+
+    bool HasFlag(unsigned char flag) const { return (m_pPool->m_Flags[m_Index] & flag) != 0; }
+
+    // スナップショットの読み込みでコライダーが古いままなら今の位置に合わせる
+    // （ステップではプールがまとめて先に直すので、並列のナローフェーズでは印を読むだけになる）
+    void SyncCollider(void) const { if (HasFlag(RigidBodyPool::FLAG_STALE_COLLIDER)) { RefreshCollider(); } }
+    void RefreshCollider(void) const;
+    void SetFlag(unsigned char flag, bool isOn);
+    void UpdateInertia(void);
+    void UpdateInverseMass(void);
+
     std::shared_ptr<Collider>   m_Collider;            // コライダーのポインタ
-    D3DXVECTOR3                 m_Position;            // 位置
-    D3DXVECTOR3                 m_Velocity;            // 速度
-    D3DXVECTOR3                 m_Scale;               // 拡大率
-    D3DXVECTOR3                 m_AccumulatedForce;    // 外力の蓄積
-    D3DXVECTOR3                 m_AccumulatedTorque;   // トルクの蓄積
+    RigidBodyPool*              m_pPool;               // 状態を持っているプール
+    int                         m_Index;               // プール内の配列番号
     D3DXVECTOR3                 m_AngularFactor;       // 回転方向
     D3DXVECTOR3                 m_Inertia;             // 慣性モーメント（回転しにくさ）
-    D3DXVECTOR3                 m_InertiaInv;          // 慣性
     D3DXVECTOR3                 m_Rotation;            // 向き
     D3DXVECTOR3                 m_LinearFactor;        // 移動方向
-    D3DXVECTOR3                 m_AngularVelocity;     // 角速度
-    D3DXQUATERNION              m_Orientation;         // 原点
-    float                       m_Friction;            // 摩擦
     float                       m_RollingFriction;     // 回転摩擦
     float                       m_Restitution;         // 反発係数
-    float                       m_Mass;                // 質量
-    bool                        m_isDynamic;           // 動的ブロックかどうか
-    bool                        m_onGround;            // 乗っているかどうか
+    int                         m_ProxyId;             // ブロードフェーズのプロキシ番号
+    int                         m_IslandIndex;         // アイランド計算用の番号
+    int                         m_WorldIndex;          // ワールドの静的・動的リスト内の番号
+    int                         m_SleepCounter;        // 静止が続いているフレーム数
+    void*                       m_pUserData;           // 持ち主のポインタ
 };
 
-#endif
\ No newline at end of file
+#endif
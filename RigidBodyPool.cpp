@@ -0,0 +1,550 @@
+//=============================================================================
+//
+// 剛体プール処理 [RigidBodyPool.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "RigidBodyPool.h"
+#include "RigidBody.h"
+#include "Collider.h"
+#include "Snapshot.h"
+
+//=============================================================================
+// コンストラクタ
+//=============================================================================
+RigidBodyPool::RigidBodyPool() : m_hasStaleColliders(false)
+{
+    // 今はなし
+}
+//=============================================================================
+// デストラクタ
+//=============================================================================
+RigidBodyPool::~RigidBodyPool()
+{
+    Clear();
+}
+//=============================================================================
+// 剛体の生成処理
+//=============================================================================
+RigidBodyHandle RigidBodyPool::Create(std::shared_ptr<Collider> col, float mass)
+{
+    // 空きスロットがあれば使い回す（世代は削除時に進めてある）
+    int slot = 0;
+
+    if (!m_FreeSlots.empty())
+    {
+        slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        slot = (int)m_Slots.size();
+        m_Slots.push_back({ -1, 0 });
+    }
+
+    int index = (int)m_Bodies.size();
+    m_Slots[slot].index = index;
+    m_SlotOfIndex.push_back(slot);
+
+    D3DXQUATERNION identity;
+    D3DXQuaternionIdentity(&identity);
+
+    m_Position.push_back(INIT_VEC3);
+    m_Velocity.push_back(INIT_VEC3);
+    m_AngularVelocity.push_back(INIT_VEC3);
+    m_PushVelocity.push_back(INIT_VEC3);
+    m_TurnVelocity.push_back(INIT_VEC3);
+    m_Force.push_back(INIT_VEC3);
+    m_Torque.push_back(INIT_VEC3);
+    m_InertiaInv.push_back(INIT_VEC3);
+    m_Scale.push_back(D3DXVECTOR3(1, 1, 1));
+    m_Orientation.push_back(identity);
+    m_PrevPosition.push_back(INIT_VEC3);
+    m_PrevOrientation.push_back(identity);
+    m_Mass.push_back(mass);
+    m_InverseMass.push_back(0.0f);
+    m_Friction.push_back(0.1f);
+    m_Flags.push_back(FLAG_MOVED);
+    m_CollisionLayer.push_back(RigidBody::DEFAULT_COLLISION_LAYER);
+    m_CollisionMask.push_back(RigidBody::ALL_COLLISION_LAYERS);
+    m_Collider.push_back(col.get());
+
+    // 配列をそろえてから本体を作る（コンストラクタで配列に書き込むため）
+    m_Bodies.push_back(std::unique_ptr<RigidBody>(new RigidBody(this, index, col, mass)));
+
+    return { slot, m_Slots[slot].generation };
+}
+//=============================================================================
+// 剛体の削除処理（末尾と入れ替えて詰める）
+//=============================================================================
+void RigidBodyPool::Destroy(const RigidBodyHandle& handle)
+{
+    if (Get(handle) == nullptr)
+    {
+        return;
+    }
+
+    int index = m_Slots[handle.slot].index;
+    int last = (int)m_Bodies.size() - 1;
+
+    if (index != last)
+    {
+        m_Position[index] = m_Position[last];
+        m_Velocity[index] = m_Velocity[last];
+        m_AngularVelocity[index] = m_AngularVelocity[last];
+        m_PushVelocity[index] = m_PushVelocity[last];
+        m_TurnVelocity[index] = m_TurnVelocity[last];
+        m_Force[index] = m_Force[last];
+        m_Torque[index] = m_Torque[last];
+        m_InertiaInv[index] = m_InertiaInv[last];
+        m_Scale[index] = m_Scale[last];
+        m_Orientation[index] = m_Orientation[last];
+        m_PrevPosition[index] = m_PrevPosition[last];
+        m_PrevOrientation[index] = m_PrevOrientation[last];
+        m_Mass[index] = m_Mass[last];
+        m_InverseMass[index] = m_InverseMass[last];
+        m_Friction[index] = m_Friction[last];
+        m_Flags[index] = m_Flags[last];
+        m_CollisionLayer[index] = m_CollisionLayer[last];
+        m_CollisionMask[index] = m_CollisionMask[last];
+        m_Collider[index] = m_Collider[last];
+        m_Bodies[index] = std::move(m_Bodies[last]);
+        m_SlotOfIndex[index] = m_SlotOfIndex[last];
+
+        // 移ってきた剛体の番号を付け直す
+        m_Bodies[index]->m_Index = index;
+        m_Slots[m_SlotOfIndex[index]].index = index;
+    }
+
+    m_Position.pop_back();
+    m_Velocity.pop_back();
+    m_AngularVelocity.pop_back();
+    m_PushVelocity.pop_back();
+    m_TurnVelocity.pop_back();
+    m_Force.pop_back();
+    m_Torque.pop_back();
+    m_InertiaInv.pop_back();
+    m_Scale.pop_back();
+    m_Orientation.pop_back();
+    m_PrevPosition.pop_back();
+    m_PrevOrientation.pop_back();
+    m_Mass.pop_back();
+    m_InverseMass.pop_back();
+    m_Friction.pop_back();
+    m_Flags.pop_back();
+    m_CollisionLayer.pop_back();
+    m_CollisionMask.pop_back();
+    m_Collider.pop_back();
+    m_Bodies.pop_back();
+    m_SlotOfIndex.pop_back();
+
+    // 世代を進めて古いハンドルを無効にする
+    m_Slots[handle.slot].index = -1;
+    m_Slots[handle.slot].generation++;
+    m_FreeSlots.push_back(handle.slot);
+}
+//=============================================================================
+// 全削除処理
+//=============================================================================
+void RigidBodyPool::Clear(void)
+{
+    // 残っているハンドルはすべて無効にする
+    for (int nCnt = 0; nCnt < (int)m_Slots.size(); nCnt++)
+    {
+        if (m_Slots[nCnt].index >= 0)
+        {
+            m_Slots[nCnt].index = -1;
+            m_Slots[nCnt].generation++;
+            m_FreeSlots.push_back(nCnt);
+        }
+    }
+
+    m_Position.clear();
+    m_Velocity.clear();
+    m_AngularVelocity.clear();
+    m_PushVelocity.clear();
+    m_TurnVelocity.clear();
+    m_Force.clear();
+    m_Torque.clear();
+    m_InertiaInv.clear();
+    m_Scale.clear();
+    m_Orientation.clear();
+    m_PrevPosition.clear();
+    m_PrevOrientation.clear();
+    m_Mass.clear();
+    m_InverseMass.clear();
+    m_Friction.clear();
+    m_Flags.clear();
+    m_CollisionLayer.clear();
+    m_CollisionMask.clear();
+    m_Collider.clear();
+    m_Bodies.clear();
+    m_SlotOfIndex.clear();
+    m_hasStaleColliders = false;
+}
+//=============================================================================
+// 領域の予約処理（まとめて生成する前に呼ぶ）
+//=============================================================================
+void RigidBodyPool::Reserve(int count)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    size_t capacity = (size_t)count;
+
+    m_Position.reserve(capacity);
+    m_Velocity.reserve(capacity);
+    m_AngularVelocity.reserve(capacity);
+    m_PushVelocity.reserve(capacity);
+    m_TurnVelocity.reserve(capacity);
+    m_Force.reserve(capacity);
+    m_Torque.reserve(capacity);
+    m_InertiaInv.reserve(capacity);
+    m_Scale.reserve(capacity);
+    m_Orientation.reserve(capacity);
+    m_PrevPosition.reserve(capacity);
+    m_PrevOrientation.reserve(capacity);
+    m_Mass.reserve(capacity);
+    m_InverseMass.reserve(capacity);
+    m_Friction.reserve(capacity);
+    m_Flags.reserve(capacity);
+    m_CollisionLayer.reserve(capacity);
+    m_CollisionMask.reserve(capacity);
+    m_Collider.reserve(capacity);
+    m_Bodies.reserve(capacity);
+    m_SlotOfIndex.reserve(capacity);
+    m_Slots.reserve(capacity);
+}
+//=============================================================================
+// 状態の大きさの取得処理（SaveStateが書き出すバイト数）
+//=============================================================================
+size_t RigidBodyPool::GetStateSize(void) const
+{
+    // 照合用のスロット・世代、位置・回転・拡大率と前のステップの位置・回転、速度と外力、摩擦・レイヤー・マスク、静止フレーム数、フラグ
+    size_t perBody =
+        sizeof(int) + sizeof(unsigned int) +
+        sizeof(D3DXVECTOR3) * 9 + sizeof(D3DXQUATERNION) * 2 +
+        sizeof(float) + sizeof(unsigned int) * 2 +
+        sizeof(int) + sizeof(unsigned char);
+
+    return perBody * m_Bodies.size();
+}
+//=============================================================================
+// 状態の書き出し処理（項目ごとの配列をそのまま写す）
+//=============================================================================
+void RigidBodyPool::SaveState(SnapshotWriter& writer) const
+{
+    size_t numBodies = m_Bodies.size();
+
+    if (numBodies == 0)
+    {
+        return;
+    }
+
+    // 戻すときに同じ剛体が同じ番号にいるかを確かめる
+    writer.WriteArray(m_SlotOfIndex.data(), numBodies);
+
+    unsigned char* generations = writer.Append(sizeof(unsigned int) * numBodies);
+
+    for (size_t nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        memcpy(generations + sizeof(unsigned int) * nCnt, &m_Slots[m_SlotOfIndex[nCnt]].generation, sizeof(unsigned int));
+    }
+
+    writer.WriteArray(m_Position.data(), numBodies);
+    writer.WriteArray(m_Orientation.data(), numBodies);
+    writer.WriteArray(m_Scale.data(), numBodies);
+    writer.WriteArray(m_PrevPosition.data(), numBodies);
+    writer.WriteArray(m_PrevOrientation.data(), numBodies);
+    writer.WriteArray(m_Velocity.data(), numBodies);
+    writer.WriteArray(m_AngularVelocity.data(), numBodies);
+    writer.WriteArray(m_PushVelocity.data(), numBodies);
+    writer.WriteArray(m_TurnVelocity.data(), numBodies);
+    writer.WriteArray(m_Force.data(), numBodies);
+    writer.WriteArray(m_Torque.data(), numBodies);
+    writer.WriteArray(m_Friction.data(), numBodies);
+    writer.WriteArray(m_CollisionLayer.data(), numBodies);
+    writer.WriteArray(m_CollisionMask.data(), numBodies);
+
+    // 静止フレーム数は剛体本体が持っている
+    unsigned char* sleepCounters = writer.Append(sizeof(int) * numBodies);
+
+    for (size_t nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        memcpy(sleepCounters + sizeof(int) * nCnt, &m_Bodies[nCnt]->m_SleepCounter, sizeof(int));
+    }
+
+    // コライダーが古いかどうかは状態ではないので落として書く（戻した直後に保存しても同じバイト列になる）
+    unsigned char* flags = writer.Append(numBodies);
+
+    for (size_t nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        flags[nCnt] = m_Flags[nCnt] & ~FLAG_STALE_COLLIDER;
+    }
+}
+//=============================================================================
+// 状態の読み込み処理（剛体の並びが違えば何も書き換えずにfalse）
+//=============================================================================
+bool RigidBodyPool::RestoreState(SnapshotReader& reader)
+{
+    size_t numBodies = m_Bodies.size();
+
+    if (reader.GetRemaining() < GetStateSize())
+    {
+        return false;
+    }
+
+    if (numBodies == 0)
+    {
+        return true;
+    }
+
+    const unsigned char* slotOfIndex = reader.Skip(sizeof(int) * numBodies);
+    const unsigned char* generations = reader.Skip(sizeof(unsigned int) * numBodies);
+    const unsigned char* position = reader.Skip(sizeof(D3DXVECTOR3) * numBodies);
+    const unsigned char* orientation = reader.Skip(sizeof(D3DXQUATERNION) * numBodies);
+    const unsigned char* scale = reader.Skip(sizeof(D3DXVECTOR3) * numBodies);
+    const unsigned char* prevPosition = reader.Skip(sizeof(D3DXVECTOR3) * numBodies);
+    const unsigned char* prevOrientation = reader.Skip(sizeof(D3DXQUATERNION) * numBodies);
+    const unsigned char* velocity = reader.Skip(sizeof(D3DXVECTOR3) * numBodies);
+    const unsigned char* angularVelocity = reader.Skip(sizeof(D3DXVECTOR3) * numBodies);
+    const unsigned char* pushVelocity = reader.Skip(sizeof(D3DXVECTOR3) * numBodies);
+    const unsigned char* turnVelocity = reader.Skip(sizeof(D3DXVECTOR3) * numBodies);
+    const unsigned char* force = reader.Skip(sizeof(D3DXVECTOR3) * numBodies);
+    const unsigned char* torque = reader.Skip(sizeof(D3DXVECTOR3) * numBodies);
+    const unsigned char* friction = reader.Skip(sizeof(float) * numBodies);
+    const unsigned char* collisionLayer = reader.Skip(sizeof(unsigned int) * numBodies);
+    const unsigned char* collisionMask = reader.Skip(sizeof(unsigned int) * numBodies);
+    const unsigned char* sleepCounters = reader.Skip(sizeof(int) * numBodies);
+    const unsigned char* flags = reader.Skip(numBodies);
+
+    // 先に全部照合する（生成・削除や動的・静的の切り替えがあったらリストの作り直しが要るので戻さない）
+    if (memcmp(slotOfIndex, m_SlotOfIndex.data(), sizeof(int) * numBodies) != 0)
+    {
+        return false;
+    }
+
+    for (size_t nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        unsigned int generation = 0;
+        memcpy(&generation, generations + sizeof(unsigned int) * nCnt, sizeof(unsigned int));
+
+        if (generation != m_Slots[m_SlotOfIndex[nCnt]].generation || ((flags[nCnt] ^ m_Flags[nCnt]) & FLAG_DYNAMIC))
+        {
+            return false;
+        }
+    }
+
+    // 置き場所が変わった剛体だけAABBの更新に印を付ける（動いていない静的剛体でBVHを作り直さない）
+    // コライダーの位置はここでは直さず、最初に使うときまで延ばす（戻しただけで使わない剛体の仮想呼び出しを省く）
+    for (size_t nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        size_t vecOffset = sizeof(D3DXVECTOR3) * nCnt;
+        size_t quatOffset = sizeof(D3DXQUATERNION) * nCnt;
+
+        bool isScaled = memcmp(scale + vecOffset, &m_Scale[nCnt], sizeof(D3DXVECTOR3)) != 0;
+        bool isMoved = isScaled ||
+            memcmp(position + vecOffset, &m_Position[nCnt], sizeof(D3DXVECTOR3)) != 0 ||
+            memcmp(orientation + quatOffset, &m_Orientation[nCnt], sizeof(D3DXQUATERNION)) != 0;
+
+        // 前の読み込みからまだ直していない印は残す
+        m_Flags[nCnt] = flags[nCnt] | (m_Flags[nCnt] & FLAG_STALE_COLLIDER);
+        memcpy(&m_Bodies[nCnt]->m_SleepCounter, sleepCounters + sizeof(int) * nCnt, sizeof(int));
+
+        if (!isMoved)
+        {
+            continue;
+        }
+
+        memcpy(&m_Position[nCnt], position + vecOffset, sizeof(D3DXVECTOR3));
+        memcpy(&m_Orientation[nCnt], orientation + quatOffset, sizeof(D3DXQUATERNION));
+        memcpy(&m_Scale[nCnt], scale + vecOffset, sizeof(D3DXVECTOR3));
+
+        m_Flags[nCnt] |= FLAG_MOVED;
+
+        if (m_Collider[nCnt] == nullptr)
+        {
+            continue;
+        }
+
+        // 慣性モーメントはコライダーの大きさから出すので、拡大率が変わったときだけはその場で直す
+        if (isScaled)
+        {
+            m_Collider[nCnt]->UpdateTransform(m_Position[nCnt], m_Orientation[nCnt], m_Scale[nCnt]);
+            m_Bodies[nCnt]->UpdateInertia();
+            m_Flags[nCnt] &= ~FLAG_STALE_COLLIDER;
+        }
+        else
+        {
+            m_Flags[nCnt] |= FLAG_STALE_COLLIDER;
+            m_hasStaleColliders = true;
+        }
+    }
+
+    memcpy(m_PrevPosition.data(), prevPosition, sizeof(D3DXVECTOR3) * numBodies);
+    memcpy(m_PrevOrientation.data(), prevOrientation, sizeof(D3DXQUATERNION) * numBodies);
+    memcpy(m_Velocity.data(), velocity, sizeof(D3DXVECTOR3) * numBodies);
+    memcpy(m_AngularVelocity.data(), angularVelocity, sizeof(D3DXVECTOR3) * numBodies);
+    memcpy(m_PushVelocity.data(), pushVelocity, sizeof(D3DXVECTOR3) * numBodies);
+    memcpy(m_TurnVelocity.data(), turnVelocity, sizeof(D3DXVECTOR3) * numBodies);
+    memcpy(m_Force.data(), force, sizeof(D3DXVECTOR3) * numBodies);
+    memcpy(m_Torque.data(), torque, sizeof(D3DXVECTOR3) * numBodies);
+    memcpy(m_Friction.data(), friction, sizeof(float) * numBodies);
+    memcpy(m_CollisionLayer.data(), collisionLayer, sizeof(unsigned int) * numBodies);
+    memcpy(m_CollisionMask.data(), collisionMask, sizeof(unsigned int) * numBodies);
+
+    return true;
+}
+//=============================================================================
+// 読み込みで古いままのコライダーの位置をまとめて直す処理
+//=============================================================================
+void RigidBodyPool::SyncColliders(void)
+{
+    if (!m_hasStaleColliders)
+    {
+        return;
+    }
+
+    for (size_t nCnt = 0; nCnt < m_Flags.size(); nCnt++)
+    {
+        if (m_Flags[nCnt] & FLAG_STALE_COLLIDER)
+        {
+            m_Collider[nCnt]->UpdateTransform(m_Position[nCnt], m_Orientation[nCnt], m_Scale[nCnt]);
+            m_Flags[nCnt] &= ~FLAG_STALE_COLLIDER;
+        }
+    }
+
+    m_hasStaleColliders = false;
+}
+//=============================================================================
+// 剛体の取得処理（削除済みならnullptr）
+//=============================================================================
+RigidBody* RigidBodyPool::Get(const RigidBodyHandle& handle) const
+{
+    if (handle.slot < 0 || handle.slot >= (int)m_Slots.size())
+    {
+        return nullptr;
+    }
+
+    const Slot& slot = m_Slots[handle.slot];
+
+    if (slot.index < 0 || slot.generation != handle.generation)
+    {
+        return nullptr;
+    }
+
+    return m_Bodies[slot.index].get();
+}
+//=============================================================================
+// ステップ前の位置・回転の保存処理
+//=============================================================================
+void RigidBodyPool::StorePreviousTransforms(void)
+{
+    // 眠っている剛体や静的剛体もまとめて写す（分岐より連続コピーの方が速い）
+    std::copy(m_Position.begin(), m_Position.end(), m_PrevPosition.begin());
+    std::copy(m_Orientation.begin(), m_Orientation.end(), m_PrevOrientation.begin());
+}
+//=============================================================================
+// 速度の積分処理（重力・トルク）
+//=============================================================================
+void RigidBodyPool::IntegrateVelocity(float dt, const D3DXVECTOR3& gravity)
+{
+    size_t numBodies = m_Flags.size();
+
+    for (size_t nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        unsigned char flags = m_Flags[nCnt];
+
+        if (!(flags & FLAG_DYNAMIC) || (flags & FLAG_SLEEPING))
+        {
+            continue;
+        }
+
+        // 接地はこのあとのナローフェーズで判定し直す
+        m_Flags[nCnt] = flags & ~FLAG_ON_GROUND;
+
+        // 線形速度更新
+        m_Velocity[nCnt] += gravity * m_Mass[nCnt] * dt;
+
+        // 角速度更新
+        const D3DXVECTOR3& torque = m_Torque[nCnt];
+        const D3DXVECTOR3& inertiaInv = m_InertiaInv[nCnt];
+
+        m_AngularVelocity[nCnt] += D3DXVECTOR3(
+            torque.x * inertiaInv.x,
+            torque.y * inertiaInv.y,
+            torque.z * inertiaInv.z) * dt;
+
+        // 力のリセット
+        m_Force[nCnt] = INIT_VEC3;
+        m_Torque[nCnt] = INIT_VEC3;
+    }
+}
+//=============================================================================
+// 位置の積分処理
+//=============================================================================
+void RigidBodyPool::IntegratePosition(float dt)
+{
+    size_t numBodies = m_Flags.size();
+
+    for (size_t nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        unsigned char flags = m_Flags[nCnt];
+
+        if (!(flags & FLAG_DYNAMIC) || (flags & FLAG_SLEEPING))
+        {
+            continue;
+        }
+
+        // 疑似速度は位置にだけ反映して捨てる（反発を生まない）
+        m_Position[nCnt] += (m_Velocity[nCnt] + m_PushVelocity[nCnt]) * dt;
+
+        D3DXVECTOR3 angVel = m_AngularVelocity[nCnt] + m_TurnVelocity[nCnt];
+
+        m_PushVelocity[nCnt] = INIT_VEC3;
+        m_TurnVelocity[nCnt] = INIT_VEC3;
+
+        // Quaternion更新
+        if (D3DXVec3LengthSq(&angVel) > MIN_ANGULAR_SPEED_SQ)
+        {
+            D3DXQUATERNION& orientation = m_Orientation[nCnt];
+            D3DXQUATERNION omega(angVel.x, angVel.y, angVel.z, 0);
+            D3DXQUATERNION dq;
+            D3DXQuaternionMultiply(&dq, &omega, &orientation);
+
+            orientation.x += dq.x * 0.5f * dt;
+            orientation.y += dq.y * 0.5f * dt;
+            orientation.z += dq.z * 0.5f * dt;
+            orientation.w += dq.w * 0.5f * dt;
+
+            D3DXQuaternionNormalize(&orientation, &orientation);
+        }
+
+        // 摩擦・転がり抵抗
+        m_Velocity[nCnt] *= (1.0f - m_Friction[nCnt] * dt);
+
+        // 減衰をフレーム固定率で
+        m_AngularVelocity[nCnt] *= ANGULAR_DAMPING;
+
+        m_Flags[nCnt] = flags | FLAG_MOVED;
+    }
+
+    // コライダー更新（仮想呼び出しは計算のループから外す）
+    for (size_t nCnt = 0; nCnt < numBodies; nCnt++)
+    {
+        unsigned char flags = m_Flags[nCnt];
+
+        if (!(flags & FLAG_DYNAMIC) || (flags & FLAG_SLEEPING) || m_Collider[nCnt] == nullptr)
+        {
+            continue;
+        }
+
+        m_Collider[nCnt]->UpdateTransform(m_Position[nCnt], m_Orientation[nCnt], m_Scale[nCnt]);
+    }
+}
@@ -0,0 +1,116 @@
+//=============================================================================
+//
+// 剛体プール処理 [RigidBodyPool.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _RIGIDBODYPOOL_H_// このマクロ定義がされていなかったら
+#define _RIGIDBODYPOOL_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// 前方宣言
+//*****************************************************************************
+class Collider;
+class RigidBody;
+class SnapshotWriter;
+class SnapshotReader;
+
+//*****************************************************************************
+// 剛体ハンドル（世代が合わなければ削除済みとして扱う）
+//*****************************************************************************
+struct RigidBodyHandle
+{
+    int          slot = -1;         // スロット番号
+    unsigned int generation = 0;    // 世代
+
+    bool IsValid(void) const { return slot >= 0; }
+};
+
+//*****************************************************************************
+// 剛体プールクラス（積分で触る状態を項目ごとの連続した配列で持つ）
+//*****************************************************************************
+class RigidBodyPool
+{
+public:
+    RigidBodyPool();
+    ~RigidBodyPool();
+
+    RigidBodyHandle Create(std::shared_ptr<Collider> col, float mass);
+    void Destroy(const RigidBodyHandle& handle);
+    void Clear(void);
+    void Reserve(int count);
+
+    // 速度・位置の積分（起きている動的剛体だけ）
+    void IntegrateVelocity(float dt, const D3DXVECTOR3& gravity);
+    void IntegratePosition(float dt);
+
+    // ステップ前の位置・回転を残す（描画の補間に使う）
+    void StorePreviousTransforms(void);
+
+    // 状態の書き出し・読み込み（スナップショット用、剛体の並びが書き出したときと同じなら戻せる）
+    // 読み込みでは置き場所が変わったコライダーに印を付けるだけで、位置は最初に使うときかSyncCollidersで直す
+    void SaveState(SnapshotWriter& writer) const;
+    bool RestoreState(SnapshotReader& reader);
+    size_t GetStateSize(void) const;
+
+    // 読み込みで古いままのコライダーの位置をまとめて直す（並列に読む前に呼ぶ）
+    void SyncColliders(void);
+
+    RigidBody* Get(const RigidBodyHandle& handle) const;
+    RigidBody* GetAt(int index) const { return m_Bodies[index].get(); }
+    int GetCount(void) const { return (int)m_Bodies.size(); }
+
+private:
+    friend class RigidBody;
+
+    // 状態フラグ
+    enum FLAG : unsigned char
+    {
+        FLAG_DYNAMIC   = 1 << 0,    // 動的
+        FLAG_SLEEPING  = 1 << 1,    // スリープ中
+        FLAG_ON_GROUND = 1 << 2,    // 接地中
+        FLAG_MOVED     = 1 << 3,    // AABBの更新が必要
+        FLAG_FAST      = 1 << 4,    // 1ステップで大きく動く（予測接触を作る）
+        FLAG_TRIGGER   = 1 << 5,    // 重なりを知らせるだけで押し戻さない
+        FLAG_STALE_COLLIDER = 1 << 6, // 読み込みで置き場所が変わり、コライダーがまだ前の位置にある（書き出さない）
+    };
+
+    // ハンドルから配列番号への対応
+    struct Slot
+    {
+        int          index;         // 配列番号（空きなら-1）
+        unsigned int generation;    // 世代
+    };
+
+    static constexpr float ANGULAR_DAMPING      = 0.98f;    // 角速度の減衰率（フレーム固定）
+    static constexpr float MIN_ANGULAR_SPEED_SQ = 1e-6f;    // 回転を更新する最低の角速度の2乗
+
+    // 積分で触る状態（番号はm_Bodiesとそろえる）
+    std::vector<D3DXVECTOR3>                m_Position;         // 位置
+    std::vector<D3DXVECTOR3>                m_Velocity;         // 速度
+    std::vector<D3DXVECTOR3>                m_AngularVelocity;  // 角速度
+    std::vector<D3DXVECTOR3>                m_PushVelocity;     // めり込み解消用の疑似速度
+    std::vector<D3DXVECTOR3>                m_TurnVelocity;     // めり込み解消用の疑似角速度
+    std::vector<D3DXVECTOR3>                m_Force;            // 外力の蓄積
+    std::vector<D3DXVECTOR3>                m_Torque;           // トルクの蓄積
+    std::vector<D3DXVECTOR3>                m_InertiaInv;       // 逆慣性モーメント
+    std::vector<D3DXVECTOR3>                m_Scale;            // 拡大率
+    std::vector<D3DXQUATERNION>             m_Orientation;      // 回転
+    std::vector<D3DXVECTOR3>                m_PrevPosition;     // 前のステップの位置
+    std::vector<D3DXQUATERNION>             m_PrevOrientation;  // 前のステップの回転
+    std::vector<float>                      m_Mass;             // 質量
+    std::vector<float>                      m_InverseMass;      // 逆質量（静的は0）
+    std::vector<float>                      m_Friction;         // 摩擦
+    std::vector<unsigned char>              m_Flags;            // 状態フラグ
+    std::vector<unsigned int>               m_CollisionLayer;   // 自分の属するレイヤー（ビット）
+    std::vector<unsigned int>               m_CollisionMask;    // 当たる相手のレイヤー（ビット）
+    std::vector<Collider*>                  m_Collider;         // コライダー（所有はRigidBody）
+
+    std::vector<std::unique_ptr<RigidBody>> m_Bodies;           // 剛体本体（アドレスは削除まで変わらない）
+    std::vector<int>                        m_SlotOfIndex;      // 配列番号からスロット番号
+    std::vector<Slot>                       m_Slots;            // ハンドルのスロット
+    std::vector<int>                        m_FreeSlots;        // 空きスロット
+    bool                                    m_hasStaleColliders; // FLAG_STALE_COLLIDERの剛体があるかもしれないか
+};
+
+#endif
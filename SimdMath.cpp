@@ -0,0 +1,52 @@
+//=============================================================================
+//
+// SIMD命令のまとまり [SimdMath.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "SimdMath.h"
+#include "intrin.h"
+
+//=============================================================================
+// AVX2が使えるかの取得処理（最初に1回だけ調べる）
+//=============================================================================
+bool SimdCpu::HasAvx2(void)
+{
+    static const bool isSupported = CheckAvx2();
+
+    return isSupported;
+}
+//=============================================================================
+// AVX2が使えるかの確認処理（CPUが対応していて、OSがYMMレジスタを保存するとき）
+//=============================================================================
+bool SimdCpu::CheckAvx2(void)
+{
+    int info[4] = {};
+
+    __cpuid(info, 0);
+
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    __cpuid(info, 1);
+
+    if ((info[2] & CPUID_ECX_OSXSAVE) == 0 || (info[2] & CPUID_ECX_AVX) == 0)
+    {
+        return false;
+    }
+
+    if ((_xgetbv(0) & XCR0_SSE_AVX) != XCR0_SSE_AVX)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+
+    return (info[1] & CPUID_EBX_AVX2) != 0;
+}
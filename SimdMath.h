@@ -0,0 +1,97 @@
+//=============================================================================
+//
+// SIMD命令のまとまり [SimdMath.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _SIMDMATH_H_// このマクロ定義がされていなかったら
+#define _SIMDMATH_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "immintrin.h"
+
+//*****************************************************************************
+// CPUの対応状況（AVX2版は専用のファイルだけをAVX2向けにビルドし、使えるCPUのときだけ呼ぶ）
+//*****************************************************************************
+struct SimdCpu
+{
+    static constexpr int AVX2_WIDTH = 8;    // AVX2版の同時処理数
+
+    static bool HasAvx2(void);
+
+private:
+    static bool CheckAvx2(void);
+
+    static constexpr int CPUID_ECX_OSXSAVE  = 1 << 27;  // 機能1のECX：OSがXSAVEでレジスタを保存する
+    static constexpr int CPUID_ECX_AVX      = 1 << 28;  // 機能1のECX：AVX
+    static constexpr int CPUID_EBX_AVX2     = 1 << 5;   // 機能7のEBX：AVX2
+    static constexpr unsigned long long XCR0_SSE_AVX = 0x6; // XCR0：XMM・YMMレジスタの状態をOSが保存する
+};
+
+//*****************************************************************************
+// SIMD命令のまとまり（判定はこの型を差し替えて4組・8組の両方を作る）
+//*****************************************************************************
+struct SimdSSE
+{
+    using Reg = __m128;
+    static constexpr int WIDTH = 4;
+
+    static Reg Load(const float* p) { return _mm_loadu_ps(p); }
+    static void Store(float* p, Reg v) { _mm_storeu_ps(p, v); }
+    static Reg Set(float f) { return _mm_set1_ps(f); }
+    static Reg Add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+    static Reg Sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+    static Reg Mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+    static Reg Div(Reg a, Reg b) { return _mm_div_ps(a, b); }
+    static Reg Min(Reg a, Reg b) { return _mm_min_ps(a, b); }
+    static Reg Max(Reg a, Reg b) { return _mm_max_ps(a, b); }
+    static Reg Sqrt(Reg a) { return _mm_sqrt_ps(a); }
+    static Reg Neg(Reg a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    static Reg Abs(Reg a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static Reg Less(Reg a, Reg b) { return _mm_cmplt_ps(a, b); }
+    static Reg LessEqual(Reg a, Reg b) { return _mm_cmple_ps(a, b); }
+    static Reg Greater(Reg a, Reg b) { return _mm_cmpgt_ps(a, b); }
+    static Reg And(Reg a, Reg b) { return _mm_and_ps(a, b); }
+    static Reg Or(Reg a, Reg b) { return _mm_or_ps(a, b); }
+    static Reg AndNot(Reg mask, Reg a) { return _mm_andnot_ps(mask, a); }
+    static Reg Select(Reg mask, Reg a, Reg b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    static Reg Zero(void) { return _mm_setzero_ps(); }
+    static int MoveMask(Reg mask) { return _mm_movemask_ps(mask); }
+};
+
+// AVX2向けにビルドしたファイル（/arch:AVX2）でだけ使える
+#if defined(__AVX2__)
+struct SimdAVX
+{
+    using Reg = __m256;
+    static constexpr int WIDTH = 8;
+
+    static Reg Load(const float* p) { return _mm256_loadu_ps(p); }
+    static void Store(float* p, Reg v) { _mm256_storeu_ps(p, v); }
+    static Reg Set(float f) { return _mm256_set1_ps(f); }
+    static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+    static Reg Sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+    static Reg Mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+    static Reg Div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+    static Reg Min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+    static Reg Max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+    static Reg Sqrt(Reg a) { return _mm256_sqrt_ps(a); }
+    static Reg Neg(Reg a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    static Reg Abs(Reg a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static Reg Less(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static Reg LessEqual(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static Reg Greater(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static Reg And(Reg a, Reg b) { return _mm256_and_ps(a, b); }
+    static Reg Or(Reg a, Reg b) { return _mm256_or_ps(a, b); }
+    static Reg AndNot(Reg mask, Reg a) { return _mm256_andnot_ps(mask, a); }
+    static Reg Select(Reg mask, Reg a, Reg b) { return _mm256_blendv_ps(b, a, mask); }
+    static Reg Zero(void) { return _mm256_setzero_ps(); }
+    static int MoveMask(Reg mask) { return _mm256_movemask_ps(mask); }
+};
+
+static_assert(SimdAVX::WIDTH == SimdCpu::AVX2_WIDTH, "AVX2版の同時処理数が合わない");
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+//=============================================================================
+//
+// スナップショットの読み書き処理 [Snapshot.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _SNAPSHOT_H_// このマクロ定義がされていなかったら
+#define _SNAPSHOT_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "type_traits"
+
+//*****************************************************************************
+// スナップショットの書き出し（値をそのままバイト列の末尾に足す）
+// 同じ実行ファイルの中で戻すためのもので、エンディアンや構造体の並びは変換しない
+//*****************************************************************************
+class SnapshotWriter
+{
+public:
+    SnapshotWriter(std::vector<unsigned char>& data) : m_Data(data) {}
+
+    template <class T> void Write(const T& value) { WriteArray(&value, 1); }
+
+    template <class T> void WriteArray(const T* values, size_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be trivially copyable");
+
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+        m_Data.insert(m_Data.end(), bytes, bytes + sizeof(T) * count);
+    }
+
+    // 末尾にsize分の領域を足して先頭を返す（ばらばらの場所から集めて書くとき用）
+    unsigned char* Append(size_t size)
+    {
+        size_t offset = m_Data.size();
+        m_Data.resize(offset + size);
+
+        return m_Data.data() + offset;
+    }
+
+private:
+    std::vector<unsigned char>& m_Data;   // 書き出し先（呼び出し側の容量を使い回す）
+};
+
+//*****************************************************************************
+// スナップショットの読み込み（足りなければfalse・nullptrを返して先へ進まない）
+//*****************************************************************************
+class SnapshotReader
+{
+public:
+    SnapshotReader(const std::vector<unsigned char>& data) : m_pData(data.data()), m_Size(data.size()), m_Offset(0) {}
+
+    template <class T> bool Read(T& value) { return ReadArray(&value, 1); }
+
+    template <class T> bool ReadArray(T* values, size_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be trivially copyable");
+
+        const unsigned char* bytes = Skip(sizeof(T) * count);
+
+        if (bytes == nullptr)
+        {
+            return false;
+        }
+
+        memcpy(values, bytes, sizeof(T) * count);
+
+        return true;
+    }
+
+    // size分読み飛ばして先頭を返す（並びがそろっているとは限らないのでmemcpy・memcmpで触る）
+    const unsigned char* Skip(size_t size)
+    {
+        if (size > m_Size - m_Offset)
+        {
+            return nullptr;
+        }
+
+        const unsigned char* bytes = m_pData + m_Offset;
+        m_Offset += size;
+
+        return bytes;
+    }
+
+    size_t GetRemaining(void) const { return m_Size - m_Offset; }
+
+private:
+    const unsigned char*    m_pData;    // 読み込み元
+    size_t                  m_Size;     // 全体の大きさ
+    size_t                  m_Offset;   // 読んだ位置
+};
+
+#endif
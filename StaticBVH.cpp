@@ -0,0 +1,322 @@
+//=============================================================================
+//
+// 静的BVH処理 [StaticBVH.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "StaticBVH.h"
+#include "StaticBVHSimd.h"
+#include "algorithm"
+
+//=============================================================================
+// 静的剛体の写し取り処理（AABBとレイ判定用の形だけを持ち、以降は剛体に触らない）
+//=============================================================================
+void StaticBVH::Gather(const std::vector<RigidBody*>& bodies)
+{
+    m_Nodes.clear();
+    m_Items.clear();
+    m_GatheredShapes.clear();
+
+    m_Items.reserve(bodies.size());
+    m_GatheredShapes.reserve(bodies.size());
+
+    for (RigidBody* body : bodies)
+    {
+        Collider* col = body->GetColliderPtr();
+
+        Item item;
+        item.box = col->GetAABB();
+        item.center = (item.box.min + item.box.max) * 0.5f;
+        item.body = body;
+        item.shape = (int)m_Items.size();
+        m_Items.push_back(item);
+
+        // レイを当てるたびに逆行列を作らないように、箱の軸はここで写しておく
+        RayShape shape = {};
+        shape.type = col->GetType();
+        shape.center = col->GetPosition();
+
+        if (shape.type == Collider::BOX)
+        {
+            BoxCollider* box = static_cast<BoxCollider*>(col);
+            const D3DXMATRIX& R = box->GetRotation();
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                shape.axis[axis] = D3DXVECTOR3(R.m[axis][0], R.m[axis][1], R.m[axis][2]);
+            }
+
+            shape.half = box->GetScaledSize() * 0.5f;
+        }
+        else if (shape.type == Collider::SPHERE)
+        {
+            shape.half = D3DXVECTOR3(static_cast<SphereCollider*>(col)->GetRadius(), 0.0f, 0.0f);
+        }
+
+        m_GatheredShapes.push_back(shape);
+    }
+}
+//=============================================================================
+// 写し取った要素からの構築処理
+//=============================================================================
+void StaticBVH::BuildGathered(void)
+{
+    m_Nodes.clear();
+    m_RayShapes.clear();
+
+    if (m_Items.empty())
+    {
+        return;
+    }
+
+    m_Nodes.reserve(m_Items.size() * 2);
+    BuildRecursive(0, (int)m_Items.size());
+
+    // 形も葉の並びにそろえて、葉を調べるときに続けて読めるようにする
+    m_RayShapes.resize(m_Items.size());
+
+    for (size_t nCnt = 0; nCnt < m_Items.size(); nCnt++)
+    {
+        m_RayShapes[nCnt] = m_GatheredShapes[m_Items[nCnt].shape];
+    }
+}
+//=============================================================================
+// 再帰構築処理（一番長い軸の中央値で分ける）
+//=============================================================================
+int StaticBVH::BuildRecursive(int start, int end)
+{
+    int nodeId = (int)m_Nodes.size();
+    m_Nodes.push_back({});
+
+    AABB box = m_Items[start].box;
+    AABB centerBox = { m_Items[start].center, m_Items[start].center };
+
+    for (int nCnt = start + 1; nCnt < end; nCnt++)
+    {
+        box.Merge(m_Items[nCnt].box);
+        centerBox.Merge({ m_Items[nCnt].center, m_Items[nCnt].center });
+    }
+
+    m_Nodes[nodeId].box = box;
+
+    if (end - start <= MAX_LEAF_ITEMS)
+    {
+        m_Nodes[nodeId].right = -1;
+        m_Nodes[nodeId].start = start;
+        m_Nodes[nodeId].count = end - start;
+        return nodeId;
+    }
+
+    D3DXVECTOR3 extent = centerBox.max - centerBox.min;
+    int axis = 0;
+
+    if (extent.y > extent.x && extent.y >= extent.z)
+    {
+        axis = 1;
+    }
+    else if (extent.z > extent.x && extent.z > extent.y)
+    {
+        axis = 2;
+    }
+
+    int mid = (start + end) / 2;
+
+    std::nth_element(m_Items.begin() + start, m_Items.begin() + mid, m_Items.begin() + end,
+        [axis](const Item& a, const Item& b) { return a.center[axis] < b.center[axis]; });
+
+    BuildRecursive(start, mid);
+    int right = BuildRecursive(mid, end);
+
+    m_Nodes[nodeId].right = right;
+    m_Nodes[nodeId].start = 0;
+    m_Nodes[nodeId].count = 0;
+
+    return nodeId;
+}
+//=============================================================================
+// 範囲検索処理
+//=============================================================================
+void StaticBVH::Query(const AABB& box, std::vector<RigidBody*>& out) const
+{
+    if (m_Nodes.empty())
+    {
+        return;
+    }
+
+    int stack[MAX_DEPTH];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const Node& node = m_Nodes[stack[--top]];
+
+        if (!node.box.Overlaps(box))
+        {
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            for (int nCnt = node.start; nCnt < node.start + node.count; nCnt++)
+            {
+                if (m_Items[nCnt].box.Overlaps(box))
+                {
+                    out.push_back(m_Items[nCnt].body);
+                }
+            }
+
+            continue;
+        }
+
+        // 左の子を先に調べる
+        int left = (int)(&node - m_Nodes.data()) + 1;
+        stack[top++] = node.right;
+        stack[top++] = left;
+    }
+}
+//=============================================================================
+// レイの検索処理（近いノードから調べ、funcが返した距離より先の枝は捨てる）
+//=============================================================================
+void StaticBVH::QueryRay(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, const D3DXVECTOR3& extent, const RayQueryFunc& func) const
+{
+    if (m_Nodes.empty())
+    {
+        return;
+    }
+
+    D3DXVECTOR3 invDir = AABB::InverseDirection(dir);
+
+    float enter = 0.0f;
+
+    if (!m_Nodes[0].box.IntersectRay(origin, invDir, maxDist, extent, enter))
+    {
+        return;
+    }
+
+    // 入る距離も一緒に積んで、取り出したときに縮んだ最大距離と比べる
+    int stack[MAX_DEPTH];
+    float stackEnter[MAX_DEPTH];
+    int top = 0;
+
+    stack[top] = 0;
+    stackEnter[top++] = enter;
+
+    while (top > 0)
+    {
+        top--;
+
+        if (stackEnter[top] > maxDist)
+        {
+            continue;
+        }
+
+        const Node& node = m_Nodes[stack[top]];
+
+        if (node.count > 0)
+        {
+            for (int nCnt = node.start; nCnt < node.start + node.count; nCnt++)
+            {
+                if (m_Items[nCnt].box.IntersectRay(origin, invDir, maxDist, extent, enter))
+                {
+                    maxDist = std::min(maxDist, func(m_Items[nCnt].body, maxDist));
+                }
+            }
+
+            continue;
+        }
+
+        int left = (int)(&node - m_Nodes.data()) + 1;
+        int right = node.right;
+
+        float enterLeft = 0.0f;
+        float enterRight = 0.0f;
+        bool isHitLeft = m_Nodes[left].box.IntersectRay(origin, invDir, maxDist, extent, enterLeft);
+        bool isHitRight = m_Nodes[right].box.IntersectRay(origin, invDir, maxDist, extent, enterRight);
+
+        // 遠い方を先に積んで近い方から調べる
+        if (isHitLeft && isHitRight && enterLeft > enterRight)
+        {
+            std::swap(left, right);
+            std::swap(enterLeft, enterRight);
+        }
+
+        if (isHitRight)
+        {
+            stack[top] = right;
+            stackEnter[top++] = enterRight;
+        }
+
+        if (isHitLeft)
+        {
+            stack[top] = left;
+            stackEnter[top++] = enterLeft;
+        }
+    }
+}
+//=============================================================================
+// まとめたレイの検索処理
+//=============================================================================
+void StaticBVH::QueryRayPacket(RayPacket& packet, const RayPacketFunc& func) const
+{
+    for (int nCnt = 0; nCnt < RayPacket::MAX_RAYS; nCnt++)
+    {
+        packet.body[nCnt] = nullptr;
+    }
+
+    if (m_Nodes.empty())
+    {
+        return;
+    }
+
+    // AVX2が使えるCPUなら8本を1回で判定する
+    if (SimdCpu::HasAvx2())
+    {
+        TraceRayPacketAvx2(packet, func);
+    }
+    else
+    {
+        TraceRayPacket<SimdSSE>(packet, func);
+    }
+}
+//=============================================================================
+// まとめたレイを同時に判定する数の取得処理
+//=============================================================================
+int StaticBVH::GetPacketLaneWidth(void)
+{
+    return SimdCpu::HasAvx2() ? SimdCpu::AVX2_WIDTH : SimdSSE::WIDTH;
+}
+//=============================================================================
+// まとめたレイで右の子の方が近いかの判定処理（子の中心が一番離れている軸で、lane番目のレイの向きから決める）
+//=============================================================================
+bool StaticBVH::IsRightChildNear(int left, int right, const RayPacket& packet, int lane) const
+{
+    D3DXVECTOR3 gap = (m_Nodes[right].box.min + m_Nodes[right].box.max) - (m_Nodes[left].box.min + m_Nodes[left].box.max);
+    float dir = packet.dirX[lane];
+    float axisGap = gap.x;
+
+    if (fabsf(gap.y) > fabsf(axisGap))
+    {
+        dir = packet.dirY[lane];
+        axisGap = gap.y;
+    }
+
+    if (fabsf(gap.z) > fabsf(axisGap))
+    {
+        dir = packet.dirZ[lane];
+        axisGap = gap.z;
+    }
+
+    return dir * axisGap < 0.0f;
+}
+//=============================================================================
+// まとめて判定できない形に1本だけ当てる処理
+//=============================================================================
+float StaticBVH::CastPacketLane(const RayPacketFunc& func, RigidBody* body, int lane, float maxDist)
+{
+    return func(body, lane, maxDist);
+}
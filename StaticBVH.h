@@ -0,0 +1,119 @@
+//=============================================================================
+//
+// 静的BVH処理 [StaticBVH.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _STATICBVH_H_// このマクロ定義がされていなかったら
+#define _STATICBVH_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "Collider.h"
+
+//*****************************************************************************
+// 前方宣言
+//*****************************************************************************
+class RigidBody;
+
+//*****************************************************************************
+// まとめて飛ばすレイ（向きの近いレイを最大8本、項目ごとの配列で持つ）
+//*****************************************************************************
+struct RayPacket
+{
+    static constexpr int MAX_RAYS = 8;      // 1つにまとめる最大のレイ数
+
+    float               originX[MAX_RAYS];      // 始点X
+    float               originY[MAX_RAYS];      // 始点Y
+    float               originZ[MAX_RAYS];      // 始点Z
+    float               dirX[MAX_RAYS];         // 向きX（正規化済み）
+    float               dirY[MAX_RAYS];         // 向きY
+    float               dirZ[MAX_RAYS];         // 向きZ
+    float               maxDist[MAX_RAYS];      // 入力：調べる距離（負なら使わないレイ） 出力：当たった距離
+    RigidBody*          body[MAX_RAYS];         // 出力：当たった剛体（当たらなければnullptr）
+    unsigned int        mask;                   // 対象にするレイヤー
+    bool                isHitTriggers;          // トリガーも対象にするか
+    const RigidBody*    pIgnoreBody;            // 対象から外す剛体
+};
+
+// まとめて判定できない形に1本ずつ当てる関数（当たった距離、当たらなければmaxDistを返す）
+using RayPacketFunc = std::function<float(RigidBody* body, int ray, float maxDist)>;
+
+//=============================================================================
+// 静的剛体用BVHクラス（ステージが編集されたときだけ作り直す）
+//=============================================================================
+class StaticBVH
+{
+public:
+    StaticBVH() {}
+
+    // 静的剛体からツリーを作り直す
+    void Build(const std::vector<RigidBody*>& bodies) { Gather(bodies); BuildGathered(); }
+
+    // 作り直しを2つに分ける（剛体・コライダーに触るのはGatherだけなので、BuildGatheredはほかのスレッドで回せる）
+    void Gather(const std::vector<RigidBody*>& bodies);
+    void BuildGathered(void);
+
+    // boxと重なる剛体をoutに追加する
+    void Query(const AABB& box, std::vector<RigidBody*>& out) const;
+
+    // 原点からdir（正規化済み）に進むレイに当たる剛体を近い順にfuncへ渡す（AABBはextentだけ太らせる）
+    void QueryRay(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, const D3DXVECTOR3& extent, const RayQueryFunc& func) const;
+
+    // まとめたレイを一緒に辿って一番近い当たりを求める（箱・球はSIMDで判定し、それ以外はfuncに任せる）
+    void QueryRayPacket(RayPacket& packet, const RayPacketFunc& func) const;
+    static int GetPacketLaneWidth(void);
+
+    void Clear(void) { m_Nodes.clear(); m_Items.clear(); m_RayShapes.clear(); m_GatheredShapes.clear(); }
+    int GetNodeCount(void) const { return (int)m_Nodes.size(); }
+
+private:
+    // ノード（葉はcount > 0）
+    struct Node
+    {
+        AABB    box;        // 子を囲むAABB
+        int     right;      // 右の子（左の子は直後のノード）
+        int     start;      // 葉の先頭要素
+        int     count;      // 葉の要素数
+    };
+
+    // 要素
+    struct Item
+    {
+        AABB        box;    // ワールドAABB
+        D3DXVECTOR3 center; // 分割用の中心
+        RigidBody*  body;   // 対象の剛体
+        int         shape;  // 写し取ったときの番号（組んだあとにm_RayShapesを同じ並びにする）
+    };
+
+    // 要素ごとのレイ判定用の形（箱はワールド→ローカルの変換を作っておく）
+    struct RayShape
+    {
+        int         type;       // Collider::TYPE
+        D3DXVECTOR3 center;     // 中心
+        D3DXVECTOR3 axis[3];    // 箱の軸（回転行列の行＝ローカルへの変換の列）
+        D3DXVECTOR3 half;       // 箱の半分の大きさ（球はxが半径）
+    };
+
+    int BuildRecursive(int start, int end);
+    template <class V> void TraceRayPacket(RayPacket& packet, const RayPacketFunc& func) const;
+    template <class V> int IntersectPacketAABB(const AABB& box, const RayPacket& packet, const float* invX, const float* invY, const float* invZ) const;
+
+    // AVX2版のまとめたレイの検索（StaticBVHAvx2.cppだけをAVX2向けにビルドし、使えるCPUのときだけ呼ぶ）
+    void TraceRayPacketAvx2(RayPacket& packet, const RayPacketFunc& func) const;
+
+    // SIMD版から呼ぶ浮動小数のインライン関数を使う処理（AVX2向けのファイルでほかと同じ関数を実体化しないよう、ここに置く）
+    bool IsRightChildNear(int left, int right, const RayPacket& packet, int lane) const;
+    static float CastPacketLane(const RayPacketFunc& func, RigidBody* body, int lane, float maxDist);
+
+    static constexpr int MAX_LEAF_ITEMS = 4;    // 葉に入れる最大要素数
+    static constexpr int MAX_DEPTH      = 64;   // 探索スタックの深さ
+
+    std::vector<Node>       m_Nodes;        // ノード（深さ優先順）
+    std::vector<Item>       m_Items;        // 要素
+    std::vector<RayShape>   m_RayShapes;    // 要素ごとのレイ判定用の形（m_Itemsと同じ並び）
+    std::vector<RayShape>   m_GatheredShapes; // 写し取ったときの並びの形（組み終わったら並べ替えてm_RayShapesへ）
+};
+
+#endif
@@ -0,0 +1,25 @@
+//=============================================================================
+//
+// 静的BVHのまとめたレイのAVX2版 [StaticBVHAvx2.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+// このファイルだけを /arch:AVX2 でビルドする（プロジェクトのファイルごとの設定）
+// AVX2命令で作った関数がほかのファイルの同じ関数と入れ替わらないよう、ここではSimdAVXの探索だけを実体化する
+//*****************************************************************************
+#include "StaticBVHSimd.h"
+
+#if !defined(__AVX2__)
+#error StaticBVHAvx2.cpp は /arch:AVX2 でビルドする
+#endif
+
+//=============================================================================
+// まとめたレイでツリーを辿る処理（AVX2版、8本を1回で判定する）
+//=============================================================================
+void StaticBVH::TraceRayPacketAvx2(RayPacket& packet, const RayPacketFunc& func) const
+{
+    TraceRayPacket<SimdAVX>(packet, func);
+}
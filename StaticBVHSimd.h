@@ -0,0 +1,227 @@
+//=============================================================================
+//
+// 静的BVHのまとめたレイのSIMD版 [StaticBVHSimd.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _STATICBVHSIMD_H_// このマクロ定義がされていなかったら
+#define _STATICBVHSIMD_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+// 命令のまとまりVを差し替えて、SSE版はStaticBVH.cpp、AVX2版はStaticBVHAvx2.cppで実体を作る
+//*****************************************************************************
+#include "StaticBVH.h"
+#include "RigidBody.h"
+#include "SimdMath.h"
+
+//=============================================================================
+// まとめたレイとAABBの判定処理（当たったレイのビットを返す）
+//=============================================================================
+template <class V>
+int StaticBVH::IntersectPacketAABB(const AABB& box, const RayPacket& packet, const float* invX, const float* invY, const float* invZ) const
+{
+    using R = typename V::Reg;
+
+    R minX = V::Set(box.min.x), minY = V::Set(box.min.y), minZ = V::Set(box.min.z);
+    R maxX = V::Set(box.max.x), maxY = V::Set(box.max.y), maxZ = V::Set(box.max.z);
+    int hitMask = 0;
+
+    for (int base = 0; base < RayPacket::MAX_RAYS; base += V::WIDTH)
+    {
+        R ox = V::Load(packet.originX + base), oy = V::Load(packet.originY + base), oz = V::Load(packet.originZ + base);
+        R ix = V::Load(invX + base), iy = V::Load(invY + base), iz = V::Load(invZ + base);
+
+        R t1x = V::Mul(V::Sub(minX, ox), ix), t2x = V::Mul(V::Sub(maxX, ox), ix);
+        R t1y = V::Mul(V::Sub(minY, oy), iy), t2y = V::Mul(V::Sub(maxY, oy), iy);
+        R t1z = V::Mul(V::Sub(minZ, oz), iz), t2z = V::Mul(V::Sub(maxZ, oz), iz);
+
+        R enter = V::Max(V::Max(V::Min(t1x, t2x), V::Min(t1y, t2y)), V::Max(V::Min(t1z, t2z), V::Zero()));
+        R exit = V::Min(V::Min(V::Max(t1x, t2x), V::Max(t1y, t2y)), V::Min(V::Max(t1z, t2z), V::Load(packet.maxDist + base)));
+
+        hitMask |= V::MoveMask(V::LessEqual(enter, exit)) << base;
+    }
+
+    return hitMask;
+}
+//=============================================================================
+// まとめたレイでツリーを辿る処理（どれか1本でも当たる枝だけ降り、葉の箱・球はレイをまとめて判定する）
+//=============================================================================
+template <class V>
+void StaticBVH::TraceRayPacket(RayPacket& packet, const RayPacketFunc& func) const
+{
+    using R = typename V::Reg;
+
+    // 軸に平行なレイは大きな値で割った代わりにする（0割りの無限大と0の積を避ける）
+    const float LARGE = 1e30f;
+    float invX[RayPacket::MAX_RAYS];
+    float invY[RayPacket::MAX_RAYS];
+    float invZ[RayPacket::MAX_RAYS];
+
+    for (int nCnt = 0; nCnt < RayPacket::MAX_RAYS; nCnt++)
+    {
+        invX[nCnt] = (packet.dirX[nCnt] != 0.0f) ? 1.0f / packet.dirX[nCnt] : LARGE;
+        invY[nCnt] = (packet.dirY[nCnt] != 0.0f) ? 1.0f / packet.dirY[nCnt] : LARGE;
+        invZ[nCnt] = (packet.dirZ[nCnt] != 0.0f) ? 1.0f / packet.dirZ[nCnt] : LARGE;
+    }
+
+    const R zero = V::Zero();
+    const R tiny = V::Set(1.0f / LARGE);
+
+    int stack[MAX_DEPTH];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const Node& node = m_Nodes[stack[--top]];
+
+        // 積んだあとに縮んだ距離で確かめ直す
+        int activeMask = IntersectPacketAABB<V>(node.box, packet, invX, invY, invZ);
+
+        if (activeMask == 0)
+        {
+            continue;
+        }
+
+        if (node.count == 0)
+        {
+            int left = (int)(&node - m_Nodes.data()) + 1;
+            int right = node.right;
+
+            // 当たっている最初のレイから見て遠い方を先に積んで近い方から調べる
+            int lane = 0;
+
+            while (!(activeMask & (1 << lane)))
+            {
+                lane++;
+            }
+
+            if (IsRightChildNear(left, right, packet, lane))
+            {
+                stack[top++] = left;
+                stack[top++] = right;
+            }
+            else
+            {
+                stack[top++] = right;
+                stack[top++] = left;
+            }
+            continue;
+        }
+
+        for (int nCnt = node.start; nCnt < node.start + node.count; nCnt++)
+        {
+            RigidBody* body = m_Items[nCnt].body;
+
+            if (body == packet.pIgnoreBody || (body->GetCollisionLayer() & packet.mask) == 0 ||
+                (!packet.isHitTriggers && body->IsTrigger()))
+            {
+                continue;
+            }
+
+            const RayShape& shape = m_RayShapes[nCnt];
+            int hitMask = 0;
+            float hitDist[RayPacket::MAX_RAYS];
+
+            if (shape.type == Collider::BOX)
+            {
+                // ローカル空間でのスラブ法（始点が中にあれば距離0）
+                R cx = V::Set(shape.center.x), cy = V::Set(shape.center.y), cz = V::Set(shape.center.z);
+
+                for (int base = 0; base < RayPacket::MAX_RAYS; base += V::WIDTH)
+                {
+                    R ox = V::Sub(V::Load(packet.originX + base), cx);
+                    R oy = V::Sub(V::Load(packet.originY + base), cy);
+                    R oz = V::Sub(V::Load(packet.originZ + base), cz);
+                    R dx = V::Load(packet.dirX + base);
+                    R dy = V::Load(packet.dirY + base);
+                    R dz = V::Load(packet.dirZ + base);
+
+                    R enter = zero;
+                    R exit = V::Load(packet.maxDist + base);
+
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        R ax = V::Set(shape.axis[axis].x), ay = V::Set(shape.axis[axis].y), az = V::Set(shape.axis[axis].z);
+                        R localOrigin = V::Add(V::Add(V::Mul(ox, ax), V::Mul(oy, ay)), V::Mul(oz, az));
+                        R localDir = V::Add(V::Add(V::Mul(dx, ax), V::Mul(dy, ay)), V::Mul(dz, az));
+
+                        // 平行に近い向きは小さな値に置き換える
+                        localDir = V::Select(V::Less(V::Abs(localDir), tiny), tiny, localDir);
+
+                        R inv = V::Div(V::Set(1.0f), localDir);
+                        R half = V::Set(shape.half[axis]);
+                        R t1 = V::Mul(V::Sub(V::Neg(half), localOrigin), inv);
+                        R t2 = V::Mul(V::Sub(half, localOrigin), inv);
+
+                        enter = V::Max(enter, V::Min(t1, t2));
+                        exit = V::Min(exit, V::Max(t1, t2));
+                    }
+
+                    V::Store(hitDist + base, enter);
+                    hitMask |= V::MoveMask(V::LessEqual(enter, exit)) << base;
+                }
+            }
+            else if (shape.type == Collider::SPHERE)
+            {
+                // 始点が中にあれば距離0
+                R cx = V::Set(shape.center.x), cy = V::Set(shape.center.y), cz = V::Set(shape.center.z);
+                R radiusSq = V::Set(shape.half.x * shape.half.x);
+
+                for (int base = 0; base < RayPacket::MAX_RAYS; base += V::WIDTH)
+                {
+                    R mx = V::Sub(V::Load(packet.originX + base), cx);
+                    R my = V::Sub(V::Load(packet.originY + base), cy);
+                    R mz = V::Sub(V::Load(packet.originZ + base), cz);
+                    R dx = V::Load(packet.dirX + base);
+                    R dy = V::Load(packet.dirY + base);
+                    R dz = V::Load(packet.dirZ + base);
+
+                    R b = V::Add(V::Add(V::Mul(mx, dx), V::Mul(my, dy)), V::Mul(mz, dz));
+                    R c = V::Sub(V::Add(V::Add(V::Mul(mx, mx), V::Mul(my, my)), V::Mul(mz, mz)), radiusSq);
+                    R disc = V::Sub(V::Mul(b, b), c);
+
+                    R isInside = V::LessEqual(c, zero);
+                    R t = V::Sub(V::Neg(b), V::Sqrt(V::Max(disc, zero)));
+                    t = V::Select(isInside, zero, t);
+
+                    R isHit = V::And(V::LessEqual(zero, disc), V::Or(isInside, V::LessEqual(zero, t)));
+                    isHit = V::And(isHit, V::LessEqual(t, V::Load(packet.maxDist + base)));
+
+                    V::Store(hitDist + base, t);
+                    hitMask |= V::MoveMask(isHit) << base;
+                }
+            }
+            else
+            {
+                // まとめて判定できない形は箱に当たったレイだけ1本ずつ
+                int boxMask = IntersectPacketAABB<V>(m_Items[nCnt].box, packet, invX, invY, invZ);
+
+                for (int lane = 0; lane < RayPacket::MAX_RAYS; lane++)
+                {
+                    if (boxMask & (1 << lane))
+                    {
+                        hitDist[lane] = CastPacketLane(func, body, lane, packet.maxDist[lane]);
+
+                        if (hitDist[lane] < packet.maxDist[lane])
+                        {
+                            hitMask |= 1 << lane;
+                        }
+                    }
+                }
+            }
+
+            for (int lane = 0; lane < RayPacket::MAX_RAYS; lane++)
+            {
+                if ((hitMask & (1 << lane)) && hitDist[lane] < packet.maxDist[lane])
+                {
+                    packet.maxDist[lane] = hitDist[lane];
+                    packet.body[lane] = body;
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,244 @@
+//=============================================================================
+//
+// スイープ＆プルーン処理 [SweepAndPrune.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "SweepAndPrune.h"
+#include "RigidBody.h"
+#include "algorithm"
+
+//=============================================================================
+// プロキシの生成処理
+//=============================================================================
+int SweepAndPrune::CreateProxy(RigidBody* body)
+{
+    int proxyId = 0;
+
+    if (!m_FreeList.empty())
+    {
+        proxyId = m_FreeList.back();
+        m_FreeList.pop_back();
+    }
+    else
+    {
+        proxyId = (int)m_Proxies.size();
+        m_Proxies.push_back({});
+    }
+
+    Proxy& proxy = m_Proxies[proxyId];
+    proxy.body = body;
+    proxy.box = body->GetColliderPtr()->GetAABB();
+    proxy.box.Expand(AABB_MARGIN);
+    proxy.activeSlot = -1;
+
+    // 端点は末尾に追加して次の更新でソートする
+    m_EndPoints.push_back({ proxy.box.min.x, proxyId, true });
+    m_EndPoints.push_back({ proxy.box.max.x, proxyId, false });
+    m_NumAdded += 2;
+
+    return proxyId;
+}
+//=============================================================================
+// プロキシの破棄処理
+//=============================================================================
+void SweepAndPrune::DestroyProxy(int proxyId)
+{
+    if (proxyId < 0 || proxyId >= (int)m_Proxies.size() || !m_Proxies[proxyId].body)
+    {
+        return;
+    }
+
+    // 端点は次の更新でまとめて取り除く
+    m_Proxies[proxyId].body = nullptr;
+    m_PendingFree.push_back(proxyId);
+}
+//=============================================================================
+// プロキシの移動処理
+//=============================================================================
+void SweepAndPrune::MoveProxy(int proxyId, const D3DXVECTOR3& motion)
+{
+    if (proxyId < 0 || proxyId >= (int)m_Proxies.size() || !m_Proxies[proxyId].body)
+    {
+        return;
+    }
+
+    Proxy& proxy = m_Proxies[proxyId];
+    proxy.box = proxy.body->GetColliderPtr()->GetAABB();
+    proxy.box.Sweep(motion);
+    proxy.box.Expand(AABB_MARGIN);
+}
+//=============================================================================
+// 端点の座標更新処理
+//=============================================================================
+void SweepAndPrune::RefreshEndPoints(void)
+{
+    // 削除されたプロキシの端点を一括で取り除く
+    if (!m_PendingFree.empty())
+    {
+        m_EndPoints.erase(std::remove_if(m_EndPoints.begin(), m_EndPoints.end(),
+            [this](const EndPoint& ep) { return m_Proxies[ep.proxyId].body == nullptr; }),
+            m_EndPoints.end());
+
+        m_FreeList.insert(m_FreeList.end(), m_PendingFree.begin(), m_PendingFree.end());
+        m_PendingFree.clear();
+    }
+
+    // 動いたプロキシのAABBはMoveProxyで更新済み
+    for (auto& ep : m_EndPoints)
+    {
+        const AABB& box = m_Proxies[ep.proxyId].box;
+        ep.value = ep.isMin ? box.min.x : box.max.x;
+    }
+}
+//=============================================================================
+// 端点のソート処理
+//=============================================================================
+void SweepAndPrune::SortEndPoints(void)
+{
+    // 同じ座標なら最小側を先にして接しているだけのペアも拾う
+    auto less = [](const EndPoint& a, const EndPoint& b)
+    {
+        return a.value < b.value || (a.value == b.value && a.isMin && !b.isMin);
+    };
+
+    if (m_NumAdded * FULL_SORT_DIVISOR > m_EndPoints.size())
+    {
+        // ステージ読み込み直後などは全ソート
+        std::sort(m_EndPoints.begin(), m_EndPoints.end(), less);
+    }
+    else
+    {
+        // 前フレームからほぼ並んでいるので挿入ソートでほぼO(n)
+        for (size_t nCnt = 1; nCnt < m_EndPoints.size(); nCnt++)
+        {
+            EndPoint key = m_EndPoints[nCnt];
+            size_t nCnt2 = nCnt;
+
+            while (nCnt2 > 0 && less(key, m_EndPoints[nCnt2 - 1]))
+            {
+                m_EndPoints[nCnt2] = m_EndPoints[nCnt2 - 1];
+                nCnt2--;
+            }
+
+            m_EndPoints[nCnt2] = key;
+        }
+    }
+
+    m_NumAdded = 0;
+}
+//=============================================================================
+// 衝突候補ペアの収集処理
+//=============================================================================
+void SweepAndPrune::UpdatePairs(std::vector<BroadphasePair>& outPairs)
+{
+    RefreshEndPoints();
+    SortEndPoints();
+
+    m_Active.clear();
+    m_ActiveBoxes.clear();
+    m_PairIds.clear();
+
+    // X軸でスイープし、区間が重なっている相手とだけY・Zを比較する
+    for (const auto& ep : m_EndPoints)
+    {
+        Proxy& proxy = m_Proxies[ep.proxyId];
+
+        if (!ep.isMin)
+        {
+            // 覚えておいた位置に末尾を移して詰める（探さずにO(1)で外す）
+            int slot = proxy.activeSlot;
+
+            if (slot >= 0)
+            {
+                int last = m_Active.back();
+                m_Active[slot] = last;
+                m_ActiveBoxes[slot] = m_ActiveBoxes.back();
+                m_Proxies[last].activeSlot = slot;
+                m_Active.pop_back();
+                m_ActiveBoxes.pop_back();
+                proxy.activeSlot = -1;
+            }
+
+            continue;
+        }
+
+        const AABB& box = proxy.box;
+        const RigidBody* body = proxy.body;
+
+        // AABBは並べて持っておき、プロキシを引かずに比べる
+        // レイヤーとマスクで外れる組はナローフェーズに渡さない
+        for (size_t slot = 0; slot < m_Active.size(); slot++)
+        {
+            int other = m_Active[slot];
+
+            if (box.Overlaps(m_ActiveBoxes[slot]) && body->CanCollideWith(m_Proxies[other].body))
+            {
+                m_PairIds.push_back({ std::min(ep.proxyId, other), std::max(ep.proxyId, other) });
+            }
+        }
+
+        proxy.activeSlot = (int)m_Active.size();
+        m_Active.push_back(ep.proxyId);
+        m_ActiveBoxes.push_back(box);
+    }
+
+    // 登録順に並べて毎フレーム同じ順番で解決する
+    std::sort(m_PairIds.begin(), m_PairIds.end());
+
+    outPairs.clear();
+    outPairs.reserve(m_PairIds.size());
+
+    for (const auto& ids : m_PairIds)
+    {
+        outPairs.push_back({ m_Proxies[ids.first].body, m_Proxies[ids.second].body });
+    }
+}
+//=============================================================================
+// AABBの問い合わせ処理（動的剛体は少ないので全プロキシを調べる）
+//=============================================================================
+void SweepAndPrune::QueryAABB(const AABB& box, std::vector<RigidBody*>& out) const
+{
+    for (const Proxy& proxy : m_Proxies)
+    {
+        if (proxy.body && proxy.box.Overlaps(box))
+        {
+            out.push_back(proxy.body);
+        }
+    }
+}
+//=============================================================================
+// レイの問い合わせ処理（当たるプロキシを集めて近い順に渡す）
+//=============================================================================
+void SweepAndPrune::QueryRay(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, const D3DXVECTOR3& extent, const RayQueryFunc& func) const
+{
+    D3DXVECTOR3 invDir = AABB::InverseDirection(dir);
+    std::vector<std::pair<float, RigidBody*>> hits;
+
+    for (const Proxy& proxy : m_Proxies)
+    {
+        float enter = 0.0f;
+
+        if (proxy.body && proxy.box.IntersectRay(origin, invDir, maxDist, extent, enter))
+        {
+            hits.push_back({ enter, proxy.body });
+        }
+    }
+
+    std::sort(hits.begin(), hits.end(),
+        [](const std::pair<float, RigidBody*>& lhs, const std::pair<float, RigidBody*>& rhs) { return lhs.first < rhs.first; });
+
+    for (const auto& hit : hits)
+    {
+        if (hit.first > maxDist)
+        {
+            break;
+        }
+
+        maxDist = std::min(maxDist, func(hit.second, maxDist));
+    }
+}
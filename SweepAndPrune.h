@@ -0,0 +1,69 @@
+//=============================================================================
+//
+// スイープ＆プルーン処理 [SweepAndPrune.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _SWEEPANDPRUNE_H_// このマクロ定義がされていなかったら
+#define _SWEEPANDPRUNE_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "Broadphase.h"
+
+//=============================================================================
+// スイープ＆プルーン（ブロードフェーズ）クラス
+//=============================================================================
+class SweepAndPrune : public Broadphase
+{
+public:
+    SweepAndPrune() : Broadphase(SWEEP_AND_PRUNE), m_NumAdded(0) {}
+
+    int CreateProxy(RigidBody* body) override;
+    void DestroyProxy(int proxyId) override;
+    void MoveProxy(int proxyId, const D3DXVECTOR3& motion) override;
+
+    // AABBを更新して重なっているペアを収集
+    void UpdatePairs(std::vector<BroadphasePair>& outPairs) override;
+
+    // 問い合わせ
+    void QueryAABB(const AABB& box, std::vector<RigidBody*>& out) const override;
+    void QueryRay(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, const D3DXVECTOR3& extent, const RayQueryFunc& func) const override;
+
+    int GetProxyCount(void) const override { return (int)(m_Proxies.size() - m_FreeList.size() - m_PendingFree.size()); }
+
+private:
+    // プロキシ（剛体ごとのAABB）
+    struct Proxy
+    {
+        RigidBody*  body;       // 対象の剛体
+        AABB        box;        // ワールドAABB
+        int         activeSlot; // スイープ中のリストでの位置（入っていなければ-1）
+    };
+
+    // X軸上の端点
+    struct EndPoint
+    {
+        float   value;      // 座標
+        int     proxyId;    // プロキシ番号
+        bool    isMin;      // 最小側かどうか
+    };
+
+    void RefreshEndPoints(void);
+    void SortEndPoints(void);
+
+    static constexpr float  AABB_MARGIN         = 2.0f; // 反復中の押し戻し分の余裕
+    static constexpr int    FULL_SORT_DIVISOR   = 8;    // 追加数がこの割合を超えたら全ソート
+
+    std::vector<Proxy>                  m_Proxies;      // プロキシ
+    std::vector<int>                    m_FreeList;     // 空きプロキシ番号
+    std::vector<int>                    m_PendingFree;  // 端点の削除待ちプロキシ番号
+    std::vector<EndPoint>               m_EndPoints;    // 端点リスト（X軸ソート済み）
+    std::vector<int>                    m_Active;       // スイープ中のプロキシ
+    std::vector<AABB>                   m_ActiveBoxes;  // スイープ中のプロキシのAABB（m_Activeと同じ並び）
+    std::vector<std::pair<int, int>>    m_PairIds;      // ペアのプロキシ番号
+    size_t                              m_NumAdded;     // 前回の更新から追加された端点数
+};
+
+#endif
@@ -0,0 +1,121 @@
+//=============================================================================
+//
+// スレッドプール処理 [ThreadPool.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "ThreadPool.h"
+
+//=============================================================================
+// コンストラクタ
+//=============================================================================
+ThreadPool::ThreadPool(int numThreads)
+    : m_pJob(nullptr), m_JobCount(0), m_NextIndex(0), m_NumBusy(0), m_Generation(0), m_isQuit(false)
+{
+    // 呼び出したスレッドの分を引いてワーカーを作る
+    for (int nCnt = 1; nCnt < numThreads; nCnt++)
+    {
+        m_Workers.emplace_back(&ThreadPool::WorkerMain, this, nCnt);
+    }
+}
+//=============================================================================
+// デストラクタ
+//=============================================================================
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_isQuit = true;
+    }
+
+    m_StartCond.notify_all();
+
+    for (auto& worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+//=============================================================================
+// 並列実行処理
+//=============================================================================
+void ThreadPool::ParallelFor(int count, const std::function<void(int, int)>& func)
+{
+    // ワーカーがいない・1件だけならそのまま回す
+    if (m_Workers.empty() || count <= 1)
+    {
+        for (int nCnt = 0; nCnt < count; nCnt++)
+        {
+            func(nCnt, 0);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_pJob = &func;
+        m_JobCount = count;
+        m_NextIndex = 0;
+        m_NumBusy = (int)m_Workers.size();
+        m_Generation++;
+    }
+
+    m_StartCond.notify_all();
+
+    // 呼び出したスレッドも番号を取って働く
+    RunJob(0);
+
+    // ワーカーが全員手を離すまで待つ（funcの寿命はここまで）
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_DoneCond.wait(lock, [this] { return m_NumBusy == 0; });
+    m_pJob = nullptr;
+}
+//=============================================================================
+// 番号を取りながら仕事を進める処理
+//=============================================================================
+void ThreadPool::RunJob(int threadIndex)
+{
+    int index = 0;
+
+    while ((index = m_NextIndex.fetch_add(1)) < m_JobCount)
+    {
+        (*m_pJob)(index, threadIndex);
+    }
+}
+//=============================================================================
+// ワーカースレッドの処理
+//=============================================================================
+void ThreadPool::WorkerMain(int threadIndex)
+{
+    unsigned int generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_StartCond.wait(lock, [&] { return m_isQuit || m_Generation != generation; });
+
+            if (m_isQuit)
+            {
+                return;
+            }
+
+            generation = m_Generation;
+        }
+
+        RunJob(threadIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            if (--m_NumBusy == 0)
+            {
+                m_DoneCond.notify_one();
+            }
+        }
+    }
+}
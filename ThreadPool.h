@@ -0,0 +1,50 @@
+//=============================================================================
+//
+// スレッドプール処理 [ThreadPool.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _THREADPOOL_H_// このマクロ定義がされていなかったら
+#define _THREADPOOL_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "thread"
+#include "mutex"
+#include "condition_variable"
+#include "atomic"
+
+//=============================================================================
+// スレッドプールクラス（呼び出したスレッドも一緒に働いて番号の範囲を分け合う）
+//=============================================================================
+class ThreadPool
+{
+public:
+    // numThreadsは呼び出したスレッドも含めた数
+    ThreadPool(int numThreads);
+    ~ThreadPool();
+
+    // 0～count-1の番号でfuncを呼ぶ（全部終わるまで戻らない、どのスレッドが何番を処理するかは決まらない）
+    // funcの2つ目の引数は処理しているスレッドの番号（呼び出したスレッドが0、GetThreadCount未満）
+    void ParallelFor(int count, const std::function<void(int, int)>& func);
+
+    int GetThreadCount(void) const { return (int)m_Workers.size() + 1; }
+
+private:
+    void WorkerMain(int threadIndex);
+    void RunJob(int threadIndex);
+
+    std::vector<std::thread>             m_Workers;      // ワーカースレッド
+    std::mutex                           m_Mutex;        // 仕事の受け渡し用
+    std::condition_variable              m_StartCond;    // 仕事の開始通知
+    std::condition_variable              m_DoneCond;     // 仕事の終了通知
+    const std::function<void(int, int)>* m_pJob;         // 実行中の仕事
+    int                                  m_JobCount;     // 実行中の仕事の番号の数
+    std::atomic<int>                     m_NextIndex;    // 次に取る番号
+    int                                  m_NumBusy;      // まだ働いているワーカー数
+    unsigned int                         m_Generation;   // 仕事の世代（新しい仕事の判別用）
+    bool                                 m_isQuit;       // 終了要求
+};
+
+#endif
@@ -0,0 +1,1259 @@
+//=============================================================================
+//
+// 三角形の形状処理 [TriangleShape.cpp]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "TriangleShape.h"
+#include "algorithm"
+
+//*****************************************************************************
+// 定数宣言
+//*****************************************************************************
+namespace
+{
+    constexpr float DEGENERATE_AREA = 1e-12f;   // これより小さい面積（外積の長さの2乗）の三角形は捨てる
+    constexpr float SAMPLE_MARGIN   = 1.0f;     // メッシュから高さを取るときにレイを上に離す距離
+    constexpr float EDGE_INSET      = 0.01f;    // 端の格子点をマスの幅のこの割合だけ内側で取る（三角形の縁を外さないように）
+}
+
+//=============================================================================
+// バイト列への書き出し処理
+//=============================================================================
+void TriangleShape::Write(std::vector<unsigned char>& outData) const
+{
+    SnapshotWriter writer(outData);
+
+    writer.Write((int)m_Kind);
+    writer.Write(m_Bounds);
+
+    WriteBody(writer);
+}
+//=============================================================================
+// バイト列からの読み込み処理（壊れていればnullptr）
+//=============================================================================
+std::shared_ptr<TriangleShape> TriangleShape::Read(SnapshotReader& reader)
+{
+    int kind = 0;
+
+    if (!reader.Read(kind))
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<TriangleShape> shape;
+
+    switch (kind)
+    {
+    case MESH:
+        shape = std::make_shared<TriangleMeshShape>();
+        break;
+    case HEIGHTFIELD:
+        shape = std::make_shared<HeightfieldShape>();
+        break;
+    case HULL:
+        shape = std::make_shared<ConvexHullShape>();
+        break;
+    default:
+        return nullptr;
+    }
+
+    if (!reader.Read(shape->m_Bounds) || !shape->ReadBody(reader))
+    {
+        return nullptr;
+    }
+
+    return shape;
+}
+//=============================================================================
+// レイと三角形の交差判定処理（Moller-Trumbore、裏から当たるレイは通す）
+//=============================================================================
+bool TriangleShape::IntersectTriangle(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir,
+    const D3DXVECTOR3& a, const D3DXVECTOR3& b, const D3DXVECTOR3& c, float maxDist, float& outDist)
+{
+    D3DXVECTOR3 e1 = b - a;
+    D3DXVECTOR3 e2 = c - a;
+    D3DXVECTOR3 p;
+    D3DXVec3Cross(&p, &dir, &e2);
+
+    // det = -dir・法線なので、正のときだけ表から当たる
+    float det = D3DXVec3Dot(&e1, &p);
+
+    if (det <= 0.0f)
+    {
+        return false;
+    }
+
+    float invDet = 1.0f / det;
+    D3DXVECTOR3 s = origin - a;
+    float u = D3DXVec3Dot(&s, &p) * invDet;
+
+    if (u < 0.0f || u > 1.0f)
+    {
+        return false;
+    }
+
+    D3DXVECTOR3 q;
+    D3DXVec3Cross(&q, &s, &e1);
+    float v = D3DXVec3Dot(&dir, &q) * invDet;
+
+    if (v < 0.0f || u + v > 1.0f)
+    {
+        return false;
+    }
+
+    float t = D3DXVec3Dot(&e2, &q) * invDet;
+
+    if (t < 0.0f || t > maxDist)
+    {
+        return false;
+    }
+
+    outDist = t;
+    return true;
+}
+
+
+//=============================================================================
+// 三角形メッシュの組み立て処理
+//=============================================================================
+void TriangleMeshShape::Cook(const D3DXVECTOR3* vertices, int numVertices, const unsigned int* indices, int numTriangles)
+{
+    m_Vertices.assign(vertices, vertices + numVertices);
+    m_Indices.clear();
+    m_Nodes.clear();
+    m_Bounds = { INIT_VEC3, INIT_VEC3 };
+
+    std::vector<BuildItem> items;
+    std::vector<int> triangles;
+    items.reserve(numTriangles);
+    triangles.reserve((size_t)numTriangles * 3);
+
+    for (int nCnt = 0; nCnt < numTriangles; nCnt++)
+    {
+        unsigned int i0 = indices[nCnt * 3 + 0];
+        unsigned int i1 = indices[nCnt * 3 + 1];
+        unsigned int i2 = indices[nCnt * 3 + 2];
+
+        if (i0 >= (unsigned int)numVertices || i1 >= (unsigned int)numVertices || i2 >= (unsigned int)numVertices)
+        {
+            continue;
+        }
+
+        const D3DXVECTOR3& a = vertices[i0];
+        const D3DXVECTOR3& b = vertices[i1];
+        const D3DXVECTOR3& c = vertices[i2];
+
+        D3DXVECTOR3 e1 = b - a;
+        D3DXVECTOR3 e2 = c - a;
+        D3DXVECTOR3 normal;
+        D3DXVec3Cross(&normal, &e1, &e2);
+
+        // 向きの決まらない三角形は当たっても押し戻せないので捨てる
+        if (D3DXVec3LengthSq(&normal) <= DEGENERATE_AREA)
+        {
+            continue;
+        }
+
+        BuildItem item;
+        item.box = { a, a };
+        item.box.Merge({ b, b });
+        item.box.Merge({ c, c });
+        item.center = (a + b + c) / 3.0f;
+        item.triangle = (int)items.size();
+        items.push_back(item);
+
+        triangles.push_back((int)i0);
+        triangles.push_back((int)i1);
+        triangles.push_back((int)i2);
+    }
+
+    if (items.empty())
+    {
+        return;
+    }
+
+    m_Nodes.reserve(items.size() * 2);
+    BuildRecursive(items, 0, (int)items.size());
+
+    // 三角形を葉の並びにして、葉を調べるときに続けて読めるようにする
+    m_Indices.resize(items.size() * 3);
+
+    for (size_t nCnt = 0; nCnt < items.size(); nCnt++)
+    {
+        for (int nVtx = 0; nVtx < 3; nVtx++)
+        {
+            m_Indices[nCnt * 3 + nVtx] = triangles[items[nCnt].triangle * 3 + nVtx];
+        }
+    }
+
+    m_Bounds = m_Nodes[0].box;
+}
+//=============================================================================
+// 再帰構築処理（一番長い軸の中央値で分ける）
+//=============================================================================
+int TriangleMeshShape::BuildRecursive(std::vector<BuildItem>& items, int start, int end)
+{
+    int nodeId = (int)m_Nodes.size();
+    m_Nodes.push_back({});
+
+    AABB box = items[start].box;
+    AABB centerBox = { items[start].center, items[start].center };
+
+    for (int nCnt = start + 1; nCnt < end; nCnt++)
+    {
+        box.Merge(items[nCnt].box);
+        centerBox.Merge({ items[nCnt].center, items[nCnt].center });
+    }
+
+    m_Nodes[nodeId].box = box;
+
+    if (end - start <= MAX_LEAF_TRIANGLES)
+    {
+        m_Nodes[nodeId].right = -1;
+        m_Nodes[nodeId].start = start;
+        m_Nodes[nodeId].count = end - start;
+        return nodeId;
+    }
+
+    D3DXVECTOR3 extent = centerBox.max - centerBox.min;
+    int axis = 0;
+
+    if (extent.y > extent.x && extent.y >= extent.z)
+    {
+        axis = 1;
+    }
+    else if (extent.z > extent.x && extent.z > extent.y)
+    {
+        axis = 2;
+    }
+
+    int mid = (start + end) / 2;
+
+    std::nth_element(items.begin() + start, items.begin() + mid, items.begin() + end,
+        [axis](const BuildItem& a, const BuildItem& b) { return a.center[axis] < b.center[axis]; });
+
+    BuildRecursive(items, start, mid);
+    int right = BuildRecursive(items, mid, end);
+
+    m_Nodes[nodeId].right = right;
+    m_Nodes[nodeId].start = 0;
+    m_Nodes[nodeId].count = 0;
+
+    return nodeId;
+}
+//=============================================================================
+// 範囲検索処理
+//=============================================================================
+void TriangleMeshShape::QueryTriangles(const AABB& box, std::vector<int>& out) const
+{
+    if (m_Nodes.empty())
+    {
+        return;
+    }
+
+    int stack[MAX_DEPTH];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const Node& node = m_Nodes[stack[--top]];
+
+        if (!node.box.Overlaps(box))
+        {
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            for (int nCnt = node.start; nCnt < node.start + node.count; nCnt++)
+            {
+                const D3DXVECTOR3& a = m_Vertices[m_Indices[nCnt * 3 + 0]];
+                const D3DXVECTOR3& b = m_Vertices[m_Indices[nCnt * 3 + 1]];
+                const D3DXVECTOR3& c = m_Vertices[m_Indices[nCnt * 3 + 2]];
+
+                AABB triBox = { a, a };
+                triBox.Merge({ b, b });
+                triBox.Merge({ c, c });
+
+                if (triBox.Overlaps(box))
+                {
+                    out.push_back(nCnt);
+                }
+            }
+
+            continue;
+        }
+
+        // 左の子を先に調べる
+        int left = (int)(&node - m_Nodes.data()) + 1;
+        stack[top++] = node.right;
+        stack[top++] = left;
+    }
+}
+//=============================================================================
+// 三角形の取得処理
+//=============================================================================
+void TriangleMeshShape::GetTriangle(int index, D3DXVECTOR3* outVertices, int* outVertexIds) const
+{
+    for (int nVtx = 0; nVtx < 3; nVtx++)
+    {
+        int id = m_Indices[index * 3 + nVtx];
+        outVertices[nVtx] = m_Vertices[id];
+
+        if (outVertexIds)
+        {
+            outVertexIds[nVtx] = id;
+        }
+    }
+}
+//=============================================================================
+// レイの判定処理（近いノードから調べ、当たった距離より先の枝は捨てる）
+//=============================================================================
+bool TriangleMeshShape::RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, int& outTriangle) const
+{
+    if (m_Nodes.empty())
+    {
+        return false;
+    }
+
+    D3DXVECTOR3 invDir = AABB::InverseDirection(dir);
+    float enter = 0.0f;
+
+    if (!m_Nodes[0].box.IntersectRay(origin, invDir, maxDist, INIT_VEC3, enter))
+    {
+        return false;
+    }
+
+    int stack[MAX_DEPTH];
+    float stackEnter[MAX_DEPTH];
+    int top = 0;
+
+    stack[top] = 0;
+    stackEnter[top++] = enter;
+
+    bool isHit = false;
+
+    while (top > 0)
+    {
+        top--;
+
+        if (stackEnter[top] > maxDist)
+        {
+            continue;
+        }
+
+        const Node& node = m_Nodes[stack[top]];
+
+        if (node.count > 0)
+        {
+            for (int nCnt = node.start; nCnt < node.start + node.count; nCnt++)
+            {
+                float dist = 0.0f;
+
+                if (IntersectTriangle(origin, dir,
+                    m_Vertices[m_Indices[nCnt * 3 + 0]], m_Vertices[m_Indices[nCnt * 3 + 1]], m_Vertices[m_Indices[nCnt * 3 + 2]],
+                    maxDist, dist))
+                {
+                    maxDist = dist;
+                    outDist = dist;
+                    outTriangle = nCnt;
+                    isHit = true;
+                }
+            }
+
+            continue;
+        }
+
+        int left = (int)(&node - m_Nodes.data()) + 1;
+        int right = node.right;
+
+        float enterLeft = 0.0f;
+        float enterRight = 0.0f;
+        bool isHitLeft = m_Nodes[left].box.IntersectRay(origin, invDir, maxDist, INIT_VEC3, enterLeft);
+        bool isHitRight = m_Nodes[right].box.IntersectRay(origin, invDir, maxDist, INIT_VEC3, enterRight);
+
+        // 遠い方を先に積んで近い方から調べる
+        if (isHitLeft && isHitRight && enterLeft > enterRight)
+        {
+            std::swap(left, right);
+            std::swap(enterLeft, enterRight);
+        }
+
+        if (isHitRight)
+        {
+            stack[top] = right;
+            stackEnter[top++] = enterRight;
+        }
+
+        if (isHitLeft)
+        {
+            stack[top] = left;
+            stackEnter[top++] = enterLeft;
+        }
+    }
+
+    return isHit;
+}
+//=============================================================================
+// 三角形メッシュの書き出し処理
+//=============================================================================
+void TriangleMeshShape::WriteBody(SnapshotWriter& writer) const
+{
+    writer.Write((int)m_Vertices.size());
+    writer.Write((int)m_Indices.size());
+    writer.Write((int)m_Nodes.size());
+    writer.WriteArray(m_Vertices.data(), m_Vertices.size());
+    writer.WriteArray(m_Indices.data(), m_Indices.size());
+    writer.WriteArray(m_Nodes.data(), m_Nodes.size());
+}
+//=============================================================================
+// 三角形メッシュの読み込み処理
+//=============================================================================
+bool TriangleMeshShape::ReadBody(SnapshotReader& reader)
+{
+    int numVertices = 0, numIndices = 0, numNodes = 0;
+
+    if (!reader.Read(numVertices) || !reader.Read(numIndices) || !reader.Read(numNodes))
+    {
+        return false;
+    }
+
+    // 数が壊れていても大きな領域を取らないように、残りの大きさと先に比べる
+    size_t bytes = (size_t)numVertices * sizeof(D3DXVECTOR3) + (size_t)numIndices * sizeof(int) + (size_t)numNodes * sizeof(Node);
+
+    if (numVertices < 0 || numIndices < 0 || numNodes < 0 || numIndices % 3 != 0 || bytes > reader.GetRemaining())
+    {
+        return false;
+    }
+
+    m_Vertices.resize(numVertices);
+    m_Indices.resize(numIndices);
+    m_Nodes.resize(numNodes);
+
+    if (!reader.ReadArray(m_Vertices.data(), m_Vertices.size()) ||
+        !reader.ReadArray(m_Indices.data(), m_Indices.size()) ||
+        !reader.ReadArray(m_Nodes.data(), m_Nodes.size()))
+    {
+        return false;
+    }
+
+    // 番号が頂点の外を指していれば使わない
+    for (int index : m_Indices)
+    {
+        if (index < 0 || index >= numVertices)
+        {
+            return false;
+        }
+    }
+
+    // ノードが三角形・ノードの外を指していれば使わない（呼び出し側で組み立て直す）
+    // 子は親より後ろにしか置かないので、前から順に見れば循環も探索スタックに収まらない深さも弾ける
+    const int numTriangles = numIndices / 3;
+    std::vector<int> depth(numNodes, 0);
+
+    for (int nCnt = 0; nCnt < numNodes; nCnt++)
+    {
+        const Node& node = m_Nodes[nCnt];
+
+        if (node.count > 0)
+        {
+            if (node.start < 0 || node.start > numTriangles - node.count)
+            {
+                return false;
+            }
+
+            continue;
+        }
+
+        int left = nCnt + 1;
+
+        if (node.count < 0 || left >= numNodes || node.right <= left || node.right >= numNodes || depth[nCnt] + 1 >= MAX_DEPTH)
+        {
+            return false;
+        }
+
+        depth[left] = std::max(depth[left], depth[nCnt] + 1);
+        depth[node.right] = std::max(depth[node.right], depth[nCnt] + 1);
+    }
+
+    return true;
+}
+
+
+//=============================================================================
+// 高さの格子の設定処理
+//=============================================================================
+void HeightfieldShape::Cook(const D3DXVECTOR3& origin, float cellX, float cellZ, int numX, int numZ, const float* heights)
+{
+    m_Origin = origin;
+    m_CellX = cellX;
+    m_CellZ = cellZ;
+    m_NumX = numX;
+    m_NumZ = numZ;
+    m_Heights.assign(heights, heights + (size_t)numX * numZ);
+
+    UpdateBounds();
+}
+//=============================================================================
+// メッシュから高さの格子を作る処理（格子点ごとに真上から下向きのレイを当てて一番上の表の面を取る）
+//=============================================================================
+void HeightfieldShape::CookFromMesh(const TriangleShape& mesh, int resolution)
+{
+    const AABB& bounds = mesh.GetBounds();
+    float sizeX = bounds.max.x - bounds.min.x;
+    float sizeZ = bounds.max.z - bounds.min.z;
+    float cell = std::max(sizeX, sizeZ) / (float)std::max(resolution, 1);
+
+    if (cell <= 0.0f)
+    {
+        Cook(bounds.min, 0.0f, 0.0f, 0, 0, nullptr);
+        return;
+    }
+
+    int numX = std::max((int)ceilf(sizeX / cell), 1) + 1;
+    int numZ = std::max((int)ceilf(sizeZ / cell), 1) + 1;
+    float cellX = (sizeX > 0.0f) ? sizeX / (float)(numX - 1) : cell;
+    float cellZ = (sizeZ > 0.0f) ? sizeZ / (float)(numZ - 1) : cell;
+
+    float top = bounds.max.y + SAMPLE_MARGIN;
+    float height = bounds.max.y - bounds.min.y + SAMPLE_MARGIN * 2.0f;
+    D3DXVECTOR3 down(0.0f, -height, 0.0f);
+
+    std::vector<float> heights((size_t)numX * numZ, HOLE);
+
+    for (int nZ = 0; nZ < numZ; nZ++)
+    {
+        for (int nX = 0; nX < numX; nX++)
+        {
+            float x = std::clamp(bounds.min.x + cellX * nX, bounds.min.x + cellX * EDGE_INSET, bounds.max.x - cellX * EDGE_INSET);
+            float z = std::clamp(bounds.min.z + cellZ * nZ, bounds.min.z + cellZ * EDGE_INSET, bounds.max.z - cellZ * EDGE_INSET);
+
+            float dist = 0.0f;
+            int triangle = 0;
+
+            if (mesh.RayCast(D3DXVECTOR3(x, top, z), down, 1.0f, dist, triangle))
+            {
+                heights[(size_t)nZ * numX + nX] = top + down.y * dist;
+            }
+        }
+    }
+
+    Cook(bounds.min, cellX, cellZ, numX, numZ, heights.data());
+}
+//=============================================================================
+// 全体を囲むAABBの更新処理（穴は含めない）
+//=============================================================================
+void HeightfieldShape::UpdateBounds(void)
+{
+    float minY = FLT_MAX;
+    float maxY = -FLT_MAX;
+
+    for (float h : m_Heights)
+    {
+        if (h != HOLE)
+        {
+            minY = std::min(minY, h);
+            maxY = std::max(maxY, h);
+        }
+    }
+
+    if (minY > maxY)
+    {
+        minY = maxY = 0.0f;
+    }
+
+    m_Bounds.min = D3DXVECTOR3(m_Origin.x, minY, m_Origin.z);
+    m_Bounds.max = D3DXVECTOR3(
+        m_Origin.x + m_CellX * std::max(m_NumX - 1, 0),
+        maxY,
+        m_Origin.z + m_CellZ * std::max(m_NumZ - 1, 0));
+}
+//=============================================================================
+// 穴のあるマスかどうかの判定処理
+//=============================================================================
+bool HeightfieldShape::IsHoleCell(int cellX, int cellZ) const
+{
+    const float* row0 = &m_Heights[(size_t)cellZ * m_NumX + cellX];
+    const float* row1 = row0 + m_NumX;
+
+    return row0[0] == HOLE || row0[1] == HOLE || row1[0] == HOLE || row1[1] == HOLE;
+}
+//=============================================================================
+// 範囲検索処理（XZで重なるマスのうち高さの範囲も重なるマスの2枚を返す）
+//=============================================================================
+void HeightfieldShape::QueryTriangles(const AABB& box, std::vector<int>& out) const
+{
+    if (m_NumX < 2 || m_NumZ < 2 || !m_Bounds.Overlaps(box))
+    {
+        return;
+    }
+
+    int cellsX = m_NumX - 1;
+    int cellsZ = m_NumZ - 1;
+
+    int x0 = std::clamp((int)floorf((box.min.x - m_Origin.x) / m_CellX), 0, cellsX - 1);
+    int x1 = std::clamp((int)floorf((box.max.x - m_Origin.x) / m_CellX), 0, cellsX - 1);
+    int z0 = std::clamp((int)floorf((box.min.z - m_Origin.z) / m_CellZ), 0, cellsZ - 1);
+    int z1 = std::clamp((int)floorf((box.max.z - m_Origin.z) / m_CellZ), 0, cellsZ - 1);
+
+    for (int nZ = z0; nZ <= z1; nZ++)
+    {
+        for (int nX = x0; nX <= x1; nX++)
+        {
+            if (IsHoleCell(nX, nZ))
+            {
+                continue;
+            }
+
+            const float* row0 = &m_Heights[(size_t)nZ * m_NumX + nX];
+            const float* row1 = row0 + m_NumX;
+
+            float minY = std::min({ row0[0], row0[1], row1[0], row1[1] });
+            float maxY = std::max({ row0[0], row0[1], row1[0], row1[1] });
+
+            if (maxY < box.min.y || minY > box.max.y)
+            {
+                continue;
+            }
+
+            int cell = nZ * cellsX + nX;
+            out.push_back(cell * 2);
+            out.push_back(cell * 2 + 1);
+        }
+    }
+}
+//=============================================================================
+// 三角形の取得処理（マスの2枚は(0,0)-(0,1)-(1,1)と(0,0)-(1,1)-(1,0)、どちらも上が表）
+//=============================================================================
+void HeightfieldShape::GetTriangle(int index, D3DXVECTOR3* outVertices, int* outVertexIds) const
+{
+    int cellsX = m_NumX - 1;
+    int cell = index / 2;
+    int cellX = cell % cellsX;
+    int cellZ = cell / cellsX;
+
+    static const int CORNERS[2][3][2] =
+    {
+        { { 0, 0 }, { 0, 1 }, { 1, 1 } },
+        { { 0, 0 }, { 1, 1 }, { 1, 0 } },
+    };
+
+    for (int nVtx = 0; nVtx < 3; nVtx++)
+    {
+        int x = cellX + CORNERS[index & 1][nVtx][0];
+        int z = cellZ + CORNERS[index & 1][nVtx][1];
+        int id = z * m_NumX + x;
+
+        outVertices[nVtx] = D3DXVECTOR3(m_Origin.x + m_CellX * x, m_Heights[id], m_Origin.z + m_CellZ * z);
+
+        if (outVertexIds)
+        {
+            outVertexIds[nVtx] = id;
+        }
+    }
+}
+//=============================================================================
+// 1マスの2枚とレイの判定処理
+//=============================================================================
+bool HeightfieldShape::RayCastCell(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, int cellX, int cellZ, float maxDist, float& outDist, int& outTriangle) const
+{
+    if (IsHoleCell(cellX, cellZ))
+    {
+        return false;
+    }
+
+    int cell = cellZ * (m_NumX - 1) + cellX;
+    bool isHit = false;
+
+    for (int nTri = 0; nTri < 2; nTri++)
+    {
+        D3DXVECTOR3 v[3];
+        GetTriangle(cell * 2 + nTri, v, nullptr);
+
+        float dist = 0.0f;
+
+        if (IntersectTriangle(origin, dir, v[0], v[1], v[2], maxDist, dist))
+        {
+            maxDist = dist;
+            outDist = dist;
+            outTriangle = cell * 2 + nTri;
+            isHit = true;
+        }
+    }
+
+    return isHit;
+}
+//=============================================================================
+// レイの判定処理（XZのマスをレイの通る順に辿り、最初に当たったマスで止める）
+//=============================================================================
+bool HeightfieldShape::RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, int& outTriangle) const
+{
+    if (m_NumX < 2 || m_NumZ < 2)
+    {
+        return false;
+    }
+
+    D3DXVECTOR3 invDir = AABB::InverseDirection(dir);
+    float enter = 0.0f;
+
+    if (!m_Bounds.IntersectRay(origin, invDir, maxDist, INIT_VEC3, enter))
+    {
+        return false;
+    }
+
+    int cellsX = m_NumX - 1;
+    int cellsZ = m_NumZ - 1;
+
+    // 入った点のマスから始める
+    D3DXVECTOR3 start = origin + dir * enter;
+    int cellX = std::clamp((int)floorf((start.x - m_Origin.x) / m_CellX), 0, cellsX - 1);
+    int cellZ = std::clamp((int)floorf((start.z - m_Origin.z) / m_CellZ), 0, cellsZ - 1);
+
+    // 次のマスの境界までの距離と1マス進む距離（XZに動かなければ1マスだけ調べる）
+    const float LARGE = FLT_MAX;
+    int stepX = (dir.x > 0.0f) ? 1 : (dir.x < 0.0f ? -1 : 0);
+    int stepZ = (dir.z > 0.0f) ? 1 : (dir.z < 0.0f ? -1 : 0);
+
+    float nextX = (stepX != 0) ? (m_Origin.x + m_CellX * (cellX + (stepX > 0 ? 1 : 0)) - origin.x) * invDir.x : LARGE;
+    float nextZ = (stepZ != 0) ? (m_Origin.z + m_CellZ * (cellZ + (stepZ > 0 ? 1 : 0)) - origin.z) * invDir.z : LARGE;
+    float deltaX = (stepX != 0) ? m_CellX * fabsf(invDir.x) : LARGE;
+    float deltaZ = (stepZ != 0) ? m_CellZ * fabsf(invDir.z) : LARGE;
+
+    for (int nStep = 0; nStep < m_NumX + m_NumZ; nStep++)
+    {
+        // マスの中の三角形はマスのXZの中にしかないので、最初に当たったマスが一番近い
+        if (RayCastCell(origin, dir, cellX, cellZ, maxDist, outDist, outTriangle))
+        {
+            return true;
+        }
+
+        if (std::min(nextX, nextZ) > maxDist)
+        {
+            break;
+        }
+
+        if (nextX < nextZ)
+        {
+            cellX += stepX;
+            nextX += deltaX;
+        }
+        else
+        {
+            cellZ += stepZ;
+            nextZ += deltaZ;
+        }
+
+        if (cellX < 0 || cellX >= cellsX || cellZ < 0 || cellZ >= cellsZ)
+        {
+            break;
+        }
+    }
+
+    return false;
+}
+//=============================================================================
+// 高さの格子の書き出し処理
+//=============================================================================
+void HeightfieldShape::WriteBody(SnapshotWriter& writer) const
+{
+    writer.Write(m_Origin);
+    writer.Write(m_CellX);
+    writer.Write(m_CellZ);
+    writer.Write(m_NumX);
+    writer.Write(m_NumZ);
+    writer.WriteArray(m_Heights.data(), m_Heights.size());
+}
+//=============================================================================
+// 高さの格子の読み込み処理
+//=============================================================================
+bool HeightfieldShape::ReadBody(SnapshotReader& reader)
+{
+    if (!reader.Read(m_Origin) || !reader.Read(m_CellX) || !reader.Read(m_CellZ) ||
+        !reader.Read(m_NumX) || !reader.Read(m_NumZ))
+    {
+        return false;
+    }
+
+    if (m_NumX < 0 || m_NumZ < 0 || (size_t)m_NumX * m_NumZ * sizeof(float) > reader.GetRemaining())
+    {
+        return false;
+    }
+
+    m_Heights.resize((size_t)m_NumX * m_NumZ);
+
+    return reader.ReadArray(m_Heights.data(), m_Heights.size());
+}
+
+
+//=============================================================================
+// 凸包の組み立て処理（四面体から始めて、外にある点を1つずつ足していく）
+//=============================================================================
+bool ConvexHullShape::Cook(const D3DXVECTOR3* points, int numPoints)
+{
+    Clear();
+
+    if (points == nullptr || numPoints < 4)
+    {
+        return false;
+    }
+
+    // 同じ平面とみなす距離は全体の大きさに合わせる
+    AABB bounds = { points[0], points[0] };
+
+    for (int nCnt = 1; nCnt < numPoints; nCnt++)
+    {
+        bounds.Merge({ points[nCnt], points[nCnt] });
+    }
+
+    D3DXVECTOR3 extent = bounds.max - bounds.min;
+    float epsilon = HULL_EPSILON * std::max({ extent.x, extent.y, extent.z });
+
+    if (epsilon <= 0.0f)
+    {
+        return false;
+    }
+
+    // 最初の四面体（Xが一番小さい点 → そこから一番遠い点 → 直線から一番遠い点 → 平面から一番遠い点）
+    int first[4] = { 0, 0, 0, 0 };
+
+    for (int nCnt = 1; nCnt < numPoints; nCnt++)
+    {
+        if (points[nCnt].x < points[first[0]].x)
+        {
+            first[0] = nCnt;
+        }
+    }
+
+    const D3DXVECTOR3& p0 = points[first[0]];
+    float best = 0.0f;
+
+    for (int nCnt = 0; nCnt < numPoints; nCnt++)
+    {
+        D3DXVECTOR3 d = points[nCnt] - p0;
+        float distSq = D3DXVec3LengthSq(&d);
+
+        if (distSq > best)
+        {
+            best = distSq;
+            first[1] = nCnt;
+        }
+    }
+
+    D3DXVECTOR3 line = points[first[1]] - p0;
+    best = 0.0f;
+
+    for (int nCnt = 0; nCnt < numPoints; nCnt++)
+    {
+        D3DXVECTOR3 d = points[nCnt] - p0;
+        D3DXVECTOR3 c;
+        D3DXVec3Cross(&c, &line, &d);
+        float distSq = D3DXVec3LengthSq(&c);
+
+        if (distSq > best)
+        {
+            best = distSq;
+            first[2] = nCnt;
+        }
+    }
+
+    D3DXVECTOR3 e1 = points[first[1]] - p0;
+    D3DXVECTOR3 e2 = points[first[2]] - p0;
+    D3DXVECTOR3 planeNormal;
+    D3DXVec3Cross(&planeNormal, &e1, &e2);
+
+    if (D3DXVec3LengthSq(&planeNormal) <= DEGENERATE_AREA)
+    {
+        return false;
+    }
+
+    D3DXVec3Normalize(&planeNormal, &planeNormal);
+    best = 0.0f;
+
+    for (int nCnt = 0; nCnt < numPoints; nCnt++)
+    {
+        D3DXVECTOR3 d = points[nCnt] - p0;
+        float dist = fabsf(D3DXVec3Dot(&planeNormal, &d));
+
+        if (dist > best)
+        {
+            best = dist;
+            first[3] = nCnt;
+        }
+    }
+
+    // 平らな点の集まりは厚みが無いので包めない
+    if (best <= epsilon)
+    {
+        return false;
+    }
+
+    // 四面体の重心は最後まで凸包の中にあるので、面の表裏はこれで決める
+    D3DXVECTOR3 inner = (points[first[0]] + points[first[1]] + points[first[2]] + points[first[3]]) * 0.25f;
+    std::vector<BuildFace> faces;
+    int numAlive = 0;
+
+    auto addFace = [&](int a, int b, int c)
+    {
+        BuildFace face = { { a, b, c }, INIT_VEC3, 0.0f, true };
+        D3DXVECTOR3 ab = points[b] - points[a];
+        D3DXVECTOR3 ac = points[c] - points[a];
+        D3DXVec3Cross(&face.normal, &ab, &ac);
+
+        if (D3DXVec3LengthSq(&face.normal) > DEGENERATE_AREA)
+        {
+            D3DXVec3Normalize(&face.normal, &face.normal);
+
+            D3DXVECTOR3 toInner = inner - points[a];
+
+            if (D3DXVec3Dot(&face.normal, &toInner) > 0.0f)
+            {
+                std::swap(face.v[1], face.v[2]);
+                face.normal = -face.normal;
+            }
+
+            face.dist = D3DXVec3Dot(&face.normal, &points[a]);
+        }
+
+        faces.push_back(face);
+        numAlive++;
+    };
+
+    addFace(first[0], first[1], first[2]);
+    addFace(first[0], first[1], first[3]);
+    addFace(first[0], first[2], first[3]);
+    addFace(first[1], first[2], first[3]);
+
+    std::vector<int> visible;
+    std::vector<std::pair<int, int>> horizon;
+
+    for (int nCnt = 0; nCnt < numPoints; nCnt++)
+    {
+        if (nCnt == first[0] || nCnt == first[1] || nCnt == first[2] || nCnt == first[3])
+        {
+            continue;
+        }
+
+        const D3DXVECTOR3& point = points[nCnt];
+
+        // 点から見える面（点が表側に離れている面）
+        visible.clear();
+
+        for (int nFace = 0; nFace < (int)faces.size(); nFace++)
+        {
+            if (faces[nFace].isAlive && D3DXVec3Dot(&faces[nFace].normal, &point) - faces[nFace].dist > epsilon)
+            {
+                visible.push_back(nFace);
+            }
+        }
+
+        if (visible.empty())
+        {
+            continue;
+        }
+
+        // 見える面の辺のうち、逆向きの辺が見える面に無いものが境目になる
+        horizon.clear();
+
+        for (int nFace : visible)
+        {
+            for (int nEdge = 0; nEdge < 3; nEdge++)
+            {
+                int a = faces[nFace].v[nEdge];
+                int b = faces[nFace].v[(nEdge + 1) % 3];
+                bool isShared = false;
+
+                for (int nOther : visible)
+                {
+                    const int* v = faces[nOther].v;
+
+                    if ((v[0] == b && v[1] == a) || (v[1] == b && v[2] == a) || (v[2] == b && v[0] == a))
+                    {
+                        isShared = true;
+                        break;
+                    }
+                }
+
+                if (!isShared)
+                {
+                    horizon.push_back({ a, b });
+                }
+            }
+        }
+
+        for (int nFace : visible)
+        {
+            faces[nFace].isAlive = false;
+            numAlive--;
+        }
+
+        // 境目の辺と点で面を張り直す
+        for (const auto& edge : horizon)
+        {
+            addFace(edge.first, edge.second, nCnt);
+        }
+
+        // 消えた面が残っている面より多くなったら詰める
+        if ((int)faces.size() > numAlive * 2)
+        {
+            faces.erase(std::remove_if(faces.begin(), faces.end(), [](const BuildFace& face) { return !face.isAlive; }), faces.end());
+        }
+    }
+
+    // 残った面が使う頂点だけを並べ直す
+    std::vector<int> remap(numPoints, -1);
+
+    for (const BuildFace& face : faces)
+    {
+        if (!face.isAlive)
+        {
+            continue;
+        }
+
+        for (int nVtx = 0; nVtx < 3; nVtx++)
+        {
+            int index = face.v[nVtx];
+
+            if (remap[index] < 0)
+            {
+                remap[index] = (int)m_Vertices.size();
+                m_Vertices.push_back(points[index]);
+            }
+
+            m_Indices.push_back(remap[index]);
+        }
+    }
+
+    m_Bounds = { m_Vertices[0], m_Vertices[0] };
+
+    for (const D3DXVECTOR3& vertex : m_Vertices)
+    {
+        m_Bounds.Merge({ vertex, vertex });
+    }
+
+    UpdateVolume();
+
+    return true;
+}
+//=============================================================================
+// メッシュから凸包を作る処理（となりの三角形と共有している頂点は1度だけ使う）
+//=============================================================================
+bool ConvexHullShape::CookFromMesh(const TriangleShape& mesh)
+{
+    std::vector<std::pair<int, D3DXVECTOR3>> corners;
+    corners.reserve((size_t)mesh.GetTriangleCount() * 3);
+
+    for (int nTri = 0; nTri < mesh.GetTriangleCount(); nTri++)
+    {
+        D3DXVECTOR3 vertices[3];
+        int ids[3];
+        mesh.GetTriangle(nTri, vertices, ids);
+
+        for (int nVtx = 0; nVtx < 3; nVtx++)
+        {
+            corners.push_back({ ids[nVtx], vertices[nVtx] });
+        }
+    }
+
+    std::sort(corners.begin(), corners.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    corners.erase(std::unique(corners.begin(), corners.end(), [](const auto& a, const auto& b) { return a.first == b.first; }), corners.end());
+
+    std::vector<D3DXVECTOR3> points;
+    points.reserve(corners.size());
+
+    for (const auto& corner : corners)
+    {
+        points.push_back(corner.second);
+    }
+
+    return Cook(points.data(), (int)points.size());
+}
+//=============================================================================
+// 凸包を空にする処理
+//=============================================================================
+void ConvexHullShape::Clear(void)
+{
+    m_Vertices.clear();
+    m_Indices.clear();
+    m_Volume = 0.0f;
+    m_Bounds = { INIT_VEC3, INIT_VEC3 };
+}
+//=============================================================================
+// 凸包の体積の計算処理（原点と各面の四面体の符号付き体積の和）
+//=============================================================================
+void ConvexHullShape::UpdateVolume(void)
+{
+    float volume = 0.0f;
+
+    for (int nTri = 0; nTri < GetTriangleCount(); nTri++)
+    {
+        const D3DXVECTOR3& a = m_Vertices[m_Indices[nTri * 3]];
+        const D3DXVECTOR3& b = m_Vertices[m_Indices[nTri * 3 + 1]];
+        const D3DXVECTOR3& c = m_Vertices[m_Indices[nTri * 3 + 2]];
+
+        D3DXVECTOR3 bc;
+        D3DXVec3Cross(&bc, &b, &c);
+        volume += D3DXVec3Dot(&a, &bc);
+    }
+
+    m_Volume = volume / 6.0f;
+}
+//=============================================================================
+// 凸包の慣性モーメントの計算処理（原点と各面の四面体ごとに2次のモーメントを足す）
+//=============================================================================
+void ConvexHullShape::CalculateInertia(const D3DXVECTOR3& scale, float mass, D3DXVECTOR3& outInertia) const
+{
+    outInertia = INIT_VEC3;
+
+    float volume = 0.0f;
+    D3DXVECTOR3 moment = INIT_VEC3;  // x・y・zの2乗の体積分
+
+    for (int nTri = 0; nTri < GetTriangleCount(); nTri++)
+    {
+        D3DXVECTOR3 v[3];
+
+        for (int nVtx = 0; nVtx < 3; nVtx++)
+        {
+            const D3DXVECTOR3& local = m_Vertices[m_Indices[nTri * 3 + nVtx]];
+            v[nVtx] = D3DXVECTOR3(local.x * scale.x, local.y * scale.y, local.z * scale.z);
+        }
+
+        D3DXVECTOR3 bc;
+        D3DXVec3Cross(&bc, &v[1], &v[2]);
+        float det = D3DXVec3Dot(&v[0], &bc);
+
+        volume += det / 6.0f;
+
+        for (int nAxis = 0; nAxis < 3; nAxis++)
+        {
+            float a = v[0][nAxis], b = v[1][nAxis], c = v[2][nAxis];
+            moment[nAxis] += det / 60.0f * (a * a + b * b + c * c + a * b + a * c + b * c);
+        }
+    }
+
+    // 裏返った拡大率では体積もモーメントも同じだけ符号が変わるので、比で密度を出す
+    if (mass <= 0.0f || fabsf(volume) <= 0.0f)
+    {
+        return;
+    }
+
+    float density = mass / volume;
+    outInertia.x = density * (moment.y + moment.z);
+    outInertia.y = density * (moment.x + moment.z);
+    outInertia.z = density * (moment.x + moment.y);
+}
+//=============================================================================
+// 凸包の三角形の範囲検索処理（三角形は少ないので総当たり）
+//=============================================================================
+void ConvexHullShape::QueryTriangles(const AABB& box, std::vector<int>& out) const
+{
+    if (!m_Bounds.Overlaps(box))
+    {
+        return;
+    }
+
+    for (int nTri = 0; nTri < GetTriangleCount(); nTri++)
+    {
+        const D3DXVECTOR3& a = m_Vertices[m_Indices[nTri * 3]];
+        AABB triangleBox = { a, a };
+        triangleBox.Merge({ m_Vertices[m_Indices[nTri * 3 + 1]], m_Vertices[m_Indices[nTri * 3 + 1]] });
+        triangleBox.Merge({ m_Vertices[m_Indices[nTri * 3 + 2]], m_Vertices[m_Indices[nTri * 3 + 2]] });
+
+        if (triangleBox.Overlaps(box))
+        {
+            out.push_back(nTri);
+        }
+    }
+}
+//=============================================================================
+// 凸包の三角形の取得処理
+//=============================================================================
+void ConvexHullShape::GetTriangle(int index, D3DXVECTOR3* outVertices, int* outVertexIds) const
+{
+    for (int nVtx = 0; nVtx < 3; nVtx++)
+    {
+        int vertex = m_Indices[index * 3 + nVtx];
+        outVertices[nVtx] = m_Vertices[vertex];
+
+        if (outVertexIds != nullptr)
+        {
+            outVertexIds[nVtx] = vertex;
+        }
+    }
+}
+//=============================================================================
+// 凸包のレイの判定処理（表から当たる三角形は1枚だけなので一番近いものを返す）
+//=============================================================================
+bool ConvexHullShape::RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, int& outTriangle) const
+{
+    bool isHit = false;
+
+    for (int nTri = 0; nTri < GetTriangleCount(); nTri++)
+    {
+        float dist = 0.0f;
+
+        if (IntersectTriangle(origin, dir, m_Vertices[m_Indices[nTri * 3]], m_Vertices[m_Indices[nTri * 3 + 1]], m_Vertices[m_Indices[nTri * 3 + 2]], maxDist, dist))
+        {
+            maxDist = dist;
+            outDist = dist;
+            outTriangle = nTri;
+            isHit = true;
+        }
+    }
+
+    return isHit;
+}
+//=============================================================================
+// 凸包の書き出し処理
+//=============================================================================
+void ConvexHullShape::WriteBody(SnapshotWriter& writer) const
+{
+    writer.Write((int)m_Vertices.size());
+    writer.Write((int)m_Indices.size());
+    writer.Write(m_Volume);
+    writer.WriteArray(m_Vertices.data(), m_Vertices.size());
+    writer.WriteArray(m_Indices.data(), m_Indices.size());
+}
+//=============================================================================
+// 凸包の読み込み処理
+//=============================================================================
+bool ConvexHullShape::ReadBody(SnapshotReader& reader)
+{
+    int numVertices = 0, numIndices = 0;
+
+    if (!reader.Read(numVertices) || !reader.Read(numIndices) || !reader.Read(m_Volume))
+    {
+        return false;
+    }
+
+    size_t bytes = (size_t)numVertices * sizeof(D3DXVECTOR3) + (size_t)numIndices * sizeof(int);
+
+    if (numVertices < 4 || numIndices < 12 || numIndices % 3 != 0 || bytes > reader.GetRemaining())
+    {
+        return false;
+    }
+
+    m_Vertices.resize(numVertices);
+    m_Indices.resize(numIndices);
+
+    if (!reader.ReadArray(m_Vertices.data(), m_Vertices.size()) ||
+        !reader.ReadArray(m_Indices.data(), m_Indices.size()))
+    {
+        return false;
+    }
+
+    for (int index : m_Indices)
+    {
+        if (index < 0 || index >= numVertices)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,199 @@
+//=============================================================================
+//
+// 三角形の形状処理 [TriangleShape.h]
+// Author : RIKU TANEKAWA
+//
+//=============================================================================
+#ifndef _TRIANGLESHAPE_H_// このマクロ定義がされていなかったら
+#define _TRIANGLESHAPE_H_// 2重インクルード防止のマクロ定義
+
+//*****************************************************************************
+// インクルードファイル
+//*****************************************************************************
+#include "Collider.h"
+#include "Snapshot.h"
+
+//=============================================================================
+// 三角形の集まりの形状クラス（静的なメッシュ・地形の当たり判定用、ローカル空間で持つ）
+// 三角形の表はD3Dの表面と同じく、(b - a)×(c - a)の向き
+//=============================================================================
+class TriangleShape
+{
+public:
+    enum KIND
+    {
+        MESH,           // 三角形メッシュ（三角形のBVHで絞る）
+        HEIGHTFIELD,    // 高さの格子（マス目で絞る）
+        HULL,           // 凸包（動く剛体にも使える、GJK/EPAで判定する）
+        KIND_MAX
+    };
+
+    TriangleShape(KIND kind) : m_Kind(kind), m_Bounds({ INIT_VEC3, INIT_VEC3 }) {}
+    virtual ~TriangleShape() {}
+
+    KIND GetKind(void) const { return m_Kind; }
+    const AABB& GetBounds(void) const { return m_Bounds; }
+    virtual int GetTriangleCount(void) const = 0;
+
+    // boxと重なるかもしれない三角形の番号をoutに追加する
+    virtual void QueryTriangles(const AABB& box, std::vector<int>& out) const = 0;
+
+    // 三角形の3頂点と頂点の番号（となりの三角形と共有している頂点は同じ番号）
+    virtual void GetTriangle(int index, D3DXVECTOR3* outVertices, int* outVertexIds) const = 0;
+
+    // 表から当たるレイの一番近い三角形（dirは正規化しなくてよく、距離はdirの長さを1とした値）
+    virtual bool RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, int& outTriangle) const = 0;
+
+    // バイト列への書き出し・読み込み（同じ実行ファイルで読み戻すキャッシュ用、先頭に種類を入れる）
+    void Write(std::vector<unsigned char>& outData) const;
+    static std::shared_ptr<TriangleShape> Read(SnapshotReader& reader);
+
+    // レイと三角形の交差（表から当たるときだけ）
+    static bool IntersectTriangle(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir,
+        const D3DXVECTOR3& a, const D3DXVECTOR3& b, const D3DXVECTOR3& c, float maxDist, float& outDist);
+
+protected:
+    virtual void WriteBody(SnapshotWriter& writer) const = 0;
+    virtual bool ReadBody(SnapshotReader& reader) = 0;
+
+    KIND    m_Kind;     // 種類
+    AABB    m_Bounds;   // 全体を囲むAABB
+};
+
+//=============================================================================
+// 三角形メッシュの形状クラス（三角形のBVHを持つ）
+//=============================================================================
+class TriangleMeshShape : public TriangleShape
+{
+public:
+    TriangleMeshShape() : TriangleShape(MESH) {}
+
+    // 頂点と3つずつの番号から組み立てる（面積のない三角形は捨てる）
+    void Cook(const D3DXVECTOR3* vertices, int numVertices, const unsigned int* indices, int numTriangles);
+
+    int GetTriangleCount(void) const override { return (int)m_Indices.size() / 3; }
+    int GetVertexCount(void) const { return (int)m_Vertices.size(); }
+    int GetNodeCount(void) const { return (int)m_Nodes.size(); }
+    void QueryTriangles(const AABB& box, std::vector<int>& out) const override;
+    void GetTriangle(int index, D3DXVECTOR3* outVertices, int* outVertexIds) const override;
+    bool RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, int& outTriangle) const override;
+
+private:
+    // ノード（葉はcount > 0、StaticBVHと同じ並び）
+    struct Node
+    {
+        AABB    box;        // 子を囲むAABB
+        int     right;      // 右の子（左の子は直後のノード）
+        int     start;      // 葉の先頭の三角形
+        int     count;      // 葉の三角形数
+    };
+
+    // 組み立て中の三角形
+    struct BuildItem
+    {
+        AABB        box;        // 三角形を囲むAABB
+        D3DXVECTOR3 center;     // 分割用の中心
+        int         triangle;   // 元の三角形の番号
+    };
+
+    void WriteBody(SnapshotWriter& writer) const override;
+    bool ReadBody(SnapshotReader& reader) override;
+    int BuildRecursive(std::vector<BuildItem>& items, int start, int end);
+
+    static constexpr int MAX_LEAF_TRIANGLES = 4;    // 葉に入れる最大の三角形数
+    static constexpr int MAX_DEPTH          = 64;   // 探索スタックの深さ
+
+    std::vector<D3DXVECTOR3>    m_Vertices;     // 頂点
+    std::vector<int>            m_Indices;      // 三角形ごとの3頂点の番号（葉の並び）
+    std::vector<Node>           m_Nodes;        // ノード（深さ優先順）
+};
+
+//=============================================================================
+// 高さの格子の形状クラス（XZの格子点ごとの高さ、マスごとに2枚の三角形）
+//=============================================================================
+class HeightfieldShape : public TriangleShape
+{
+public:
+    HeightfieldShape() : TriangleShape(HEIGHTFIELD), m_Origin(INIT_VEC3), m_CellX(0.0f), m_CellZ(0.0f), m_NumX(0), m_NumZ(0) {}
+
+    // 高さをそのまま設定する（heightsはnumX×numZ、穴はHOLE）
+    void Cook(const D3DXVECTOR3& origin, float cellX, float cellZ, int numX, int numZ, const float* heights);
+
+    // メッシュを真上から見下ろして作る（マスの数は長い方の辺でresolution）
+    void CookFromMesh(const TriangleShape& mesh, int resolution = DEFAULT_RESOLUTION);
+
+    int GetTriangleCount(void) const override { return std::max(m_NumX - 1, 0) * std::max(m_NumZ - 1, 0) * 2; }
+    int GetNumX(void) const { return m_NumX; }
+    int GetNumZ(void) const { return m_NumZ; }
+    void QueryTriangles(const AABB& box, std::vector<int>& out) const override;
+    void GetTriangle(int index, D3DXVECTOR3* outVertices, int* outVertexIds) const override;
+    bool RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, int& outTriangle) const override;
+
+    static constexpr float  HOLE                = -FLT_MAX;     // 穴の高さ（まわりのマスの三角形を作らない）
+    static constexpr int    DEFAULT_RESOLUTION  = 64;           // メッシュから作るときのマスの数
+
+private:
+    void WriteBody(SnapshotWriter& writer) const override;
+    bool ReadBody(SnapshotReader& reader) override;
+    bool RayCastCell(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, int cellX, int cellZ, float maxDist, float& outDist, int& outTriangle) const;
+    bool IsHoleCell(int cellX, int cellZ) const;
+    void UpdateBounds(void);
+
+    D3DXVECTOR3         m_Origin;   // 格子点(0, 0)のXZ（yは使わない）
+    float               m_CellX;    // マスのXの幅
+    float               m_CellZ;    // マスのZの幅
+    int                 m_NumX;     // Xの格子点の数
+    int                 m_NumZ;     // Zの格子点の数
+    std::vector<float>  m_Heights;  // 格子点の高さ（z * m_NumX + x）
+};
+
+//=============================================================================
+// 凸包の形状クラス（点の集まりを包む凸多面体、三角形は外向き）
+// 頂点は凸包の角だけを持つので、支持点は頂点を総当たりで探す
+//=============================================================================
+class ConvexHullShape : public TriangleShape
+{
+public:
+    ConvexHullShape() : TriangleShape(HULL), m_Volume(0.0f) {}
+
+    // 点の集まりから組み立てる（平ら・点が足りないときは失敗して空になる）
+    bool Cook(const D3DXVECTOR3* points, int numPoints);
+
+    // メッシュの頂点を包んで作る
+    bool CookFromMesh(const TriangleShape& mesh);
+
+    int GetTriangleCount(void) const override { return (int)m_Indices.size() / 3; }
+    int GetVertexCount(void) const { return (int)m_Vertices.size(); }
+    const D3DXVECTOR3& GetVertex(int index) const { return m_Vertices[index]; }
+    int GetIndex(int triangle, int corner) const { return m_Indices[triangle * 3 + corner]; }
+    float GetVolume(void) const { return m_Volume; }
+    void QueryTriangles(const AABB& box, std::vector<int>& out) const override;
+    void GetTriangle(int index, D3DXVECTOR3* outVertices, int* outVertexIds) const override;
+    bool RayCast(const D3DXVECTOR3& origin, const D3DXVECTOR3& dir, float maxDist, float& outDist, int& outTriangle) const override;
+
+    // 拡大率をかけた凸包の原点まわりの慣性モーメント（密度一定、対角成分だけ）
+    void CalculateInertia(const D3DXVECTOR3& scale, float mass, D3DXVECTOR3& outInertia) const;
+
+private:
+    // 組み立て中の面
+    struct BuildFace
+    {
+        int         v[3];       // 頂点の番号（外から見て左回り）
+        D3DXVECTOR3 normal;     // 外向きの法線（正規化済み）
+        float       dist;       // 原点からの距離（normal・v）
+        bool        isAlive;    // 残っているか
+    };
+
+    void WriteBody(SnapshotWriter& writer) const override;
+    bool ReadBody(SnapshotReader& reader) override;
+    void Clear(void);
+    void UpdateVolume(void);
+
+    static constexpr float  HULL_EPSILON    = 1e-5f;    // 同じ平面とみなす距離（全体の大きさに対する割合）
+
+    std::vector<D3DXVECTOR3>    m_Vertices;     // 凸包の角の頂点
+    std::vector<int>            m_Indices;      // 三角形ごとの3頂点の番号
+    float                       m_Volume;       // 体積
+};
+
+#endif